@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+// Runs a function several times and reports the median time, which is stable against the odd slow run
+// The results are printed as one line per case: name, median and min in milliseconds, so runs can be compared
+class BenchmarkTimer
+{
+public:
+    BenchmarkTimer(unsigned int runCount = 15, unsigned int warmupCount = 2) : m_runCount(runCount), m_warmupCount(warmupCount)
+    {
+    }
+
+    // Returns the median time in milliseconds
+    template<typename F>
+    double Run(const char* name, F&& function) const
+    {
+        for (unsigned int i = 0; i < m_warmupCount; ++i)
+        {
+            function();
+        }
+
+        std::vector<double> times(m_runCount);
+        for (double& time : times)
+        {
+            auto start = std::chrono::steady_clock::now();
+            function();
+            time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        std::sort(times.begin(), times.end());
+
+        double median = times[times.size() / 2];
+        std::printf("%-40s median %10.4f ms   min %10.4f ms\n", name, median, times.front());
+        return median;
+    }
+
+private:
+    unsigned int m_runCount;
+    unsigned int m_warmupCount;
+};
+
+// Written by BenchmarkKeep, never read
+inline volatile unsigned char BenchmarkSink = 0;
+
+// Stops the compiler from removing work whose result is not used, by reading all its bytes into a volatile
+inline void BenchmarkKeep(const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    unsigned char sum = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        sum ^= bytes[i];
+    }
+    BenchmarkSink = sum;
+}
@@ -0,0 +1,72 @@
+#include <ituGL/scene/BoundsArray.h>
+#include <ituGL/core/CpuFeatures.h>
+
+#include <BenchmarkTimer.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// Time of the vectorized bounds kernels against their scalar reference implementations
+// Usage: boundsBenchmark [element count]
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    std::printf("%zu elements\n", count);
+
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.1f, 10.0f);
+
+    AabbArray boxes;
+    SphereArray spheres;
+    boxes.Reserve(count);
+    spheres.Reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        glm::vec3 center(position(random), position(random), position(random));
+        boxes.Add(center, glm::vec3(size(random), size(random), size(random)));
+        spheres.Add(center, size(random));
+    }
+
+    glm::mat4 viewProjection = glm::perspective(1.0f, 1.5f, 0.1f, 1000.0f)
+        * glm::lookAt(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(100.0f, 0.0f, 100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    std::array<BoundsPlane, 6> planes;
+    ExtractFrustumPlanes(viewProjection, planes);
+
+    AabbBounds otherBox(glm::vec3(0.0f), glm::vec3(200.0f));
+    SphereBounds otherSphere(glm::vec3(0.0f), 200.0f);
+    glm::mat4 matrix = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(5.0f)), 0.5f, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f)));
+
+    std::vector<unsigned char> results(count);
+    AabbArray transformed;
+
+    BenchmarkTimer timer;
+    timer.Run("AabbArray::TestPlanesReference", [&]() { boxes.TestPlanesReference(planes, results); BenchmarkKeep(results.data(), results.size()); });
+    timer.Run("AabbArray::TestOverlapReference", [&]() { boxes.TestOverlapReference(otherBox, results); BenchmarkKeep(results.data(), results.size()); });
+    timer.Run("AabbArray::TransformReference", [&]() { boxes.TransformReference(matrix, transformed); BenchmarkKeep(transformed.GetCenterX().data(), sizeof(float)); });
+    timer.Run("SphereArray::TestPlanesReference", [&]() { spheres.TestPlanesReference(planes, results); BenchmarkKeep(results.data(), results.size()); });
+    timer.Run("SphereArray::TestOverlapReference", [&]() { spheres.TestOverlapReference(otherSphere, results); BenchmarkKeep(results.data(), results.size()); });
+
+    // Vectorized kernels with SSE2, then with AVX2 if the CPU has it
+    for (bool avx2 : { false, true })
+    {
+        if (avx2 && !CpuFeatures::IsAvx2Supported())
+        {
+            std::printf("AVX2 is not supported\n");
+            continue;
+        }
+        CpuFeatures::SetAvx2Enabled(avx2);
+        std::string suffix = avx2 ? " AVX2" : " SSE2";
+
+        timer.Run(("AabbArray::TestPlanes" + suffix).c_str(), [&]() { boxes.TestPlanes(planes, results); BenchmarkKeep(results.data(), results.size()); });
+        timer.Run(("AabbArray::TestOverlap" + suffix).c_str(), [&]() { boxes.TestOverlap(otherBox, results); BenchmarkKeep(results.data(), results.size()); });
+        timer.Run(("AabbArray::Transform" + suffix).c_str(), [&]() { boxes.Transform(matrix, transformed); BenchmarkKeep(transformed.GetCenterX().data(), sizeof(float)); });
+        timer.Run(("SphereArray::TestPlanes" + suffix).c_str(), [&]() { spheres.TestPlanes(planes, results); BenchmarkKeep(results.data(), results.size()); });
+        timer.Run(("SphereArray::TestOverlap" + suffix).c_str(), [&]() { spheres.TestOverlap(otherSphere, results); BenchmarkKeep(results.data(), results.size()); });
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <ituGL/geometry/HeightfieldGenerator.h>
+#include <ituGL/core/JobSystem.h>
+#include <ituGL/core/CpuFeatures.h>
+
+#include <BenchmarkTimer.h>
+#include <glm/vec3.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Time of the heightfield noise and tangent frames against their scalar references, and against the number of worker threads
+// Usage: heightfieldBenchmark [grid size] [max worker count]
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec3 tangent;
+    glm::vec3 bitangent;
+};
+
+int main(int argc, char** argv)
+{
+    unsigned int size = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1025;
+    unsigned int maxWorkerCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    std::printf("%ux%u grid, hardware concurrency %u\n", size, size, std::thread::hardware_concurrency());
+
+    HeightfieldGenerator::NoiseSettings settings;
+    settings.noiseMax = glm::vec2(8.0f);
+    settings.noiseZ = 0.37f;
+    settings.height = 20.0f;
+
+    const glm::vec2 spacing(0.5f);
+    std::vector<float> heights(static_cast<size_t>(size) * size);
+    std::vector<Vertex> vertices(heights.size());
+    std::span<std::byte> vertexData(reinterpret_cast<std::byte*>(vertices.data()), vertices.size() * sizeof(Vertex));
+
+    BenchmarkTimer timer(7, 1);
+    timer.Run("HeightfieldGenerator::GenerateReference", [&]()
+        {
+            HeightfieldGenerator::GenerateReference(heights, size, size, settings);
+            BenchmarkKeep(heights.data(), sizeof(float));
+        });
+    timer.Run("ComputeTangentFramesReference", [&]()
+        {
+            HeightfieldGenerator::ComputeTangentFramesReference(heights, size, size, spacing, vertexData, sizeof(Vertex),
+                offsetof(Vertex, normal), offsetof(Vertex, tangent), offsetof(Vertex, bitangent));
+            BenchmarkKeep(vertices.data(), sizeof(Vertex));
+        });
+
+    // Vectorized rows with SSE2, then with AVX2 if the CPU has it
+    for (bool avx2 : { false, true })
+    {
+        if (avx2 && !CpuFeatures::IsAvx2Supported())
+        {
+            std::printf("AVX2 is not supported\n");
+            continue;
+        }
+        CpuFeatures::SetAvx2Enabled(avx2);
+        std::string suffix = avx2 ? " AVX2" : " SSE2";
+
+        for (unsigned int workerCount = 0; workerCount <= maxWorkerCount; ++workerCount)
+        {
+            JobSystem jobSystem(workerCount);
+            std::string generateName = "Generate " + std::to_string(workerCount) + " workers" + suffix;
+            timer.Run(generateName.c_str(), [&]()
+                {
+                    HeightfieldGenerator::Generate(heights, size, size, settings, jobSystem);
+                    BenchmarkKeep(heights.data(), sizeof(float));
+                });
+
+            std::string tangentFramesName = "ComputeTangentFrames " + std::to_string(workerCount) + " workers" + suffix;
+            timer.Run(tangentFramesName.c_str(), [&]()
+                {
+                    HeightfieldGenerator::ComputeTangentFrames(heights, size, size, spacing, vertices,
+                        offsetof(Vertex, normal), offsetof(Vertex, tangent), offsetof(Vertex, bitangent), jobSystem);
+                    BenchmarkKeep(vertices.data(), sizeof(Vertex));
+                });
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <ituGL/scene/Scene.h>
+#include <ituGL/scene/SceneModel.h>
+#include <ituGL/scene/SceneVisitor.h>
+#include <ituGL/scene/Transform.h>
+#include <ituGL/geometry/Model.h>
+#include <ituGL/core/JobSystem.h>
+
+#include <BenchmarkTimer.h>
+#include <glm/common.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Frame time of the parallel scene traversal against the number of worker threads
+// Every frame the parent transforms are animated, so all the node transforms are dirty when the traversal starts
+// Usage: sceneTraversalBenchmark [node count] [max worker count]
+
+// Computes the world space bounds of the model positions, similar to the work done by RendererSceneVisitor
+class WorldBoundsVisitor : public SceneVisitor
+{
+public:
+    WorldBoundsVisitor() : m_min(std::numeric_limits<float>::max()), m_max(-std::numeric_limits<float>::max()), m_count(0)
+    {
+    }
+
+    void VisitModel(SceneModel& sceneModel) override
+    {
+        glm::vec3 position = sceneModel.GetTransform()->GetTransformMatrix() * glm::vec4(sceneModel.GetAabbCenter(), 1.0f);
+        m_min = glm::min(m_min, position);
+        m_max = glm::max(m_max, position);
+        ++m_count;
+    }
+
+    WorldBoundsVisitor CreateChunkVisitor() const
+    {
+        return WorldBoundsVisitor();
+    }
+
+    void MergeChunkVisitor(WorldBoundsVisitor& chunkVisitor)
+    {
+        m_min = glm::min(m_min, chunkVisitor.m_min);
+        m_max = glm::max(m_max, chunkVisitor.m_max);
+        m_count += chunkVisitor.m_count;
+    }
+
+    bool operator == (const WorldBoundsVisitor& other) const
+    {
+        return m_min == other.m_min && m_max == other.m_max && m_count == other.m_count;
+    }
+
+private:
+    glm::vec3 m_min;
+    glm::vec3 m_max;
+    size_t m_count;
+};
+
+template<>
+struct SceneVisitorTraits<WorldBoundsVisitor>
+{
+    static constexpr bool IsThreadSafe = true;
+};
+
+int main(int argc, char** argv)
+{
+    size_t nodeCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    unsigned int maxWorkerCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    std::printf("%zu nodes, hardware concurrency %u\n", nodeCount, std::thread::hardware_concurrency());
+
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+
+    // Nodes share a few parents, like objects grouped under a common transform
+    std::vector<std::shared_ptr<Transform>> parents(64);
+    for (std::shared_ptr<Transform>& parent : parents)
+    {
+        parent = std::make_shared<Transform>();
+        parent->SetTranslation(glm::vec3(position(random), 0.0f, position(random)));
+    }
+
+    std::shared_ptr<Model> model = std::make_shared<Model>();
+    Scene scene;
+    for (size_t i = 0; i < nodeCount; ++i)
+    {
+        std::shared_ptr<SceneModel> node = std::make_shared<SceneModel>("node" + std::to_string(i), model);
+        node->GetTransform()->SetParent(parents[i % parents.size()]);
+        node->GetTransform()->SetTranslation(glm::vec3(position(random), position(random), position(random)));
+        scene.AddSceneNode(node);
+    }
+
+    float time = 0.0f;
+    auto animate = [&]()
+    {
+        time += 0.01f;
+        for (std::shared_ptr<Transform>& parent : parents)
+        {
+            parent->SetRotation(glm::vec3(0.0f, time, 0.0f));
+        }
+    };
+
+    BenchmarkTimer timer;
+    WorldBoundsVisitor serialResult;
+    timer.Run("Scene::AcceptVisitor", [&]()
+        {
+            animate();
+            serialResult = WorldBoundsVisitor();
+            scene.AcceptVisitor(serialResult);
+        });
+
+    for (unsigned int workerCount = 0; workerCount <= maxWorkerCount; ++workerCount)
+    {
+        JobSystem jobSystem(workerCount);
+        WorldBoundsVisitor parallelResult;
+        std::string name = "Scene::AcceptVisitorParallel " + std::to_string(workerCount) + " workers";
+        timer.Run(name.c_str(), [&]()
+            {
+                animate();
+                parallelResult = WorldBoundsVisitor();
+                scene.AcceptVisitorParallel(parallelResult, jobSystem);
+            });
+
+        // The parallel traversal starts with dirty transforms, the serial one then reads the same cached matrices
+        animate();
+        parallelResult = WorldBoundsVisitor();
+        scene.AcceptVisitorParallel(parallelResult, jobSystem);
+        serialResult = WorldBoundsVisitor();
+        scene.AcceptVisitor(serialResult);
+        if (!(parallelResult == serialResult))
+        {
+            std::printf("Parallel traversal result differs from the serial one\n");
+            return 1;
+        }
+    }
+
+    return 0;
+}
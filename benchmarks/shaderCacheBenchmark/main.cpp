@@ -0,0 +1,246 @@
+#include <ituGL/core/DeviceGL.h>
+#include <ituGL/application/Window.h>
+#include <ituGL/asset/ShaderProgramCache.h>
+#include <ituGL/shader/ShaderProgram.h>
+
+#include <BenchmarkTimer.h>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Time to build a set of shader programs with an empty binary cache (cold) and with all the binaries in the cache (warm)
+// Also the time with the cache disabled, that only compiles, to see the cost of writing the binaries in a cold build
+// Each cold run builds sources that were never built before, so the driver's own shader cache can't hide the compile
+// Usage: shaderCacheBenchmark [program count]
+
+namespace
+{
+    const char* VertexShaderSource = R"(
+layout (location = 0) in vec3 VertexPosition;
+layout (location = 1) in vec3 VertexNormal;
+layout (location = 2) in vec2 VertexTexCoord;
+
+out vec3 WorldPosition;
+out vec3 WorldNormal;
+out vec2 TexCoord;
+
+uniform mat4 WorldMatrix;
+uniform mat4 ViewProjMatrix;
+
+void main()
+{
+    WorldPosition = (WorldMatrix * vec4(VertexPosition, 1.0)).xyz;
+    WorldNormal = normalize(mat3(WorldMatrix) * VertexNormal);
+    TexCoord = VertexTexCoord * PROGRAM_SCALE;
+    gl_Position = ViewProjMatrix * vec4(WorldPosition, 1.0);
+}
+)";
+
+    // Enough work per program to be close to a real lighting shader
+    const char* FragmentShaderSource = R"(
+in vec3 WorldPosition;
+in vec3 WorldNormal;
+in vec2 TexCoord;
+
+out vec4 FragColor;
+
+uniform sampler2D ColorTexture;
+uniform vec3 CameraPosition;
+uniform vec3 LightPositions[8];
+uniform vec3 LightColors[8];
+uniform float Roughness;
+uniform float Metalness;
+
+const float Pi = 3.1415926536;
+
+float DistributionGGX(float NdotH, float a)
+{
+    float a2 = a * a;
+    float d = NdotH * NdotH * (a2 - 1.0) + 1.0;
+    return a2 / (Pi * d * d);
+}
+
+float GeometrySmith(float NdotV, float NdotL, float a)
+{
+    float k = a * 0.5;
+    return NdotV / (NdotV * (1.0 - k) + k) * NdotL / (NdotL * (1.0 - k) + k);
+}
+
+vec3 Fresnel(vec3 f0, float VdotH)
+{
+    return f0 + (1.0 - f0) * pow(1.0 - VdotH, 5.0);
+}
+
+void main()
+{
+    vec3 albedo = texture(ColorTexture, TexCoord).rgb;
+    vec3 N = normalize(WorldNormal);
+    vec3 V = normalize(CameraPosition - WorldPosition);
+    float a = Roughness * Roughness;
+    vec3 f0 = mix(vec3(0.04), albedo, Metalness);
+    vec3 color = vec3(0.0);
+    for (int i = 0; i < 8; ++i)
+    {
+        vec3 L = LightPositions[i] - WorldPosition;
+        float attenuation = 1.0 / (1.0 + dot(L, L));
+        L = normalize(L);
+        vec3 H = normalize(L + V);
+        float NdotL = max(dot(N, L), 0.0);
+        float NdotV = max(dot(N, V), 0.001);
+        float NdotH = max(dot(N, H), 0.0);
+        vec3 F = Fresnel(f0, max(dot(V, H), 0.0));
+        vec3 specular = DistributionGGX(NdotH, a) * GeometrySmith(NdotV, NdotL, a) * F / (4.0 * NdotV * NdotL + 0.001);
+        vec3 diffuse = (1.0 - F) * (1.0 - Metalness) * albedo / Pi;
+        color += (diffuse + specular) * LightColors[i] * NdotL * attenuation;
+    }
+    FragColor = vec4(color * PROGRAM_SCALE, 1.0);
+}
+)";
+
+    void WriteFile(const std::filesystem::path& path, const std::string& text)
+    {
+        std::ofstream(path, std::ios::trunc) << text;
+    }
+
+    // Source files of the benchmark programs. Only the shared prefix file changes between runs
+    class ProgramSet
+    {
+    public:
+        ProgramSet(const std::filesystem::path& directory, unsigned int programCount) : m_directory(directory)
+        {
+            WriteFile(directory / "version.glsl", "#version 330 core\n");
+            WriteFile(directory / "shader.vert", VertexShaderSource);
+            WriteFile(directory / "shader.frag", FragmentShaderSource);
+            for (unsigned int i = 0; i < programCount; ++i)
+            {
+                std::string path = (directory / ("program" + std::to_string(i) + ".glsl")).string();
+                WriteFile(path, "#define PROGRAM_SCALE " + std::to_string(i + 1) + ".0\n");
+                m_programPaths.push_back(path);
+            }
+            m_versionPath = (directory / "version.glsl").string();
+            m_vertexPath = (directory / "shader.vert").string();
+            m_fragmentPath = (directory / "shader.frag").string();
+        }
+
+        // Builds every program with a run prefix. Sources with a new prefix were never compiled before
+        // Returns the number of linked programs
+        unsigned int Build(ShaderProgramCache& cache, const std::string& runName)
+        {
+            // A new file for each run, so the source cache never returns stale text
+            std::string runPath = (m_directory / ("run_" + runName + ".glsl")).string();
+            if (!std::filesystem::exists(runPath))
+            {
+                WriteFile(runPath, "// Benchmark run " + runName + "\n");
+            }
+
+            unsigned int linkedCount = 0;
+            for (const std::string& programPath : m_programPaths)
+            {
+                const char* vertexPaths[] = { m_versionPath.c_str(), runPath.c_str(), programPath.c_str(), m_vertexPath.c_str() };
+                const char* fragmentPaths[] = { m_versionPath.c_str(), runPath.c_str(), programPath.c_str(), m_fragmentPath.c_str() };
+                ShaderProgram shaderProgram;
+                if (cache.Build(shaderProgram, vertexPaths, fragmentPaths))
+                {
+                    ++linkedCount;
+                }
+            }
+            return linkedCount;
+        }
+
+        inline unsigned int GetProgramCount() const { return static_cast<unsigned int>(m_programPaths.size()); }
+
+    private:
+        std::filesystem::path m_directory;
+        std::string m_versionPath;
+        std::string m_vertexPath;
+        std::string m_fragmentPath;
+        std::vector<std::string> m_programPaths;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int programCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 32;
+
+    // Hidden window, only for the context
+    DeviceGL deviceGL;
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    Window window(64, 64, "shaderCacheBenchmark");
+    if (!window.IsValid())
+    {
+        std::printf("Could not create an OpenGL context\n");
+        return 1;
+    }
+    deviceGL.SetCurrentWindow(window);
+    if (!deviceGL.IsReady())
+    {
+        std::printf("Could not load OpenGL\n");
+        return 1;
+    }
+    std::printf("%s, %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+
+    GLint binaryFormatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormatCount);
+    if (binaryFormatCount == 0)
+    {
+        std::printf("The driver has no program binary formats, the cache is always disabled\n");
+        return 1;
+    }
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "shaderCacheBenchmark";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "sources");
+    std::filesystem::create_directories(directory / "cache");
+    std::string cacheDirectory = (directory / "cache").string();
+
+    ProgramSet programSet(directory / "sources", programCount);
+    std::printf("%u programs\n", programSet.GetProgramCount());
+
+    // Compiling is slow, fewer runs are enough
+    BenchmarkTimer timer(7, 1);
+    unsigned int runIndex = 0;
+    bool success = true;
+
+    timer.Run("Cache disabled", [&]()
+        {
+            ShaderProgramCache cache(cacheDirectory.c_str());
+            cache.SetEnabled(false);
+            success &= programSet.Build(cache, std::to_string(runIndex++)) == programCount;
+        });
+
+    timer.Run("Cold cache (compile and store)", [&]()
+        {
+            ShaderProgramCache cache(cacheDirectory.c_str());
+            success &= programSet.Build(cache, std::to_string(runIndex++)) == programCount;
+            success &= cache.GetMissCount() == programCount;
+        });
+
+    // Fill the cache once, then every run loads all the binaries
+    {
+        ShaderProgramCache cache(cacheDirectory.c_str());
+        success &= programSet.Build(cache, "warm") == programCount;
+    }
+    unsigned int rejectedCount = 0;
+    timer.Run("Warm cache (load binaries)", [&]()
+        {
+            ShaderProgramCache cache(cacheDirectory.c_str());
+            success &= programSet.Build(cache, "warm") == programCount;
+            success &= cache.GetHitCount() + cache.GetRejectedCount() == programCount;
+            rejectedCount += cache.GetRejectedCount();
+        });
+    if (rejectedCount > 0)
+    {
+        std::printf("%u binaries rejected by the driver, warm times include compiling them\n", rejectedCount);
+    }
+
+    std::filesystem::remove_all(directory);
+
+    if (!success)
+    {
+        std::printf("Some programs failed to build, or the cache didn't behave as expected\n");
+        return 1;
+    }
+    return 0;
+}
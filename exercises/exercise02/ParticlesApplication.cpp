@@ -1,7 +1,7 @@
 #include "ParticlesApplication.h"
 
 #include <ituGL/shader/Shader.h>
-#include <ituGL/geometry/VertexAttribute.h>
+#include <ituGL/geometry/VertexLayout.h>
 #include <cassert>
 #include <array>
 #include <fstream>
@@ -19,16 +19,14 @@ struct Particle
     glm::vec2 velocity;
 };
 
-// List of attributes of the particle. Must match the structure above
-const std::array<VertexAttribute, 6> s_vertexAttributes =
-{
-    VertexAttribute(Data::Type::Float, 2), // position
-    VertexAttribute(Data::Type::Float, 1), // size
-    VertexAttribute(Data::Type::Float, 1), // birth
-    VertexAttribute(Data::Type::Float, 1), // duration
-    VertexAttribute(Data::Type::Float, 4), // color
-    VertexAttribute(Data::Type::Float, 2), // velocity
-};
+// Layout of the particle attributes, built from the structure above at compile time
+using ParticleLayout = VertexLayout<Particle,
+    ITUGL_VERTEX_ATTRIBUTE(Particle, position, Position),
+    ITUGL_VERTEX_ATTRIBUTE(Particle, size, Unknown),
+    ITUGL_VERTEX_ATTRIBUTE(Particle, birth, Unknown),
+    ITUGL_VERTEX_ATTRIBUTE(Particle, duration, Unknown),
+    ITUGL_VERTEX_ATTRIBUTE(Particle, color, Color0),
+    ITUGL_VERTEX_ATTRIBUTE(Particle, velocity, Unknown)>;
 
 
 ParticlesApplication::ParticlesApplication()
@@ -115,7 +113,7 @@ void ParticlesApplication::Render()
 }
 
 // Nothing to do in this method for this exercise.
-// Change s_vertexAttributes and the Particle struct to add new vertex attributes
+// Change ParticleLayout and the Particle struct to add new vertex attributes
 void ParticlesApplication::InitializeGeometry()
 {
     m_vbo.Bind();
@@ -127,14 +125,11 @@ void ParticlesApplication::InitializeGeometry()
     m_vao.Bind();
 
     // Automatically iterate through the vertex attributes, and set the pointer
-    // We use interleaved attributes, so the offset is local to the particle, and the stride is the size of the particle
-    GLsizei stride = sizeof(Particle);
-    GLint offset = 0;
+    // We use interleaved attributes, the layout has the offset of each member and the size of the particle as stride
     GLuint location = 0;
-    for (const VertexAttribute& attribute : s_vertexAttributes)
+    for (const VertexAttribute::Layout& layout : ParticleLayout::Layouts)
     {
-        m_vao.SetAttribute(location++, attribute, offset, stride);
-        offset += attribute.GetSize();
+        m_vao.SetAttribute(location++, layout.GetAttribute(), layout.GetOffset(), layout.GetStride());
     }
 
     // Unbind VAO and VBO
@@ -0,0 +1,424 @@
+#include "ChunkedTerrain.h"
+
+#include <ituGL/core/JobSystem.h>
+#include <ituGL/geometry/HeightfieldGenerator.h>
+#include <ituGL/geometry/VertexLayout.h>
+#include <ituGL/geometry/MeshOptimizer.h>
+#include <ituGL/camera/Camera.h>
+#include <ituGL/shader/Material.h>
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+namespace
+{
+    // Position w is the height of the vertex in the next level, texture coordinates are the grid coordinates
+    struct Vertex
+    {
+        glm::vec4 position;
+        glm::vec3 normal;
+        glm::vec3 tangent;
+        glm::vec3 bitangent;
+        glm::vec2 texCoord;
+    };
+
+    using Layout = VertexLayout<Vertex,
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, position, Position),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, normal, Normal),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, tangent, Tangent),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, bitangent, Bitangent),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, texCoord, TexCoord0)>;
+
+    // Highest level that has the vertex, capped to maxLevel
+    unsigned int GetVertexLevel(unsigned int i, unsigned int j, unsigned int maxLevel)
+    {
+        unsigned int level = 0;
+        while (level < maxLevel && ((i | j) & (1u << level)) == 0)
+        {
+            ++level;
+        }
+        return level;
+    }
+
+    // Closest point of the box is inside the sphere
+    bool IntersectsSphere(const AabbBounds& bounds, const glm::vec3& center, float radius)
+    {
+        glm::vec3 offset = glm::clamp(center, bounds.GetMin(), bounds.GetMax()) - center;
+        return glm::dot(offset, offset) <= radius * radius;
+    }
+}
+
+ChunkedTerrain::ChunkedTerrain()
+    : m_gridSize(0)
+    , m_cellSize(0.0f)
+    , m_chunkSize(0)
+    , m_levelCount(0)
+    , m_quadrantElementCount(0)
+    , m_boundsMin(0.0f)
+    , m_boundsMax(0.0f)
+    , m_maxScreenError(2.0f)
+    , m_shadowLodBias(1.0f)
+    , m_morphRatio(0.3f)
+{
+}
+
+void ChunkedTerrain::Initialize(std::span<const float> heightmap, unsigned int gridSize, float cellSize, unsigned int chunkSize,
+    const Mesh::SemanticMap& locations)
+{
+    unsigned int pitch = gridSize + 1;
+    assert(heightmap.size() == pitch * pitch);
+    assert(chunkSize >= 2 && chunkSize % 2 == 0 && gridSize % chunkSize == 0 && std::has_single_bit(gridSize / chunkSize));
+
+    m_gridSize = gridSize;
+    m_cellSize = cellSize;
+    m_chunkSize = chunkSize;
+    m_levelCount = std::bit_width(gridSize / chunkSize);
+
+    auto GetHeight = [&](unsigned int i, unsigned int j) { return heightmap[j * pitch + i]; };
+
+    // Full resolution grid, with the height of each vertex in the level after its own, where it is no longer present
+    // Vertices of the top level don't morph. The error of each level adds the max morph of the previous one
+    std::vector<float> levelMorphs(m_levelCount, 0.0f);
+    std::vector<Vertex> vertices(pitch * pitch);
+    for (unsigned int j = 0; j < pitch; ++j)
+    {
+        for (unsigned int i = 0; i < pitch; ++i)
+        {
+            float height = GetHeight(i, j);
+            float nextHeight = height;
+
+            unsigned int level = GetVertexLevel(i, j, m_levelCount - 1);
+            if (level < m_levelCount - 1)
+            {
+                // Odd vertices of the level are in the middle of an edge of the next level, or of its diagonal (see the triangles below)
+                unsigned int step = 1u << level;
+                bool oddX = (i >> level) & 1;
+                bool oddY = (j >> level) & 1;
+                if (oddX && oddY)
+                {
+                    nextHeight = (GetHeight(i - step, j + step) + GetHeight(i + step, j - step)) * 0.5f;
+                }
+                else if (oddX)
+                {
+                    nextHeight = (GetHeight(i - step, j) + GetHeight(i + step, j)) * 0.5f;
+                }
+                else
+                {
+                    nextHeight = (GetHeight(i, j - step) + GetHeight(i, j + step)) * 0.5f;
+                }
+                levelMorphs[level] = std::max(levelMorphs[level], std::abs(nextHeight - height));
+            }
+
+            Vertex& vertex = vertices[j * pitch + i];
+            vertex.position = glm::vec4(i * cellSize, height, j * cellSize, nextHeight);
+            vertex.texCoord = glm::vec2(i, j);
+        }
+    }
+
+    m_levelErrors.assign(m_levelCount, 0.0f);
+    for (unsigned int level = 1; level < m_levelCount; ++level)
+    {
+        m_levelErrors[level] = m_levelErrors[level - 1] + levelMorphs[level - 1];
+    }
+
+    // Compute normals when we have the positions of all the vertices
+    HeightfieldGenerator::ComputeTangentFrames(heightmap, pitch, pitch, glm::vec2(cellSize), vertices,
+        offsetof(Vertex, normal), offsetof(Vertex, tangent), offsetof(Vertex, bitangent), JobSystem::GetDefault());
+
+    // Elements of a quadrant of a chunk, in a grid of its own so they can be reordered for the vertex cache
+    // The quadrants are consecutive in the EBO, so a node can draw all of it or the quadrants of the children it doesn't draw
+    unsigned int quadrantSize = chunkSize / 2;
+    unsigned int quadrantPitch = quadrantSize + 1;
+    std::vector<unsigned int> quadrantIndices;
+    for (unsigned int y = 0; y < quadrantSize; ++y)
+    {
+        for (unsigned int x = 0; x < quadrantSize; ++x)
+        {
+            unsigned int bottom_left = y * quadrantPitch + x;
+            unsigned int bottom_right = bottom_left + 1;
+            unsigned int top_left = bottom_left + quadrantPitch;
+            unsigned int top_right = top_left + 1;
+
+            // Same triangles as Terrain::CreateTerrainMesh
+            quadrantIndices.insert(quadrantIndices.end(), { bottom_left, top_left, bottom_right });
+            quadrantIndices.insert(quadrantIndices.end(), { bottom_right, top_left, top_right });
+        }
+    }
+    MeshOptimizer::OptimizeVertexCache(quadrantIndices, quadrantPitch * quadrantPitch);
+    m_quadrantElementCount = static_cast<unsigned int>(quadrantIndices.size());
+
+    unsigned int vboIndex = m_mesh.AddVertexData(std::span<const Vertex>(vertices));
+    for (unsigned int level = 0; level < m_levelCount; ++level)
+    {
+        // Same chunk with 2^level times the spacing. The node adds its origin as base vertex
+        unsigned int step = 1u << level;
+        std::vector<unsigned int> indices;
+        indices.reserve(4 * quadrantIndices.size());
+        for (unsigned int quadrant = 0; quadrant < 4; ++quadrant)
+        {
+            unsigned int quadrantX = (quadrant & 1) * quadrantSize;
+            unsigned int quadrantY = (quadrant >> 1) * quadrantSize;
+            for (unsigned int quadrantIndex : quadrantIndices)
+            {
+                unsigned int x = quadrantX + quadrantIndex % quadrantPitch;
+                unsigned int y = quadrantY + quadrantIndex / quadrantPitch;
+                indices.push_back((y * pitch + x) * step);
+            }
+        }
+
+        unsigned int eboIndex = m_mesh.AddElementData(std::span<const unsigned int>(indices));
+        m_mesh.AddSubmesh(Drawcall::Primitive::Triangles, 0, static_cast<int>(indices.size()), Data::Type::UInt,
+            vboIndex, eboIndex, Layout::LayoutBegin(), Layout::LayoutEnd(), locations);
+    }
+
+    // Quadtree with the root covering the whole grid, and the chunks of the full resolution as leaves
+    unsigned int nodeCount = ((1u << (2 * m_levelCount)) - 1) / 3;
+    m_nodes.resize(nodeCount);
+    m_nodeBounds.Resize(nodeCount);
+    m_visibleNodes.resize(nodeCount);
+    m_levelDiagonals.assign(m_levelCount, 0.0f);
+
+    unsigned int nextNodeIndex = 1;
+    InitializeNode(0, m_levelCount - 1, 0, 0, heightmap, nextNodeIndex);
+    assert(nextNodeIndex == nodeCount);
+
+    AabbBounds rootBounds = m_nodeBounds.Get(0);
+    m_boundsMin = rootBounds.GetMin();
+    m_boundsMax = rootBounds.GetMax();
+}
+
+void ChunkedTerrain::InitializeNode(unsigned int nodeIndex, unsigned int level, unsigned int x, unsigned int y,
+    std::span<const float> heightmap, unsigned int& nextNodeIndex)
+{
+    unsigned int pitch = m_gridSize + 1;
+    unsigned int extent = m_chunkSize << level;
+
+    // The morphed heights are averages of heights inside the node, so they are in the same bounds
+    float minHeight = FLT_MAX;
+    float maxHeight = -FLT_MAX;
+    for (unsigned int j = y; j <= y + extent; ++j)
+    {
+        for (unsigned int i = x; i <= x + extent; ++i)
+        {
+            minHeight = std::min(minHeight, heightmap[j * pitch + i]);
+            maxHeight = std::max(maxHeight, heightmap[j * pitch + i]);
+        }
+    }
+
+    glm::vec3 boundsMin(x * m_cellSize, minHeight, y * m_cellSize);
+    glm::vec3 boundsMax((x + extent) * m_cellSize, maxHeight, (y + extent) * m_cellSize);
+    m_nodeBounds.Set(nodeIndex, (boundsMin + boundsMax) * 0.5f, (boundsMax - boundsMin) * 0.5f);
+    m_levelDiagonals[level] = std::max(m_levelDiagonals[level], glm::length(boundsMax - boundsMin));
+
+    Node& node = m_nodes[nodeIndex];
+    node.baseVertex = y * pitch + x;
+    node.level = level;
+    node.firstChild = 0;
+
+    if (level > 0)
+    {
+        // Reserve the children first, so they are consecutive
+        unsigned int firstChild = nextNodeIndex;
+        nextNodeIndex += 4;
+        node.firstChild = firstChild;
+
+        unsigned int childExtent = extent / 2;
+        for (unsigned int quadrant = 0; quadrant < 4; ++quadrant)
+        {
+            InitializeNode(firstChild + quadrant, level - 1, x + (quadrant & 1) * childExtent, y + (quadrant >> 1) * childExtent,
+                heightmap, nextNodeIndex);
+        }
+    }
+}
+
+void ChunkedTerrain::SetMaterials(std::shared_ptr<const Material> material, std::shared_ptr<const Material> shadowMaterial)
+{
+    CreateLevelMaterials(m_mainPass, *material, m_levelCount);
+    CreateLevelMaterials(m_shadowPass, *shadowMaterial, m_levelCount);
+}
+
+void ChunkedTerrain::CreateLevelMaterials(LodPass& pass, const Material& material, unsigned int levelCount)
+{
+    pass.materials.clear();
+    for (unsigned int level = 0; level < levelCount; ++level)
+    {
+        std::shared_ptr<Material> levelMaterial = std::make_shared<Material>(material);
+        levelMaterial->SetUniformValue("LodStep", static_cast<float>(1u << level));
+        pass.materials.push_back(levelMaterial);
+    }
+}
+
+std::shared_ptr<Material> ChunkedTerrain::GetLevelMaterial(unsigned int level) const
+{
+    assert(level < m_mainPass.materials.size());
+    return m_mainPass.materials[level];
+}
+
+std::shared_ptr<Material> ChunkedTerrain::GetShadowLevelMaterial(unsigned int level) const
+{
+    assert(level < m_shadowPass.materials.size());
+    return m_shadowPass.materials[level];
+}
+
+void ChunkedTerrain::AddDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera, float viewportHeight)
+{
+    std::array<BoundsPlane, 6> planes;
+    ExtractFrustumPlanes(camera.GetViewProjectionMatrix(), planes);
+
+    AddPassDrawcalls(m_mainPass, renderer, collectionIndex, camera, viewportHeight, m_maxScreenError, planes);
+}
+
+void ChunkedTerrain::AddShadowDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera, float viewportHeight,
+    const glm::vec3& lightDirection)
+{
+    std::array<BoundsPlane, 6> frustumPlanes;
+    ExtractFrustumPlanes(camera.GetViewProjectionMatrix(), frustumPlanes);
+
+    // Chunks behind a plane can only cast shadows into the frustum if the light goes through that plane towards the inside
+    std::vector<BoundsPlane> planes;
+    for (const BoundsPlane& plane : frustumPlanes)
+    {
+        if (glm::dot(glm::vec3(plane), lightDirection) <= 0.0f)
+        {
+            planes.push_back(plane);
+        }
+    }
+
+    AddPassDrawcalls(m_shadowPass, renderer, collectionIndex, camera, viewportHeight, m_maxScreenError * std::exp2(m_shadowLodBias), planes);
+}
+
+void ChunkedTerrain::AddPassDrawcalls(LodPass& pass, Renderer& renderer, unsigned int collectionIndex, const Camera& camera,
+    float viewportHeight, float maxScreenError, std::span<const BoundsPlane> planes)
+{
+    pass.statistics = Statistics();
+    if (m_nodes.empty() || pass.materials.size() != m_levelCount)
+    {
+        return;
+    }
+
+    UpdateRanges(pass, camera, viewportHeight, maxScreenError);
+
+    // Test all the nodes at once, the selection only reads the results
+    m_nodeBounds.TestPlanes(planes, m_visibleNodes);
+
+    glm::vec3 cameraPosition = camera.ExtractTranslation();
+    pass.chunks.clear();
+    SelectNode(pass, 0, cameraPosition);
+
+    // Morph between the start of the range and its end, where the next level is used. The top level doesn't morph
+    for (unsigned int level = 0; level < m_levelCount; ++level)
+    {
+        glm::vec2 morphRange(FLT_MAX * 0.5f, FLT_MAX);
+        if (level + 1 < m_levelCount)
+        {
+            float previousRange = level > 0 ? pass.ranges[level - 1] : 0.0f;
+            morphRange.y = pass.ranges[level];
+            morphRange.x = morphRange.y - m_morphRatio * (morphRange.y - previousRange);
+        }
+        Material& material = *pass.materials[level];
+        material.SetUniformValue("LodCameraPosition", cameraPosition);
+        material.SetUniformValue("LodMorphRange", morphRange);
+    }
+
+    // The renderer references the drawcalls, so they are all created before adding them
+    pass.drawcalls.clear();
+    pass.drawcalls.reserve(pass.chunks.size());
+    for (const Chunk& chunk : pass.chunks)
+    {
+        GLint first = static_cast<GLint>(chunk.firstElement * sizeof(unsigned int));
+        pass.drawcalls.emplace_back(Drawcall::Primitive::Triangles, chunk.elementCount, Data::Type::UInt, first, chunk.baseVertex);
+        pass.statistics.triangleCount += chunk.elementCount / 3;
+    }
+    pass.statistics.drawcallCount = static_cast<unsigned int>(pass.drawcalls.size());
+
+    // Vertices are in world space
+    unsigned int worldMatrixIndex = renderer.AddWorldMatrix(glm::mat4(1.0f));
+    for (size_t i = 0; i < pass.chunks.size(); ++i)
+    {
+        unsigned int level = pass.chunks[i].level;
+        renderer.AddDrawcall(collectionIndex, Renderer::DrawcallInfo(*pass.materials[level], worldMatrixIndex,
+            m_mesh.GetSubmeshVertexArray(level), pass.drawcalls[i]));
+    }
+}
+
+void ChunkedTerrain::UpdateRanges(LodPass& pass, const Camera& camera, float viewportHeight, float maxScreenError) const
+{
+    // A height error at distance d covers error * pixelScale / d pixels on screen
+    float pixelScale = camera.GetProjectionMatrix()[1][1] * viewportHeight * 0.5f;
+
+    pass.ranges.resize(m_levelCount);
+    float previousRange = 0.0f;
+    for (unsigned int level = 0; level + 1 < m_levelCount; ++level)
+    {
+        // The next level can be used from where its error is small enough
+        float range = m_levelErrors[level + 1] * pixelScale / maxScreenError;
+
+        // Nodes of this level must be fully morphed before they get next to the next level, and never next to the level after it
+        // The previous level reaches a diagonal of its nodes past its range, and that must be before this level starts morphing
+        float minRange = level > 0 ? previousRange + m_levelDiagonals[level - 1] / (1.0f - m_morphRatio) : m_levelDiagonals[0];
+        range = std::max(range, minRange);
+
+        pass.ranges[level] = range;
+        previousRange = range;
+    }
+    pass.ranges[m_levelCount - 1] = FLT_MAX;
+}
+
+bool ChunkedTerrain::SelectNode(LodPass& pass, unsigned int nodeIndex, const glm::vec3& cameraPosition) const
+{
+    const Node& node = m_nodes[nodeIndex];
+    AabbBounds bounds = m_nodeBounds.Get(nodeIndex);
+
+    // Too far for this level, the parent draws this part
+    if (!IntersectsSphere(bounds, cameraPosition, pass.ranges[node.level]))
+    {
+        return false;
+    }
+
+    // Handled, but there is nothing to draw
+    if (!m_visibleNodes[nodeIndex])
+    {
+        ++pass.statistics.culledCount;
+        return true;
+    }
+
+    // Draw the whole node if it has no children, or if they are too far for their level
+    if (node.level == 0 || !IntersectsSphere(bounds, cameraPosition, pass.ranges[node.level - 1]))
+    {
+        AddChunk(pass, node, 0, 4 * m_quadrantElementCount);
+        return true;
+    }
+
+    // Otherwise the children are drawn, and this node draws the quadrants of the children that are too far
+    for (unsigned int quadrant = 0; quadrant < 4; ++quadrant)
+    {
+        if (!SelectNode(pass, node.firstChild + quadrant, cameraPosition))
+        {
+            AddChunk(pass, node, quadrant * m_quadrantElementCount, m_quadrantElementCount);
+        }
+    }
+    return true;
+}
+
+void ChunkedTerrain::AddChunk(LodPass& pass, const Node& node, unsigned int firstElement, unsigned int elementCount) const
+{
+    // Consecutive quadrants of the same node are merged in a single drawcall
+    if (!pass.chunks.empty())
+    {
+        Chunk& lastChunk = pass.chunks.back();
+        if (lastChunk.baseVertex == node.baseVertex && lastChunk.level == node.level
+            && lastChunk.firstElement + lastChunk.elementCount == firstElement)
+        {
+            lastChunk.elementCount += elementCount;
+            return;
+        }
+    }
+    pass.chunks.push_back(Chunk{ node.level, node.baseVertex, firstElement, elementCount });
+}
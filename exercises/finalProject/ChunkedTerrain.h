@@ -0,0 +1,147 @@
+#pragma once
+
+#include <ituGL/geometry/Mesh.h>
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/scene/BoundsArray.h>
+#include <glm/vec3.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+class Camera;
+class Material;
+
+// Terrain split in a quadtree of chunks, drawn with continuous distance-dependent LOD (CDLOD)
+// All the chunks share one VBO with the full resolution grid, and each level has one EBO shared by all its chunks
+// Chunks are culled against the camera frustum, and their level keeps the error on screen under a number of pixels
+// Vertices morph to the height of the next level before the switch, so there are no cracks or pops (see terrainlod.glsl)
+class ChunkedTerrain
+{
+public:
+    struct Statistics
+    {
+        unsigned int drawcallCount = 0;
+        unsigned int triangleCount = 0;
+        unsigned int culledCount = 0;
+    };
+
+public:
+    ChunkedTerrain();
+
+    // The heightmap has (gridSize + 1) x (gridSize + 1) heights, and gridSize must be chunkSize times a power of 2
+    // Locations are the attributes of the materials
+    void Initialize(std::span<const float> heightmap, unsigned int gridSize, float cellSize, unsigned int chunkSize,
+        const Mesh::SemanticMap& locations);
+
+    inline unsigned int GetLevelCount() const { return m_levelCount; }
+    inline unsigned int GetNodeCount() const { return static_cast<unsigned int>(m_nodes.size()); }
+    // Triangles of a whole chunk, the same in all the levels
+    inline unsigned int GetChunkTriangleCount() const { return 4 * m_quadrantElementCount / 3; }
+    inline const glm::vec3& GetBoundsMin() const { return m_boundsMin; }
+    inline const glm::vec3& GetBoundsMax() const { return m_boundsMax; }
+
+    // Materials for the g-buffer and the shadow map, their shaders must include terrainlod.glsl
+    // Each level draws with a copy of the material, with its own morph uniforms
+    void SetMaterials(std::shared_ptr<const Material> material, std::shared_ptr<const Material> shadowMaterial);
+    std::shared_ptr<Material> GetLevelMaterial(unsigned int level) const;
+    std::shared_ptr<Material> GetShadowLevelMaterial(unsigned int level) const;
+
+    // Max error of the terrain on screen, in pixels
+    inline float GetMaxScreenError() const { return m_maxScreenError; }
+    inline void SetMaxScreenError(float maxScreenError) { m_maxScreenError = maxScreenError; }
+
+    // The shadow map allows 2^bias times the error on screen, so it uses coarser levels
+    inline float GetShadowLodBias() const { return m_shadowLodBias; }
+    inline void SetShadowLodBias(float shadowLodBias) { m_shadowLodBias = shadowLodBias; }
+
+    // Part of the range of each level where its vertices morph to the next level
+    inline float GetMorphRatio() const { return m_morphRatio; }
+    inline void SetMorphRatio(float morphRatio) { m_morphRatio = morphRatio; }
+
+    // Selects the chunks visible from the camera and adds their drawcalls to a collection of the renderer
+    // The drawcalls are referenced by the renderer, so this must be called again every frame
+    void AddDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera, float viewportHeight);
+
+    // Same for the shadow map. Chunks outside the camera frustum are kept if they can cast shadows into it
+    void AddShadowDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera, float viewportHeight,
+        const glm::vec3& lightDirection);
+
+    inline const Statistics& GetStatistics() const { return m_mainPass.statistics; }
+    inline const Statistics& GetShadowStatistics() const { return m_shadowPass.statistics; }
+
+private:
+    // Node of the quadtree. Its bounds are in m_nodeBounds, with the same index
+    struct Node
+    {
+        // Vertex of the chunk origin, added to the elements of the level EBO
+        unsigned int baseVertex;
+        unsigned int level;
+        // The 4 children are consecutive, in the same order as the quadrants in the EBO
+        unsigned int firstChild;
+    };
+
+    // Range of the level EBO drawn for a node, all of it or a quadrant
+    struct Chunk
+    {
+        unsigned int level;
+        unsigned int baseVertex;
+        unsigned int firstElement;
+        unsigned int elementCount;
+    };
+
+    // Selection, materials and drawcalls of one pass
+    struct LodPass
+    {
+        std::vector<std::shared_ptr<Material>> materials;
+        // Distance where each level switches to the next one
+        std::vector<float> ranges;
+        std::vector<Chunk> chunks;
+        std::vector<Drawcall> drawcalls;
+        Statistics statistics;
+    };
+
+private:
+    void InitializeNode(unsigned int nodeIndex, unsigned int level, unsigned int x, unsigned int y,
+        std::span<const float> heightmap, unsigned int& nextNodeIndex);
+
+    void UpdateRanges(LodPass& pass, const Camera& camera, float viewportHeight, float maxScreenError) const;
+    bool SelectNode(LodPass& pass, unsigned int nodeIndex, const glm::vec3& cameraPosition) const;
+    void AddChunk(LodPass& pass, const Node& node, unsigned int firstElement, unsigned int elementCount) const;
+
+    void AddPassDrawcalls(LodPass& pass, Renderer& renderer, unsigned int collectionIndex, const Camera& camera,
+        float viewportHeight, float maxScreenError, std::span<const BoundsPlane> planes);
+
+    static void CreateLevelMaterials(LodPass& pass, const Material& material, unsigned int levelCount);
+
+private:
+    // Full resolution VBO, and one VAO and EBO per level. Submesh i is level i
+    Mesh m_mesh;
+
+    unsigned int m_gridSize;
+    float m_cellSize;
+    unsigned int m_chunkSize;
+    unsigned int m_levelCount;
+
+    // Elements in a quadrant of a chunk, the same in all the levels
+    unsigned int m_quadrantElementCount;
+
+    std::vector<Node> m_nodes;
+    AabbArray m_nodeBounds;
+    // Result of the frustum test of each node, updated for each pass
+    std::vector<unsigned char> m_visibleNodes;
+
+    glm::vec3 m_boundsMin;
+    glm::vec3 m_boundsMax;
+
+    // Max height error of each level, compared to the full resolution
+    std::vector<float> m_levelErrors;
+    // Max diagonal of the nodes of each level
+    std::vector<float> m_levelDiagonals;
+
+    float m_maxScreenError;
+    float m_shadowLodBias;
+    float m_morphRatio;
+
+    LodPass m_mainPass;
+    LodPass m_shadowPass;
+};
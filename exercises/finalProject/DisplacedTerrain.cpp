@@ -0,0 +1,259 @@
+#include "DisplacedTerrain.h"
+
+#include <ituGL/geometry/VertexAttribute.h>
+#include <ituGL/geometry/MeshOptimizer.h>
+#include <ituGL/texture/Texture2DObject.h>
+#include <ituGL/camera/Camera.h>
+#include <ituGL/shader/Material.h>
+
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+    // Attribute locations, the same as in terraindisplaced.vert and terraindisplacedshadow.vert
+    constexpr GLuint GridPositionLocation = 0;
+    constexpr GLuint ChunkOriginLocation = 1;
+
+    // Integer grid coordinates, converted to float in the shader
+    constexpr VertexAttribute GridAttribute(Data::Type::UShort, 2);
+}
+
+DisplacedTerrain::DisplacedTerrain()
+    : m_heightRange(0.0f)
+    , m_gridElementCount(0)
+    , m_cellSize(0.0f)
+    , m_boundsMin(0.0f)
+    , m_boundsMax(0.0f)
+    , m_memorySize(0)
+    , m_vertexMemorySize(0)
+{
+}
+
+void DisplacedTerrain::Initialize(std::span<const float> heightmap, unsigned int gridSize, float cellSize, unsigned int chunkSize)
+{
+    unsigned int pitch = gridSize + 1;
+    assert(heightmap.size() == pitch * pitch);
+    assert(chunkSize > 0 && gridSize % chunkSize == 0 && pitch <= 65536);
+
+    m_cellSize = cellSize;
+
+    // Normalize the heights to 16 bits. The step is the height range / 65535, well under the precision of the noise
+    auto [minHeight, maxHeight] = std::minmax_element(heightmap.begin(), heightmap.end());
+    m_heightRange = glm::vec2(*minHeight, *maxHeight);
+    float heightScale = m_heightRange.y > m_heightRange.x ? 65535.0f / (m_heightRange.y - m_heightRange.x) : 0.0f;
+    std::vector<std::uint16_t> texels(heightmap.size());
+    for (size_t i = 0; i < heightmap.size(); ++i)
+    {
+        texels[i] = static_cast<std::uint16_t>(std::lround((heightmap[i] - m_heightRange.x) * heightScale));
+    }
+
+    // Rows of 2 byte texels are not multiple of 4 bytes
+    GLint unpackAlignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+
+    // The shader reads exact texels with texelFetch, the filters only make the texture complete
+    m_heightmapTexture = std::make_shared<Texture2DObject>();
+    m_heightmapTexture->Bind();
+    m_heightmapTexture->SetImage<std::uint16_t>(0, pitch, pitch, TextureObject::FormatR, TextureObject::InternalFormatR16, texels);
+    m_heightmapTexture->SetParameter(TextureObject::ParameterEnum::WrapS, GL_CLAMP_TO_EDGE);
+    m_heightmapTexture->SetParameter(TextureObject::ParameterEnum::WrapT, GL_CLAMP_TO_EDGE);
+    m_heightmapTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST);
+    m_heightmapTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
+    Texture2DObject::Unbind();
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+
+    // Flat grid of one chunk, with the same triangles as Terrain::CreateTerrainMesh
+    unsigned int chunkPitch = chunkSize + 1;
+    std::vector<glm::u16vec2> gridVertices;
+    gridVertices.reserve(chunkPitch * chunkPitch);
+    for (unsigned int y = 0; y < chunkPitch; ++y)
+    {
+        for (unsigned int x = 0; x < chunkPitch; ++x)
+        {
+            gridVertices.emplace_back(x, y);
+        }
+    }
+
+    std::vector<unsigned int> gridIndices;
+    for (unsigned int y = 0; y < chunkSize; ++y)
+    {
+        for (unsigned int x = 0; x < chunkSize; ++x)
+        {
+            unsigned int bottom_left = y * chunkPitch + x;
+            unsigned int bottom_right = bottom_left + 1;
+            unsigned int top_left = bottom_left + chunkPitch;
+            unsigned int top_right = top_left + 1;
+
+            gridIndices.insert(gridIndices.end(), { bottom_left, top_left, bottom_right });
+            gridIndices.insert(gridIndices.end(), { bottom_right, top_left, top_right });
+        }
+    }
+    MeshOptimizer::OptimizeVertexCache(gridIndices, static_cast<unsigned int>(gridVertices.size()));
+    m_gridElementCount = static_cast<unsigned int>(gridIndices.size());
+
+    // 16-bit elements, a chunk has less than 65536 vertices
+    assert(gridVertices.size() <= 65536);
+    std::vector<std::uint16_t> gridElements(gridIndices.begin(), gridIndices.end());
+
+    m_gridBuffer.Bind();
+    m_gridBuffer.AllocateData(std::span<const glm::u16vec2>(gridVertices));
+    VertexBufferObject::Unbind();
+
+    m_gridElements.Bind();
+    m_gridElements.AllocateData(std::span<const std::uint16_t>(gridElements));
+    ElementBufferObject::Unbind();
+
+    // Chunks and their bounds, from the heights of their vertices
+    unsigned int chunkCount = gridSize / chunkSize;
+    m_chunkOrigins.clear();
+    m_chunkBounds.Resize(chunkCount * chunkCount);
+    m_visibleChunks.resize(chunkCount * chunkCount);
+    m_boundsMin = glm::vec3(FLT_MAX);
+    m_boundsMax = glm::vec3(-FLT_MAX);
+    for (unsigned int chunkY = 0; chunkY < chunkCount; ++chunkY)
+    {
+        for (unsigned int chunkX = 0; chunkX < chunkCount; ++chunkX)
+        {
+            unsigned int x = chunkX * chunkSize;
+            unsigned int y = chunkY * chunkSize;
+
+            float chunkMinHeight = FLT_MAX;
+            float chunkMaxHeight = -FLT_MAX;
+            for (unsigned int j = y; j <= y + chunkSize; ++j)
+            {
+                for (unsigned int i = x; i <= x + chunkSize; ++i)
+                {
+                    chunkMinHeight = std::min(chunkMinHeight, heightmap[j * pitch + i]);
+                    chunkMaxHeight = std::max(chunkMaxHeight, heightmap[j * pitch + i]);
+                }
+            }
+
+            glm::vec3 boundsMin(x * cellSize, chunkMinHeight, y * cellSize);
+            glm::vec3 boundsMax((x + chunkSize) * cellSize, chunkMaxHeight, (y + chunkSize) * cellSize);
+            m_chunkBounds.Set(m_chunkOrigins.size(), (boundsMin + boundsMax) * 0.5f, (boundsMax - boundsMin) * 0.5f);
+            m_chunkOrigins.emplace_back(x, y);
+
+            m_boundsMin = glm::min(m_boundsMin, boundsMin);
+            m_boundsMax = glm::max(m_boundsMax, boundsMax);
+        }
+    }
+
+    InitializePass(m_mainPass);
+    InitializePass(m_shadowPass);
+
+    size_t instanceBufferSize = m_chunkOrigins.size() * sizeof(glm::u16vec2);
+    m_memorySize = texels.size() * sizeof(std::uint16_t)
+        + gridVertices.size() * sizeof(glm::u16vec2) + gridElements.size() * sizeof(std::uint16_t)
+        + 2 * instanceBufferSize;
+
+    // Same grid as the VBO of the chunked terrain: vec4 position, 3 vec3 and a vec2 per vertex
+    m_vertexMemorySize = heightmap.size() * (sizeof(glm::vec4) + 3 * sizeof(glm::vec3) + sizeof(glm::vec2));
+}
+
+void DisplacedTerrain::InitializePass(InstancePass& pass)
+{
+    // Enough room for all the chunks, updated every frame with the visible ones
+    pass.instanceBuffer.Bind();
+    pass.instanceBuffer.AllocateData(m_chunkOrigins.size() * sizeof(glm::u16vec2), BufferObject::Usage::DynamicDraw);
+
+    pass.vao.Bind();
+    pass.instanceBuffer.Bind();
+    pass.vao.SetAttribute(ChunkOriginLocation, GridAttribute, 0);
+    pass.vao.SetAttributeDivisor(ChunkOriginLocation, 1);
+    m_gridBuffer.Bind();
+    pass.vao.SetAttribute(GridPositionLocation, GridAttribute, 0);
+    m_gridElements.Bind();
+
+    VertexArrayObject::Unbind();
+    VertexBufferObject::Unbind();
+    ElementBufferObject::Unbind();
+
+    pass.instances.reserve(m_chunkOrigins.size());
+}
+
+void DisplacedTerrain::SetMaterials(std::shared_ptr<const Material> material, std::shared_ptr<const Material> shadowMaterial)
+{
+    auto CreatePassMaterial = [&](InstancePass& pass, const Material& passMaterial)
+    {
+        pass.material = std::make_shared<Material>(passMaterial);
+        pass.material->SetUniformValue("TerrainHeightmap", m_heightmapTexture);
+        pass.material->SetUniformValue("TerrainHeightRange", m_heightRange);
+        pass.material->SetUniformValue("TerrainCellSize", m_cellSize);
+    };
+    CreatePassMaterial(m_mainPass, *material);
+    CreatePassMaterial(m_shadowPass, *shadowMaterial);
+}
+
+void DisplacedTerrain::AddDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera)
+{
+    std::array<BoundsPlane, 6> planes;
+    ExtractFrustumPlanes(camera.GetViewProjectionMatrix(), planes);
+
+    AddPassDrawcalls(m_mainPass, renderer, collectionIndex, planes);
+}
+
+void DisplacedTerrain::AddShadowDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera, const glm::vec3& lightDirection)
+{
+    std::array<BoundsPlane, 6> frustumPlanes;
+    ExtractFrustumPlanes(camera.GetViewProjectionMatrix(), frustumPlanes);
+
+    // Chunks behind a plane can only cast shadows into the frustum if the light goes through that plane towards the inside
+    std::vector<BoundsPlane> planes;
+    for (const BoundsPlane& plane : frustumPlanes)
+    {
+        if (glm::dot(glm::vec3(plane), lightDirection) <= 0.0f)
+        {
+            planes.push_back(plane);
+        }
+    }
+
+    AddPassDrawcalls(m_shadowPass, renderer, collectionIndex, planes);
+}
+
+void DisplacedTerrain::AddPassDrawcalls(InstancePass& pass, Renderer& renderer, unsigned int collectionIndex, std::span<const BoundsPlane> planes)
+{
+    pass.statistics = Statistics();
+    if (m_chunkOrigins.empty() || !pass.material)
+    {
+        return;
+    }
+
+    m_chunkBounds.TestPlanes(planes, m_visibleChunks);
+
+    pass.instances.clear();
+    for (size_t i = 0; i < m_chunkOrigins.size(); ++i)
+    {
+        if (m_visibleChunks[i])
+        {
+            pass.instances.push_back(m_chunkOrigins[i]);
+        }
+    }
+    pass.statistics.culledCount = static_cast<unsigned int>(m_chunkOrigins.size() - pass.instances.size());
+    if (pass.instances.empty())
+    {
+        return;
+    }
+
+    pass.instanceBuffer.Bind();
+    pass.instanceBuffer.UpdateData(std::span<const glm::u16vec2>(pass.instances));
+    VertexBufferObject::Unbind();
+
+    unsigned int instanceCount = static_cast<unsigned int>(pass.instances.size());
+    pass.drawcall = Drawcall(Drawcall::Primitive::Triangles, m_gridElementCount, Data::Type::UShort);
+    pass.drawcall.SetInstanceCount(instanceCount);
+    pass.statistics.drawcallCount = 1;
+    pass.statistics.instanceCount = instanceCount;
+    pass.statistics.triangleCount = instanceCount * m_gridElementCount / 3;
+
+    // Vertices are displaced in world space
+    unsigned int worldMatrixIndex = renderer.AddWorldMatrix(glm::mat4(1.0f));
+    renderer.AddDrawcall(collectionIndex, Renderer::DrawcallInfo(*pass.material, worldMatrixIndex, pass.vao, pass.drawcall));
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <ituGL/geometry/VertexBufferObject.h>
+#include <ituGL/geometry/ElementBufferObject.h>
+#include <ituGL/geometry/VertexArrayObject.h>
+#include <ituGL/geometry/Drawcall.h>
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/scene/BoundsArray.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+class Camera;
+class Material;
+class Texture2DObject;
+
+// Terrain drawn from a heightmap texture, instead of a VBO with all the vertices
+// A single flat grid, the size of a chunk, is instanced for each visible chunk, and displaced in the vertex shader (see terrainheightmap.glsl)
+// The vertices only have their grid coordinates. Normals are reconstructed from the height differences in the texture
+// Moving the chunks only changes the instance buffer, the grid and the heightmap are not uploaded again
+class DisplacedTerrain
+{
+public:
+    struct Statistics
+    {
+        unsigned int drawcallCount = 0;
+        unsigned int instanceCount = 0;
+        unsigned int triangleCount = 0;
+        unsigned int culledCount = 0;
+    };
+
+public:
+    DisplacedTerrain();
+
+    // The heightmap has (gridSize + 1) x (gridSize + 1) heights, and gridSize must be a multiple of chunkSize
+    // Heights are stored in 16 bits, normalized between the min and max heights
+    void Initialize(std::span<const float> heightmap, unsigned int gridSize, float cellSize, unsigned int chunkSize);
+
+    inline const glm::vec3& GetBoundsMin() const { return m_boundsMin; }
+    inline const glm::vec3& GetBoundsMax() const { return m_boundsMax; }
+
+    // Bytes used on the GPU: heightmap texture, grid, and instance buffers
+    inline size_t GetMemorySize() const { return m_memorySize; }
+    // Bytes the same grid would use as a VBO of full vertices, like the chunked terrain
+    inline size_t GetVertexMemorySize() const { return m_vertexMemorySize; }
+
+    inline unsigned int GetChunkCount() const { return static_cast<unsigned int>(m_chunkOrigins.size()); }
+
+    // Materials for the g-buffer and the shadow map, their shaders must include terrainheightmap.glsl
+    // The terrain draws with copies of the materials, with the heightmap uniforms set
+    void SetMaterials(std::shared_ptr<const Material> material, std::shared_ptr<const Material> shadowMaterial);
+    inline std::shared_ptr<Material> GetMaterial() const { return m_mainPass.material; }
+    inline std::shared_ptr<Material> GetShadowMaterial() const { return m_shadowPass.material; }
+
+    // Adds one drawcall with an instance for each chunk visible from the camera
+    // The drawcall is referenced by the renderer, so this must be called again every frame
+    void AddDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera);
+
+    // Same for the shadow map. Chunks outside the camera frustum are kept if they can cast shadows into it
+    void AddShadowDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera, const glm::vec3& lightDirection);
+
+    inline const Statistics& GetStatistics() const { return m_mainPass.statistics; }
+    inline const Statistics& GetShadowStatistics() const { return m_shadowPass.statistics; }
+
+private:
+    // Each pass has its own instance buffer, so both can be drawn in the same frame
+    struct InstancePass
+    {
+        std::shared_ptr<Material> material;
+        VertexBufferObject instanceBuffer;
+        VertexArrayObject vao;
+        // Grid coordinates of the origin of the visible chunks
+        std::vector<glm::u16vec2> instances;
+        Drawcall drawcall;
+        Statistics statistics;
+    };
+
+private:
+    void InitializePass(InstancePass& pass);
+
+    void AddPassDrawcalls(InstancePass& pass, Renderer& renderer, unsigned int collectionIndex, std::span<const BoundsPlane> planes);
+
+private:
+    // Heights as R16, mapped to [m_heightRange.x, m_heightRange.y]
+    std::shared_ptr<Texture2DObject> m_heightmapTexture;
+    glm::vec2 m_heightRange;
+
+    // Grid of one chunk, with the grid coordinates of each vertex
+    VertexBufferObject m_gridBuffer;
+    ElementBufferObject m_gridElements;
+    unsigned int m_gridElementCount;
+
+    float m_cellSize;
+
+    // Origin and bounds of each chunk
+    std::vector<glm::u16vec2> m_chunkOrigins;
+    AabbArray m_chunkBounds;
+    // Result of the frustum test of each chunk, updated for each pass
+    std::vector<unsigned char> m_visibleChunks;
+
+    glm::vec3 m_boundsMin;
+    glm::vec3 m_boundsMax;
+
+    size_t m_memorySize;
+    size_t m_vertexMemorySize;
+
+    InstancePass m_mainPass;
+    InstancePass m_shadowPass;
+};
@@ -0,0 +1,264 @@
+#include "Foliage.h"
+
+#include <ituGL/geometry/Model.h>
+#include <ituGL/geometry/VertexAttribute.h>
+#include <ituGL/geometry/VertexLayout.h>
+#include <ituGL/geometry/TerrainHeightfield.h>
+#include <ituGL/camera/Camera.h>
+#include <ituGL/shader/Material.h>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <array>
+#include <cassert>
+#include <cfloat>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace
+{
+    // Attribute locations after the ones of the model vertices, the same as in foliage.vert and foliageshadow.vert
+    constexpr GLuint InstancePositionLocation = 5;
+    constexpr GLuint InstanceYawScaleLocation = 6;
+
+    constexpr VertexAttribute InstancePositionAttribute(Data::Type::Float, 3);
+    constexpr VertexAttribute InstanceYawScaleAttribute(Data::Type::Half, 2);
+
+    static_assert(sizeof(FoliageScatter::Instance) == 16);
+
+    struct GrassVertex
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec4 tangent;
+        glm::vec2 texCoord;
+    };
+
+    // No bitangent, the shader rebuilds it from the normal and the tangent
+    using GrassLayout = VertexLayout<GrassVertex,
+        ITUGL_VERTEX_ATTRIBUTE(GrassVertex, position, Position),
+        ITUGL_VERTEX_ATTRIBUTE(GrassVertex, normal, Normal),
+        ITUGL_VERTEX_ATTRIBUTE(GrassVertex, tangent, Tangent),
+        ITUGL_VERTEX_ATTRIBUTE(GrassVertex, texCoord, TexCoord0)>;
+
+    // Closest point of the box is inside the sphere
+    bool IntersectsSphere(const AabbBounds& bounds, const glm::vec3& center, float radius)
+    {
+        glm::vec3 offset = glm::clamp(center, bounds.GetMin(), bounds.GetMax()) - center;
+        return glm::dot(offset, offset) <= radius * radius;
+    }
+}
+
+Foliage::Foliage()
+    : m_boundsMin(FLT_MAX)
+    , m_boundsMax(-FLT_MAX)
+{
+}
+
+unsigned int Foliage::AddLayer(const std::string& name, std::shared_ptr<Model> model, const LayerSettings& settings,
+    const TerrainHeightfield& heightfield, JobSystem& jobSystem)
+{
+    std::unique_ptr<Layer> layer = std::make_unique<Layer>();
+    layer->name = name;
+    layer->model = model;
+    layer->settings = settings;
+
+    auto startTime = std::chrono::steady_clock::now();
+    std::vector<FoliageScatter::Instance> instances;
+    FoliageScatter::Scatter(heightfield, settings.scatter, settings.chunkSize, jobSystem, instances, layer->chunks);
+    layer->scatterTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    layer->instanceCount = static_cast<unsigned int>(instances.size());
+    if (!instances.empty())
+    {
+        layer->instanceBuffer.Bind();
+        layer->instanceBuffer.AllocateData(std::span<const FoliageScatter::Instance>(instances));
+        VertexBufferObject::Unbind();
+    }
+
+    // The model rotates around y, so it covers a circle of its furthest corner horizontally
+    glm::vec2 scaleRange = settings.scatter.scaleRange;
+    glm::vec2 modelCorner = glm::max(glm::abs(glm::vec2(settings.modelBoundsMin.x, settings.modelBoundsMin.z)),
+        glm::abs(glm::vec2(settings.modelBoundsMax.x, settings.modelBoundsMax.z)));
+    float radius = glm::length(modelCorner) * scaleRange.y;
+    float minOffset = glm::min(settings.modelBoundsMin.y * scaleRange.x, settings.modelBoundsMin.y * scaleRange.y);
+    float maxOffset = glm::max(settings.modelBoundsMax.y * scaleRange.x, settings.modelBoundsMax.y * scaleRange.y);
+
+    layer->chunkBounds.Resize(layer->chunks.size());
+    for (size_t i = 0; i < layer->chunks.size(); ++i)
+    {
+        const FoliageScatter::Chunk& chunk = layer->chunks[i];
+        glm::vec3 boundsMin = chunk.boundsMin + glm::vec3(-radius, minOffset, -radius);
+        glm::vec3 boundsMax = chunk.boundsMax + glm::vec3(radius, maxOffset, radius);
+        layer->chunkBounds.Set(i, (boundsMin + boundsMax) * 0.5f, (boundsMax - boundsMin) * 0.5f);
+        if (chunk.instanceCount > 0)
+        {
+            m_boundsMin = glm::min(m_boundsMin, boundsMin);
+            m_boundsMax = glm::max(m_boundsMax, boundsMax);
+        }
+    }
+    m_visibleChunks.resize(std::max(m_visibleChunks.size(), layer->chunks.size()));
+
+    unsigned int layerIndex = GetLayerCount();
+    m_layers.push_back(std::move(layer));
+    return layerIndex;
+}
+
+void Foliage::AddDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera)
+{
+    std::array<BoundsPlane, 6> planes;
+    ExtractFrustumPlanes(camera.GetViewProjectionMatrix(), planes);
+    glm::vec3 cameraPosition = camera.ExtractTranslation();
+
+    for (std::unique_ptr<Layer>& layer : m_layers)
+    {
+        AddPassDrawcalls(*layer, layer->mainPass, nullptr, renderer, collectionIndex, planes, cameraPosition);
+    }
+}
+
+void Foliage::AddShadowDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera, const glm::vec3& lightDirection)
+{
+    std::array<BoundsPlane, 6> frustumPlanes;
+    ExtractFrustumPlanes(camera.GetViewProjectionMatrix(), frustumPlanes);
+    glm::vec3 cameraPosition = camera.ExtractTranslation();
+
+    // Chunks behind a plane can only cast shadows into the frustum if the light goes through that plane towards the inside
+    std::vector<BoundsPlane> planes;
+    for (const BoundsPlane& plane : frustumPlanes)
+    {
+        if (glm::dot(glm::vec3(plane), lightDirection) <= 0.0f)
+        {
+            planes.push_back(plane);
+        }
+    }
+
+    for (std::unique_ptr<Layer>& layer : m_layers)
+    {
+        layer->shadowPass.statistics = Statistics();
+        if (layer->settings.castShadows && m_shadowMaterial)
+        {
+            AddPassDrawcalls(*layer, layer->shadowPass, m_shadowMaterial.get(), renderer, collectionIndex, planes, cameraPosition);
+        }
+    }
+}
+
+void Foliage::AddPassDrawcalls(Layer& layer, InstancePass& pass, const Material* material, Renderer& renderer, unsigned int collectionIndex,
+    std::span<const BoundsPlane> planes, const glm::vec3& cameraPosition)
+{
+    pass.statistics = Statistics();
+    if (layer.instanceCount == 0 || !UpdateInstancedMesh(layer))
+    {
+        return;
+    }
+
+    layer.chunkBounds.TestPlanes(planes, m_visibleChunks);
+
+    // Runs of consecutive visible chunks, as ranges of instances
+    std::vector<glm::uvec2> runs;
+    for (size_t i = 0; i < layer.chunks.size(); ++i)
+    {
+        const FoliageScatter::Chunk& chunk = layer.chunks[i];
+        if (chunk.instanceCount == 0)
+        {
+            continue;
+        }
+
+        if (!m_visibleChunks[i] || !IntersectsSphere(layer.chunkBounds.Get(i), cameraPosition, layer.settings.maxDistance))
+        {
+            pass.statistics.culledCount++;
+            continue;
+        }
+
+        // Empty chunks in between don't break the run, their instance range is empty
+        if (!runs.empty() && runs.back().x + runs.back().y == chunk.firstInstance)
+        {
+            runs.back().y += chunk.instanceCount;
+        }
+        else
+        {
+            runs.emplace_back(chunk.firstInstance, chunk.instanceCount);
+        }
+        pass.statistics.instanceCount += chunk.instanceCount;
+    }
+
+    // The renderer references the drawcalls, so they are all created before adding them
+    const Mesh& mesh = layer.model->GetMesh();
+    pass.drawcalls.clear();
+    pass.drawcalls.reserve(runs.size() * mesh.GetSubmeshCount());
+    for (unsigned int submeshIndex = 0; submeshIndex < mesh.GetSubmeshCount(); ++submeshIndex)
+    {
+        for (const glm::uvec2& run : runs)
+        {
+            Drawcall& drawcall = pass.drawcalls.emplace_back(mesh.GetSubmeshDrawcall(submeshIndex));
+            drawcall.SetBaseInstance(run.x);
+            drawcall.SetInstanceCount(run.y);
+        }
+    }
+    pass.statistics.drawcallCount = static_cast<unsigned int>(pass.drawcalls.size());
+
+    // The world matrix only has the transform of the quantized positions, the shader adds the transform of each instance
+    for (unsigned int submeshIndex = 0; submeshIndex < mesh.GetSubmeshCount(); ++submeshIndex)
+    {
+        unsigned int worldMatrixIndex = renderer.AddWorldMatrix(mesh.GetSubmeshPositionTransform(submeshIndex));
+        const Material& submeshMaterial = material ? *material : layer.model->GetMaterial(submeshIndex);
+        for (size_t i = 0; i < runs.size(); ++i)
+        {
+            renderer.AddDrawcall(collectionIndex, Renderer::DrawcallInfo(submeshMaterial, worldMatrixIndex,
+                mesh.GetSubmeshVertexArray(submeshIndex), pass.drawcalls[submeshIndex * runs.size() + i]));
+        }
+    }
+}
+
+bool Foliage::UpdateInstancedMesh(Layer& layer)
+{
+    if (!layer.model || !layer.model->HasMesh())
+    {
+        return false;
+    }
+
+    // The new mesh is created before the old one is released, so a reloaded mesh never has the address of the previous one
+    Mesh& mesh = layer.model->GetMesh();
+    if (&mesh != layer.instancedMesh)
+    {
+        constexpr GLsizei stride = sizeof(FoliageScatter::Instance);
+        for (unsigned int submeshIndex = 0; submeshIndex < mesh.GetSubmeshCount(); ++submeshIndex)
+        {
+            mesh.SetSubmeshInstanceAttribute(submeshIndex, layer.instanceBuffer, InstancePositionLocation,
+                InstancePositionAttribute, offsetof(FoliageScatter::Instance, position), stride);
+            mesh.SetSubmeshInstanceAttribute(submeshIndex, layer.instanceBuffer, InstanceYawScaleLocation,
+                InstanceYawScaleAttribute, offsetof(FoliageScatter::Instance, yaw), stride);
+        }
+        layer.instancedMesh = &mesh;
+    }
+    return true;
+}
+
+std::shared_ptr<Mesh> Foliage::CreateGrassMesh(const Mesh::SemanticMap& locations)
+{
+    constexpr unsigned int quadCount = 3;
+    constexpr float halfWidth = 0.3f;
+
+    std::vector<GrassVertex> vertices;
+    std::vector<std::uint16_t> indices;
+    for (unsigned int quad = 0; quad < quadCount; ++quad)
+    {
+        float angle = quad * glm::pi<float>() / quadCount;
+        glm::vec3 side(std::cos(angle) * halfWidth, 0.0f, std::sin(angle) * halfWidth);
+        glm::vec4 tangent(glm::normalize(side), 1.0f);
+
+        std::uint16_t first = static_cast<std::uint16_t>(vertices.size());
+        vertices.push_back({ -side, glm::vec3(0.0f, 1.0f, 0.0f), tangent, glm::vec2(0.0f, 0.0f) });
+        vertices.push_back({ side, glm::vec3(0.0f, 1.0f, 0.0f), tangent, glm::vec2(1.0f, 0.0f) });
+        vertices.push_back({ side + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), tangent, glm::vec2(1.0f, 1.0f) });
+        vertices.push_back({ -side + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), tangent, glm::vec2(0.0f, 1.0f) });
+
+        indices.insert(indices.end(), { first, std::uint16_t(first + 1), std::uint16_t(first + 2) });
+        indices.insert(indices.end(), { first, std::uint16_t(first + 2), std::uint16_t(first + 3) });
+    }
+
+    std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
+    mesh->AddSubmesh<GrassLayout, std::uint16_t>(Drawcall::Primitive::Triangles, vertices, indices, locations);
+    return mesh;
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <ituGL/geometry/VertexBufferObject.h>
+#include <ituGL/geometry/Drawcall.h>
+#include <ituGL/geometry/FoliageScatter.h>
+#include <ituGL/geometry/Mesh.h>
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/scene/BoundsArray.h>
+#include <glm/vec3.hpp>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+class Camera;
+class Material;
+class Model;
+class TerrainHeightfield;
+class JobSystem;
+
+// Instanced foliage scattered over the terrain, without scene nodes
+// Each layer draws a model at the instances of a FoliageScatter distribution. The instances are uploaded once, sorted by chunk,
+// so each run of consecutive visible chunks is a single instanced drawcall per submesh, starting at the first instance of the run
+// The model materials must use a shader that reads the instance attributes, like foliage.vert
+class Foliage
+{
+public:
+    struct LayerSettings
+    {
+        FoliageScatter::Settings scatter;
+
+        // Size of the chunks, the unit of culling
+        float chunkSize = 16.0f;
+
+        // Bounds of the model at scale 1, to extend the bounds of the chunks
+        glm::vec3 modelBoundsMin = glm::vec3(-1.0f);
+        glm::vec3 modelBoundsMax = glm::vec3(1.0f);
+
+        // Chunks further away from the camera are not drawn
+        float maxDistance = 1000.0f;
+
+        bool castShadows = true;
+    };
+
+    struct Statistics
+    {
+        unsigned int drawcallCount = 0;
+        unsigned int instanceCount = 0;
+        unsigned int culledCount = 0;
+    };
+
+public:
+    Foliage();
+
+    // Scatters the instances of a new layer and uploads them. Returns the index of the layer
+    // The model can still be loading, the layer is drawn when it has a mesh
+    unsigned int AddLayer(const std::string& name, std::shared_ptr<Model> model, const LayerSettings& settings,
+        const TerrainHeightfield& heightfield, JobSystem& jobSystem);
+
+    // Bounds of the instances of all the layers, with the size of the models
+    inline const glm::vec3& GetBoundsMin() const { return m_boundsMin; }
+    inline const glm::vec3& GetBoundsMax() const { return m_boundsMax; }
+
+    inline unsigned int GetLayerCount() const { return static_cast<unsigned int>(m_layers.size()); }
+    inline const std::string& GetLayerName(unsigned int layerIndex) const { return m_layers[layerIndex]->name; }
+    inline unsigned int GetLayerInstanceCount(unsigned int layerIndex) const { return m_layers[layerIndex]->instanceCount; }
+    inline unsigned int GetLayerChunkCount(unsigned int layerIndex) const { return static_cast<unsigned int>(m_layers[layerIndex]->chunks.size()); }
+    // Time to scatter the instances of the layer, in seconds
+    inline double GetLayerScatterTime(unsigned int layerIndex) const { return m_layers[layerIndex]->scatterTime; }
+    // Bytes of the instance buffer
+    inline size_t GetLayerMemorySize(unsigned int layerIndex) const { return m_layers[layerIndex]->instanceCount * sizeof(FoliageScatter::Instance); }
+    inline const Statistics& GetLayerStatistics(unsigned int layerIndex) const { return m_layers[layerIndex]->mainPass.statistics; }
+    inline const Statistics& GetLayerShadowStatistics(unsigned int layerIndex) const { return m_layers[layerIndex]->shadowPass.statistics; }
+
+    // Material of the shadow map drawcalls, for all the layers. Its shader must read the instance attributes, like foliageshadow.vert
+    inline void SetShadowMaterial(std::shared_ptr<const Material> shadowMaterial) { m_shadowMaterial = shadowMaterial; }
+
+    // Adds the drawcalls of the chunks visible from the camera
+    // The drawcalls are referenced by the renderer, so this must be called again every frame
+    void AddDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera);
+
+    // Same for the shadow map, for the layers that cast shadows. Chunks outside the camera frustum are kept if they can cast shadows into it
+    void AddShadowDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera, const glm::vec3& lightDirection);
+
+    // Grass tuft of 3 crossed quads, 1 unit tall, facing up so it is lit like the ground
+    static std::shared_ptr<Mesh> CreateGrassMesh(const Mesh::SemanticMap& locations);
+
+private:
+    struct InstancePass
+    {
+        std::vector<Drawcall> drawcalls;
+        Statistics statistics;
+    };
+
+    struct Layer
+    {
+        std::string name;
+        std::shared_ptr<Model> model;
+        LayerSettings settings;
+
+        // Mesh that has the instance attributes in its VAOs. A reloaded model has a new mesh, that needs them too
+        const Mesh* instancedMesh = nullptr;
+
+        VertexBufferObject instanceBuffer;
+        unsigned int instanceCount = 0;
+        double scatterTime = 0.0;
+
+        std::vector<FoliageScatter::Chunk> chunks;
+        // Bounds of the chunks, with the size of the model
+        AabbArray chunkBounds;
+
+        InstancePass mainPass;
+        InstancePass shadowPass;
+    };
+
+private:
+    void AddPassDrawcalls(Layer& layer, InstancePass& pass, const Material* material, Renderer& renderer, unsigned int collectionIndex,
+        std::span<const BoundsPlane> planes, const glm::vec3& cameraPosition);
+
+    // Adds the instance attributes to the VAOs of the model mesh, if they don't have them yet
+    static bool UpdateInstancedMesh(Layer& layer);
+
+private:
+    // Layers don't move, the renderer references their drawcalls
+    std::vector<std::unique_ptr<Layer>> m_layers;
+
+    std::shared_ptr<const Material> m_shadowMaterial;
+
+    // Empty, min over max, until a layer with instances is added
+    glm::vec3 m_boundsMin;
+    glm::vec3 m_boundsMax;
+
+    // Result of the frustum test of each chunk, updated for each layer and pass
+    std::vector<unsigned char> m_visibleChunks;
+};
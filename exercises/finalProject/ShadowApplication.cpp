@@ -3,8 +3,8 @@
 #include "Terrain.h"
 
 #include <ituGL/asset/TextureCubemapLoader.h>
-#include <ituGL/asset/ShaderLoader.h>
 #include <ituGL/asset/ModelLoader.h>
+#include <ituGL/asset/VirtualFileSystem.h>
 
 #include <ituGL/camera/Camera.h>
 #include <ituGL/scene/SceneCamera.h>
@@ -15,7 +15,10 @@
 
 #include <ituGL/shader/ShaderUniformCollection.h>
 #include <ituGL/shader/Material.h>
+#include <ituGL/shader/ShaderProgramVariants.h>
+#include <ituGL/shader/UniformBufferPool.h>
 #include <ituGL/geometry/Model.h>
+#include <ituGL/geometry/VertexQuantization.h>
 #include <ituGL/scene/SceneModel.h>
 
 #include <ituGL/renderer/SkyboxRenderPass.h>
@@ -25,18 +28,27 @@
 #include <ituGL/renderer/PostFXRenderPass.h>
 #include <ituGL/renderer/DebugRenderPass.h>
 #include <ituGL/scene/RendererSceneVisitor.h>
+#include <ituGL/core/JobSystem.h>
 
 #include <ituGL/scene/Transform.h>
 #include <ituGL/scene/ImGuiSceneVisitor.h>
 #include <imgui.h>
 
-#include <stb_image.h>
+#include <array>
+#include <cfloat>
 #include <iostream>
+#include <chrono>
+#include <filesystem>
 #include <glm/gtx/string_cast.hpp>
 
 ShadowApplication::ShadowApplication()
 	: Application(1024, 1024, "Shadow Scene Viewer demo")
 	, m_renderer(GetDevice())
+	, m_textureLoader(TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA)
+	, m_shaderBuildTime(0.0)
+	, m_cameraGroundOffset(1.5f)
+	, m_displacedTerrainEnabled(false)
+	, m_streamingTerrainEnabled(false)
 	, m_sceneFramebuffer(std::make_shared<FramebufferObject>())
 	, m_exposure(0.41f)
 	, m_contrast(1.0f)
@@ -47,6 +59,10 @@ ShadowApplication::ShadowApplication()
 	, m_bloomRange(1.0f, 2.0f)
 	, m_bloomIntensity(1.0f)
 	, m_terrainColor(1.0f)
+	, m_shadowPassIndex(-1)
+	, m_shadowCollectionIndex(0)
+	, m_shadowBoundsMin(0.0f)
+	, m_shadowBoundsMax(0.0f)
 {
 }
 
@@ -54,6 +70,12 @@ void ShadowApplication::Initialize()
 {
 	Application::Initialize();
 
+	// Read the assets from a pack, if one was built with the assetPacker tool. Files not in the pack are read from disk
+	if (std::filesystem::exists("assets.pak"))
+	{
+		VirtualFileSystem::GetDefault().Mount("assets.pak");
+	}
+
 	// Initialize DearImGUI
 	m_imGui.Initialize(GetMainWindow());
 
@@ -68,13 +90,100 @@ void ShadowApplication::Update()
 {
 	Application::Update();
 
+	// Upload the assets loaded in the background
+	m_loadQueue.Update();
+
+	// Reload the assets changed on disk
+	m_assetReloader.Update();
+
 	// Update camera controller
 	m_cameraController.Update(GetMainWindow(), GetDeltaTime());
 
+	// Keep the camera over the ground
+	if (std::shared_ptr<SceneCamera> sceneCamera = m_cameraController.GetCamera())
+	{
+		Transform& transform = *sceneCamera->GetTransform();
+		glm::vec3 translation = transform.GetTranslation();
+
+		// Stream the tiles around the camera before sampling them. Without a tile there, the camera is free
+		float groundHeight = -FLT_MAX;
+		if (m_streamingTerrainEnabled)
+		{
+			m_streamingTerrain.Update(translation);
+			m_streamingTerrain.SampleHeight(translation.x, translation.z, groundHeight);
+		}
+		else if (m_heightfield.Contains(translation.x, translation.z))
+		{
+			groundHeight = m_heightfield.SampleHeight(translation.x, translation.z);
+		}
+
+		if (translation.y < groundHeight + m_cameraGroundOffset)
+		{
+			translation.y = groundHeight + m_cameraGroundOffset;
+			transform.SetTranslation(translation);
+			sceneCamera->MatchCameraToTransform();
+		}
+	}
+
 	// Add the scene nodes to the renderer
 	RendererSceneVisitor rendererSceneVisitor(m_renderer);
-	m_scene.AcceptVisitor(rendererSceneVisitor);
+	m_scene.AcceptVisitorParallel(rendererSceneVisitor, JobSystem::GetDefault());
 
+	// The shadow map covers the streamed tiles, or the fixed terrain
+	if (m_mainLight && m_shadowPassIndex >= 0)
+	{
+		ShadowMapRenderPass* shadowMapRenderPass = static_cast<ShadowMapRenderPass*>(m_renderer.GetRenderPass(m_shadowPassIndex));
+		if (m_streamingTerrainEnabled)
+		{
+			shadowMapRenderPass->SetSceneAABBBounds(m_streamingTerrain.GetBoundsMin(), m_streamingTerrain.GetBoundsMax());
+		}
+		else
+		{
+			shadowMapRenderPass->SetSceneAABBBounds(m_shadowBoundsMin, m_shadowBoundsMax);
+		}
+	}
+
+	// Add the terrain chunks, selected for the current camera. The shadow map uses coarser chunks
+	if (m_renderer.HasCamera() && m_streamingTerrainEnabled)
+	{
+		const Camera& camera = m_renderer.GetCurrentCamera();
+		m_streamingTerrain.AddDrawcalls(m_renderer, 0, camera);
+		if (m_mainLight)
+		{
+			m_streamingTerrain.AddShadowDrawcalls(m_renderer, m_shadowCollectionIndex, camera, m_mainLight->GetDirection());
+		}
+	}
+	else if (m_renderer.HasCamera() && m_displacedTerrainEnabled)
+	{
+		const Camera& camera = m_renderer.GetCurrentCamera();
+		m_displacedTerrain.AddDrawcalls(m_renderer, 0, camera);
+		if (m_mainLight)
+		{
+			m_displacedTerrain.AddShadowDrawcalls(m_renderer, m_shadowCollectionIndex, camera, m_mainLight->GetDirection());
+		}
+	}
+	else if (m_renderer.HasCamera())
+	{
+		int width, height;
+		GetMainWindow().GetDimensions(width, height);
+		const Camera& camera = m_renderer.GetCurrentCamera();
+		m_terrain.AddDrawcalls(m_renderer, 0, camera, static_cast<float>(height));
+		if (m_mainLight)
+		{
+			m_terrain.AddShadowDrawcalls(m_renderer, m_shadowCollectionIndex, camera, static_cast<float>(height), m_mainLight->GetDirection());
+		}
+	}
+
+	// Add the foliage chunks visible from the camera. The foliage is only on the fixed terrain
+	if (m_renderer.HasCamera() && !m_streamingTerrainEnabled)
+	{
+		const Camera& camera = m_renderer.GetCurrentCamera();
+		m_foliage.AddDrawcalls(m_renderer, 0, camera);
+		if (m_mainLight)
+		{
+			m_foliage.AddShadowDrawcalls(m_renderer, m_shadowCollectionIndex, camera, m_mainLight->GetDirection());
+		}
+	}
 
 	if (GetMainWindow().IsKeyPressed(GLFW_KEY_T))
 	{
@@ -92,6 +201,9 @@ void ShadowApplication::Render()
 
 	GetDevice().Clear(true, Color(0.0f, 0.0f, 0.0f, 1.0f), true, 1.0f);
 
+	// Count the calls of the materials in this frame only
+	ShaderUniformCollection::ResetStatistics();
+
 	m_renderer.Render();
 	RenderGUI();
 }
@@ -125,33 +237,35 @@ void ShadowApplication::InitializeLights()
 
 void ShadowApplication::InitializeMaterials()
 {
+	// The g-buffer materials have their properties in a MaterialBlock. Copies of the materials share the pool
+	m_materialBufferPool = std::make_shared<UniformBufferPool>();
+
 	// Shadow map material
 	{
 		// Load and build shader
 		std::vector<const char*> vertexShaderPaths;
 		vertexShaderPaths.push_back("shaders/version330.glsl");
 		vertexShaderPaths.push_back("shaders/renderer/empty.vert");
-		Shader vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
 
 		std::vector<const char*> fragmentShaderPaths;
 		fragmentShaderPaths.push_back("shaders/version330.glsl");
 		fragmentShaderPaths.push_back("shaders/renderer/empty.frag");
-		Shader fragmentShader = ShaderLoader(Shader::FragmentShader).Load(fragmentShaderPaths);
-
-		std::shared_ptr<ShaderProgram> shaderProgramPtr = std::make_shared<ShaderProgram>();
-		shaderProgramPtr->Build(vertexShader, fragmentShader);
 
-		// Get transform related uniform locations
-		ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
-
-		// Register shader with renderer
-		m_renderer.RegisterShaderProgram(shaderProgramPtr,
-			[=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
+		// Register shader with renderer, again after it is rebuilt
+		std::shared_ptr<ShaderProgram> shaderProgramPtr = BuildShaderProgram(vertexShaderPaths, fragmentShaderPaths,
+			[this](std::shared_ptr<ShaderProgram> shaderProgramPtr)
 			{
-				shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
-			},
-			nullptr
-		);
+				// Get transform related uniform locations
+				ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
+
+				m_renderer.RegisterShaderProgram(shaderProgramPtr,
+					[=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool)
+					{
+						shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
+					},
+					nullptr
+				);
+			});
 
 		// Filter out uniforms that are not material properties
 		ShaderUniformCollection::NameSet filteredUniforms;
@@ -160,6 +274,7 @@ void ShadowApplication::InitializeMaterials()
 		// Create material
 		m_shadowMapMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
 		m_shadowMapMaterial->SetCullMode(Material::CullMode::Front);
+		m_assetReloader.AddMaterial(m_shadowMapMaterial);
 	}
 
 	// G-buffer material
@@ -168,38 +283,40 @@ void ShadowApplication::InitializeMaterials()
 		std::vector<const char*> vertexShaderPaths;
 		vertexShaderPaths.push_back("shaders/version330.glsl");
 		vertexShaderPaths.push_back("shaders/default.vert");
-		Shader vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
 
 		std::vector<const char*> fragmentShaderPaths;
 		fragmentShaderPaths.push_back("shaders/version330.glsl");
 		fragmentShaderPaths.push_back("shaders/utils.glsl");
 		fragmentShaderPaths.push_back("shaders/default.frag");
-		Shader fragmentShader = ShaderLoader(Shader::FragmentShader).Load(fragmentShaderPaths);
-
-		std::shared_ptr<ShaderProgram> shaderProgramPtr = std::make_shared<ShaderProgram>();
-		shaderProgramPtr->Build(vertexShader, fragmentShader);
-
-		// Get transform related uniform locations
-		ShaderProgram::Location worldViewMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewMatrix");
-		ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
 
-		// Register shader with renderer
-		m_renderer.RegisterShaderProgram(shaderProgramPtr,
-			[=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
+		// Register shader with renderer, again after it is rebuilt
+		std::shared_ptr<ShaderProgram> shaderProgramPtr = BuildShaderProgram(vertexShaderPaths, fragmentShaderPaths,
+			[this](std::shared_ptr<ShaderProgram> shaderProgramPtr)
 			{
-				shaderProgram.SetUniform(worldViewMatrixLocation, camera.GetViewMatrix() * worldMatrix);
-				shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
-			},
-			nullptr
-		);
+				// Get transform related uniform locations
+				ShaderProgram::Location worldViewMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewMatrix");
+				ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
+
+				m_renderer.RegisterShaderProgram(shaderProgramPtr,
+					[=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool)
+					{
+						shaderProgram.SetUniform(worldViewMatrixLocation, camera.GetViewMatrix() * worldMatrix);
+						shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
+					},
+					nullptr
+				);
+			});
 
 		// Filter out uniforms that are not material properties
 		ShaderUniformCollection::NameSet filteredUniforms;
 		filteredUniforms.insert("WorldViewMatrix");
 		filteredUniforms.insert("WorldViewProjMatrix");
+		filteredUniforms.insert("PrevWorldViewProjMatrix");
 
 		// Create material
 		m_defaultMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+		m_defaultMaterial->SetUniformBufferPool(m_materialBufferPool);
+		m_assetReloader.AddMaterial(m_defaultMaterial);
 		m_defaultMaterial->SetUniformValue("Color", glm::vec3(1.0f, 0.0f, 1.0f));
 		// Use default textures
 		m_default_colorTexture = LoadTexture("textures/Default_Albedo.jpg");
@@ -210,56 +327,306 @@ void ShadowApplication::InitializeMaterials()
 		m_defaultMaterial->SetUniformValue("SpecularTexture", m_default_specularTexture);
 	}
 
+	// Terrain g-buffer material, same as the default material with the vertices morphed between the terrain levels
+	{
+		// Load and build shader
+		std::vector<const char*> vertexShaderPaths;
+		vertexShaderPaths.push_back("shaders/version330.glsl");
+		vertexShaderPaths.push_back("shaders/terrainchunk.vert");
+
+		std::vector<const char*> fragmentShaderPaths;
+		fragmentShaderPaths.push_back("shaders/version330.glsl");
+		fragmentShaderPaths.push_back("shaders/utils.glsl");
+		fragmentShaderPaths.push_back("shaders/default.frag");
+
+		// Register shader with renderer, again after it is rebuilt
+		std::shared_ptr<ShaderProgram> shaderProgramPtr = BuildShaderProgram(vertexShaderPaths, fragmentShaderPaths,
+			[this](std::shared_ptr<ShaderProgram> shaderProgramPtr)
+			{
+				// Get transform related uniform locations
+				ShaderProgram::Location worldViewMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewMatrix");
+				ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
+
+				m_renderer.RegisterShaderProgram(shaderProgramPtr,
+					[=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool)
+					{
+						shaderProgram.SetUniform(worldViewMatrixLocation, camera.GetViewMatrix() * worldMatrix);
+						shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
+					},
+					nullptr
+				);
+			});
+
+		// Filter out uniforms that are not material properties
+		ShaderUniformCollection::NameSet filteredUniforms;
+		filteredUniforms.insert("WorldViewMatrix");
+		filteredUniforms.insert("WorldViewProjMatrix");
+		filteredUniforms.insert("PrevWorldViewProjMatrix");
+
+		// Create material. The terrain makes a copy for each level
+		m_terrainMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+		m_terrainMaterial->SetUniformBufferPool(m_materialBufferPool);
+		CreateTerrainMaterial(m_terrainMaterial);
+	}
+
+	// Terrain shadow map material
+	{
+		// Load and build shader
+		std::vector<const char*> vertexShaderPaths;
+		vertexShaderPaths.push_back("shaders/version330.glsl");
+		vertexShaderPaths.push_back("shaders/renderer/terrainshadow.vert");
+
+		std::vector<const char*> fragmentShaderPaths;
+		fragmentShaderPaths.push_back("shaders/version330.glsl");
+		fragmentShaderPaths.push_back("shaders/renderer/empty.frag");
+
+		// Register shader with renderer, again after it is rebuilt
+		std::shared_ptr<ShaderProgram> shaderProgramPtr = BuildShaderProgram(vertexShaderPaths, fragmentShaderPaths,
+			[this](std::shared_ptr<ShaderProgram> shaderProgramPtr)
+			{
+				// Get transform related uniform locations
+				ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
+
+				m_renderer.RegisterShaderProgram(shaderProgramPtr,
+					[=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool)
+					{
+						shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
+					},
+					nullptr
+				);
+			});
+
+		// Filter out uniforms that are not material properties
+		ShaderUniformCollection::NameSet filteredUniforms;
+		filteredUniforms.insert("WorldViewProjMatrix");
+
+		// Create material
+		m_terrainShadowMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+		m_terrainShadowMaterial->SetCullMode(Material::CullMode::Front);
+	}
+
+	// Displaced terrain g-buffer material, same as the terrain material with the vertices read from the heightmap texture
+	{
+		// Load and build shader
+		std::vector<const char*> vertexShaderPaths;
+		vertexShaderPaths.push_back("shaders/version330.glsl");
+		vertexShaderPaths.push_back("shaders/terraindisplaced.vert");
+
+		std::vector<const char*> fragmentShaderPaths;
+		fragmentShaderPaths.push_back("shaders/version330.glsl");
+		fragmentShaderPaths.push_back("shaders/utils.glsl");
+		fragmentShaderPaths.push_back("shaders/default.frag");
+
+		// Register shader with renderer, again after it is rebuilt
+		std::shared_ptr<ShaderProgram> shaderProgramPtr = BuildShaderProgram(vertexShaderPaths, fragmentShaderPaths,
+			[this](std::shared_ptr<ShaderProgram> shaderProgramPtr)
+			{
+				// Get transform related uniform locations
+				ShaderProgram::Location worldViewMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewMatrix");
+				ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
+
+				m_renderer.RegisterShaderProgram(shaderProgramPtr,
+					[=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool)
+					{
+						shaderProgram.SetUniform(worldViewMatrixLocation, camera.GetViewMatrix() * worldMatrix);
+						shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
+					},
+					nullptr
+				);
+			});
+
+		// Filter out uniforms that are not material properties
+		ShaderUniformCollection::NameSet filteredUniforms;
+		filteredUniforms.insert("WorldViewMatrix");
+		filteredUniforms.insert("WorldViewProjMatrix");
+		filteredUniforms.insert("PrevWorldViewProjMatrix");
+
+		// Create material. The terrain makes a copy with the heightmap
+		m_displacedTerrainMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+		m_displacedTerrainMaterial->SetUniformBufferPool(m_materialBufferPool);
+		CreateTerrainMaterial(m_displacedTerrainMaterial);
+	}
+
+	// Displaced terrain shadow map material
+	{
+		// Load and build shader
+		std::vector<const char*> vertexShaderPaths;
+		vertexShaderPaths.push_back("shaders/version330.glsl");
+		vertexShaderPaths.push_back("shaders/renderer/terraindisplacedshadow.vert");
+
+		std::vector<const char*> fragmentShaderPaths;
+		fragmentShaderPaths.push_back("shaders/version330.glsl");
+		fragmentShaderPaths.push_back("shaders/renderer/empty.frag");
+
+		// Register shader with renderer, again after it is rebuilt
+		std::shared_ptr<ShaderProgram> shaderProgramPtr = BuildShaderProgram(vertexShaderPaths, fragmentShaderPaths,
+			[this](std::shared_ptr<ShaderProgram> shaderProgramPtr)
+			{
+				// Get transform related uniform locations
+				ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
+
+				m_renderer.RegisterShaderProgram(shaderProgramPtr,
+					[=, this](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool)
+					{
+						shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
+					},
+					nullptr
+				);
+			});
+
+		// Filter out uniforms that are not material properties
+		ShaderUniformCollection::NameSet filteredUniforms;
+		filteredUniforms.insert("WorldViewProjMatrix");
+
+		// Create material
+		m_displacedTerrainShadowMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+		m_displacedTerrainShadowMaterial->SetCullMode(Material::CullMode::Front);
+	}
+
+	// Foliage g-buffer material, same as the default material with the transform of each instance
+	{
+		// Load and build shader
+		std::vector<const char*> vertexShaderPaths;
+		vertexShaderPaths.push_back("shaders/version330.glsl");
+		vertexShaderPaths.push_back("shaders/foliage.vert");
+
+		std::vector<const char*> fragmentShaderPaths;
+		fragmentShaderPaths.push_back("shaders/version330.glsl");
+		fragmentShaderPaths.push_back("shaders/utils.glsl");
+		fragmentShaderPaths.push_back("shaders/default.frag");
+
+		// Register shader with renderer, again after it is rebuilt
+		std::shared_ptr<ShaderProgram> shaderProgramPtr = BuildShaderProgram(vertexShaderPaths, fragmentShaderPaths,
+			[this](std::shared_ptr<ShaderProgram> shaderProgramPtr)
+			{
+				// Get transform related uniform locations
+				ShaderProgram::Location worldMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldMatrix");
+				ShaderProgram::Location viewMatrixLocation = shaderProgramPtr->GetUniformLocation("ViewMatrix");
+				ShaderProgram::Location viewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("ViewProjMatrix");
+				ShaderProgram::Location prevViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("PrevViewProjMatrix");
+
+				// The instance transform goes between the world matrix and the view, so they are set separately
+				m_renderer.RegisterShaderProgram(shaderProgramPtr,
+					[=, this](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
+					{
+						shaderProgram.SetUniform(worldMatrixLocation, worldMatrix);
+						if (cameraChanged)
+						{
+							shaderProgram.SetUniform(viewMatrixLocation, camera.GetViewMatrix());
+							shaderProgram.SetUniform(viewProjMatrixLocation, camera.GetViewProjectionMatrix());
+							shaderProgram.SetUniform(prevViewProjMatrixLocation, m_renderer.GetPreviousViewProjectionMatrix());
+						}
+					},
+					nullptr
+				);
+			});
+
+		// Filter out uniforms that are not material properties
+		ShaderUniformCollection::NameSet filteredUniforms;
+		filteredUniforms.insert("WorldMatrix");
+		filteredUniforms.insert("ViewMatrix");
+		filteredUniforms.insert("ViewProjMatrix");
+		filteredUniforms.insert("PrevViewProjMatrix");
+
+		// Create material. The foliage model loader copies it for each submaterial
+		m_foliageMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+		m_foliageMaterial->SetUniformBufferPool(m_materialBufferPool);
+		m_assetReloader.AddMaterial(m_foliageMaterial);
+		m_foliageMaterial->SetUniformValue("Color", glm::vec3(1.0f));
+		m_foliageMaterial->SetUniformValue("ColorTexture", m_default_colorTexture);
+		m_foliageMaterial->SetUniformValue("NormalTexture", m_default_normalTexture);
+		m_foliageMaterial->SetUniformValue("SpecularTexture", m_default_specularTexture);
+	}
+
+	// Foliage shadow map material
+	{
+		// Load and build shader
+		std::vector<const char*> vertexShaderPaths;
+		vertexShaderPaths.push_back("shaders/version330.glsl");
+		vertexShaderPaths.push_back("shaders/renderer/foliageshadow.vert");
+
+		std::vector<const char*> fragmentShaderPaths;
+		fragmentShaderPaths.push_back("shaders/version330.glsl");
+		fragmentShaderPaths.push_back("shaders/renderer/empty.frag");
+
+		// Register shader with renderer, again after it is rebuilt
+		std::shared_ptr<ShaderProgram> shaderProgramPtr = BuildShaderProgram(vertexShaderPaths, fragmentShaderPaths,
+			[this](std::shared_ptr<ShaderProgram> shaderProgramPtr)
+			{
+				// Get transform related uniform locations
+				ShaderProgram::Location worldMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldMatrix");
+				ShaderProgram::Location viewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("ViewProjMatrix");
+
+				m_renderer.RegisterShaderProgram(shaderProgramPtr,
+					[=, this](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool)
+					{
+						shaderProgram.SetUniform(worldMatrixLocation, worldMatrix);
+						shaderProgram.SetUniform(viewProjMatrixLocation, camera.GetViewProjectionMatrix());
+					},
+					nullptr
+				);
+			});
+
+		// Filter out uniforms that are not material properties
+		ShaderUniformCollection::NameSet filteredUniforms;
+		filteredUniforms.insert("WorldMatrix");
+		filteredUniforms.insert("ViewProjMatrix");
+
+		// Create material. Leaves and grass are thin, so both faces cast shadows
+		m_foliageShadowMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+		m_foliageShadowMaterial->SetCullMode(Material::CullMode::None);
+		m_assetReloader.AddMaterial(m_foliageShadowMaterial);
+	}
+
 	// Deferred material
 	{
 		std::vector<const char*> vertexShaderPaths;
 		vertexShaderPaths.push_back("shaders/version330.glsl");
 		vertexShaderPaths.push_back("shaders/renderer/deferred.vert");
-		Shader vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
 
 		std::vector<const char*> fragmentShaderPaths;
 		fragmentShaderPaths.push_back("shaders/version330.glsl");
-		fragmentShaderPaths.push_back("shaders/utils.glsl");
-		fragmentShaderPaths.push_back("shaders/lambert-ggx.glsl");
-		fragmentShaderPaths.push_back("shaders/lighting.glsl");
+		// Includes lighting.glsl and its dependencies
 		fragmentShaderPaths.push_back("shaders/renderer/deferred.frag");
-		Shader fragmentShader = ShaderLoader(Shader::FragmentShader).Load(fragmentShaderPaths);
 
-		std::shared_ptr<ShaderProgram> shaderProgramPtr = std::make_shared<ShaderProgram>();
-		shaderProgramPtr->Build(vertexShader, fragmentShader);
+		// Indirect light and shadows are compiled only in the variants of the lights that use them
+		std::array<const char*, 2> keywords = { "LIGHT_INDIRECT", "LIGHT_SHADOW" };
+		std::shared_ptr<ShaderProgramVariants> shaderVariants = std::make_shared<ShaderProgramVariants>(keywords,
+			[this, vertexShaderPaths, fragmentShaderPaths](ShaderProgram& shaderProgram, std::span<const std::string> defines) mutable
+			{
+				return BuildShaderProgram(shaderProgram, vertexShaderPaths, fragmentShaderPaths, defines);
+			});
+
+		// Register each variant with renderer when it is built
+		shaderVariants->SetVariantBuiltFunction(
+			[this](ShaderProgramVariants::KeywordMask, std::shared_ptr<ShaderProgram> shaderProgramPtr)
+			{
+				m_renderer.RegisterShaderProgram(shaderProgramPtr, GetFullscreenTransformFunction(shaderProgramPtr),
+					m_renderer.GetDefaultUpdateLightsFunction(*shaderProgramPtr));
+			});
+
+		// Build the common variants now, instead of on the first frame that uses them
+		shaderVariants->LoadManifest("shaders/renderer/deferred.variants");
+
+		// All the variants are rebuilt when the sources change, the keywords don't change which files are included
+		m_assetReloader.AddShaderVariants(shaderVariants, m_shaderProgramCache);
 
 		// Filter out uniforms that are not material properties
 		ShaderUniformCollection::NameSet filteredUniforms;
 		filteredUniforms.insert("InvViewMatrix");
 		filteredUniforms.insert("InvProjMatrix");
 		filteredUniforms.insert("WorldViewProjMatrix");
-		filteredUniforms.insert("LightIndirect");
 		filteredUniforms.insert("LightColor");
 		filteredUniforms.insert("LightPosition");
 		filteredUniforms.insert("LightDirection");
 		filteredUniforms.insert("LightAttenuation");
-
-		// Get transform related uniform locations
-		ShaderProgram::Location invViewMatrixLocation = shaderProgramPtr->GetUniformLocation("InvViewMatrix");
-		ShaderProgram::Location invProjMatrixLocation = shaderProgramPtr->GetUniformLocation("InvProjMatrix");
-		ShaderProgram::Location worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
-
-		// Register shader with renderer
-		m_renderer.RegisterShaderProgram(shaderProgramPtr,
-			[=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
-			{
-				if (cameraChanged)
-				{
-					shaderProgram.SetUniform(invViewMatrixLocation, glm::inverse(camera.GetViewMatrix()));
-					shaderProgram.SetUniform(invProjMatrixLocation, glm::inverse(camera.GetProjectionMatrix()));
-				}
-				shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
-			},
-			m_renderer.GetDefaultUpdateLightsFunction(*shaderProgramPtr)
-		);
+		filteredUniforms.insert("LightShadowMap");
+		filteredUniforms.insert("LightShadowMatrix");
+		filteredUniforms.insert("LightShadowBias");
 
 		// Create material
-		m_deferredMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+		m_deferredMaterial = std::make_shared<Material>(shaderVariants, filteredUniforms);
+		m_assetReloader.AddMaterial(m_deferredMaterial);
 	}
 }
 
@@ -276,8 +643,96 @@ void ShadowApplication::InitializeModels()
 	m_deferredMaterial->SetUniformValue("EnvironmentTexture", m_skyboxTexture);
 	m_deferredMaterial->SetUniformValue("EnvironmentMaxLod", maxLod);
 
-	// Configure loader
-	ModelLoader loader(m_defaultMaterial);
+	// Configure loaders. The foliage models get copies of the foliage material, that reads the instance transforms
+	ModelLoader& loader = m_modelLoader;
+	InitializeModelLoader(loader, m_defaultMaterial);
+	InitializeModelLoader(m_foliageModelLoader, m_foliageMaterial);
+	
+	// Generate terrain heightmap, and the chunks drawn with it
+	float terrainSize = 150.0f;
+	float terrainHeight = 50.0f;
+	unsigned int terrainGridSize = 256u;
+	float indexMultiplier = terrainSize / static_cast<float>(terrainGridSize - 1);
+	std::vector<float> heightmap = Terrain::CreateHeightMap(terrainGridSize + 1, terrainGridSize + 1, terrainHeight);
+	m_heightfield.Initialize(heightmap, terrainGridSize + 1, terrainGridSize + 1, glm::vec2(indexMultiplier));
+	m_terrain.Initialize(heightmap, terrainGridSize, indexMultiplier, 32u, loader.GetMaterialAttributeMap());
+	// Each level has its own copy of the materials, reloaded with the shaders
+	m_terrain.SetMaterials(m_terrainMaterial, m_terrainShadowMaterial);
+	for (unsigned int level = 0; level < m_terrain.GetLevelCount(); ++level)
+	{
+		m_assetReloader.AddMaterial(m_terrain.GetLevelMaterial(level));
+		m_assetReloader.AddMaterial(m_terrain.GetShadowLevelMaterial(level));
+	}
+
+	// The same heightmap in a texture, displacing a single grid instanced per chunk
+	m_displacedTerrain.Initialize(heightmap, terrainGridSize, indexMultiplier, 32u);
+	m_displacedTerrain.SetMaterials(m_displacedTerrainMaterial, m_displacedTerrainShadowMaterial);
+	m_assetReloader.AddMaterial(m_displacedTerrain.GetMaterial());
+	m_assetReloader.AddMaterial(m_displacedTerrain.GetShadowMaterial());
+
+	// Terrain without borders, with the same noise in tiles streamed around the camera, up to the far plane
+	StreamingTerrain::Settings streamingSettings;
+	streamingSettings.tileResolution = 64;
+	streamingSettings.cellSize = indexMultiplier;
+	streamingSettings.tileRadius = 4;
+	streamingSettings.lodDistance = 40.0f;
+	streamingSettings.skirtDepth = terrainHeight * 0.1f;
+	streamingSettings.noise.lacunarity = 1.9f;
+	streamingSettings.noise.gain = 0.5f;
+	streamingSettings.noise.octaves = 8;
+	streamingSettings.noise.height = terrainHeight;
+	streamingSettings.noiseScale = 1.0f / terrainSize;
+	m_streamingTerrain.Initialize(streamingSettings, loader.GetMaterialAttributeMap());
+	m_streamingTerrain.SetMaterials(m_terrainMaterial, m_terrainShadowMaterial);
+	m_assetReloader.AddMaterial(m_streamingTerrain.GetMaterial());
+	m_assetReloader.AddMaterial(m_streamingTerrain.GetShadowMaterial());
+
+	// Load tree model in the background. The foliage layer draws nothing until it is ready
+	std::shared_ptr<Model> treeModel = m_foliageModelLoader.LoadAsync("models/myTree/Tree.obj", m_loadQueue).Get();
+	m_assetReloader.AddModel(treeModel, "models/myTree/Tree.obj", m_foliageModelLoader);
+
+	// Trees, apart from each other and not on steep slopes
+	Foliage::LayerSettings treeSettings;
+	treeSettings.scatter.minDistance = 6.0f;
+	treeSettings.scatter.density = 0.6f;
+	treeSettings.scatter.maxSlope = 0.6f;
+	treeSettings.scatter.slopeFade = 0.15f;
+	treeSettings.scatter.scaleRange = glm::vec2(0.8f, 1.2f);
+	treeSettings.scatter.seed = 1;
+	treeSettings.chunkSize = 25.0f;
+	treeSettings.modelBoundsMin = glm::vec3(-2.0f, 0.0f, -2.0f);
+	treeSettings.modelBoundsMax = glm::vec3(2.0f, 5.0f, 2.0f);
+	m_foliage.AddLayer("Trees", treeModel, treeSettings, m_heightfield, JobSystem::GetDefault());
+
+	// Grass tufts, only drawn close to the camera and without shadows
+	std::shared_ptr<Material> grassMaterial = std::make_shared<Material>(*m_foliageMaterial);
+	grassMaterial->SetUniformValue("Color", glm::vec3(0.4f, 0.6f, 0.2f));
+	grassMaterial->SetCullMode(Material::CullMode::None);
+	m_assetReloader.AddMaterial(grassMaterial);
+	std::shared_ptr<Model> grassModel = std::make_shared<Model>(Foliage::CreateGrassMesh(m_foliageModelLoader.GetMaterialAttributeMap()));
+	grassModel->AddMaterial(grassMaterial);
+
+	Foliage::LayerSettings grassSettings;
+	grassSettings.scatter.minDistance = 0.2f;
+	grassSettings.scatter.maxSlope = 0.5f;
+	grassSettings.scatter.slopeFade = 0.15f;
+	grassSettings.scatter.maxHeight = terrainHeight * 0.6f;
+	grassSettings.scatter.heightFade = 5.0f;
+	grassSettings.scatter.scaleRange = glm::vec2(0.3f, 0.6f);
+	grassSettings.scatter.seed = 2;
+	grassSettings.chunkSize = 16.0f;
+	grassSettings.modelBoundsMin = glm::vec3(-0.3f, 0.0f, -0.3f);
+	grassSettings.modelBoundsMax = glm::vec3(0.3f, 1.0f, 0.3f);
+	grassSettings.maxDistance = 50.0f;
+	grassSettings.castShadows = false;
+	m_foliage.AddLayer("Grass", grassModel, grassSettings, m_heightfield, JobSystem::GetDefault());
+
+	m_foliage.SetShadowMaterial(m_foliageShadowMaterial);
+}
+
+void ShadowApplication::InitializeModelLoader(ModelLoader& loader, std::shared_ptr<Material> referenceMaterial)
+{
+	loader.SetReferenceMaterial(referenceMaterial);
 
 	// Create a new material copy for each submaterial
 	loader.SetCreateMaterials(true);
@@ -285,6 +740,9 @@ void ShadowApplication::InitializeModels()
 	// Flip vertically textures loaded by the model loader
 	loader.GetTexture2DLoader().SetFlipVertical(true);
 
+	// Quantize the vertices, default.vert and foliage.vert rebuild the bitangent
+	loader.SetCompactVertexFormat(true);
+
 	// Link vertex properties to attributes
 	loader.SetMaterialAttribute(VertexAttribute::Semantic::Position, "VertexPosition");
 	loader.SetMaterialAttribute(VertexAttribute::Semantic::Normal, "VertexNormal");
@@ -297,49 +755,6 @@ void ShadowApplication::InitializeModels()
 	loader.SetMaterialProperty(ModelLoader::MaterialProperty::DiffuseTexture, "ColorTexture");
 	loader.SetMaterialProperty(ModelLoader::MaterialProperty::NormalTexture, "NormalTexture");
 	loader.SetMaterialProperty(ModelLoader::MaterialProperty::SpecularTexture, "SpecularTexture");
-	
-	// Generate terrain model
-	std::shared_ptr<Mesh> terrainMesh = std::make_shared<Mesh>();
-	float terrainSize = 150.0f;
-	float terrainHeight = 50.0f;
-	unsigned int terrainGridSize = 256u;
-	float indexMultiplier = terrainSize / static_cast<float>(terrainGridSize - 1);
-	m_heightmap = Terrain::CreateTerrainMesh(terrainMesh, terrainGridSize, terrainGridSize, terrainHeight, terrainSize);
-	std::shared_ptr<Model> terrainModel = std::make_shared<Model>(terrainMesh);
-	// Add AABB info and add to scene
-	glm::vec3 terrainAABBMax = glm::vec3(terrainSize, terrainHeight * 0.5f, terrainSize);
-	glm::vec3 terrainAABBMin = glm::vec3(0.0f, -terrainHeight * 0.5f, 0.0f);
-	std::shared_ptr<SceneModel> terrainSceneModel = std::make_shared<SceneModel>("terrain", terrainModel, terrainAABBMin, terrainAABBMax);
-	m_scene.AddSceneNode(terrainSceneModel);
-	// Add material to terrain
-	m_terrainMaterial = std::make_shared<Material>(*m_defaultMaterial);
-	CreateTerrainMaterial(m_terrainMaterial);
-	terrainModel.get()->AddMaterial(m_terrainMaterial);
-
-	// Load tree model
-	std::shared_ptr<Model> treeModel = loader.LoadShared("models/myTree/Tree.obj");
-	glm::vec3 treeAABBExtents = glm::vec3(1.5f, 1.5f, 2.0f);
-	glm::vec3 treeAABBMin;
-	glm::vec3 treeAABBMax;
-	// Generate random distribution of trees
-	int distance = 25;
-	for (unsigned int x = 0u; x < terrainGridSize / distance; ++x) {
-		for (unsigned int y = 0u; y < terrainGridSize / distance; ++y) {
-			// Get name and position
-			std::string name("tree ");
-			name += std::to_string(y * distance + x);
-			glm::ivec2 treeCoords(distance * x + distance * GetRandomRange(-0.4f, 0.4f), distance * y + distance * GetRandomRange(-0.4f, 0.4f));
-			float height = m_heightmap[treeCoords.y * (terrainGridSize + 1) + treeCoords.x];
-			glm::vec3 position(treeCoords.x * indexMultiplier, height, treeCoords.y * indexMultiplier);
-			//
-			treeAABBMin = position - treeAABBExtents;
-			treeAABBMax = position + treeAABBExtents;
-			std::shared_ptr<SceneModel> sceneModel = std::make_shared<SceneModel>(name, treeModel, treeAABBMin, treeAABBMax);
-			//
-			sceneModel->GetTransform()->SetTranslation(position);
-			m_scene.AddSceneNode(sceneModel);
-		}
-	}
 }
 
 void ShadowApplication::InitializeFramebuffers()
@@ -395,10 +810,24 @@ void ShadowApplication::InitializeRenderer()
 			m_mainLight->CreateShadowMap(glm::vec2(2000, 2000));
 			m_mainLight->SetShadowBias(0.001f);
 		}
-		std::unique_ptr<ShadowMapRenderPass> shadowMapRenderPass(std::make_unique<ShadowMapRenderPass>(m_mainLight, m_shadowMapMaterial));
+		// The shadow pass has its own collection, for the terrain chunks of the shadow levels
+		m_shadowCollectionIndex = m_renderer.AddDrawcallCollection();
+		std::unique_ptr<ShadowMapRenderPass> shadowMapRenderPass(std::make_unique<ShadowMapRenderPass>(m_mainLight, m_shadowMapMaterial, m_shadowCollectionIndex));
+		for (unsigned int level = 0; level < m_terrain.GetLevelCount(); ++level)
+		{
+			shadowMapRenderPass->AddCasterMaterial(m_terrain.GetShadowLevelMaterial(level));
+		}
+		shadowMapRenderPass->AddCasterMaterial(m_displacedTerrain.GetShadowMaterial());
+		shadowMapRenderPass->AddCasterMaterial(m_streamingTerrain.GetShadowMaterial());
+		shadowMapRenderPass->AddCasterMaterial(m_foliageShadowMaterial);
+		// The terrain and the foliage are not in the scene, add their bounds
 		glm::vec3 min, max;
 		m_scene.GetAABBBounds(min, max);
+		min = glm::min(min, glm::min(m_terrain.GetBoundsMin(), m_foliage.GetBoundsMin()));
+		max = glm::max(max, glm::max(m_terrain.GetBoundsMax(), m_foliage.GetBoundsMax()));
 		shadowMapRenderPass->SetSceneAABBBounds(min, max);
+		m_shadowBoundsMin = min;
+		m_shadowBoundsMax = max;
 		m_shadowPassIndex = m_renderer.AddRenderPass(std::move(shadowMapRenderPass));
 	}
 
@@ -471,24 +900,67 @@ std::shared_ptr<Material> ShadowApplication::CreatePostFXMaterial(const char* fr
 	std::vector<const char*> vertexShaderPaths;
 	vertexShaderPaths.push_back("shaders/version330.glsl");
 	vertexShaderPaths.push_back("shaders/renderer/fullscreen.vert");
-	Shader vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
 
 	std::vector<const char*> fragmentShaderPaths;
 	fragmentShaderPaths.push_back("shaders/version330.glsl");
 	fragmentShaderPaths.push_back("shaders/utils.glsl");
 	fragmentShaderPaths.push_back(fragmentShaderPath);
-	Shader fragmentShader = ShaderLoader(Shader::FragmentShader).Load(fragmentShaderPaths);
 
-	std::shared_ptr<ShaderProgram> shaderProgramPtr = std::make_shared<ShaderProgram>();
-	shaderProgramPtr->Build(vertexShader, fragmentShader);
+	std::shared_ptr<ShaderProgram> shaderProgramPtr = BuildShaderProgram(vertexShaderPaths, fragmentShaderPaths);
 
 	// Create material
 	std::shared_ptr<Material> material = std::make_shared<Material>(shaderProgramPtr);
 	material->SetUniformValue("SourceTexture", sourceTexture);
+	m_assetReloader.AddMaterial(material);
 
 	return material;
 }
 
+std::shared_ptr<ShaderProgram> ShadowApplication::BuildShaderProgram(std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+	const ShaderProgramBuiltFunction& builtFunction)
+{
+	// Timed for the startup benchmark. Run twice to compare compiling with loading the cached binaries
+	auto startTime = std::chrono::steady_clock::now();
+
+	std::shared_ptr<ShaderProgram> shaderProgramPtr = std::make_shared<ShaderProgram>();
+	m_shaderProgramCache.Build(*shaderProgramPtr, vertexShaderPaths, fragmentShaderPaths);
+
+	m_shaderBuildTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	if (builtFunction)
+	{
+		builtFunction(shaderProgramPtr);
+	}
+
+	// Rebuild when any of the sources change. The paths are copied, the spans don't outlive this call
+	std::vector<const char*> vertexPaths(vertexShaderPaths.begin(), vertexShaderPaths.end());
+	std::vector<const char*> fragmentPaths(fragmentShaderPaths.begin(), fragmentShaderPaths.end());
+	AssetReloader::ReloadedFunction reloadedFunction;
+	if (builtFunction)
+	{
+		reloadedFunction = [builtFunction, shaderProgramPtr]() { builtFunction(shaderProgramPtr); };
+	}
+	m_assetReloader.AddShaderProgram(shaderProgramPtr, m_shaderProgramCache,
+		[this, vertexPaths, fragmentPaths](ShaderProgram& shaderProgram) mutable
+		{
+			return m_shaderProgramCache.Build(shaderProgram, vertexPaths, fragmentPaths);
+		},
+		reloadedFunction);
+
+	return shaderProgramPtr;
+}
+
+bool ShadowApplication::BuildShaderProgram(ShaderProgram& shaderProgram, std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+	std::span<const std::string> defines)
+{
+	auto startTime = std::chrono::steady_clock::now();
+
+	bool linked = m_shaderProgramCache.BuildWithDefines(shaderProgram, vertexShaderPaths, fragmentShaderPaths, defines);
+
+	m_shaderBuildTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	return linked;
+}
+
 Renderer::UpdateTransformsFunction ShadowApplication::GetFullscreenTransformFunction(std::shared_ptr<ShaderProgram> shaderProgramPtr) const
 {
 	// Get transform related uniform locations
@@ -519,6 +991,33 @@ void ShadowApplication::RenderGUI()
 	// Draw GUI for camera controller
 	m_cameraController.DrawGUI(m_imGui);
 
+	if (auto window = m_imGui.UseWindow("Startup"))
+	{
+		ImGui::Text("Shader programs: %.1f ms", m_shaderBuildTime * 1000.0);
+		ImGui::Text("Cached: %u, compiled: %u, rejected: %u", m_shaderProgramCache.GetHitCount(),
+			m_shaderProgramCache.GetMissCount(), m_shaderProgramCache.GetRejectedCount());
+		ImGui::Text("Assets reloaded: %u", m_assetReloader.GetReloadCount());
+
+		// Vertices of the models quantized on import, not the ones read from the cache
+		VertexQuantization::QualityReport report = m_modelLoader.GetQuantizationReport();
+		report.Merge(m_foliageModelLoader.GetQuantizationReport());
+		ImGui::Text("Quantized vertices: %zu KB -> %zu KB (%.0f%%)", report.GetSourceSize() / 1024, report.GetQuantizedSize() / 1024,
+			report.GetSizeRatio() * 100.0f);
+		ImGui::Text("Max errors: position %.4f, normal %.2f deg, tangent %.2f deg, texcoord %.5f", report.GetMaxPositionError(),
+			report.GetMaxNormalError(), report.GetMaxTangentError(), report.GetMaxTexCoordError());
+	}
+
+	if (auto window = m_imGui.UseWindow("Materials"))
+	{
+		ImGui::Text("Material blocks: %u, %zu bytes", m_materialBufferPool->GetAllocationCount(), m_materialBufferPool->GetAllocatedSize());
+		ImGui::Text("Uniform buffers: %u, %zu KB", m_materialBufferPool->GetPageCount(), m_materialBufferPool->GetMemorySize() / 1024);
+
+		const ShaderUniformCollection::Statistics& statistics = ShaderUniformCollection::GetStatistics();
+		ImGui::Text("Uniforms set: %u, skipped: %u", statistics.uniformCount, statistics.skippedUniformCount);
+		ImGui::Text("Texture binds: %u, skipped: %u", statistics.textureBindCount, statistics.skippedTextureBindCount);
+		ImGui::Text("Block uploads: %u", statistics.blockUploadCount);
+	}
+
 	if (auto window = m_imGui.UseWindow("Post FX"))
 	{
 		if (m_composeMaterial)
@@ -561,6 +1060,95 @@ void ShadowApplication::RenderGUI()
 	}
 
 
+	if (auto window = m_imGui.UseWindow("Terrain"))
+	{
+		ImGui::Checkbox("Infinite Terrain", &m_streamingTerrainEnabled);
+		ImGui::Checkbox("Heightmap Displacement", &m_displacedTerrainEnabled);
+		ImGui::SliderFloat("Camera Ground Offset", &m_cameraGroundOffset, 0.0f, 10.0f);
+
+		// Terrain point under the mouse cursor, from the ray between the near and far planes
+		if (std::shared_ptr<const SceneCamera> sceneCamera = m_cameraController.GetCamera())
+		{
+			glm::vec2 mousePosition = GetMainWindow().GetMousePosition(true);
+			glm::mat4 invViewProjMatrix = glm::inverse(sceneCamera->GetCamera()->GetViewProjectionMatrix());
+			glm::vec4 nearPoint = invViewProjMatrix * glm::vec4(mousePosition, -1.0f, 1.0f);
+			glm::vec4 farPoint = invViewProjMatrix * glm::vec4(mousePosition, 1.0f, 1.0f);
+			glm::vec3 rayOrigin = glm::vec3(nearPoint) / nearPoint.w;
+			glm::vec3 rayDirection = glm::vec3(farPoint) / farPoint.w - rayOrigin;
+
+			TerrainHeightfield::RayHit hit;
+			if (m_heightfield.Raycast(rayOrigin, rayDirection, 1.0f, hit))
+			{
+				ImGui::Text("Cursor: (%.2f, %.2f, %.2f)", hit.position.x, hit.position.y, hit.position.z);
+			}
+			else
+			{
+				ImGui::Text("Cursor: -");
+			}
+		}
+		ImGui::Separator();
+
+		if (m_streamingTerrainEnabled)
+		{
+			const StreamingTerrain::Statistics& statistics = m_streamingTerrain.GetStatistics();
+			const StreamingTerrain::Statistics& shadowStatistics = m_streamingTerrain.GetShadowStatistics();
+			const StreamingTerrain::StreamingStatistics& streamingStatistics = m_streamingTerrain.GetStreamingStatistics();
+			ImGui::Text("Drawcalls: %u, triangles: %u, culled: %u", statistics.drawcallCount, statistics.triangleCount, statistics.culledCount);
+			ImGui::Text("Shadow drawcalls: %u, triangles: %u, culled: %u", shadowStatistics.drawcallCount, shadowStatistics.triangleCount, shadowStatistics.culledCount);
+			ImGui::Text("Tiles: %u resident, %u pending, %u uploaded this frame", streamingStatistics.residentCount, streamingStatistics.pendingCount, streamingStatistics.uploadCount);
+			ImGui::Text("Tiles generated: %u, pool: %u of %.0f units", streamingStatistics.generatedCount, m_streamingTerrain.GetTileCount(),
+				m_streamingTerrain.GetTileSize());
+			ImGui::Text("GPU memory: %zu KB", m_streamingTerrain.GetMemorySize() / 1024);
+		}
+		else if (m_displacedTerrainEnabled)
+		{
+			const DisplacedTerrain::Statistics& statistics = m_displacedTerrain.GetStatistics();
+			const DisplacedTerrain::Statistics& shadowStatistics = m_displacedTerrain.GetShadowStatistics();
+			ImGui::Text("Instances: %u, triangles: %u, culled: %u", statistics.instanceCount, statistics.triangleCount, statistics.culledCount);
+			ImGui::Text("Shadow instances: %u, triangles: %u, culled: %u", shadowStatistics.instanceCount, shadowStatistics.triangleCount, shadowStatistics.culledCount);
+			ImGui::Text("Chunks: %u", m_displacedTerrain.GetChunkCount());
+			ImGui::Text("GPU memory: %zu KB (%zu KB with vertices)", m_displacedTerrain.GetMemorySize() / 1024, m_displacedTerrain.GetVertexMemorySize() / 1024);
+		}
+		else
+		{
+			const ChunkedTerrain::Statistics& statistics = m_terrain.GetStatistics();
+			const ChunkedTerrain::Statistics& shadowStatistics = m_terrain.GetShadowStatistics();
+			ImGui::Text("Levels: %u, nodes: %u, triangles per chunk: %u", m_terrain.GetLevelCount(), m_terrain.GetNodeCount(), m_terrain.GetChunkTriangleCount());
+			ImGui::Text("Drawcalls: %u, triangles: %u, culled: %u", statistics.drawcallCount, statistics.triangleCount, statistics.culledCount);
+			ImGui::Text("Shadow drawcalls: %u, triangles: %u, culled: %u", shadowStatistics.drawcallCount, shadowStatistics.triangleCount, shadowStatistics.culledCount);
+
+			ImGui::Separator();
+
+			float maxScreenError = m_terrain.GetMaxScreenError();
+			if (ImGui::SliderFloat("Max Screen Error", &maxScreenError, 0.5f, 16.0f))
+			{
+				m_terrain.SetMaxScreenError(maxScreenError);
+			}
+			float shadowLodBias = m_terrain.GetShadowLodBias();
+			if (ImGui::SliderFloat("Shadow LOD Bias", &shadowLodBias, 0.0f, 4.0f))
+			{
+				m_terrain.SetShadowLodBias(shadowLodBias);
+			}
+			float morphRatio = m_terrain.GetMorphRatio();
+			if (ImGui::SliderFloat("Morph Ratio", &morphRatio, 0.05f, 0.9f))
+			{
+				m_terrain.SetMorphRatio(morphRatio);
+			}
+		}
+
+		ImGui::Separator();
+		for (unsigned int layerIndex = 0; layerIndex < m_foliage.GetLayerCount(); ++layerIndex)
+		{
+			const Foliage::Statistics& statistics = m_foliage.GetLayerStatistics(layerIndex);
+			const Foliage::Statistics& shadowStatistics = m_foliage.GetLayerShadowStatistics(layerIndex);
+			ImGui::Text("%s: %u instances in %u chunks, %zu KB", m_foliage.GetLayerName(layerIndex).c_str(), m_foliage.GetLayerInstanceCount(layerIndex),
+				m_foliage.GetLayerChunkCount(layerIndex), m_foliage.GetLayerMemorySize(layerIndex) / 1024);
+			ImGui::Text("Scattered in %.1f ms", m_foliage.GetLayerScatterTime(layerIndex) * 1000.0);
+			ImGui::Text("Drawn: %u, drawcalls: %u, culled chunks: %u", statistics.instanceCount, statistics.drawcallCount, statistics.culledCount);
+			ImGui::Text("Shadow drawn: %u, drawcalls: %u", shadowStatistics.instanceCount, shadowStatistics.drawcallCount);
+		}
+	}
+
 	if (auto window = m_imGui.UseWindow("Shadow Debug"))
 	{
 		ImVec2 pos = ImGui::GetCursorScreenPos();
@@ -598,23 +1186,13 @@ void ShadowApplication::CreateTerrainMaterial(std::shared_ptr<Material> material
 
 std::shared_ptr<Texture2DObject> ShadowApplication::LoadTexture(const char* path)
 {
-	std::shared_ptr<Texture2DObject> texture = std::make_shared<Texture2DObject>();
-
-	int width = 0;
-	int height = 0;
-	int components = 0;
-
-	// Load the texture data here
-	unsigned char* data = stbi_load(path, &width, &height, &components, 4);
-
-	texture->Bind();
-	texture->SetImage(0, width, height, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA, std::span<const unsigned char>(data, width * height * 4));
-
-	// Generate mipmaps
-	texture->GenerateMipmap();
-
-	// Release texture data
-	stbi_image_free(data);
-
+	// The texture has a placeholder image until it is loaded
+	// Mipmaps are generated in the loading thread, so the upload is cheaper
+	m_textureLoader.SetGenerateMipmap(true);
+	m_textureLoader.SetCpuMipmap(true);
+	std::shared_ptr<Texture2DObject> texture = m_textureLoader.LoadSharedAsync(path, m_loadQueue).Get();
+
+	// Reloaded with the same loader when the image changes
+	m_assetReloader.AddTexture(texture, path, m_textureLoader);
 	return texture;
 }
\ No newline at end of file
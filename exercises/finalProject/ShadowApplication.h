@@ -6,13 +6,24 @@
 #include <ituGL/texture/FramebufferObject.h>
 #include <ituGL/renderer/Renderer.h>
 #include <ituGL/camera/CameraController.h>
+#include <ituGL/asset/ModelLoader.h>
+#include <ituGL/asset/Texture2DLoader.h>
+#include <ituGL/asset/AsyncLoadQueue.h>
+#include <ituGL/asset/ShaderProgramCache.h>
+#include <ituGL/asset/AssetReloader.h>
 #include <ituGL/utils/DearImGui.h>
+#include <ituGL/geometry/TerrainHeightfield.h>
+#include "ChunkedTerrain.h"
+#include "DisplacedTerrain.h"
+#include "StreamingTerrain.h"
+#include "Foliage.h"
 #include <array>
 
 class Texture2DObject;
 class TextureCubemapObject;
 class Material;
 class Light;
+class UniformBufferPool;
 
 class ShadowApplication : public Application
 {
@@ -30,18 +41,25 @@ private:
     void InitializeLights();
     void InitializeMaterials();
     void InitializeModels();
+    void InitializeModelLoader(ModelLoader& loader, std::shared_ptr<Material> referenceMaterial);
     void InitializeFramebuffers();
     void InitializeRenderer();
 
     std::shared_ptr<Material> CreatePostFXMaterial(const char* fragmentShaderPath, std::shared_ptr<Texture2DObject> sourceTexture = nullptr);
     void CreateTerrainMaterial(std::shared_ptr<Material> material);
     std::shared_ptr<Texture2DObject> LoadTexture(const char* path);
+    // Called after the program is built, and again when it is rebuilt because the sources changed
+    using ShaderProgramBuiltFunction = std::function<void(std::shared_ptr<ShaderProgram>)>;
+    std::shared_ptr<ShaderProgram> BuildShaderProgram(std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+        const ShaderProgramBuiltFunction& builtFunction = nullptr);
+    bool BuildShaderProgram(ShaderProgram& shaderProgram, std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+        std::span<const std::string> defines);
 
     Renderer::UpdateTransformsFunction GetFullscreenTransformFunction(std::shared_ptr<ShaderProgram> shaderProgramPtr) const;
 
     void RenderGUI();
 
-    static inline float GetRandom01() { return ((float)rand() / (RAND_MAX)) + 1; }
+    static inline float GetRandom01() { return (float)rand() / (RAND_MAX); }
     static inline float GetRandom(float max) { return max * GetRandom01(); }
     static inline float GetRandomRange(float min, float max) { return GetRandom01() * (max - min) + min; }
 
@@ -58,8 +76,43 @@ private:
     // Renderer
     Renderer m_renderer;
 
-    // Heightmap
-    std::vector<float> m_heightmap;
+    // Asset loaders. Declared before the load queue, so they outlive its pending loads
+    ModelLoader m_modelLoader;
+    // Creates the materials of the foliage models from the foliage material
+    ModelLoader m_foliageModelLoader;
+    Texture2DLoader m_textureLoader;
+
+    // Loads assets in the background, and uploads them in Update
+    AsyncLoadQueue m_loadQueue;
+
+    // Linked shader programs from previous runs
+    ShaderProgramCache m_shaderProgramCache;
+
+    // Time spent building shader programs at startup, in seconds
+    double m_shaderBuildTime;
+
+    // Reloads shaders, textures and models when their files change
+    AssetReloader m_assetReloader;
+
+    // Heightmap, for height queries and raycasts
+    TerrainHeightfield m_heightfield;
+
+    // Min height of the camera over the terrain
+    float m_cameraGroundOffset;
+
+    // Terrain chunks, drawn with continuous LOD from the heightmap
+    ChunkedTerrain m_terrain;
+
+    // Same terrain displaced from a heightmap texture, drawn instead of the chunks when enabled
+    DisplacedTerrain m_displacedTerrain;
+    bool m_displacedTerrainEnabled;
+
+    // Terrain without borders, streamed in tiles around the camera, drawn instead of the others when enabled
+    StreamingTerrain m_streamingTerrain;
+    bool m_streamingTerrainEnabled;
+
+    // Trees and grass scattered over the terrain, drawn instanced
+    Foliage m_foliage;
 
     // Skybox texture
     std::shared_ptr<TextureCubemapObject> m_skyboxTexture;
@@ -74,6 +127,14 @@ private:
     std::shared_ptr<Material> m_composeMaterial;
     std::shared_ptr<Material> m_bloomMaterial;
     std::shared_ptr<Material> m_terrainMaterial;
+    std::shared_ptr<Material> m_terrainShadowMaterial;
+    std::shared_ptr<Material> m_displacedTerrainMaterial;
+    std::shared_ptr<Material> m_displacedTerrainShadowMaterial;
+    std::shared_ptr<Material> m_foliageMaterial;
+    std::shared_ptr<Material> m_foliageShadowMaterial;
+
+    // Uniform buffer with the material blocks of the g-buffer materials, and of the copies made by the model loader
+    std::shared_ptr<UniformBufferPool> m_materialBufferPool;
 
     // Material properties
     std::shared_ptr<Texture2DObject> m_default_colorTexture;
@@ -102,4 +163,10 @@ private:
     float m_bloomIntensity;
 
     int m_shadowPassIndex;
+    // Drawcalls of the shadow pass, the terrain uses coarser chunks there
+    unsigned int m_shadowCollectionIndex;
+
+    // Bounds of the scene, the terrain and the foliage, for the shadow map. The streaming terrain has its own
+    glm::vec3 m_shadowBoundsMin;
+    glm::vec3 m_shadowBoundsMax;
 };
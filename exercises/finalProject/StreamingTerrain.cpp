@@ -0,0 +1,550 @@
+#include "StreamingTerrain.h"
+
+#include <ituGL/geometry/VertexLayout.h>
+#include <ituGL/geometry/MeshOptimizer.h>
+#include <ituGL/camera/Camera.h>
+#include <ituGL/shader/Material.h>
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_precision.hpp>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace
+{
+    // Texture coordinates are the grid coordinates, wrapped to keep their precision far from the origin
+    // The textures repeat on each cell, so any multiple of the tile resolution wraps without seams
+    constexpr std::int64_t TexCoordPeriod = 1024;
+
+    // Vertex of the grid at a position of the border, walking it counterclockwise seen from above, from the origin
+    glm::uvec2 GetBorderVertex(unsigned int borderIndex, unsigned int resolution)
+    {
+        unsigned int side = borderIndex / resolution;
+        unsigned int offset = borderIndex % resolution;
+        switch (side)
+        {
+        case 0: return glm::uvec2(offset, 0);
+        case 1: return glm::uvec2(resolution, offset);
+        case 2: return glm::uvec2(resolution - offset, resolution);
+        default: return glm::uvec2(0, resolution - offset);
+        }
+    }
+
+    // Closest point of the box, and the distance to it
+    float GetDistance(const AabbBounds& bounds, const glm::vec3& point)
+    {
+        return glm::distance(glm::clamp(point, bounds.GetMin(), bounds.GetMax()), point);
+    }
+}
+
+StreamingTerrain::StreamingTerrain()
+    : m_gridVertexCount(0)
+    , m_vertexCount(0)
+    , m_centerCoordinates(0)
+    , m_boundsMin(0.0f)
+    , m_boundsMax(0.0f)
+    , m_memorySize(0)
+{
+}
+
+StreamingTerrain::~StreamingTerrain()
+{
+    // Workers write to the tiles, they must finish before the tiles are destroyed
+    if (m_jobSystem)
+    {
+        for (std::unique_ptr<Tile>& tile : m_tiles)
+        {
+            m_jobSystem->Wait(tile->counter);
+        }
+    }
+}
+
+void StreamingTerrain::Initialize(const Settings& settings, const Mesh::SemanticMap& locations)
+{
+    assert(m_tiles.empty());
+    assert(std::has_single_bit(settings.tileResolution) && TexCoordPeriod % settings.tileResolution == 0);
+    assert(settings.levelCount >= 1 && (settings.tileResolution >> (settings.levelCount - 1)) >= 1);
+    assert(settings.workerCount > 0 && settings.maxPendingTiles > 0);
+
+    m_settings = settings;
+
+    unsigned int pitch = settings.tileResolution + 1;
+    m_gridVertexCount = pitch * pitch;
+    m_vertexCount = m_gridVertexCount + 4 * settings.tileResolution;
+    // 16-bit elements
+    assert(m_vertexCount <= 65536);
+
+    InitializeElements();
+
+    // Tiles in range, and one more row and column, for the tiles still generating when the camera moves to the next tile
+    unsigned int gridSize = 2 * settings.tileRadius + 1;
+    unsigned int tileCount = (gridSize + 1) * (gridSize + 1);
+    m_tiles.reserve(tileCount);
+    for (unsigned int i = 0; i < tileCount; ++i)
+    {
+        std::unique_ptr<Tile>& tile = m_tiles.emplace_back(std::make_unique<Tile>());
+        InitializeTile(*tile, locations);
+    }
+    m_tileBounds.Resize(tileCount);
+    m_visibleTiles.resize(tileCount);
+
+    m_tileGrid.assign(gridSize * gridSize, -1);
+    m_requestOrder.clear();
+    int radius = static_cast<int>(settings.tileRadius);
+    for (int y = -radius; y <= radius; ++y)
+    {
+        for (int x = -radius; x <= radius; ++x)
+        {
+            m_requestOrder.emplace_back(x, y);
+        }
+    }
+    std::stable_sort(m_requestOrder.begin(), m_requestOrder.end(), [](const glm::ivec2& a, const glm::ivec2& b)
+        {
+            return a.x * a.x + a.y * a.y < b.x * b.x + b.y * b.y;
+        });
+
+    unsigned int elementCount = m_levels.back().firstElement + m_levels.back().elementCount;
+    m_memorySize = tileCount * m_vertexCount * sizeof(Vertex) + elementCount * sizeof(std::uint16_t);
+
+    m_jobSystem = std::make_unique<JobSystem>(settings.workerCount);
+}
+
+void StreamingTerrain::InitializeElements()
+{
+    unsigned int resolution = m_settings.tileResolution;
+    unsigned int pitch = resolution + 1;
+    unsigned int borderCount = 4 * resolution;
+
+    std::vector<unsigned int> indices;
+    m_levels.clear();
+    for (unsigned int level = 0; level < m_settings.levelCount; ++level)
+    {
+        // Same triangles as Terrain::CreateTerrainMesh, with 2^level times the spacing
+        unsigned int step = 1u << level;
+        unsigned int cellCount = resolution / step;
+        std::vector<unsigned int> levelIndices;
+        for (unsigned int y = 0; y < cellCount; ++y)
+        {
+            for (unsigned int x = 0; x < cellCount; ++x)
+            {
+                unsigned int bottom_left = (y * pitch + x) * step;
+                unsigned int bottom_right = bottom_left + step;
+                unsigned int top_left = bottom_left + pitch * step;
+                unsigned int top_right = top_left + step;
+
+                levelIndices.insert(levelIndices.end(), { bottom_left, top_left, bottom_right });
+                levelIndices.insert(levelIndices.end(), { bottom_right, top_left, top_right });
+            }
+        }
+        MeshOptimizer::OptimizeVertexCache(levelIndices, m_gridVertexCount);
+
+        // Skirt along the border vertices of the level, facing out. Skirt vertices follow the grid, in border order
+        for (unsigned int border = 0; border < borderCount; border += step)
+        {
+            unsigned int nextBorder = (border + step) % borderCount;
+            glm::uvec2 vertex = GetBorderVertex(border, resolution);
+            glm::uvec2 nextVertex = GetBorderVertex(nextBorder, resolution);
+            unsigned int top = vertex.y * pitch + vertex.x;
+            unsigned int nextTop = nextVertex.y * pitch + nextVertex.x;
+            unsigned int bottom = m_gridVertexCount + border;
+            unsigned int nextBottom = m_gridVertexCount + nextBorder;
+
+            levelIndices.insert(levelIndices.end(), { top, nextTop, bottom });
+            levelIndices.insert(levelIndices.end(), { nextTop, nextBottom, bottom });
+        }
+
+        m_levels.push_back(Level{ static_cast<unsigned int>(indices.size()), static_cast<unsigned int>(levelIndices.size()) });
+        indices.insert(indices.end(), levelIndices.begin(), levelIndices.end());
+    }
+
+    std::vector<std::uint16_t> elements(indices.begin(), indices.end());
+    m_elements.Bind();
+    m_elements.AllocateData(std::span<const std::uint16_t>(elements));
+    ElementBufferObject::Unbind();
+}
+
+void StreamingTerrain::InitializeTile(Tile& tile, const Mesh::SemanticMap& locations)
+{
+    using Layout = VertexLayout<Vertex,
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, position, Position),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, normal, Normal),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, tangent, Tangent),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, bitangent, Bitangent),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, texCoord, TexCoord0)>;
+
+    // The worker buffers are allocated once, and reused by every tile generated here
+    unsigned int borderedPitch = m_settings.tileResolution + 3;
+    tile.heights.resize(borderedPitch * borderedPitch);
+    tile.tangentFrames.resize(borderedPitch * borderedPitch);
+    tile.vertices.resize(m_vertexCount);
+
+    tile.vbo.Bind();
+    tile.vbo.AllocateData(m_vertexCount * sizeof(Vertex));
+
+    // Same locations as the semantics in a Mesh, in order when they are not in the map
+    tile.vao.Bind();
+    GLuint location = 0;
+    for (const VertexAttribute::Layout* it = Layout::LayoutBegin(); it != Layout::LayoutEnd(); ++it)
+    {
+        const VertexAttribute& attribute = it->GetAttribute();
+        auto itLocation = locations.find(attribute.GetSemantic());
+        if (itLocation != locations.end())
+        {
+            location = itLocation->second;
+        }
+        tile.vao.SetAttribute(location, attribute, it->GetOffset(), it->GetStride());
+        location += attribute.GetLocationSize();
+    }
+    m_elements.Bind();
+
+    VertexArrayObject::Unbind();
+    VertexBufferObject::Unbind();
+    ElementBufferObject::Unbind();
+}
+
+void StreamingTerrain::SetMaterials(std::shared_ptr<const Material> material, std::shared_ptr<const Material> shadowMaterial)
+{
+    // Morph range past any distance, so the vertices never morph. Tiles switch levels as a whole, and the skirts hide the cracks
+    auto CreatePassMaterial = [&](TilePass& pass, const Material& passMaterial)
+    {
+        pass.material = std::make_shared<Material>(passMaterial);
+        pass.material->SetUniformValue("LodStep", 1.0f);
+        pass.material->SetUniformValue("LodCameraPosition", glm::vec3(0.0f));
+        pass.material->SetUniformValue("LodMorphRange", glm::vec2(FLT_MAX * 0.5f, FLT_MAX));
+    };
+    CreatePassMaterial(m_mainPass, *material);
+    CreatePassMaterial(m_shadowPass, *shadowMaterial);
+}
+
+int StreamingTerrain::GetGridIndex(const glm::ivec2& coordinates) const
+{
+    int radius = static_cast<int>(m_settings.tileRadius);
+    glm::ivec2 offset = coordinates - m_centerCoordinates + radius;
+    int gridSize = 2 * radius + 1;
+    if (offset.x < 0 || offset.y < 0 || offset.x >= gridSize || offset.y >= gridSize)
+    {
+        return -1;
+    }
+    return offset.y * gridSize + offset.x;
+}
+
+glm::vec3 StreamingTerrain::GetTileOrigin(const glm::ivec2& coordinates) const
+{
+    return glm::vec3(coordinates.x * GetTileSize(), 0.0f, coordinates.y * GetTileSize());
+}
+
+void StreamingTerrain::Update(const glm::vec3& cameraPosition)
+{
+    if (m_tiles.empty())
+    {
+        return;
+    }
+
+    float tileSize = GetTileSize();
+    m_centerCoordinates = glm::ivec2(static_cast<int>(std::floor(cameraPosition.x / tileSize)),
+        static_cast<int>(std::floor(cameraPosition.z / tileSize)));
+
+    // Tiles out of range go back to the pool. Tiles still generating wait for their worker
+    unsigned int pendingCount = 0;
+    for (std::unique_ptr<Tile>& tile : m_tiles)
+    {
+        if (tile->state == TileState::Generating && tile->counter.IsDone())
+        {
+            tile->state = TileState::Generated;
+            ++m_streamingStatistics.generatedCount;
+        }
+        if (tile->state != TileState::Free && tile->state != TileState::Generating && GetGridIndex(tile->coordinates) < 0)
+        {
+            tile->state = TileState::Free;
+        }
+        if (tile->state == TileState::Generating)
+        {
+            ++pendingCount;
+        }
+    }
+
+    std::fill(m_tileGrid.begin(), m_tileGrid.end(), -1);
+    for (unsigned int tileIndex = 0; tileIndex < m_tiles.size(); ++tileIndex)
+    {
+        const Tile& tile = *m_tiles[tileIndex];
+        int gridIndex = GetGridIndex(tile.coordinates);
+        if (tile.state != TileState::Free && gridIndex >= 0)
+        {
+            m_tileGrid[gridIndex] = static_cast<int>(tileIndex);
+        }
+    }
+
+    // Request the missing tiles, closest first. Few at a time, so the workers don't start with the furthest ones
+    unsigned int freeTileIndex = 0;
+    for (const glm::ivec2& offset : m_requestOrder)
+    {
+        if (pendingCount >= m_settings.maxPendingTiles)
+        {
+            break;
+        }
+
+        glm::ivec2 coordinates = m_centerCoordinates + offset;
+        int gridIndex = GetGridIndex(coordinates);
+        if (m_tileGrid[gridIndex] >= 0)
+        {
+            continue;
+        }
+
+        while (freeTileIndex < m_tiles.size() && m_tiles[freeTileIndex]->state != TileState::Free)
+        {
+            ++freeTileIndex;
+        }
+        if (freeTileIndex == m_tiles.size())
+        {
+            break;
+        }
+
+        Tile& tile = *m_tiles[freeTileIndex];
+        tile.state = TileState::Generating;
+        tile.coordinates = coordinates;
+        m_jobSystem->Schedule([this, &tile]() { GenerateTile(tile); }, &tile.counter);
+        m_tileGrid[gridIndex] = static_cast<int>(freeTileIndex);
+        ++pendingCount;
+    }
+
+    // Upload the generated tiles, closest first, up to the budget of the frame
+    m_streamingStatistics.uploadCount = 0;
+    for (const glm::ivec2& offset : m_requestOrder)
+    {
+        if (m_streamingStatistics.uploadCount >= m_settings.uploadsPerFrame)
+        {
+            break;
+        }
+
+        int tileIndex = m_tileGrid[GetGridIndex(m_centerCoordinates + offset)];
+        if (tileIndex >= 0 && m_tiles[tileIndex]->state == TileState::Generated)
+        {
+            UploadTile(static_cast<unsigned int>(tileIndex));
+            ++m_streamingStatistics.uploadCount;
+        }
+    }
+
+    m_streamingStatistics.residentCount = 0;
+    m_streamingStatistics.pendingCount = 0;
+    m_boundsMin = glm::vec3(FLT_MAX);
+    m_boundsMax = glm::vec3(-FLT_MAX);
+    for (unsigned int tileIndex = 0; tileIndex < m_tiles.size(); ++tileIndex)
+    {
+        TileState state = m_tiles[tileIndex]->state;
+        if (state == TileState::Resident)
+        {
+            ++m_streamingStatistics.residentCount;
+            AabbBounds bounds = m_tileBounds.Get(tileIndex);
+            m_boundsMin = glm::min(m_boundsMin, bounds.GetMin());
+            m_boundsMax = glm::max(m_boundsMax, bounds.GetMax());
+        }
+        else if (state != TileState::Free)
+        {
+            ++m_streamingStatistics.pendingCount;
+        }
+    }
+    if (m_streamingStatistics.residentCount == 0)
+    {
+        m_boundsMin = m_boundsMax = glm::vec3(0.0f);
+    }
+}
+
+void StreamingTerrain::GenerateTile(Tile& tile) const
+{
+    unsigned int resolution = m_settings.tileResolution;
+    unsigned int pitch = resolution + 1;
+    unsigned int borderedPitch = resolution + 3;
+    float cellSize = m_settings.cellSize;
+
+    // Noise at the world coordinates of the samples, one cell outside the tile on each side
+    // Computed in double from the grid coordinates, so tiles far from the origin keep the precision of their position
+    HeightfieldGenerator::NoiseSettings noise = m_settings.noise;
+    glm::i64vec2 firstSample = glm::i64vec2(tile.coordinates) * static_cast<std::int64_t>(resolution) - std::int64_t(1);
+    glm::i64vec2 lastSample = firstSample + static_cast<std::int64_t>(borderedPitch - 1);
+    double noiseScale = static_cast<double>(cellSize) * m_settings.noiseScale;
+    noise.noiseMin = glm::vec2(glm::dvec2(firstSample) * noiseScale);
+    noise.noiseMax = glm::vec2(glm::dvec2(lastSample) * noiseScale);
+    HeightfieldGenerator::Generate(tile.heights, borderedPitch, borderedPitch, noise, *m_jobSystem);
+
+    HeightfieldGenerator::ComputeTangentFrames(tile.heights, borderedPitch, borderedPitch, glm::vec2(cellSize), tile.tangentFrames,
+        offsetof(TangentFrame, normal), offsetof(TangentFrame, tangent), offsetof(TangentFrame, bitangent), *m_jobSystem);
+
+    // Vertices relative to the tile origin, without the border
+    glm::vec2 texCoordOrigin(glm::i64vec2(tile.coordinates) * static_cast<std::int64_t>(resolution) % TexCoordPeriod);
+    texCoordOrigin = glm::mod(texCoordOrigin + static_cast<float>(TexCoordPeriod), static_cast<float>(TexCoordPeriod));
+    float minHeight = FLT_MAX;
+    float maxHeight = -FLT_MAX;
+    for (unsigned int j = 0; j < pitch; ++j)
+    {
+        for (unsigned int i = 0; i < pitch; ++i)
+        {
+            unsigned int borderedIndex = (j + 1) * borderedPitch + i + 1;
+            float height = tile.heights[borderedIndex];
+            const TangentFrame& frame = tile.tangentFrames[borderedIndex];
+
+            Vertex& vertex = tile.vertices[j * pitch + i];
+            vertex.position = glm::vec4(i * cellSize, height, j * cellSize, height);
+            vertex.normal = frame.normal;
+            vertex.tangent = frame.tangent;
+            vertex.bitangent = frame.bitangent;
+            vertex.texCoord = texCoordOrigin + glm::vec2(i, j);
+
+            minHeight = std::min(minHeight, height);
+            maxHeight = std::max(maxHeight, height);
+        }
+    }
+
+    // Skirt vertices hang below the border, with the same attributes
+    for (unsigned int border = 0; border < 4 * resolution; ++border)
+    {
+        glm::uvec2 gridVertex = GetBorderVertex(border, resolution);
+        Vertex& vertex = tile.vertices[m_gridVertexCount + border];
+        vertex = tile.vertices[gridVertex.y * pitch + gridVertex.x];
+        vertex.position.y -= m_settings.skirtDepth;
+        vertex.position.w = vertex.position.y;
+    }
+
+    tile.heightRange = glm::vec2(minHeight, maxHeight);
+}
+
+void StreamingTerrain::UploadTile(unsigned int tileIndex)
+{
+    Tile& tile = *m_tiles[tileIndex];
+    assert(tile.state == TileState::Generated);
+
+    // Same size as allocated, only the data changes
+    tile.vbo.Bind();
+    tile.vbo.UpdateData(std::span<const Vertex>(tile.vertices));
+    VertexBufferObject::Unbind();
+
+    glm::vec3 origin = GetTileOrigin(tile.coordinates);
+    glm::vec3 boundsMin = origin + glm::vec3(0.0f, tile.heightRange.x - m_settings.skirtDepth, 0.0f);
+    glm::vec3 boundsMax = origin + glm::vec3(GetTileSize(), tile.heightRange.y, GetTileSize());
+    m_tileBounds.Set(tileIndex, (boundsMin + boundsMax) * 0.5f, (boundsMax - boundsMin) * 0.5f);
+
+    tile.state = TileState::Resident;
+}
+
+bool StreamingTerrain::SampleHeight(float x, float z, float& height) const
+{
+    if (m_tiles.empty())
+    {
+        return false;
+    }
+
+    float tileSize = GetTileSize();
+    glm::ivec2 coordinates(static_cast<int>(std::floor(x / tileSize)), static_cast<int>(std::floor(z / tileSize)));
+    int gridIndex = GetGridIndex(coordinates);
+    int tileIndex = gridIndex >= 0 ? m_tileGrid[gridIndex] : -1;
+    if (tileIndex < 0 || m_tiles[tileIndex]->state != TileState::Resident)
+    {
+        return false;
+    }
+
+    // Bilinear, in the cell of the point, like the triangles of the grid within their error
+    const Tile& tile = *m_tiles[tileIndex];
+    glm::vec3 origin = GetTileOrigin(coordinates);
+    unsigned int resolution = m_settings.tileResolution;
+    glm::vec2 gridPosition = glm::clamp(glm::vec2(x - origin.x, z - origin.z) / m_settings.cellSize, glm::vec2(0.0f), glm::vec2(resolution));
+    glm::uvec2 cell = glm::min(glm::uvec2(gridPosition), glm::uvec2(resolution - 1));
+    glm::vec2 t = gridPosition - glm::vec2(cell);
+
+    unsigned int borderedPitch = resolution + 3;
+    auto GetHeight = [&](unsigned int i, unsigned int j) { return tile.heights[(j + 1) * borderedPitch + i + 1]; };
+    float bottom = glm::mix(GetHeight(cell.x, cell.y), GetHeight(cell.x + 1, cell.y), t.x);
+    float top = glm::mix(GetHeight(cell.x, cell.y + 1), GetHeight(cell.x + 1, cell.y + 1), t.x);
+    height = glm::mix(bottom, top, t.y);
+    return true;
+}
+
+void StreamingTerrain::AddDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera)
+{
+    std::array<BoundsPlane, 6> planes;
+    ExtractFrustumPlanes(camera.GetViewProjectionMatrix(), planes);
+
+    AddPassDrawcalls(m_mainPass, renderer, collectionIndex, camera, 0, planes);
+}
+
+void StreamingTerrain::AddShadowDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera, const glm::vec3& lightDirection)
+{
+    std::array<BoundsPlane, 6> frustumPlanes;
+    ExtractFrustumPlanes(camera.GetViewProjectionMatrix(), frustumPlanes);
+
+    // Tiles behind a plane can only cast shadows into the frustum if the light goes through that plane towards the inside
+    std::vector<BoundsPlane> planes;
+    for (const BoundsPlane& plane : frustumPlanes)
+    {
+        if (glm::dot(glm::vec3(plane), lightDirection) <= 0.0f)
+        {
+            planes.push_back(plane);
+        }
+    }
+
+    AddPassDrawcalls(m_shadowPass, renderer, collectionIndex, camera, m_settings.shadowLodBias, planes);
+}
+
+void StreamingTerrain::AddPassDrawcalls(TilePass& pass, Renderer& renderer, unsigned int collectionIndex, const Camera& camera,
+    unsigned int lodBias, std::span<const BoundsPlane> planes)
+{
+    pass.statistics = Statistics();
+    if (m_tiles.empty() || !pass.material)
+    {
+        return;
+    }
+
+    // Test all the tiles at once, the ones not uploaded are skipped after
+    m_tileBounds.TestPlanes(planes, m_visibleTiles);
+
+    glm::vec3 cameraPosition = camera.ExtractTranslation();
+    unsigned int maxLevel = m_settings.levelCount - 1;
+
+    // The renderer references the drawcalls, so they are all created before adding them
+    pass.drawcalls.clear();
+    pass.drawcalls.reserve(m_tiles.size());
+    std::vector<unsigned int> drawnTiles;
+    drawnTiles.reserve(m_tiles.size());
+    for (unsigned int tileIndex = 0; tileIndex < m_tiles.size(); ++tileIndex)
+    {
+        if (m_tiles[tileIndex]->state != TileState::Resident)
+        {
+            continue;
+        }
+        if (!m_visibleTiles[tileIndex])
+        {
+            ++pass.statistics.culledCount;
+            continue;
+        }
+
+        // Each level doubles the distance of the previous one
+        float distance = GetDistance(m_tileBounds.Get(tileIndex), cameraPosition);
+        unsigned int level = 0;
+        if (distance >= m_settings.lodDistance)
+        {
+            level = 1 + static_cast<unsigned int>(std::log2(distance / m_settings.lodDistance));
+        }
+        level = std::min(level + lodBias, maxLevel);
+
+        const Level& levelElements = m_levels[level];
+        GLint first = static_cast<GLint>(levelElements.firstElement * sizeof(std::uint16_t));
+        pass.drawcalls.emplace_back(Drawcall::Primitive::Triangles, levelElements.elementCount, Data::Type::UShort, first);
+        pass.statistics.triangleCount += levelElements.elementCount / 3;
+        drawnTiles.push_back(tileIndex);
+    }
+    pass.statistics.drawcallCount = static_cast<unsigned int>(pass.drawcalls.size());
+
+    // Vertices are relative to the tile origin
+    for (size_t i = 0; i < drawnTiles.size(); ++i)
+    {
+        const Tile& tile = *m_tiles[drawnTiles[i]];
+        unsigned int worldMatrixIndex = renderer.AddWorldMatrix(glm::translate(GetTileOrigin(tile.coordinates)));
+        renderer.AddDrawcall(collectionIndex, Renderer::DrawcallInfo(*pass.material, worldMatrixIndex, tile.vao, pass.drawcalls[i]));
+    }
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <ituGL/core/JobSystem.h>
+#include <ituGL/geometry/HeightfieldGenerator.h>
+#include <ituGL/geometry/VertexBufferObject.h>
+#include <ituGL/geometry/ElementBufferObject.h>
+#include <ituGL/geometry/VertexArrayObject.h>
+#include <ituGL/geometry/Drawcall.h>
+#include <ituGL/geometry/Mesh.h>
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/scene/BoundsArray.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+class Camera;
+class Material;
+
+// Terrain without borders, made of square tiles streamed around the camera
+// Tiles are generated by worker threads from the noise at their world coordinates, so neighbour tiles match at the borders
+// A fixed pool of tiles is allocated once, with its VBOs. Tiles that get out of range are reused for the new ones,
+// and only a few generated tiles are uploaded each frame, so memory is constant and moving doesn't cause hitches
+// All the tiles share one EBO, with a range of elements for each LOD level. Skirts around the tiles hide the cracks between levels
+class StreamingTerrain
+{
+public:
+    struct Settings
+    {
+        // Cells on each side of a tile, a power of 2
+        unsigned int tileResolution = 64;
+        float cellSize = 1.0f;
+
+        // Tiles are kept up to this number of tiles away from the tile of the camera, in x and z
+        unsigned int tileRadius = 4;
+
+        // Level i has 2^i times the cell size. Tiles closer than lodDistance use level 0, and each level doubles the distance
+        unsigned int levelCount = 4;
+        float lodDistance = 64.0f;
+
+        // The shadow map uses this number of levels more than the camera
+        unsigned int shadowLodBias = 1;
+
+        // Height of the skirts below the border of the tiles. It must cover the height error of the levels
+        float skirtDepth = 4.0f;
+
+        // Noise of the heights. The noise coordinates are the world coordinates times noiseScale, noiseMin and noiseMax are ignored
+        HeightfieldGenerator::NoiseSettings noise;
+        float noiseScale = 1.0f / 64.0f;
+
+        // Worker threads that generate the tiles, and max tiles generated or uploaded at once
+        unsigned int workerCount = 2;
+        unsigned int maxPendingTiles = 4;
+        unsigned int uploadsPerFrame = 2;
+    };
+
+    struct Statistics
+    {
+        unsigned int drawcallCount = 0;
+        unsigned int triangleCount = 0;
+        unsigned int culledCount = 0;
+    };
+
+    struct StreamingStatistics
+    {
+        unsigned int residentCount = 0;
+        unsigned int pendingCount = 0;
+        unsigned int uploadCount = 0;
+        unsigned int generatedCount = 0;
+    };
+
+public:
+    StreamingTerrain();
+    ~StreamingTerrain();
+
+    StreamingTerrain(const StreamingTerrain&) = delete;
+    StreamingTerrain& operator = (const StreamingTerrain&) = delete;
+
+    // Allocates the pool of tiles and starts the workers. Locations are the attributes of the materials
+    void Initialize(const Settings& settings, const Mesh::SemanticMap& locations);
+
+    inline const Settings& GetSettings() const { return m_settings; }
+    inline float GetTileSize() const { return m_settings.tileResolution * m_settings.cellSize; }
+    inline unsigned int GetTileCount() const { return static_cast<unsigned int>(m_tiles.size()); }
+
+    // Bounds of the tiles uploaded
+    inline const glm::vec3& GetBoundsMin() const { return m_boundsMin; }
+    inline const glm::vec3& GetBoundsMax() const { return m_boundsMax; }
+
+    // Bytes used on the GPU, the same for the whole run
+    inline size_t GetMemorySize() const { return m_memorySize; }
+
+    // Materials for the g-buffer and the shadow map, with the vertex format of the chunked terrain (see terrainlod.glsl)
+    // The terrain draws with copies of the materials, that never morph
+    void SetMaterials(std::shared_ptr<const Material> material, std::shared_ptr<const Material> shadowMaterial);
+    inline std::shared_ptr<Material> GetMaterial() const { return m_mainPass.material; }
+    inline std::shared_ptr<Material> GetShadowMaterial() const { return m_shadowPass.material; }
+
+    // Requests the tiles around the camera, reuses the tiles out of range, and uploads the tiles generated since the last frame
+    void Update(const glm::vec3& cameraPosition);
+
+    // Height of the terrain at a point, if its tile is uploaded
+    bool SampleHeight(float x, float z, float& height) const;
+
+    // Adds one drawcall for each uploaded tile visible from the camera, with the level for its distance
+    // The drawcalls are referenced by the renderer, so this must be called again every frame
+    void AddDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera);
+
+    // Same for the shadow map. Tiles outside the camera frustum are kept if they can cast shadows into it
+    void AddShadowDrawcalls(Renderer& renderer, unsigned int collectionIndex, const Camera& camera, const glm::vec3& lightDirection);
+
+    inline const Statistics& GetStatistics() const { return m_mainPass.statistics; }
+    inline const Statistics& GetShadowStatistics() const { return m_shadowPass.statistics; }
+    inline const StreamingStatistics& GetStreamingStatistics() const { return m_streamingStatistics; }
+
+private:
+    // Same format as the vertices of the chunked terrain, with the height in position.w too
+    struct Vertex
+    {
+        glm::vec4 position;
+        glm::vec3 normal;
+        glm::vec3 tangent;
+        glm::vec3 bitangent;
+        glm::vec2 texCoord;
+    };
+
+    struct TangentFrame
+    {
+        glm::vec3 normal;
+        glm::vec3 tangent;
+        glm::vec3 bitangent;
+    };
+
+    enum class TileState
+    {
+        // In the pool, can be requested
+        Free,
+        // A worker is filling the vertices
+        Generating,
+        // The vertices are ready to upload
+        Generated,
+        // Uploaded, can be drawn
+        Resident,
+    };
+
+    struct Tile
+    {
+        TileState state = TileState::Free;
+        glm::ivec2 coordinates = glm::ivec2(0);
+        JobSystem::Counter counter;
+
+        // Written by the worker while generating. Heights have a border of one sample, for the normals at the edges
+        std::vector<float> heights;
+        std::vector<TangentFrame> tangentFrames;
+        std::vector<Vertex> vertices;
+        glm::vec2 heightRange = glm::vec2(0.0f);
+
+        VertexBufferObject vbo;
+        VertexArrayObject vao;
+    };
+
+    // Range of the shared EBO with the elements of a level
+    struct Level
+    {
+        unsigned int firstElement;
+        unsigned int elementCount;
+    };
+
+    struct TilePass
+    {
+        std::shared_ptr<Material> material;
+        std::vector<Drawcall> drawcalls;
+        Statistics statistics;
+    };
+
+private:
+    void InitializeElements();
+    void InitializeTile(Tile& tile, const Mesh::SemanticMap& locations);
+
+    // Runs in a worker
+    void GenerateTile(Tile& tile) const;
+
+    void UploadTile(unsigned int tileIndex);
+
+    // Index in m_tileGrid of a tile, or -1 if it is out of range
+    int GetGridIndex(const glm::ivec2& coordinates) const;
+    glm::vec3 GetTileOrigin(const glm::ivec2& coordinates) const;
+
+    void AddPassDrawcalls(TilePass& pass, Renderer& renderer, unsigned int collectionIndex, const Camera& camera,
+        unsigned int lodBias, std::span<const BoundsPlane> planes);
+
+private:
+    Settings m_settings;
+
+    // Shared by all the tiles: grid and skirt elements of each level
+    ElementBufferObject m_elements;
+    std::vector<Level> m_levels;
+
+    // Vertices of a tile, the grid followed by the skirt
+    unsigned int m_gridVertexCount;
+    unsigned int m_vertexCount;
+
+    // The pool. Tiles don't move, the workers and the renderer reference them
+    std::vector<std::unique_ptr<Tile>> m_tiles;
+    AabbArray m_tileBounds;
+    // Result of the frustum test of each tile, updated for each pass
+    std::vector<unsigned char> m_visibleTiles;
+
+    // Tiles in range of the camera tile, in rows, with the index of the tile that has them or -1
+    glm::ivec2 m_centerCoordinates;
+    std::vector<int> m_tileGrid;
+    // Offsets from the camera tile, sorted by distance so the closest tiles are requested and uploaded first
+    std::vector<glm::ivec2> m_requestOrder;
+
+    glm::vec3 m_boundsMin;
+    glm::vec3 m_boundsMax;
+
+    size_t m_memorySize;
+
+    TilePass m_mainPass;
+    TilePass m_shadowPass;
+
+    StreamingStatistics m_streamingStatistics;
+
+    // Workers of the tiles only. A frame that waits for its own jobs in the default job system never runs a tile instead
+    // Declared last, so the workers stop before the tiles are destroyed
+    std::unique_ptr<JobSystem> m_jobSystem;
+};
@@ -1,36 +1,34 @@
 #include "Terrain.h"
 
-#include <ituGL/geometry/VertexFormat.h>
+#include <ituGL/core/JobSystem.h>
+#include <ituGL/geometry/HeightfieldGenerator.h>
+#include <ituGL/geometry/VertexLayout.h>
+#include <ituGL/geometry/MeshOptimizer.h>
+#include <ituGL/geometry/VertexQuantization.h>
 #include <ituGL/texture/Texture2DObject.h>
 
 #include <glm/gtx/transform.hpp>  // for matrix transformations
 
-#define STB_PERLIN_IMPLEMENTATION
-#include <stb_perlin.h>
-
 #include <stb_image.h>
 
 #include <cmath>
+#include <cstddef>
 #include <iostream>
 #include <numbers>  // for PI constant
 
 std::vector<float> Terrain::CreateHeightMap(unsigned int horizontal, unsigned int vertical, float height)
 {
-    std::vector<float> pixels(vertical * horizontal);
-    for (unsigned int j = 0; j < vertical; ++j)
-    {
-        for (unsigned int i = 0; i < horizontal; ++i)
-        {
-            float x = static_cast<float>(i) / (horizontal - 1);
-            float y = static_cast<float>(j) / (vertical - 1);
-            pixels[j * horizontal + i] = stb_perlin_fbm_noise3(x, y, 0.0f, 1.9f, 0.5f, 8) * height;
-        }
-    }
-
-    return pixels;
+    // Same noise as stb_perlin_fbm_noise3 over [0, 1], generated in parallel
+    HeightfieldGenerator::NoiseSettings settings;
+    settings.lacunarity = 1.9f;
+    settings.gain = 0.5f;
+    settings.octaves = 8;
+    settings.height = height;
+    return HeightfieldGenerator::Generate(horizontal, vertical, settings, JobSystem::GetDefault());
 }
 
-std::vector<float> Terrain::CreateTerrainMesh(std::shared_ptr<Mesh> mesh, unsigned int gridX, unsigned int gridY, float height, float size)
+std::vector<float> Terrain::CreateTerrainMesh(std::shared_ptr<Mesh> mesh, unsigned int gridX, unsigned int gridY, float height, float size,
+    const Mesh::SemanticMap& locations, bool compactVertexFormat, MeshStatistics* statistics)
 {
     // Define the vertex structure
     struct Vertex
@@ -45,13 +43,30 @@ std::vector<float> Terrain::CreateTerrainMesh(std::shared_ptr<Mesh> mesh, unsign
         glm::vec2 texCoord;
     };
 
-    // Define the vertex format (should match the vertex structure)
-    VertexFormat vertexFormat;
-    vertexFormat.AddVertexAttribute<float>(3); // position
-    vertexFormat.AddVertexAttribute<float>(3); // normal
-    vertexFormat.AddVertexAttribute<float>(3); // tangent
-    vertexFormat.AddVertexAttribute<float>(3); // bitangent
-    vertexFormat.AddVertexAttribute<float>(2); // texture coordinates
+    // Quantized vertex, 20 bytes instead of 56. See VertexQuantization
+    struct CompactVertex
+    {
+        glm::i16vec4 position;
+        std::uint32_t normal;
+        // Bitangent sign in w
+        std::uint32_t tangent;
+        glm::u16vec2 texCoord;
+    };
+    static_assert(sizeof(CompactVertex) == 20);
+
+    // Define the vertex layouts from the vertex structures, checked at compile time
+    using Layout = VertexLayout<Vertex,
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, position, Position),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, normal, Normal),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, tangent, Tangent),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, bitangent, Bitangent),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, texCoord, TexCoord0)>;
+
+    using CompactLayout = VertexLayout<CompactVertex,
+        ITUGL_VERTEX_ATTRIBUTE_FORMAT(CompactVertex, position, Position, Short, 4, true),
+        ITUGL_VERTEX_ATTRIBUTE_FORMAT(CompactVertex, normal, Normal, Int2101010Rev, 4, true),
+        ITUGL_VERTEX_ATTRIBUTE_FORMAT(CompactVertex, tangent, Tangent, Int2101010Rev, 4, true),
+        ITUGL_VERTEX_ATTRIBUTE_FORMAT(CompactVertex, texCoord, TexCoord0, Half, 2, false)>;
 
     // List of vertices (VBO)
     std::vector<Vertex> vertices;
@@ -103,31 +118,69 @@ std::vector<float> Terrain::CreateTerrainMesh(std::shared_ptr<Mesh> mesh, unsign
 
 
     // Compute normals when we have the positions of all the vertices
-    // Iterate AGAIN over each vertex
+    vertices.reserve(positions.size());
     for (unsigned int j = 0u; j < rowCount; ++j)
     {
         for (unsigned int i = 0u; i < columnCount; ++i)
         {
+            vertices.emplace_back(positions[j * columnCount + i], glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f), glm::vec2(i, j));
+        }
+    }
+    HeightfieldGenerator::ComputeTangentFrames(heightmap, columnCount, rowCount, scale, vertices,
+        offsetof(Vertex, normal), offsetof(Vertex, tangent), offsetof(Vertex, bitangent), JobSystem::GetDefault());
 
-            unsigned int index = j * columnCount + i;
-            unsigned int prevX = i > 0 ? index - 1 : index;
-            unsigned int nextX = i < gridX ? index + 1 : index;
-            int prevY = j > 0 ? index - columnCount : index;
-            int nextY = j < gridY ? index + columnCount : index;
+    // Reorder the grid for the vertex caches. The heightmap returned keeps the grid order
+    if (statistics)
+    {
+        statistics->gridVertexCache = MeshOptimizer::AnalyzeVertexCache(indices, static_cast<unsigned int>(vertices.size()));
+    }
+    MeshOptimizer::Optimize(indices, vertices, offsetof(Vertex, position));
+    if (statistics)
+    {
+        statistics->optimizedVertexCache = MeshOptimizer::AnalyzeVertexCache(indices, static_cast<unsigned int>(vertices.size()));
+    }
 
-            glm::vec3 tangent = positions[nextX] - positions[prevX];
-            tangent = glm::normalize(tangent);
-            glm::vec3 bitangent = positions[nextY] - positions[prevY];
-            bitangent = glm::normalize(bitangent);
-            glm::vec3 normal = glm::cross(bitangent, tangent);
-            glm::vec2 texCoord(i, j);
+    if (!compactVertexFormat)
+    {
+        mesh.get()->AddSubmesh<Layout, unsigned int>(Drawcall::Primitive::Triangles, vertices, indices, locations);
+        return heightmap;
+    }
 
-            vertices.emplace_back(positions[index], normal, tangent, bitangent, texCoord);
-        }
+    // Quantize the vertices inside the bounds of the terrain
+    glm::vec3 boundsMin = vertices[0].position;
+    glm::vec3 boundsMax = boundsMin;
+    for (const Vertex& vertex : vertices)
+    {
+        boundsMin = glm::min(boundsMin, vertex.position);
+        boundsMax = glm::max(boundsMax, vertex.position);
+    }
+    VertexQuantization::PositionTransform positionTransform = VertexQuantization::GetPositionTransform(boundsMin, boundsMax);
+
+    VertexQuantization::QualityReport report;
+    std::vector<CompactVertex> compactVertices(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const Vertex& vertex = vertices[i];
+        CompactVertex& compactVertex = compactVertices[i];
+        float bitangentSign = VertexQuantization::GetBitangentSign(vertex.normal, vertex.tangent, vertex.bitangent);
+        compactVertex.position = VertexQuantization::QuantizePosition(vertex.position, positionTransform);
+        compactVertex.normal = VertexQuantization::QuantizeDirection(vertex.normal);
+        compactVertex.tangent = VertexQuantization::QuantizeDirection(vertex.tangent, bitangentSign);
+        compactVertex.texCoord = VertexQuantization::QuantizeTexCoord(vertex.texCoord);
+
+        report.AddPosition(vertex.position, VertexQuantization::DequantizePosition(compactVertex.position, positionTransform));
+        report.AddNormal(vertex.normal, VertexQuantization::DequantizeDirection(compactVertex.normal));
+        report.AddTangent(vertex.tangent, VertexQuantization::DequantizeDirection(compactVertex.tangent));
+        report.AddTexCoord(vertex.texCoord, VertexQuantization::DequantizeTexCoord(compactVertex.texCoord));
+    }
+    report.AddVertexData(vertices.size() * sizeof(Vertex), compactVertices.size() * sizeof(CompactVertex));
+    if (statistics)
+    {
+        statistics->quantization = report;
     }
 
-    mesh.get()->AddSubmesh<Vertex, unsigned int, VertexFormat::LayoutIterator>(Drawcall::Primitive::Triangles, vertices, indices,
-        vertexFormat.LayoutBegin(static_cast<int>(vertices.size()), true /* interleaved */), vertexFormat.LayoutEnd());
+    unsigned int submeshIndex = mesh.get()->AddSubmesh<CompactLayout, unsigned int>(Drawcall::Primitive::Triangles, compactVertices, indices, locations);
+    mesh.get()->SetSubmeshPositionTransform(submeshIndex, positionTransform.offset, positionTransform.scale);
 
     return heightmap;
 }
\ No newline at end of file
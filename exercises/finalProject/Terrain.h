@@ -2,6 +2,8 @@
 
 #include <ituGL/asset/ShaderLoader.h>
 #include <ituGL/geometry/Mesh.h>
+#include <ituGL/geometry/MeshOptimizer.h>
+#include <ituGL/geometry/VertexQuantization.h>
 #include <ituGL/camera/Camera.h>
 #include <ituGL/shader/Material.h>
 #include <glm/mat4x4.hpp>
@@ -12,8 +14,22 @@ class Texture2DObject;
 class Terrain
 {
 public:
-    static std::vector<float> CreateTerrainMesh(std::shared_ptr<Mesh> mesh, unsigned int gridX, unsigned int gridY, float height, float size);
+    // Results of building the mesh, to show them in the UI
+    struct MeshStatistics
+    {
+        // Vertex cache of the grid order and after the optimization
+        MeshOptimizer::VertexCacheStatistics gridVertexCache;
+        MeshOptimizer::VertexCacheStatistics optimizedVertexCache;
 
-private:
+        // Errors and sizes of the compact vertex format, empty without it
+        VertexQuantization::QualityReport quantization;
+    };
+
+public:
+    // Locations are the attributes of the material, compact vertex format quantizes the vertices (see VertexQuantization)
+    static std::vector<float> CreateTerrainMesh(std::shared_ptr<Mesh> mesh, unsigned int gridX, unsigned int gridY, float height, float size,
+        const Mesh::SemanticMap& locations, bool compactVertexFormat, MeshStatistics* statistics = nullptr);
+
+    // Heights of the grid vertices, row by row
     static std::vector<float> CreateHeightMap(unsigned int horizontal, unsigned int vertical, float height);
 };
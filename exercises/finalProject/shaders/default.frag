@@ -3,14 +3,20 @@ in vec3 ViewNormal;
 in vec3 ViewTangent;
 in vec3 ViewBitangent;
 in vec2 TexCoord;
+in vec4 ClipPosition;
+in vec4 PrevClipPosition;
 
 //Outputs
 out vec4 FragAlbedo;
 out vec2 FragNormal;
 out vec4 FragOthers;
+out vec2 FragVelocity;
 
 //Uniforms
-uniform vec3 Color;
+layout(std140) uniform MaterialBlock
+{
+	vec3 Color;
+};
 uniform sampler2D ColorTexture;
 uniform sampler2D NormalTexture;
 uniform sampler2D SpecularTexture;
@@ -23,4 +29,7 @@ void main()
 	FragNormal = viewNormal.xy;
 
 	FragOthers = texture(SpecularTexture, TexCoord);
+
+	// Motion since the previous frame, in NDC. Ignored if the g-buffer has no velocity texture
+	FragVelocity = ClipPosition.xy / ClipPosition.w - PrevClipPosition.xy / PrevClipPosition.w;
 }
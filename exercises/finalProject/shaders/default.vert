@@ -1,7 +1,7 @@
 //Inputs
 layout (location = 0) in vec3 VertexPosition;
 layout (location = 1) in vec3 VertexNormal;
-layout (location = 2) in vec3 VertexTangent;
+layout (location = 2) in vec4 VertexTangent;
 layout (location = 3) in vec3 VertexBitangent;
 layout (location = 4) in vec2 VertexTexCoord;
 
@@ -10,10 +10,13 @@ out vec3 ViewNormal;
 out vec3 ViewTangent;
 out vec3 ViewBitangent;
 out vec2 TexCoord;
+out vec4 ClipPosition;
+out vec4 PrevClipPosition;
 
 //Uniforms
 uniform mat4 WorldViewMatrix;
 uniform mat4 WorldViewProjMatrix;
+uniform mat4 PrevWorldViewProjMatrix;
 
 void main()
 {
@@ -21,14 +24,25 @@ void main()
 	ViewNormal = (WorldViewMatrix * vec4(VertexNormal, 0.0)).xyz;
 
 	// tangent in view space (for lighting computation)
-	ViewTangent = (WorldViewMatrix * vec4(VertexTangent, 0.0)).xyz;
+	ViewTangent = (WorldViewMatrix * vec4(VertexTangent.xyz, 0.0)).xyz;
+
+	// compact vertex formats don't have a bitangent, it is rebuilt with the sign stored in the tangent w
+	vec3 bitangent = VertexBitangent;
+	if (dot(bitangent, bitangent) == 0.0)
+	{
+		bitangent = cross(VertexNormal, VertexTangent.xyz) * VertexTangent.w;
+	}
 
 	// bitangent in view space (for lighting computation)
-	ViewBitangent = (WorldViewMatrix * vec4(VertexBitangent, 0.0)).xyz;
+	ViewBitangent = (WorldViewMatrix * vec4(bitangent, 0.0)).xyz;
 
 	// texture coordinates
 	TexCoord = VertexTexCoord;
 
+	// clip position in this frame and the previous one (for velocity)
+	ClipPosition = WorldViewProjMatrix * vec4(VertexPosition, 1.0);
+	PrevClipPosition = PrevWorldViewProjMatrix * vec4(VertexPosition, 1.0);
+
 	// final vertex position (for opengl rendering, not for lighting)
-	gl_Position = WorldViewProjMatrix * vec4(VertexPosition, 1.0);
+	gl_Position = ClipPosition;
 }
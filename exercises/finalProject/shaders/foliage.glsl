@@ -0,0 +1,17 @@
+#pragma once
+
+// Instanced foliage, see Foliage
+// Each instance has a position, and a rotation around the y axis and a uniform scale
+
+//Inputs
+layout (location = 5) in vec3 InstancePosition;
+layout (location = 6) in vec2 InstanceYawScale;
+
+// From the model space to the world space, rotated and scaled around the instance position
+mat4 GetFoliageInstanceMatrix()
+{
+	float scale = InstanceYawScale.y;
+	float c = cos(InstanceYawScale.x) * scale;
+	float s = sin(InstanceYawScale.x) * scale;
+	return mat4(vec4(c, 0.0, -s, 0.0), vec4(0.0, scale, 0.0, 0.0), vec4(s, 0.0, c, 0.0), vec4(InstancePosition, 1.0));
+}
@@ -0,0 +1,57 @@
+#include "foliage.glsl"
+
+//Inputs
+layout (location = 0) in vec3 VertexPosition;
+layout (location = 1) in vec3 VertexNormal;
+layout (location = 2) in vec4 VertexTangent;
+layout (location = 3) in vec3 VertexBitangent;
+layout (location = 4) in vec2 VertexTexCoord;
+
+//Outputs
+out vec3 ViewNormal;
+out vec3 ViewTangent;
+out vec3 ViewBitangent;
+out vec2 TexCoord;
+out vec4 ClipPosition;
+out vec4 PrevClipPosition;
+
+//Uniforms
+// Transform of the quantized positions, the same for all the instances
+uniform mat4 WorldMatrix;
+uniform mat4 ViewMatrix;
+uniform mat4 ViewProjMatrix;
+uniform mat4 PrevViewProjMatrix;
+
+void main()
+{
+	// world matrix of this instance. The instances don't move, so it is the same in the previous frame
+	mat4 worldMatrix = GetFoliageInstanceMatrix() * WorldMatrix;
+	mat4 worldViewMatrix = ViewMatrix * worldMatrix;
+
+	// normal in view space (for lighting computation)
+	ViewNormal = (worldViewMatrix * vec4(VertexNormal, 0.0)).xyz;
+
+	// tangent in view space (for lighting computation)
+	ViewTangent = (worldViewMatrix * vec4(VertexTangent.xyz, 0.0)).xyz;
+
+	// compact vertex formats don't have a bitangent, it is rebuilt with the sign stored in the tangent w
+	vec3 bitangent = VertexBitangent;
+	if (dot(bitangent, bitangent) == 0.0)
+	{
+		bitangent = cross(VertexNormal, VertexTangent.xyz) * VertexTangent.w;
+	}
+
+	// bitangent in view space (for lighting computation)
+	ViewBitangent = (worldViewMatrix * vec4(bitangent, 0.0)).xyz;
+
+	// texture coordinates
+	TexCoord = VertexTexCoord;
+
+	// clip position in this frame and the previous one (for velocity)
+	vec4 worldPosition = worldMatrix * vec4(VertexPosition, 1.0);
+	ClipPosition = ViewProjMatrix * worldPosition;
+	PrevClipPosition = PrevViewProjMatrix * worldPosition;
+
+	// final vertex position (for opengl rendering, not for lighting)
+	gl_Position = ClipPosition;
+}
@@ -1,3 +1,5 @@
+#pragma once
+#include "utils.glsl"
 
 uniform samplerCube EnvironmentTexture;
 uniform float EnvironmentMaxLod;
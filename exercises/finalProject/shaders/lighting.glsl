@@ -1,14 +1,19 @@
+#pragma once
+#include "lambert-ggx.glsl"
+
+// Features compiled only in the shader variants that use them:
+// LIGHT_INDIRECT adds the environment lighting, LIGHT_SHADOW samples the shadow map of the light
 
-uniform bool LightIndirect;
 uniform vec3 LightColor;
 uniform vec3 LightPosition;
 uniform vec3 LightDirection;
 uniform vec4 LightAttenuation;
 
-uniform bool LightShadowEnabled;
+#ifdef LIGHT_SHADOW
 uniform sampler2DShadow LightShadowMap;
 uniform mat4 LightShadowMatrix;
 uniform float LightShadowBias;
+#endif
 
 float ComputeDistanceAttenuation(vec3 position)
 {
@@ -40,23 +45,22 @@ float ComputeAttenuation(vec3 position, vec3 lightDir)
 float ComputeShadow(vec3 position)
 {
 	float shadow = 1.0f;
-	if (LightShadowEnabled)
-	{
-		// Transform position to light space
-		vec4 lightSpacePosition = LightShadowMatrix * vec4(position, 1.0f);
+#ifdef LIGHT_SHADOW
+	// Transform position to light space
+	vec4 lightSpacePosition = LightShadowMatrix * vec4(position, 1.0f);
 
-		// Homogeneous coordinates
-		lightSpacePosition /= lightSpacePosition.w;
+	// Homogeneous coordinates
+	lightSpacePosition /= lightSpacePosition.w;
 
-		// Transform to texture range (0-1)
-		lightSpacePosition = lightSpacePosition * 0.5f + 0.5f;
+	// Transform to texture range (0-1)
+	lightSpacePosition = lightSpacePosition * 0.5f + 0.5f;
 
-		// Depth bias
-		lightSpacePosition.z *= (1.0f - LightShadowBias);
+	// Depth bias
+	lightSpacePosition.z *= (1.0f - LightShadowBias);
 
-		// Sample shadow texture
-		shadow = texture(LightShadowMap, lightSpacePosition.xyz);
-	}
+	// Sample shadow texture
+	shadow = texture(LightShadowMap, lightSpacePosition.xyz);
+#endif
 	return shadow;
 }
 
@@ -84,12 +88,14 @@ vec3 ComputeLighting(vec3 position, SurfaceData data, vec3 viewDir, bool indirec
 {
 	vec3 light = ComputeLight(data, viewDir, position);
 	
-	if (indirect && LightIndirect)
+#ifdef LIGHT_INDIRECT
+	if (indirect)
 	{
 		vec3 diffuseIndirect = ComputeDiffuseIndirectLighting(data);
 		vec3 specularIndirect = ComputeSpecularIndirectLighting(data, viewDir);
 		light += CombineIndirectLighting(diffuseIndirect, specularIndirect, data, viewDir);
 	}
+#endif
 
 	return light;
 }
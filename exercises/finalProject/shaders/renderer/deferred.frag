@@ -1,3 +1,5 @@
+#include "../lighting.glsl"
+
 //Inputs
 in vec2 TexCoord;
 
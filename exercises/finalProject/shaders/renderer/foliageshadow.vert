@@ -0,0 +1,14 @@
+#include "../foliage.glsl"
+
+//Inputs
+layout (location = 0) in vec3 VertexPosition;
+
+//Uniforms
+uniform mat4 WorldMatrix;
+uniform mat4 ViewProjMatrix;
+
+void main()
+{
+	// same transform as the foliage in the g-buffer
+	gl_Position = ViewProjMatrix * GetFoliageInstanceMatrix() * WorldMatrix * vec4(VertexPosition, 1.0);
+}
@@ -0,0 +1,15 @@
+#include "../terrainheightmap.glsl"
+
+//Inputs
+layout (location = 0) in vec2 VertexGridPosition;
+layout (location = 1) in vec2 InstanceChunkOrigin;
+
+//Uniforms
+uniform mat4 WorldViewProjMatrix;
+
+void main()
+{
+	// same displacement as the terrain in the g-buffer
+	ivec2 coordinates = ivec2(InstanceChunkOrigin + VertexGridPosition);
+	gl_Position = WorldViewProjMatrix * vec4(GetTerrainPosition(coordinates), 1.0);
+}
@@ -0,0 +1,14 @@
+#include "../terrainlod.glsl"
+
+//Inputs
+layout (location = 0) in vec4 VertexPosition;
+layout (location = 4) in vec2 VertexTexCoord;
+
+//Uniforms
+uniform mat4 WorldViewProjMatrix;
+
+void main()
+{
+	// same morph as the terrain in the g-buffer, with the ranges of the shadow levels
+	gl_Position = WorldViewProjMatrix * vec4(GetLodPosition(VertexPosition, VertexTexCoord), 1.0);
+}
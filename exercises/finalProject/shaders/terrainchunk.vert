@@ -0,0 +1,42 @@
+#include "terrainlod.glsl"
+
+//Inputs
+layout (location = 0) in vec4 VertexPosition;
+layout (location = 1) in vec3 VertexNormal;
+layout (location = 2) in vec3 VertexTangent;
+layout (location = 3) in vec3 VertexBitangent;
+layout (location = 4) in vec2 VertexTexCoord;
+
+//Outputs
+out vec3 ViewNormal;
+out vec3 ViewTangent;
+out vec3 ViewBitangent;
+out vec2 TexCoord;
+out vec4 ClipPosition;
+out vec4 PrevClipPosition;
+
+//Uniforms
+uniform mat4 WorldViewMatrix;
+uniform mat4 WorldViewProjMatrix;
+uniform mat4 PrevWorldViewProjMatrix;
+
+void main()
+{
+	// position morphed towards the next level, the texture coordinates are the grid coordinates
+	vec3 position = GetLodPosition(VertexPosition, VertexTexCoord);
+
+	// normal, tangent and bitangent in view space (for lighting computation). They are not morphed
+	ViewNormal = (WorldViewMatrix * vec4(VertexNormal, 0.0)).xyz;
+	ViewTangent = (WorldViewMatrix * vec4(VertexTangent, 0.0)).xyz;
+	ViewBitangent = (WorldViewMatrix * vec4(VertexBitangent, 0.0)).xyz;
+
+	// texture coordinates
+	TexCoord = VertexTexCoord;
+
+	// clip position in this frame and the previous one (for velocity)
+	ClipPosition = WorldViewProjMatrix * vec4(position, 1.0);
+	PrevClipPosition = PrevWorldViewProjMatrix * vec4(position, 1.0);
+
+	// final vertex position (for opengl rendering, not for lighting)
+	gl_Position = ClipPosition;
+}
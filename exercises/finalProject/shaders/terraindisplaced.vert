@@ -0,0 +1,42 @@
+#include "terrainheightmap.glsl"
+
+//Inputs
+layout (location = 0) in vec2 VertexGridPosition;
+layout (location = 1) in vec2 InstanceChunkOrigin;
+
+//Outputs
+out vec3 ViewNormal;
+out vec3 ViewTangent;
+out vec3 ViewBitangent;
+out vec2 TexCoord;
+out vec4 ClipPosition;
+out vec4 PrevClipPosition;
+
+//Uniforms
+uniform mat4 WorldViewMatrix;
+uniform mat4 WorldViewProjMatrix;
+uniform mat4 PrevWorldViewProjMatrix;
+
+void main()
+{
+	// grid coordinates of the vertex in the whole terrain, displaced with the height of its texel
+	ivec2 coordinates = ivec2(InstanceChunkOrigin + VertexGridPosition);
+	vec3 position = GetTerrainPosition(coordinates);
+
+	// normal, tangent and bitangent in view space (for lighting computation), reconstructed from the neighbour heights
+	vec3 normal, tangent, bitangent;
+	GetTerrainTangentFrame(coordinates, normal, tangent, bitangent);
+	ViewNormal = (WorldViewMatrix * vec4(normal, 0.0)).xyz;
+	ViewTangent = (WorldViewMatrix * vec4(tangent, 0.0)).xyz;
+	ViewBitangent = (WorldViewMatrix * vec4(bitangent, 0.0)).xyz;
+
+	// texture coordinates are the grid coordinates, like the chunked terrain
+	TexCoord = vec2(coordinates);
+
+	// clip position in this frame and the previous one (for velocity)
+	ClipPosition = WorldViewProjMatrix * vec4(position, 1.0);
+	PrevClipPosition = PrevWorldViewProjMatrix * vec4(position, 1.0);
+
+	// final vertex position (for opengl rendering, not for lighting)
+	gl_Position = ClipPosition;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Terrain displaced from a heightmap texture, see DisplacedTerrain
+// Vertices have integer grid coordinates, the texel of their height
+
+//Uniforms
+uniform sampler2D TerrainHeightmap;
+// Heights of the texel values 0 and 1
+uniform vec2 TerrainHeightRange;
+uniform float TerrainCellSize;
+
+// Exact texel, without filtering. Coordinates outside the grid take the height of the border
+float GetTerrainHeight(ivec2 coordinates)
+{
+	coordinates = clamp(coordinates, ivec2(0), textureSize(TerrainHeightmap, 0) - 1);
+	return mix(TerrainHeightRange.x, TerrainHeightRange.y, texelFetch(TerrainHeightmap, coordinates, 0).r);
+}
+
+vec3 GetTerrainPosition(ivec2 coordinates)
+{
+	return vec3(float(coordinates.x) * TerrainCellSize, GetTerrainHeight(coordinates), float(coordinates.y) * TerrainCellSize);
+}
+
+// Same tangent frame as HeightfieldGenerator::ComputeTangentFrames: central differences, one-sided on the borders
+void GetTerrainTangentFrame(ivec2 coordinates, out vec3 normal, out vec3 tangent, out vec3 bitangent)
+{
+	ivec2 lastTexel = textureSize(TerrainHeightmap, 0) - 1;
+	ivec2 prev = max(coordinates - 1, ivec2(0));
+	ivec2 next = min(coordinates + 1, lastTexel);
+
+	float heightX = GetTerrainHeight(ivec2(next.x, coordinates.y)) - GetTerrainHeight(ivec2(prev.x, coordinates.y));
+	float heightY = GetTerrainHeight(ivec2(coordinates.x, next.y)) - GetTerrainHeight(ivec2(coordinates.x, prev.y));
+
+	tangent = normalize(vec3(float(next.x - prev.x) * TerrainCellSize, heightX, 0.0));
+	bitangent = normalize(vec3(0.0, heightY, float(next.y - prev.y) * TerrainCellSize));
+	normal = normalize(cross(bitangent, tangent));
+}
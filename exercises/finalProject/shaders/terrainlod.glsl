@@ -0,0 +1,22 @@
+#pragma once
+
+// Continuous LOD of the chunked terrain, see ChunkedTerrain
+// Terrain vertices are in world space, with the height they have in the next level in position.w
+
+//Uniforms
+uniform vec3 LodCameraPosition;
+uniform float LodStep;
+uniform vec2 LodMorphRange;
+
+// Vertices that are not part of the next level move to its height as they get away from the camera
+// At the end of the range the chunk matches the next level, so there are no cracks or pops when it switches
+vec3 GetLodPosition(vec4 position, vec2 gridCoordinates)
+{
+	vec2 nextLevel = mod(gridCoordinates, 2.0 * LodStep);
+	if (nextLevel.x != 0.0 || nextLevel.y != 0.0)
+	{
+		float morph = clamp((distance(position.xyz, LodCameraPosition) - LodMorphRange.x) / (LodMorphRange.y - LodMorphRange.x), 0.0, 1.0);
+		position.y = mix(position.y, position.w, morph);
+	}
+	return position.xyz;
+}
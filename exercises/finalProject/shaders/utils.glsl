@@ -1,3 +1,4 @@
+#pragma once
 
 //
 vec3 GetCameraPosition(mat4 viewMatrix)
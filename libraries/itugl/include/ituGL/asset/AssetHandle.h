@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+// Handle to an asset loaded in the background, see AsyncLoadQueue
+// The asset object exists from the start with placeholder contents, and it is filled in place on the main thread when ready
+// It can be used right away, for example set in a material, and it shows the loaded data as soon as it is uploaded
+template<typename T>
+class AssetHandle
+{
+public:
+    enum class State
+    {
+        Loading,
+        Ready,
+        Failed,
+    };
+
+public:
+    AssetHandle() = default;
+    explicit AssetHandle(std::shared_ptr<T> asset);
+
+    inline bool IsValid() const { return m_sharedData != nullptr; }
+
+    // The asset object. Has the placeholder contents until the handle is ready
+    inline std::shared_ptr<T> Get() const { return m_sharedData ? m_sharedData->asset : nullptr; }
+
+    State GetState() const;
+    inline bool IsReady() const { return GetState() == State::Ready; }
+    inline bool IsDone() const { return GetState() != State::Loading; }
+
+    // Used by the loaders when the asset is filled, or the load failed. The asset keeps the placeholder contents if failed
+    void SetState(State state) const;
+
+private:
+    // Shared by all the copies of the handle
+    struct SharedData
+    {
+        std::shared_ptr<T> asset;
+        std::atomic<State> state = State::Loading;
+    };
+
+    std::shared_ptr<SharedData> m_sharedData;
+};
+
+template<typename T>
+AssetHandle<T>::AssetHandle(std::shared_ptr<T> asset) : m_sharedData(std::make_shared<SharedData>())
+{
+    m_sharedData->asset = std::move(asset);
+}
+
+template<typename T>
+typename AssetHandle<T>::State AssetHandle<T>::GetState() const
+{
+    return m_sharedData ? m_sharedData->state.load(std::memory_order_acquire) : State::Failed;
+}
+
+template<typename T>
+void AssetHandle<T>::SetState(State state) const
+{
+    if (m_sharedData)
+    {
+        m_sharedData->state.store(state, std::memory_order_release);
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <ituGL/core/MappedFile.h>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Many asset files stored in a single file, mapped in memory
+// The table of contents is sorted by the hash of the paths, so finding a file is a binary search without any allocation
+// Files can be stored compressed with LZ4. Uncompressed files are read directly from the mapped memory
+class AssetPack
+{
+public:
+    enum class Compression : std::uint32_t
+    {
+        None = 0,
+        LZ4 = 1
+    };
+
+    // Entry of the table of contents, as stored in the file
+    struct Entry
+    {
+        std::uint64_t pathHash;
+        std::uint64_t offset;
+        // Size in the pack, compressed or not
+        std::uint64_t storedSize;
+        // Size of the original file
+        std::uint64_t size;
+        Compression compression;
+        std::uint32_t pathOffset;
+        std::uint32_t pathLength;
+        std::uint32_t reserved;
+    };
+
+    // Settings to build a pack
+    struct BuildSettings
+    {
+        Compression compression = Compression::LZ4;
+
+        // Files are stored compressed only if it saves at least this fraction of their size
+        float minSavings = 0.1f;
+
+        // Extensions of the files to skip, for example ".pak"
+        std::vector<std::string> excludedExtensions;
+    };
+
+public:
+    AssetPack();
+
+    // Maps the pack file. Returns false if the file can't be opened or is not a valid pack
+    bool Open(const char* path);
+    void Close();
+
+    inline bool IsOpen() const { return m_file.IsOpen(); }
+
+    // Find a file by its path, relative to the directory the pack was built from. Returns nullptr if not found
+    // The path must be normalized, see ShaderSourceCache::NormalizePath
+    const Entry* Find(std::string_view path) const;
+
+    inline unsigned int GetEntryCount() const { return static_cast<unsigned int>(m_entries.size()); }
+    inline const Entry& GetEntry(unsigned int index) const { return m_entries[index]; }
+    std::string_view GetPath(const Entry& entry) const;
+
+    // Data of the entry as stored in the pack. If it is not compressed, this is the content of the file
+    std::span<const std::byte> GetStoredData(const Entry& entry) const;
+
+    // Decompress the entry, or copy it if it is not compressed. Returns false if the data is corrupted
+    bool Read(const Entry& entry, std::vector<std::byte>& data) const;
+
+    // Build a pack with all the files in the directory and its subdirectories. Returns the number of files stored
+    // Returns -1 if the pack can't be written
+    static int Build(const char* directory, const char* path, const BuildSettings& settings);
+
+    // Hash used in the table of contents
+    static std::uint64_t GetPathHash(std::string_view path);
+
+private:
+    MappedFile m_file;
+
+    // Table of contents in the mapped file
+    std::span<const Entry> m_entries;
+
+    // Paths of the entries, to tell apart the ones with the same hash
+    const char* m_paths;
+    size_t m_pathsSize;
+};
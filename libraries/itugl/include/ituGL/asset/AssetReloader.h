@@ -0,0 +1,138 @@
+#pragma once
+
+#include <ituGL/core/FileWatcher.h>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ShaderProgram;
+class ShaderProgramVariants;
+class ShaderProgramCache;
+class Texture2DObject;
+class Texture2DLoader;
+class Model;
+class ModelLoader;
+class Material;
+
+// Reloads assets when their files change on disk, while the application is running
+// Assets are reloaded in place, so everyone holding them gets the new version without doing anything
+// Only the assets that depend on the changed files are reloaded. For shaders, this includes the included files
+class AssetReloader
+{
+public:
+    // Build the program again from its sources. Returns true if the program is linked
+    using BuildFunction = std::function<bool(ShaderProgram&)>;
+
+    // Called after the asset is reloaded, for example to register the shader program with the renderer again
+    using ReloadedFunction = std::function<void()>;
+
+public:
+    AssetReloader();
+
+    inline FileWatcher& GetFileWatcher() { return m_fileWatcher; }
+
+    // Rebuild the program when any of its source files change. The program must have just been built with the cache,
+    // and the build function must use it too: the files are read from ShaderProgramCache::GetDependencies, again after each rebuild
+    // If the new sources don't build, the previous program is kept. The cache must outlive the reloader
+    void AddShaderProgram(std::shared_ptr<ShaderProgram> shaderProgram, const ShaderProgramCache& shaderProgramCache,
+        const BuildFunction& buildFunction, const ReloadedFunction& reloadedFunction = nullptr);
+
+    // Rebuild all the variants when any of their source files change, with the same rules as AddShaderProgram
+    void AddShaderVariants(std::shared_ptr<ShaderProgramVariants> shaderVariants, const ShaderProgramCache& shaderProgramCache);
+
+    // Load the texture again when the image, or its cooked file, changes. The previous image is kept if the file can't be read
+    // The loader must outlive the reloader
+    void AddTexture(std::shared_ptr<Texture2DObject> texture, const char* path, Texture2DLoader& loader);
+
+    // Load the mesh again when the file changes. The materials are kept if the number of submeshes doesn't change
+    // The loader must outlive the reloader
+    void AddModel(std::shared_ptr<Model> model, const char* path, ModelLoader& loader);
+
+    // Read the uniforms of the material again when its shader program, or its variants, are rebuilt
+    // The materials of the models added are refreshed too
+    void AddMaterial(std::shared_ptr<Material> material);
+
+    // Reload the assets of the files changed since the last update. Call once per frame, with the GL context current
+    // Returns the number of assets reloaded
+    unsigned int Update();
+
+    // Total number of assets reloaded
+    inline unsigned int GetReloadCount() const { return m_reloadCount; }
+
+private:
+    enum class AssetType
+    {
+        ShaderProgram,
+        ShaderVariants,
+        Texture,
+        Model
+    };
+
+    struct AssetReference
+    {
+        AssetType type;
+        unsigned int index;
+    };
+
+    struct ShaderProgramEntry
+    {
+        std::shared_ptr<ShaderProgram> shaderProgram;
+        const ShaderProgramCache* shaderProgramCache;
+        BuildFunction buildFunction;
+        ReloadedFunction reloadedFunction;
+    };
+
+    struct ShaderVariantsEntry
+    {
+        std::shared_ptr<ShaderProgramVariants> shaderVariants;
+        const ShaderProgramCache* shaderProgramCache;
+    };
+
+    struct TextureEntry
+    {
+        std::shared_ptr<Texture2DObject> texture;
+        std::string path;
+        Texture2DLoader* loader;
+    };
+
+    struct ModelEntry
+    {
+        std::shared_ptr<Model> model;
+        std::string path;
+        ModelLoader* loader;
+    };
+
+    void AddDependency(std::string_view path, AssetType type, unsigned int index);
+
+    // Replace the files the asset depends on
+    void SetDependencies(std::span<const std::string> paths, AssetType type, unsigned int index);
+
+    bool ReloadShaderProgram(ShaderProgramEntry& entry, unsigned int index);
+    bool ReloadShaderVariants(ShaderVariantsEntry& entry, unsigned int index);
+    bool ReloadTexture(TextureEntry& entry);
+    bool ReloadModel(ModelEntry& entry);
+
+    // Refresh the uniforms if the material uses a rebuilt program
+    void RefreshMaterial(Material& material, std::span<const ShaderProgram* const> shaderPrograms,
+        std::span<const ShaderProgramVariants* const> shaderVariants);
+
+private:
+    FileWatcher m_fileWatcher;
+
+    std::vector<ShaderProgramEntry> m_shaderPrograms;
+    std::vector<ShaderVariantsEntry> m_shaderVariants;
+    std::vector<TextureEntry> m_textures;
+    std::vector<ModelEntry> m_models;
+    std::vector<std::shared_ptr<Material>> m_materials;
+
+    // Assets that depend on each file, with the normalized path as key
+    std::unordered_multimap<std::string, AssetReference> m_dependents;
+
+    // Reused every update
+    std::vector<std::string> m_changedPaths;
+
+    unsigned int m_reloadCount;
+};
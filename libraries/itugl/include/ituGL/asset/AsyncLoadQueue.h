@@ -0,0 +1,58 @@
+#pragma once
+
+#include <ituGL/core/JobSystem.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// Loads assets in two steps: reading and decoding the files in worker threads, and creating the GL objects in the main thread
+// GL uploads are queued, and Update runs them within a time budget, so loading doesn't stall the frame
+class AsyncLoadQueue
+{
+public:
+    // Runs on the main thread, where the GL context is current
+    using UploadFunction = std::function<void()>;
+
+    // Runs on a worker thread, and returns the upload for the loaded data. It must not call GL
+    using LoadFunction = std::function<UploadFunction()>;
+
+public:
+    AsyncLoadQueue(JobSystem& jobSystem = JobSystem::GetDefault());
+    ~AsyncLoadQueue();
+
+    AsyncLoadQueue(const AsyncLoadQueue&) = delete;
+    AsyncLoadQueue& operator = (const AsyncLoadQueue&) = delete;
+
+    // Maximum time per Update spent uploading, in seconds. At least one upload runs every Update
+    inline double GetTimeBudget() const { return m_timeBudget; }
+    inline void SetTimeBudget(double timeBudget) { m_timeBudget = timeBudget; }
+
+    // Starts a load in a worker thread. Its upload runs in a later Update
+    void Schedule(LoadFunction loadFunction);
+
+    // Runs the uploads of the finished loads. Call once per frame from the main thread
+    void Update();
+
+    // Blocks until all the scheduled loads are finished and uploaded, for example behind a loading screen
+    void Flush();
+
+    // Loads not uploaded yet
+    inline unsigned int GetPendingCount() const { return m_pendingCount.load(std::memory_order_acquire); }
+
+private:
+    bool RunUpload();
+
+private:
+    JobSystem& m_jobSystem;
+
+    // Jobs still running. They are waited for on destruction, as they push to the upload queue
+    JobSystem::Counter m_counter;
+
+    std::mutex m_uploadMutex;
+    std::deque<UploadFunction> m_uploads;
+
+    std::atomic<unsigned int> m_pendingCount;
+
+    double m_timeBudget;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <ituGL/texture/TextureObject.h>
+#include <ituGL/asset/VirtualFileSystem.h>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+class Texture2DObject;
+
+// Block compressed 2D texture with its mip levels, in a DDS container
+// Files are written with the DX10 header, and the legacy DXT1/DXT5/ATI1/ATI2 headers can also be read
+class DDSFile
+{
+public:
+    struct Level
+    {
+        int width;
+        int height;
+        std::span<const std::byte> data;
+    };
+
+public:
+    DDSFile();
+
+    void Clear();
+
+    // Reads the file with VirtualFileSystem. The levels point to the file data, so it must be kept alive until uploaded
+    bool Read(const char* path);
+
+    // Writes all the levels to the file
+    bool Write(const char* path) const;
+
+    inline TextureObject::InternalFormat GetInternalFormat() const { return m_internalFormat; }
+    inline void SetInternalFormat(TextureObject::InternalFormat internalFormat) { m_internalFormat = internalFormat; }
+
+    // If the rows were flipped vertically when cooking. Kept in the reserved header fields, files from other tools are not flipped
+    inline bool GetFlipVertical() const { return m_flipVertical; }
+    inline void SetFlipVertical(bool flipVertical) { m_flipVertical = flipVertical; }
+
+    inline unsigned int GetLevelCount() const { return static_cast<unsigned int>(m_levels.size()); }
+    inline const Level& GetLevel(unsigned int level) const { return m_levels[level]; }
+
+    // Adds the next mip level. The data must be in the internal format
+    void AddLevel(int width, int height, std::vector<std::byte>&& data);
+
+    // Sets every level as the compressed image of the texture. The texture must be bound
+    void Upload(Texture2DObject& texture) const;
+
+private:
+    TextureObject::InternalFormat m_internalFormat;
+    bool m_flipVertical;
+
+    std::vector<Level> m_levels;
+
+    // Data of the levels added with AddLevel
+    std::vector<std::vector<std::byte>> m_levelData;
+
+    // Data of the levels read from the file
+    VirtualFile m_file;
+};
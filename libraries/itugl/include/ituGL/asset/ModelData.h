@@ -0,0 +1,118 @@
+#pragma once
+
+#include <ituGL/asset/VirtualFileSystem.h>
+#include <ituGL/geometry/VertexFormat.h>
+#include <ituGL/geometry/Drawcall.h>
+#include <ituGL/geometry/VertexQuantization.h>
+#include <glm/vec3.hpp>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Mesh and material data of a model in CPU memory, before any GL object is created
+// It can be filled from a source file, or read from a cooked cache file and used in place from the mapped file
+class ModelData
+{
+public:
+    // Range of elements drawn with the same primitive. First is the offset in bytes in the element data
+    struct DrawcallData
+    {
+        Drawcall::Primitive primitive;
+        int first;
+        int count;
+    };
+
+    // Vertices are interleaved in a single buffer
+    struct SubmeshData
+    {
+        VertexFormat vertexFormat;
+        int vertexCount = 0;
+        std::span<const GLubyte> vertexData;
+
+        Data::Type elementType = Data::Type::None;
+        std::span<const GLubyte> elementData;
+
+        std::vector<DrawcallData> drawcalls;
+
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        glm::vec3 boundsMax = glm::vec3(0.0f);
+
+        // Transform of the quantized positions to the model space, see Mesh::SetSubmeshPositionTransform
+        glm::vec3 positionOffset = glm::vec3(0.0f);
+        float positionScale = 1.0f;
+
+        unsigned int materialIndex = 0;
+    };
+
+    // Material properties found in the source file. Texture paths are relative to the model folder
+    struct MaterialData
+    {
+        enum Flags : std::uint32_t
+        {
+            HasAmbientColor = 1 << 0,
+            HasDiffuseColor = 1 << 1,
+            HasSpecularColor = 1 << 2,
+            HasSpecularExponent = 1 << 3,
+        };
+
+        std::uint32_t flags = 0;
+        glm::vec3 ambientColor = glm::vec3(0.0f);
+        glm::vec3 diffuseColor = glm::vec3(0.0f);
+        glm::vec3 specularColor = glm::vec3(0.0f);
+        float specularExponent = 0.0f;
+
+        // Empty if the material doesn't have the texture
+        std::string diffuseTexture;
+        std::string normalTexture;
+        std::string specularTexture;
+    };
+
+    // Increase when the cache layout changes. Cache files with a different version are ignored
+    static constexpr std::uint32_t CacheVersion = 2;
+
+public:
+    ModelData();
+
+    // Move semantics only, submeshes point to data owned by this object
+    ModelData(ModelData&& modelData) noexcept = default;
+    ModelData& operator = (ModelData&& modelData) noexcept = default;
+    ModelData(const ModelData&) = delete;
+    ModelData& operator = (const ModelData&) = delete;
+
+    void Clear();
+
+    inline std::span<SubmeshData> GetSubmeshes() { return m_submeshes; }
+    inline std::span<const SubmeshData> GetSubmeshes() const { return m_submeshes; }
+    inline std::span<const MaterialData> GetMaterials() const { return m_materials; }
+
+    // Add a submesh with its vertex and element data. The data is moved inside the model data
+    SubmeshData& AddSubmesh(std::vector<GLubyte>&& vertexData, std::vector<GLubyte>&& elementData);
+
+    void AddMaterial(const MaterialData& material);
+
+    // Errors and sizes of the quantized vertices. Empty when the data is read from the cache
+    inline const VertexQuantization::QualityReport& GetQuantizationReport() const { return m_quantizationReport; }
+    inline void SetQuantizationReport(const VertexQuantization::QualityReport& report) { m_quantizationReport = report; }
+
+    // Maps a cache file and uses it in place. Fails if the file is missing, invalid, or was cooked from a different source key
+    bool ReadCache(const char* path, std::uint64_t sourceKey);
+
+    // Writes the data to a cache file, with the key of the source it was created from
+    bool WriteCache(const char* path, std::uint64_t sourceKey) const;
+
+private:
+    struct CacheHeader;
+
+private:
+    std::vector<SubmeshData> m_submeshes;
+    std::vector<MaterialData> m_materials;
+
+    VertexQuantization::QualityReport m_quantizationReport;
+
+    // Owned data, when loaded from the source
+    std::vector<std::vector<GLubyte>> m_buffers;
+
+    // Data of the cache file, mapped or in a pack, when loaded from the cache
+    VirtualFile m_cacheFile;
+};
@@ -4,12 +4,17 @@
 
 #include <ituGL/geometry/Model.h>
 #include <ituGL/geometry/Mesh.h>
+#include <ituGL/asset/ModelData.h>
+#include <ituGL/asset/AssetHandle.h>
 #include <ituGL/asset/Texture2DLoader.h>
+#include <ituGL/geometry/VertexQuantization.h>
+#include <string>
 #include <vector>
 
 struct aiMesh;
 struct aiMaterial;
 class VertexFormat;
+class AsyncLoadQueue;
 
 // Asset loader for Models. Contains a pointer to a reference material for loaded submeshes
 class ModelLoader : public AssetLoader<Model>
@@ -30,33 +35,79 @@ public:
     Texture2DLoader& GetTexture2DLoader();
     const Texture2DLoader& GetTexture2DLoader() const;
 
+    // If enabled, the imported data is cooked to a cache file next to the source, and read from it in later loads
+    bool GetCacheEnabled() const;
+    void SetCacheEnabled(bool cacheEnabled);
+
+    // If enabled, the vertices are quantized on import, see VertexQuantization. The shaders must rebuild the bitangent
+    bool GetCompactVertexFormat() const;
+    void SetCompactVertexFormat(bool compactVertexFormat);
+
+    // Errors and sizes of all the vertices quantized on import by this loader, to show them in the UI
+    inline const VertexQuantization::QualityReport& GetQuantizationReport() const { return m_quantizationReport; }
+
     // Load the model from the path
     Model Load(const char* path) override;
 
+    // Read the model data from the cache, or import it from the source file. Doesn't create GL objects
+    bool LoadData(const char* path, ModelData& modelData) const;
+
+    // Create the mesh and materials of the model. Path is the model file, to find its textures
+    Model CreateModel(const ModelData& modelData, const char* path);
+
+    // Import the model in the background. The model has an empty mesh until it is uploaded, and its textures load asynchronously too
+    // The loader must stay alive until the load is finished
+    AssetHandle<Model> LoadAsync(const char* path, AsyncLoadQueue& loadQueue);
+
     // Maps a semantic to an attribute in the shader program used by the material
     bool SetMaterialAttribute(VertexAttribute::Semantic semantic, const char* attributeName);
 
+    // Locations of the semantics in the reference material, to create other meshes for it
+    inline const Mesh::SemanticMap& GetMaterialAttributeMap() const { return m_materialAttributeMap; }
+
     // Maps a material property to a uniform in the shader program used by the material
     bool SetMaterialProperty(MaterialProperty materialProperty, const char* uniformName);
 
 private:
-    // Generate a submesh from the loaded mesh data
-    void GenerateSubmesh(Mesh& mesh, const aiMesh& meshData);
+    // Import the model data from the source file with Assimp
+    static bool ImportData(const char* path, bool compactVertexFormat, ModelData& modelData);
+
+    // Key of the source file contents and the import settings, to validate the cache
+    static bool GetSourceKey(const char* path, bool compactVertexFormat, std::uint64_t& sourceKey);
+
+    // Path of the cache file of a model
+    static std::string GetCachePath(const char* path);
 
-    // Generate a material from the loaded material data
-    std::shared_ptr<Material> GenerateMaterial(const aiMaterial& materialData);
+    // Collect the submesh data from the loaded mesh data
+    static void CollectSubmeshData(ModelData& modelData, const aiMesh& meshData, bool compactVertexFormat, VertexQuantization::QualityReport& report);
 
-    // Load a texture of the specific type in the location
-    void LoadTexture(const aiMaterial& materialData, int textureType, Material& material, ShaderProgram::Location location,
+    // Collect the material data from the loaded material data
+    static ModelData::MaterialData CollectMaterialData(const aiMaterial& materialData);
+
+    // Generate a submesh from the model data
+    void GenerateSubmesh(Mesh& mesh, const ModelData::SubmeshData& submeshData);
+
+    // Generate a material from the model data
+    std::shared_ptr<Material> GenerateMaterial(const ModelData::MaterialData& materialData);
+
+    // Load a texture in the location, if the material has it
+    void LoadTexture(const std::string& texturePath, Material& material, ShaderProgram::Location location,
         TextureObject::Format format, TextureObject::InternalFormat internalFormat) const;
 
     // Build the vertex data from the mesh data
     static std::vector<GLubyte> CollectVertexData(const aiMesh& meshData, VertexFormat& vertexFormat, bool interleaved);
 
+    // Quantize interleaved float vertex data. The vertex format is replaced with the compact one
+    static std::vector<GLubyte> QuantizeVertexData(const std::vector<GLubyte>& vertexData, VertexFormat& vertexFormat, unsigned int vertexCount,
+        const VertexQuantization::PositionTransform& positionTransform, VertexQuantization::QualityReport& report);
+
     // Build the element data from the mesh data
     static std::vector<GLubyte> CollectElementData(const aiMesh& meshData, Data::Type& elementType,
         std::vector<Drawcall::Primitive>& primitives, std::vector<int>& elementCounts);
 
+    // Optimize the order of a triangle list with interleaved vertices. Returns the number of vertices left
+    static unsigned int OptimizeTriangles(std::vector<GLubyte>& vertexData, size_t vertexSize, std::vector<GLubyte>& elementData, Data::Type elementType);
+
     // Get the correct vertex data pointer for a specific semantic
     static const void* GetVertexDataPointer(const aiMesh& meshData, VertexAttribute::Semantic semantic, int& stride);
 
@@ -82,8 +133,20 @@ private:
     // Should create new materials for each submesh or use the reference material
     bool m_createMaterials;
 
+    // Should read and write the cooked cache files
+    bool m_cacheEnabled;
+
+    // Should quantize the vertices on import
+    bool m_compactVertexFormat;
+
+    // Results of the quantization of the models created so far
+    VertexQuantization::QualityReport m_quantizationReport;
+
     // Texture loader to cache already loaded shared textures
     mutable Texture2DLoader m_textureLoader;
+
+    // Set while creating a model loaded asynchronously, to load its textures the same way
+    AsyncLoadQueue* m_asyncLoadQueue;
 };
 
 enum class ModelLoader::MaterialProperty
@@ -3,6 +3,9 @@
 #include <ituGL/asset/AssetLoader.h>
 #include <ituGL/shader/Shader.h>
 #include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 
 class ShaderLoader : AssetLoader<Shader>
 {
@@ -20,10 +23,39 @@ public:
     Shader* LoadNew(std::span<const char*> paths);
     bool LoadInto(Shader& shader, std::span<const char*> paths);
 
+    // Create and compile the shader from source code already loaded
+    // files are the paths of the #line source numbers, used to report the compilation errors
+    Shader Load(std::span<const std::string> sources, std::span<const std::string> files = {});
+
     static Shader Load(Shader::Type type, const char* path);
 
+    // Defines added after the #version line of the shaders loaded from paths. Each one is "NAME" or "NAME VALUE"
+    inline const std::vector<std::string>& GetDefines() const { return m_defines; }
+    inline void SetDefines(std::span<const std::string> defines) { m_defines.assign(defines.begin(), defines.end()); }
+
+    // Files used by the last shader loaded from paths, including the ones from #include directives
+    inline const std::vector<std::string>& GetDependencies() const { return m_dependencies; }
+
+    // Read the source files, in order, with their #include directives replaced by the included files
+    // Files are read through ShaderSourceCache, so they are read from disk only once
+    // Each file gets a #line source number, and its path is added to files at that index
+    // The defines are added after the #version line, or at the start if there is none
+    // Directives inside /* */ comments are skipped, but #if blocks are not evaluated:
+    // an #include in an inactive block is still expanded there, and its file must exist
+    // Returns false if any of them can't be opened, or the includes are recursive
+    static bool LoadSources(std::span<const char*> paths, std::vector<std::string>& sources, std::vector<std::string>* files = nullptr,
+        std::span<const std::string> defines = {});
+
+    // Replace the source numbers at the start of each line of a compilation log with the file paths
+    // Lines that don't start with a known source number are kept as they are
+    static std::string RemapErrors(std::string_view errors, std::span<const std::string> files);
+
 private:
-    void Compile(Shader& shader);
+    void Compile(Shader& shader, std::span<const std::string> files);
 
     Shader::Type m_type;
+
+    std::vector<std::string> m_defines;
+
+    std::vector<std::string> m_dependencies;
 };
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <ituGL/shader/Shader.h>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+class ShaderProgram;
+
+// Builds shader programs from source files, and keeps the linked binaries on disk
+// The binaries are keyed by a hash of the sources and the driver, so they are used again only if nothing changed
+// If the driver rejects a binary anyway, the program is compiled from the sources and the binary is replaced
+class ShaderProgramCache
+{
+public:
+    ShaderProgramCache(const char* directory = "shadercache");
+
+    // If disabled, programs are always compiled from the sources and no files are written
+    inline bool GetEnabled() const { return m_enabled; }
+    inline void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+    // Build the program with the source files of each stage. Returns true if the program is linked
+    bool Build(ShaderProgram& shaderProgram, std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths);
+
+    // Same as Build, adding a geometry shader
+    bool Build(ShaderProgram& shaderProgram, std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+        std::span<const char*> geometryShaderPaths);
+
+    // Same as Build, with defines added to all the stages, see ShaderLoader::SetDefines. Used to build shader variants
+    bool BuildWithDefines(ShaderProgram& shaderProgram, std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+        std::span<const std::string> defines);
+
+    // Source files read by the last build, including the included files. Used to rebuild the program when they change
+    inline const std::vector<std::string>& GetDependencies() const { return m_dependencies; }
+
+    // Programs loaded from a binary
+    inline unsigned int GetHitCount() const { return m_hitCount; }
+    // Programs compiled from the sources, including the rejected binaries
+    inline unsigned int GetMissCount() const { return m_missCount; }
+    // Binaries found but rejected by the driver
+    inline unsigned int GetRejectedCount() const { return m_rejectedCount; }
+
+private:
+    struct Stage
+    {
+        Shader::Type type;
+        std::span<const char*> paths;
+    };
+
+    bool Build(ShaderProgram& shaderProgram, std::span<const Stage> stages, std::span<const std::string> defines = {});
+
+    // Hash of the driver strings. Computed once, it needs a GL context
+    std::uint64_t GetDriverKey();
+
+    std::string GetBinaryPath(std::uint64_t key) const;
+    bool ReadBinary(ShaderProgram& shaderProgram, std::uint64_t key);
+    bool WriteBinary(const ShaderProgram& shaderProgram, std::uint64_t key) const;
+
+private:
+    std::string m_directory;
+
+    bool m_enabled;
+
+    // Set when the driver key is computed. Also disables the cache if the driver has no binary formats
+    bool m_driverChecked;
+    std::uint64_t m_driverKey;
+
+    std::vector<std::string> m_dependencies;
+
+    unsigned int m_hitCount;
+    unsigned int m_missCount;
+    unsigned int m_rejectedCount;
+};
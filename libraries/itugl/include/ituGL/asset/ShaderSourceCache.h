@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Shader source files loaded from disk and split at their #include directives, shared by all the shader loaders
+// Each file is read only once, so building many programs or variants with the same files doesn't touch the disk again
+class ShaderSourceCache
+{
+public:
+    // Part of a parsed source file
+    struct Segment
+    {
+        enum class Type
+        {
+            // Lines of code, from offset with size characters
+            Text,
+            // The #version line. It must stay the first line of the shader, before any #line directive
+            Version,
+            // #include directive, replaced by the contents of includePath
+            Include,
+        };
+
+        Type type;
+        size_t offset;
+        size_t size;
+        // Line number in the file of the first line of the segment, starting at 1
+        int line;
+        std::string includePath;
+    };
+
+    struct SourceFile
+    {
+        std::string path;
+        std::string text;
+        std::vector<Segment> segments;
+        // The file has #pragma once, it is included only once per shader
+        bool includeOnce = false;
+
+        inline std::string_view GetText(const Segment& segment) const { return std::string_view(text).substr(segment.offset, segment.size); }
+    };
+
+public:
+    ShaderSourceCache();
+
+    static ShaderSourceCache& GetDefault();
+
+    // Parsed file, read from disk the first time. Returns nullptr if it can't be read. Thread-safe
+    std::shared_ptr<const SourceFile> GetFile(std::string_view path);
+
+    // Directory where included files are searched, after the directory of the file that includes them
+    void AddIncludeDirectory(std::string_view directory);
+
+    // Forget a file, so it is read again next time. Used when a file changes
+    void Invalidate(std::string_view path);
+    void Clear();
+
+    // Path used as key: normalized, with forward slashes
+    static std::string NormalizePath(std::string_view path);
+
+private:
+    std::shared_ptr<SourceFile> ParseFile(const std::string& path) const;
+    std::string ResolveInclude(std::string_view name, const std::string& includingPath) const;
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<const SourceFile>> m_files;
+    std::vector<std::string> m_includeDirectories;
+};
@@ -1,7 +1,17 @@
 #pragma once
 
 #include <ituGL/asset/TextureLoader.h>
+#include <ituGL/asset/AssetHandle.h>
+#include <ituGL/asset/DDSFile.h>
 #include <ituGL/texture/Texture2DObject.h>
+#include <ituGL/texture/MipChain.h>
+#include <ituGL/core/Color.h>
+#include <ituGL/core/JobSystem.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class AsyncLoadQueue;
 
 // Asset loader for Texture2DObject
 class Texture2DLoader : public TextureLoader<Texture2DObject>
@@ -13,6 +23,18 @@ public:
     // Load the texture from the path
     Texture2DObject Load(const char* path) override;
 
+    // Same as Load, but returns false instead of asserting if the image can't be read, for files that may be half written
+    bool TryLoad(const char* path, Texture2DObject& texture2D);
+
+    // Load many textures, decoding them and generating their mipmaps in parallel. They are uploaded from the calling thread
+    std::vector<Texture2DObject> LoadBatch(std::span<const char* const> paths, JobSystem& jobSystem = JobSystem::GetDefault());
+
+    // Decode the texture in the background. The texture has a 1x1 placeholder image until it is uploaded
+    AssetHandle<Texture2DObject> LoadAsync(const char* path, AsyncLoadQueue& loadQueue) const;
+
+    // Same as LoadAsync, but returns the same handle if the path was already requested
+    AssetHandle<Texture2DObject> LoadSharedAsync(const char* path, AsyncLoadQueue& loadQueue);
+
     // Helper to easily load a shared texture
     static std::shared_ptr<Texture2DObject> LoadTextureShared(const char* path,
         TextureObject::Format format, TextureObject::InternalFormat internalFormat,
@@ -21,8 +43,56 @@ public:
     inline bool GetFlipVertical() const { return m_flipVertical; }
     inline void SetFlipVertical(bool flipVertical) { m_flipVertical = flipVertical; }
 
+    // If true, mipmaps are generated on the CPU with the mipmap filter, in the same thread as the decoding
+    // Otherwise they are generated by the driver after the upload
+    inline bool GetCpuMipmap() const { return m_cpuMipmap; }
+    inline void SetCpuMipmap(bool cpuMipmap) { m_cpuMipmap = cpuMipmap; }
+
+    inline MipChain::Filter GetMipmapFilter() const { return m_mipmapFilter; }
+    inline void SetMipmapFilter(MipChain::Filter mipmapFilter) { m_mipmapFilter = mipmapFilter; }
+
+    // If true, a cooked DDS file next to the source image is loaded instead, when it is not older than the source
+    // Cooked files have compressed data and mipmaps already, see the textureCooker tool
+    inline bool GetPreferCooked() const { return m_preferCooked; }
+    inline void SetPreferCooked(bool preferCooked) { m_preferCooked = preferCooked; }
+
+    // Path of the cooked file of a source image: the same path with the .dds extension
+    static std::string GetCookedPath(const char* path);
+
+    // Color of the placeholder image of textures loaded asynchronously
+    inline const Color& GetPlaceholderColor() const { return m_placeholderColor; }
+    inline void SetPlaceholderColor(const Color& placeholderColor) { m_placeholderColor = placeholderColor; }
+
+private:
+    // Set the decoded image in the texture, with the filtering and mipmap settings
+    static void UploadImage(Texture2DObject& texture2D, int width, int height, TextureObject::Format format, TextureObject::InternalFormat internalFormat,
+        std::span<const std::byte> data, Data::Type dataType, bool generateMipmap);
+
+    // Set all the levels of a mip chain generated on the CPU in the texture
+    static void UploadMipChain(Texture2DObject& texture2D, const MipChain& mipChain, TextureObject::Format format, TextureObject::InternalFormat internalFormat);
+
+    // Read the cooked file of the source image, if it is up to date and was cooked with the same sRGB and flip settings
+    // Thread-safe, it doesn't call GL
+    static bool LoadCooked(const char* path, DDSFile& cookedFile, TextureObject::InternalFormat internalFormat, bool flipVertical);
+
+    // Set all the compressed levels of a cooked file in the texture
+    static void UploadCooked(Texture2DObject& texture2D, const DDSFile& cookedFile);
+
+    // Decode the image and generate its mip chain. Thread-safe, it doesn't call GL
+    static bool LoadMipChain(const char* path, MipChain& mipChain, TextureObject::Format format, TextureObject::InternalFormat internalFormat,
+        bool flipVertical, MipChain::Filter filter);
+
 private:
     // If true, the texture will be flipped vertically on load
     // This option exists because some systems define the vertical origin as "up", and others as "down"
     bool m_flipVertical;
+
+    bool m_cpuMipmap;
+    bool m_preferCooked;
+    MipChain::Filter m_mipmapFilter;
+
+    Color m_placeholderColor;
+
+    // Handles of the textures loaded with LoadSharedAsync
+    std::unordered_map<std::string, AssetHandle<Texture2DObject>> m_sharedAsyncAssets;
 };
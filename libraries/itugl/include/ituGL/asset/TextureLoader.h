@@ -40,10 +40,12 @@ protected:
 class TextureLoaderUtils
 {
 public:
+    // Decode the image file. Doesn't use GL, so it can be called from any thread
     static std::span<const std::byte> LoadTexture2DData(const char* path, int& width, int& height, Data::Type& dataType, TextureObject::Format format, TextureObject::InternalFormat internalFormat, bool flipVertical);
     static void FreeTexture2DData(std::span<const std::byte> data);
 private:
     static bool IsHDR(TextureObject::InternalFormat internalFormat);
+    static void FlipVertical(std::span<const std::byte> data, int height);
 };
 
 template<typename T>
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <ituGL/asset/AssetPack.h>
+#include <ituGL/core/MappedFile.h>
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Content of a file opened with VirtualFileSystem
+// Depending on where the file is, the data is in a mapped loose file, in a mapped pack, or decompressed in memory
+class VirtualFile
+{
+public:
+    VirtualFile();
+
+    // Move semantics, the data may point to the mapped file
+    VirtualFile(VirtualFile&& virtualFile) noexcept;
+    VirtualFile& operator = (VirtualFile&& virtualFile) noexcept;
+    VirtualFile(const VirtualFile&) = delete;
+    VirtualFile& operator = (const VirtualFile&) = delete;
+
+    void Close();
+
+    inline bool IsOpen() const { return m_open; }
+
+    inline std::span<const std::byte> GetData() const { return m_data; }
+    inline size_t GetSize() const { return m_data.size(); }
+
+    inline std::string_view GetText() const { return std::string_view(reinterpret_cast<const char*>(m_data.data()), m_data.size()); }
+
+private:
+    friend class VirtualFileSystem;
+
+    bool m_open;
+    std::span<const std::byte> m_data;
+
+    // Loose files are mapped
+    MappedFile m_mappedFile;
+
+    // Compressed files are decompressed here
+    std::vector<std::byte> m_buffer;
+
+    // Files read in place keep their pack alive
+    std::shared_ptr<const AssetPack> m_pack;
+};
+
+// Single place where the asset loaders read their files
+// Files are looked up first in the mounted packs, the last mounted first, and then on disk, if loose files are enabled
+// Reads are thread-safe, so loaders can use it in worker threads
+class VirtualFileSystem
+{
+public:
+    VirtualFileSystem();
+
+    static VirtualFileSystem& GetDefault();
+
+    // Map a pack. Its paths are found under the mount point, for example "models" for a pack built from that directory
+    // Returns false if the pack can't be opened
+    bool Mount(const char* packPath, std::string_view mountPoint = "");
+    void UnmountAll();
+
+    // If files not found in the packs are read from disk. Default: true
+    bool GetLooseFilesEnabled() const;
+    void SetLooseFilesEnabled(bool looseFilesEnabled);
+
+    // If the file exists, in a pack or on disk
+    bool Exists(std::string_view path) const;
+
+    // If the file is in a mounted pack
+    bool IsPacked(std::string_view path) const;
+
+    // Open the file to read its data. Returns false if it doesn't exist or can't be read
+    bool Open(std::string_view path, VirtualFile& file) const;
+
+private:
+    struct MountedPack
+    {
+        std::shared_ptr<AssetPack> pack;
+        // Normalized, with a separator at the end if not empty
+        std::string mountPoint;
+    };
+
+    // Find the file in the packs. Returns the entry and the pack, or nullptr
+    const AssetPack::Entry* FindPacked(const std::string& normalizedPath, std::shared_ptr<const AssetPack>& pack) const;
+
+private:
+    mutable std::shared_mutex m_mutex;
+
+    std::vector<MountedPack> m_packs;
+
+    bool m_looseFilesEnabled;
+};
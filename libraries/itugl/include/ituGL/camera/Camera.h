@@ -41,6 +41,8 @@ public:
 
     std::vector<glm::vec4> GetFrustumCornersWorldSpace() const;
     std::vector<glm::vec3> GetFrustumCornersWorldSpace3D() const;
+    // Frustum corners for any view projection matrix, for example from a previous frame
+    static std::vector<glm::vec3> GetFrustumCornersWorldSpace3D(const glm::mat4& viewProjMatrix);
     glm::mat4 GetInvViewProjMatrix() const;
 
 
@@ -13,6 +13,8 @@ public:
         ArrayBuffer = GL_ARRAY_BUFFER,
         // Element Buffer Object
         ElementArrayBuffer = GL_ELEMENT_ARRAY_BUFFER,
+        // Uniform Buffer Object
+        UniformBuffer = GL_UNIFORM_BUFFER,
         // TODO: There are more types, add them when they are supported
     };
 
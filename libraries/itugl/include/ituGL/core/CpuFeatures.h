@@ -0,0 +1,37 @@
+#pragma once
+
+// Instruction sets of the CPU running the program, to pick between the versions of the SIMD kernels
+// The library keeps the default compiler flags. Kernels for wider instruction sets are built for them function by function,
+// between ITUGL_AVX2_BEGIN and ITUGL_AVX2_END, and are only called after checking the CPU here
+class CpuFeatures
+{
+public:
+    CpuFeatures() = delete;
+
+    // If the CPU and the OS support AVX2. Only AVX2 is checked, the kernels are not built with FMA
+    static bool IsAvx2Supported();
+
+    // If the AVX2 kernels are used. Enabled when supported, and can be disabled to compare them with the SSE2 kernels
+    static bool IsAvx2Enabled();
+    static void SetAvx2Enabled(bool enabled);
+};
+
+// SSE2 kernels are built on every x86 target. AVX2 kernels too, with the compilers that can target single functions
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ITUGL_SIMD_SSE2
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define ITUGL_SIMD_AVX2
+#endif
+#endif
+
+// Functions defined between these are built for AVX2. MSVC allows the AVX2 intrinsics in any function
+#if defined(__clang__)
+#define ITUGL_AVX2_BEGIN _Pragma("clang attribute push (__attribute__((target(\"avx2\"))), apply_to = function)")
+#define ITUGL_AVX2_END _Pragma("clang attribute pop")
+#elif defined(__GNUC__)
+#define ITUGL_AVX2_BEGIN _Pragma("GCC push_options") _Pragma("GCC target(\"avx2\")")
+#define ITUGL_AVX2_END _Pragma("GCC pop_options")
+#else
+#define ITUGL_AVX2_BEGIN
+#define ITUGL_AVX2_END
+#endif
@@ -20,6 +20,9 @@ public:
         UShort = GL_UNSIGNED_SHORT,
         Int = GL_INT,
         UInt = GL_UNSIGNED_INT,
+        // Packed types, with all the components in a single value
+        Int2101010Rev = GL_INT_2_10_10_10_REV,
+        UInt2101010Rev = GL_UNSIGNED_INT_2_10_10_10_REV,
         // And more...
     };
 
@@ -30,12 +33,15 @@ public:
 
     // Templated method to convert from types to the enum Type
     template<typename T>
-    static Type GetType();
+    static constexpr Type GetType();
     template<typename T>
-    static Type GetType(const T&);
+    static constexpr Type GetType(const T&);
 
     // Get size in bytes for each Type
-    static unsigned int GetTypeSize(Type type);
+    static constexpr unsigned int GetTypeSize(Type type);
+
+    // Packed types store all the components in a single value of GetTypeSize bytes
+    static constexpr bool IsPackedType(Type type);
 
     // Convert data to a span of bytes
     template <typename T>
@@ -48,6 +54,30 @@ public:
     static std::span<const std::byte> GetBytes(std::span<const T> data);
 };
 
+// Constexpr, so vertex layouts can be checked at compile time
+constexpr unsigned int Data::GetTypeSize(Type type)
+{
+    switch (type)
+    {
+    case Type::Byte:
+    case Type::UByte:
+        return 1;
+    case Type::Short:
+    case Type::UShort:
+    case Type::Half:
+        return 2;
+    case Type::Double:
+        return 8;
+    default:
+        return 4;
+    }
+}
+
+constexpr bool Data::IsPackedType(Type type)
+{
+    return type == Type::Int2101010Rev || type == Type::UInt2101010Rev;
+}
+
 // Template methods implementation to perform the conversion to bytes, not relevant to the course
 
 template <typename T>
@@ -75,13 +105,13 @@ std::span<const std::byte> Data::GetBytes(std::span<const T> data)
 }
 
 template<typename T>
-inline Data::Type Data::GetType(const T&) { return GetType<T>(); }
-
-template<> inline Data::Type Data::GetType<GLfloat>() { return Type::Float; }
-template<> inline Data::Type Data::GetType<GLdouble>() { return Type::Double; }
-template<> inline Data::Type Data::GetType<GLbyte>() { return Type::Byte; }
-template<> inline Data::Type Data::GetType<GLubyte>() { return Type::UByte; }
-template<> inline Data::Type Data::GetType<GLshort>() { return Type::Short; }
-template<> inline Data::Type Data::GetType<GLushort>() { return Type::UShort; }
-template<> inline Data::Type Data::GetType<GLint>() { return Type::Int; }
-template<> inline Data::Type Data::GetType<GLuint>() { return Type::UInt; }
+constexpr Data::Type Data::GetType(const T&) { return GetType<T>(); }
+
+template<> constexpr Data::Type Data::GetType<GLfloat>() { return Type::Float; }
+template<> constexpr Data::Type Data::GetType<GLdouble>() { return Type::Double; }
+template<> constexpr Data::Type Data::GetType<GLbyte>() { return Type::Byte; }
+template<> constexpr Data::Type Data::GetType<GLubyte>() { return Type::UByte; }
+template<> constexpr Data::Type Data::GetType<GLshort>() { return Type::Short; }
+template<> constexpr Data::Type Data::GetType<GLushort>() { return Type::UShort; }
+template<> constexpr Data::Type Data::GetType<GLint>() { return Type::Int; }
+template<> constexpr Data::Type Data::GetType<GLuint>() { return Type::UInt; }
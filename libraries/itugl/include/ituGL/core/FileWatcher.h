@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Detects when files change on disk
+// Uses inotify on Linux. On other platforms, or if inotify fails, it checks the modification times every poll interval
+// If only the watch of a directory fails, the files in it are checked by modification time
+// Changes are collected when Poll is called, so they are handled in the calling thread
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    // Not copyable, it owns the inotify descriptor
+    FileWatcher(const FileWatcher&) = delete;
+    void operator = (const FileWatcher&) = delete;
+
+    // Start watching a file. It doesn't need to exist yet
+    void AddFile(std::string_view path);
+    void RemoveFile(std::string_view path);
+    bool IsWatching(std::string_view path) const;
+
+    // Add the paths of the files that changed since the last poll, normalized like ShaderSourceCache::NormalizePath
+    // Each path is added once, even if the file was written many times
+    void Poll(std::vector<std::string>& changedPaths);
+
+    // If the changes come from inotify, instead of checking the modification times
+    bool IsUsingNotifications() const;
+
+    // If the file is checked by modification time, because its directory couldn't be watched
+    bool IsPolling(std::string_view path) const;
+
+    // Time between checks of the modification times, when not using notifications
+    inline std::chrono::milliseconds GetPollInterval() const { return m_pollInterval; }
+    inline void SetPollInterval(std::chrono::milliseconds pollInterval) { m_pollInterval = pollInterval; }
+
+private:
+    void PollNotifications(std::vector<std::string>& changedPaths);
+    void PollModificationTimes(std::vector<std::string>& changedPaths);
+
+    static std::string NormalizePath(std::string_view path);
+    static std::filesystem::file_time_type GetModificationTime(const std::string& path);
+
+private:
+    // Watched files, with their modification time when they were added or last changed
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_files;
+
+    std::chrono::milliseconds m_pollInterval;
+    std::chrono::steady_clock::time_point m_lastPollTime;
+
+    // Descriptor of the inotify instance, -1 if not available
+    int m_notifyDescriptor;
+
+    // Directories are watched instead of the files, because editors often save by replacing the file
+    // Directories that failed to be watched have a descriptor of -1
+    std::unordered_map<int, std::string> m_watchDirectories;
+    std::unordered_map<std::string, int> m_directoryWatches;
+
+    // Files checked by modification time while using notifications
+    std::unordered_set<std::string> m_polledFiles;
+};
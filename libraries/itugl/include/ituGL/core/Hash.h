@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+// 64-bit FNV-1a hash. Not cryptographic, but stable across runs and platforms, so it can be stored in files
+class Hash
+{
+public:
+    Hash() = delete;
+
+    static constexpr std::uint64_t Seed = 14695981039346656037ull;
+
+    // Hash a block of memory. Pass a previous hash as seed to combine several blocks
+    static inline std::uint64_t FNV1a(std::span<const std::byte> data, std::uint64_t hash = Seed)
+    {
+        for (std::byte value : data)
+        {
+            hash ^= static_cast<std::uint64_t>(value);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static inline std::uint64_t FNV1a(std::string_view text, std::uint64_t hash = Seed)
+    {
+        return FNV1a(std::as_bytes(std::span<const char>(text.data(), text.size())), hash);
+    }
+};
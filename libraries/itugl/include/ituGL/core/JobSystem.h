@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool of worker threads that run small jobs
+// Each worker has its own queue. Workers run their newest jobs first and steal the oldest jobs of other queues when idle
+class JobSystem
+{
+public:
+    using Job = std::function<void()>;
+
+    // Function called for a range of elements [begin, end), chunkIndex identifies the range
+    using ParallelForFunction = std::function<void(size_t begin, size_t end, size_t chunkIndex)>;
+
+    // Tracks a group of scheduled jobs, to wait until all of them are finished
+    class Counter
+    {
+    public:
+        Counter() : m_pending(0) {}
+
+        inline bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+        std::atomic<unsigned int> m_pending;
+    };
+
+public:
+    // Creates the job system with a number of worker threads. With 0 workers, jobs run when waiting for them
+    explicit JobSystem(unsigned int workerCount);
+    // Runs the jobs still queued before stopping the workers
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator = (const JobSystem&) = delete;
+
+    inline unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_threads.size()); }
+
+    // Adds a job to be run by any worker. If counter is set, it is kept pending until the job finishes
+    void Schedule(Job job, Counter* counter = nullptr);
+
+    // Blocks until all the jobs of the counter are finished. The calling thread runs pending jobs meanwhile,
+    // and sleeps while there are none
+    void Wait(Counter& counter);
+
+    // Splits [0, count) in chunks of chunkSize elements and runs the function for each of them in parallel
+    // Returns when all the chunks are finished. Chunk indices are ordered like the elements
+    void ParallelFor(size_t count, size_t chunkSize, const ParallelForFunction& function);
+
+    // Shared job system, with one worker per hardware thread except the calling one
+    static JobSystem& GetDefault();
+
+private:
+    struct JobEntry
+    {
+        Job job;
+        Counter* counter;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<JobEntry> jobs;
+    };
+
+    unsigned int GetCurrentQueueIndex() const;
+
+    bool TryPop(unsigned int queueIndex, JobEntry& entry);
+    bool TrySteal(unsigned int queueIndex, JobEntry& entry);
+    bool TryRunJob(unsigned int queueIndex);
+
+    void WorkerMain(unsigned int queueIndex);
+
+private:
+    // Queue 0 is shared by the threads that are not workers, queue i + 1 belongs to worker i
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    // Number of jobs waiting in any queue
+    std::atomic<unsigned int> m_queuedJobCount;
+
+    // Used to distribute the jobs scheduled from outside the workers
+    std::atomic<unsigned int> m_nextQueueIndex;
+
+    // Idle workers sleep here until there are new jobs, and waiting threads until their counter is done
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCondition;
+    bool m_stopping;
+};
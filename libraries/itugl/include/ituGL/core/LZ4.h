@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+// Compression in the LZ4 block format. Fast to decompress, so assets can be stored compressed without slowing loads
+// Only the raw block format is supported, without the LZ4 frame header
+class LZ4
+{
+public:
+    LZ4() = delete;
+
+    // Size of the destination buffer that Compress needs in the worst case
+    static size_t GetMaxCompressedSize(size_t size);
+
+    // Compress the data into the destination, that must have at least GetMaxCompressedSize bytes
+    // Returns the size of the compressed data
+    static size_t Compress(std::span<const std::byte> data, std::span<std::byte> compressedData);
+
+    // Decompress the data. The size of the destination must be the size of the original data
+    // Returns false if the compressed data is invalid, or doesn't decompress to exactly that size
+    static bool Decompress(std::span<const std::byte> compressedData, std::span<std::byte> data);
+};
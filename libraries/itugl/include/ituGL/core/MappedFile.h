@@ -0,0 +1,40 @@
+#pragma once
+
+#include <span>
+#include <cstddef>
+
+// Read-only view of a file mapped in memory. Pages are loaded by the OS when accessed, so opening is cheap
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // Move semantics, the mapping can't be shared
+    MappedFile(MappedFile&& mappedFile) noexcept;
+    MappedFile& operator = (MappedFile&& mappedFile) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator = (const MappedFile&) = delete;
+
+    // Maps the whole file. Returns false if the file can't be opened
+    bool Open(const char* path);
+    void Close();
+
+    inline bool IsOpen() const { return m_data != nullptr; }
+
+    inline std::span<const std::byte> GetData() const { return std::span<const std::byte>(m_data, m_size); }
+    inline size_t GetSize() const { return m_size; }
+
+    // Reads every page of the file, so later accesses don't wait for the disk. Useful in background threads
+    void Prefetch() const;
+
+private:
+    const std::byte* m_data;
+    size_t m_size;
+
+    // Platform specific handles
+#ifdef _WIN32
+    void* m_fileHandle;
+    void* m_mappingHandle;
+#endif
+};
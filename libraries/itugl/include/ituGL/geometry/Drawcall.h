@@ -27,10 +27,23 @@ public:
     Drawcall();
     Drawcall(Primitive primitive, GLsizei count, GLint first = 0);
     Drawcall(Primitive primitive, GLsizei count, Data::Type eboType, GLint first = 0);
+    // Indexed drawcall that adds baseVertex to each element, to share an EBO between parts of a larger VBO
+    Drawcall(Primitive primitive, GLsizei count, Data::Type eboType, GLint first, GLint baseVertex);
 
     // Check if the drawcall is valid
     inline bool IsValid() const { return m_primitive != Primitive::Invalid && m_count > 0; }
 
+    inline GLsizei GetCount() const { return m_count; }
+
+    // Number of instances drawn, 1 for a drawcall that is not instanced
+    inline GLsizei GetInstanceCount() const { return m_instanceCount; }
+    inline void SetInstanceCount(GLsizei instanceCount) { m_instanceCount = instanceCount; }
+
+    // Index of the first instance. Attributes with a divisor start at this instance instead of the first one
+    // Drawing with a base instance other than 0 needs OpenGL 4.2
+    inline GLuint GetBaseInstance() const { return m_baseInstance; }
+    inline void SetBaseInstance(GLuint baseInstance) { m_baseInstance = baseInstance; }
+
     // Execute the drawcall
     void Draw() const;
 
@@ -46,4 +59,13 @@ private:
 
     // Data type of the elements in the EBO (int, uint, short, byte, etc.). A value of None means no EBO
     Data::Type m_eboType;
+
+    // Value added to the elements before fetching the vertices. Only with EBO
+    GLint m_baseVertex;
+
+    // Number of times the vertices are drawn. Attributes with a divisor advance once per instance
+    GLsizei m_instanceCount;
+
+    // Offset added to the instance index of the attributes with a divisor
+    GLuint m_baseInstance;
 };
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+class TerrainHeightfield;
+class JobSystem;
+
+// Scatters instances over a heightfield with a Poisson-disk distribution, where no two points are closer than a min distance
+// The terrain is split in square chunks, generated in parallel in 4 phases so that neighbour chunks never run at the same time
+// Each chunk sees the points of the neighbours generated before it, so there are no seams between chunks,
+// and the result is the same with any number of workers
+// The points are then thinned by the density, slope and height masks, which keeps the distribution blue noise
+class FoliageScatter
+{
+public:
+    struct Settings
+    {
+        // Min distance between two points, before the masks remove some of them
+        float minDistance = 1.0f;
+
+        // Fraction of the points kept where the masks don't remove any
+        float density = 1.0f;
+
+        // No instances on slopes steeper than maxSlope, in radians. The density fades out over slopeFade radians before it
+        float maxSlope = 1.0f;
+        float slopeFade = 0.0f;
+
+        // No instances outside the height band. The density fades out over heightFade units inside the limits
+        float minHeight = -FLT_MAX;
+        float maxHeight = FLT_MAX;
+        float heightFade = 0.0f;
+
+        // Uniform scale of the instances, random in this range
+        glm::vec2 scaleRange = glm::vec2(1.0f);
+
+        // Different seeds give different distributions
+        unsigned int seed = 0;
+    };
+
+    // 16 bytes per instance: position, and rotation around the y axis in radians and scale as half floats
+    struct Instance
+    {
+        glm::vec3 position;
+        std::uint16_t yaw;
+        std::uint16_t scale;
+    };
+
+    // The instances of a chunk are consecutive in the list, and the chunks are in rows, like the heights
+    struct Chunk
+    {
+        unsigned int firstInstance = 0;
+        unsigned int instanceCount = 0;
+
+        // Bounds of the positions of the instances
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        glm::vec3 boundsMax = glm::vec3(0.0f);
+    };
+
+public:
+    FoliageScatter() = delete;
+
+    // Chunks are chunkSize x chunkSize over the bounds of the heightfield. chunkSize can't be smaller than the min distance
+    static void Scatter(const TerrainHeightfield& heightfield, const Settings& settings, float chunkSize, JobSystem& jobSystem,
+        std::vector<Instance>& instances, std::vector<Chunk>& chunks);
+
+    static float GetYaw(const Instance& instance);
+    static float GetScale(const Instance& instance);
+};
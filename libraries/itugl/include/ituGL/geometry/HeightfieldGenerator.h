@@ -0,0 +1,74 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+class JobSystem;
+
+// Generates heightfields from fractal gradient noise, and the tangent frames of their vertices
+// Rows are split across the job system, and each row is computed with SIMD (AVX2 or SSE2)
+// Every sample is computed on its own, so the result doesn't depend on the number of threads
+class HeightfieldGenerator
+{
+public:
+    HeightfieldGenerator() = delete;
+
+    // Fractal Brownian motion: octaves of gradient noise, each with lacunarity times the frequency and gain times the amplitude
+    struct NoiseSettings
+    {
+        // Noise coordinates of the first and the last sample of the grid
+        glm::vec2 noiseMin = glm::vec2(0.0f);
+        glm::vec2 noiseMax = glm::vec2(1.0f);
+        // Noise coordinate z, the same for all the samples
+        float noiseZ = 0.0f;
+
+        float lacunarity = 2.0f;
+        float gain = 0.5f;
+        int octaves = 6;
+
+        // Scale of the noise values
+        float height = 1.0f;
+    };
+
+    // Fills the width x height samples, row by row, with the same values as stb_perlin_fbm_noise3 (within rounding)
+    static void Generate(std::span<float> heights, unsigned int width, unsigned int height, const NoiseSettings& settings,
+        JobSystem& jobSystem);
+    static std::vector<float> Generate(unsigned int width, unsigned int height, const NoiseSettings& settings, JobSystem& jobSystem);
+
+    // Same as Generate, using only scalar code in the calling thread. Used to validate the optimized path
+    static void GenerateReference(std::span<float> heights, unsigned int width, unsigned int height, const NoiseSettings& settings);
+
+    // Computes the normal, tangent and bitangent of each vertex of a grid with the heights in y and the spacing in x and z
+    // Tangent and bitangent are the central differences along x and z, normalized, and the normal is their normalized cross product
+    // The vectors are written as 3 floats to the interleaved vertices, at the given offsets
+    static void ComputeTangentFrames(std::span<const float> heights, unsigned int width, unsigned int height, const glm::vec2& spacing,
+        std::span<std::byte> vertexData, size_t vertexSize, size_t normalOffset, size_t tangentOffset, size_t bitangentOffset,
+        JobSystem& jobSystem);
+
+    // Same as ComputeTangentFrames, for an array of vertex structs
+    template<typename T>
+    static void ComputeTangentFrames(std::span<const float> heights, unsigned int width, unsigned int height, const glm::vec2& spacing,
+        std::vector<T>& vertices, size_t normalOffset, size_t tangentOffset, size_t bitangentOffset, JobSystem& jobSystem);
+
+    // Same as ComputeTangentFrames, using only scalar code in the calling thread
+    static void ComputeTangentFramesReference(std::span<const float> heights, unsigned int width, unsigned int height, const glm::vec2& spacing,
+        std::span<std::byte> vertexData, size_t vertexSize, size_t normalOffset, size_t tangentOffset, size_t bitangentOffset);
+
+private:
+    static void GenerateRows(std::span<float> heights, unsigned int width, unsigned int height, const NoiseSettings& settings,
+        unsigned int firstRow, unsigned int lastRow, bool reference);
+
+    static void ComputeTangentFrameRows(std::span<const float> heights, unsigned int width, unsigned int height, const glm::vec2& spacing,
+        std::span<std::byte> vertexData, size_t vertexSize, size_t normalOffset, size_t tangentOffset, size_t bitangentOffset,
+        unsigned int firstRow, unsigned int lastRow, bool reference);
+};
+
+template<typename T>
+void HeightfieldGenerator::ComputeTangentFrames(std::span<const float> heights, unsigned int width, unsigned int height, const glm::vec2& spacing,
+    std::vector<T>& vertices, size_t normalOffset, size_t tangentOffset, size_t bitangentOffset, JobSystem& jobSystem)
+{
+    std::span<std::byte> vertexData(reinterpret_cast<std::byte*>(vertices.data()), vertices.size() * sizeof(T));
+    ComputeTangentFrames(heights, width, height, spacing, vertexData, sizeof(T), normalOffset, tangentOffset, bitangentOffset, jobSystem);
+}
@@ -6,6 +6,8 @@
 #include <ituGL/geometry/VertexAttribute.h>
 #include <ituGL/geometry/Drawcall.h>
 #include <ituGL/shader/ShaderProgram.h>
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
 #include <vector>
 #include <unordered_map>
 
@@ -100,6 +102,16 @@ public:
         std::span<const TVertex> vertices, std::span<const TElement> elements,
         TIterator it, const TIterator itEnd, const SemanticMap& locations = SemanticMap());
 
+    // Adds a new submesh, adding a new VAO and a new VBO, with the attributes of a VertexLayout
+    template<typename TLayout>
+    unsigned int AddSubmesh(Drawcall::Primitive primitive,
+        std::span<const typename TLayout::Vertex> vertices, const SemanticMap& locations = SemanticMap());
+
+    // Adds a new submesh, adding a new VAO, a new VBO and an EBO, with the attributes of a VertexLayout
+    template<typename TLayout, typename TElement>
+    unsigned int AddSubmesh(Drawcall::Primitive primitive,
+        std::span<const typename TLayout::Vertex> vertices, std::span<const TElement> elements, const SemanticMap& locations = SemanticMap());
+
     inline unsigned int GetVertexBufferCount() const { return static_cast<unsigned int>(m_vbos.size()); }
     inline const VertexBufferObject& GetVertexBuffer(unsigned int vboIndex) const { return m_vbos[vboIndex]; }
 
@@ -113,6 +125,17 @@ public:
     inline const VertexArrayObject& GetSubmeshVertexArray(unsigned int submeshIndex) const { return m_vaos[m_submeshes[submeshIndex].vaoIndex]; }
     inline const Drawcall& GetSubmeshDrawcall(unsigned int submeshIndex) const { return m_submeshes[submeshIndex].drawcall; }
 
+    // Transform from the positions stored in the vertices to the model space, for quantized positions
+    // The same scale is used on all axes, so the normals keep their direction
+    void SetSubmeshPositionTransform(unsigned int submeshIndex, const glm::vec3& offset, float scale);
+    bool HasSubmeshPositionTransform(unsigned int submeshIndex) const;
+    glm::mat4 GetSubmeshPositionTransform(unsigned int submeshIndex) const;
+
+    // Adds an attribute read from a VBO outside the mesh, that advances once per instance, to the VAO of a submesh
+    // Used to draw the submesh instanced, with per instance data like a transform. Submeshes sharing the VAO get it too
+    void SetSubmeshInstanceAttribute(unsigned int submeshIndex, const VertexBufferObject& vbo, GLuint location,
+        const VertexAttribute& attribute, GLint offset, GLsizei stride);
+
     // Draws a submesh
     void DrawSubmesh(int submeshIndex) const;
 
@@ -123,6 +146,8 @@ private:
     {
         unsigned int vaoIndex;
         Drawcall drawcall;
+        glm::vec3 positionOffset = glm::vec3(0.0f);
+        float positionScale = 1.0f;
     };
 
 private:
@@ -303,3 +328,16 @@ unsigned int Mesh::AddSubmesh(Drawcall::Primitive primitive,
     return AddSubmesh(primitive, 0, static_cast<int>(elements.size()), Data::GetType<TElement>(), vboIndex, eboIndex, it, itEnd, locations);
 }
 
+template<typename TLayout>
+unsigned int Mesh::AddSubmesh(Drawcall::Primitive primitive,
+    std::span<const typename TLayout::Vertex> vertices, const SemanticMap& locations)
+{
+    return AddSubmesh(primitive, vertices, TLayout::LayoutBegin(), TLayout::LayoutEnd(), locations);
+}
+
+template<typename TLayout, typename TElement>
+unsigned int Mesh::AddSubmesh(Drawcall::Primitive primitive,
+    std::span<const typename TLayout::Vertex> vertices, std::span<const TElement> elements, const SemanticMap& locations)
+{
+    return AddSubmesh(primitive, vertices, elements, TLayout::LayoutBegin(), TLayout::LayoutEnd(), locations);
+}
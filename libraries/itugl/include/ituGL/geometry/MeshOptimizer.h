@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Reorders triangle lists so the GPU does less work drawing them
+// Run the steps in this order: vertex cache, overdraw, vertex fetch. Each step keeps most of the gains of the previous one
+// Meshes are indexed triangle lists, with 3 indices per triangle
+class MeshOptimizer
+{
+public:
+    MeshOptimizer() = delete;
+
+    // Results of simulating the post-transform vertex cache
+    struct VertexCacheStatistics
+    {
+        // Vertices transformed, counting the cache misses
+        unsigned int transformedCount;
+        // Average cache miss ratio: vertices transformed per triangle. 0.5 is the best for a regular grid, 3 the worst
+        float acmr;
+        // Average transformed vertex ratio: vertices transformed per vertex in the mesh. 1 is the best
+        float atvr;
+    };
+
+    // Results of simulating the vertex fetch cache
+    struct VertexFetchStatistics
+    {
+        // Bytes read from the vertex buffer, in whole cache lines
+        size_t bytesFetched;
+        // Bytes fetched per byte in the vertex buffer. 1 is the best
+        float overfetch;
+    };
+
+    // Simulate a FIFO post-transform cache, like the one in most GPUs
+    static VertexCacheStatistics AnalyzeVertexCache(std::span<const unsigned int> indices, unsigned int vertexCount, unsigned int cacheSize = 16);
+
+    // Simulate fetching the vertices from memory in cache lines, with a small cache
+    static VertexFetchStatistics AnalyzeVertexFetch(std::span<const unsigned int> indices, unsigned int vertexCount, size_t vertexSize);
+
+    // Reorder the triangles to reuse the transformed vertices, with Tom Forsyth's linear-speed algorithm
+    static void OptimizeVertexCache(std::span<unsigned int> indices, unsigned int vertexCount);
+
+    // Reorder clusters of triangles so the ones facing out of the mesh are drawn first, and hide the ones behind
+    // Clusters are split where the vertex cache restarts, so the vertex cache order is mostly kept
+    // Threshold is how much worse the ACMR can get, 1.05 allows 5% more vertices transformed
+    static void OptimizeOverdraw(std::span<unsigned int> indices, std::span<const std::byte> vertexData, size_t vertexSize, size_t positionOffset,
+        float threshold = 1.05f);
+
+    // Reorder the vertices in the order the triangles use them, and update the indices
+    // Interleaved vertices only. Unused vertices are moved to the end. Returns the number of used vertices
+    static unsigned int OptimizeVertexFetch(std::span<unsigned int> indices, std::span<std::byte> vertexData, size_t vertexSize);
+
+    // Same as OptimizeVertexFetch, for an array of vertex structs. Unused vertices are removed
+    template<typename T>
+    static unsigned int OptimizeVertexFetch(std::span<unsigned int> indices, std::vector<T>& vertices);
+
+    // Run all the steps. The position must be 3 floats. Returns the number of used vertices
+    static unsigned int Optimize(std::span<unsigned int> indices, std::span<std::byte> vertexData, size_t vertexSize, size_t positionOffset);
+
+    // Same as Optimize, for an array of vertex structs
+    template<typename T>
+    static unsigned int Optimize(std::span<unsigned int> indices, std::vector<T>& vertices, size_t positionOffset);
+
+private:
+    // New position of each vertex, in order of first use. Unused vertices get ~0u. Returns the number of used vertices
+    static unsigned int GetVertexFetchRemap(std::span<const unsigned int> indices, std::vector<unsigned int>& remap);
+};
+
+template<typename T>
+unsigned int MeshOptimizer::OptimizeVertexFetch(std::span<unsigned int> indices, std::vector<T>& vertices)
+{
+    std::vector<unsigned int> remap(vertices.size());
+    unsigned int usedCount = GetVertexFetchRemap(indices, remap);
+
+    std::vector<T> reorderedVertices(usedCount);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        if (remap[i] != ~0u)
+        {
+            reorderedVertices[remap[i]] = vertices[i];
+        }
+    }
+    for (unsigned int& index : indices)
+    {
+        index = remap[index];
+    }
+    vertices = std::move(reorderedVertices);
+    return usedCount;
+}
+
+template<typename T>
+unsigned int MeshOptimizer::Optimize(std::span<unsigned int> indices, std::vector<T>& vertices, size_t positionOffset)
+{
+    OptimizeVertexCache(indices, static_cast<unsigned int>(vertices.size()));
+    OptimizeOverdraw(indices, std::as_bytes(std::span<const T>(vertices)), sizeof(T), positionOffset);
+    return OptimizeVertexFetch(indices, vertices);
+}
@@ -14,6 +14,9 @@ class Model
 public:
     Model(std::shared_ptr<Mesh> mesh = nullptr);
 
+    // If the model has a mesh. Models that fail to load don't have one
+    bool HasMesh() const;
+
     Mesh& GetMesh();
     const Mesh& GetMesh() const;
 
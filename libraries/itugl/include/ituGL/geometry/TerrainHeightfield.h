@@ -0,0 +1,90 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+// Heights of a regular grid in the xz plane, with queries at any position
+// Between the samples the surface is bilinear. Positions outside the grid take the height of the closest border
+// Raycasts skip empty space with a quadtree of the min and max heights of each block of cells
+class TerrainHeightfield
+{
+public:
+    struct RayHit
+    {
+        // Distance along the ray direction, in units of its length
+        float distance = 0.0f;
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::vec3 normal = glm::vec3(0.0f, 1.0f, 0.0f);
+    };
+
+public:
+    TerrainHeightfield();
+
+    // Copies width x height heights, row by row. Sample (i, j) is at origin + (i, j) * spacing in the xz plane
+    void Initialize(std::span<const float> heights, unsigned int width, unsigned int height, const glm::vec2& spacing,
+        const glm::vec2& origin = glm::vec2(0.0f));
+
+    inline unsigned int GetWidth() const { return m_width; }
+    inline unsigned int GetHeight() const { return m_height; }
+    inline std::span<const float> GetHeights() const { return m_heights; }
+    inline const glm::vec2& GetSpacing() const { return m_spacing; }
+    inline const glm::vec2& GetOrigin() const { return m_origin; }
+    glm::vec3 GetBoundsMin() const;
+    glm::vec3 GetBoundsMax() const;
+
+    // If the position is over the grid
+    bool Contains(float x, float z) const;
+
+    // Bilinear height at the position
+    float SampleHeight(float x, float z) const;
+
+    // Normal of the bilinear surface at the position
+    glm::vec3 SampleNormal(float x, float z) const;
+
+    // Heights at many positions at once, with SIMD (AVX2 or SSE2). The spans have the same size
+    void SampleHeights(std::span<const float> x, std::span<const float> z, std::span<float> heights) const;
+    void SampleHeightsReference(std::span<const float> x, std::span<const float> z, std::span<float> heights) const;
+
+    // Closest intersection of the ray with the surface, up to maxDistance. Only hits from above the surface are reported
+    bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& hit) const;
+
+    // Same as Raycast, testing all the cells. Used to validate the quadtree traversal
+    bool RaycastReference(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& hit) const;
+
+private:
+    // One level of the quadtree. Level 0 has a node per cell, each next level has a node per 2x2 nodes
+    struct Level
+    {
+        unsigned int width;
+        unsigned int height;
+        std::vector<float> minHeights;
+        std::vector<float> maxHeights;
+    };
+
+private:
+    // Cell that contains the position, clamped to the grid, and the coordinates inside it
+    void GetCell(float x, float z, unsigned int& i, unsigned int& j, float& u, float& v) const;
+
+    void SampleHeights(std::span<const float> x, std::span<const float> z, std::span<float> heights, bool reference) const;
+
+    // First intersection with the bilinear patch of the cell between the distances tMin and tMax
+    bool IntersectCell(unsigned int i, unsigned int j, const glm::vec3& origin, const glm::vec3& direction,
+        float tMin, float tMax, RayHit& hit) const;
+
+    // Distances where the ray enters and exits the box, false if it misses it between tMin and tMax
+    static bool IntersectBox(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec3& origin, const glm::vec3& inverseDirection,
+        float tMin, float tMax, float& tEnter, float& tExit);
+
+    void BuildLevels();
+
+private:
+    std::vector<float> m_heights;
+    unsigned int m_width;
+    unsigned int m_height;
+    glm::vec2 m_spacing;
+    glm::vec2 m_origin;
+
+    std::vector<Level> m_levels;
+};
@@ -23,16 +23,16 @@ public:
     };
 
 public:
-    VertexAttribute(Data::Type type, int components, Semantic semantic = Semantic::Unknown);
-    VertexAttribute(Data::Type type, int components, bool normalized, Semantic semantic = Semantic::Unknown);
+    constexpr VertexAttribute(Data::Type type, int components, Semantic semantic = Semantic::Unknown);
+    constexpr VertexAttribute(Data::Type type, int components, bool normalized, Semantic semantic = Semantic::Unknown);
 
-    inline Data::Type GetType() const { return m_type; }
-    inline int GetComponents() const { return m_components; }
-    inline bool IsNormalized() const { return m_normalized; }
-    inline Semantic GetSemantic() const { return m_semantic; }
+    constexpr Data::Type GetType() const { return m_type; }
+    constexpr int GetComponents() const { return m_components; }
+    constexpr bool IsNormalized() const { return m_normalized; }
+    constexpr Semantic GetSemantic() const { return m_semantic; }
 
-    // Gets the size of the attribute
-    inline int GetSize() const { return Data::GetTypeSize(m_type) * m_components; }
+    // Gets the size of the attribute. Packed types have all the components in one value
+    constexpr int GetSize() const { return Data::GetTypeSize(m_type) * (Data::IsPackedType(m_type) ? 1 : m_components); }
 
     // Gets how many location indices the attribute needs (usually 1)
     int GetLocationSize() const;
@@ -53,14 +53,36 @@ private:
 class VertexAttribute::Layout
 {
 public:
-    Layout(const VertexAttribute& attribute, GLint offset, GLsizei stride);
+    constexpr Layout(const VertexAttribute& attribute, GLint offset, GLsizei stride);
 
-    inline const VertexAttribute& GetAttribute() const { return m_attribute; }
-    inline GLint GetOffset() const { return m_offset; }
-    inline GLsizei GetStride() const { return m_stride; }
+    constexpr const VertexAttribute& GetAttribute() const { return m_attribute; }
+    constexpr GLint GetOffset() const { return m_offset; }
+    constexpr GLsizei GetStride() const { return m_stride; }
 
 private:
     VertexAttribute m_attribute;
     GLint m_offset;
     GLsizei m_stride;
 };
+
+// Constexpr, so attributes can be built at compile time, see VertexLayout
+
+constexpr VertexAttribute::VertexAttribute(Data::Type type, int components, Semantic semantic)
+    : VertexAttribute(type, components, false, semantic)
+{
+}
+
+constexpr VertexAttribute::VertexAttribute(Data::Type type, int components, bool normalized, Semantic semantic)
+    : m_type(type)
+    , m_components(components)
+    , m_normalized(normalized)
+    , m_semantic(semantic)
+{
+}
+
+constexpr VertexAttribute::Layout::Layout(const VertexAttribute& attribute, GLint offset, GLsizei stride)
+    : m_attribute(attribute)
+    , m_offset(offset)
+    , m_stride(stride)
+{
+}
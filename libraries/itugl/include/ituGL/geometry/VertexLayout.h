@@ -0,0 +1,132 @@
+#pragma once
+
+#include <ituGL/geometry/VertexAttribute.h>
+#include <ituGL/geometry/VertexFormat.h>
+#include <ituGL/core/Color.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Vertex layouts described by a C++ vertex struct, checked and built at compile time
+// Each attribute is a member of the struct, so the offsets, types and stride can't go out of sync with it
+//
+// struct Vertex { glm::vec3 position; glm::vec2 texCoord; };
+// using Layout = VertexLayout<Vertex,
+//     ITUGL_VERTEX_ATTRIBUTE(Vertex, position, Position),
+//     ITUGL_VERTEX_ATTRIBUTE(Vertex, texCoord, TexCoord0)>;
+// mesh.AddSubmesh<Layout, unsigned int>(Drawcall::Primitive::Triangles, vertices, indices);
+
+// Attribute type and components for each member type. Specialize it to support new member types
+template<typename T>
+struct VertexAttributeType;
+
+template<typename T> requires std::is_arithmetic_v<T>
+struct VertexAttributeType<T>
+{
+    static constexpr Data::Type type = Data::GetType<T>();
+    static constexpr int components = 1;
+};
+
+template<glm::length_t L, typename T, glm::qualifier Q>
+struct VertexAttributeType<glm::vec<L, T, Q>>
+{
+    static constexpr Data::Type type = Data::GetType<T>();
+    static constexpr int components = L;
+};
+
+template<>
+struct VertexAttributeType<Color>
+{
+    static constexpr Data::Type type = Data::Type::Float;
+    static constexpr int components = 4;
+};
+
+// Attribute stored in a member of the vertex, at the given offset. Use ITUGL_VERTEX_ATTRIBUTE to declare it
+// The type and components can be set explicitly for packed or normalized members, for example an uint32_t with Int2101010Rev
+template<typename TMember, size_t Offset, VertexAttribute::Semantic S,
+    Data::Type Type = VertexAttributeType<TMember>::type, int Components = VertexAttributeType<TMember>::components, bool Normalized = false>
+struct VertexLayoutAttribute
+{
+    static constexpr VertexAttribute attribute = VertexAttribute(Type, Components, Normalized, S);
+    static constexpr size_t offset = Offset;
+    static constexpr size_t size = attribute.GetSize();
+
+    static_assert(Type != Data::Type::None, "Vertex attribute type is not supported");
+    static_assert(Components >= 1 && Components <= 4, "Vertex attributes have 1 to 4 components");
+    static_assert(sizeof(TMember) == size, "Vertex attribute size doesn't match the size of the member");
+    static_assert(Offset % 4 == 0, "Vertex attributes must be aligned to 4 bytes");
+};
+
+// Declares an attribute for a member of the vertex struct, with the type and components of the member
+#define ITUGL_VERTEX_ATTRIBUTE(TVertex, member, semantic) \
+    VertexLayoutAttribute<decltype(TVertex::member), offsetof(TVertex, member), VertexAttribute::Semantic::semantic>
+
+// Declares an attribute for a member of the vertex struct, with explicit type, components and normalization
+#define ITUGL_VERTEX_ATTRIBUTE_FORMAT(TVertex, member, semantic, type, components, normalized) \
+    VertexLayoutAttribute<decltype(TVertex::member), offsetof(TVertex, member), VertexAttribute::Semantic::semantic, \
+        Data::Type::type, components, normalized>
+
+// True if each attribute starts where the previous one ends, and the last one ends at the end of the vertex
+template<typename TVertex, typename... TAttributes>
+constexpr bool IsVertexLayoutPacked()
+{
+    constexpr std::array<size_t, sizeof...(TAttributes)> offsets = { TAttributes::offset... };
+    constexpr std::array<size_t, sizeof...(TAttributes)> sizes = { TAttributes::size... };
+    size_t offset = 0;
+    for (size_t i = 0; i < offsets.size(); ++i)
+    {
+        if (offsets[i] != offset)
+        {
+            return false;
+        }
+        offset += sizes[i];
+    }
+    return offset == sizeof(TVertex);
+}
+
+// Interleaved layout of a vertex struct. The attributes must be in the order of the members, and cover the whole struct
+template<typename TVertex, typename... TAttributes>
+class VertexLayout
+{
+public:
+    using Vertex = TVertex;
+
+    VertexLayout() = delete;
+
+    static constexpr size_t AttributeCount = sizeof...(TAttributes);
+    static constexpr GLsizei Stride = sizeof(TVertex);
+
+    // Layouts of all the attributes, ready for Mesh. Built at compile time
+    static constexpr std::array<VertexAttribute::Layout, AttributeCount> Layouts =
+    {
+        VertexAttribute::Layout(TAttributes::attribute, static_cast<GLint>(TAttributes::offset), Stride)...
+    };
+
+    // Iterators over the layouts, to add the vertices to a Mesh
+    static constexpr const VertexAttribute::Layout* LayoutBegin() { return Layouts.data(); }
+    static constexpr const VertexAttribute::Layout* LayoutEnd() { return Layouts.data() + AttributeCount; }
+
+    // Same attributes in a VertexFormat, for the code that builds the layout at runtime
+    static VertexFormat GetVertexFormat();
+
+    static_assert(AttributeCount > 0, "Vertex layouts need at least one attribute");
+    static_assert(std::is_standard_layout_v<TVertex>, "Vertex struct must have standard layout, to use offsetof");
+    static_assert(sizeof(TVertex) % 4 == 0, "Vertex size must be a multiple of 4 bytes");
+    static_assert(IsVertexLayoutPacked<TVertex, TAttributes...>(), "Vertex attributes must be in the order of the members, without gaps or padding");
+};
+
+template<typename TVertex, typename... TAttributes>
+VertexFormat VertexLayout<TVertex, TAttributes...>::GetVertexFormat()
+{
+    VertexFormat vertexFormat;
+    for (const VertexAttribute::Layout& layout : Layouts)
+    {
+        const VertexAttribute& attribute = layout.GetAttribute();
+        vertexFormat.AddVertexAttribute(attribute.GetType(), attribute.GetComponents(), attribute.IsNormalized(), attribute.GetSemantic());
+    }
+    return vertexFormat;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/ext/vector_int4_sized.hpp>
+#include <glm/ext/vector_uint2_sized.hpp>
+#include <cstddef>
+#include <cstdint>
+
+// Compact encodings of vertex attributes. The GPU decodes them when the vertices are fetched, so shaders don't change
+// Positions: snorm16 inside the bounds of the submesh, moved back with the position transform of the submesh (8 bytes)
+// Normals and tangents: snorm 10-10-10-2, the tangent keeps the bitangent sign in w (4 bytes each, no bitangent)
+// Texture coordinates: half floats (4 bytes)
+class VertexQuantization
+{
+public:
+    VertexQuantization() = delete;
+
+    // Maps the snorm16 range [-1, 1] to the bounds, position = offset + scale * quantized
+    // The scale is the same on all axes, so the normals transformed with the world matrix keep their direction
+    struct PositionTransform
+    {
+        glm::vec3 offset;
+        float scale;
+    };
+
+    // Largest errors of the quantized attributes, to check the quality of the compact format
+    class QualityReport
+    {
+    public:
+        QualityReport();
+
+        void AddPosition(const glm::vec3& position, const glm::vec3& quantizedPosition);
+        void AddNormal(const glm::vec3& normal, const glm::vec3& quantizedNormal);
+        void AddTangent(const glm::vec3& tangent, const glm::vec3& quantizedTangent);
+        void AddTexCoord(const glm::vec2& texCoord, const glm::vec2& quantizedTexCoord);
+
+        // Size of the vertex data, before and after quantization
+        void AddVertexData(size_t sourceSize, size_t quantizedSize);
+
+        // Adds the results of another report
+        void Merge(const QualityReport& report);
+
+        inline float GetMaxPositionError() const { return m_maxPositionError; }
+        // Angle errors are in degrees
+        float GetMaxNormalError() const;
+        float GetMaxTangentError() const;
+        inline float GetMaxTexCoordError() const { return m_maxTexCoordError; }
+        inline size_t GetSourceSize() const { return m_sourceSize; }
+        inline size_t GetQuantizedSize() const { return m_quantizedSize; }
+        // Quantized size over the source size, 1 without vertex data
+        float GetSizeRatio() const;
+
+    private:
+        float m_maxPositionError;
+        // Cosine of the largest angle, the smallest dot product
+        float m_minNormalDot;
+        float m_minTangentDot;
+        float m_maxTexCoordError;
+        size_t m_sourceSize;
+        size_t m_quantizedSize;
+    };
+
+public:
+    static PositionTransform GetPositionTransform(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+    static glm::i16vec4 QuantizePosition(const glm::vec3& position, const PositionTransform& transform);
+    static glm::vec3 DequantizePosition(const glm::i16vec4& quantizedPosition, const PositionTransform& transform);
+
+    // Direction in xyz, w is -1, 0 or 1. Stored as GL_INT_2_10_10_10_REV
+    static std::uint32_t QuantizeDirection(const glm::vec3& direction, float w = 0.0f);
+    static glm::vec4 DequantizeDirection(std::uint32_t quantizedDirection);
+
+    // Stored as half floats
+    static glm::u16vec2 QuantizeTexCoord(const glm::vec2& texCoord);
+    static glm::vec2 DequantizeTexCoord(const glm::u16vec2& quantizedTexCoord);
+
+    // Sign to rebuild the bitangent as cross(normal, tangent) * sign
+    static float GetBitangentSign(const glm::vec3& normal, const glm::vec3& tangent, const glm::vec3& bitangent);
+};
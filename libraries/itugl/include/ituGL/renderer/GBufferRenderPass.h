@@ -7,7 +7,8 @@ class Texture2DObject;
 class GBufferRenderPass : public RenderPass
 {
 public:
-    GBufferRenderPass(int width, int height, int drawcallCollectionIndex = 0);
+    // If velocity is enabled, the pass also writes the screen space motion of each pixel since the previous frame
+    GBufferRenderPass(int width, int height, int drawcallCollectionIndex = 0, bool velocityEnabled = false);
 
     void Render() override;
 
@@ -15,9 +16,11 @@ public:
     const std::shared_ptr<Texture2DObject> GetAlbedoTexture() const { return m_albedoTexture; }
     const std::shared_ptr<Texture2DObject> GetNormalTexture() const { return m_normalTexture; }
     const std::shared_ptr<Texture2DObject> GetOthersTexture() const { return m_othersTexture; }
+    // Null if velocity is not enabled
+    const std::shared_ptr<Texture2DObject> GetVelocityTexture() const { return m_velocityTexture; }
 
 private:
-    void InitTextures(int width, int height);
+    void InitTextures(int width, int height, bool velocityEnabled);
     void InitFramebuffer();
 
 private:
@@ -27,4 +30,5 @@ private:
     std::shared_ptr<Texture2DObject> m_albedoTexture;
     std::shared_ptr<Texture2DObject> m_normalTexture;
     std::shared_ptr<Texture2DObject> m_othersTexture;
+    std::shared_ptr<Texture2DObject> m_velocityTexture;
 };
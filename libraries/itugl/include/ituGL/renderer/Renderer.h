@@ -5,7 +5,9 @@
 #include <ituGL/renderer/DebugRenderPass.h>
 #include <ituGL/geometry/Drawcall.h>
 #include <ituGL/geometry/Mesh.h>
+#include <ituGL/shader/ShaderProgramVariants.h>
 #include <glm/mat4x4.hpp>
+#include <cstdint>
 #include <vector>
 #include <unordered_map>
 #include <memory>
@@ -39,6 +41,21 @@ public:
 
     using DrawcallCollection = std::vector<DrawcallInfo>;
 
+    // Identifies the same object across frames, like SceneNode::GetId. Must not be reused by another object
+    using ObjectKey = std::uint64_t;
+    static constexpr ObjectKey NoObjectKey = 0;
+
+    // Drawcalls collected away from the renderer, for example in a worker thread
+    // World matrix indices are local to the list until it is added with AddDrawcalls
+    // Matrices are final, with the previous frame already looked up, so adding the list only appends them
+    struct DrawcallList
+    {
+        std::vector<glm::mat4> worldMatrices;
+        std::vector<glm::mat4> previousWorldMatrices;
+        std::vector<ObjectKey> objectKeys;
+        DrawcallCollection drawcalls;
+    };
+
     using UpdateTransformsFunction = std::function<void(const ShaderProgram&, const glm::mat4&, const Camera&, bool)>;
     using UpdateLightsFunction = std::function<bool(const ShaderProgram&, std::span<const Light* const>, unsigned int&)>;
 
@@ -63,7 +80,27 @@ public:
     void AddLight(const Light& light);
 
     std::span<const DrawcallInfo> GetDrawcalls(unsigned int collectionIndex) const;
-    void AddModel(const Model& model, const glm::mat4& worldMatrix);
+
+    // Adds a drawcall collection. Models are added to all the collections, AddDrawcall adds to a single one
+    // For objects that draw different geometry in each pass, like the terrain LOD in the shadow pass
+    unsigned int AddDrawcallCollection();
+    inline unsigned int GetDrawcallCollectionCount() const { return static_cast<unsigned int>(m_drawcallCollections.size()); }
+
+    // World matrix for the drawcalls added with AddDrawcall. Objects without a key are treated as static
+    unsigned int AddWorldMatrix(const glm::mat4& worldMatrix, ObjectKey objectKey = NoObjectKey);
+
+    // The drawcall is referenced until the end of the frame, it must not be moved before Render
+    void AddDrawcall(unsigned int collectionIndex, const DrawcallInfo& drawcallInfo);
+
+    // The object key identifies the same object across frames, to find its world matrix in the previous frame
+    // Models added without a key are treated as static
+    void AddModel(const Model& model, const glm::mat4& worldMatrix, ObjectKey objectKey = NoObjectKey);
+
+    // Collect the drawcalls of a model in a list. Only reads the matrices of the previous frame,
+    // so it can be called from any thread until the lists are added
+    void AddModel(DrawcallList& drawcallList, const Model& model, const glm::mat4& worldMatrix, ObjectKey objectKey = NoObjectKey) const;
+    // Add all the drawcalls of the list, in order
+    void AddDrawcalls(const DrawcallList& drawcallList);
 
     const Mesh& GetFullscreenMesh() const;
 
@@ -74,6 +111,13 @@ public:
     void UpdateTransforms(std::shared_ptr<const ShaderProgram> shaderProgramPtr, const glm::mat4& worldMatrix, bool cameraChanged = true) const;
     void UpdateTransforms(std::shared_ptr<const ShaderProgram> shaderProgramPtr, unsigned int worldMatrixIndex, bool cameraChanged = true) const;
 
+    // World matrix of the drawcall in the previous frame
+    const glm::mat4& GetPreviousWorldMatrix(unsigned int worldMatrixIndex) const;
+
+    // View projection matrix of the main camera in this frame and the previous frame, for reprojection
+    inline const glm::mat4& GetViewProjectionMatrix() const { return m_viewProjMatrix; }
+    inline const glm::mat4& GetPreviousViewProjectionMatrix() const { return m_previousViewProjMatrix; }
+
     UpdateLightsFunction GetDefaultUpdateLightsFunction(const ShaderProgram& shaderProgram);
     bool UpdateLights(std::shared_ptr<const ShaderProgram> shaderProgramPtr, std::span<const Light* const> lights, unsigned int& lightIndex) const;
 
@@ -81,6 +125,10 @@ public:
 
     void SetLightingRenderStates(bool firstPass);
 
+    // Keywords for the shader variant of a light pass: LIGHT_INDIRECT in the first pass, LIGHT_SHADOW if the light has a shadow map
+    // Only the keywords declared by the material variants are set, 0 if the material has no variants
+    static ShaderProgramVariants::KeywordMask GetLightKeywords(const Material& material, const Light* light, bool firstPass);
+
     void Render();
 
     DebugRenderPass& GetDebugRenderPass();
@@ -90,6 +138,14 @@ private:
 
     void InitializeFullscreenMesh();
 
+    // Adds a matrix relative to a world matrix already added, in this frame and the previous one
+    unsigned int AddLocalMatrix(unsigned int parentIndex, const glm::mat4& localMatrix);
+
+    // World matrix of the object in the previous frame, or the current one if the object wasn't there
+    const glm::mat4& FindPreviousWorldMatrix(ObjectKey objectKey, const glm::mat4& worldMatrix) const;
+
+    void UpdatePreviousTransform(std::shared_ptr<const ShaderProgram> shaderProgramPtr, const glm::mat4& previousWorldMatrix) const;
+
 private:
     DeviceGL& m_device;
 
@@ -103,12 +159,26 @@ private:
     std::vector<const Light*> m_lights;
 
     std::vector<glm::mat4> m_worldMatrices;
+    std::vector<glm::mat4> m_previousWorldMatrices;
+
+    // Object key of each world matrix, NoObjectKey for the local matrices and the objects without a key
+    std::vector<ObjectKey> m_worldMatrixObjectKeys;
+
+    // World matrices by object key in the previous frame. Filled from the world matrices in Reset
+    std::unordered_map<ObjectKey, glm::mat4> m_previousObjectWorldMatrices;
+
+    glm::mat4 m_viewProjMatrix;
+    glm::mat4 m_previousViewProjMatrix;
+    bool m_hasPreviousFrame;
 
     std::vector<DrawcallCollection> m_drawcallCollections;
 
     std::unordered_map<std::shared_ptr<const ShaderProgram>, UpdateTransformsFunction> m_updateTransformsFunctions;
     std::unordered_map<std::shared_ptr<const ShaderProgram>, UpdateLightsFunction> m_updateLightsFunctions;
 
+    // Location of the "PrevWorldViewProjMatrix" uniform, for the programs that use it
+    std::unordered_map<std::shared_ptr<const ShaderProgram>, int> m_previousTransformLocations;
+
     Mesh m_fullscreenMesh;
 
     std::vector<std::unique_ptr<RenderPass>> m_passes;
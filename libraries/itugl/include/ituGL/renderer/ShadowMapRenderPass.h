@@ -5,6 +5,7 @@
 
 #include <glm/glm.hpp>
 #include <vector>
+#include <unordered_map>
 
 class Light;
 class Material;
@@ -31,13 +32,17 @@ public:
     void SetVolume(const glm::vec3& volumeCenter, const glm::vec3& volumeSize);
     void SetSceneAABBBounds(const glm::vec3& min, const glm::vec3& max);
 
+    // Drawcalls with a caster material are drawn with it, instead of the pass material
+    // For casters that need their own vertex shader, like the morphing terrain
+    void AddCasterMaterial(std::shared_ptr<const Material> material);
+
     void Render() override;
 
     bool shouldFreeze = false;
 
 private:
     void InitFramebuffer();
-    void InitLightCamera(Camera& lightCamera, const Camera& curCamera);
+    void InitLightCamera(Camera& lightCamera, const glm::mat4& viewProjMatrix);
     void ComputeNearAndFar(float& near, float& far, const glm::vec2& lightFrustumMin, 
         const glm::vec2& lightFrustumMax, const std::vector<glm::vec3>& sceneAABBLightSpace);
     void ComputeNearAndFarNoClip(float& near, float& far, const std::vector<glm::vec3>& sceneAABB);
@@ -49,6 +54,9 @@ private:
 
     std::shared_ptr<const Material> m_material;
 
+    // Caster materials by address, the drawcalls only reference their material
+    std::unordered_map<const Material*, std::shared_ptr<const Material>> m_casterMaterials;
+
     int m_drawcallCollectionIndex;
 
     glm::vec3 m_volumeCenter;
@@ -60,6 +68,7 @@ private:
     glm::vec3 m_sceneAABBExtents;
     glm::vec3 m_sceneAABBCenter;
 
-    Camera m_mainCameraCopy;
+    // View projection matrix of the main camera used to fit the shadow. Not updated while frozen
+    glm::mat4 m_mainViewProjMatrix;
 
 };
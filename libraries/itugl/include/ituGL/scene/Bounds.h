@@ -2,6 +2,7 @@
 
 #include <glm/vec3.hpp>
 #include <glm/mat3x3.hpp>
+#include <cassert>
 
 class Bounds
 {
@@ -117,7 +118,7 @@ private:
 template<typename T>
 bool Bounds::Intersects(const T& other) const
 {
-    Bounds::Intersects(this, other);
+    return Bounds::Intersects(*this, other);
 }
 
 template<typename TA, typename TB>
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <ituGL/scene/Bounds.h>
+
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <array>
+#include <span>
+#include <vector>
+
+// Planes are stored as vec4(normal, distance), so a point p is in front of the plane if dot(normal, p) + distance >= 0
+using BoundsPlane = glm::vec4;
+
+// Batch bounds kernels work on groups of this many elements. Arrays are padded to a multiple of it
+constexpr size_t BoundsArrayBatchSize = 8;
+
+// Structure-of-arrays container for many axis aligned boxes, stored as center and half size like AabbBounds
+// Kernels have a vectorized implementation (SSE2, or AVX2 when the CPU has it) and a scalar reference implementation with the same results
+class AabbArray
+{
+public:
+    AabbArray();
+
+    // Number of boxes in the array
+    inline size_t GetSize() const { return m_size; }
+    inline bool IsEmpty() const { return m_size == 0; }
+
+    void Reserve(size_t capacity);
+    void Resize(size_t size);
+    void Clear();
+
+    // Adds a box at the end and returns its index
+    size_t Add(const glm::vec3& center, const glm::vec3& size);
+    size_t Add(const AabbBounds& bounds);
+
+    AabbBounds Get(size_t index) const;
+    void Set(size_t index, const glm::vec3& center, const glm::vec3& size);
+    void Set(size_t index, const AabbBounds& bounds);
+
+    // Direct access to the components. Spans include the padding elements
+    inline std::span<const float> GetCenterX() const { return m_centerX; }
+    inline std::span<const float> GetCenterY() const { return m_centerY; }
+    inline std::span<const float> GetCenterZ() const { return m_centerZ; }
+    inline std::span<const float> GetSizeX() const { return m_sizeX; }
+    inline std::span<const float> GetSizeY() const { return m_sizeY; }
+    inline std::span<const float> GetSizeZ() const { return m_sizeZ; }
+
+    // Writes 1 to results[i] if box i is at least partially in front of every plane, 0 otherwise
+    // results must have at least GetSize() elements
+    void TestPlanes(std::span<const BoundsPlane> planes, std::span<unsigned char> results) const;
+    void TestPlanesReference(std::span<const BoundsPlane> planes, std::span<unsigned char> results) const;
+
+    // Writes 1 to results[i] if box i overlaps the given box, 0 otherwise
+    void TestOverlap(const AabbBounds& bounds, std::span<unsigned char> results) const;
+    void TestOverlapReference(const AabbBounds& bounds, std::span<unsigned char> results) const;
+
+    // Transforms every box by the matrix and stores the axis aligned box enclosing the result in output
+    void Transform(const glm::mat4& matrix, AabbArray& output) const;
+    void TransformReference(const glm::mat4& matrix, AabbArray& output) const;
+
+private:
+    void ResizeStorage(size_t size);
+
+private:
+    size_t m_size;
+
+    std::vector<float> m_centerX;
+    std::vector<float> m_centerY;
+    std::vector<float> m_centerZ;
+    std::vector<float> m_sizeX;
+    std::vector<float> m_sizeY;
+    std::vector<float> m_sizeZ;
+};
+
+// Structure-of-arrays container for many spheres
+class SphereArray
+{
+public:
+    SphereArray();
+
+    // Number of spheres in the array
+    inline size_t GetSize() const { return m_size; }
+    inline bool IsEmpty() const { return m_size == 0; }
+
+    void Reserve(size_t capacity);
+    void Resize(size_t size);
+    void Clear();
+
+    // Adds a sphere at the end and returns its index
+    size_t Add(const glm::vec3& center, float radius);
+    size_t Add(const SphereBounds& bounds);
+
+    SphereBounds Get(size_t index) const;
+    void Set(size_t index, const glm::vec3& center, float radius);
+    void Set(size_t index, const SphereBounds& bounds);
+
+    // Direct access to the components. Spans include the padding elements
+    inline std::span<const float> GetCenterX() const { return m_centerX; }
+    inline std::span<const float> GetCenterY() const { return m_centerY; }
+    inline std::span<const float> GetCenterZ() const { return m_centerZ; }
+    inline std::span<const float> GetRadius() const { return m_radius; }
+
+    // Writes 1 to results[i] if sphere i is at least partially in front of every plane, 0 otherwise
+    // With the planes from ExtractFrustumPlanes, this is the sphere-vs-frustum test
+    void TestPlanes(std::span<const BoundsPlane> planes, std::span<unsigned char> results) const;
+    void TestPlanesReference(std::span<const BoundsPlane> planes, std::span<unsigned char> results) const;
+
+    // Writes 1 to results[i] if sphere i overlaps the given sphere, 0 otherwise
+    void TestOverlap(const SphereBounds& bounds, std::span<unsigned char> results) const;
+    void TestOverlapReference(const SphereBounds& bounds, std::span<unsigned char> results) const;
+
+private:
+    void ResizeStorage(size_t size);
+
+private:
+    size_t m_size;
+
+    std::vector<float> m_centerX;
+    std::vector<float> m_centerY;
+    std::vector<float> m_centerZ;
+    std::vector<float> m_radius;
+};
+
+// Extracts the 6 frustum planes from a view projection matrix (left, right, bottom, top, near, far)
+// Planes point inwards and are normalized
+void ExtractFrustumPlanes(const glm::mat4& viewProjectionMatrix, std::array<BoundsPlane, 6>& planes);
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <ituGL/scene/SceneVisitor.h>
+#include <ituGL/renderer/Renderer.h>
+#include <memory>
+#include <vector>
 
-class Renderer;
+class Camera;
+class Light;
 class SceneCamera;
 class SceneLight;
 class SceneModel;
@@ -19,6 +23,29 @@ public:
 
     void VisitModel(SceneModel& sceneModel) override;
 
+    // Creates a visitor that collects the nodes in its own lists instead of adding them to the renderer
+    RendererSceneVisitor CreateChunkVisitor() const;
+    // Adds the nodes collected by a chunk visitor to the renderer
+    void MergeChunkVisitor(RendererSceneVisitor& chunkVisitor);
+
 private:
+    // Nodes collected by a chunk visitor, added to the renderer on merge
+    struct ChunkData
+    {
+        const Camera* camera = nullptr;
+        std::vector<const Light*> lights;
+        Renderer::DrawcallList drawcallList;
+    };
+
     Renderer& m_renderer;
+
+    // Only set in chunk visitors
+    std::unique_ptr<ChunkData> m_chunkData;
+};
+
+// Chunk visitors don't modify the renderer, so the visitor can be used in parallel
+template<>
+struct SceneVisitorTraits<RendererSceneVisitor>
+{
+    static constexpr bool IsThreadSafe = true;
 };
@@ -1,13 +1,17 @@
 #pragma once
 
+#include <ituGL/scene/SceneVisitor.h>
+#include <ituGL/scene/SceneSnapshot.h>
 #include <glm/vec3.hpp>
 
 #include <unordered_map>
+#include <vector>
 #include <string>
 #include <memory>
+#include <functional>
 
 class SceneNode;
-class SceneVisitor;
+class JobSystem;
 
 class Scene
 {
@@ -25,13 +29,67 @@ public:
     void AcceptVisitor(SceneVisitor& visitor);
     void AcceptVisitor(SceneVisitor& visitor) const;
 
+    // Visit the nodes in chunks of chunkSize, running the chunks in parallel in the job system
+    // Each chunk is visited by its own chunk visitor, and the results are merged in node order, same as AcceptVisitor
+    // Visitors that are not thread safe (see SceneVisitorTraits) are run serially
+    // Dirty transforms are updated in the calling thread first, so the chunks only read cached matrices
+    template<typename TVisitor>
+    void AcceptVisitorParallel(TVisitor& visitor, JobSystem& jobSystem, size_t chunkSize = 1024);
+
+    // Number of nodes in the scene
+    inline size_t GetSceneNodeCount() const { return m_nodeList.size(); }
+
+    // Writes the nodes to a binary snapshot file. Model nodes are stored if getModelId returns a valid id for their model
+    bool Save(const char* path, const SceneSnapshot::GetModelIdFunction& getModelId) const;
+    // Adds the nodes of a binary snapshot file. getModel returns the model for each model id
+    bool Load(const char* path, const SceneSnapshot::GetModelFunction& getModel);
+
     void GetAABBBounds(glm::vec3& min, glm::vec3& max);
     glm::vec3 GetAABBExtents() const;
 
 private:
-    std::unordered_map<std::string, std::shared_ptr<SceneNode>> m_nodes;
+    using ChunkFunction = std::function<void(SceneNode& node, size_t chunkIndex)>;
+    size_t GetChunkCount(size_t chunkSize) const;
+    void UpdateTransforms();
+    void ForEachNodeParallel(JobSystem& jobSystem, size_t chunkSize, const ChunkFunction& function);
+    static void AcceptVisitorOnNode(SceneNode& node, SceneVisitor& visitor);
+
+private:
+    // Nodes are stored in a list, to be partitioned in chunks. The map stores the index of each node in the list
+    std::vector<std::shared_ptr<SceneNode>> m_nodeList;
+    std::unordered_map<std::string, size_t> m_nodes;
     glm::vec3 m_AABBExtents;
     glm::vec3 m_AABBMinBounds;
     glm::vec3 m_AABBMaxBounds;
     glm::vec3 m_AABBCenter;
 };
+
+template<typename TVisitor>
+void Scene::AcceptVisitorParallel(TVisitor& visitor, JobSystem& jobSystem, size_t chunkSize)
+{
+    if constexpr (SceneVisitorTraits<TVisitor>::IsThreadSafe)
+    {
+        std::vector<TVisitor> chunkVisitors;
+        size_t chunkCount = GetChunkCount(chunkSize);
+        chunkVisitors.reserve(chunkCount);
+        for (size_t i = 0; i < chunkCount; ++i)
+        {
+            chunkVisitors.push_back(visitor.CreateChunkVisitor());
+        }
+
+        UpdateTransforms();
+        ForEachNodeParallel(jobSystem, chunkSize, [&chunkVisitors](SceneNode& node, size_t chunkIndex)
+            {
+                Scene::AcceptVisitorOnNode(node, chunkVisitors[chunkIndex]);
+            });
+
+        for (TVisitor& chunkVisitor : chunkVisitors)
+        {
+            visitor.MergeChunkVisitor(chunkVisitor);
+        }
+    }
+    else
+    {
+        AcceptVisitor(visitor);
+    }
+}
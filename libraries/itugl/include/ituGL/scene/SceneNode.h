@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ituGL/scene/Bounds.h>
+#include <cstdint>
 #include <string>
 #include <memory>
 
@@ -21,6 +22,9 @@ public:
     const std::string& GetName() const;
     void Rename(const std::string& name);
 
+    // Unique for each node created in the program, ids are never reused
+    inline std::uint64_t GetId() const { return m_id; }
+
     std::shared_ptr<Transform> GetTransform();
     std::shared_ptr<const Transform> GetTransform() const;
     void SetTransform(std::shared_ptr<Transform> transform);
@@ -29,6 +33,7 @@ public:
     virtual AabbBounds GetAabbBounds() const;
     virtual BoxBounds GetBoxBounds() const;
     virtual glm::vec3 GetAabbExtents() const;
+    glm::vec3 GetAabbCenter() const;
 
     virtual void AcceptVisitor(SceneVisitor& visitor);
     virtual void AcceptVisitor(SceneVisitor& visitor) const;
@@ -39,8 +44,12 @@ private:
     Scene* GetOwnerScene() const;
     void SetOwnerScene(Scene* scene);
 
+    static std::uint64_t GetNextId();
+
     Scene* m_scene;
 
+    std::uint64_t m_id;
+
 protected:
     std::string m_name;
     std::shared_ptr<Transform> m_transform;
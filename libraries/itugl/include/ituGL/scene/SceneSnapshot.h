@@ -0,0 +1,121 @@
+#pragma once
+
+#include <ituGL/core/MappedFile.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string_view>
+
+class Scene;
+class SceneNode;
+class Model;
+
+// Identifies an asset referenced from serialized data. Usually the hash of its path, see SceneSnapshot::GetAssetId
+using AssetId = std::uint64_t;
+
+// Versioned binary snapshot of the nodes of a scene
+// Each node property is stored in its own array, aligned in the file, so the snapshot is used in place from a mapped file
+// Models are referenced by AssetId, and resolved by the application when the nodes are created
+// Transform parents are stored as the index of the node that owns the parent transform. Parents that are not the transform
+// of a stored node (or of a node removed by the filter) are not kept, and their children are loaded without parent
+class SceneSnapshot
+{
+public:
+    enum class NodeType : std::uint8_t
+    {
+        Model,
+        Light,
+        Camera,
+    };
+
+    // Light parameters. Attenuation is the distance attenuation for point lights, or all the attenuation values for spot lights
+    struct LightData
+    {
+        std::uint32_t type;
+        glm::vec3 color;
+        float intensity;
+        glm::vec3 position;
+        glm::vec3 direction;
+        glm::vec4 attenuation;
+        float shadowBias;
+        glm::ivec2 shadowMapResolution;
+    };
+
+    struct CameraData
+    {
+        glm::mat4 viewMatrix;
+        glm::mat4 projectionMatrix;
+    };
+
+    // Returns the asset of the model used by a node, or 0 if it can't be referenced
+    using GetModelIdFunction = std::function<AssetId(const Model&)>;
+    // Returns the model for an asset. Nodes with a null model are skipped
+    using GetModelFunction = std::function<std::shared_ptr<Model>(AssetId)>;
+    // Returns true if the node must be stored
+    using NodeFilterFunction = std::function<bool(const SceneNode&)>;
+
+    // Increase when the layout changes. Snapshots with a different version fail to open
+    static constexpr std::uint32_t Version = 2;
+
+    // Parent index of the nodes without parent
+    static constexpr std::uint32_t NoParent = ~0u;
+
+public:
+    SceneSnapshot();
+
+    // Map a snapshot file. Returns false if the file is missing or is not a valid snapshot
+    bool Open(const char* path);
+    void Close();
+
+    inline bool IsOpen() const { return m_header != nullptr; }
+
+    // Loads all the file pages in memory
+    inline void Prefetch() const { m_file.Prefetch(); }
+
+    // Node arrays, pointing to the mapped file
+    unsigned int GetNodeCount() const;
+    std::span<const NodeType> GetNodeTypes() const;
+    std::span<const AssetId> GetModelIds() const;
+    std::span<const glm::vec3> GetTranslations() const;
+    std::span<const glm::vec3> GetRotations() const;
+    std::span<const glm::vec3> GetScales() const;
+    std::span<const glm::vec3> GetBoundsMin() const;
+    std::span<const glm::vec3> GetBoundsMax() const;
+    std::span<const std::uint32_t> GetParentIndices() const;
+    std::string_view GetNodeName(unsigned int nodeIndex) const;
+
+    // Light or camera data of the node, depending on its type
+    const LightData& GetLightData(unsigned int nodeIndex) const;
+    const CameraData& GetCameraData(unsigned int nodeIndex) const;
+
+    // Creates a new scene node from the snapshot data. Returns null if it has no model
+    // The transform parent is not linked, see AddToScene
+    std::shared_ptr<SceneNode> CreateSceneNode(unsigned int nodeIndex, const GetModelFunction& getModel) const;
+
+    // Creates all the nodes and adds them to the scene, linking their transform parents
+    void AddToScene(Scene& scene, const GetModelFunction& getModel) const;
+
+    // Writes the nodes of a scene to a snapshot file. If filter is set, only the nodes it accepts are written
+    static bool Save(const char* path, const Scene& scene, const GetModelIdFunction& getModelId, const NodeFilterFunction& filter = nullptr);
+
+    // Asset id for a path or name
+    static AssetId GetAssetId(std::string_view path);
+
+private:
+    struct Header;
+
+    template<typename T>
+    std::span<const T> GetArray(std::uint64_t offset, std::uint64_t count) const;
+
+    bool ValidateHeader() const;
+
+private:
+    MappedFile m_file;
+
+    const Header* m_header;
+};
@@ -20,3 +20,13 @@ public:
     virtual void VisitRenderable(Renderable& renderable);
     virtual void VisitRenderable(const Renderable& renderable);
 };
+
+// Visitors are not thread safe by default. Specialize this trait to allow a visitor in Scene::AcceptVisitorParallel
+// Thread safe visitors must provide:
+//  - TVisitor CreateChunkVisitor() : returns a visitor that will visit one chunk of nodes, all of them in the same thread
+//  - void MergeChunkVisitor(TVisitor& chunkVisitor) : merges the results of a chunk. Called in the calling thread, in chunk order
+template<typename TVisitor>
+struct SceneVisitorTraits
+{
+    static constexpr bool IsThreadSafe = false;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <ituGL/scene/SceneSnapshot.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Scene;
+class SceneNode;
+class JobSystem;
+
+// Splits a large world in a grid of square cells on the XZ plane. Each cell is stored as a scene snapshot file
+// Cells around the camera are loaded in the background, and their nodes added to the scene within a time budget per frame
+// Cells are removed when they are further than the unload radius, so memory depends on the radius and not on the world size
+class WorldPartition
+{
+public:
+    // Returns the snapshot file of a cell
+    using GetCellPathFunction = std::function<std::string(glm::ivec2 cell)>;
+
+public:
+    WorldPartition(Scene& scene, JobSystem& jobSystem, float cellSize, const GetCellPathFunction& getCellPath, const SceneSnapshot::GetModelFunction& getModel);
+    ~WorldPartition();
+
+    inline float GetCellSize() const { return m_cellSize; }
+
+    // Cells closer than the load radius are loaded. Loaded cells are kept until they are further than the unload radius
+    // The unload radius should be larger, so cells don't reload when the camera moves around a border
+    inline float GetLoadRadius() const { return m_loadRadius; }
+    inline float GetUnloadRadius() const { return m_unloadRadius; }
+    void SetRadius(float loadRadius, float unloadRadius);
+
+    // Maximum time per Update spent adding and removing nodes, in seconds
+    inline double GetTimeBudget() const { return m_timeBudget; }
+    inline void SetTimeBudget(double timeBudget) { m_timeBudget = timeBudget; }
+
+    // Starts loading and unloading cells around the position, and adds loaded nodes to the scene. Call once per frame
+    void Update(const glm::vec3& position);
+
+    // Removes all the nodes of the loaded cells from the scene
+    void UnloadAll();
+
+    unsigned int GetCellCount() const;
+    unsigned int GetActiveCellCount() const;
+
+    // Cell that contains the position
+    glm::ivec2 GetCell(const glm::vec3& position) const;
+
+    // Prefix added to the names of the nodes of a cell, so nodes with the same name in different cells don't replace each other
+    static std::string GetNodeNamePrefix(glm::ivec2 cell);
+
+    // Splits the nodes of a scene in cells, and writes the snapshot of each cell
+    // Each transform hierarchy is stored in the cell of its root translation, and linked again when the cell is streamed in
+    // Fails without writing if a node has a parent transform that is not stored, like a model without id
+    static bool SaveCells(const Scene& scene, float cellSize, const GetCellPathFunction& getCellPath, const SceneSnapshot::GetModelIdFunction& getModelId);
+
+private:
+    // Data loaded in a background job. The job keeps it alive if the cell is removed while loading
+    struct CellData
+    {
+        SceneSnapshot snapshot;
+
+        // Snapshot node indices in the order they are added, parents before their children
+        std::vector<unsigned int> nodeOrder;
+
+        std::atomic<bool> ready = false;
+    };
+
+    struct Cell
+    {
+        glm::ivec2 coordinates;
+        std::shared_ptr<CellData> data;
+
+        std::string namePrefix;
+
+        // Node created for each snapshot node, empty if it is not in the scene. Children look up their parent here
+        std::vector<std::shared_ptr<SceneNode>> nodes;
+
+        // Positions in the node order of the nodes added to the scene, and next position to add
+        std::vector<unsigned int> addedNodes;
+        unsigned int nextNodeIndex = 0;
+    };
+
+    static std::uint64_t GetCellKey(glm::ivec2 cell);
+
+    float GetDistanceToCell(const glm::vec3& position, glm::ivec2 cell) const;
+
+    void RequestCells(const glm::vec3& position);
+    void ReleaseCells(const glm::vec3& position, double endTime);
+    void IntegrateCells(const glm::vec3& position, double endTime);
+    void RemoveCellNodes(Cell& cell);
+
+    std::shared_ptr<Model> GetModel(AssetId modelId);
+
+private:
+    Scene& m_scene;
+    JobSystem& m_jobSystem;
+
+    float m_cellSize;
+    float m_loadRadius;
+    float m_unloadRadius;
+    double m_timeBudget;
+
+    GetCellPathFunction m_getCellPath;
+    SceneSnapshot::GetModelFunction m_getModel;
+
+    std::unordered_map<std::uint64_t, Cell> m_cells;
+
+    // Models shared between cells. They are released when no node uses them
+    std::unordered_map<AssetId, std::weak_ptr<Model>> m_models;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ituGL/shader/ShaderUniformCollection.h>
+#include <ituGL/shader/ShaderProgramVariants.h>
 
 #include <ituGL/core/Color.h>
 #include <functional>
@@ -39,10 +40,29 @@ public:
     // Function pointer to prepare the shader used by the material that is being rendered
     using ShaderSetupFunction = std::function<void(ShaderProgram&)>;
 
+    using KeywordMask = ShaderProgramVariants::KeywordMask;
+
 public:
     Material();
     // Initialize with the shader program, will extract all the properties. Skip the names in filtered uniforms
     Material(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet& filteredUniforms = NameSet());
+    // Initialize with shader variants. The properties are extracted from the variant with all the keywords
+    Material(std::shared_ptr<ShaderProgramVariants> shaderVariants, const NameSet& filteredUniforms = NameSet());
+
+    // Variants of the shader program, null if the material has a single program
+    std::shared_ptr<ShaderProgramVariants> GetShaderVariants() const;
+
+    // Keywords enabled in the material, they select the variant of the shader program
+    KeywordMask GetKeywords() const;
+    void SetKeywords(KeywordMask keywords);
+    void SetKeywordEnabled(const char* keyword, bool enabled);
+
+    // Program used with the keywords of the material, plus extraKeywords, for example from the light being rendered
+    // If the material has no variants, or the variant doesn't build, it is the regular shader program
+    std::shared_ptr<const ShaderProgram> GetShaderProgramVariant(KeywordMask extraKeywords = 0) const;
+
+    // Read the uniforms again after the shader program or its variants are rebuilt, keeping the values of the properties
+    void RefreshUniforms();
 
 
     // The function that will be executed for additional shader program setup
@@ -113,7 +133,15 @@ public:
     // You can skip depth, stencil or blending using the override flags
     void Use(OverrideFlags overrideFlags = OverrideFlags::NoOverride) const;
 
+    // Same as Use, with the shader program from GetShaderProgramVariant
+    void UseVariant(KeywordMask extraKeywords, OverrideFlags overrideFlags = OverrideFlags::NoOverride) const;
+
 private:
+    std::shared_ptr<ShaderProgram> FindShaderProgramVariant(KeywordMask extraKeywords) const;
+
+    // Where the properties are in a variant, computed the first time the variant is used
+    const LocationMap& GetVariantLocationMap(const ShaderProgram& shaderProgram) const;
+
     // Set all the properties relative to depth
     void UseDepthTest() const;
 
@@ -130,6 +158,11 @@ private:
     // Function pointer to prepare the shader used by the material
     ShaderSetupFunction m_shaderSetupFunction;
 
+    // Variants of the shader program, and the keywords enabled in this material
+    std::shared_ptr<ShaderProgramVariants> m_shaderVariants;
+    KeywordMask m_keywords;
+    mutable std::unordered_map<const ShaderProgram*, LocationMap> m_variantLocationMaps;
+
     // Test function for depth. Default: Less
     TestFunction m_depthTestFunction;
 
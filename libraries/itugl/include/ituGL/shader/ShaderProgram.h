@@ -16,7 +16,9 @@
 #include <glm/mat4x3.hpp>
 #include <glm/mat4x4.hpp>
 
+#include <cstddef>
 #include <span>
+#include <vector>
 
 class Shader;
 class TextureObject;
@@ -74,6 +76,16 @@ public:
     // Check if shaders have been linked to create a valid program
     bool IsLinked() const;
 
+    // Allow getting the binary of the program after linking. Must be set before Build
+    void SetBinaryRetrievable(bool retrievable);
+
+    // Get the binary of the linked program, in a format that depends on the driver
+    bool GetBinary(std::vector<std::byte>& binary, GLenum& binaryFormat) const;
+
+    // Link the program from a binary got with GetBinary, instead of building it from shaders
+    // Returns false if the driver rejects it, for example after a driver update. Then the program can still be built
+    bool SetBinary(std::span<const std::byte> binary, GLenum binaryFormat);
+
     // Get a string with linking error messages
     // The max length of the string returned is determined by the capacity of the span
     void GetLinkingErrors(std::span<char> errors) const;
@@ -90,6 +102,19 @@ public:
     // Get information about a specific uniform
     void GetUniformInfo(unsigned int index, int& size, GLenum& glType, std::span<char> uniformName) const;
 
+    // Get where a uniform is in its uniform block: block index, byte offset, and strides of the array elements and matrix columns
+    // The block index is -1 if the uniform is not in a block, and has a location instead
+    void GetUniformBlockMemberInfo(unsigned int index, int& blockIndex, int& offset, int& arrayStride, int& matrixStride) const;
+
+    // Find a uniform block by name. Returns -1 if the program doesn't have it
+    Location GetUniformBlockIndex(const char* name) const;
+
+    // Get the size in bytes of the data of a uniform block
+    int GetUniformBlockSize(Location blockIndex) const;
+
+    // Set the binding point where the uniform block reads its buffer
+    void SetUniformBlockBinding(Location blockIndex, GLuint binding) const;
+
     // Template method combinations to simplify getting uniforms
     template<typename T>
     void GetUniform(Location location, T& value) const;
@@ -116,6 +141,11 @@ public:
     // Set the shader program as the active one to be used for rendering
     void Use() const;
 
+    // Id of the uniform collection whose values the program has, and the serial of its changes when they were set
+    // Set by ShaderUniformCollection, so it only sets the values that changed since. Cleared when the program is linked again
+    inline void GetAppliedUniforms(unsigned long long& id, unsigned long long& serial) const { id = m_appliedUniformsId; serial = m_appliedUniformsSerial; }
+    inline void SetAppliedUniforms(unsigned long long id, unsigned long long serial) const { m_appliedUniformsId = id; m_appliedUniformsSerial = serial; }
+
 private:
     // Build (Attach and link) all shaders provided for the rasterization pipeline
     bool Build(const Shader& vertexShader, const Shader& fragmentShader,
@@ -139,6 +169,10 @@ private:
     void SetUniforms(Location location, const T* values, GLsizei count) const;
 
 private:
+    // Uniforms are state of the program, not of the binding, so they can be tracked in a const program
+    mutable unsigned long long m_appliedUniformsId;
+    mutable unsigned long long m_appliedUniformsSerial;
+
 #ifndef NDEBUG
     inline bool IsUsed() const { return s_usedHandle == GetHandle(); }
     static Handle s_usedHandle;
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class ShaderProgram;
+
+// Variants of a shader program, built from the same sources with different feature keywords
+// Each keyword enabled in a variant is added as a #define, so the shader can remove the code of the disabled features
+// Variants are built the first time they are requested, or ahead of time from a manifest
+class ShaderProgramVariants
+{
+public:
+    // One bit per keyword, in the order they are declared
+    using KeywordMask = unsigned int;
+
+    // Build the program with the defines of the variant. Returns true if the program is linked
+    using BuildFunction = std::function<bool(ShaderProgram&, std::span<const std::string>)>;
+
+    // Called after a variant is built, for example to register it with the renderer
+    using VariantBuiltFunction = std::function<void(KeywordMask, std::shared_ptr<ShaderProgram>)>;
+
+public:
+    ShaderProgramVariants(std::span<const char* const> keywords, const BuildFunction& buildFunction);
+
+    unsigned int GetKeywordCount() const;
+    const std::string& GetKeyword(unsigned int index) const;
+
+    // Mask of the keyword, 0 if it is not declared. Keywords that are not declared are ignored
+    KeywordMask GetKeywordMask(std::string_view keyword) const;
+
+    // Mask with all the keywords. That variant has all the uniforms of the other variants
+    KeywordMask GetAllKeywordsMask() const;
+
+    void SetVariantBuiltFunction(const VariantBuiltFunction& variantBuiltFunction);
+
+    // Program of the variant with these keywords, built if needed. Returns nullptr if it doesn't build
+    std::shared_ptr<ShaderProgram> GetVariant(KeywordMask keywords);
+
+    // If the variant was built already, even if it failed
+    bool HasVariant(KeywordMask keywords) const;
+    unsigned int GetVariantCount() const;
+
+    // Build the variants listed in a manifest file. Each line has the keywords of one variant, separated by spaces
+    // Empty lines and lines starting with '#' are skipped. Returns false if the file can't be read or a variant fails
+    bool LoadManifest(const char* path);
+
+    // Build again all the variants, for example when the sources change. The programs are rebuilt in place
+    // If a variant doesn't build, it keeps the previous program. Variants that failed are built again when requested
+    // Returns true if all the variants were rebuilt
+    bool Rebuild();
+
+private:
+    // Defines for the keywords in the mask
+    std::vector<std::string> GetDefines(KeywordMask keywords) const;
+
+private:
+    std::vector<std::string> m_keywords;
+
+    BuildFunction m_buildFunction;
+    VariantBuiltFunction m_variantBuiltFunction;
+
+    // Failed variants are stored as nullptr, so they are not built again every frame
+    std::unordered_map<KeywordMask, std::shared_ptr<ShaderProgram>> m_variants;
+};
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/shader/UniformBufferPool.h>
 #include <ituGL/texture/TextureObject.h>
 #include <ituGL/core/Data.h>
+#include <algorithm>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
@@ -10,24 +12,51 @@
 #include <cstring>
 #include <memory>
 
+// Properties of a shader program, with the values of its uniforms
+// The members of the uniform block named MaterialBlock are properties too, but their values are stored in a range of a uniform buffer
+// The block is packed with the std140 layout and uploaded only when a value changes, then bound with one glBindBufferRange
+// Programs remember the last collection set to them, so setting the same collection again only sets the values changed since
 class ShaderUniformCollection
 {
 public:
     // Alias for a set of names
     using NameSet = std::unordered_set<std::string>;
 
+    // Name of the uniform block with properties, and the binding point where it is bound
+    static constexpr const char* MaterialBlockName = "MaterialBlock";
+    static constexpr GLuint MaterialBlockBinding = 0;
+
+    // Calls made by all the collections when setting their properties, and calls skipped because they were not needed
+    struct Statistics
+    {
+        unsigned int uniformCount = 0;
+        unsigned int skippedUniformCount = 0;
+        unsigned int textureBindCount = 0;
+        unsigned int skippedTextureBindCount = 0;
+        unsigned int blockUploadCount = 0;
+    };
+
 public:
     ShaderUniformCollection();
     // Initialize with the shader program, will extract all the properties. Skip the names in filtered uniforms
     ShaderUniformCollection(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet& filteredUniforms = NameSet());
 
+    // Copies have the same properties and values, and get their own range of the material block on the first use
+    ShaderUniformCollection(const ShaderUniformCollection& other);
+    ShaderUniformCollection& operator = (const ShaderUniformCollection& other);
+    ShaderUniformCollection(ShaderUniformCollection&& other) = default;
+    ShaderUniformCollection& operator = (ShaderUniformCollection&& other) = default;
+
     // Get the shader program
     std::shared_ptr<ShaderProgram> GetShaderProgram();
     std::shared_ptr<const ShaderProgram> GetShaderProgram() const;
 
-    // Reset the material with a different shader
+    // Reset the material with a different shader. The properties with the same name and type keep their values
     void ChangeShader(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet& filteredUniforms = NameSet());
 
+    // Read the uniforms again after the shader program is rebuilt, keeping the values of the properties
+    void RefreshUniforms();
+
     // Get the vertex attribute location by name
     ShaderProgram::Location GetAttributeLocation(const char* name) const;
 
@@ -62,15 +91,29 @@ public:
     template<typename T>
     void SetUniformValues(ShaderProgram::Location location, std::span<const T> value);
 
-    // Get the pointer to the uniform data
-    template<typename T>
-    T* GetDataUniformPointer(const char* name);
-    template<typename T>
-    T* GetDataUniformPointer(ShaderProgram::Location location);
-
     // Set all the properties to the shader. Requires the shader program to be in use
     void SetUniforms() const;
 
+    // Locations of the properties, mapped to the locations of the same uniforms in another shader program
+    using LocationMap = std::unordered_map<ShaderProgram::Location, ShaderProgram::Location>;
+
+    // Find the properties by name in another shader program built from the same sources, like a shader variant
+    LocationMap GetLocationMap(const ShaderProgram& shaderProgram) const;
+
+    // Set the properties to another shader program, with the locations from GetLocationMap. Requires the shader program to be in use
+    void SetUniforms(const ShaderProgram& shaderProgram, const LocationMap& locations) const;
+
+    // Pool where the material block gets its range. If not set, it uses UniformBufferPool::GetDefault()
+    std::shared_ptr<UniformBufferPool> GetUniformBufferPool() const;
+    void SetUniformBufferPool(std::shared_ptr<UniformBufferPool> uniformBufferPool);
+
+    // Check if the shader program has a material block
+    inline bool HasMaterialBlock() const { return m_materialBlockIndex >= 0; }
+
+    // Counted since the last reset, usually once per frame
+    static const Statistics& GetStatistics();
+    static void ResetStatistics();
+
 private:
     // Different dimensions of the properties
     enum class UniformDimension
@@ -87,6 +130,8 @@ private:
     // Struct to store a data property
     struct DataUniform
     {
+        // Uniform name
+        std::string name;
         // Uniform location
         ShaderProgram::Location location;
         // Data type
@@ -97,17 +142,38 @@ private:
         unsigned int count;
         // Index in the data buffer
         int index;
+        // Offset in the material block, and strides of the array elements and matrix columns. -1 if it is not in the block
+        int blockOffset;
+        int arrayStride;
+        int matrixStride;
+        // Change serial of the collection when the value was last changed
+        unsigned long long serial;
     };
 
     // Struct to store a texture property
     struct TextureUniform
     {
+        // Uniform name
+        std::string name;
         // Uniform location
         ShaderProgram::Location location;
         // Texture subtype
         TextureObject::Target target;
         // Shared pointer to the texture object
         std::shared_ptr<TextureObject> texture;
+        // Change serial of the collection when the texture was last changed
+        unsigned long long serial;
+    };
+
+    // Identifies the values of a collection in the programs where they are set
+    // Copies get a new id, their values can change separately
+    struct ValuesId
+    {
+        ValuesId();
+        inline ValuesId(const ValuesId&) : ValuesId() {}
+        inline ValuesId& operator = (const ValuesId&) { value = ValuesId().value; return *this; }
+
+        unsigned long long value;
     };
 
 private:
@@ -123,6 +189,14 @@ private:
     // Can skip by name those in the filteredUniforms
     void ExtractUniforms(const NameSet& filteredUniforms = NameSet());
 
+    // Pack the values of the block members with the block layout, and upload them if they changed. Then bind the range
+    void UseMaterialBlock() const;
+    template<typename T>
+    void PackBlockValues(const DataUniform& uniform) const;
+
+    // Check if a location is one of the block members
+    static bool IsBlockLocation(ShaderProgram::Location location);
+
     // Check if an OpenGL type is a data type and, if so, return the data type and dimension
     static bool IsDataUniform(GLenum glType, Data::Type& type, UniformDimension& dimension);
 
@@ -135,11 +209,16 @@ private:
     void AddUniform(const DataUniform& uniform);
     void AddUniform(const TextureUniform& uniform);
 
-    // Use uniform property
-    void UseUniform(const DataUniform& uniform) const;
+    // Set the properties to a program, at the locations in the map if there is one
+    // Only the values changed since they were last set are set, if this collection was the last one set to the program
+    void SetUniforms(const ShaderProgram& shaderProgram, const LocationMap* locations) const;
+
+    // Use uniform property, setting it to targetLocation in shaderProgram
+    void UseUniform(const DataUniform& uniform, const ShaderProgram& shaderProgram, ShaderProgram::Location targetLocation) const;
     template<typename T>
-    void UseUniform(const DataUniform& uniform) const;
-    void UseUniform(const TextureUniform& uniform) const;
+    void UseUniform(const DataUniform& uniform, const ShaderProgram& shaderProgram, ShaderProgram::Location targetLocation) const;
+    // Textures are bound to their unit if they are not already. The unit is set to the uniform only if setUnit is true
+    void UseUniform(const TextureUniform& uniform, const ShaderProgram& shaderProgram, ShaderProgram::Location targetLocation, bool setUnit) const;
 
     // Get the buffer where data values are stored for a certain type
     template<typename T>
@@ -164,6 +243,11 @@ private:
     // Get the size of a data property
     int GetDataUniformSize(const DataUniform& uniform) const;
 
+    // Copy the values of the properties with the same name and type from another collection
+    void CopyUniformValues(const ShaderUniformCollection& source);
+    template<typename T>
+    void CopyDataValues(const DataUniform& uniform, const ShaderUniformCollection& source, const DataUniform& sourceUniform);
+
     // Delete all the properties and set the shader program to null
     void Reset();
 
@@ -179,6 +263,9 @@ protected:
     // The shader program
     std::shared_ptr<ShaderProgram> m_shaderProgram;
 
+    // Names that are not properties, kept to read the uniforms again
+    NameSet m_filteredUniforms;
+
 private:
     // The list of data properties
     std::vector<DataUniform> m_dataUniforms;
@@ -195,6 +282,26 @@ private:
     std::vector<unsigned int> m_uintDataValues;
     std::vector<float> m_floatDataValues;
     std::vector<double> m_doubleDataValues;
+
+    // Block members don't have locations in the program. They get locations starting here, above any real location
+    static constexpr ShaderProgram::Location BlockLocationBase = 0x40000000;
+
+    // Index of the material block in the shader program, -1 if it doesn't have one
+    ShaderProgram::Location m_materialBlockIndex;
+    // Locations of the block members by name
+    std::unordered_map<std::string, ShaderProgram::Location> m_blockLocations;
+
+    // Id set to the programs with the values, and serial incremented when a value changes
+    ValuesId m_valuesId;
+    unsigned long long m_changeSerial;
+
+    static Statistics s_statistics;
+
+    // Block data with the std140 layout, packed when it is used
+    mutable std::vector<std::byte> m_materialBlockData;
+    mutable bool m_materialBlockDirty;
+    mutable std::shared_ptr<UniformBufferPool> m_uniformBufferPool;
+    mutable UniformBufferPool::Allocation m_materialBlockAllocation;
 };
 
 
@@ -297,7 +404,19 @@ void ShaderUniformCollection::SetUniformValues(ShaderProgram::Location location,
     std::span<T> storedValues;
     GetDataValues(location, storedValues);
     assert(values.size() == storedValues.size());
+
+    // Setting the same values doesn't make them dirty
+    if (std::memcmp(storedValues.data(), values.data(), values.size_bytes()) == 0)
+    {
+        return;
+    }
+
     std::memcpy(storedValues.data(), values.data(), values.size_bytes());
+    GetDataUniform(location).serial = ++m_changeSerial;
+    if (IsBlockLocation(location))
+    {
+        m_materialBlockDirty = true;
+    }
 }
 
 template<typename T>
@@ -370,53 +489,76 @@ void ShaderUniformCollection::GetDataValues(ShaderProgram::Location location, st
 }
 
 template<typename T>
-T* ShaderUniformCollection::GetDataUniformPointer(const char* name)
+void ShaderUniformCollection::AddUniform(const DataUniform& uniform)
 {
-    ShaderProgram::Location location = GetUniformLocation(name);
-    assert(location >= 0);
-    return GetDataUniformPointer<T>(location);
+    m_locationDataIndex.insert(std::make_pair(uniform.location, static_cast<int>(m_dataUniforms.size())));
+    m_dataUniforms.push_back(uniform);
+
+    std::vector<T>& values = GetDataValues<T>();
+    m_dataUniforms.back().index = static_cast<int>(values.size());
+    int size = GetDataUniformSize(uniform);
+    values.insert(values.end(), size, T());
 }
 
 template<typename T>
-T* ShaderUniformCollection::GetDataUniformPointer(ShaderProgram::Location location)
+void ShaderUniformCollection::CopyDataValues(const DataUniform& uniform, const ShaderUniformCollection& source, const DataUniform& sourceUniform)
 {
-    const DataUniform& uniform = GetDataUniform(location);
-    std::vector<T>& allValues = GetDataValues<T>();
-    return &allValues[uniform.index];
+    // Arrays may have changed size, copy the elements in both
+    int size = GetDataUniformSize(uniform) / uniform.count * std::min(uniform.count, sourceUniform.count);
+    const std::vector<T>& sourceValues = source.GetDataValues<T>();
+    std::copy_n(sourceValues.begin() + sourceUniform.index, size, GetDataValues<T>().begin() + uniform.index);
 }
 
 template<typename T>
-void ShaderUniformCollection::AddUniform(const DataUniform& uniform)
+void ShaderUniformCollection::PackBlockValues(const DataUniform& uniform) const
 {
-    m_locationDataIndex.insert(std::make_pair(uniform.location, static_cast<int>(m_dataUniforms.size())));
-    m_dataUniforms.push_back(uniform);
+    // Vectors are one column of its size, and each matrix column is stored as a vector
+    int columns = 1;
+    int rows = 1;
+    if (uniform.dimension >= UniformDimension::VectorFirst && uniform.dimension <= UniformDimension::VectorLast)
+    {
+        rows = static_cast<int>(uniform.dimension) - static_cast<int>(UniformDimension::VectorFirst) + 2;
+    }
+    else if (uniform.dimension >= UniformDimension::MatrixFirst && uniform.dimension <= UniformDimension::MatrixLast)
+    {
+        int offset = static_cast<int>(uniform.dimension) - static_cast<int>(UniformDimension::MatrixFirst);
+        columns = offset / 3 + 2;
+        rows = offset % 3 + 2;
+    }
 
-    std::vector<T>& values = GetDataValues<T>();
-    m_dataUniforms.back().index = static_cast<int>(values.size());
-    int size = GetDataUniformSize(uniform);
-    values.insert(values.end(), size, T());
+    const T* values = &GetDataValues<T>()[uniform.index];
+    for (unsigned int element = 0; element < uniform.count; ++element)
+    {
+        for (int column = 0; column < columns; ++column)
+        {
+            size_t offset = uniform.blockOffset + element * uniform.arrayStride + column * uniform.matrixStride;
+            assert(offset + rows * sizeof(T) <= m_materialBlockData.size());
+            std::memcpy(&m_materialBlockData[offset], values, rows * sizeof(T));
+            values += rows;
+        }
+    }
 }
 
 template<>
-void ShaderUniformCollection::UseUniform<float>(const DataUniform& uniform) const;
+void ShaderUniformCollection::UseUniform<float>(const DataUniform& uniform, const ShaderProgram& shaderProgram, ShaderProgram::Location targetLocation) const;
 
 template<typename T>
-void ShaderUniformCollection::UseUniform(const DataUniform& uniform) const
+void ShaderUniformCollection::UseUniform(const DataUniform& uniform, const ShaderProgram& shaderProgram, ShaderProgram::Location targetLocation) const
 {
     ShaderProgram::Location location = uniform.location;
     switch (uniform.dimension)
     {
     case UniformDimension::Scalar:
-        m_shaderProgram->SetUniforms<T>(location, GetDataValues<T>(location));
+        shaderProgram.SetUniforms<T>(targetLocation, GetDataValues<T>(location));
         break;
     case UniformDimension::Vector2:
-        m_shaderProgram->SetUniforms<T, 2>(location, GetDataValues<glm::vec<2, T>>(location));
+        shaderProgram.SetUniforms<T, 2>(targetLocation, GetDataValues<glm::vec<2, T>>(location));
         break;
     case UniformDimension::Vector3:
-        m_shaderProgram->SetUniforms<T, 3>(location, GetDataValues<glm::vec<3, T>>(location));
+        shaderProgram.SetUniforms<T, 3>(targetLocation, GetDataValues<glm::vec<3, T>>(location));
         break;
     case UniformDimension::Vector4:
-        m_shaderProgram->SetUniforms<T, 4>(location, GetDataValues<glm::vec<4, T>>(location));
+        shaderProgram.SetUniforms<T, 4>(targetLocation, GetDataValues<glm::vec<4, T>>(location));
         break;
     default:
         assert(false);
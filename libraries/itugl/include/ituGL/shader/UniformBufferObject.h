@@ -0,0 +1,20 @@
+#pragma once
+
+#include <ituGL/core/BufferObject.h>
+
+// Uniform Buffer Object (UBO) is the common term for a BufferObject when it is the source of the data of uniform blocks
+// Uniform blocks read from binding points. A range of the buffer is bound to a binding point, and blocks are set to read that binding point
+class UniformBufferObject : public BufferObjectBase<BufferObject::UniformBuffer>
+{
+public:
+    UniformBufferObject();
+
+    // Bind the whole buffer to an indexed binding point
+    void BindBase(GLuint index) const;
+
+    // Bind a range of the buffer to an indexed binding point. Offset must be a multiple of GetOffsetAlignment()
+    void BindRange(GLuint index, size_t offset, size_t size) const;
+
+    // Alignment required for the offset of the ranges, queried once
+    static size_t GetOffsetAlignment();
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <ituGL/shader/UniformBufferObject.h>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Ranges of a few large uniform buffers, so many uniform blocks share the same buffers instead of one buffer each
+// The buffers are allocated in pages. Ranges are aligned to the offset alignment, so each one can be bound with glBindBufferRange
+class UniformBufferPool
+{
+public:
+    // Range of bytes in one of the pages
+    struct Range
+    {
+        unsigned int pageIndex;
+        size_t offset;
+        size_t size;
+    };
+
+    // Owns a range of a pool and frees it when destroyed. Only movable, each owner of a block needs its own range
+    class Allocation
+    {
+    public:
+        Allocation();
+        Allocation(std::shared_ptr<UniformBufferPool> pool, size_t size);
+        ~Allocation();
+
+        Allocation(const Allocation&) = delete;
+        Allocation& operator = (const Allocation&) = delete;
+        Allocation(Allocation&& allocation) noexcept;
+        Allocation& operator = (Allocation&& allocation) noexcept;
+
+        inline bool IsValid() const { return m_pool != nullptr; }
+        inline const Range& GetRange() const { return m_range; }
+
+        void UpdateData(std::span<const std::byte> data) const;
+        void BindRange(GLuint binding) const;
+
+        // Free the range, leaving the allocation empty
+        void Release();
+
+    private:
+        std::shared_ptr<UniformBufferPool> m_pool;
+        Range m_range;
+    };
+
+public:
+    UniformBufferPool(size_t pageSize = 64 * 1024);
+
+    UniformBufferPool(const UniformBufferPool&) = delete;
+    UniformBufferPool& operator = (const UniformBufferPool&) = delete;
+
+    // Find a free range of at least size bytes, adding a page if none is big enough
+    Range Allocate(size_t size);
+    void Free(const Range& range);
+
+    // Write the data at the start of the range. Binds the page buffer
+    void UpdateData(const Range& range, std::span<const std::byte> data);
+
+    // Bind the range to an indexed binding point of the uniform blocks
+    void BindRange(GLuint binding, const Range& range) const;
+
+    inline unsigned int GetPageCount() const { return static_cast<unsigned int>(m_pages.size()); }
+    inline unsigned int GetAllocationCount() const { return m_allocationCount; }
+    inline size_t GetAllocatedSize() const { return m_allocatedSize; }
+
+    // Bytes of the buffers, allocated or not
+    size_t GetMemorySize() const;
+
+    // Pool used by the collections that don't have one. Shared while it is in use, and destroyed with its last user
+    static std::shared_ptr<UniformBufferPool> GetDefault();
+
+private:
+    struct Page
+    {
+        UniformBufferObject buffer;
+        size_t size;
+        // Bytes from the start given to ranges. Freed ranges go to the free list, not back here
+        size_t usedSize;
+    };
+
+private:
+    size_t m_pageSize;
+
+    std::vector<Page> m_pages;
+
+    // Freed ranges, reused first fit. Sorted by page and offset, so adjacent ranges are merged when freed
+    std::vector<Range> m_freeRanges;
+
+    unsigned int m_allocationCount;
+    size_t m_allocatedSize;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <ituGL/texture/TextureObject.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// CPU encoders for the block compressed formats, used to cook textures offline
+// Images are encoded in blocks of 4x4 texels. The values are encoded as stored, so sRGB data stays in sRGB
+class BlockCompression
+{
+public:
+    // Encodes a RGBA8 image (4 bytes per texel, tightly packed) in the block compressed format
+    // Blocks on the edges of images that are not multiple of 4 repeat the last row and column
+    static std::vector<std::byte> Encode(std::span<const std::byte> rgba, int width, int height, TextureObject::InternalFormat internalFormat);
+
+    // Block encoders, from 16 RGBA8 texels in rows
+    // BC1: RGB, 8 bytes. Always uses the opaque 4 color mode
+    static void EncodeBC1(const std::uint8_t texels[64], std::uint8_t block[8]);
+    // BC3: RGB as BC1, and alpha as BC4. 16 bytes
+    static void EncodeBC3(const std::uint8_t texels[64], std::uint8_t block[16]);
+    // BC4: One component, 8 bytes
+    static void EncodeBC4(const std::uint8_t texels[64], int component, std::uint8_t block[8]);
+    // BC5: Red and green, as two BC4 blocks. 16 bytes
+    static void EncodeBC5(const std::uint8_t texels[64], std::uint8_t block[16]);
+    // BC7: RGBA, 16 bytes. Only mode 6 (one subset, 7-bit endpoints with p-bits and 4-bit indices) is used
+    static void EncodeBC7(const std::uint8_t texels[64], std::uint8_t block[16]);
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <ituGL/texture/TextureObject.h>
+#include <ituGL/core/Data.h>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+class Texture2DObject;
+
+// Mipmap levels of an image generated on the CPU, so they can be created in a worker thread and uploaded all at once
+// The result doesn't depend on the GL driver, and the SIMD path gives the same result as the scalar reference
+class MipChain
+{
+public:
+    enum class Filter
+    {
+        // Average of 2x2 texels. Fast, a bit blurry
+        Box,
+        // Kaiser windowed sinc. Sharper, keeps more detail in the small levels
+        Kaiser,
+    };
+
+    // Tightly packed texels of one level
+    struct Level
+    {
+        int width;
+        int height;
+        std::vector<std::byte> data;
+    };
+
+public:
+    MipChain();
+
+    // Generates all the levels, from the base image down to 1x1. Supports UByte and Float data, with 1 to 4 components
+    // If srgb is set, color components are filtered in linear space. The alpha component is always linear
+    void Generate(std::span<const std::byte> data, int width, int height, int components, Data::Type dataType, bool srgb, Filter filter);
+
+    // Same as Generate, using only scalar code. Used to validate the optimized path
+    void GenerateReference(std::span<const std::byte> data, int width, int height, int components, Data::Type dataType, bool srgb, Filter filter);
+
+    void Clear();
+
+    inline unsigned int GetLevelCount() const { return static_cast<unsigned int>(m_levels.size()); }
+    inline const Level& GetLevel(unsigned int level) const { return m_levels[level]; }
+
+    inline int GetComponents() const { return m_components; }
+    inline Data::Type GetDataType() const { return m_dataType; }
+
+    // Sets every level as the image of the texture. The texture must be bound
+    void Upload(Texture2DObject& texture, TextureObject::Format format, TextureObject::InternalFormat internalFormat) const;
+
+    // True if the internal format stores color in sRGB space
+    static bool IsSRGB(TextureObject::InternalFormat internalFormat);
+
+private:
+    void Generate(std::span<const std::byte> data, int width, int height, int components, Data::Type dataType, bool srgb, Filter filter, bool reference);
+
+private:
+    std::vector<Level> m_levels;
+    int m_components;
+    Data::Type m_dataType;
+};
@@ -3,6 +3,16 @@
 #include <ituGL/core/Object.h>
 #include <span>
 
+// S3TC formats come from EXT_texture_compression_s3tc, available in all desktop drivers but not in the core profile headers
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
 // Abstract OpenGL object that encapsulates a Texture
 // There are different subtypes depending on the target
 class TextureObject : public Object
@@ -75,9 +85,25 @@ public:
     // Get number of components of the data type of the texture (packed components count as 1)
     static int GetDataComponentCount(InternalFormat internalFormat);
 
+    // True for the formats stored in blocks of 4x4 texels (BC1-BC7)
+    static bool IsBlockCompressed(InternalFormat internalFormat);
+
+    // Bytes of each 4x4 block of a block compressed format, 0 for other formats
+    static int GetBlockSize(InternalFormat internalFormat);
+
+    // Bytes of an image in a block compressed format. Partial blocks on the edges count as full blocks
+    static size_t GetCompressedImageSize(InternalFormat internalFormat, int width, int height);
+
     // Set active texture unit
     static void SetActiveTexture(GLint textureUnit);
 
+    // Bind the texture to a texture unit. Skipped if the last bind in that unit was this texture, then returns false
+    // The bindings are tracked for the binds done with TextureObject. After binding textures with OpenGL directly, call InvalidateUnitBindings
+    bool BindToUnit(GLint textureUnit) const;
+
+    // Forget the tracked bindings, so the next BindToUnit of each unit binds again
+    static void InvalidateUnitBindings();
+
 protected:
     // Bind the specific target. Used by the Bind() method in derived classes
     void Bind(Target target) const;
@@ -92,6 +118,21 @@ protected:
     static bool IsValidFormat(Format format, InternalFormat internalFormat);
 #endif
 
+private:
+    // Last texture bound in a texture unit. Other targets of the unit may have other textures, they are not tracked
+    struct UnitBinding
+    {
+        GLenum target;
+        Handle handle;
+    };
+
+    // Units tracked, the first ones are enough for the materials
+    static constexpr GLint TrackedUnitCount = 32;
+
+    static void SetUnitBinding(GLenum target, Handle handle);
+
+    static GLint s_activeTextureUnit;
+    static UnitBinding s_unitBindings[TrackedUnitCount];
 };
 
 // (C++) 5
@@ -227,6 +268,15 @@ enum TextureObject::InternalFormat : GLint
     InternalFormatRGBACompressed = GL_COMPRESSED_RGBA,
     InternalFormatSRGBCompressed = GL_COMPRESSED_SRGB,
     InternalFormatSRGBACompressed = GL_COMPRESSED_SRGB_ALPHA,
+    // Block compressed
+    InternalFormatBC1 = GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+    InternalFormatBC1SRGB = GL_COMPRESSED_SRGB_S3TC_DXT1_EXT,
+    InternalFormatBC3 = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+    InternalFormatBC3SRGB = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,
+    InternalFormatBC4 = GL_COMPRESSED_RED_RGTC1,
+    InternalFormatBC5 = GL_COMPRESSED_RG_RGTC2,
+    InternalFormatBC7 = GL_COMPRESSED_RGBA_BPTC_UNORM,
+    InternalFormatBC7SRGB = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,
     // Depth Stencil
     InternalFormatDepth = GL_DEPTH_COMPONENT,
     InternalFormatDepth16 = GL_DEPTH_COMPONENT16,
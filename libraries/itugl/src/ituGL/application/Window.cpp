@@ -4,8 +4,9 @@
 Window::Window(int width, int height, const char* title) : m_window(nullptr)
 {
     // Set some hints for window creation
+    // OpenGL 4.2 is needed for the base instance of the drawcalls and for BC7 textures
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 2);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 
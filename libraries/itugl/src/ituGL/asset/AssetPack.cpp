@@ -0,0 +1,247 @@
+#include <ituGL/asset/AssetPack.h>
+
+#include <ituGL/core/Hash.h>
+#include <ituGL/core/LZ4.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    constexpr char PackMagic[4] = { 'I', 'P', 'A', 'K' };
+    constexpr std::uint32_t PackVersion = 1;
+
+    // Data of each file starts aligned, so it can be used in place
+    constexpr std::uint64_t DataAlignment = 16;
+
+    // Followed by the data of the files, the table of contents and the paths
+    struct PackHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t entryCount;
+        std::uint32_t reserved;
+        std::uint64_t entriesOffset;
+        std::uint64_t pathsOffset;
+        std::uint64_t pathsSize;
+    };
+
+    inline bool IsBlockValid(std::uint64_t offset, std::uint64_t size, std::uint64_t fileSize)
+    {
+        return offset <= fileSize && size <= fileSize - offset;
+    }
+
+    inline void WritePadding(std::ofstream& stream, std::uint64_t& offset)
+    {
+        constexpr char padding[DataAlignment] = {};
+        std::uint64_t paddingSize = (DataAlignment - offset % DataAlignment) % DataAlignment;
+        stream.write(padding, paddingSize);
+        offset += paddingSize;
+    }
+}
+
+AssetPack::AssetPack() : m_paths(nullptr), m_pathsSize(0)
+{
+}
+
+bool AssetPack::Open(const char* path)
+{
+    Close();
+
+    if (!m_file.Open(path) || m_file.GetSize() < sizeof(PackHeader))
+    {
+        m_file.Close();
+        return false;
+    }
+
+    const std::byte* fileData = m_file.GetData().data();
+    const std::uint64_t fileSize = m_file.GetSize();
+    const PackHeader& header = *reinterpret_cast<const PackHeader*>(fileData);
+
+    bool valid = std::memcmp(header.magic, PackMagic, sizeof(PackMagic)) == 0
+        && header.version == PackVersion
+        && header.entriesOffset % alignof(Entry) == 0
+        && IsBlockValid(header.entriesOffset, std::uint64_t(header.entryCount) * sizeof(Entry), fileSize)
+        && IsBlockValid(header.pathsOffset, header.pathsSize, fileSize);
+    if (valid)
+    {
+        m_entries = std::span<const Entry>(reinterpret_cast<const Entry*>(fileData + header.entriesOffset), header.entryCount);
+        m_paths = reinterpret_cast<const char*>(fileData + header.pathsOffset);
+        m_pathsSize = header.pathsSize;
+
+        // Checked once here, so the reads don't need to
+        for (const Entry& entry : m_entries)
+        {
+            valid &= IsBlockValid(entry.offset, entry.storedSize, fileSize)
+                && IsBlockValid(entry.pathOffset, entry.pathLength, m_pathsSize)
+                && (entry.compression == Compression::LZ4 || (entry.compression == Compression::None && entry.storedSize == entry.size));
+        }
+    }
+
+    if (!valid)
+    {
+        std::cout << "ERROR::ASSET_PACK::INVALID_FILE: " << path << std::endl;
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void AssetPack::Close()
+{
+    m_file.Close();
+    m_entries = std::span<const Entry>();
+    m_paths = nullptr;
+    m_pathsSize = 0;
+}
+
+const AssetPack::Entry* AssetPack::Find(std::string_view path) const
+{
+    std::uint64_t pathHash = GetPathHash(path);
+    auto itEntry = std::lower_bound(m_entries.begin(), m_entries.end(), pathHash,
+        [](const Entry& entry, std::uint64_t hash) { return entry.pathHash < hash; });
+
+    // Different paths could have the same hash
+    for (; itEntry != m_entries.end() && itEntry->pathHash == pathHash; ++itEntry)
+    {
+        if (GetPath(*itEntry) == path)
+        {
+            return &*itEntry;
+        }
+    }
+    return nullptr;
+}
+
+std::string_view AssetPack::GetPath(const Entry& entry) const
+{
+    return std::string_view(m_paths + entry.pathOffset, entry.pathLength);
+}
+
+std::span<const std::byte> AssetPack::GetStoredData(const Entry& entry) const
+{
+    return m_file.GetData().subspan(entry.offset, entry.storedSize);
+}
+
+bool AssetPack::Read(const Entry& entry, std::vector<std::byte>& data) const
+{
+    std::span<const std::byte> storedData = GetStoredData(entry);
+    data.resize(entry.size);
+    switch (entry.compression)
+    {
+    case Compression::None:
+        std::copy(storedData.begin(), storedData.end(), data.begin());
+        return true;
+    case Compression::LZ4:
+        if (LZ4::Decompress(storedData, data))
+        {
+            return true;
+        }
+        std::cout << "ERROR::ASSET_PACK::CORRUPTED_ENTRY: " << GetPath(entry) << std::endl;
+        return false;
+    default:
+        return false;
+    }
+}
+
+int AssetPack::Build(const char* directory, const char* path, const BuildSettings& settings)
+{
+    std::filesystem::path directoryPath(directory);
+    std::filesystem::path packPath = std::filesystem::absolute(path).lexically_normal();
+
+    // Sorted, so the same directory always builds the same pack
+    std::vector<std::string> filePaths;
+    std::error_code error;
+    for (const std::filesystem::directory_entry& directoryEntry : std::filesystem::recursive_directory_iterator(directoryPath, error))
+    {
+        if (!directoryEntry.is_regular_file() || std::filesystem::absolute(directoryEntry.path()).lexically_normal() == packPath)
+        {
+            continue;
+        }
+        std::string extension = directoryEntry.path().extension().string();
+        if (std::find(settings.excludedExtensions.begin(), settings.excludedExtensions.end(), extension) != settings.excludedExtensions.end())
+        {
+            continue;
+        }
+        filePaths.push_back(directoryEntry.path().lexically_relative(directoryPath).lexically_normal().generic_string());
+    }
+    std::sort(filePaths.begin(), filePaths.end());
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        return -1;
+    }
+
+    // Written again at the end, when the offsets are known
+    PackHeader header{};
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(PackHeader));
+    std::uint64_t offset = sizeof(PackHeader);
+
+    std::vector<Entry> entries;
+    std::string paths;
+    std::vector<std::byte> compressedData;
+    for (const std::string& filePath : filePaths)
+    {
+        MappedFile file;
+        std::string sourcePath = (directoryPath / filePath).string();
+        if (!file.Open(sourcePath.c_str()) && std::filesystem::file_size(sourcePath, error) != 0)
+        {
+            std::cout << "ERROR::ASSET_PACK::FILE_NOT_READ: " << sourcePath << std::endl;
+            continue;
+        }
+        std::span<const std::byte> data = file.GetData();
+
+        Entry entry{};
+        entry.pathHash = GetPathHash(filePath);
+        entry.size = data.size();
+        entry.pathOffset = static_cast<std::uint32_t>(paths.size());
+        entry.pathLength = static_cast<std::uint32_t>(filePath.size());
+        paths += filePath;
+
+        std::span<const std::byte> storedData = data;
+        if (settings.compression == Compression::LZ4 && !data.empty())
+        {
+            compressedData.resize(LZ4::GetMaxCompressedSize(data.size()));
+            size_t compressedSize = LZ4::Compress(data, compressedData);
+            // Already compressed formats, like jpg or png, don't get smaller
+            if (compressedSize <= data.size() * (1.0f - settings.minSavings))
+            {
+                storedData = std::span<const std::byte>(compressedData.data(), compressedSize);
+                entry.compression = Compression::LZ4;
+            }
+        }
+
+        WritePadding(stream, offset);
+        entry.offset = offset;
+        entry.storedSize = storedData.size();
+        stream.write(reinterpret_cast<const char*>(storedData.data()), storedData.size());
+        offset += storedData.size();
+
+        entries.push_back(entry);
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.pathHash < b.pathHash; });
+
+    WritePadding(stream, offset);
+    std::memcpy(header.magic, PackMagic, sizeof(PackMagic));
+    header.version = PackVersion;
+    header.entryCount = static_cast<std::uint32_t>(entries.size());
+    header.entriesOffset = offset;
+    stream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+    offset += entries.size() * sizeof(Entry);
+
+    header.pathsOffset = offset;
+    header.pathsSize = paths.size();
+    stream.write(paths.data(), paths.size());
+
+    stream.seekp(0);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(PackHeader));
+    return stream.good() ? static_cast<int>(entries.size()) : -1;
+}
+
+std::uint64_t AssetPack::GetPathHash(std::string_view path)
+{
+    return Hash::FNV1a(path);
+}
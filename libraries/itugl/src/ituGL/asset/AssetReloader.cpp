@@ -0,0 +1,299 @@
+#include <ituGL/asset/AssetReloader.h>
+
+#include <ituGL/asset/ShaderSourceCache.h>
+#include <ituGL/asset/ShaderProgramCache.h>
+#include <ituGL/asset/Texture2DLoader.h>
+#include <ituGL/asset/ModelLoader.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/shader/ShaderProgramVariants.h>
+#include <ituGL/shader/Material.h>
+#include <ituGL/geometry/Model.h>
+#include <ituGL/geometry/Mesh.h>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+AssetReloader::AssetReloader() : m_reloadCount(0)
+{
+}
+
+void AssetReloader::AddShaderProgram(std::shared_ptr<ShaderProgram> shaderProgram, const ShaderProgramCache& shaderProgramCache,
+    const BuildFunction& buildFunction, const ReloadedFunction& reloadedFunction)
+{
+    assert(shaderProgram);
+    assert(buildFunction);
+
+    unsigned int index = static_cast<unsigned int>(m_shaderPrograms.size());
+    m_shaderPrograms.push_back(ShaderProgramEntry{ shaderProgram, &shaderProgramCache, buildFunction, reloadedFunction });
+    SetDependencies(shaderProgramCache.GetDependencies(), AssetType::ShaderProgram, index);
+}
+
+void AssetReloader::AddShaderVariants(std::shared_ptr<ShaderProgramVariants> shaderVariants, const ShaderProgramCache& shaderProgramCache)
+{
+    assert(shaderVariants);
+
+    unsigned int index = static_cast<unsigned int>(m_shaderVariants.size());
+    m_shaderVariants.push_back(ShaderVariantsEntry{ shaderVariants, &shaderProgramCache });
+    SetDependencies(shaderProgramCache.GetDependencies(), AssetType::ShaderVariants, index);
+}
+
+void AssetReloader::AddTexture(std::shared_ptr<Texture2DObject> texture, const char* path, Texture2DLoader& loader)
+{
+    assert(texture);
+
+    // Shared textures may be added more than once
+    for (const TextureEntry& entry : m_textures)
+    {
+        if (entry.texture == texture)
+        {
+            return;
+        }
+    }
+
+    unsigned int index = static_cast<unsigned int>(m_textures.size());
+    m_textures.push_back(TextureEntry{ texture, path, &loader });
+    AddDependency(path, AssetType::Texture, index);
+    if (loader.GetPreferCooked())
+    {
+        // The cooked file is loaded instead, when it is up to date
+        AddDependency(Texture2DLoader::GetCookedPath(path), AssetType::Texture, index);
+    }
+}
+
+void AssetReloader::AddModel(std::shared_ptr<Model> model, const char* path, ModelLoader& loader)
+{
+    assert(model);
+
+    unsigned int index = static_cast<unsigned int>(m_models.size());
+    m_models.push_back(ModelEntry{ model, path, &loader });
+    AddDependency(path, AssetType::Model, index);
+}
+
+void AssetReloader::AddMaterial(std::shared_ptr<Material> material)
+{
+    assert(material);
+    m_materials.push_back(material);
+}
+
+void AssetReloader::AddDependency(std::string_view path, AssetType type, unsigned int index)
+{
+    std::string normalizedPath = ShaderSourceCache::NormalizePath(path);
+    m_fileWatcher.AddFile(normalizedPath);
+    m_dependents.emplace(normalizedPath, AssetReference{ type, index });
+}
+
+void AssetReloader::SetDependencies(std::span<const std::string> paths, AssetType type, unsigned int index)
+{
+    std::vector<std::string> previousPaths;
+    std::erase_if(m_dependents, [&](const auto& pair)
+        {
+            bool previous = pair.second.type == type && pair.second.index == index;
+            if (previous)
+            {
+                previousPaths.push_back(pair.first);
+            }
+            return previous;
+        });
+
+    for (const std::string& path : paths)
+    {
+        AddDependency(path, type, index);
+    }
+
+    // Stop watching the files that no asset uses anymore, like an include that was removed
+    for (const std::string& path : previousPaths)
+    {
+        if (!m_dependents.contains(path))
+        {
+            m_fileWatcher.RemoveFile(path);
+        }
+    }
+}
+
+unsigned int AssetReloader::Update()
+{
+    m_changedPaths.clear();
+    m_fileWatcher.Poll(m_changedPaths);
+    if (m_changedPaths.empty())
+    {
+        return 0;
+    }
+
+    // Find the assets to reload, each one once even if several of its files changed
+    std::vector<bool> reloadShaderPrograms(m_shaderPrograms.size());
+    std::vector<bool> reloadShaderVariants(m_shaderVariants.size());
+    std::vector<bool> reloadTextures(m_textures.size());
+    std::vector<bool> reloadModels(m_models.size());
+    for (const std::string& path : m_changedPaths)
+    {
+        // The next build must read the file again
+        ShaderSourceCache::GetDefault().Invalidate(path);
+
+        auto range = m_dependents.equal_range(path);
+        for (auto itDependent = range.first; itDependent != range.second; ++itDependent)
+        {
+            const AssetReference& reference = itDependent->second;
+            switch (reference.type)
+            {
+            case AssetType::ShaderProgram:
+                reloadShaderPrograms[reference.index] = true;
+                break;
+            case AssetType::ShaderVariants:
+                reloadShaderVariants[reference.index] = true;
+                break;
+            case AssetType::Texture:
+                reloadTextures[reference.index] = true;
+                break;
+            case AssetType::Model:
+                reloadModels[reference.index] = true;
+                break;
+            }
+        }
+    }
+
+    unsigned int reloadCount = 0;
+
+    // Programs rebuilt, to refresh the materials that use them
+    std::vector<const ShaderProgram*> rebuiltShaderPrograms;
+    std::vector<const ShaderProgramVariants*> rebuiltShaderVariants;
+
+    for (unsigned int i = 0; i < m_shaderPrograms.size(); ++i)
+    {
+        if (reloadShaderPrograms[i] && ReloadShaderProgram(m_shaderPrograms[i], i))
+        {
+            rebuiltShaderPrograms.push_back(m_shaderPrograms[i].shaderProgram.get());
+            ++reloadCount;
+        }
+    }
+
+    for (unsigned int i = 0; i < m_shaderVariants.size(); ++i)
+    {
+        // Even if some variants fail, the others were rebuilt
+        if (reloadShaderVariants[i])
+        {
+            ReloadShaderVariants(m_shaderVariants[i], i);
+            rebuiltShaderVariants.push_back(m_shaderVariants[i].shaderVariants.get());
+            ++reloadCount;
+        }
+    }
+
+    for (unsigned int i = 0; i < m_textures.size(); ++i)
+    {
+        if (reloadTextures[i] && ReloadTexture(m_textures[i]))
+        {
+            ++reloadCount;
+        }
+    }
+
+    for (unsigned int i = 0; i < m_models.size(); ++i)
+    {
+        if (reloadModels[i] && ReloadModel(m_models[i]))
+        {
+            ++reloadCount;
+        }
+    }
+
+    // Locations may have changed in the rebuilt programs
+    if (!rebuiltShaderPrograms.empty() || !rebuiltShaderVariants.empty())
+    {
+        for (const std::shared_ptr<Material>& material : m_materials)
+        {
+            RefreshMaterial(*material, rebuiltShaderPrograms, rebuiltShaderVariants);
+        }
+        for (ModelEntry& entry : m_models)
+        {
+            for (unsigned int i = 0; i < entry.model->GetMaterialCount(); ++i)
+            {
+                RefreshMaterial(entry.model->GetMaterial(i), rebuiltShaderPrograms, rebuiltShaderVariants);
+            }
+        }
+    }
+
+    m_reloadCount += reloadCount;
+    return reloadCount;
+}
+
+bool AssetReloader::ReloadShaderProgram(ShaderProgramEntry& entry, unsigned int index)
+{
+    // Build into a new program, so the current one is kept if the new sources have errors
+    ShaderProgram shaderProgram;
+    if (!entry.buildFunction(shaderProgram))
+    {
+        std::cout << "ERROR::ASSET_RELOADER::SHADER_PROGRAM_NOT_REBUILT" << std::endl;
+        return false;
+    }
+
+    // The sources may include other files now
+    SetDependencies(entry.shaderProgramCache->GetDependencies(), AssetType::ShaderProgram, index);
+
+    *entry.shaderProgram = std::move(shaderProgram);
+    if (entry.reloadedFunction)
+    {
+        entry.reloadedFunction();
+    }
+    return true;
+}
+
+bool AssetReloader::ReloadShaderVariants(ShaderVariantsEntry& entry, unsigned int index)
+{
+    // Registered variants are notified again with the variant built function
+    if (!entry.shaderVariants->Rebuild() || entry.shaderVariants->GetVariantCount() == 0)
+    {
+        return false;
+    }
+
+    // The keywords don't change which files are included, so the last variant built has all the dependencies
+    SetDependencies(entry.shaderProgramCache->GetDependencies(), AssetType::ShaderVariants, index);
+    return true;
+}
+
+bool AssetReloader::ReloadTexture(TextureEntry& entry)
+{
+    // Load into a new texture, so the current one is kept if the file can't be read, for example while it is being written
+    Texture2DObject texture;
+    if (!entry.loader->TryLoad(entry.path.c_str(), texture))
+    {
+        std::cout << "ERROR::ASSET_RELOADER::TEXTURE_NOT_RELOADED: " << entry.path << std::endl;
+        return false;
+    }
+
+    // Same object, so the materials using the texture get the new image
+    *entry.texture = std::move(texture);
+    return true;
+}
+
+bool AssetReloader::ReloadModel(ModelEntry& entry)
+{
+    Model model = entry.loader->Load(entry.path.c_str());
+    if (!model.HasMesh())
+    {
+        std::cout << "ERROR::ASSET_RELOADER::MODEL_NOT_RELOADED: " << entry.path << std::endl;
+        return false;
+    }
+
+    if (entry.model->HasMesh() && entry.model->GetMaterialCount() == model.GetMaterialCount())
+    {
+        // Keep the materials, they may have been changed after loading
+        entry.model->GetMesh() = std::move(model.GetMesh());
+    }
+    else
+    {
+        *entry.model = std::move(model);
+    }
+    return true;
+}
+
+void AssetReloader::RefreshMaterial(Material& material, std::span<const ShaderProgram* const> shaderPrograms,
+    std::span<const ShaderProgramVariants* const> shaderVariants)
+{
+    bool rebuilt = std::find(shaderPrograms.begin(), shaderPrograms.end(), material.GetShaderProgram().get()) != shaderPrograms.end();
+    if (!rebuilt && material.GetShaderVariants())
+    {
+        rebuilt = std::find(shaderVariants.begin(), shaderVariants.end(), material.GetShaderVariants().get()) != shaderVariants.end();
+    }
+
+    if (rebuilt)
+    {
+        material.RefreshUniforms();
+    }
+}
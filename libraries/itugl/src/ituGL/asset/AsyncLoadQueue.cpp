@@ -0,0 +1,87 @@
+#include <ituGL/asset/AsyncLoadQueue.h>
+
+#include <cassert>
+#include <chrono>
+
+namespace
+{
+    double GetTime()
+    {
+        using namespace std::chrono;
+        return duration<double>(steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+AsyncLoadQueue::AsyncLoadQueue(JobSystem& jobSystem)
+    : m_jobSystem(jobSystem)
+    , m_pendingCount(0)
+    , m_timeBudget(0.004)
+{
+}
+
+AsyncLoadQueue::~AsyncLoadQueue()
+{
+    // Pending uploads are discarded, and their assets keep the placeholder contents
+    m_jobSystem.Wait(m_counter);
+}
+
+void AsyncLoadQueue::Schedule(LoadFunction loadFunction)
+{
+    assert(loadFunction);
+
+    m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+    m_jobSystem.Schedule([this, loadFunction = std::move(loadFunction)]()
+        {
+            UploadFunction upload = loadFunction();
+
+            std::lock_guard<std::mutex> lock(m_uploadMutex);
+            m_uploads.push_back(std::move(upload));
+        }, &m_counter);
+}
+
+void AsyncLoadQueue::Update()
+{
+    double endTime = GetTime() + m_timeBudget;
+    do
+    {
+        if (!RunUpload())
+        {
+            break;
+        }
+    } while (GetTime() < endTime);
+}
+
+void AsyncLoadQueue::Flush()
+{
+    // Uploads can schedule more loads, for example the textures of a model
+    while (GetPendingCount() > 0)
+    {
+        if (!RunUpload())
+        {
+            // Help with the loads, so it works even without worker threads
+            m_jobSystem.Wait(m_counter);
+        }
+    }
+}
+
+bool AsyncLoadQueue::RunUpload()
+{
+    UploadFunction upload;
+    {
+        std::lock_guard<std::mutex> lock(m_uploadMutex);
+        if (m_uploads.empty())
+        {
+            return false;
+        }
+        upload = std::move(m_uploads.front());
+        m_uploads.pop_front();
+    }
+
+    // A load can fail without upload
+    if (upload)
+    {
+        upload();
+    }
+    m_pendingCount.fetch_sub(1, std::memory_order_release);
+    return true;
+}
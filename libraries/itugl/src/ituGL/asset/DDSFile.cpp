@@ -0,0 +1,278 @@
+#include <ituGL/asset/DDSFile.h>
+
+#include <ituGL/texture/Texture2DObject.h>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+// Layout of the DDS headers, see the DirectX documentation. All values are little endian
+namespace
+{
+    constexpr char DDSMagic[4] = { 'D', 'D', 'S', ' ' };
+
+    constexpr std::uint32_t FlagCaps = 0x1;
+    constexpr std::uint32_t FlagHeight = 0x2;
+    constexpr std::uint32_t FlagWidth = 0x4;
+    constexpr std::uint32_t FlagPixelFormat = 0x1000;
+    constexpr std::uint32_t FlagMipMapCount = 0x20000;
+    constexpr std::uint32_t FlagLinearSize = 0x80000;
+
+    constexpr std::uint32_t PixelFormatFourCC = 0x4;
+
+    constexpr std::uint32_t CapsComplex = 0x8;
+    constexpr std::uint32_t CapsTexture = 0x1000;
+    constexpr std::uint32_t CapsMipMap = 0x400000;
+
+    constexpr std::uint32_t ResourceDimensionTexture2D = 3;
+
+    // Cook settings in the last reserved fields of the header: a tag, then the flags
+    constexpr std::uint32_t CookTagIndex = 9;
+    constexpr std::uint32_t CookFlagsIndex = 10;
+    constexpr std::uint32_t CookFlagFlipVertical = 0x1;
+
+    struct PixelFormat
+    {
+        std::uint32_t size;
+        std::uint32_t flags;
+        std::uint32_t fourCC;
+        std::uint32_t rgbBitCount;
+        std::uint32_t bitMasks[4];
+    };
+
+    struct Header
+    {
+        std::uint32_t size;
+        std::uint32_t flags;
+        std::uint32_t height;
+        std::uint32_t width;
+        std::uint32_t pitchOrLinearSize;
+        std::uint32_t depth;
+        std::uint32_t mipMapCount;
+        std::uint32_t reserved1[11];
+        PixelFormat pixelFormat;
+        std::uint32_t caps[4];
+        std::uint32_t reserved2;
+    };
+    static_assert(sizeof(Header) == 124);
+
+    struct HeaderDX10
+    {
+        std::uint32_t dxgiFormat;
+        std::uint32_t resourceDimension;
+        std::uint32_t miscFlag;
+        std::uint32_t arraySize;
+        std::uint32_t miscFlags2;
+    };
+
+    constexpr std::uint32_t MakeFourCC(char a, char b, char c, char d)
+    {
+        return static_cast<std::uint32_t>(a) | (static_cast<std::uint32_t>(b) << 8) | (static_cast<std::uint32_t>(c) << 16) | (static_cast<std::uint32_t>(d) << 24);
+    }
+
+    // DXGI_FORMAT values of the supported formats
+    struct FormatEntry
+    {
+        std::uint32_t dxgiFormat;
+        TextureObject::InternalFormat internalFormat;
+    };
+    constexpr FormatEntry Formats[] = {
+        { 71, TextureObject::InternalFormatBC1 },
+        { 72, TextureObject::InternalFormatBC1SRGB },
+        { 77, TextureObject::InternalFormatBC3 },
+        { 78, TextureObject::InternalFormatBC3SRGB },
+        { 80, TextureObject::InternalFormatBC4 },
+        { 83, TextureObject::InternalFormatBC5 },
+        { 98, TextureObject::InternalFormatBC7 },
+        { 99, TextureObject::InternalFormatBC7SRGB },
+    };
+
+    bool GetDXGIInternalFormat(std::uint32_t dxgiFormat, TextureObject::InternalFormat& internalFormat)
+    {
+        for (const FormatEntry& entry : Formats)
+        {
+            if (entry.dxgiFormat == dxgiFormat)
+            {
+                internalFormat = entry.internalFormat;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::uint32_t GetDXGIFormat(TextureObject::InternalFormat internalFormat)
+    {
+        for (const FormatEntry& entry : Formats)
+        {
+            if (entry.internalFormat == internalFormat)
+            {
+                return entry.dxgiFormat;
+            }
+        }
+        return 0;
+    }
+
+    bool GetLegacyInternalFormat(std::uint32_t fourCC, TextureObject::InternalFormat& internalFormat)
+    {
+        switch (fourCC)
+        {
+        case MakeFourCC('D', 'X', 'T', '1'):
+            internalFormat = TextureObject::InternalFormatBC1;
+            return true;
+        case MakeFourCC('D', 'X', 'T', '5'):
+            internalFormat = TextureObject::InternalFormatBC3;
+            return true;
+        case MakeFourCC('A', 'T', 'I', '1'):
+        case MakeFourCC('B', 'C', '4', 'U'):
+            internalFormat = TextureObject::InternalFormatBC4;
+            return true;
+        case MakeFourCC('A', 'T', 'I', '2'):
+        case MakeFourCC('B', 'C', '5', 'U'):
+            internalFormat = TextureObject::InternalFormatBC5;
+            return true;
+        default:
+            return false;
+        }
+    }
+}
+
+DDSFile::DDSFile() : m_internalFormat(TextureObject::InternalFormatBC7), m_flipVertical(false)
+{
+}
+
+void DDSFile::Clear()
+{
+    m_levels.clear();
+    m_levelData.clear();
+    m_file.Close();
+}
+
+bool DDSFile::Read(const char* path)
+{
+    Clear();
+
+    if (!VirtualFileSystem::GetDefault().Open(path, m_file) || m_file.GetSize() < sizeof(DDSMagic) + sizeof(Header))
+    {
+        m_file.Close();
+        return false;
+    }
+
+    std::span<const std::byte> fileData = m_file.GetData();
+    Header header;
+    std::memcpy(&header, fileData.data() + sizeof(DDSMagic), sizeof(Header));
+    size_t offset = sizeof(DDSMagic) + sizeof(Header);
+
+    bool valid = std::memcmp(fileData.data(), DDSMagic, sizeof(DDSMagic)) == 0
+        && header.size == sizeof(Header)
+        && (header.pixelFormat.flags & PixelFormatFourCC) != 0
+        && header.width > 0 && header.height > 0;
+    if (valid && header.pixelFormat.fourCC == MakeFourCC('D', 'X', '1', '0'))
+    {
+        HeaderDX10 headerDX10;
+        valid = fileData.size() >= offset + sizeof(HeaderDX10);
+        if (valid)
+        {
+            std::memcpy(&headerDX10, fileData.data() + offset, sizeof(HeaderDX10));
+            offset += sizeof(HeaderDX10);
+            valid = headerDX10.resourceDimension == ResourceDimensionTexture2D && headerDX10.arraySize <= 1
+                && GetDXGIInternalFormat(headerDX10.dxgiFormat, m_internalFormat);
+        }
+    }
+    else if (valid)
+    {
+        valid = GetLegacyInternalFormat(header.pixelFormat.fourCC, m_internalFormat);
+    }
+    if (!valid)
+    {
+        Clear();
+        return false;
+    }
+    m_flipVertical = header.reserved1[CookTagIndex] == MakeFourCC('I', 'T', 'U', 'G') && (header.reserved1[CookFlagsIndex] & CookFlagFlipVertical) != 0;
+
+    unsigned int levelCount = (header.flags & FlagMipMapCount) && header.mipMapCount > 0 ? header.mipMapCount : 1;
+    int width = static_cast<int>(header.width);
+    int height = static_cast<int>(header.height);
+    for (unsigned int levelIndex = 0; levelIndex < levelCount; ++levelIndex)
+    {
+        size_t levelSize = TextureObject::GetCompressedImageSize(m_internalFormat, width, height);
+        if (offset + levelSize > fileData.size())
+        {
+            Clear();
+            return false;
+        }
+        m_levels.push_back(Level{ width, height, fileData.subspan(offset, levelSize) });
+        offset += levelSize;
+
+        if (width == 1 && height == 1)
+        {
+            break;
+        }
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return true;
+}
+
+bool DDSFile::Write(const char* path) const
+{
+    assert(!m_levels.empty());
+
+    const Level& baseLevel = m_levels.front();
+
+    Header header{};
+    header.size = sizeof(Header);
+    header.flags = FlagCaps | FlagHeight | FlagWidth | FlagPixelFormat | FlagMipMapCount | FlagLinearSize;
+    header.height = baseLevel.height;
+    header.width = baseLevel.width;
+    header.pitchOrLinearSize = static_cast<std::uint32_t>(baseLevel.data.size());
+    header.mipMapCount = GetLevelCount();
+    header.pixelFormat.size = sizeof(PixelFormat);
+    header.pixelFormat.flags = PixelFormatFourCC;
+    header.pixelFormat.fourCC = MakeFourCC('D', 'X', '1', '0');
+    header.reserved1[CookTagIndex] = MakeFourCC('I', 'T', 'U', 'G');
+    header.reserved1[CookFlagsIndex] = m_flipVertical ? CookFlagFlipVertical : 0;
+    header.caps[0] = CapsTexture | (GetLevelCount() > 1 ? CapsComplex | CapsMipMap : 0);
+
+    HeaderDX10 headerDX10{};
+    headerDX10.dxgiFormat = GetDXGIFormat(m_internalFormat);
+    headerDX10.resourceDimension = ResourceDimensionTexture2D;
+    headerDX10.arraySize = 1;
+    assert(headerDX10.dxgiFormat != 0);
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        return false;
+    }
+    stream.write(DDSMagic, sizeof(DDSMagic));
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    stream.write(reinterpret_cast<const char*>(&headerDX10), sizeof(HeaderDX10));
+    for (const Level& level : m_levels)
+    {
+        stream.write(reinterpret_cast<const char*>(level.data.data()), level.data.size());
+    }
+    return stream.good();
+}
+
+void DDSFile::AddLevel(int width, int height, std::vector<std::byte>&& data)
+{
+    assert(data.size() == TextureObject::GetCompressedImageSize(m_internalFormat, width, height));
+
+    // Moving the vector keeps its buffer, so the spans of the previous levels stay valid
+    m_levelData.push_back(std::move(data));
+    m_levels.push_back(Level{ width, height, m_levelData.back() });
+}
+
+void DDSFile::Upload(Texture2DObject& texture) const
+{
+    assert(!m_levels.empty());
+
+    for (unsigned int i = 0; i < GetLevelCount(); ++i)
+    {
+        const Level& level = m_levels[i];
+        texture.SetCompressedImage(i, level.width, level.height, m_internalFormat, level.data);
+    }
+    texture.SetParameter(TextureObject::ParameterInt::BaseLevel, 0);
+    texture.SetParameter(TextureObject::ParameterInt::MaxLevel, static_cast<int>(GetLevelCount()) - 1);
+}
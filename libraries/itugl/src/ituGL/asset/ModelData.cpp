@@ -0,0 +1,332 @@
+#include <ituGL/asset/ModelData.h>
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+// File layout: header, followed by the tables and the data blocks at the offsets in the header
+// Vertex and element data are aligned to DataAlignment, so they can be uploaded directly from the mapped file
+// All values are stored in the native (little endian) format
+struct ModelData::CacheHeader
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t sourceKey;
+    std::uint64_t fileSize;
+
+    std::uint32_t submeshCount;
+    std::uint32_t drawcallCount;
+    std::uint32_t materialCount;
+    std::uint32_t stringsSize;
+
+    std::uint64_t submeshesOffset;
+    std::uint64_t drawcallsOffset;
+    std::uint64_t materialsOffset;
+    std::uint64_t stringsOffset;
+};
+
+namespace
+{
+    constexpr char CacheMagic[4] = { 'I', 'M', 'D', 'L' };
+    constexpr std::uint64_t DataAlignment = 16;
+
+    // Position, normal, tangent, bitangent, 8 colors and 8 texture coordinates
+    constexpr unsigned int MaxAttributes = 20;
+
+    struct AttributeEntry
+    {
+        std::uint16_t type;
+        std::uint8_t components;
+        std::uint8_t normalized;
+        std::uint32_t semantic;
+    };
+
+    struct SubmeshEntry
+    {
+        std::uint32_t attributeCount;
+        std::uint32_t vertexCount;
+        std::uint32_t elementType;
+        std::uint32_t materialIndex;
+        std::uint32_t firstDrawcall;
+        std::uint32_t drawcallCount;
+        std::uint64_t vertexOffset;
+        std::uint64_t vertexSize;
+        std::uint64_t elementOffset;
+        std::uint64_t elementSize;
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+        glm::vec3 positionOffset;
+        float positionScale;
+        AttributeEntry attributes[MaxAttributes];
+    };
+
+    struct DrawcallEntry
+    {
+        std::uint32_t primitive;
+        std::int32_t first;
+        std::int32_t count;
+    };
+
+    struct StringEntry
+    {
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+
+    struct MaterialEntry
+    {
+        std::uint32_t flags;
+        glm::vec3 ambientColor;
+        glm::vec3 diffuseColor;
+        glm::vec3 specularColor;
+        float specularExponent;
+        StringEntry diffuseTexture;
+        StringEntry normalTexture;
+        StringEntry specularTexture;
+    };
+
+    static_assert(sizeof(glm::vec3) == 12, "Cache entries require tightly packed vectors");
+
+    std::uint64_t AlignOffset(std::uint64_t offset)
+    {
+        return (offset + DataAlignment - 1) / DataAlignment * DataAlignment;
+    }
+
+    // Appends a block at the next aligned offset of the file buffer and returns the offset
+    std::uint64_t AppendBlock(std::vector<char>& file, const void* data, size_t size)
+    {
+        std::uint64_t offset = AlignOffset(file.size());
+        file.resize(offset + size);
+        if (size > 0)
+        {
+            std::memcpy(&file[offset], data, size);
+        }
+        return offset;
+    }
+
+    StringEntry AddString(std::vector<char>& strings, const std::string& string)
+    {
+        StringEntry entry{ static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(string.size()) };
+        strings.insert(strings.end(), string.begin(), string.end());
+        return entry;
+    }
+
+    bool IsBlockValid(std::uint64_t offset, std::uint64_t size, std::uint64_t fileSize)
+    {
+        return offset <= fileSize && size <= fileSize - offset;
+    }
+}
+
+ModelData::ModelData()
+{
+}
+
+void ModelData::Clear()
+{
+    m_submeshes.clear();
+    m_materials.clear();
+    m_quantizationReport = VertexQuantization::QualityReport();
+    m_buffers.clear();
+    m_cacheFile.Close();
+}
+
+ModelData::SubmeshData& ModelData::AddSubmesh(std::vector<GLubyte>&& vertexData, std::vector<GLubyte>&& elementData)
+{
+    // Moving the vectors keeps their storage, so the spans stay valid when m_buffers grows
+    std::vector<GLubyte>& vertexBuffer = m_buffers.emplace_back(std::move(vertexData));
+    std::span<const GLubyte> vertexSpan = vertexBuffer;
+    std::vector<GLubyte>& elementBuffer = m_buffers.emplace_back(std::move(elementData));
+    std::span<const GLubyte> elementSpan = elementBuffer;
+
+    SubmeshData& submesh = m_submeshes.emplace_back();
+    submesh.vertexData = vertexSpan;
+    submesh.elementData = elementSpan;
+    return submesh;
+}
+
+void ModelData::AddMaterial(const MaterialData& material)
+{
+    m_materials.push_back(material);
+}
+
+bool ModelData::ReadCache(const char* path, std::uint64_t sourceKey)
+{
+    Clear();
+
+    if (!VirtualFileSystem::GetDefault().Open(path, m_cacheFile) || m_cacheFile.GetSize() < sizeof(CacheHeader))
+    {
+        m_cacheFile.Close();
+        return false;
+    }
+
+    const std::byte* fileData = m_cacheFile.GetData().data();
+    const std::uint64_t fileSize = m_cacheFile.GetSize();
+    const CacheHeader& header = *reinterpret_cast<const CacheHeader*>(fileData);
+
+    bool valid = std::memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) == 0
+        && header.version == CacheVersion
+        && header.sourceKey == sourceKey
+        && header.fileSize == fileSize
+        && IsBlockValid(header.submeshesOffset, header.submeshCount * sizeof(SubmeshEntry), fileSize)
+        && IsBlockValid(header.drawcallsOffset, header.drawcallCount * sizeof(DrawcallEntry), fileSize)
+        && IsBlockValid(header.materialsOffset, header.materialCount * sizeof(MaterialEntry), fileSize)
+        && IsBlockValid(header.stringsOffset, header.stringsSize, fileSize);
+    if (!valid)
+    {
+        m_cacheFile.Close();
+        return false;
+    }
+
+    const SubmeshEntry* submeshEntries = reinterpret_cast<const SubmeshEntry*>(fileData + header.submeshesOffset);
+    const DrawcallEntry* drawcallEntries = reinterpret_cast<const DrawcallEntry*>(fileData + header.drawcallsOffset);
+    const MaterialEntry* materialEntries = reinterpret_cast<const MaterialEntry*>(fileData + header.materialsOffset);
+    const char* strings = reinterpret_cast<const char*>(fileData + header.stringsOffset);
+
+    m_submeshes.reserve(header.submeshCount);
+    for (unsigned int submeshIndex = 0; submeshIndex < header.submeshCount; ++submeshIndex)
+    {
+        const SubmeshEntry& entry = submeshEntries[submeshIndex];
+        if (entry.attributeCount > MaxAttributes
+            || entry.materialIndex >= header.materialCount
+            || entry.firstDrawcall + static_cast<std::uint64_t>(entry.drawcallCount) > header.drawcallCount
+            || !IsBlockValid(entry.vertexOffset, entry.vertexSize, fileSize)
+            || !IsBlockValid(entry.elementOffset, entry.elementSize, fileSize))
+        {
+            Clear();
+            return false;
+        }
+
+        SubmeshData& submesh = m_submeshes.emplace_back();
+        for (unsigned int attributeIndex = 0; attributeIndex < entry.attributeCount; ++attributeIndex)
+        {
+            const AttributeEntry& attribute = entry.attributes[attributeIndex];
+            submesh.vertexFormat.AddVertexAttribute(static_cast<Data::Type>(attribute.type), attribute.components,
+                attribute.normalized != 0, static_cast<VertexAttribute::Semantic>(attribute.semantic));
+        }
+
+        // The vertex block must hold all the vertices in the format, or the upload would read past it
+        if (static_cast<std::uint64_t>(entry.vertexCount) * submesh.vertexFormat.GetSize() > entry.vertexSize)
+        {
+            Clear();
+            return false;
+        }
+        submesh.vertexCount = entry.vertexCount;
+        submesh.vertexData = std::span<const GLubyte>(reinterpret_cast<const GLubyte*>(fileData + entry.vertexOffset), entry.vertexSize);
+        submesh.elementType = static_cast<Data::Type>(entry.elementType);
+        submesh.elementData = std::span<const GLubyte>(reinterpret_cast<const GLubyte*>(fileData + entry.elementOffset), entry.elementSize);
+        for (unsigned int drawcallIndex = 0; drawcallIndex < entry.drawcallCount; ++drawcallIndex)
+        {
+            const DrawcallEntry& drawcall = drawcallEntries[entry.firstDrawcall + drawcallIndex];
+            submesh.drawcalls.push_back(DrawcallData{ static_cast<Drawcall::Primitive>(drawcall.primitive), drawcall.first, drawcall.count });
+        }
+        submesh.boundsMin = entry.boundsMin;
+        submesh.boundsMax = entry.boundsMax;
+        submesh.positionOffset = entry.positionOffset;
+        submesh.positionScale = entry.positionScale;
+        submesh.materialIndex = entry.materialIndex;
+    }
+
+    auto getString = [&](const StringEntry& string)
+    {
+        return string.offset + static_cast<std::uint64_t>(string.length) <= header.stringsSize ? std::string(strings + string.offset, string.length) : std::string();
+    };
+
+    m_materials.reserve(header.materialCount);
+    for (unsigned int materialIndex = 0; materialIndex < header.materialCount; ++materialIndex)
+    {
+        const MaterialEntry& entry = materialEntries[materialIndex];
+        MaterialData& material = m_materials.emplace_back();
+        material.flags = entry.flags;
+        material.ambientColor = entry.ambientColor;
+        material.diffuseColor = entry.diffuseColor;
+        material.specularColor = entry.specularColor;
+        material.specularExponent = entry.specularExponent;
+        material.diffuseTexture = getString(entry.diffuseTexture);
+        material.normalTexture = getString(entry.normalTexture);
+        material.specularTexture = getString(entry.specularTexture);
+    }
+
+    return true;
+}
+
+bool ModelData::WriteCache(const char* path, std::uint64_t sourceKey) const
+{
+    // Build the tables first, with the data blocks appended after the header
+    std::vector<char> file(sizeof(CacheHeader));
+
+    std::vector<SubmeshEntry> submeshEntries;
+    std::vector<DrawcallEntry> drawcallEntries;
+    for (const SubmeshData& submesh : m_submeshes)
+    {
+        assert(static_cast<unsigned int>(submesh.vertexFormat.GetAttributeCount()) <= MaxAttributes);
+
+        SubmeshEntry entry{};
+        entry.attributeCount = submesh.vertexFormat.GetAttributeCount();
+        for (unsigned int attributeIndex = 0; attributeIndex < entry.attributeCount; ++attributeIndex)
+        {
+            VertexAttribute attribute = submesh.vertexFormat.GetAttribute(attributeIndex);
+            entry.attributes[attributeIndex].type = static_cast<std::uint16_t>(attribute.GetType());
+            entry.attributes[attributeIndex].components = static_cast<std::uint8_t>(attribute.GetComponents());
+            entry.attributes[attributeIndex].normalized = attribute.IsNormalized() ? 1 : 0;
+            entry.attributes[attributeIndex].semantic = static_cast<std::uint32_t>(attribute.GetSemantic());
+        }
+        entry.vertexCount = submesh.vertexCount;
+        entry.elementType = static_cast<std::uint32_t>(submesh.elementType);
+        entry.materialIndex = submesh.materialIndex;
+        entry.firstDrawcall = static_cast<std::uint32_t>(drawcallEntries.size());
+        entry.drawcallCount = static_cast<std::uint32_t>(submesh.drawcalls.size());
+        entry.vertexSize = submesh.vertexData.size();
+        entry.vertexOffset = AppendBlock(file, submesh.vertexData.data(), submesh.vertexData.size());
+        entry.elementSize = submesh.elementData.size();
+        entry.elementOffset = AppendBlock(file, submesh.elementData.data(), submesh.elementData.size());
+        entry.boundsMin = submesh.boundsMin;
+        entry.boundsMax = submesh.boundsMax;
+        entry.positionOffset = submesh.positionOffset;
+        entry.positionScale = submesh.positionScale;
+        submeshEntries.push_back(entry);
+
+        for (const DrawcallData& drawcall : submesh.drawcalls)
+        {
+            drawcallEntries.push_back(DrawcallEntry{ static_cast<std::uint32_t>(drawcall.primitive), drawcall.first, drawcall.count });
+        }
+    }
+
+    std::vector<MaterialEntry> materialEntries;
+    std::vector<char> strings;
+    for (const MaterialData& material : m_materials)
+    {
+        MaterialEntry entry{};
+        entry.flags = material.flags;
+        entry.ambientColor = material.ambientColor;
+        entry.diffuseColor = material.diffuseColor;
+        entry.specularColor = material.specularColor;
+        entry.specularExponent = material.specularExponent;
+        entry.diffuseTexture = AddString(strings, material.diffuseTexture);
+        entry.normalTexture = AddString(strings, material.normalTexture);
+        entry.specularTexture = AddString(strings, material.specularTexture);
+        materialEntries.push_back(entry);
+    }
+
+    CacheHeader header{};
+    std::memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.version = CacheVersion;
+    header.sourceKey = sourceKey;
+    header.submeshCount = static_cast<std::uint32_t>(submeshEntries.size());
+    header.drawcallCount = static_cast<std::uint32_t>(drawcallEntries.size());
+    header.materialCount = static_cast<std::uint32_t>(materialEntries.size());
+    header.stringsSize = static_cast<std::uint32_t>(strings.size());
+    header.submeshesOffset = AppendBlock(file, submeshEntries.data(), submeshEntries.size() * sizeof(SubmeshEntry));
+    header.drawcallsOffset = AppendBlock(file, drawcallEntries.data(), drawcallEntries.size() * sizeof(DrawcallEntry));
+    header.materialsOffset = AppendBlock(file, materialEntries.data(), materialEntries.size() * sizeof(MaterialEntry));
+    header.stringsOffset = AppendBlock(file, strings.data(), strings.size());
+    header.fileSize = file.size();
+    std::memcpy(file.data(), &header, sizeof(CacheHeader));
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        return false;
+    }
+    stream.write(file.data(), file.size());
+    return stream.good();
+}
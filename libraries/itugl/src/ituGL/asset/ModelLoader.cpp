@@ -1,17 +1,148 @@
 #include <ituGL/asset/ModelLoader.h>
 
 #include <ituGL/geometry/VertexFormat.h>
+#include <ituGL/geometry/MeshOptimizer.h>
 #include <ituGL/shader/Material.h>
 #include <ituGL/asset/Texture2DLoader.h>
+#include <ituGL/asset/AsyncLoadQueue.h>
+#include <ituGL/core/Hash.h>
+#include <ituGL/asset/VirtualFileSystem.h>
 #include <assimp/Importer.hpp>
+#include <assimp/IOSystem.hpp>
+#include <assimp/IOStream.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <glm/common.hpp>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <bit>
 
+namespace
+{
+    // Changing the flags invalidates the cached models
+    constexpr unsigned int ImportFlags = aiProcess_CalcTangentSpace | aiProcess_GenNormals | aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType;
+
+    // Increase when the mesh optimization changes, to invalidate the cached models
+    constexpr unsigned int OptimizerVersion = 1;
+
+    // Read-only Assimp stream over a file opened with VirtualFileSystem
+    class VirtualIOStream : public Assimp::IOStream
+    {
+    public:
+        VirtualIOStream(VirtualFile&& file) : m_file(std::move(file)), m_position(0)
+        {
+        }
+
+        size_t Read(void* buffer, size_t size, size_t count) override
+        {
+            if (size == 0)
+            {
+                return 0;
+            }
+            // Only whole elements are read
+            count = std::min(count, (m_file.GetSize() - m_position) / size);
+            std::memcpy(buffer, m_file.GetData().data() + m_position, size * count);
+            m_position += size * count;
+            return count;
+        }
+
+        size_t Write(const void*, size_t, size_t) override
+        {
+            return 0;
+        }
+
+        aiReturn Seek(size_t offset, aiOrigin origin) override
+        {
+            size_t position;
+            switch (origin)
+            {
+            case aiOrigin_SET:
+                position = offset;
+                break;
+            case aiOrigin_CUR:
+                position = m_position + offset;
+                break;
+            case aiOrigin_END:
+                position = m_file.GetSize() - offset;
+                break;
+            default:
+                return aiReturn_FAILURE;
+            }
+            if (position > m_file.GetSize())
+            {
+                return aiReturn_FAILURE;
+            }
+            m_position = position;
+            return aiReturn_SUCCESS;
+        }
+
+        size_t Tell() const override
+        {
+            return m_position;
+        }
+
+        size_t FileSize() const override
+        {
+            return m_file.GetSize();
+        }
+
+        void Flush() override
+        {
+        }
+
+    private:
+        VirtualFile m_file;
+        size_t m_position;
+    };
+
+    // Makes Assimp read the model, and the files it references, like materials, with VirtualFileSystem
+    class VirtualIOSystem : public Assimp::IOSystem
+    {
+    public:
+        bool Exists(const char* path) const override
+        {
+            return VirtualFileSystem::GetDefault().Exists(GetPath(path));
+        }
+
+        char getOsSeparator() const override
+        {
+            return '/';
+        }
+
+        Assimp::IOStream* Open(const char* path, const char* mode) override
+        {
+            // Models are never written
+            VirtualFile file;
+            if (std::strchr(mode, 'w') || std::strchr(mode, 'a') || !VirtualFileSystem::GetDefault().Open(GetPath(path), file))
+            {
+                return nullptr;
+            }
+            return new VirtualIOStream(std::move(file));
+        }
+
+        void Close(Assimp::IOStream* stream) override
+        {
+            delete stream;
+        }
+
+    private:
+        // Some formats reference files with Windows separators
+        static std::string GetPath(const char* path)
+        {
+            std::string pathString(path);
+            std::replace(pathString.begin(), pathString.end(), '\\', '/');
+            return pathString;
+        }
+    };
+}
+
 ModelLoader::ModelLoader(std::shared_ptr<Material> referenceMaterial)
     : m_referenceMaterial(referenceMaterial)
     , m_createMaterials(false)
+    , m_cacheEnabled(true)
+    , m_compactVertexFormat(false)
+    , m_asyncLoadQueue(nullptr)
 {
     m_textureLoader.SetGenerateMipmap(true);
 }
@@ -49,6 +180,26 @@ const Texture2DLoader& ModelLoader::GetTexture2DLoader() const
     return m_textureLoader;
 }
 
+bool ModelLoader::GetCacheEnabled() const
+{
+    return m_cacheEnabled;
+}
+
+void ModelLoader::SetCacheEnabled(bool cacheEnabled)
+{
+    m_cacheEnabled = cacheEnabled;
+}
+
+bool ModelLoader::GetCompactVertexFormat() const
+{
+    return m_compactVertexFormat;
+}
+
+void ModelLoader::SetCompactVertexFormat(bool compactVertexFormat)
+{
+    m_compactVertexFormat = compactVertexFormat;
+}
+
 bool ModelLoader::SetMaterialAttribute(VertexAttribute::Semantic semantic, const char* attributeName)
 {
     bool found = false;
@@ -77,30 +228,70 @@ Model ModelLoader::Load(const char* path)
 {
     Model model;
 
-    // Read the file using Assimp importer
-    Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(path,
-        aiProcess_CalcTangentSpace | aiProcess_GenNormals | aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType);
+    ModelData modelData;
+    if (LoadData(path, modelData))
+    {
+        model = CreateModel(modelData, path);
+    }
+
+    return model;
+}
+
+bool ModelLoader::LoadData(const char* path, ModelData& modelData) const
+{
+    // Use the cache only if it was cooked from the same source and import settings
+    std::uint64_t sourceKey = 0;
+    bool useCache = m_cacheEnabled && GetSourceKey(path, m_compactVertexFormat, sourceKey);
+    std::string cachePath = GetCachePath(path);
+    if (useCache && modelData.ReadCache(cachePath.c_str(), sourceKey))
+    {
+        return true;
+    }
+
+    if (!ImportData(path, m_compactVertexFormat, modelData))
+    {
+        return false;
+    }
+
+    if (useCache && !modelData.WriteCache(cachePath.c_str(), sourceKey))
+    {
+        std::cout << "ERROR::MODEL::CACHE_NOT_WRITTEN: " << cachePath << std::endl;
+    }
+    return true;
+}
+
+Model ModelLoader::CreateModel(const ModelData& modelData, const char* path)
+{
+    Model model;
 
     m_baseFolder = path;
     m_baseFolder.resize(m_baseFolder.rfind('/') + 1);
 
-    // If the file was loaded, load all the meshes as submeshes
-    if (scene)
+    m_quantizationReport.Merge(modelData.GetQuantizationReport());
+
+    // Materials are created when first used, and shared by the submeshes that use them
+    std::vector<std::shared_ptr<Material>> materials(modelData.GetMaterials().size());
+
+    model.SetMesh(std::make_shared<Mesh>());
+    Mesh& mesh = model.GetMesh();
+    for (const ModelData::SubmeshData& submeshData : modelData.GetSubmeshes())
     {
-        model.SetMesh(std::make_shared<Mesh>());
-        Mesh& mesh = model.GetMesh();
-        for (unsigned int meshIndex = 0; meshIndex < scene->mNumMeshes; ++meshIndex)
-        {
-            aiMesh& meshData = *scene->mMeshes[meshIndex];
-            GenerateSubmesh(mesh, meshData);
+        GenerateSubmesh(mesh, submeshData);
 
-            std::shared_ptr<Material> material = m_referenceMaterial;
-            if (m_createMaterials)
+        std::shared_ptr<Material> material = m_referenceMaterial;
+        if (m_createMaterials && submeshData.materialIndex < materials.size())
+        {
+            std::shared_ptr<Material>& sharedMaterial = materials[submeshData.materialIndex];
+            if (!sharedMaterial)
             {
-                // Create a new material with the material data
-                material = GenerateMaterial(*scene->mMaterials[meshData.mMaterialIndex]);
+                sharedMaterial = GenerateMaterial(modelData.GetMaterials()[submeshData.materialIndex]);
             }
+            material = sharedMaterial;
+        }
+
+        // Each drawcall of the submesh needs its material
+        for (size_t i = 0; i < submeshData.drawcalls.size(); ++i)
+        {
             model.AddMaterial(material);
         }
     }
@@ -108,98 +299,267 @@ Model ModelLoader::Load(const char* path)
     return model;
 }
 
-void ModelLoader::GenerateSubmesh(Mesh& mesh, const aiMesh& meshData)
+AssetHandle<Model> ModelLoader::LoadAsync(const char* path, AsyncLoadQueue& loadQueue)
+{
+    // Empty mesh, so the model can be rendered before it is loaded
+    AssetHandle<Model> handle(std::make_shared<Model>(std::make_shared<Mesh>()));
+
+    std::string pathString(path);
+    loadQueue.Schedule([this, handle, pathString, &loadQueue]() -> AsyncLoadQueue::UploadFunction
+        {
+            std::shared_ptr<ModelData> modelData = std::make_shared<ModelData>();
+            if (!LoadData(pathString.c_str(), *modelData))
+            {
+                return [handle]() { handle.SetState(AssetHandle<Model>::State::Failed); };
+            }
+
+            return [this, handle, pathString, modelData, &loadQueue]()
+                {
+                    m_asyncLoadQueue = &loadQueue;
+                    *handle.Get() = CreateModel(*modelData, pathString.c_str());
+                    m_asyncLoadQueue = nullptr;
+                    handle.SetState(AssetHandle<Model>::State::Ready);
+                };
+        });
+
+    return handle;
+}
+
+bool ModelLoader::ImportData(const char* path, bool compactVertexFormat, ModelData& modelData)
+{
+    modelData.Clear();
+
+    // Read the file using Assimp importer
+    Assimp::Importer importer;
+    // The importer deletes the IO system
+    importer.SetIOHandler(new VirtualIOSystem());
+    const aiScene* scene = importer.ReadFile(path, ImportFlags);
+    if (!scene)
+    {
+        return false;
+    }
+
+    // Load all the meshes as submeshes
+    VertexQuantization::QualityReport report;
+    for (unsigned int meshIndex = 0; meshIndex < scene->mNumMeshes; ++meshIndex)
+    {
+        CollectSubmeshData(modelData, *scene->mMeshes[meshIndex], compactVertexFormat, report);
+    }
+    modelData.SetQuantizationReport(report);
+
+    for (unsigned int materialIndex = 0; materialIndex < scene->mNumMaterials; ++materialIndex)
+    {
+        modelData.AddMaterial(CollectMaterialData(*scene->mMaterials[materialIndex]));
+    }
+
+    return true;
+}
+
+bool ModelLoader::GetSourceKey(const char* path, bool compactVertexFormat, std::uint64_t& sourceKey)
+{
+    VirtualFile sourceFile;
+    if (!VirtualFileSystem::GetDefault().Open(path, sourceFile))
+    {
+        return false;
+    }
+
+    sourceKey = Hash::FNV1a(sourceFile.GetData());
+    sourceKey = Hash::FNV1a(std::as_bytes(std::span<const unsigned int>(&ImportFlags, 1)), sourceKey);
+    sourceKey = Hash::FNV1a(std::as_bytes(std::span<const unsigned int>(&OptimizerVersion, 1)), sourceKey);
+    sourceKey = Hash::FNV1a(std::as_bytes(std::span<const bool>(&compactVertexFormat, 1)), sourceKey);
+    return true;
+}
+
+std::string ModelLoader::GetCachePath(const char* path)
+{
+    return std::string(path) + ".meshcache";
+}
+
+void ModelLoader::CollectSubmeshData(ModelData& modelData, const aiMesh& meshData, bool compactVertexFormat, VertexQuantization::QualityReport& report)
 {
     // Collect vertex data
     VertexFormat vertexFormat;
     bool interleaved = true;
     std::vector<GLubyte> vertexData = CollectVertexData(meshData, vertexFormat, interleaved);
-    int vboIndex = mesh.AddVertexData<GLubyte>(vertexData);
 
     // Collect element data
     Data::Type elementType;
     std::vector<Drawcall::Primitive> primitives;
     std::vector<int> elementCounts;
     std::vector<GLubyte> elementData = CollectElementData(meshData, elementType, primitives, elementCounts);
-    int eboIndex = mesh.AddElementData<GLubyte>(elementData);
 
-    // Add submeshes
+    // Reorder triangles and vertices for the GPU caches. Meshes with mixed primitives are left as they are
+    unsigned int vertexCount = meshData.mNumVertices;
+    if (primitives.size() == 1 && primitives[0] == Drawcall::Primitive::Triangles && interleaved)
+    {
+        vertexCount = OptimizeTriangles(vertexData, vertexFormat.GetSize(), elementData, elementType);
+    }
+
+    // Bounds of the positions
+    glm::vec3 boundsMin(0.0f);
+    glm::vec3 boundsMax(0.0f);
+    if (meshData.mNumVertices > 0)
+    {
+        boundsMin = glm::vec3(meshData.mVertices[0].x, meshData.mVertices[0].y, meshData.mVertices[0].z);
+        boundsMax = boundsMin;
+        for (unsigned int vertexIndex = 1; vertexIndex < meshData.mNumVertices; ++vertexIndex)
+        {
+            const aiVector3D& position = meshData.mVertices[vertexIndex];
+            boundsMin = glm::min(boundsMin, glm::vec3(position.x, position.y, position.z));
+            boundsMax = glm::max(boundsMax, glm::vec3(position.x, position.y, position.z));
+        }
+    }
+
+    // Quantize after the optimization, it needs the float positions
+    VertexQuantization::PositionTransform positionTransform{ glm::vec3(0.0f), 1.0f };
+    if (compactVertexFormat && interleaved)
+    {
+        positionTransform = VertexQuantization::GetPositionTransform(boundsMin, boundsMax);
+        vertexData = QuantizeVertexData(vertexData, vertexFormat, vertexCount, positionTransform, report);
+    }
+
+    ModelData::SubmeshData& submeshData = modelData.AddSubmesh(std::move(vertexData), std::move(elementData));
+    submeshData.vertexFormat = vertexFormat;
+    submeshData.vertexCount = vertexCount;
+    submeshData.elementType = elementType;
+    submeshData.materialIndex = meshData.mMaterialIndex;
+    submeshData.boundsMin = boundsMin;
+    submeshData.boundsMax = boundsMax;
+    submeshData.positionOffset = positionTransform.offset;
+    submeshData.positionScale = positionTransform.scale;
+
+    // Element counts are the end of each range, in bytes. Drawcalls take the start in bytes and the count in elements
+    int elementSize = Data::GetTypeSize(elementType);
     int start = 0;
     assert(primitives.size() == elementCounts.size());
     for (int i = 0; i < primitives.size(); ++i)
     {
-        Drawcall::Primitive primitive = primitives[i];
         int end = elementCounts[i];
-        mesh.AddSubmesh(primitive, start, end - start, elementType, eboIndex, vboIndex, vertexFormat.LayoutBegin(static_cast<int>(vertexData.size()), interleaved), vertexFormat.LayoutEnd(), m_materialAttributeMap);
+        submeshData.drawcalls.push_back(ModelData::DrawcallData{ primitives[i], start, (end - start) / elementSize });
         start = end;
     }
 }
 
-std::shared_ptr<Material> ModelLoader::GenerateMaterial(const aiMaterial& materialData)
+ModelData::MaterialData ModelLoader::CollectMaterialData(const aiMaterial& materialData)
 {
-    std::shared_ptr<Material> material = std::make_shared<Material>(*m_referenceMaterial);
+    ModelData::MaterialData material;
+
+    aiColor3D color;
+    if (materialData.Get(AI_MATKEY_COLOR_AMBIENT, color) == aiReturn_SUCCESS)
+    {
+        material.ambientColor = glm::vec3(color.r, color.g, color.b);
+        material.flags |= ModelData::MaterialData::HasAmbientColor;
+    }
+    if (materialData.Get(AI_MATKEY_COLOR_DIFFUSE, color) == aiReturn_SUCCESS)
+    {
+        material.diffuseColor = glm::vec3(color.r, color.g, color.b);
+        material.flags |= ModelData::MaterialData::HasDiffuseColor;
+    }
+    if (materialData.Get(AI_MATKEY_COLOR_SPECULAR, color) == aiReturn_SUCCESS)
+    {
+        material.specularColor = glm::vec3(color.r, color.g, color.b);
+        material.flags |= ModelData::MaterialData::HasSpecularColor;
+    }
     float value;
+    if (materialData.Get(AI_MATKEY_SHININESS, value) == aiReturn_SUCCESS)
+    {
+        material.specularExponent = value;
+        material.flags |= ModelData::MaterialData::HasSpecularExponent;
+    }
+
+    auto getTexturePath = [&](aiTextureType textureType)
+    {
+        aiString texturePath;
+        if (materialData.GetTextureCount(textureType) > 0)
+        {
+            assert(materialData.GetTextureCount(textureType) == 1);
+            materialData.GetTexture(textureType, 0, &texturePath);
+        }
+        return std::string(texturePath.C_Str());
+    };
+    material.diffuseTexture = getTexturePath(aiTextureType_DIFFUSE);
+    material.normalTexture = getTexturePath(aiTextureType_NORMALS);
+    material.specularTexture = getTexturePath(aiTextureType_SHININESS);
+
+    return material;
+}
+
+void ModelLoader::GenerateSubmesh(Mesh& mesh, const ModelData::SubmeshData& submeshData)
+{
+    // Upload the data as it is, it was already packed on import
+    VertexFormat vertexFormat = submeshData.vertexFormat;
+    bool interleaved = true;
+    int vboIndex = mesh.AddVertexData<GLubyte>(submeshData.vertexData);
+    int eboIndex = mesh.AddElementData<GLubyte>(submeshData.elementData);
+
+    // Add submeshes
+    for (const ModelData::DrawcallData& drawcall : submeshData.drawcalls)
+    {
+        unsigned int submeshIndex = mesh.AddSubmesh(drawcall.primitive, drawcall.first, drawcall.count, submeshData.elementType, vboIndex, eboIndex,
+            vertexFormat.LayoutBegin(submeshData.vertexCount, interleaved), vertexFormat.LayoutEnd(), m_materialAttributeMap);
+        mesh.SetSubmeshPositionTransform(submeshIndex, submeshData.positionOffset, submeshData.positionScale);
+    }
+}
+
+std::shared_ptr<Material> ModelLoader::GenerateMaterial(const ModelData::MaterialData& materialData)
+{
+    std::shared_ptr<Material> material = std::make_shared<Material>(*m_referenceMaterial);
     for (auto& materialPropertyPair : m_materialPropertyMap)
     {
-        aiColor3D color;
         MaterialProperty materialProperty = materialPropertyPair.first;
         ShaderProgram::Location location = materialPropertyPair.second;
         switch (materialProperty)
         {
         case MaterialProperty::AmbientColor:
-            if (materialData.Get(AI_MATKEY_COLOR_AMBIENT, color) == aiReturn_SUCCESS)
+            if (materialData.flags & ModelData::MaterialData::HasAmbientColor)
             {
-                material->SetUniformValue(location, glm::vec3(color.r, color.g, color.b));
+                material->SetUniformValue(location, materialData.ambientColor);
             }
             break;
         case MaterialProperty::DiffuseColor:
-            if (materialData.Get(AI_MATKEY_COLOR_DIFFUSE, color) == aiReturn_SUCCESS)
+            if (materialData.flags & ModelData::MaterialData::HasDiffuseColor)
             {
-                material->SetUniformValue(location, glm::vec3(color.r, color.g, color.b));
+                material->SetUniformValue(location, materialData.diffuseColor);
             }
             break;
         case MaterialProperty::SpecularColor:
-            if (materialData.Get(AI_MATKEY_COLOR_SPECULAR, color) == aiReturn_SUCCESS)
+            if (materialData.flags & ModelData::MaterialData::HasSpecularColor)
             {
-                material->SetUniformValue(location, glm::vec3(color.r, color.g, color.b));
+                material->SetUniformValue(location, materialData.specularColor);
             }
             break;
         case MaterialProperty::SpecularExponent:
-            if (materialData.Get(AI_MATKEY_SHININESS, value) == aiReturn_SUCCESS)
+            if (materialData.flags & ModelData::MaterialData::HasSpecularExponent)
             {
-                material->SetUniformValue(location, value);
+                material->SetUniformValue(location, materialData.specularExponent);
             }
             break;
         case MaterialProperty::DiffuseTexture:
-            LoadTexture(materialData, aiTextureType_DIFFUSE, *material, location, TextureObject::FormatRGBA, TextureObject::InternalFormatSRGBA8);
+            LoadTexture(materialData.diffuseTexture, *material, location, TextureObject::FormatRGBA, TextureObject::InternalFormatSRGBA8);
             break;
         case MaterialProperty::NormalTexture:
-            LoadTexture(materialData, aiTextureType_NORMALS, *material, location, TextureObject::FormatRGB, TextureObject::InternalFormatRGB8);
+            LoadTexture(materialData.normalTexture, *material, location, TextureObject::FormatRGB, TextureObject::InternalFormatRGB8);
             break;
         case MaterialProperty::SpecularTexture:
-            LoadTexture(materialData, aiTextureType_SHININESS, *material, location, TextureObject::FormatRGB, TextureObject::InternalFormatSRGB8);
+            LoadTexture(materialData.specularTexture, *material, location, TextureObject::FormatRGB, TextureObject::InternalFormatSRGB8);
             break;
         }
     }
     return material;
 }
 
-void ModelLoader::LoadTexture(const aiMaterial& materialData, int textureTypeValue, Material& material, ShaderProgram::Location location,
+void ModelLoader::LoadTexture(const std::string& texturePath, Material& material, ShaderProgram::Location location,
     TextureObject::Format format, TextureObject::InternalFormat internalFormat) const
 {
-    aiTextureType textureType = static_cast<aiTextureType>(textureTypeValue);
-    if (materialData.GetTextureCount(textureType) > 0)
+    if (!texturePath.empty())
     {
-        assert(materialData.GetTextureCount(textureType) == 1);
-        aiString texturePath;
-        if (materialData.GetTexture(textureType, 0, &texturePath) == aiReturn_SUCCESS)
-        {
-            texturePath = m_baseFolder + texturePath.C_Str();
-            m_textureLoader.SetFormat(format);
-            m_textureLoader.SetInternalFormat(internalFormat);
-            std::shared_ptr<Texture2DObject> texture = m_textureLoader.LoadShared(texturePath.C_Str());
-            material.SetUniformValue(location, texture);
-        }
+        std::string fullPath = m_baseFolder + texturePath;
+        m_textureLoader.SetFormat(format);
+        m_textureLoader.SetInternalFormat(internalFormat);
+        std::shared_ptr<Texture2DObject> texture = m_asyncLoadQueue
+            ? m_textureLoader.LoadSharedAsync(fullPath.c_str(), *m_asyncLoadQueue).Get()
+            : m_textureLoader.LoadShared(fullPath.c_str());
+        material.SetUniformValue(location, texture);
     }
 }
 
@@ -253,6 +613,135 @@ std::vector<GLubyte> ModelLoader::CollectVertexData(const aiMesh& meshData, Vert
     return vertexData;
 }
 
+std::vector<GLubyte> ModelLoader::QuantizeVertexData(const std::vector<GLubyte>& vertexData, VertexFormat& vertexFormat, unsigned int vertexCount,
+    const VertexQuantization::PositionTransform& positionTransform, VertexQuantization::QualityReport& report)
+{
+    using Semantic = VertexAttribute::Semantic;
+
+    // Offsets of the source attributes inside a vertex
+    std::vector<VertexAttribute::Layout> sourceLayouts;
+    int bitangentOffset = -1;
+    for (auto it = vertexFormat.LayoutBegin(vertexCount, true), itEnd = vertexFormat.LayoutEnd(); it != itEnd; it++)
+    {
+        sourceLayouts.push_back(*it);
+        if (it->GetAttribute().GetSemantic() == Semantic::Bitangent)
+        {
+            bitangentOffset = it->GetOffset();
+        }
+    }
+
+    // Compact format, with the same attributes except the bitangent, which is rebuilt from the sign in the tangent
+    VertexFormat compactFormat;
+    for (const VertexAttribute::Layout& layout : sourceLayouts)
+    {
+        const VertexAttribute& attribute = layout.GetAttribute();
+        Semantic semantic = attribute.GetSemantic();
+        bool isFloat = attribute.GetType() == Data::Type::Float;
+        if (semantic == Semantic::Position && isFloat)
+        {
+            compactFormat.AddVertexAttribute(Data::Type::Short, 4, true, semantic);
+        }
+        else if ((semantic == Semantic::Normal || semantic == Semantic::Tangent) && isFloat)
+        {
+            compactFormat.AddVertexAttribute(Data::Type::Int2101010Rev, 4, true, semantic);
+        }
+        else if (semantic == Semantic::Bitangent)
+        {
+            continue;
+        }
+        else if (semantic >= Semantic::TexCoord0 && semantic <= Semantic::TexCoord7 && isFloat)
+        {
+            // Even number of components, to keep the attributes aligned to 4 bytes
+            compactFormat.AddVertexAttribute(Data::Type::Half, (attribute.GetComponents() + 1) & ~1, false, semantic);
+        }
+        else
+        {
+            compactFormat.AddVertexAttribute(attribute.GetType(), attribute.GetComponents(), attribute.IsNormalized(), semantic);
+        }
+    }
+
+    std::vector<VertexAttribute::Layout> compactLayouts;
+    for (auto it = compactFormat.LayoutBegin(vertexCount, true), itEnd = compactFormat.LayoutEnd(); it != itEnd; it++)
+    {
+        compactLayouts.push_back(*it);
+    }
+
+    size_t sourceSize = vertexFormat.GetSize();
+    size_t compactSize = compactFormat.GetSize();
+    std::vector<GLubyte> compactData(compactSize * vertexCount);
+    for (unsigned int vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+    {
+        const GLubyte* sourceVertex = &vertexData[vertexIndex * sourceSize];
+        GLubyte* compactVertex = &compactData[vertexIndex * compactSize];
+        auto readVector = [&](int offset, int components)
+            {
+                glm::vec4 value(0.0f);
+                std::memcpy(&value, sourceVertex + offset, components * sizeof(float));
+                return value;
+            };
+
+        auto itCompact = compactLayouts.begin();
+        glm::vec3 normal(0.0f, 0.0f, 1.0f);
+        for (const VertexAttribute::Layout& layout : sourceLayouts)
+        {
+            const VertexAttribute& attribute = layout.GetAttribute();
+            Semantic semantic = attribute.GetSemantic();
+            if (semantic == Semantic::Bitangent)
+            {
+                continue;
+            }
+
+            const VertexAttribute& compactAttribute = itCompact->GetAttribute();
+            GLubyte* destination = compactVertex + itCompact->GetOffset();
+            ++itCompact;
+
+            if (compactAttribute.GetType() == attribute.GetType())
+            {
+                std::memcpy(destination, sourceVertex + layout.GetOffset(), attribute.GetSize());
+            }
+            else if (semantic == Semantic::Position)
+            {
+                glm::vec3 position = readVector(layout.GetOffset(), 3);
+                glm::i16vec4 quantized = VertexQuantization::QuantizePosition(position, positionTransform);
+                std::memcpy(destination, &quantized, sizeof(quantized));
+                report.AddPosition(position, VertexQuantization::DequantizePosition(quantized, positionTransform));
+            }
+            else if (semantic == Semantic::Normal)
+            {
+                normal = readVector(layout.GetOffset(), 3);
+                std::uint32_t quantized = VertexQuantization::QuantizeDirection(normal);
+                std::memcpy(destination, &quantized, sizeof(quantized));
+                report.AddNormal(normal, VertexQuantization::DequantizeDirection(quantized));
+            }
+            else if (semantic == Semantic::Tangent)
+            {
+                // Normal is always before the tangent
+                glm::vec3 tangent = readVector(layout.GetOffset(), 3);
+                float sign = 1.0f;
+                if (bitangentOffset >= 0)
+                {
+                    sign = VertexQuantization::GetBitangentSign(normal, tangent, readVector(bitangentOffset, 3));
+                }
+                std::uint32_t quantized = VertexQuantization::QuantizeDirection(tangent, sign);
+                std::memcpy(destination, &quantized, sizeof(quantized));
+                report.AddTangent(tangent, VertexQuantization::DequantizeDirection(quantized));
+            }
+            else
+            {
+                // Texture coordinates, in pairs of half floats
+                glm::vec4 texCoord = readVector(layout.GetOffset(), attribute.GetComponents());
+                glm::u16vec2 quantized[2] = { VertexQuantization::QuantizeTexCoord(texCoord), VertexQuantization::QuantizeTexCoord(glm::vec2(texCoord.z, texCoord.w)) };
+                std::memcpy(destination, quantized, compactAttribute.GetSize());
+                report.AddTexCoord(glm::vec2(texCoord), VertexQuantization::DequantizeTexCoord(quantized[0]));
+            }
+        }
+    }
+    report.AddVertexData(vertexData.size(), compactData.size());
+
+    vertexFormat = compactFormat;
+    return compactData;
+}
+
 std::vector<GLubyte> ModelLoader::CollectElementData(const aiMesh& meshData, Data::Type& elementType,
     std::vector<Drawcall::Primitive>& primitives, std::vector<int>& elementCounts)
 {
@@ -300,6 +789,54 @@ std::vector<GLubyte> ModelLoader::CollectElementData(const aiMesh& meshData, Dat
     return elementData;
 }
 
+unsigned int ModelLoader::OptimizeTriangles(std::vector<GLubyte>& vertexData, size_t vertexSize, std::vector<GLubyte>& elementData, Data::Type elementType)
+{
+    int elementSize = Data::GetTypeSize(elementType);
+    std::vector<unsigned int> indices(elementData.size() / elementSize);
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        switch (elementType)
+        {
+        case Data::Type::UByte:
+            indices[i] = elementData[i];
+            break;
+        case Data::Type::UShort:
+            indices[i] = reinterpret_cast<const GLushort*>(elementData.data())[i];
+            break;
+        case Data::Type::UInt:
+            indices[i] = reinterpret_cast<const GLuint*>(elementData.data())[i];
+            break;
+        default:
+            assert(false);
+            return static_cast<unsigned int>(vertexData.size() / vertexSize);
+        }
+    }
+
+    // Position is always the first attribute
+    unsigned int vertexCount = MeshOptimizer::Optimize(indices, std::as_writable_bytes(std::span(vertexData)), vertexSize, 0);
+    vertexData.resize(vertexCount * vertexSize);
+
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        switch (elementType)
+        {
+        case Data::Type::UByte:
+            elementData[i] = static_cast<GLubyte>(indices[i]);
+            break;
+        case Data::Type::UShort:
+            reinterpret_cast<GLushort*>(elementData.data())[i] = static_cast<GLushort>(indices[i]);
+            break;
+        case Data::Type::UInt:
+            reinterpret_cast<GLuint*>(elementData.data())[i] = indices[i];
+            break;
+        default:
+            break;
+        }
+    }
+
+    return vertexCount;
+}
+
 const void* ModelLoader::GetVertexDataPointer(const aiMesh& meshData, VertexAttribute::Semantic semantic, int& stride)
 {
     const void* data = nullptr;
@@ -382,10 +919,13 @@ Drawcall::Primitive ModelLoader::GetPrimitiveType(int elementCount)
     {
     case 1:
         primitive = Drawcall::Primitive::Points;
+        break;
     case 2:
         primitive = Drawcall::Primitive::Lines;
+        break;
     case 3:
         primitive = Drawcall::Primitive::Triangles;
+        break;
     }
     return primitive;
 }
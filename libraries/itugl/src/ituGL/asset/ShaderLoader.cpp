@@ -1,13 +1,121 @@
 #include <ituGL/asset/ShaderLoader.h>
 
-#include <fstream>
-#include <sstream>
+#include <ituGL/asset/ShaderSourceCache.h>
+#include <algorithm>
 #include <vector>
 #include <array>
 #include <cassert>
+#include <cctype>
+#include <charconv>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <iostream>
 
+namespace
+{
+    // State shared by all the files of one shader
+    struct IncludeContext
+    {
+        IncludeContext(std::vector<std::string>& files) : files(files) {}
+
+        std::vector<std::string>& files;
+        std::unordered_map<std::string, int> fileIndices;
+        std::unordered_set<std::string> includedOnce;
+        std::vector<std::string> includeStack;
+        // #define lines, written after #version
+        std::string defines;
+        // After the first line of code, #version is not allowed anymore
+        bool codeWritten = false;
+    };
+
+    int GetFileIndex(const std::string& path, IncludeContext& context)
+    {
+        auto itIndex = context.fileIndices.find(path);
+        if (itIndex != context.fileIndices.end())
+        {
+            return itIndex->second;
+        }
+        int index = static_cast<int>(context.files.size());
+        context.files.push_back(path);
+        context.fileIndices.emplace(path, index);
+        return index;
+    }
+
+    bool ExpandFile(const std::string& path, std::string& output, IncludeContext& context)
+    {
+        std::shared_ptr<const ShaderSourceCache::SourceFile> file = ShaderSourceCache::GetDefault().GetFile(path);
+        if (!file)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_FOUND: " << path << std::endl;
+            return false;
+        }
+
+        if (std::find(context.includeStack.begin(), context.includeStack.end(), file->path) != context.includeStack.end())
+        {
+            std::cout << "ERROR::SHADER::RECURSIVE_INCLUDE: " << file->path << std::endl;
+            return false;
+        }
+
+        if (file->includeOnce && !context.includedOnce.insert(file->path).second)
+        {
+            return true;
+        }
+
+        int fileIndex = GetFileIndex(file->path, context);
+        context.includeStack.push_back(file->path);
+
+        for (const ShaderSourceCache::Segment& segment : file->segments)
+        {
+            switch (segment.type)
+            {
+            case ShaderSourceCache::Segment::Type::Text:
+                if (!context.codeWritten)
+                {
+                    // No #version, the defines go first
+                    output += context.defines;
+                }
+                // The #line directive sets the number of the next line, and the file as the source number
+                output += "#line ";
+                output += std::to_string(segment.line);
+                output += ' ';
+                output += std::to_string(fileIndex);
+                output += '\n';
+                output += file->GetText(segment);
+                if (output.back() != '\n')
+                {
+                    output += '\n';
+                }
+                context.codeWritten = true;
+                break;
+            case ShaderSourceCache::Segment::Type::Version:
+                // Only the first one is kept, included files may have their own to be compiled alone
+                if (!context.codeWritten)
+                {
+                    output += file->GetText(segment);
+                    if (output.back() != '\n')
+                    {
+                        output += '\n';
+                    }
+                    output += context.defines;
+                    context.codeWritten = true;
+                }
+                break;
+            case ShaderSourceCache::Segment::Type::Include:
+                if (segment.includePath.empty() || !ExpandFile(segment.includePath, output, context))
+                {
+                    std::cout << "ERROR::SHADER::INCLUDE_FAILED: " << file->path << ":" << segment.line << std::endl;
+                    return false;
+                }
+                break;
+            }
+        }
+
+        context.includeStack.pop_back();
+        return true;
+    }
+}
+
 ShaderLoader::ShaderLoader(Shader::Type type) : m_type(type)
 {
 }
@@ -24,35 +132,55 @@ bool ShaderLoader::IsValid(std::span<const char*> paths)
 
 Shader ShaderLoader::Load(const char* path)
 {
-    Shader shader(m_type);
-    std::ifstream file(path);
-    assert(file.is_open());
-    std::stringstream stringStream;
-    stringStream << file.rdbuf() << '\0';
-    shader.SetSource(stringStream.str().c_str());
-    Compile(shader);
-    return shader;
+    return Load(std::span<const char*>(&path, 1));
 }
 
 Shader ShaderLoader::Load(std::span<const char*> paths)
+{
+    std::vector<std::string> sources;
+    m_dependencies.clear();
+    bool loaded = LoadSources(paths, sources, &m_dependencies, m_defines);
+    assert(loaded);
+    return Load(sources, m_dependencies);
+}
+
+Shader ShaderLoader::Load(std::span<const std::string> sources, std::span<const std::string> files)
 {
     Shader shader(m_type);
-    std::vector<std::stringstream> stringStreams(paths.size());
-    std::vector<std::string> sourceCodeStrings(paths.size());
-    std::vector<const char*> sourceCode(paths.size());
-    for (int i = 0; i < paths.size(); ++i)
+    std::vector<const char*> sourceCode(sources.size());
+    for (size_t i = 0; i < sources.size(); ++i)
     {
-        std::ifstream file(paths[i]);
-        assert(file.is_open());
-        stringStreams[i] << file.rdbuf() << '\0';
-        sourceCodeStrings[i] = stringStreams[i].str();
-        sourceCode[i] = sourceCodeStrings[i].c_str();
+        sourceCode[i] = sources[i].c_str();
     }
     shader.SetSource(sourceCode);
-    Compile(shader);
+    Compile(shader, files);
     return shader;
 }
 
+bool ShaderLoader::LoadSources(std::span<const char*> paths, std::vector<std::string>& sources, std::vector<std::string>* files,
+    std::span<const std::string> defines)
+{
+    std::vector<std::string> localFiles;
+    IncludeContext context(files ? *files : localFiles);
+    for (const std::string& define : defines)
+    {
+        context.defines += "#define ";
+        context.defines += define;
+        context.defines += '\n';
+    }
+
+    sources.resize(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        sources[i].clear();
+        if (!ExpandFile(paths[i], sources[i], context))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 Shader* ShaderLoader::LoadNew(std::span<const char*> paths)
 {
     Shader* shader = nullptr;
@@ -73,7 +201,7 @@ bool ShaderLoader::LoadInto(Shader& shader, std::span<const char*> paths)
     return valid;
 }
 
-void ShaderLoader::Compile(Shader& shader)
+void ShaderLoader::Compile(Shader& shader, std::span<const std::string> files)
 {
     if (!shader.Compile())
     {
@@ -102,8 +230,55 @@ void ShaderLoader::Compile(Shader& shader)
             typeName = "FRAGMENT";
             break;
         }
-        std::cout << "ERROR::SHADER::" << typeName << "::COMPILATION_FAILED\n" << infoLog.data() << std::endl;
+        std::cout << "ERROR::SHADER::" << typeName << "::COMPILATION_FAILED\n" << RemapErrors(infoLog.data(), files) << std::endl;
+    }
+}
+
+std::string ShaderLoader::RemapErrors(std::string_view errors, std::span<const std::string> files)
+{
+    // Drivers start the lines with "0(12)" (NVIDIA), "0:12(3)" (Mesa) or "ERROR: 0:12" (AMD), where 0 is the source number
+    std::string remapped;
+    remapped.reserve(errors.size());
+    while (!errors.empty())
+    {
+        size_t lineEnd = errors.find('\n');
+        lineEnd = lineEnd == std::string_view::npos ? errors.size() : lineEnd + 1;
+        std::string_view line = errors.substr(0, lineEnd);
+        errors.remove_prefix(lineEnd);
+
+        size_t start = 0;
+        for (std::string_view prefix : { "ERROR: ", "WARNING: " })
+        {
+            if (line.starts_with(prefix))
+            {
+                start = prefix.size();
+            }
+        }
+        size_t end = start;
+        while (end < line.size() && std::isdigit(static_cast<unsigned char>(line[end])))
+        {
+            ++end;
+        }
+
+        // Numbers that don't fit are not source numbers, the line is kept as it is
+        size_t fileIndex = files.size();
+        if (end > start && std::from_chars(line.data() + start, line.data() + end, fileIndex).ec != std::errc())
+        {
+            fileIndex = files.size();
+        }
+        if (fileIndex < files.size() && end + 1 < line.size() && (line[end] == ':' || line[end] == '(')
+            && std::isdigit(static_cast<unsigned char>(line[end + 1])))
+        {
+            remapped += line.substr(0, start);
+            remapped += files[fileIndex];
+            remapped += line.substr(end);
+        }
+        else
+        {
+            remapped += line;
+        }
     }
+    return remapped;
 }
 
 Shader ShaderLoader::Load(Shader::Type type, const char* path)
@@ -0,0 +1,247 @@
+#include <ituGL/asset/ShaderProgramCache.h>
+
+#include <ituGL/asset/ShaderLoader.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/core/Hash.h>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    constexpr char BinaryMagic[4] = { 'I', 'P', 'R', 'G' };
+    constexpr std::uint32_t BinaryVersion = 1;
+
+    // Followed by the program binary
+    struct BinaryHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t key;
+        std::uint32_t binaryFormat;
+        std::uint32_t binarySize;
+    };
+
+    std::uint64_t HashString(const GLubyte* text, std::uint64_t hash)
+    {
+        const char* chars = reinterpret_cast<const char*>(text);
+        return Hash::FNV1a(chars ? std::string_view(chars) : std::string_view(), hash);
+    }
+}
+
+ShaderProgramCache::ShaderProgramCache(const char* directory)
+    : m_directory(directory)
+    , m_enabled(true)
+    , m_driverChecked(false)
+    , m_driverKey(0)
+    , m_hitCount(0)
+    , m_missCount(0)
+    , m_rejectedCount(0)
+{
+}
+
+bool ShaderProgramCache::Build(ShaderProgram& shaderProgram, std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths)
+{
+    std::array<Stage, 2> stages = { Stage{ Shader::VertexShader, vertexShaderPaths }, Stage{ Shader::FragmentShader, fragmentShaderPaths } };
+    return Build(shaderProgram, stages);
+}
+
+bool ShaderProgramCache::Build(ShaderProgram& shaderProgram, std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+    std::span<const char*> geometryShaderPaths)
+{
+    std::array<Stage, 3> stages = { Stage{ Shader::VertexShader, vertexShaderPaths }, Stage{ Shader::FragmentShader, fragmentShaderPaths },
+        Stage{ Shader::GeometryShader, geometryShaderPaths } };
+    return Build(shaderProgram, stages);
+}
+
+bool ShaderProgramCache::BuildWithDefines(ShaderProgram& shaderProgram, std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+    std::span<const std::string> defines)
+{
+    std::array<Stage, 2> stages = { Stage{ Shader::VertexShader, vertexShaderPaths }, Stage{ Shader::FragmentShader, fragmentShaderPaths } };
+    return Build(shaderProgram, stages, defines);
+}
+
+bool ShaderProgramCache::Build(ShaderProgram& shaderProgram, std::span<const Stage> stages, std::span<const std::string> defines)
+{
+    // Sources are read anyway, they come from ShaderSourceCache and are cheap compared to compiling
+    std::vector<std::vector<std::string>> sources(stages.size());
+    std::vector<std::vector<std::string>> files(stages.size());
+    m_dependencies.clear();
+    for (size_t i = 0; i < stages.size(); ++i)
+    {
+        // The defines are part of the sources, so each variant gets its own key
+        bool loaded = ShaderLoader::LoadSources(stages[i].paths, sources[i], &files[i], defines);
+
+        // Also when it fails, so the program can be built again once the missing file is fixed
+        for (const std::string& file : files[i])
+        {
+            if (std::find(m_dependencies.begin(), m_dependencies.end(), file) == m_dependencies.end())
+            {
+                m_dependencies.push_back(file);
+            }
+        }
+
+        if (!loaded)
+        {
+            std::cout << "ERROR::SHADER_PROGRAM_CACHE::SOURCE_NOT_FOUND" << std::endl;
+            return false;
+        }
+    }
+
+    bool useCache = m_enabled && GetDriverKey() != 0;
+
+    std::uint64_t key = m_driverKey;
+    if (useCache)
+    {
+        for (size_t i = 0; i < stages.size(); ++i)
+        {
+            std::uint32_t type = stages[i].type;
+            key = Hash::FNV1a(std::as_bytes(std::span(&type, 1)), key);
+            for (const std::string& source : sources[i])
+            {
+                // Include the terminator, so moving text between files changes the key
+                key = Hash::FNV1a(std::string_view(source.c_str(), source.size() + 1), key);
+            }
+        }
+
+        if (ReadBinary(shaderProgram, key))
+        {
+            ++m_hitCount;
+            return true;
+        }
+        shaderProgram.SetBinaryRetrievable(true);
+    }
+
+    ++m_missCount;
+    std::vector<Shader> shaders;
+    shaders.reserve(stages.size());
+    for (size_t i = 0; i < stages.size(); ++i)
+    {
+        shaders.push_back(ShaderLoader(stages[i].type).Load(sources[i], files[i]));
+    }
+
+    bool linked = false;
+    switch (shaders.size())
+    {
+    case 2:
+        linked = shaderProgram.Build(shaders[0], shaders[1]);
+        break;
+    case 3:
+        linked = shaderProgram.Build(shaders[0], shaders[1], shaders[2]);
+        break;
+    default:
+        assert(false);
+        break;
+    }
+
+    if (!linked)
+    {
+        std::array<char, 512> errors;
+        shaderProgram.GetLinkingErrors(errors);
+        std::cout << "ERROR::SHADER_PROGRAM::LINKING_FAILED\n" << errors.data() << std::endl;
+    }
+    else if (useCache && !WriteBinary(shaderProgram, key))
+    {
+        std::cout << "ERROR::SHADER_PROGRAM_CACHE::BINARY_NOT_WRITTEN: " << GetBinaryPath(key) << std::endl;
+    }
+    return linked;
+}
+
+std::uint64_t ShaderProgramCache::GetDriverKey()
+{
+    if (!m_driverChecked)
+    {
+        m_driverChecked = true;
+
+        GLint formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        if (formatCount > 0)
+        {
+            std::uint64_t key = Hash::Seed;
+            key = HashString(glGetString(GL_VENDOR), key);
+            key = HashString(glGetString(GL_RENDERER), key);
+            key = HashString(glGetString(GL_VERSION), key);
+            m_driverKey = key;
+        }
+    }
+    return m_driverKey;
+}
+
+std::string ShaderProgramCache::GetBinaryPath(std::uint64_t key) const
+{
+    std::ostringstream stream;
+    stream << m_directory << '/' << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+    return stream.str();
+}
+
+bool ShaderProgramCache::ReadBinary(ShaderProgram& shaderProgram, std::uint64_t key)
+{
+    std::ifstream stream(GetBinaryPath(key), std::ios::binary | std::ios::ate);
+    if (!stream)
+    {
+        return false;
+    }
+    std::streamoff fileSize = stream.tellg();
+    stream.seekg(0);
+
+    // A truncated or corrupted file is a miss, the binary size must match the rest of the file
+    BinaryHeader header;
+    stream.read(reinterpret_cast<char*>(&header), sizeof(BinaryHeader));
+    if (!stream || std::memcmp(header.magic, BinaryMagic, sizeof(BinaryMagic)) != 0
+        || header.version != BinaryVersion || header.key != key
+        || static_cast<std::streamoff>(header.binarySize) != fileSize - static_cast<std::streamoff>(sizeof(BinaryHeader)))
+    {
+        return false;
+    }
+
+    std::vector<std::byte> binary(header.binarySize);
+    stream.read(reinterpret_cast<char*>(binary.data()), binary.size());
+    if (!stream)
+    {
+        return false;
+    }
+
+    if (!shaderProgram.SetBinary(binary, header.binaryFormat))
+    {
+        // The program stays valid, it is built from the sources next
+        ++m_rejectedCount;
+        return false;
+    }
+    return true;
+}
+
+bool ShaderProgramCache::WriteBinary(const ShaderProgram& shaderProgram, std::uint64_t key) const
+{
+    std::vector<std::byte> binary;
+    GLenum binaryFormat;
+    if (!shaderProgram.GetBinary(binary, binaryFormat))
+    {
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+
+    BinaryHeader header{};
+    std::memcpy(header.magic, BinaryMagic, sizeof(BinaryMagic));
+    header.version = BinaryVersion;
+    header.key = key;
+    header.binaryFormat = binaryFormat;
+    header.binarySize = static_cast<std::uint32_t>(binary.size());
+
+    std::ofstream stream(GetBinaryPath(key), std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        return false;
+    }
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
+    stream.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+    return stream.good();
+}
@@ -0,0 +1,220 @@
+#include <ituGL/asset/ShaderSourceCache.h>
+
+#include <ituGL/asset/VirtualFileSystem.h>
+#include <filesystem>
+
+namespace
+{
+    // Returns the directive name if the line is a preprocessor directive ("include" for "  #  include <a>"), and moves rest after it
+    std::string_view GetDirective(std::string_view line, std::string_view& rest)
+    {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string_view::npos || line[start] != '#')
+        {
+            return std::string_view();
+        }
+        size_t nameStart = line.find_first_not_of(" \t", start + 1);
+        if (nameStart == std::string_view::npos)
+        {
+            return std::string_view();
+        }
+        size_t nameEnd = line.find_first_of(" \t\r", nameStart);
+        nameEnd = nameEnd == std::string_view::npos ? line.size() : nameEnd;
+        rest = line.substr(nameEnd);
+        return line.substr(nameStart, nameEnd - nameStart);
+    }
+
+    // Name between quotes or angle brackets
+    std::string_view GetIncludeName(std::string_view rest)
+    {
+        size_t start = rest.find_first_of("\"<");
+        if (start == std::string_view::npos)
+        {
+            return std::string_view();
+        }
+        size_t end = rest.find(rest[start] == '"' ? '"' : '>', start + 1);
+        if (end == std::string_view::npos)
+        {
+            return std::string_view();
+        }
+        return rest.substr(start + 1, end - start - 1);
+    }
+
+    // Returns if a /* */ comment is still open at the end of the line
+    bool IsBlockCommentOpen(std::string_view line, bool inBlockComment)
+    {
+        for (size_t i = 0; i + 1 < line.size(); ++i)
+        {
+            if (inBlockComment)
+            {
+                if (line[i] == '*' && line[i + 1] == '/')
+                {
+                    inBlockComment = false;
+                    ++i;
+                }
+            }
+            else if (line[i] == '/' && line[i + 1] == '/')
+            {
+                break;
+            }
+            else if (line[i] == '/' && line[i + 1] == '*')
+            {
+                inBlockComment = true;
+                ++i;
+            }
+        }
+        return inBlockComment;
+    }
+}
+
+ShaderSourceCache::ShaderSourceCache()
+{
+}
+
+ShaderSourceCache& ShaderSourceCache::GetDefault()
+{
+    static ShaderSourceCache sourceCache;
+    return sourceCache;
+}
+
+std::shared_ptr<const ShaderSourceCache::SourceFile> ShaderSourceCache::GetFile(std::string_view path)
+{
+    std::string normalizedPath = NormalizePath(path);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto itFile = m_files.find(normalizedPath);
+    if (itFile != m_files.end())
+    {
+        return itFile->second;
+    }
+
+    // Parsed with the lock held, so two threads don't read the same file
+    std::shared_ptr<const SourceFile> file = ParseFile(normalizedPath);
+    if (file)
+    {
+        m_files.emplace(normalizedPath, file);
+    }
+    return file;
+}
+
+void ShaderSourceCache::AddIncludeDirectory(std::string_view directory)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_includeDirectories.push_back(NormalizePath(directory));
+
+    // Includes are resolved when parsing, so the files must be parsed again
+    m_files.clear();
+}
+
+void ShaderSourceCache::Invalidate(std::string_view path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files.erase(NormalizePath(path));
+}
+
+void ShaderSourceCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files.clear();
+}
+
+std::string ShaderSourceCache::NormalizePath(std::string_view path)
+{
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+std::shared_ptr<ShaderSourceCache::SourceFile> ShaderSourceCache::ParseFile(const std::string& path) const
+{
+    VirtualFile sourceFile;
+    if (!VirtualFileSystem::GetDefault().Open(path, sourceFile))
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<SourceFile> file = std::make_shared<SourceFile>();
+    file->path = path;
+    file->text = sourceFile.GetText();
+
+    std::string_view text(file->text);
+
+    // Text segments grow line by line, and are closed by the directives handled here
+    Segment textSegment{ Segment::Type::Text, 0, 0, 1, std::string() };
+    auto closeTextSegment = [&](size_t nextOffset, int nextLine)
+        {
+            if (textSegment.size > 0)
+            {
+                file->segments.push_back(textSegment);
+            }
+            textSegment = Segment{ Segment::Type::Text, nextOffset, 0, nextLine, std::string() };
+        };
+
+    size_t offset = 0;
+    int line = 1;
+    bool inBlockComment = false;
+    while (offset < text.size())
+    {
+        size_t lineEnd = text.find('\n', offset);
+        lineEnd = lineEnd == std::string_view::npos ? text.size() : lineEnd + 1;
+        std::string_view lineText = text.substr(offset, lineEnd - offset);
+
+        // Directives are only recognized in lines that don't start inside a block comment
+        std::string_view rest;
+        std::string_view directive = inBlockComment ? std::string_view() : GetDirective(lineText, rest);
+        inBlockComment = IsBlockCommentOpen(lineText, inBlockComment);
+        if (directive == "include")
+        {
+            closeTextSegment(lineEnd, line + 1);
+            file->segments.push_back(Segment{ Segment::Type::Include, offset, lineText.size(), line, ResolveInclude(GetIncludeName(rest), path) });
+        }
+        else if (directive == "pragma" && rest.find("once") != std::string_view::npos)
+        {
+            closeTextSegment(lineEnd, line + 1);
+            file->includeOnce = true;
+        }
+        else if (directive == "version")
+        {
+            // Comments and empty lines before #version are dropped, as the #line directive can't go before it
+            textSegment.size = 0;
+            closeTextSegment(lineEnd, line + 1);
+            file->segments.push_back(Segment{ Segment::Type::Version, offset, lineText.size(), line, std::string() });
+        }
+        else
+        {
+            textSegment.size = lineEnd - textSegment.offset;
+        }
+
+        offset = lineEnd;
+        ++line;
+    }
+    closeTextSegment(offset, line);
+
+    return file;
+}
+
+std::string ShaderSourceCache::ResolveInclude(std::string_view name, const std::string& includingPath) const
+{
+    if (name.empty())
+    {
+        return std::string();
+    }
+
+    // Included files may be in a pack
+    const VirtualFileSystem& fileSystem = VirtualFileSystem::GetDefault();
+    std::filesystem::path localPath = std::filesystem::path(includingPath).parent_path() / name;
+    if (fileSystem.Exists(localPath.string()))
+    {
+        return NormalizePath(localPath.string());
+    }
+
+    for (const std::string& directory : m_includeDirectories)
+    {
+        std::filesystem::path directoryPath = std::filesystem::path(directory) / name;
+        if (fileSystem.Exists(directoryPath.string()))
+        {
+            return NormalizePath(directoryPath.string());
+        }
+    }
+
+    // Not found. Loading the shader reports the error
+    return NormalizePath(localPath.string());
+}
@@ -1,55 +1,349 @@
 #include <ituGL/asset/Texture2DLoader.h>
 
+#include <ituGL/asset/AsyncLoadQueue.h>
+#include <ituGL/asset/VirtualFileSystem.h>
+#include <array>
 #include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
 
 Texture2DLoader::Texture2DLoader()
     : m_flipVertical(false)
+    , m_cpuMipmap(false)
+    , m_preferCooked(true)
+    , m_mipmapFilter(MipChain::Filter::Box)
+    , m_placeholderColor(1.0f, 1.0f, 1.0f)
 {
 }
 
 Texture2DLoader::Texture2DLoader(TextureObject::Format format, TextureObject::InternalFormat internalFormat)
     : TextureLoader(format, internalFormat)
     , m_flipVertical(false)
+    , m_cpuMipmap(false)
+    , m_preferCooked(true)
+    , m_mipmapFilter(MipChain::Filter::Box)
+    , m_placeholderColor(1.0f, 1.0f, 1.0f)
 {
 }
 
 Texture2DObject Texture2DLoader::Load(const char* path)
 {
     Texture2DObject texture2D;
+    bool loaded = TryLoad(path, texture2D);
+    assert(loaded);
+    return texture2D;
+}
+
+bool Texture2DLoader::TryLoad(const char* path, Texture2DObject& texture2D)
+{
+    if (m_preferCooked)
+    {
+        DDSFile cookedFile;
+        if (LoadCooked(path, cookedFile, m_internalFormat, m_flipVertical))
+        {
+            UploadCooked(texture2D, cookedFile);
+            return true;
+        }
+    }
+
+    if (m_generateMipmap && m_cpuMipmap)
+    {
+        MipChain mipChain;
+        if (!LoadMipChain(path, mipChain, m_format, m_internalFormat, m_flipVertical, m_mipmapFilter))
+        {
+            return false;
+        }
+        UploadMipChain(texture2D, mipChain, m_format, m_internalFormat);
+        return true;
+    }
 
     // Load texture data using stbimage library
     int width, height;
     Data::Type dataType;
     std::span<const std::byte> data = LoadTexture2DData(path, width, height, dataType, m_flipVertical);
+    if (data.empty())
+    {
+        return false;
+    }
+
+    // Copy the data to the texture object
+    UploadImage(texture2D, width, height, m_format, m_internalFormat, data, dataType, m_generateMipmap);
+
+    // Free loaded data (not needed anymore)
+    FreeTexture2DData(data);
+    return true;
+}
 
-    // If data was loaded, copy it to the texture object
-    assert(!data.empty());
-    if (!data.empty())
+std::vector<Texture2DObject> Texture2DLoader::LoadBatch(std::span<const char* const> paths, JobSystem& jobSystem)
+{
+    // Decoded in the workers. Only one of cookedFile, data or mipChain is used, depending on where the mipmaps come from
+    struct DecodedImage
     {
-        texture2D.Bind();
-        texture2D.SetImage<std::byte>(0, width, height, m_format, m_internalFormat, data, dataType);
+        int width = 0;
+        int height = 0;
+        Data::Type dataType = Data::Type::None;
+        std::span<const std::byte> data;
+        MipChain mipChain;
+        DDSFile cookedFile;
+    };
+    std::vector<DecodedImage> images(paths.size());
 
-        texture2D.SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
-        texture2D.SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
+    bool cpuMipmap = m_generateMipmap && m_cpuMipmap;
+    jobSystem.ParallelFor(paths.size(), 1, [&](size_t begin, size_t end, size_t)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                DecodedImage& image = images[i];
+                if (m_preferCooked && LoadCooked(paths[i], image.cookedFile, m_internalFormat, m_flipVertical))
+                {
+                    continue;
+                }
+                if (cpuMipmap)
+                {
+                    LoadMipChain(paths[i], image.mipChain, m_format, m_internalFormat, m_flipVertical, m_mipmapFilter);
+                }
+                else
+                {
+                    image.data = TextureLoaderUtils::LoadTexture2DData(paths[i], image.width, image.height, image.dataType, m_format, m_internalFormat, m_flipVertical);
+                }
+            }
+        });
 
-        // Generate mipmap if needed
-        if (m_generateMipmap)
+    // GL calls only in this thread, in the same order as the paths
+    std::vector<Texture2DObject> textures;
+    textures.reserve(images.size());
+    for (DecodedImage& image : images)
+    {
+        Texture2DObject& texture2D = textures.emplace_back();
+        if (image.cookedFile.GetLevelCount() > 0)
         {
-            texture2D.GenerateMipmap();
-            texture2D.SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR_MIPMAP_LINEAR);
+            UploadCooked(texture2D, image.cookedFile);
+        }
+        else if (image.mipChain.GetLevelCount() > 0)
+        {
+            UploadMipChain(texture2D, image.mipChain, m_format, m_internalFormat);
+        }
+        else if (!image.data.empty())
+        {
+            UploadImage(texture2D, image.width, image.height, m_format, m_internalFormat, image.data, image.dataType, m_generateMipmap);
+            TextureLoaderUtils::FreeTexture2DData(image.data);
+        }
+        else
+        {
+            std::cout << "ERROR::TEXTURE::LOAD_FAILED: " << paths[textures.size() - 1] << std::endl;
+        }
+    }
+    return textures;
+}
+
+AssetHandle<Texture2DObject> Texture2DLoader::LoadAsync(const char* path, AsyncLoadQueue& loadQueue) const
+{
+    // Placeholder image, replaced in the same texture object when the data is uploaded
+    std::shared_ptr<Texture2DObject> texture2D = std::make_shared<Texture2DObject>();
+    std::array<GLubyte, 4> placeholder = {
+        static_cast<GLubyte>(m_placeholderColor.GetRed() * 255.0f + 0.5f),
+        static_cast<GLubyte>(m_placeholderColor.GetGreen() * 255.0f + 0.5f),
+        static_cast<GLubyte>(m_placeholderColor.GetBlue() * 255.0f + 0.5f),
+        static_cast<GLubyte>(m_placeholderColor.GetAlpha() * 255.0f + 0.5f) };
+    texture2D->Bind();
+    texture2D->SetImage<GLubyte>(0, 1, 1, TextureObject::FormatRGBA, m_internalFormat, placeholder);
+    texture2D->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
+    texture2D->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
+    texture2D->Unbind();
+
+    AssetHandle<Texture2DObject> handle(texture2D);
+
+    // Copy the settings, the loader can change before the load finishes
+    std::string pathString(path);
+    TextureObject::Format format = m_format;
+    TextureObject::InternalFormat internalFormat = m_internalFormat;
+    bool generateMipmap = m_generateMipmap;
+    bool flipVertical = m_flipVertical;
+    bool cpuMipmap = m_generateMipmap && m_cpuMipmap;
+    bool preferCooked = m_preferCooked;
+    MipChain::Filter mipmapFilter = m_mipmapFilter;
+
+    loadQueue.Schedule([=]() -> AsyncLoadQueue::UploadFunction
+        {
+            if (preferCooked)
+            {
+                std::shared_ptr<DDSFile> cookedFile = std::make_shared<DDSFile>();
+                if (LoadCooked(pathString.c_str(), *cookedFile, internalFormat, flipVertical))
+                {
+                    return [=]()
+                        {
+                            UploadCooked(*handle.Get(), *cookedFile);
+                            handle.SetState(AssetHandle<Texture2DObject>::State::Ready);
+                        };
+                }
+            }
 
-            // Adjust mip levels
-            texture2D.SetParameter(TextureObject::ParameterFloat::MinLod, 0.0f);
-            float maxLod = 1.0f + std::floorf(std::log2f(static_cast<float>(std::max(width, height))));
-            texture2D.SetParameter(TextureObject::ParameterFloat::MaxLod, maxLod);
+            if (cpuMipmap)
+            {
+                std::shared_ptr<MipChain> mipChain = std::make_shared<MipChain>();
+                if (!LoadMipChain(pathString.c_str(), *mipChain, format, internalFormat, flipVertical, mipmapFilter))
+                {
+                    return [handle]() { handle.SetState(AssetHandle<Texture2DObject>::State::Failed); };
+                }
+                return [=]()
+                    {
+                        UploadMipChain(*handle.Get(), *mipChain, format, internalFormat);
+                        handle.SetState(AssetHandle<Texture2DObject>::State::Ready);
+                    };
+            }
+
+            int width, height;
+            Data::Type dataType;
+            std::span<const std::byte> data = TextureLoaderUtils::LoadTexture2DData(pathString.c_str(), width, height, dataType, format, internalFormat, flipVertical);
+            if (data.empty())
+            {
+                return [handle]() { handle.SetState(AssetHandle<Texture2DObject>::State::Failed); };
+            }
+
+            // The data is freed with the upload, even if the queue is destroyed before running it
+            std::shared_ptr<const std::byte> dataOwner(data.data(), [](const std::byte* bytes) { TextureLoaderUtils::FreeTexture2DData(std::span<const std::byte>(bytes, 0)); });
+            return [=]()
+                {
+                    UploadImage(*handle.Get(), width, height, format, internalFormat, std::span<const std::byte>(dataOwner.get(), data.size()), dataType, generateMipmap);
+                    handle.SetState(AssetHandle<Texture2DObject>::State::Ready);
+                };
+        });
+
+    return handle;
+}
+
+AssetHandle<Texture2DObject> Texture2DLoader::LoadSharedAsync(const char* path, AsyncLoadQueue& loadQueue)
+{
+    std::string pathString(path);
+    auto itAsset = m_sharedAsyncAssets.find(pathString);
+    if (itAsset != m_sharedAsyncAssets.end())
+    {
+        return itAsset->second;
+    }
+
+    AssetHandle<Texture2DObject> handle = LoadAsync(path, loadQueue);
+    if (GetKeepShared())
+    {
+        m_sharedAsyncAssets.insert(std::make_pair(pathString, handle));
+    }
+    return handle;
+}
+
+void Texture2DLoader::UploadImage(Texture2DObject& texture2D, int width, int height, TextureObject::Format format, TextureObject::InternalFormat internalFormat,
+    std::span<const std::byte> data, Data::Type dataType, bool generateMipmap)
+{
+    texture2D.Bind();
+    texture2D.SetImage<std::byte>(0, width, height, format, internalFormat, data, dataType);
+
+    texture2D.SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
+    texture2D.SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
+
+    // Generate mipmap if needed
+    if (generateMipmap)
+    {
+        texture2D.GenerateMipmap();
+        texture2D.SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR_MIPMAP_LINEAR);
+
+        // Adjust mip levels
+        texture2D.SetParameter(TextureObject::ParameterFloat::MinLod, 0.0f);
+        float maxLod = 1.0f + std::floorf(std::log2f(static_cast<float>(std::max(width, height))));
+        texture2D.SetParameter(TextureObject::ParameterFloat::MaxLod, maxLod);
+    }
+
+    texture2D.Unbind();
+}
+
+void Texture2DLoader::UploadMipChain(Texture2DObject& texture2D, const MipChain& mipChain, TextureObject::Format format, TextureObject::InternalFormat internalFormat)
+{
+    texture2D.Bind();
+    mipChain.Upload(texture2D, format, internalFormat);
+
+    texture2D.SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR_MIPMAP_LINEAR);
+    texture2D.SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
+    texture2D.SetParameter(TextureObject::ParameterFloat::MinLod, 0.0f);
+    texture2D.SetParameter(TextureObject::ParameterFloat::MaxLod, static_cast<float>(mipChain.GetLevelCount() - 1));
+
+    texture2D.Unbind();
+}
+
+std::string Texture2DLoader::GetCookedPath(const char* path)
+{
+    return std::filesystem::path(path).replace_extension(".dds").string();
+}
+
+bool Texture2DLoader::LoadCooked(const char* path, DDSFile& cookedFile, TextureObject::InternalFormat internalFormat, bool flipVertical)
+{
+    std::filesystem::path sourcePath(path);
+    std::filesystem::path cookedPath(GetCookedPath(path));
+
+    if (sourcePath == cookedPath)
+    {
+        return false;
+    }
+
+    // Packs are built from cooked files, so they are up to date. Loose files are checked against the source
+    if (!VirtualFileSystem::GetDefault().IsPacked(cookedPath.string()))
+    {
+        // The source is optional, only the cooked file may be shipped
+        std::error_code error;
+        std::filesystem::file_time_type cookedTime = std::filesystem::last_write_time(cookedPath, error);
+        if (error)
+        {
+            return false;
         }
+        std::filesystem::file_time_type sourceTime = std::filesystem::last_write_time(sourcePath, error);
+        if (!error && sourceTime > cookedTime)
+        {
+            return false;
+        }
+    }
 
-        texture2D.Unbind();
+    if (!cookedFile.Read(cookedPath.string().c_str()))
+    {
+        std::cout << "ERROR::TEXTURE::INVALID_COOKED_FILE: " << cookedPath.string() << std::endl;
+        return false;
+    }
 
-        // Free loaded data (not needed anymore)
-        FreeTexture2DData(data);
+    // The file would be sampled with the wrong color space or upside down, load the source instead
+    if (MipChain::IsSRGB(cookedFile.GetInternalFormat()) != MipChain::IsSRGB(internalFormat) || cookedFile.GetFlipVertical() != flipVertical)
+    {
+        std::cout << "ERROR::TEXTURE::COOKED_SETTINGS_MISMATCH: " << cookedPath.string() << std::endl;
+        cookedFile.Clear();
+        return false;
     }
-    return texture2D;
+    return true;
+}
+
+void Texture2DLoader::UploadCooked(Texture2DObject& texture2D, const DDSFile& cookedFile)
+{
+    texture2D.Bind();
+    cookedFile.Upload(texture2D);
+
+    bool hasMipmap = cookedFile.GetLevelCount() > 1;
+    texture2D.SetParameter(TextureObject::ParameterEnum::MinFilter, hasMipmap ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    texture2D.SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
+    texture2D.SetParameter(TextureObject::ParameterFloat::MinLod, 0.0f);
+    texture2D.SetParameter(TextureObject::ParameterFloat::MaxLod, static_cast<float>(cookedFile.GetLevelCount() - 1));
+
+    texture2D.Unbind();
+}
+
+bool Texture2DLoader::LoadMipChain(const char* path, MipChain& mipChain, TextureObject::Format format, TextureObject::InternalFormat internalFormat,
+    bool flipVertical, MipChain::Filter filter)
+{
+    int width, height;
+    Data::Type dataType;
+    std::span<const std::byte> data = TextureLoaderUtils::LoadTexture2DData(path, width, height, dataType, format, internalFormat, flipVertical);
+    if (data.empty())
+    {
+        return false;
+    }
+
+    // The chain keeps a copy of the base level, so the decoded data can be freed right away
+    mipChain.Generate(data, width, height, TextureObject::GetComponentCount(format), dataType, MipChain::IsSRGB(internalFormat), filter);
+    TextureLoaderUtils::FreeTexture2DData(data);
+    return true;
 }
 
 std::shared_ptr<Texture2DObject> Texture2DLoader::LoadTextureShared(const char* path,
@@ -1,35 +1,64 @@
 #include <ituGL/asset/TextureLoader.h>
 
+#include <ituGL/asset/VirtualFileSystem.h>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <algorithm>
+#include <climits>
+
 std::span<const std::byte> TextureLoaderUtils::LoadTexture2DData(const char* path, int& width, int& height, Data::Type& dataType, TextureObject::Format format, TextureObject::InternalFormat internalFormat, bool flipVertical)
 {
     std::span<const std::byte> dataSpan;
 
+    // Decoded from memory, the file may be in a pack
+    VirtualFile file;
+    if (!VirtualFileSystem::GetDefault().Open(path, file) || file.GetSize() > INT_MAX)
+    {
+        return dataSpan;
+    }
+    const stbi_uc* fileData = reinterpret_cast<const stbi_uc*>(file.GetData().data());
+    int fileSize = static_cast<int>(file.GetSize());
+
     int componentCount = TextureObject::GetComponentCount(format);
     int originalComponentCount;
 
-    // Set flip vertical on load if needed
-    stbi_set_flip_vertically_on_load(flipVertical ? 1 : 0);
-
     if (IsHDR(internalFormat))
     {
-        float* data = stbi_loadf(path, &width, &height, &originalComponentCount, componentCount);
+        float* data = stbi_loadf_from_memory(fileData, fileSize, &width, &height, &originalComponentCount, componentCount);
         std::span<const float> dataSpanFloat(data, data ? width * height * componentCount : 0);
         dataSpan = Data::GetBytes(dataSpanFloat);
         dataType = Data::Type::Float;
     }
     else
     {
-        unsigned char* data = stbi_load(path, &width, &height, &originalComponentCount, componentCount);
+        unsigned char* data = stbi_load_from_memory(fileData, fileSize, &width, &height, &originalComponentCount, componentCount);
         std::span<const unsigned char> dataSpanByte(data, data ? width * height * componentCount : 0);
         dataSpan = Data::GetBytes(dataSpanByte);
         dataType = Data::Type::UByte;
     }
+
+    // Flip here instead of using the stb option, that is global and would affect loads in other threads
+    if (flipVertical && !dataSpan.empty())
+    {
+        FlipVertical(dataSpan, height);
+    }
+
     return dataSpan;
 }
 
+void TextureLoaderUtils::FlipVertical(std::span<const std::byte> data, int height)
+{
+    // The data was allocated by the loader, so it can be modified
+    std::byte* bytes = const_cast<std::byte*>(data.data());
+    size_t rowSize = data.size() / height;
+    for (int row = 0; row < height / 2; ++row)
+    {
+        std::swap_ranges(bytes + row * rowSize, bytes + (row + 1) * rowSize, bytes + (height - 1 - row) * rowSize);
+    }
+}
+
 void TextureLoaderUtils::FreeTexture2DData(std::span<const std::byte> data)
 {
     const void* dataPtr = data.data();
@@ -0,0 +1,172 @@
+#include <ituGL/asset/VirtualFileSystem.h>
+
+#include <ituGL/asset/ShaderSourceCache.h>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <utility>
+
+VirtualFile::VirtualFile() : m_open(false)
+{
+}
+
+VirtualFile::VirtualFile(VirtualFile&& virtualFile) noexcept : VirtualFile()
+{
+    *this = std::move(virtualFile);
+}
+
+VirtualFile& VirtualFile::operator = (VirtualFile&& virtualFile) noexcept
+{
+    if (this != &virtualFile)
+    {
+        // The span stays valid: moving the vector or the mapping keeps the same memory
+        m_open = std::exchange(virtualFile.m_open, false);
+        m_data = std::exchange(virtualFile.m_data, std::span<const std::byte>());
+        m_mappedFile = std::move(virtualFile.m_mappedFile);
+        m_buffer = std::move(virtualFile.m_buffer);
+        m_pack = std::move(virtualFile.m_pack);
+    }
+    return *this;
+}
+
+void VirtualFile::Close()
+{
+    m_open = false;
+    m_data = std::span<const std::byte>();
+    m_mappedFile.Close();
+    m_buffer.clear();
+    m_pack.reset();
+}
+
+VirtualFileSystem::VirtualFileSystem() : m_looseFilesEnabled(true)
+{
+}
+
+VirtualFileSystem& VirtualFileSystem::GetDefault()
+{
+    static VirtualFileSystem fileSystem;
+    return fileSystem;
+}
+
+bool VirtualFileSystem::Mount(const char* packPath, std::string_view mountPoint)
+{
+    std::shared_ptr<AssetPack> pack = std::make_shared<AssetPack>();
+    if (!pack->Open(packPath))
+    {
+        std::cout << "ERROR::VIRTUAL_FILE_SYSTEM::PACK_NOT_MOUNTED: " << packPath << std::endl;
+        return false;
+    }
+
+    std::string normalizedMountPoint = mountPoint.empty() ? std::string() : ShaderSourceCache::NormalizePath(mountPoint);
+    if (!normalizedMountPoint.empty() && normalizedMountPoint.back() != '/')
+    {
+        normalizedMountPoint += '/';
+    }
+
+    std::unique_lock lock(m_mutex);
+    m_packs.push_back(MountedPack{ pack, normalizedMountPoint });
+    return true;
+}
+
+void VirtualFileSystem::UnmountAll()
+{
+    // Files already open keep their pack alive
+    std::unique_lock lock(m_mutex);
+    m_packs.clear();
+}
+
+bool VirtualFileSystem::GetLooseFilesEnabled() const
+{
+    std::shared_lock lock(m_mutex);
+    return m_looseFilesEnabled;
+}
+
+void VirtualFileSystem::SetLooseFilesEnabled(bool looseFilesEnabled)
+{
+    std::unique_lock lock(m_mutex);
+    m_looseFilesEnabled = looseFilesEnabled;
+}
+
+bool VirtualFileSystem::Exists(std::string_view path) const
+{
+    std::shared_ptr<const AssetPack> pack;
+    if (FindPacked(ShaderSourceCache::NormalizePath(path), pack))
+    {
+        return true;
+    }
+
+    std::error_code error;
+    return GetLooseFilesEnabled() && std::filesystem::is_regular_file(path, error);
+}
+
+bool VirtualFileSystem::IsPacked(std::string_view path) const
+{
+    std::shared_ptr<const AssetPack> pack;
+    return FindPacked(ShaderSourceCache::NormalizePath(path), pack) != nullptr;
+}
+
+bool VirtualFileSystem::Open(std::string_view path, VirtualFile& file) const
+{
+    file.Close();
+
+    std::shared_ptr<const AssetPack> pack;
+    if (const AssetPack::Entry* entry = FindPacked(ShaderSourceCache::NormalizePath(path), pack))
+    {
+        if (entry->compression == AssetPack::Compression::None)
+        {
+            // No copy, the data is read from the mapped pack
+            file.m_data = pack->GetStoredData(*entry);
+            file.m_pack = pack;
+        }
+        else if (pack->Read(*entry, file.m_buffer))
+        {
+            file.m_data = file.m_buffer;
+        }
+        else
+        {
+            return false;
+        }
+        file.m_open = true;
+        return true;
+    }
+
+    if (!GetLooseFilesEnabled())
+    {
+        return false;
+    }
+
+    std::string pathString(path);
+    if (file.m_mappedFile.Open(pathString.c_str()))
+    {
+        file.m_data = file.m_mappedFile.GetData();
+        file.m_open = true;
+    }
+    else
+    {
+        // Empty files can't be mapped, but they exist
+        std::error_code error;
+        file.m_open = std::filesystem::is_regular_file(pathString, error) && std::filesystem::file_size(pathString, error) == 0 && !error;
+    }
+    return file.m_open;
+}
+
+const AssetPack::Entry* VirtualFileSystem::FindPacked(const std::string& normalizedPath, std::shared_ptr<const AssetPack>& pack) const
+{
+    std::shared_lock lock(m_mutex);
+    for (auto itPack = m_packs.rbegin(); itPack != m_packs.rend(); ++itPack)
+    {
+        const std::string& mountPoint = itPack->mountPoint;
+        if (normalizedPath.compare(0, mountPoint.size(), mountPoint) != 0)
+        {
+            continue;
+        }
+
+        std::string_view packPath = std::string_view(normalizedPath).substr(mountPoint.size());
+        if (const AssetPack::Entry* entry = itPack->pack->Find(packPath))
+        {
+            pack = itPack->pack;
+            return entry;
+        }
+    }
+    return nullptr;
+}
@@ -92,13 +92,27 @@ std::vector<glm::vec4> Camera::GetFrustumCornersWorldSpace() const
 
 std::vector<glm::vec3> Camera::GetFrustumCornersWorldSpace3D() const
 {
-    std::vector<glm::vec3> retval;
-    std::vector<glm::vec4> corners4D = GetFrustumCornersWorldSpace();
-    for (auto& corner : corners4D) {
-        retval.push_back(glm::vec3(corner));
+    return GetFrustumCornersWorldSpace3D(m_projMatrix * m_viewMatrix);
+}
+
+std::vector<glm::vec3> Camera::GetFrustumCornersWorldSpace3D(const glm::mat4& viewProjMatrix)
+{
+    const glm::mat4 inv = glm::inverse(viewProjMatrix);
+
+    std::vector<glm::vec3> frustumCorners;
+    for (unsigned int x = 0; x < 2; ++x)
+    {
+        for (unsigned int y = 0; y < 2; ++y)
+        {
+            for (unsigned int z = 0; z < 2; ++z)
+            {
+                const glm::vec4 pt = inv * glm::vec4(2.0f * x - 1.0f, 2.0f * y - 1.0f, 2.0f * z - 1.0f, 1.0f);
+                frustumCorners.push_back(glm::vec3(pt) / pt.w);
+            }
+        }
     }
 
-    return retval;
+    return frustumCorners;
 }
 
 
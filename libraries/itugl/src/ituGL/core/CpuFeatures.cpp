@@ -0,0 +1,54 @@
+#include <ituGL/core/CpuFeatures.h>
+
+#include <atomic>
+
+#if defined(_MSC_VER) && defined(ITUGL_SIMD_SSE2)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    bool CheckAvx2()
+    {
+#if defined(_MSC_VER) && defined(ITUGL_SIMD_SSE2)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        __cpuidex(info, 7, 0);
+        bool avx2 = (info[1] & (1 << 5)) != 0;
+        // The OS must save the AVX registers too
+        return avx2 && osxsave && (_xgetbv(0) & 6) == 6;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        // Also checks that the OS saves the AVX registers. Init is needed if called before the constructors of libgcc
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+
+    // Read by the kernels in any thread
+    std::atomic<bool> s_avx2Enabled = CpuFeatures::IsAvx2Supported();
+}
+
+bool CpuFeatures::IsAvx2Supported()
+{
+    static const bool s_avx2Supported = CheckAvx2();
+    return s_avx2Supported;
+}
+
+bool CpuFeatures::IsAvx2Enabled()
+{
+    return s_avx2Enabled.load(std::memory_order_relaxed);
+}
+
+void CpuFeatures::SetAvx2Enabled(bool enabled)
+{
+    s_avx2Enabled.store(enabled && IsAvx2Supported(), std::memory_order_relaxed);
+}
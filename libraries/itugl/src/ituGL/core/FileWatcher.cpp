@@ -0,0 +1,194 @@
+#include <ituGL/core/FileWatcher.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher()
+    : m_pollInterval(500)
+    , m_lastPollTime(std::chrono::steady_clock::now())
+    , m_notifyDescriptor(-1)
+{
+#ifdef __linux__
+    m_notifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+    if (m_notifyDescriptor >= 0)
+    {
+        // Closing the descriptor removes all the watches
+        close(m_notifyDescriptor);
+    }
+#endif
+}
+
+void FileWatcher::AddFile(std::string_view path)
+{
+    std::string normalizedPath = NormalizePath(path);
+    if (m_files.contains(normalizedPath))
+    {
+        return;
+    }
+    m_files.emplace(normalizedPath, GetModificationTime(normalizedPath));
+
+#ifdef __linux__
+    if (m_notifyDescriptor >= 0)
+    {
+        std::string directory = std::filesystem::path(normalizedPath).parent_path().generic_string();
+        if (directory.empty())
+        {
+            directory = ".";
+        }
+        auto itWatch = m_directoryWatches.find(directory);
+        if (itWatch == m_directoryWatches.end())
+        {
+            int watchDescriptor = inotify_add_watch(m_notifyDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (watchDescriptor >= 0)
+            {
+                m_watchDirectories.emplace(watchDescriptor, directory);
+            }
+            else
+            {
+                // Missing directory, or out of watches (fs.inotify.max_user_watches)
+                int error = errno;
+                std::cout << "ERROR::FILE_WATCHER::WATCH_FAILED: " << directory << ": " << std::strerror(error) << std::endl;
+            }
+            itWatch = m_directoryWatches.emplace(directory, watchDescriptor).first;
+        }
+
+        // Not retried, so files in a directory created later are also checked by modification time
+        if (itWatch->second < 0)
+        {
+            m_polledFiles.insert(normalizedPath);
+        }
+    }
+#endif
+}
+
+void FileWatcher::RemoveFile(std::string_view path)
+{
+    // The directory stays watched, events for files not in the list are ignored
+    std::string normalizedPath = NormalizePath(path);
+    m_files.erase(normalizedPath);
+    m_polledFiles.erase(normalizedPath);
+}
+
+bool FileWatcher::IsWatching(std::string_view path) const
+{
+    return m_files.contains(NormalizePath(path));
+}
+
+bool FileWatcher::IsUsingNotifications() const
+{
+    return m_notifyDescriptor >= 0;
+}
+
+bool FileWatcher::IsPolling(std::string_view path) const
+{
+    std::string normalizedPath = NormalizePath(path);
+    return m_files.contains(normalizedPath) && (!IsUsingNotifications() || m_polledFiles.contains(normalizedPath));
+}
+
+void FileWatcher::Poll(std::vector<std::string>& changedPaths)
+{
+    size_t firstChanged = changedPaths.size();
+
+    if (IsUsingNotifications())
+    {
+        PollNotifications(changedPaths);
+    }
+
+    if (!IsUsingNotifications() || !m_polledFiles.empty())
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now - m_lastPollTime >= m_pollInterval)
+        {
+            m_lastPollTime = now;
+            PollModificationTimes(changedPaths);
+        }
+    }
+
+    // Saving a file can generate several events
+    std::sort(changedPaths.begin() + firstChanged, changedPaths.end());
+    changedPaths.erase(std::unique(changedPaths.begin() + firstChanged, changedPaths.end()), changedPaths.end());
+}
+
+void FileWatcher::PollNotifications(std::vector<std::string>& changedPaths)
+{
+#ifdef __linux__
+    // Aligned like inotify_event, events are read whole
+    alignas(inotify_event) char buffer[4096];
+    while (true)
+    {
+        ssize_t size = read(m_notifyDescriptor, buffer, sizeof(buffer));
+        if (size <= 0)
+        {
+            // EAGAIN: no more events
+            break;
+        }
+
+        for (char* event = buffer; event < buffer + size; )
+        {
+            const inotify_event& notifyEvent = *reinterpret_cast<const inotify_event*>(event);
+            event += sizeof(inotify_event) + notifyEvent.len;
+
+            auto itDirectory = m_watchDirectories.find(notifyEvent.wd);
+            if (itDirectory == m_watchDirectories.end() || notifyEvent.len == 0)
+            {
+                continue;
+            }
+
+            std::string path = NormalizePath(itDirectory->second + "/" + notifyEvent.name);
+            auto itFile = m_files.find(path);
+            if (itFile != m_files.end())
+            {
+                itFile->second = GetModificationTime(path);
+                changedPaths.push_back(path);
+            }
+        }
+    }
+#endif
+}
+
+void FileWatcher::PollModificationTimes(std::vector<std::string>& changedPaths)
+{
+    for (auto& file : m_files)
+    {
+        if (IsUsingNotifications() && !m_polledFiles.contains(file.first))
+        {
+            continue;
+        }
+
+        std::filesystem::file_time_type modificationTime = GetModificationTime(file.first);
+        if (modificationTime != file.second)
+        {
+            file.second = modificationTime;
+            // Deleted files are not reported, only when they are written again
+            if (modificationTime != std::filesystem::file_time_type::min())
+            {
+                changedPaths.push_back(file.first);
+            }
+        }
+    }
+}
+
+std::string FileWatcher::NormalizePath(std::string_view path)
+{
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+std::filesystem::file_time_type FileWatcher::GetModificationTime(const std::string& path)
+{
+    std::error_code error;
+    std::filesystem::file_time_type modificationTime = std::filesystem::last_write_time(path, error);
+    return error ? std::filesystem::file_time_type::min() : modificationTime;
+}
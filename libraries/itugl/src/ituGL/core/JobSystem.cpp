@@ -0,0 +1,206 @@
+#include <ituGL/core/JobSystem.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+    // Job system and queue owned by the current thread, if it is a worker
+    thread_local const JobSystem* t_workerJobSystem = nullptr;
+    thread_local unsigned int t_workerQueueIndex = 0;
+}
+
+JobSystem::JobSystem(unsigned int workerCount) : m_queuedJobCount(0), m_nextQueueIndex(0), m_stopping(false)
+{
+    for (unsigned int i = 0; i <= workerCount; ++i)
+    {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+
+    // Queues must exist before starting the workers, as they can steal from any of them
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        m_threads.emplace_back(&JobSystem::WorkerMain, this, i + 1);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_sleepCondition.notify_all();
+
+    // Workers only stop when the queues are empty
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+
+    // Without workers, the jobs that were never waited for are run here
+    while (TryRunJob(0))
+    {
+    }
+    assert(m_queuedJobCount.load(std::memory_order_acquire) == 0);
+}
+
+JobSystem& JobSystem::GetDefault()
+{
+    static JobSystem s_defaultJobSystem(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    return s_defaultJobSystem;
+}
+
+void JobSystem::Schedule(Job job, Counter* counter)
+{
+    assert(job);
+
+    if (counter)
+    {
+        counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Workers keep their jobs in their own queue. Other threads spread them among the workers
+    unsigned int queueIndex = GetCurrentQueueIndex();
+    if (queueIndex == 0 && !m_threads.empty())
+    {
+        queueIndex = 1 + m_nextQueueIndex.fetch_add(1, std::memory_order_relaxed) % GetWorkerCount();
+    }
+
+    Queue& queue = *m_queues[queueIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(JobEntry{ std::move(job), counter });
+        m_queuedJobCount.fetch_add(1, std::memory_order_release);
+    }
+
+    // Lock before notifying, so a worker can't miss the notification between checking the count and sleeping
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_sleepCondition.notify_one();
+}
+
+void JobSystem::Wait(Counter& counter)
+{
+    unsigned int queueIndex = GetCurrentQueueIndex();
+    while (!counter.IsDone())
+    {
+        if (TryRunJob(queueIndex))
+        {
+            continue;
+        }
+
+        // The remaining jobs of the counter are running in other threads. Sleep until they finish, or there is another job to run
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepCondition.wait(lock, [this, &counter]() { return counter.IsDone() || m_queuedJobCount.load(std::memory_order_acquire) > 0; });
+    }
+}
+
+void JobSystem::ParallelFor(size_t count, size_t chunkSize, const ParallelForFunction& function)
+{
+    assert(chunkSize > 0);
+    if (count == 0)
+    {
+        return;
+    }
+
+    size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    Counter counter;
+    for (size_t chunkIndex = 1; chunkIndex < chunkCount; ++chunkIndex)
+    {
+        size_t begin = chunkIndex * chunkSize;
+        size_t end = std::min(begin + chunkSize, count);
+        Schedule([&function, begin, end, chunkIndex]() { function(begin, end, chunkIndex); }, &counter);
+    }
+
+    // The calling thread takes the first chunk, then helps with the rest
+    function(0, std::min(chunkSize, count), 0);
+    Wait(counter);
+}
+
+unsigned int JobSystem::GetCurrentQueueIndex() const
+{
+    return t_workerJobSystem == this ? t_workerQueueIndex : 0;
+}
+
+bool JobSystem::TryPop(unsigned int queueIndex, JobEntry& entry)
+{
+    Queue& queue = *m_queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty())
+    {
+        return false;
+    }
+
+    // Newest job first, its data is more likely to be in cache
+    entry = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    m_queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::TrySteal(unsigned int queueIndex, JobEntry& entry)
+{
+    unsigned int queueCount = static_cast<unsigned int>(m_queues.size());
+    for (unsigned int offset = 1; offset < queueCount; ++offset)
+    {
+        Queue& queue = *m_queues[(queueIndex + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            // Steal the oldest job, the owner is working on the other end
+            entry = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            m_queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobSystem::TryRunJob(unsigned int queueIndex)
+{
+    JobEntry entry;
+    if (!TryPop(queueIndex, entry) && !TrySteal(queueIndex, entry))
+    {
+        return false;
+    }
+
+    entry.job();
+
+    // The counter can be destroyed as soon as it is done, so it is not accessed after this
+    if (entry.counter && entry.counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        // Lock before notifying, so a waiting thread can't miss it between checking the counter and sleeping
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_sleepCondition.notify_all();
+    }
+    return true;
+}
+
+void JobSystem::WorkerMain(unsigned int queueIndex)
+{
+    t_workerJobSystem = this;
+    t_workerQueueIndex = queueIndex;
+
+    while (true)
+    {
+        if (TryRunJob(queueIndex))
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepCondition.wait(lock, [this]() { return m_stopping || m_queuedJobCount.load(std::memory_order_acquire) > 0; });
+
+        // Jobs scheduled before stopping are still run
+        if (m_stopping && m_queuedJobCount.load(std::memory_order_acquire) == 0)
+        {
+            break;
+        }
+    }
+}
@@ -0,0 +1,208 @@
+#include <ituGL/core/LZ4.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    // Limits of the block format
+    constexpr size_t MinMatch = 4;
+    constexpr size_t LastLiterals = 5;
+    constexpr size_t MatchFindLimit = 12;
+    constexpr size_t MaxOffset = 65535;
+
+    constexpr unsigned int HashBits = 16;
+
+    inline std::uint32_t Read32(const std::byte* data)
+    {
+        std::uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline std::uint32_t HashSequence(std::uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - HashBits);
+    }
+
+    // Lengths that don't fit in the token nibble continue in bytes of 255
+    inline std::byte* WriteLength(std::byte* output, size_t length)
+    {
+        for (; length >= 255; length -= 255)
+        {
+            *output++ = std::byte(255);
+        }
+        *output++ = std::byte(length);
+        return output;
+    }
+
+    std::byte* WriteSequence(std::byte* output, const std::byte* literals, size_t literalLength, size_t offset, size_t matchLength)
+    {
+        std::byte* token = output++;
+        std::uint8_t tokenValue = static_cast<std::uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+        if (literalLength >= 15)
+        {
+            output = WriteLength(output, literalLength - 15);
+        }
+        // Empty data may have null pointers, that memcpy doesn't accept even without bytes to copy
+        if (literalLength > 0)
+        {
+            std::memcpy(output, literals, literalLength);
+            output += literalLength;
+        }
+
+        // The last sequence has only literals
+        if (matchLength > 0)
+        {
+            *output++ = std::byte(offset & 0xFF);
+            *output++ = std::byte(offset >> 8);
+
+            size_t length = matchLength - MinMatch;
+            tokenValue |= static_cast<std::uint8_t>(std::min<size_t>(length, 15));
+            if (length >= 15)
+            {
+                output = WriteLength(output, length - 15);
+            }
+        }
+        *token = std::byte(tokenValue);
+        return output;
+    }
+
+    inline bool ReadLength(const std::byte*& input, const std::byte* inputEnd, size_t& length)
+    {
+        std::uint8_t value;
+        do
+        {
+            if (input >= inputEnd)
+            {
+                return false;
+            }
+            value = static_cast<std::uint8_t>(*input++);
+            length += value;
+        } while (value == 255);
+        return true;
+    }
+}
+
+size_t LZ4::GetMaxCompressedSize(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+size_t LZ4::Compress(std::span<const std::byte> data, std::span<std::byte> compressedData)
+{
+    assert(compressedData.size() >= GetMaxCompressedSize(data.size()));
+
+    const std::byte* input = data.data();
+    const size_t size = data.size();
+    std::byte* output = compressedData.data();
+
+    size_t position = 0;
+    size_t anchor = 0;
+    if (size > MatchFindLimit)
+    {
+        // Last position where a match can start, and where it has to end
+        const size_t matchFindEnd = size - MatchFindLimit;
+        const size_t matchEnd = size - LastLiterals;
+
+        // Last position of each hashed sequence. Stale entries are fine, the bytes are compared
+        std::vector<std::uint32_t> hashTable(size_t(1) << HashBits, 0);
+
+        // Skip faster over data that doesn't compress
+        unsigned int missCount = 0;
+        while (position < matchFindEnd)
+        {
+            std::uint32_t sequence = Read32(input + position);
+            std::uint32_t& entry = hashTable[HashSequence(sequence)];
+            size_t reference = entry;
+            entry = static_cast<std::uint32_t>(position);
+
+            if (reference >= position || position - reference > MaxOffset || Read32(input + reference) != sequence)
+            {
+                position += 1 + (missCount++ >> 6);
+                continue;
+            }
+            missCount = 0;
+
+            size_t matchLength = MinMatch;
+            while (position + matchLength < matchEnd && input[reference + matchLength] == input[position + matchLength])
+            {
+                ++matchLength;
+            }
+
+            output = WriteSequence(output, input + anchor, position - anchor, position - reference, matchLength);
+            position += matchLength;
+            anchor = position;
+        }
+    }
+
+    output = WriteSequence(output, input + anchor, size - anchor, 0, 0);
+    return static_cast<size_t>(output - compressedData.data());
+}
+
+bool LZ4::Decompress(std::span<const std::byte> compressedData, std::span<std::byte> data)
+{
+    const std::byte* input = compressedData.data();
+    const std::byte* inputEnd = input + compressedData.size();
+    std::byte* output = data.data();
+    std::byte* outputEnd = output + data.size();
+
+    while (input < inputEnd)
+    {
+        std::uint8_t token = static_cast<std::uint8_t>(*input++);
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !ReadLength(input, inputEnd, literalLength))
+        {
+            return false;
+        }
+        if (literalLength > static_cast<size_t>(inputEnd - input) || literalLength > static_cast<size_t>(outputEnd - output))
+        {
+            return false;
+        }
+        if (literalLength > 0)
+        {
+            std::memcpy(output, input, literalLength);
+            input += literalLength;
+            output += literalLength;
+        }
+
+        // The last sequence ends after the literals
+        if (input == inputEnd)
+        {
+            break;
+        }
+
+        if (inputEnd - input < 2)
+        {
+            return false;
+        }
+        size_t offset = static_cast<size_t>(input[0]) | (static_cast<size_t>(input[1]) << 8);
+        input += 2;
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !ReadLength(input, inputEnd, matchLength))
+        {
+            return false;
+        }
+        matchLength += MinMatch;
+
+        if (offset == 0 || offset > static_cast<size_t>(output - data.data()) || matchLength > static_cast<size_t>(outputEnd - output))
+        {
+            return false;
+        }
+
+        // Byte by byte, the match can overlap the bytes it is writing
+        const std::byte* match = output - offset;
+        for (size_t i = 0; i < matchLength; ++i)
+        {
+            output[i] = match[i];
+        }
+        output += matchLength;
+    }
+
+    return output == outputEnd;
+}
@@ -0,0 +1,152 @@
+#include <ituGL/core/MappedFile.h>
+
+#include <atomic>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Result of the prefetch reads. Atomic, as several threads can prefetch at the same time
+    std::atomic<std::byte> s_prefetchSink;
+}
+
+MappedFile::MappedFile() : m_data(nullptr), m_size(0)
+#ifdef _WIN32
+    , m_fileHandle(nullptr), m_mappingHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& mappedFile) noexcept : MappedFile()
+{
+    *this = std::move(mappedFile);
+}
+
+MappedFile& MappedFile::operator = (MappedFile&& mappedFile) noexcept
+{
+    if (this != &mappedFile)
+    {
+        Close();
+        std::swap(m_data, mappedFile.m_data);
+        std::swap(m_size, mappedFile.m_size);
+#ifdef _WIN32
+        std::swap(m_fileHandle, mappedFile.m_fileHandle);
+        std::swap(m_mappingHandle, mappedFile.m_mappingHandle);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const char* path)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (!data)
+    {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    m_fileHandle = fileHandle;
+    m_mappingHandle = mappingHandle;
+    m_data = static_cast<const std::byte*>(data);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fileDescriptor = open(path, O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        close(fileDescriptor);
+        return false;
+    }
+
+    void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    // The mapping keeps its own reference to the file
+    close(fileDescriptor);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_data = static_cast<const std::byte*>(data);
+    m_size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (!m_data)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mappingHandle);
+    CloseHandle(m_fileHandle);
+    m_fileHandle = nullptr;
+    m_mappingHandle = nullptr;
+#else
+    munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+void MappedFile::Prefetch() const
+{
+    // Combine one byte of each page, and store the result so the reads are not optimized away
+    constexpr size_t pageSize = 4096;
+    std::byte value{};
+    for (size_t offset = 0; offset < m_size; offset += pageSize)
+    {
+        value ^= m_data[offset];
+    }
+    s_prefetchSink.store(value, std::memory_order_relaxed);
+}
@@ -5,7 +5,7 @@
 #include <cassert>
 
 Drawcall::Drawcall()
-    : m_primitive(Primitive::Invalid), m_first(0), m_count(0), m_eboType(Data::Type::None)
+    : m_primitive(Primitive::Invalid), m_first(0), m_count(0), m_eboType(Data::Type::None), m_baseVertex(0), m_instanceCount(1), m_baseInstance(0)
 {
 }
 
@@ -15,30 +15,64 @@ Drawcall::Drawcall(Primitive primitive, GLsizei count, GLint first)
 }
 
 Drawcall::Drawcall(Primitive primitive, GLsizei count, Data::Type eboType, GLint first)
-    : m_primitive(primitive), m_first(first), m_count(count), m_eboType(eboType)
+    : Drawcall(primitive, count, eboType, first, 0)
+{
+}
+
+Drawcall::Drawcall(Primitive primitive, GLsizei count, Data::Type eboType, GLint first, GLint baseVertex)
+    : m_primitive(primitive), m_first(first), m_count(count), m_eboType(eboType), m_baseVertex(baseVertex), m_instanceCount(1), m_baseInstance(0)
 {
     assert(primitive != Primitive::Invalid);
     assert(first >= 0);
     assert(count > 0);
+    assert(baseVertex == 0 || eboType != Data::Type::None);
 }
 
 // Execute the drawcall
 void Drawcall::Draw() const
 {
     assert(IsValid());
+    assert(m_instanceCount > 0);
     assert(VertexArrayObject::IsAnyBound());
 
     GLenum primitive = static_cast<GLenum>(m_primitive);
     if (m_eboType == Data::Type::None)
     {
         // If no EBO is present, use glDrawArrays
-        glDrawArrays(primitive, m_first, m_count);
+        if (m_baseInstance != 0)
+        {
+            glDrawArraysInstancedBaseInstance(primitive, m_first, m_count, m_instanceCount, m_baseInstance);
+        }
+        else if (m_instanceCount != 1)
+        {
+            glDrawArraysInstanced(primitive, m_first, m_count, m_instanceCount);
+        }
+        else
+        {
+            glDrawArrays(primitive, m_first, m_count);
+        }
     }
     else
     {
         // If there is an EBO, use glDrawElements
         assert(ElementBufferObject::IsSupportedType(m_eboType));
         const char* basePointer = nullptr; // Actual element pointer is in VAO
-        glDrawElements(primitive, m_count, static_cast<GLenum>(m_eboType), basePointer + m_first);
+        if (m_baseInstance != 0)
+        {
+            glDrawElementsInstancedBaseVertexBaseInstance(primitive, m_count, static_cast<GLenum>(m_eboType), basePointer + m_first,
+                m_instanceCount, m_baseVertex, m_baseInstance);
+        }
+        else if (m_instanceCount != 1)
+        {
+            glDrawElementsInstancedBaseVertex(primitive, m_count, static_cast<GLenum>(m_eboType), basePointer + m_first, m_instanceCount, m_baseVertex);
+        }
+        else if (m_baseVertex != 0)
+        {
+            glDrawElementsBaseVertex(primitive, m_count, static_cast<GLenum>(m_eboType), basePointer + m_first, m_baseVertex);
+        }
+        else
+        {
+            glDrawElements(primitive, m_count, static_cast<GLenum>(m_eboType), basePointer + m_first);
+        }
     }
 }
@@ -0,0 +1,356 @@
+#include <ituGL/geometry/FoliageScatter.h>
+
+#include <ituGL/geometry/TerrainHeightfield.h>
+#include <ituGL/core/JobSystem.h>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+    // Random seeds tried when there are no active points, before the chunk is considered full
+    constexpr unsigned int SeedCount = 30;
+
+    // Candidates tried around each active point. Bridson uses 30, 12 is twice as fast and only ~6% less dense
+    constexpr unsigned int CandidateCount = 12;
+
+    // Cosine and sine of the angle between consecutive candidates, the golden angle so they don't repeat directions
+    const glm::vec2 CandidateRotation(std::cos(2.39996323f), std::sin(2.39996323f));
+
+    // SplitMix64. Small and fast, and the same sequence on all platforms
+    class Random
+    {
+    public:
+        explicit Random(std::uint64_t seed) : m_state(seed) {}
+
+        std::uint64_t Next()
+        {
+            std::uint64_t z = (m_state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        // Uniform in [0, 1)
+        float Next01() { return static_cast<float>(Next() >> 40) * (1.0f / 16777216.0f); }
+
+        float NextRange(float min, float max) { return min + (max - min) * Next01(); }
+
+    private:
+        std::uint64_t m_state;
+    };
+
+    // Each chunk has its own sequences, so the result doesn't depend on the order the chunks run
+    // The stream separates the sequence of the points from the one of the masks
+    Random GetChunkRandom(unsigned int seed, size_t chunkIndex, unsigned int stream)
+    {
+        return Random(((static_cast<std::uint64_t>(seed) << 32) | chunkIndex) * 2 + stream);
+    }
+
+    // 1 below edge - fade, 0 above edge, and linear between them
+    float FadeOut(float value, float edge, float fade)
+    {
+        if (fade <= 0.0f)
+        {
+            return value <= edge ? 1.0f : 0.0f;
+        }
+        return glm::clamp((edge - value) / fade, 0.0f, 1.0f);
+    }
+
+    // Background grid of Bridson's algorithm. Cells are small enough to hold a single point
+    // Covers a chunk and a margin of the min distance around it, for the points of the neighbours
+    class PoissonGrid
+    {
+    public:
+        PoissonGrid(const glm::vec2& min, const glm::vec2& max, float minDistance)
+            : m_min(min)
+            , m_minDistance2(minDistance * minDistance)
+            , m_inverseCellSize(glm::sqrt(2.0f) / minDistance)
+        {
+            glm::vec2 size = glm::ceil((max - min) * m_inverseCellSize);
+            m_width = std::max(static_cast<int>(size.x), 1);
+            m_height = std::max(static_cast<int>(size.y), 1);
+            m_cells.resize(static_cast<size_t>(m_width) * m_height, glm::vec2(FLT_MAX));
+        }
+
+        // No point closer than the min distance
+        bool IsFree(const glm::vec2& point) const
+        {
+            int i, j;
+            GetCell(point, i, j);
+            for (int y = std::max(j - 2, 0); y <= std::min(j + 2, m_height - 1); ++y)
+            {
+                for (int x = std::max(i - 2, 0); x <= std::min(i + 2, m_width - 1); ++x)
+                {
+                    // Points in the corner cells are at least the min distance away
+                    if (std::abs(x - i) == 2 && std::abs(y - j) == 2)
+                    {
+                        continue;
+                    }
+
+                    // Empty cells are infinitely far
+                    glm::vec2 offset = m_cells[y * m_width + x] - point;
+                    if (glm::dot(offset, offset) < m_minDistance2)
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        void Add(const glm::vec2& point)
+        {
+            int i, j;
+            GetCell(point, i, j);
+            m_cells[j * m_width + i] = point;
+        }
+
+    private:
+        void GetCell(const glm::vec2& point, int& i, int& j) const
+        {
+            glm::vec2 coordinates = (point - m_min) * m_inverseCellSize;
+            i = glm::clamp(static_cast<int>(coordinates.x), 0, m_width - 1);
+            j = glm::clamp(static_cast<int>(coordinates.y), 0, m_height - 1);
+        }
+
+    private:
+        glm::vec2 m_min;
+        float m_minDistance2;
+        float m_inverseCellSize;
+        int m_width;
+        int m_height;
+        std::vector<glm::vec2> m_cells;
+    };
+
+    // Bridson's algorithm, restricted to the chunk and avoiding the points already generated in the neighbours
+    void GeneratePoints(const glm::vec2& chunkMin, const glm::vec2& chunkMax, float minDistance,
+        std::span<const std::vector<glm::vec2>* const> neighbours, Random& random, std::vector<glm::vec2>& points)
+    {
+        glm::vec2 gridMin = chunkMin - minDistance;
+        glm::vec2 gridMax = chunkMax + minDistance;
+        PoissonGrid grid(gridMin, gridMax, minDistance);
+        for (const std::vector<glm::vec2>* neighbourPoints : neighbours)
+        {
+            for (const glm::vec2& point : *neighbourPoints)
+            {
+                if (glm::all(glm::greaterThanEqual(point, gridMin)) && glm::all(glm::lessThan(point, gridMax)))
+                {
+                    grid.Add(point);
+                }
+            }
+        }
+
+        auto IsInChunk = [&](const glm::vec2& point)
+        {
+            return glm::all(glm::greaterThanEqual(point, chunkMin)) && glm::all(glm::lessThan(point, chunkMax));
+        };
+
+        auto AddPoint = [&](const glm::vec2& point, std::vector<glm::vec2>& active)
+        {
+            grid.Add(point);
+            points.push_back(point);
+            active.push_back(point);
+        };
+
+        // Random seeds start new fronts, until many of them in a row land too close to other points
+        std::vector<glm::vec2> active;
+        unsigned int failedSeeds = 0;
+        while (failedSeeds < SeedCount)
+        {
+            if (active.empty())
+            {
+                glm::vec2 seed(random.NextRange(chunkMin.x, chunkMax.x), random.NextRange(chunkMin.y, chunkMax.y));
+                if (IsInChunk(seed) && grid.IsFree(seed))
+                {
+                    AddPoint(seed, active);
+                    failedSeeds = 0;
+                }
+                else
+                {
+                    ++failedSeeds;
+                }
+                continue;
+            }
+
+            // Candidates uniformly distributed in the ring between the min distance and twice it
+            size_t activeIndex = std::min(static_cast<size_t>(random.Next01() * active.size()), active.size() - 1);
+            glm::vec2 center = active[activeIndex];
+            bool found = false;
+            // The directions go around the circle from a random angle, rotating the previous one instead of calling cos and sin
+            float angle = random.Next01() * glm::two_pi<float>();
+            glm::vec2 direction(std::cos(angle), std::sin(angle));
+            for (unsigned int candidate = 0; candidate < CandidateCount && !found; ++candidate)
+            {
+                float radius = minDistance * glm::sqrt(1.0f + 3.0f * random.Next01());
+                glm::vec2 point = center + radius * direction;
+                direction = glm::vec2(direction.x * CandidateRotation.x - direction.y * CandidateRotation.y,
+                    direction.x * CandidateRotation.y + direction.y * CandidateRotation.x);
+                if (IsInChunk(point) && grid.IsFree(point))
+                {
+                    AddPoint(point, active);
+                    found = true;
+                }
+            }
+
+            // No room around this point anymore
+            if (!found)
+            {
+                active[activeIndex] = active.back();
+                active.pop_back();
+            }
+        }
+    }
+}
+
+void FoliageScatter::Scatter(const TerrainHeightfield& heightfield, const Settings& settings, float chunkSize, JobSystem& jobSystem,
+    std::vector<Instance>& instances, std::vector<Chunk>& chunks)
+{
+    assert(settings.minDistance > 0.0f && chunkSize >= settings.minDistance);
+
+    instances.clear();
+    chunks.clear();
+
+    glm::vec3 boundsMin = heightfield.GetBoundsMin();
+    glm::vec3 boundsMax = heightfield.GetBoundsMax();
+    glm::vec2 areaMin(boundsMin.x, boundsMin.z);
+    glm::vec2 areaMax(boundsMax.x, boundsMax.z);
+    glm::uvec2 chunkCount = glm::max(glm::uvec2(glm::ceil((areaMax - areaMin) / chunkSize)), glm::uvec2(1));
+    size_t totalChunkCount = static_cast<size_t>(chunkCount.x) * chunkCount.y;
+
+    auto GetChunkMin = [&](unsigned int chunkX, unsigned int chunkY)
+    {
+        return areaMin + glm::vec2(chunkX, chunkY) * chunkSize;
+    };
+    auto GetChunkMax = [&](unsigned int chunkX, unsigned int chunkY)
+    {
+        return glm::min(GetChunkMin(chunkX + 1, chunkY + 1), areaMax);
+    };
+
+    // Chunks with the same parity in x and y are never neighbours, so they can be generated at the same time
+    // The neighbours of the chunks of a phase are either finished, in a previous phase, or still empty
+    std::vector<std::vector<glm::vec2>> chunkPoints(totalChunkCount);
+    for (unsigned int phase = 0; phase < 4; ++phase)
+    {
+        std::vector<glm::uvec2> phaseChunks;
+        for (unsigned int chunkY = phase / 2; chunkY < chunkCount.y; chunkY += 2)
+        {
+            for (unsigned int chunkX = phase % 2; chunkX < chunkCount.x; chunkX += 2)
+            {
+                phaseChunks.emplace_back(chunkX, chunkY);
+            }
+        }
+
+        jobSystem.ParallelFor(phaseChunks.size(), 1, [&](size_t begin, size_t end, size_t)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    glm::uvec2 chunk = phaseChunks[i];
+
+                    std::array<const std::vector<glm::vec2>*, 8> neighbours;
+                    unsigned int neighbourCount = 0;
+                    for (unsigned int y = std::max(chunk.y, 1u) - 1; y <= std::min(chunk.y + 1, chunkCount.y - 1); ++y)
+                    {
+                        for (unsigned int x = std::max(chunk.x, 1u) - 1; x <= std::min(chunk.x + 1, chunkCount.x - 1); ++x)
+                        {
+                            if (x != chunk.x || y != chunk.y)
+                            {
+                                neighbours[neighbourCount++] = &chunkPoints[y * chunkCount.x + x];
+                            }
+                        }
+                    }
+
+                    size_t index = chunk.y * chunkCount.x + chunk.x;
+                    Random random = GetChunkRandom(settings.seed, index, 0);
+                    GeneratePoints(GetChunkMin(chunk.x, chunk.y), GetChunkMax(chunk.x, chunk.y), settings.minDistance,
+                        std::span(neighbours.data(), neighbourCount), random, chunkPoints[index]);
+                }
+            });
+    }
+
+    // Heights and masks of each chunk, in parallel too
+    std::vector<std::vector<Instance>> chunkInstances(totalChunkCount);
+    jobSystem.ParallelFor(totalChunkCount, 1, [&](size_t begin, size_t end, size_t)
+        {
+            std::vector<float> x, z, heights;
+            for (size_t index = begin; index < end; ++index)
+            {
+                const std::vector<glm::vec2>& points = chunkPoints[index];
+                x.resize(points.size());
+                z.resize(points.size());
+                heights.resize(points.size());
+                for (size_t i = 0; i < points.size(); ++i)
+                {
+                    x[i] = points[i].x;
+                    z[i] = points[i].y;
+                }
+                heightfield.SampleHeights(x, z, heights);
+
+                // The same random numbers are used for each point, kept or not
+                Random random = GetChunkRandom(settings.seed, index, 1);
+                std::vector<Instance>& kept = chunkInstances[index];
+                for (size_t i = 0; i < points.size(); ++i)
+                {
+                    float keep = random.Next01();
+                    float yaw = random.Next01() * glm::two_pi<float>();
+                    float scale = random.NextRange(settings.scaleRange.x, settings.scaleRange.y);
+
+                    float slope = std::acos(glm::clamp(heightfield.SampleNormal(x[i], z[i]).y, -1.0f, 1.0f));
+                    float density = settings.density
+                        * FadeOut(slope, settings.maxSlope, settings.slopeFade)
+                        * FadeOut(heights[i], settings.maxHeight, settings.heightFade)
+                        * FadeOut(-heights[i], -settings.minHeight, settings.heightFade);
+                    if (keep < density)
+                    {
+                        Instance& instance = kept.emplace_back();
+                        instance.position = glm::vec3(x[i], heights[i], z[i]);
+                        instance.yaw = glm::packHalf1x16(yaw);
+                        instance.scale = glm::packHalf1x16(scale);
+                    }
+                }
+            }
+        });
+
+    // Join the chunks, in order
+    size_t instanceCount = 0;
+    for (const std::vector<Instance>& chunkInstanceList : chunkInstances)
+    {
+        instanceCount += chunkInstanceList.size();
+    }
+    instances.reserve(instanceCount);
+    chunks.resize(totalChunkCount);
+    for (size_t index = 0; index < totalChunkCount; ++index)
+    {
+        Chunk& chunk = chunks[index];
+        chunk.firstInstance = static_cast<unsigned int>(instances.size());
+        chunk.instanceCount = static_cast<unsigned int>(chunkInstances[index].size());
+        if (chunk.instanceCount > 0)
+        {
+            chunk.boundsMin = glm::vec3(FLT_MAX);
+            chunk.boundsMax = glm::vec3(-FLT_MAX);
+            for (const Instance& instance : chunkInstances[index])
+            {
+                chunk.boundsMin = glm::min(chunk.boundsMin, instance.position);
+                chunk.boundsMax = glm::max(chunk.boundsMax, instance.position);
+            }
+        }
+        instances.insert(instances.end(), chunkInstances[index].begin(), chunkInstances[index].end());
+    }
+}
+
+float FoliageScatter::GetYaw(const Instance& instance)
+{
+    return glm::unpackHalf1x16(instance.yaw);
+}
+
+float FoliageScatter::GetScale(const Instance& instance)
+{
+    return glm::unpackHalf1x16(instance.scale);
+}
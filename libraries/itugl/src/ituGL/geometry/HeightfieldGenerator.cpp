@@ -0,0 +1,437 @@
+#include <ituGL/geometry/HeightfieldGenerator.h>
+
+#include <ituGL/core/CpuFeatures.h>
+#include <ituGL/core/JobSystem.h>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(ITUGL_SIMD_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // Same permutation and gradient hash as stb_perlin.h, so the noise matches stb_perlin_fbm_noise3
+    // stb repeats the tables to skip the masks, here the indices are masked to 8 bits instead
+    constexpr std::array<std::int32_t, 256> Permutation =
+    {
+        23, 125, 161, 52, 103, 117, 70, 37, 247, 101, 203, 169, 124, 126, 44, 123,
+        152, 238, 145, 45, 171, 114, 253, 10, 192, 136, 4, 157, 249, 30, 35, 72,
+        175, 63, 77, 90, 181, 16, 96, 111, 133, 104, 75, 162, 93, 56, 66, 240,
+        8, 50, 84, 229, 49, 210, 173, 239, 141, 1, 87, 18, 2, 198, 143, 57,
+        225, 160, 58, 217, 168, 206, 245, 204, 199, 6, 73, 60, 20, 230, 211, 233,
+        94, 200, 88, 9, 74, 155, 33, 15, 219, 130, 226, 202, 83, 236, 42, 172,
+        165, 218, 55, 222, 46, 107, 98, 154, 109, 67, 196, 178, 127, 158, 13, 243,
+        65, 79, 166, 248, 25, 224, 115, 80, 68, 51, 184, 128, 232, 208, 151, 122,
+        26, 212, 105, 43, 179, 213, 235, 148, 146, 89, 14, 195, 28, 78, 112, 76,
+        250, 47, 24, 251, 140, 108, 186, 190, 228, 170, 183, 139, 39, 188, 244, 246,
+        132, 48, 119, 144, 180, 138, 134, 193, 82, 182, 120, 121, 86, 220, 209, 3,
+        91, 241, 149, 85, 205, 150, 113, 216, 31, 100, 41, 164, 177, 214, 153, 231,
+        38, 71, 185, 174, 97, 201, 29, 95, 7, 92, 54, 254, 191, 118, 34, 221,
+        131, 11, 163, 99, 234, 81, 227, 147, 156, 176, 17, 142, 69, 12, 110, 62,
+        27, 255, 0, 194, 59, 116, 242, 252, 19, 21, 187, 53, 207, 129, 64, 135,
+        61, 40, 167, 237, 102, 223, 106, 159, 197, 189, 215, 137, 36, 32, 22, 5,
+    };
+
+    constexpr std::array<std::uint8_t, 256> GradientIndices =
+    {
+        7, 9, 5, 0, 11, 1, 6, 9, 3, 9, 11, 1, 8, 10, 4, 7,
+        8, 6, 1, 5, 3, 10, 9, 10, 0, 8, 4, 1, 5, 2, 7, 8,
+        7, 11, 9, 10, 1, 0, 4, 7, 5, 0, 11, 6, 1, 4, 2, 8,
+        8, 10, 4, 9, 9, 2, 5, 7, 9, 1, 7, 2, 2, 6, 11, 5,
+        5, 4, 6, 9, 0, 1, 1, 0, 7, 6, 9, 8, 4, 10, 3, 1,
+        2, 8, 8, 9, 10, 11, 5, 11, 11, 2, 6, 10, 3, 4, 2, 4,
+        9, 10, 3, 2, 6, 3, 6, 10, 5, 3, 4, 10, 11, 2, 9, 11,
+        1, 11, 10, 4, 9, 4, 11, 0, 4, 11, 4, 0, 0, 0, 7, 6,
+        10, 4, 1, 3, 11, 5, 3, 4, 2, 9, 1, 3, 0, 1, 8, 0,
+        6, 7, 8, 7, 0, 4, 6, 10, 8, 2, 3, 11, 11, 8, 0, 2,
+        4, 8, 3, 0, 0, 10, 6, 1, 2, 2, 4, 5, 6, 0, 1, 3,
+        11, 9, 5, 5, 9, 6, 9, 8, 3, 8, 1, 8, 9, 6, 9, 11,
+        10, 7, 5, 6, 5, 9, 1, 3, 7, 0, 2, 10, 11, 2, 6, 1,
+        3, 11, 7, 7, 2, 1, 7, 3, 0, 8, 1, 1, 5, 0, 6, 10,
+        11, 11, 0, 2, 7, 0, 10, 8, 3, 5, 7, 1, 11, 1, 0, 7,
+        9, 0, 11, 5, 10, 3, 2, 3, 5, 9, 7, 9, 8, 4, 6, 5,
+    };
+
+    // The 12 edge directions of a cube, like Perlin's improved noise
+    constexpr float GradientBasis[12][3] =
+    {
+        { 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 },
+        { 1, 0, 1 }, { -1, 0, 1 }, { 1, 0, -1 }, { -1, 0, -1 },
+        { 0, 1, 1 }, { 0, -1, 1 }, { 0, 1, -1 }, { 0, -1, -1 },
+    };
+
+    // Gradient component of each hash, to look it up with a single gather
+    constexpr std::array<float, 256> GetGradientTable(int component)
+    {
+        std::array<float, 256> table = {};
+        for (size_t i = 0; i < table.size(); ++i)
+        {
+            table[i] = GradientBasis[GradientIndices[i]][component];
+        }
+        return table;
+    }
+
+    constexpr std::array<float, 256> GradientX = GetGradientTable(0);
+    constexpr std::array<float, 256> GradientY = GetGradientTable(1);
+    constexpr std::array<float, 256> GradientZ = GetGradientTable(2);
+
+    // Same as stb__perlin_fastfloor
+    inline int FastFloor(float value)
+    {
+        int truncated = static_cast<int>(value);
+        return value < truncated ? truncated - 1 : truncated;
+    }
+
+    // Same as stb__perlin_ease, with the same operation order
+    inline float Ease(float t)
+    {
+        return ((t * 6 - 15) * t + 10) * t * t * t;
+    }
+
+    inline float Lerp(float a, float b, float t)
+    {
+        return a + (b - a) * t;
+    }
+
+    inline float Gradient(int hash, float x, float y, float z)
+    {
+        return GradientX[hash] * x + GradientY[hash] * y + GradientZ[hash] * z;
+    }
+
+    // Lattice cell and weight of the z coordinate. It is the same for every sample of an octave
+    struct NoisePlane
+    {
+        NoisePlane(float z, int seed)
+        {
+            int pz = FastFloor(z);
+            z0 = pz & 255;
+            z1 = (pz + 1) & 255;
+            offset = z - pz;
+            weight = Ease(offset);
+            this->seed = seed & 255;
+        }
+
+        int z0;
+        int z1;
+        float offset;
+        float weight;
+        int seed;
+    };
+
+    // stb_perlin_noise3_internal without wrapping
+    // With a weight of 0 in z, lerp(a, b, 0) is a, so the corners of the second plane are skipped
+    float NoiseReference(float x, float y, const NoisePlane& plane)
+    {
+        int px = FastFloor(x);
+        int py = FastFloor(y);
+        int x0 = px & 255, x1 = (px + 1) & 255;
+        int y0 = py & 255, y1 = (py + 1) & 255;
+
+        x -= px;
+        y -= py;
+        float u = Ease(x);
+        float v = Ease(y);
+        float z = plane.offset;
+
+        int r0 = Permutation[(x0 + plane.seed) & 255];
+        int r1 = Permutation[(x1 + plane.seed) & 255];
+        int r00 = Permutation[(r0 + y0) & 255];
+        int r01 = Permutation[(r0 + y1) & 255];
+        int r10 = Permutation[(r1 + y0) & 255];
+        int r11 = Permutation[(r1 + y1) & 255];
+
+        float n00 = Gradient((r00 + plane.z0) & 255, x, y, z);
+        float n01 = Gradient((r01 + plane.z0) & 255, x, y - 1, z);
+        float n10 = Gradient((r10 + plane.z0) & 255, x - 1, y, z);
+        float n11 = Gradient((r11 + plane.z0) & 255, x - 1, y - 1, z);
+        if (plane.weight != 0.0f)
+        {
+            n00 = Lerp(n00, Gradient((r00 + plane.z1) & 255, x, y, z - 1), plane.weight);
+            n01 = Lerp(n01, Gradient((r01 + plane.z1) & 255, x, y - 1, z - 1), plane.weight);
+            n10 = Lerp(n10, Gradient((r10 + plane.z1) & 255, x - 1, y, z - 1), plane.weight);
+            n11 = Lerp(n11, Gradient((r11 + plane.z1) & 255, x - 1, y - 1, z - 1), plane.weight);
+        }
+
+        float n0 = Lerp(n00, n01, v);
+        float n1 = Lerp(n10, n11, v);
+        return Lerp(n0, n1, u);
+    }
+
+    // Position of sample i of count, between min and max
+    inline float GetNoiseCoordinate(unsigned int i, unsigned int count, float min, float max)
+    {
+        float t = static_cast<float>(i) / static_cast<float>(count > 1 ? count - 1 : 1);
+        return min + (max - min) * t;
+    }
+
+    void GenerateRowReference(float* row, unsigned int width, float y, const HeightfieldGenerator::NoiseSettings& settings)
+    {
+        for (unsigned int i = 0; i < width; ++i)
+        {
+            float x = GetNoiseCoordinate(i, width, settings.noiseMin.x, settings.noiseMax.x);
+
+            // Same as stb_perlin_fbm_noise3, with the octave as seed
+            float frequency = 1.0f;
+            float amplitude = 1.0f;
+            float sum = 0.0f;
+            for (int octave = 0; octave < settings.octaves; ++octave)
+            {
+                NoisePlane plane(settings.noiseZ * frequency, octave);
+                sum += NoiseReference(x * frequency, y * frequency, plane) * amplitude;
+                frequency *= settings.lacunarity;
+                amplitude *= settings.gain;
+            }
+            row[i] = sum * settings.height;
+        }
+    }
+
+    // Tangent frame of a vertex, from the height differences across it and the distances between the samples
+    struct TangentFrame
+    {
+        float tangent[3];
+        float bitangent[3];
+        float normal[3];
+    };
+
+    // Tangent is (tx, ty, 0) and bitangent is (0, by, bz), normalized. The normal is cross(bitangent, tangent), normalized
+    inline void ComputeTangentFrameReference(float tx, float ty, float by, float bz, TangentFrame& frame)
+    {
+        float tangentScale = 1.0f / std::sqrt(tx * tx + ty * ty);
+        tx *= tangentScale;
+        ty *= tangentScale;
+
+        float bitangentScale = 1.0f / std::sqrt(by * by + bz * bz);
+        by *= bitangentScale;
+        bz *= bitangentScale;
+
+        float nx = -(bz * ty);
+        float ny = bz * tx;
+        float nz = -(by * tx);
+        float normalScale = 1.0f / std::sqrt(nx * nx + ny * ny + nz * nz);
+
+        frame = TangentFrame{ { tx, ty, 0.0f }, { 0.0f, by, bz }, { nx * normalScale, ny * normalScale, nz * normalScale } };
+    }
+
+    inline void StoreTangentFrame(const TangentFrame& frame, std::byte* vertex, size_t normalOffset, size_t tangentOffset, size_t bitangentOffset)
+    {
+        std::memcpy(vertex + normalOffset, frame.normal, sizeof(frame.normal));
+        std::memcpy(vertex + tangentOffset, frame.tangent, sizeof(frame.tangent));
+        std::memcpy(vertex + bitangentOffset, frame.bitangent, sizeof(frame.bitangent));
+    }
+
+    // Rows per job, so each job has enough samples to hide the scheduling cost
+    size_t GetRowsPerJob(unsigned int width)
+    {
+        return std::max<size_t>(1, 16384 / std::max(width, 1u));
+    }
+}
+
+// The same kernels are built for each instruction set, and picked at runtime with CpuFeatures
+#if defined(ITUGL_SIMD_SSE2)
+namespace
+{
+    namespace Sse2
+    {
+        using FloatVector = __m128;
+        using IntVector = __m128i;
+        constexpr unsigned int VectorLanes = 4;
+        inline FloatVector VectorLoad(const float* data) { return _mm_loadu_ps(data); }
+        inline void VectorStore(float* data, FloatVector a) { _mm_storeu_ps(data, a); }
+        inline FloatVector VectorSplat(float value) { return _mm_set1_ps(value); }
+        inline FloatVector VectorAdd(FloatVector a, FloatVector b) { return _mm_add_ps(a, b); }
+        inline FloatVector VectorSub(FloatVector a, FloatVector b) { return _mm_sub_ps(a, b); }
+        inline FloatVector VectorMul(FloatVector a, FloatVector b) { return _mm_mul_ps(a, b); }
+        inline FloatVector VectorDiv(FloatVector a, FloatVector b) { return _mm_div_ps(a, b); }
+        inline FloatVector VectorSqrt(FloatVector a) { return _mm_sqrt_ps(a); }
+        inline IntVector VectorLessThan(FloatVector a, FloatVector b) { return _mm_castps_si128(_mm_cmplt_ps(a, b)); }
+        inline IntVector VectorTruncate(FloatVector a) { return _mm_cvttps_epi32(a); }
+        inline FloatVector VectorToFloat(IntVector a) { return _mm_cvtepi32_ps(a); }
+        inline IntVector IntSplat(int value) { return _mm_set1_epi32(value); }
+        inline IntVector IntAdd(IntVector a, IntVector b) { return _mm_add_epi32(a, b); }
+        inline IntVector IntAnd(IntVector a, IntVector b) { return _mm_and_si128(a, b); }
+        inline IntVector IntLaneIndices() { return _mm_setr_epi32(0, 1, 2, 3); }
+
+        // SSE2 has no gathers, the lanes are looked up one by one
+        inline IntVector Gather(const std::int32_t* table, IntVector indices)
+        {
+            alignas(16) std::int32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), indices);
+            return _mm_setr_epi32(table[lanes[0]], table[lanes[1]], table[lanes[2]], table[lanes[3]]);
+        }
+        inline FloatVector Gather(const float* table, IntVector indices)
+        {
+            alignas(16) std::int32_t lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), indices);
+            return _mm_setr_ps(table[lanes[0]], table[lanes[1]], table[lanes[2]], table[lanes[3]]);
+        }
+
+#include "HeightfieldGeneratorKernels.inl"
+    }
+}
+#endif
+
+#if defined(ITUGL_SIMD_AVX2)
+ITUGL_AVX2_BEGIN
+namespace
+{
+    namespace Avx2
+    {
+        using FloatVector = __m256;
+        using IntVector = __m256i;
+        constexpr unsigned int VectorLanes = 8;
+        inline FloatVector VectorLoad(const float* data) { return _mm256_loadu_ps(data); }
+        inline void VectorStore(float* data, FloatVector a) { _mm256_storeu_ps(data, a); }
+        inline FloatVector VectorSplat(float value) { return _mm256_set1_ps(value); }
+        inline FloatVector VectorAdd(FloatVector a, FloatVector b) { return _mm256_add_ps(a, b); }
+        inline FloatVector VectorSub(FloatVector a, FloatVector b) { return _mm256_sub_ps(a, b); }
+        inline FloatVector VectorMul(FloatVector a, FloatVector b) { return _mm256_mul_ps(a, b); }
+        inline FloatVector VectorDiv(FloatVector a, FloatVector b) { return _mm256_div_ps(a, b); }
+        inline FloatVector VectorSqrt(FloatVector a) { return _mm256_sqrt_ps(a); }
+        inline IntVector VectorLessThan(FloatVector a, FloatVector b) { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+        inline IntVector VectorTruncate(FloatVector a) { return _mm256_cvttps_epi32(a); }
+        inline FloatVector VectorToFloat(IntVector a) { return _mm256_cvtepi32_ps(a); }
+        inline IntVector IntSplat(int value) { return _mm256_set1_epi32(value); }
+        inline IntVector IntAdd(IntVector a, IntVector b) { return _mm256_add_epi32(a, b); }
+        inline IntVector IntAnd(IntVector a, IntVector b) { return _mm256_and_si256(a, b); }
+        inline IntVector IntLaneIndices() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+        inline IntVector Gather(const std::int32_t* table, IntVector indices) { return _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), indices, 4); }
+        inline FloatVector Gather(const float* table, IntVector indices) { return _mm256_i32gather_ps(table, indices, 4); }
+
+#include "HeightfieldGeneratorKernels.inl"
+    }
+}
+ITUGL_AVX2_END
+#endif
+
+void HeightfieldGenerator::Generate(std::span<float> heights, unsigned int width, unsigned int height, const NoiseSettings& settings,
+    JobSystem& jobSystem)
+{
+    assert(heights.size() >= static_cast<size_t>(width) * height);
+
+    // Rows don't depend on each other, so any split gives the same result
+    jobSystem.ParallelFor(height, GetRowsPerJob(width), [&](size_t begin, size_t end, size_t)
+        {
+            GenerateRows(heights, width, height, settings, static_cast<unsigned int>(begin), static_cast<unsigned int>(end), false);
+        });
+}
+
+std::vector<float> HeightfieldGenerator::Generate(unsigned int width, unsigned int height, const NoiseSettings& settings, JobSystem& jobSystem)
+{
+    std::vector<float> heights(static_cast<size_t>(width) * height);
+    Generate(heights, width, height, settings, jobSystem);
+    return heights;
+}
+
+void HeightfieldGenerator::GenerateReference(std::span<float> heights, unsigned int width, unsigned int height, const NoiseSettings& settings)
+{
+    assert(heights.size() >= static_cast<size_t>(width) * height);
+    GenerateRows(heights, width, height, settings, 0, height, true);
+}
+
+void HeightfieldGenerator::GenerateRows(std::span<float> heights, unsigned int width, unsigned int height, const NoiseSettings& settings,
+    unsigned int firstRow, unsigned int lastRow, bool reference)
+{
+    for (unsigned int j = firstRow; j < lastRow; ++j)
+    {
+        float* row = heights.data() + static_cast<size_t>(j) * width;
+        float y = GetNoiseCoordinate(j, height, settings.noiseMin.y, settings.noiseMax.y);
+#if defined(ITUGL_SIMD_AVX2)
+        if (!reference && CpuFeatures::IsAvx2Enabled())
+        {
+            Avx2::GenerateRow(row, width, y, settings);
+            continue;
+        }
+#endif
+#if defined(ITUGL_SIMD_SSE2)
+        if (!reference)
+        {
+            Sse2::GenerateRow(row, width, y, settings);
+            continue;
+        }
+#endif
+        (void)reference;
+        GenerateRowReference(row, width, y, settings);
+    }
+}
+
+void HeightfieldGenerator::ComputeTangentFrames(std::span<const float> heights, unsigned int width, unsigned int height, const glm::vec2& spacing,
+    std::span<std::byte> vertexData, size_t vertexSize, size_t normalOffset, size_t tangentOffset, size_t bitangentOffset,
+    JobSystem& jobSystem)
+{
+    assert(heights.size() >= static_cast<size_t>(width) * height);
+    assert(vertexData.size() >= static_cast<size_t>(width) * height * vertexSize);
+
+    jobSystem.ParallelFor(height, GetRowsPerJob(width), [&](size_t begin, size_t end, size_t)
+        {
+            ComputeTangentFrameRows(heights, width, height, spacing, vertexData, vertexSize, normalOffset, tangentOffset, bitangentOffset,
+                static_cast<unsigned int>(begin), static_cast<unsigned int>(end), false);
+        });
+}
+
+void HeightfieldGenerator::ComputeTangentFramesReference(std::span<const float> heights, unsigned int width, unsigned int height, const glm::vec2& spacing,
+    std::span<std::byte> vertexData, size_t vertexSize, size_t normalOffset, size_t tangentOffset, size_t bitangentOffset)
+{
+    assert(heights.size() >= static_cast<size_t>(width) * height);
+    assert(vertexData.size() >= static_cast<size_t>(width) * height * vertexSize);
+
+    ComputeTangentFrameRows(heights, width, height, spacing, vertexData, vertexSize, normalOffset, tangentOffset, bitangentOffset,
+        0, height, true);
+}
+
+void HeightfieldGenerator::ComputeTangentFrameRows(std::span<const float> heights, unsigned int width, unsigned int height, const glm::vec2& spacing,
+    std::span<std::byte> vertexData, size_t vertexSize, size_t normalOffset, size_t tangentOffset, size_t bitangentOffset,
+    unsigned int firstRow, unsigned int lastRow, bool reference)
+{
+    for (unsigned int j = firstRow; j < lastRow; ++j)
+    {
+        // Central differences, or one-sided differences on the borders
+        unsigned int prevY = j > 0 ? j - 1 : j;
+        unsigned int nextY = j + 1 < height ? j + 1 : j;
+        const float* row = heights.data() + static_cast<size_t>(j) * width;
+        const float* prevRow = heights.data() + static_cast<size_t>(prevY) * width;
+        const float* nextRow = heights.data() + static_cast<size_t>(nextY) * width;
+        float bz = static_cast<float>(nextY - prevY) * spacing.y;
+        std::byte* vertices = vertexData.data() + static_cast<size_t>(j) * width * vertexSize;
+
+        unsigned int i = 0;
+#if defined(ITUGL_SIMD_SSE2)
+        if (!reference && width > 2)
+        {
+            // First column with the scalar code, then the inner columns in vectors. The rest go to the scalar code too
+            TangentFrame frame;
+            ComputeTangentFrameReference(static_cast<float>(std::min(1u, width - 1)) * spacing.x, row[std::min(1u, width - 1)] - row[0],
+                nextRow[0] - prevRow[0], bz, frame);
+            StoreTangentFrame(frame, vertices, normalOffset, tangentOffset, bitangentOffset);
+
+#if defined(ITUGL_SIMD_AVX2)
+            if (CpuFeatures::IsAvx2Enabled())
+            {
+                i = Avx2::ComputeTangentFrameColumns(row, prevRow, nextRow, width, spacing.x, bz, vertices, vertexSize,
+                    normalOffset, tangentOffset, bitangentOffset);
+            }
+            else
+#endif
+            {
+                i = Sse2::ComputeTangentFrameColumns(row, prevRow, nextRow, width, spacing.x, bz, vertices, vertexSize,
+                    normalOffset, tangentOffset, bitangentOffset);
+            }
+        }
+#endif
+        (void)reference;
+        for (; i < width; ++i)
+        {
+            unsigned int prevX = i > 0 ? i - 1 : i;
+            unsigned int nextX = i + 1 < width ? i + 1 : i;
+
+            TangentFrame frame;
+            ComputeTangentFrameReference(static_cast<float>(nextX - prevX) * spacing.x, row[nextX] - row[prevX],
+                nextRow[i] - prevRow[i], bz, frame);
+            StoreTangentFrame(frame, vertices + static_cast<size_t>(i) * vertexSize, normalOffset, tangentOffset, bitangentOffset);
+        }
+    }
+}
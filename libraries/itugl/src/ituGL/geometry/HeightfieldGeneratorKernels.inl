@@ -0,0 +1,170 @@
+// Vectorized kernels of HeightfieldGenerator.cpp, included once for each instruction set
+// Included inside a namespace that defines FloatVector, IntVector, VectorLanes and the Vector functions for that set
+
+// Same operations as the scalar functions, in the same order, so both give the same bits
+inline IntVector VectorFastFloor(FloatVector value)
+{
+    // The comparison mask is -1 where the value was truncated up
+    IntVector truncated = VectorTruncate(value);
+    return IntAdd(truncated, VectorLessThan(value, VectorToFloat(truncated)));
+}
+
+inline FloatVector VectorEase(FloatVector t)
+{
+    FloatVector a = VectorAdd(VectorMul(VectorSub(VectorMul(t, VectorSplat(6.0f)), VectorSplat(15.0f)), t), VectorSplat(10.0f));
+    return VectorMul(VectorMul(VectorMul(a, t), t), t);
+}
+
+inline FloatVector VectorLerp(FloatVector a, FloatVector b, FloatVector t)
+{
+    return VectorAdd(a, VectorMul(VectorSub(b, a), t));
+}
+
+inline FloatVector VectorGradient(IntVector hash, FloatVector x, FloatVector y, FloatVector z)
+{
+    FloatVector xy = VectorAdd(VectorMul(Gather(GradientX.data(), hash), x), VectorMul(Gather(GradientY.data(), hash), y));
+    return VectorAdd(xy, VectorMul(Gather(GradientZ.data(), hash), z));
+}
+
+FloatVector VectorNoise(FloatVector x, FloatVector y, const NoisePlane& plane)
+{
+    IntVector mask = IntSplat(255);
+    IntVector one = IntSplat(1);
+    FloatVector oneFloat = VectorSplat(1.0f);
+
+    IntVector px = VectorFastFloor(x);
+    IntVector py = VectorFastFloor(y);
+    IntVector x0 = IntAnd(px, mask), x1 = IntAnd(IntAdd(px, one), mask);
+    IntVector y0 = IntAnd(py, mask), y1 = IntAnd(IntAdd(py, one), mask);
+
+    x = VectorSub(x, VectorToFloat(px));
+    y = VectorSub(y, VectorToFloat(py));
+    FloatVector u = VectorEase(x);
+    FloatVector v = VectorEase(y);
+    FloatVector z = VectorSplat(plane.offset);
+    FloatVector x1Offset = VectorSub(x, oneFloat);
+    FloatVector y1Offset = VectorSub(y, oneFloat);
+
+    IntVector seed = IntSplat(plane.seed);
+    IntVector r0 = Gather(Permutation.data(), IntAnd(IntAdd(x0, seed), mask));
+    IntVector r1 = Gather(Permutation.data(), IntAnd(IntAdd(x1, seed), mask));
+    IntVector r00 = Gather(Permutation.data(), IntAnd(IntAdd(r0, y0), mask));
+    IntVector r01 = Gather(Permutation.data(), IntAnd(IntAdd(r0, y1), mask));
+    IntVector r10 = Gather(Permutation.data(), IntAnd(IntAdd(r1, y0), mask));
+    IntVector r11 = Gather(Permutation.data(), IntAnd(IntAdd(r1, y1), mask));
+
+    IntVector z0 = IntSplat(plane.z0);
+    FloatVector n00 = VectorGradient(IntAnd(IntAdd(r00, z0), mask), x, y, z);
+    FloatVector n01 = VectorGradient(IntAnd(IntAdd(r01, z0), mask), x, y1Offset, z);
+    FloatVector n10 = VectorGradient(IntAnd(IntAdd(r10, z0), mask), x1Offset, y, z);
+    FloatVector n11 = VectorGradient(IntAnd(IntAdd(r11, z0), mask), x1Offset, y1Offset, z);
+    if (plane.weight != 0.0f)
+    {
+        IntVector z1 = IntSplat(plane.z1);
+        FloatVector z1Offset = VectorSub(z, oneFloat);
+        FloatVector w = VectorSplat(plane.weight);
+        n00 = VectorLerp(n00, VectorGradient(IntAnd(IntAdd(r00, z1), mask), x, y, z1Offset), w);
+        n01 = VectorLerp(n01, VectorGradient(IntAnd(IntAdd(r01, z1), mask), x, y1Offset, z1Offset), w);
+        n10 = VectorLerp(n10, VectorGradient(IntAnd(IntAdd(r10, z1), mask), x1Offset, y, z1Offset), w);
+        n11 = VectorLerp(n11, VectorGradient(IntAnd(IntAdd(r11, z1), mask), x1Offset, y1Offset, z1Offset), w);
+    }
+
+    FloatVector n0 = VectorLerp(n00, n01, v);
+    FloatVector n1 = VectorLerp(n10, n11, v);
+    return VectorLerp(n0, n1, u);
+}
+
+void GenerateRow(float* row, unsigned int width, float y, const HeightfieldGenerator::NoiseSettings& settings)
+{
+    // The planes and octave scales don't depend on the sample
+    std::vector<NoisePlane> planes;
+    std::vector<float> frequencies;
+    std::vector<float> amplitudes;
+    float frequency = 1.0f;
+    float amplitude = 1.0f;
+    for (int octave = 0; octave < settings.octaves; ++octave)
+    {
+        planes.emplace_back(settings.noiseZ * frequency, octave);
+        frequencies.push_back(frequency);
+        amplitudes.push_back(amplitude);
+        frequency *= settings.lacunarity;
+        amplitude *= settings.gain;
+    }
+
+    FloatVector noiseMin = VectorSplat(settings.noiseMin.x);
+    FloatVector noiseRange = VectorSplat(settings.noiseMax.x - settings.noiseMin.x);
+    FloatVector divisor = VectorSplat(static_cast<float>(width > 1 ? width - 1 : 1));
+    for (unsigned int i = 0; i < width; i += VectorLanes)
+    {
+        // Same as GetNoiseCoordinate. The last vector is computed whole, and only the samples inside the row are stored
+        FloatVector t = VectorDiv(VectorToFloat(IntAdd(IntSplat(static_cast<int>(i)), IntLaneIndices())), divisor);
+        FloatVector x = VectorAdd(noiseMin, VectorMul(noiseRange, t));
+
+        FloatVector sum = VectorSplat(0.0f);
+        for (int octave = 0; octave < settings.octaves; ++octave)
+        {
+            FloatVector octaveFrequency = VectorSplat(frequencies[octave]);
+            FloatVector noise = VectorNoise(VectorMul(x, octaveFrequency), VectorMul(VectorSplat(y), octaveFrequency), planes[octave]);
+            sum = VectorAdd(sum, VectorMul(noise, VectorSplat(amplitudes[octave])));
+        }
+        sum = VectorMul(sum, VectorSplat(settings.height));
+
+        if (i + VectorLanes <= width)
+        {
+            VectorStore(row + i, sum);
+        }
+        else
+        {
+            alignas(32) float lanes[VectorLanes];
+            VectorStore(lanes, sum);
+            std::memcpy(row + i, lanes, (width - i) * sizeof(float));
+        }
+    }
+}
+
+// Tangent frames of the inner columns of a row, from column 1. Returns the first column left to the scalar code
+unsigned int ComputeTangentFrameColumns(const float* row, const float* prevRow, const float* nextRow, unsigned int width, float spacingX, float bz,
+    std::byte* vertices, size_t vertexSize, size_t normalOffset, size_t tangentOffset, size_t bitangentOffset)
+{
+    FloatVector tx = VectorSplat(2.0f * spacingX);
+    FloatVector bzVector = VectorSplat(bz);
+    FloatVector one = VectorSplat(1.0f);
+    FloatVector zero = VectorSplat(0.0f);
+    unsigned int i = 1;
+    for (; i + VectorLanes < width; i += VectorLanes)
+    {
+        FloatVector ty = VectorSub(VectorLoad(row + i + 1), VectorLoad(row + i - 1));
+        FloatVector by = VectorSub(VectorLoad(nextRow + i), VectorLoad(prevRow + i));
+
+        FloatVector tangentScale = VectorDiv(one, VectorSqrt(VectorAdd(VectorMul(tx, tx), VectorMul(ty, ty))));
+        FloatVector tangentX = VectorMul(tx, tangentScale);
+        FloatVector tangentY = VectorMul(ty, tangentScale);
+
+        FloatVector bitangentScale = VectorDiv(one, VectorSqrt(VectorAdd(VectorMul(by, by), VectorMul(bzVector, bzVector))));
+        FloatVector bitangentY = VectorMul(by, bitangentScale);
+        FloatVector bitangentZ = VectorMul(bzVector, bitangentScale);
+
+        FloatVector normalX = VectorSub(zero, VectorMul(bitangentZ, tangentY));
+        FloatVector normalY = VectorMul(bitangentZ, tangentX);
+        FloatVector normalZ = VectorSub(zero, VectorMul(bitangentY, tangentX));
+        FloatVector normalLengthSquared = VectorAdd(VectorAdd(VectorMul(normalX, normalX), VectorMul(normalY, normalY)), VectorMul(normalZ, normalZ));
+        FloatVector normalScale = VectorDiv(one, VectorSqrt(normalLengthSquared));
+
+        // Vertices are interleaved, so the lanes are written one by one
+        alignas(32) float lanes[7][VectorLanes];
+        VectorStore(lanes[0], tangentX);
+        VectorStore(lanes[1], tangentY);
+        VectorStore(lanes[2], bitangentY);
+        VectorStore(lanes[3], bitangentZ);
+        VectorStore(lanes[4], VectorMul(normalX, normalScale));
+        VectorStore(lanes[5], VectorMul(normalY, normalScale));
+        VectorStore(lanes[6], VectorMul(normalZ, normalScale));
+        for (unsigned int lane = 0; lane < VectorLanes; ++lane)
+        {
+            TangentFrame laneFrame{ { lanes[0][lane], lanes[1][lane], 0.0f }, { 0.0f, lanes[2][lane], lanes[3][lane] },
+                { lanes[4][lane], lanes[5][lane], lanes[6][lane] } };
+            StoreTangentFrame(laneFrame, vertices + (i + lane) * vertexSize, normalOffset, tangentOffset, bitangentOffset);
+        }
+    }
+    return i;
+}
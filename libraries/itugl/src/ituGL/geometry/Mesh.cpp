@@ -35,6 +35,39 @@ unsigned int Mesh::AddSubmesh(unsigned int vaoIndex,
     return AddSubmesh(vaoIndex, Drawcall(primitive, count, eboType, first));
 }
 
+void Mesh::SetSubmeshPositionTransform(unsigned int submeshIndex, const glm::vec3& offset, float scale)
+{
+    Submesh& submesh = GetSubmesh(submeshIndex);
+    submesh.positionOffset = offset;
+    submesh.positionScale = scale;
+}
+
+bool Mesh::HasSubmeshPositionTransform(unsigned int submeshIndex) const
+{
+    const Submesh& submesh = GetSubmesh(submeshIndex);
+    return submesh.positionScale != 1.0f || submesh.positionOffset != glm::vec3(0.0f);
+}
+
+glm::mat4 Mesh::GetSubmeshPositionTransform(unsigned int submeshIndex) const
+{
+    const Submesh& submesh = GetSubmesh(submeshIndex);
+    glm::mat4 transform(submesh.positionScale);
+    transform[3] = glm::vec4(submesh.positionOffset, 1.0f);
+    return transform;
+}
+
+void Mesh::SetSubmeshInstanceAttribute(unsigned int submeshIndex, const VertexBufferObject& vbo, GLuint location,
+    const VertexAttribute& attribute, GLint offset, GLsizei stride)
+{
+    VertexArrayObject& vao = GetVertexArray(GetSubmesh(submeshIndex).vaoIndex);
+    vao.Bind();
+    vbo.Bind();
+    vao.SetAttribute(location, attribute, offset, stride);
+    vao.SetAttributeDivisor(location, 1);
+    VertexArrayObject::Unbind();
+    VertexBufferObject::Unbind();
+}
+
 // Bind the VAO and render the drawcall of the submesh
 void Mesh::DrawSubmesh(int submeshIndex) const
 {
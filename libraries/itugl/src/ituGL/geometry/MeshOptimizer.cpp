@@ -0,0 +1,475 @@
+#include <ituGL/geometry/MeshOptimizer.h>
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+    // Parameters of Forsyth's scoring, from "Linear-Speed Vertex Cache Optimisation"
+    constexpr unsigned int ScoringCacheSize = 32;
+    constexpr float CacheDecayPower = 1.5f;
+    constexpr float LastTriangleScore = 0.75f;
+    constexpr float ValenceBoostScale = 2.0f;
+    constexpr float ValenceBoostPower = 0.5f;
+
+    // Cache size used to find the cluster boundaries. Smaller than most GPUs, so the order works well on all of them
+    constexpr unsigned int ClusterCacheSize = 16;
+
+    // Vertex fetch simulation
+    constexpr size_t CacheLineSize = 64;
+    constexpr unsigned int CacheLineCount = 64;
+
+    float GetVertexScore(int cachePosition, unsigned int remainingTriangles)
+    {
+        // Vertices without triangles left are not interesting anymore
+        if (remainingTriangles == 0)
+        {
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            // The vertices of the last triangle get a fixed score, so the same triangle pattern isn't repeated
+            if (cachePosition < 3)
+            {
+                score = LastTriangleScore;
+            }
+            else
+            {
+                float scale = 1.0f / (ScoringCacheSize - 3);
+                score = std::pow(1.0f - (cachePosition - 3) * scale, CacheDecayPower);
+            }
+        }
+
+        // Vertices with few triangles left get a boost, to finish them and avoid isolated triangles at the end
+        score += ValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -ValenceBoostPower);
+        return score;
+    }
+
+    // FIFO cache with timestamps: a vertex is in the cache if fewer than cacheSize vertices were added after it
+    class FifoCache
+    {
+    public:
+        FifoCache(unsigned int vertexCount, unsigned int cacheSize) : m_timestamps(vertexCount, 0), m_time(cacheSize + 1), m_cacheSize(cacheSize)
+        {
+        }
+
+        // Returns true if the vertex was not in the cache
+        inline bool Access(unsigned int vertex)
+        {
+            if (m_time - m_timestamps[vertex] > m_cacheSize)
+            {
+                m_timestamps[vertex] = m_time++;
+                return true;
+            }
+            return false;
+        }
+
+        inline void Reset()
+        {
+            // Everything added before is too old now
+            m_time += m_cacheSize + 1;
+        }
+
+    private:
+        std::vector<unsigned int> m_timestamps;
+        unsigned int m_time;
+        unsigned int m_cacheSize;
+    };
+
+    inline glm::vec3 GetPosition(std::span<const std::byte> vertexData, size_t vertexSize, size_t positionOffset, unsigned int vertex)
+    {
+        glm::vec3 position;
+        std::memcpy(&position, vertexData.data() + vertex * vertexSize + positionOffset, sizeof(position));
+        return position;
+    }
+}
+
+MeshOptimizer::VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(std::span<const unsigned int> indices, unsigned int vertexCount, unsigned int cacheSize)
+{
+    assert(indices.size() % 3 == 0);
+
+    VertexCacheStatistics statistics{};
+    FifoCache cache(vertexCount, cacheSize);
+    std::vector<bool> used(vertexCount, false);
+    unsigned int usedCount = 0;
+    for (unsigned int index : indices)
+    {
+        if (cache.Access(index))
+        {
+            ++statistics.transformedCount;
+        }
+        if (!used[index])
+        {
+            used[index] = true;
+            ++usedCount;
+        }
+    }
+
+    size_t triangleCount = indices.size() / 3;
+    statistics.acmr = triangleCount > 0 ? static_cast<float>(statistics.transformedCount) / triangleCount : 0.0f;
+    statistics.atvr = usedCount > 0 ? static_cast<float>(statistics.transformedCount) / usedCount : 0.0f;
+    return statistics;
+}
+
+MeshOptimizer::VertexFetchStatistics MeshOptimizer::AnalyzeVertexFetch(std::span<const unsigned int> indices, unsigned int vertexCount, size_t vertexSize)
+{
+    VertexFetchStatistics statistics{};
+
+    size_t lineCount = (vertexCount * vertexSize + CacheLineSize - 1) / CacheLineSize;
+    FifoCache cache(static_cast<unsigned int>(lineCount), CacheLineCount);
+    for (unsigned int index : indices)
+    {
+        size_t firstLine = index * vertexSize / CacheLineSize;
+        size_t lastLine = ((index + 1) * vertexSize - 1) / CacheLineSize;
+        for (size_t line = firstLine; line <= lastLine; ++line)
+        {
+            if (cache.Access(static_cast<unsigned int>(line)))
+            {
+                statistics.bytesFetched += CacheLineSize;
+            }
+        }
+    }
+
+    size_t vertexBufferSize = vertexCount * vertexSize;
+    statistics.overfetch = vertexBufferSize > 0 ? static_cast<float>(statistics.bytesFetched) / vertexBufferSize : 0.0f;
+    return statistics;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::span<unsigned int> indices, unsigned int vertexCount)
+{
+    assert(indices.size() % 3 == 0);
+    unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Scores only depend on small integers, so they are precomputed
+    std::array<float, ScoringCacheSize> cacheScores;
+    for (unsigned int i = 0; i < ScoringCacheSize; ++i)
+    {
+        cacheScores[i] = GetVertexScore(i, 1) - GetVertexScore(-1, 1);
+    }
+    constexpr unsigned int ValenceScoreCount = 64;
+    std::array<float, ValenceScoreCount> valenceScores;
+    for (unsigned int i = 0; i < ValenceScoreCount; ++i)
+    {
+        valenceScores[i] = GetVertexScore(-1, i);
+    }
+    auto getScore = [&](int cachePosition, unsigned int remainingTriangles)
+        {
+            if (remainingTriangles == 0)
+            {
+                return -1.0f;
+            }
+            float score = remainingTriangles < ValenceScoreCount ? valenceScores[remainingTriangles] : GetVertexScore(-1, remainingTriangles);
+            return cachePosition >= 0 ? score + cacheScores[cachePosition] : score;
+        };
+
+    // Triangles of each vertex. The live ones are kept at the start of each range
+    std::vector<unsigned int> remainingTriangles(vertexCount, 0);
+    for (unsigned int index : indices)
+    {
+        ++remainingTriangles[index];
+    }
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+    std::partial_sum(remainingTriangles.begin(), remainingTriangles.end(), adjacencyOffsets.begin() + 1);
+    std::vector<unsigned int> adjacency(indices.size());
+    {
+        std::vector<unsigned int> fillOffsets(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (unsigned int i = 0; i < indices.size(); ++i)
+        {
+            adjacency[fillOffsets[indices[i]]++] = i / 3;
+        }
+    }
+
+    std::vector<float> vertexScores(vertexCount);
+    for (unsigned int vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        vertexScores[vertex] = getScore(-1, remainingTriangles[vertex]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    unsigned int bestTriangle = 0;
+    for (unsigned int triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        triangleScores[triangle] = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+        if (triangleScores[triangle] > triangleScores[bestTriangle])
+        {
+            bestTriangle = triangle;
+        }
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    unsigned int nextTriangle = 0;
+
+    // LRU cache, with room for the 3 vertices pushed before the oldest ones are evicted
+    std::array<unsigned int, ScoringCacheSize + 3> cache;
+    std::array<unsigned int, ScoringCacheSize + 3> newCache;
+    unsigned int cacheCount = 0;
+
+    std::vector<unsigned int> optimizedIndices;
+    optimizedIndices.reserve(indices.size());
+    for (unsigned int emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+    {
+        // No triangle connected to the cache, continue with the next one in the original order
+        if (bestTriangle == ~0u)
+        {
+            while (emitted[nextTriangle])
+            {
+                ++nextTriangle;
+            }
+            bestTriangle = nextTriangle;
+        }
+
+        emitted[bestTriangle] = true;
+        const unsigned int* triangleIndices = &indices[bestTriangle * 3];
+        optimizedIndices.insert(optimizedIndices.end(), triangleIndices, triangleIndices + 3);
+
+        // The triangle is not live anymore for its vertices
+        unsigned int newCacheCount = 0;
+        for (unsigned int corner = 0; corner < 3; ++corner)
+        {
+            unsigned int vertex = triangleIndices[corner];
+            unsigned int* triangles = &adjacency[adjacencyOffsets[vertex]];
+            unsigned int& count = remainingTriangles[vertex];
+            unsigned int* itTriangle = std::find(triangles, triangles + count, bestTriangle);
+            assert(itTriangle != triangles + count);
+            std::swap(*itTriangle, triangles[count - 1]);
+            --count;
+
+            // Degenerate triangles repeat vertices
+            if (std::find(newCache.begin(), newCache.begin() + newCacheCount, vertex) == newCache.begin() + newCacheCount)
+            {
+                newCache[newCacheCount++] = vertex;
+            }
+        }
+
+        // Vertices of the triangle move to the front of the cache
+        unsigned int triangleVertexCount = newCacheCount;
+        for (unsigned int i = 0; i < cacheCount; ++i)
+        {
+            unsigned int vertex = cache[i];
+            if (std::find(newCache.begin(), newCache.begin() + triangleVertexCount, vertex) == newCache.begin() + triangleVertexCount)
+            {
+                newCache[newCacheCount++] = vertex;
+            }
+        }
+
+        // Update the scores of the vertices in the cache, and the evicted ones
+        for (unsigned int i = 0; i < newCacheCount; ++i)
+        {
+            unsigned int vertex = newCache[i];
+            int cachePosition = i < ScoringCacheSize ? static_cast<int>(i) : -1;
+
+            float score = getScore(cachePosition, remainingTriangles[vertex]);
+            float scoreDelta = score - vertexScores[vertex];
+            vertexScores[vertex] = score;
+
+            const unsigned int* triangles = &adjacency[adjacencyOffsets[vertex]];
+            for (unsigned int j = 0; j < remainingTriangles[vertex]; ++j)
+            {
+                triangleScores[triangles[j]] += scoreDelta;
+            }
+        }
+
+        cacheCount = std::min(newCacheCount, ScoringCacheSize);
+        std::copy(newCache.begin(), newCache.begin() + cacheCount, cache.begin());
+
+        // The next triangle is the best one using the vertices in the cache
+        bestTriangle = ~0u;
+        float bestScore = -1.0f;
+        for (unsigned int i = 0; i < cacheCount; ++i)
+        {
+            unsigned int vertex = cache[i];
+            const unsigned int* triangles = &adjacency[adjacencyOffsets[vertex]];
+            for (unsigned int j = 0; j < remainingTriangles[vertex]; ++j)
+            {
+                if (triangleScores[triangles[j]] > bestScore)
+                {
+                    bestScore = triangleScores[triangles[j]];
+                    bestTriangle = triangles[j];
+                }
+            }
+        }
+    }
+
+    std::copy(optimizedIndices.begin(), optimizedIndices.end(), indices.begin());
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::span<unsigned int> indices, std::span<const std::byte> vertexData, size_t vertexSize, size_t positionOffset,
+    float threshold)
+{
+    assert(indices.size() % 3 == 0);
+    assert(positionOffset + sizeof(glm::vec3) <= vertexSize);
+    unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+    unsigned int vertexCount = static_cast<unsigned int>(vertexData.size() / vertexSize);
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Hard boundaries: triangles where the cache starts again, with all their vertices missing
+    std::vector<unsigned int> hardClusters;
+    {
+        FifoCache cache(vertexCount, ClusterCacheSize);
+        for (unsigned int triangle = 0; triangle < triangleCount; ++triangle)
+        {
+            unsigned int missCount = 0;
+            for (unsigned int corner = 0; corner < 3; ++corner)
+            {
+                missCount += cache.Access(indices[triangle * 3 + corner]);
+            }
+            if (missCount == 3 || triangle == 0)
+            {
+                hardClusters.push_back(triangle);
+            }
+        }
+        hardClusters.push_back(triangleCount);
+    }
+
+    // Soft boundaries: split the hard clusters where starting again doesn't make the ACMR worse than the threshold
+    std::vector<unsigned int> clusters;
+    {
+        FifoCache cache(vertexCount, ClusterCacheSize);
+        for (size_t i = 0; i + 1 < hardClusters.size(); ++i)
+        {
+            unsigned int start = hardClusters[i];
+            unsigned int end = hardClusters[i + 1];
+
+            cache.Reset();
+            unsigned int clusterMissCount = 0;
+            for (unsigned int index = start * 3; index < end * 3; ++index)
+            {
+                clusterMissCount += cache.Access(indices[index]);
+            }
+            float clusterACMR = static_cast<float>(clusterMissCount) / (end - start);
+
+            cache.Reset();
+            clusters.push_back(start);
+            unsigned int missCount = 0;
+            unsigned int clusterStart = start;
+            for (unsigned int triangle = start; triangle < end; ++triangle)
+            {
+                for (unsigned int corner = 0; corner < 3; ++corner)
+                {
+                    missCount += cache.Access(indices[triangle * 3 + corner]);
+                }
+
+                float acmr = static_cast<float>(missCount) / (triangle + 1 - clusterStart);
+                if (triangle + 1 < end && acmr <= clusterACMR * threshold)
+                {
+                    clusters.push_back(triangle + 1);
+                    clusterStart = triangle + 1;
+                    missCount = 0;
+                    cache.Reset();
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+    }
+
+    // Center of the mesh, weighted by the area of the triangles
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    std::vector<glm::vec3> triangleNormals(triangleCount);
+    std::vector<glm::vec3> triangleCenters(triangleCount);
+    for (unsigned int triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        glm::vec3 p0 = GetPosition(vertexData, vertexSize, positionOffset, indices[triangle * 3]);
+        glm::vec3 p1 = GetPosition(vertexData, vertexSize, positionOffset, indices[triangle * 3 + 1]);
+        glm::vec3 p2 = GetPosition(vertexData, vertexSize, positionOffset, indices[triangle * 3 + 2]);
+
+        // Length is twice the area
+        triangleNormals[triangle] = glm::cross(p1 - p0, p2 - p0);
+        triangleCenters[triangle] = (p0 + p1 + p2) / 3.0f;
+
+        float area = glm::length(triangleNormals[triangle]);
+        meshCenter += triangleCenters[triangle] * area;
+        meshArea += area;
+    }
+    meshCenter = meshArea > 0.0f ? meshCenter / meshArea : meshCenter;
+
+    // Clusters that face away from the center are on the outside of the mesh, and should be drawn first
+    unsigned int clusterCount = static_cast<unsigned int>(clusters.size() - 1);
+    std::vector<float> clusterScores(clusterCount);
+    for (unsigned int cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        glm::vec3 center(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (unsigned int triangle = clusters[cluster]; triangle < clusters[cluster + 1]; ++triangle)
+        {
+            float triangleArea = glm::length(triangleNormals[triangle]);
+            center += triangleCenters[triangle] * triangleArea;
+            normal += triangleNormals[triangle];
+            area += triangleArea;
+        }
+        center = area > 0.0f ? center / area : center;
+        float normalLength = glm::length(normal);
+        clusterScores[cluster] = normalLength > 0.0f ? glm::dot(center - meshCenter, normal / normalLength) : 0.0f;
+    }
+
+    std::vector<unsigned int> clusterOrder(clusterCount);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(),
+        [&](unsigned int a, unsigned int b) { return clusterScores[a] > clusterScores[b]; });
+
+    std::vector<unsigned int> sortedIndices;
+    sortedIndices.reserve(indices.size());
+    for (unsigned int cluster : clusterOrder)
+    {
+        sortedIndices.insert(sortedIndices.end(), indices.begin() + clusters[cluster] * 3, indices.begin() + clusters[cluster + 1] * 3);
+    }
+    std::copy(sortedIndices.begin(), sortedIndices.end(), indices.begin());
+}
+
+unsigned int MeshOptimizer::OptimizeVertexFetch(std::span<unsigned int> indices, std::span<std::byte> vertexData, size_t vertexSize)
+{
+    unsigned int vertexCount = static_cast<unsigned int>(vertexData.size() / vertexSize);
+    std::vector<unsigned int> remap(vertexCount);
+    unsigned int usedCount = GetVertexFetchRemap(indices, remap);
+
+    // Unused vertices keep their order after the used ones
+    unsigned int unusedIndex = usedCount;
+    std::vector<std::byte> reorderedData(vertexCount * vertexSize);
+    for (unsigned int vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        unsigned int newIndex = remap[vertex] != ~0u ? remap[vertex] : unusedIndex++;
+        std::memcpy(&reorderedData[newIndex * vertexSize], &vertexData[vertex * vertexSize], vertexSize);
+    }
+    for (unsigned int& index : indices)
+    {
+        index = remap[index];
+    }
+    std::copy(reorderedData.begin(), reorderedData.end(), vertexData.begin());
+    return usedCount;
+}
+
+unsigned int MeshOptimizer::Optimize(std::span<unsigned int> indices, std::span<std::byte> vertexData, size_t vertexSize, size_t positionOffset)
+{
+    OptimizeVertexCache(indices, static_cast<unsigned int>(vertexData.size() / vertexSize));
+    OptimizeOverdraw(indices, vertexData, vertexSize, positionOffset);
+    return OptimizeVertexFetch(indices, vertexData, vertexSize);
+}
+
+unsigned int MeshOptimizer::GetVertexFetchRemap(std::span<const unsigned int> indices, std::vector<unsigned int>& remap)
+{
+    std::fill(remap.begin(), remap.end(), ~0u);
+    unsigned int usedCount = 0;
+    for (unsigned int index : indices)
+    {
+        if (remap[index] == ~0u)
+        {
+            remap[index] = usedCount++;
+        }
+    }
+    return usedCount;
+}
@@ -7,6 +7,11 @@ Model::Model(std::shared_ptr<Mesh> mesh) : m_mesh(mesh)
 {
 }
 
+bool Model::HasMesh() const
+{
+    return m_mesh != nullptr;
+}
+
 Mesh& Model::GetMesh()
 {
     return *m_mesh;
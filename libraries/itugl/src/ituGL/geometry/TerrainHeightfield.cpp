@@ -0,0 +1,439 @@
+#include <ituGL/geometry/TerrainHeightfield.h>
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
+// Pick the widest vector instruction set enabled in the compiler flags. AVX2 is needed for 8 lanes, for the gathers
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ITUGL_HEIGHTFIELD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ITUGL_HEIGHTFIELD_SSE
+#endif
+
+namespace
+{
+    // Sample index is computed in float in the vector path, exact up to 2^24
+    constexpr size_t MaxSampleCount = size_t(1) << 24;
+
+    inline float Lerp(float a, float b, float t)
+    {
+        return a + (b - a) * t;
+    }
+
+#if defined(ITUGL_HEIGHTFIELD_AVX2)
+    using FloatVector = __m256;
+    constexpr unsigned int VectorLanes = 8;
+    inline FloatVector VectorLoad(const float* data) { return _mm256_loadu_ps(data); }
+    inline void VectorStore(float* data, FloatVector a) { _mm256_storeu_ps(data, a); }
+    inline FloatVector VectorSplat(float value) { return _mm256_set1_ps(value); }
+    inline FloatVector VectorAdd(FloatVector a, FloatVector b) { return _mm256_add_ps(a, b); }
+    inline FloatVector VectorSub(FloatVector a, FloatVector b) { return _mm256_sub_ps(a, b); }
+    inline FloatVector VectorMul(FloatVector a, FloatVector b) { return _mm256_mul_ps(a, b); }
+    inline FloatVector VectorMin(FloatVector a, FloatVector b) { return _mm256_min_ps(a, b); }
+    inline FloatVector VectorMax(FloatVector a, FloatVector b) { return _mm256_max_ps(a, b); }
+    // Truncation, the same as floor for positive values
+    inline FloatVector VectorTruncate(FloatVector a) { return _mm256_cvtepi32_ps(_mm256_cvttps_epi32(a)); }
+
+    // Looks up the samples at the indices, and offset samples further
+    inline FloatVector Gather(const float* data, FloatVector indices, int offset)
+    {
+        return _mm256_i32gather_ps(data + offset, _mm256_cvttps_epi32(indices), 4);
+    }
+#elif defined(ITUGL_HEIGHTFIELD_SSE)
+    using FloatVector = __m128;
+    constexpr unsigned int VectorLanes = 4;
+    inline FloatVector VectorLoad(const float* data) { return _mm_loadu_ps(data); }
+    inline void VectorStore(float* data, FloatVector a) { _mm_storeu_ps(data, a); }
+    inline FloatVector VectorSplat(float value) { return _mm_set1_ps(value); }
+    inline FloatVector VectorAdd(FloatVector a, FloatVector b) { return _mm_add_ps(a, b); }
+    inline FloatVector VectorSub(FloatVector a, FloatVector b) { return _mm_sub_ps(a, b); }
+    inline FloatVector VectorMul(FloatVector a, FloatVector b) { return _mm_mul_ps(a, b); }
+    inline FloatVector VectorMin(FloatVector a, FloatVector b) { return _mm_min_ps(a, b); }
+    inline FloatVector VectorMax(FloatVector a, FloatVector b) { return _mm_max_ps(a, b); }
+    inline FloatVector VectorTruncate(FloatVector a) { return _mm_cvtepi32_ps(_mm_cvttps_epi32(a)); }
+
+    // SSE2 has no gathers, the lanes are looked up one by one
+    inline FloatVector Gather(const float* data, FloatVector indices, int offset)
+    {
+        alignas(16) std::int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_cvttps_epi32(indices));
+        data += offset;
+        return _mm_setr_ps(data[lanes[0]], data[lanes[1]], data[lanes[2]], data[lanes[3]]);
+    }
+#endif
+}
+
+TerrainHeightfield::TerrainHeightfield()
+    : m_width(0)
+    , m_height(0)
+    , m_spacing(1.0f)
+    , m_origin(0.0f)
+{
+}
+
+void TerrainHeightfield::Initialize(std::span<const float> heights, unsigned int width, unsigned int height, const glm::vec2& spacing,
+    const glm::vec2& origin)
+{
+    assert(width >= 2 && height >= 2);
+    assert(heights.size() == static_cast<size_t>(width) * height);
+    assert(heights.size() <= MaxSampleCount);
+    assert(spacing.x > 0.0f && spacing.y > 0.0f);
+
+    m_heights.assign(heights.begin(), heights.end());
+    m_width = width;
+    m_height = height;
+    m_spacing = spacing;
+    m_origin = origin;
+
+    BuildLevels();
+}
+
+void TerrainHeightfield::BuildLevels()
+{
+    m_levels.clear();
+
+    // Cells, with the range of their 4 corners. The bilinear surface doesn't leave that range
+    Level& cells = m_levels.emplace_back();
+    cells.width = m_width - 1;
+    cells.height = m_height - 1;
+    cells.minHeights.resize(cells.width * cells.height);
+    cells.maxHeights.resize(cells.width * cells.height);
+    for (unsigned int j = 0; j < cells.height; ++j)
+    {
+        for (unsigned int i = 0; i < cells.width; ++i)
+        {
+            const float* corners = &m_heights[j * m_width + i];
+            cells.minHeights[j * cells.width + i] = std::min(std::min(corners[0], corners[1]), std::min(corners[m_width], corners[m_width + 1]));
+            cells.maxHeights[j * cells.width + i] = std::max(std::max(corners[0], corners[1]), std::max(corners[m_width], corners[m_width + 1]));
+        }
+    }
+
+    // Each level halves the previous one, until a single node covers the whole grid
+    while (m_levels.back().width > 1 || m_levels.back().height > 1)
+    {
+        const Level& previous = m_levels.back();
+        Level level;
+        level.width = (previous.width + 1) / 2;
+        level.height = (previous.height + 1) / 2;
+        level.minHeights.assign(level.width * level.height, FLT_MAX);
+        level.maxHeights.assign(level.width * level.height, -FLT_MAX);
+        for (unsigned int j = 0; j < previous.height; ++j)
+        {
+            for (unsigned int i = 0; i < previous.width; ++i)
+            {
+                unsigned int index = (j / 2) * level.width + i / 2;
+                level.minHeights[index] = std::min(level.minHeights[index], previous.minHeights[j * previous.width + i]);
+                level.maxHeights[index] = std::max(level.maxHeights[index], previous.maxHeights[j * previous.width + i]);
+            }
+        }
+        m_levels.push_back(std::move(level));
+    }
+}
+
+glm::vec3 TerrainHeightfield::GetBoundsMin() const
+{
+    return glm::vec3(m_origin.x, m_levels.empty() ? 0.0f : m_levels.back().minHeights[0], m_origin.y);
+}
+
+glm::vec3 TerrainHeightfield::GetBoundsMax() const
+{
+    glm::vec2 extents = glm::vec2(m_width - 1, m_height - 1) * m_spacing;
+    return glm::vec3(m_origin.x + extents.x, m_levels.empty() ? 0.0f : m_levels.back().maxHeights[0], m_origin.y + extents.y);
+}
+
+bool TerrainHeightfield::Contains(float x, float z) const
+{
+    glm::vec3 boundsMin = GetBoundsMin();
+    glm::vec3 boundsMax = GetBoundsMax();
+    return x >= boundsMin.x && x <= boundsMax.x && z >= boundsMin.z && z <= boundsMax.z;
+}
+
+void TerrainHeightfield::GetCell(float x, float z, unsigned int& i, unsigned int& j, float& u, float& v) const
+{
+    assert(!m_heights.empty());
+
+    // Same operations as the vector path in SampleHeights
+    float gridX = std::min(std::max((x - m_origin.x) * (1.0f / m_spacing.x), 0.0f), static_cast<float>(m_width - 1));
+    float gridZ = std::min(std::max((z - m_origin.y) * (1.0f / m_spacing.y), 0.0f), static_cast<float>(m_height - 1));
+    float cellX = std::min(std::floor(gridX), static_cast<float>(m_width - 2));
+    float cellZ = std::min(std::floor(gridZ), static_cast<float>(m_height - 2));
+    i = static_cast<unsigned int>(cellX);
+    j = static_cast<unsigned int>(cellZ);
+    u = gridX - cellX;
+    v = gridZ - cellZ;
+}
+
+float TerrainHeightfield::SampleHeight(float x, float z) const
+{
+    unsigned int i, j;
+    float u, v;
+    GetCell(x, z, i, j, u, v);
+
+    const float* corners = &m_heights[j * m_width + i];
+    float height0 = Lerp(corners[0], corners[1], u);
+    float height1 = Lerp(corners[m_width], corners[m_width + 1], u);
+    return Lerp(height0, height1, v);
+}
+
+glm::vec3 TerrainHeightfield::SampleNormal(float x, float z) const
+{
+    unsigned int i, j;
+    float u, v;
+    GetCell(x, z, i, j, u, v);
+
+    // Gradient of the bilinear patch, the normal is (-dh/dx, 1, -dh/dz)
+    const float* corners = &m_heights[j * m_width + i];
+    float slopeX = Lerp(corners[1] - corners[0], corners[m_width + 1] - corners[m_width], v) / m_spacing.x;
+    float slopeZ = Lerp(corners[m_width] - corners[0], corners[m_width + 1] - corners[1], u) / m_spacing.y;
+    return glm::normalize(glm::vec3(-slopeX, 1.0f, -slopeZ));
+}
+
+void TerrainHeightfield::SampleHeights(std::span<const float> x, std::span<const float> z, std::span<float> heights) const
+{
+    SampleHeights(x, z, heights, false);
+}
+
+void TerrainHeightfield::SampleHeightsReference(std::span<const float> x, std::span<const float> z, std::span<float> heights) const
+{
+    SampleHeights(x, z, heights, true);
+}
+
+void TerrainHeightfield::SampleHeights(std::span<const float> x, std::span<const float> z, std::span<float> heights, bool reference) const
+{
+    assert(x.size() == z.size() && heights.size() == x.size());
+
+    size_t i = 0;
+#if defined(ITUGL_HEIGHTFIELD_AVX2) || defined(ITUGL_HEIGHTFIELD_SSE)
+    if (!reference)
+    {
+        FloatVector originX = VectorSplat(m_origin.x);
+        FloatVector originZ = VectorSplat(m_origin.y);
+        FloatVector inverseSpacingX = VectorSplat(1.0f / m_spacing.x);
+        FloatVector inverseSpacingZ = VectorSplat(1.0f / m_spacing.y);
+        FloatVector zero = VectorSplat(0.0f);
+        FloatVector lastX = VectorSplat(static_cast<float>(m_width - 1));
+        FloatVector lastZ = VectorSplat(static_cast<float>(m_height - 1));
+        FloatVector lastCellX = VectorSplat(static_cast<float>(m_width - 2));
+        FloatVector lastCellZ = VectorSplat(static_cast<float>(m_height - 2));
+        FloatVector width = VectorSplat(static_cast<float>(m_width));
+        int rowOffset = static_cast<int>(m_width);
+        const float* data = m_heights.data();
+
+        for (; i + VectorLanes <= x.size(); i += VectorLanes)
+        {
+            // Same as GetCell. Grid coordinates are clamped to positive values, where truncation is floor
+            FloatVector gridX = VectorMin(VectorMax(VectorMul(VectorSub(VectorLoad(&x[i]), originX), inverseSpacingX), zero), lastX);
+            FloatVector gridZ = VectorMin(VectorMax(VectorMul(VectorSub(VectorLoad(&z[i]), originZ), inverseSpacingZ), zero), lastZ);
+            FloatVector cellX = VectorMin(VectorTruncate(gridX), lastCellX);
+            FloatVector cellZ = VectorMin(VectorTruncate(gridZ), lastCellZ);
+            FloatVector u = VectorSub(gridX, cellX);
+            FloatVector v = VectorSub(gridZ, cellZ);
+
+            FloatVector indices = VectorAdd(VectorMul(cellZ, width), cellX);
+            FloatVector height00 = Gather(data, indices, 0);
+            FloatVector height10 = Gather(data, indices, 1);
+            FloatVector height01 = Gather(data, indices, rowOffset);
+            FloatVector height11 = Gather(data, indices, rowOffset + 1);
+
+            FloatVector height0 = VectorAdd(height00, VectorMul(VectorSub(height10, height00), u));
+            FloatVector height1 = VectorAdd(height01, VectorMul(VectorSub(height11, height01), u));
+            VectorStore(&heights[i], VectorAdd(height0, VectorMul(VectorSub(height1, height0), v)));
+        }
+    }
+#endif
+    (void)reference;
+    for (; i < x.size(); ++i)
+    {
+        heights[i] = SampleHeight(x[i], z[i]);
+    }
+}
+
+bool TerrainHeightfield::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& hit) const
+{
+    if (m_levels.empty())
+    {
+        return false;
+    }
+
+    glm::vec3 inverseDirection = 1.0f / direction;
+
+    // Children are visited front to back, so the first hit is the closest one
+    // With the ray going towards +x, the node at -x is entered first. A ray goes through only one of the 2 nodes in the diagonal
+    unsigned int nearX = direction.x >= 0.0f ? 0 : 1;
+    unsigned int nearZ = direction.z >= 0.0f ? 0 : 1;
+
+    struct Node
+    {
+        unsigned int level;
+        unsigned int x;
+        unsigned int y;
+    };
+    std::vector<Node> stack;
+    stack.push_back(Node{ static_cast<unsigned int>(m_levels.size() - 1), 0, 0 });
+    while (!stack.empty())
+    {
+        Node node = stack.back();
+        stack.pop_back();
+
+        const Level& level = m_levels[node.level];
+        unsigned int index = node.y * level.width + node.x;
+
+        // Cells covered by the node, the last nodes can cover less
+        unsigned int firstCellX = node.x << node.level;
+        unsigned int firstCellY = node.y << node.level;
+        unsigned int lastCellX = std::min((node.x + 1) << node.level, m_width - 1);
+        unsigned int lastCellY = std::min((node.y + 1) << node.level, m_height - 1);
+        glm::vec3 boxMin(m_origin.x + firstCellX * m_spacing.x, level.minHeights[index], m_origin.y + firstCellY * m_spacing.y);
+        glm::vec3 boxMax(m_origin.x + lastCellX * m_spacing.x, level.maxHeights[index], m_origin.y + lastCellY * m_spacing.y);
+
+        float tEnter, tExit;
+        if (!IntersectBox(boxMin, boxMax, origin, inverseDirection, 0.0f, maxDistance, tEnter, tExit))
+        {
+            continue;
+        }
+
+        if (node.level == 0)
+        {
+            if (IntersectCell(node.x, node.y, origin, direction, tEnter, tExit, hit))
+            {
+                return true;
+            }
+            continue;
+        }
+
+        // Push in reverse order, so the nearest child is on top
+        const Level& childLevel = m_levels[node.level - 1];
+        for (int child = 3; child >= 0; --child)
+        {
+            unsigned int childX = 2 * node.x + ((child & 1) ^ nearX);
+            unsigned int childY = 2 * node.y + ((child >> 1) ^ nearZ);
+            if (childX < childLevel.width && childY < childLevel.height)
+            {
+                stack.push_back(Node{ node.level - 1, childX, childY });
+            }
+        }
+    }
+    return false;
+}
+
+bool TerrainHeightfield::RaycastReference(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& hit) const
+{
+    if (m_levels.empty())
+    {
+        return false;
+    }
+
+    glm::vec3 inverseDirection = 1.0f / direction;
+    const Level& cells = m_levels[0];
+
+    bool found = false;
+    float closestDistance = maxDistance;
+    for (unsigned int j = 0; j < cells.height; ++j)
+    {
+        for (unsigned int i = 0; i < cells.width; ++i)
+        {
+            unsigned int index = j * cells.width + i;
+            glm::vec3 boxMin(m_origin.x + i * m_spacing.x, cells.minHeights[index], m_origin.y + j * m_spacing.y);
+            glm::vec3 boxMax(m_origin.x + (i + 1) * m_spacing.x, cells.maxHeights[index], m_origin.y + (j + 1) * m_spacing.y);
+
+            float tEnter, tExit;
+            RayHit cellHit;
+            if (IntersectBox(boxMin, boxMax, origin, inverseDirection, 0.0f, maxDistance, tEnter, tExit)
+                && IntersectCell(i, j, origin, direction, tEnter, tExit, cellHit) && cellHit.distance < closestDistance)
+            {
+                closestDistance = cellHit.distance;
+                hit = cellHit;
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+bool TerrainHeightfield::IntersectBox(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec3& origin, const glm::vec3& inverseDirection,
+    float tMin, float tMax, float& tEnter, float& tExit)
+{
+    // Slab test. Axes where the direction is 0 give infinite distances, and the ray is inside the slab or misses it
+    glm::vec3 t0 = (boxMin - origin) * inverseDirection;
+    glm::vec3 t1 = (boxMax - origin) * inverseDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    tEnter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, tMin));
+    tExit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    return tEnter <= tExit;
+}
+
+bool TerrainHeightfield::IntersectCell(unsigned int i, unsigned int j, const glm::vec3& origin, const glm::vec3& direction,
+    float tMin, float tMax, RayHit& hit) const
+{
+    const float* corners = &m_heights[j * m_width + i];
+    float height00 = corners[0];
+    float height10 = corners[1];
+    float height01 = corners[m_width];
+    float height11 = corners[m_width + 1];
+
+    // Ray from the entry point, in the coordinates of the cell: u and v in [0, 1]
+    glm::vec3 entry = origin + direction * tMin;
+    float u0 = (entry.x - (m_origin.x + i * m_spacing.x)) / m_spacing.x;
+    float v0 = (entry.z - (m_origin.y + j * m_spacing.y)) / m_spacing.y;
+    float du = direction.x / m_spacing.x;
+    float dv = direction.z / m_spacing.y;
+
+    // The patch is h = a + b u + c v + d u v. Along the ray, h - y is a quadratic in t
+    float a = height00;
+    float b = height10 - height00;
+    float c = height01 - height00;
+    float d = height00 - height10 - height01 + height11;
+    float qa = d * du * dv;
+    float qb = b * du + c * dv + d * (u0 * dv + v0 * du) - direction.y;
+    float qc = a + b * u0 + c * v0 + d * u0 * v0 - entry.y;
+
+    // The hit is the first point on or below the surface
+    float t = -1.0f;
+    float length = tMax - tMin;
+    if (qc >= 0.0f)
+    {
+        t = 0.0f;
+    }
+    else
+    {
+        float discriminant = qb * qb - 4.0f * qa * qc;
+        if (discriminant < 0.0f)
+        {
+            return false;
+        }
+
+        // Roots without cancellation. With qa = 0 only the first one is valid, the linear root
+        float q = -0.5f * (qb + std::copysign(std::sqrt(discriminant), qb));
+        float roots[2] = { q != 0.0f ? qc / q : -1.0f, qa != 0.0f ? q / qa : -1.0f };
+        for (float root : roots)
+        {
+            if (root >= 0.0f && root <= length && (t < 0.0f || root < t))
+            {
+                t = root;
+            }
+        }
+        if (t < 0.0f)
+        {
+            return false;
+        }
+    }
+
+    hit.distance = tMin + t;
+    hit.position = origin + direction * hit.distance;
+
+    // Normal of the patch at the hit, as in SampleNormal
+    float u = std::clamp(u0 + du * t, 0.0f, 1.0f);
+    float v = std::clamp(v0 + dv * t, 0.0f, 1.0f);
+    float slopeX = Lerp(height10 - height00, height11 - height01, v) / m_spacing.x;
+    float slopeZ = Lerp(height01 - height00, height11 - height10, u) / m_spacing.y;
+    hit.normal = glm::normalize(glm::vec3(-slopeX, 1.0f, -slopeZ));
+    return true;
+}
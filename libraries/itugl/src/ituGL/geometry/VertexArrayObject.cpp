@@ -74,3 +74,11 @@ void VertexArrayObject::SetAttribute(GLuint location, const VertexAttribute& att
     // Finally, we enable the VertexAttribute in this location
     glEnableVertexAttribArray(location);
 }
+
+// Sets the divisor of the VertexAttribute in that location, for instanced drawcalls
+void VertexArrayObject::SetAttributeDivisor(GLuint location, GLuint divisor)
+{
+    assert(IsBound());
+
+    glVertexAttribDivisor(location, divisor);
+}
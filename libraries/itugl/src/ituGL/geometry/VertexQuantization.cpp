@@ -0,0 +1,149 @@
+#include <ituGL/geometry/VertexQuantization.h>
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace
+{
+    float GetAngleDegrees(float dot)
+    {
+        return std::acos(std::clamp(dot, -1.0f, 1.0f)) * 180.0f / std::numbers::pi_v<float>;
+    }
+
+    float GetDirectionDot(const glm::vec3& direction, const glm::vec3& quantizedDirection)
+    {
+        float length = glm::length(direction) * glm::length(quantizedDirection);
+        return length > 0.0f ? glm::dot(direction, quantizedDirection) / length : 1.0f;
+    }
+
+    // Signed normalized integer with the given bits, as stored in GL_INT_2_10_10_10_REV
+    std::uint32_t PackSnorm(float value, unsigned int bits)
+    {
+        float maxValue = static_cast<float>((1 << (bits - 1)) - 1);
+        int quantized = static_cast<int>(std::round(std::clamp(value, -1.0f, 1.0f) * maxValue));
+        return static_cast<std::uint32_t>(quantized) & ((1u << bits) - 1);
+    }
+
+    float UnpackSnorm(std::uint32_t value, unsigned int bits)
+    {
+        // Sign extend, then the same conversion as OpenGL 4.2+: max(c / maxValue, -1)
+        int shift = 32 - bits;
+        int quantized = static_cast<int>(value << shift) >> shift;
+        float maxValue = static_cast<float>((1 << (bits - 1)) - 1);
+        return std::max(quantized / maxValue, -1.0f);
+    }
+}
+
+VertexQuantization::QualityReport::QualityReport()
+    : m_maxPositionError(0.0f)
+    , m_minNormalDot(1.0f)
+    , m_minTangentDot(1.0f)
+    , m_maxTexCoordError(0.0f)
+    , m_sourceSize(0)
+    , m_quantizedSize(0)
+{
+}
+
+void VertexQuantization::QualityReport::AddPosition(const glm::vec3& position, const glm::vec3& quantizedPosition)
+{
+    m_maxPositionError = std::max(m_maxPositionError, glm::length(quantizedPosition - position));
+}
+
+void VertexQuantization::QualityReport::AddNormal(const glm::vec3& normal, const glm::vec3& quantizedNormal)
+{
+    m_minNormalDot = std::min(m_minNormalDot, GetDirectionDot(normal, quantizedNormal));
+}
+
+void VertexQuantization::QualityReport::AddTangent(const glm::vec3& tangent, const glm::vec3& quantizedTangent)
+{
+    m_minTangentDot = std::min(m_minTangentDot, GetDirectionDot(tangent, quantizedTangent));
+}
+
+void VertexQuantization::QualityReport::AddTexCoord(const glm::vec2& texCoord, const glm::vec2& quantizedTexCoord)
+{
+    glm::vec2 error = glm::abs(quantizedTexCoord - texCoord);
+    m_maxTexCoordError = std::max(m_maxTexCoordError, std::max(error.x, error.y));
+}
+
+void VertexQuantization::QualityReport::AddVertexData(size_t sourceSize, size_t quantizedSize)
+{
+    m_sourceSize += sourceSize;
+    m_quantizedSize += quantizedSize;
+}
+
+void VertexQuantization::QualityReport::Merge(const QualityReport& report)
+{
+    m_maxPositionError = std::max(m_maxPositionError, report.m_maxPositionError);
+    m_minNormalDot = std::min(m_minNormalDot, report.m_minNormalDot);
+    m_minTangentDot = std::min(m_minTangentDot, report.m_minTangentDot);
+    m_maxTexCoordError = std::max(m_maxTexCoordError, report.m_maxTexCoordError);
+    m_sourceSize += report.m_sourceSize;
+    m_quantizedSize += report.m_quantizedSize;
+}
+
+float VertexQuantization::QualityReport::GetMaxNormalError() const
+{
+    return GetAngleDegrees(m_minNormalDot);
+}
+
+float VertexQuantization::QualityReport::GetMaxTangentError() const
+{
+    return GetAngleDegrees(m_minTangentDot);
+}
+
+float VertexQuantization::QualityReport::GetSizeRatio() const
+{
+    return m_sourceSize > 0 ? static_cast<float>(m_quantizedSize) / m_sourceSize : 1.0f;
+}
+
+VertexQuantization::PositionTransform VertexQuantization::GetPositionTransform(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+    glm::vec3 halfExtents = (boundsMax - boundsMin) * 0.5f;
+    float scale = std::max(halfExtents.x, std::max(halfExtents.y, halfExtents.z));
+    return PositionTransform{ (boundsMin + boundsMax) * 0.5f, scale > 0.0f ? scale : 1.0f };
+}
+
+glm::i16vec4 VertexQuantization::QuantizePosition(const glm::vec3& position, const PositionTransform& transform)
+{
+    glm::vec3 normalized = glm::clamp((position - transform.offset) / transform.scale, -1.0f, 1.0f);
+    glm::vec3 quantized = glm::round(normalized * 32767.0f);
+    return glm::i16vec4(quantized.x, quantized.y, quantized.z, 32767);
+}
+
+glm::vec3 VertexQuantization::DequantizePosition(const glm::i16vec4& quantizedPosition, const PositionTransform& transform)
+{
+    glm::vec3 normalized = glm::max(glm::vec3(quantizedPosition) / 32767.0f, -1.0f);
+    return transform.offset + normalized * transform.scale;
+}
+
+std::uint32_t VertexQuantization::QuantizeDirection(const glm::vec3& direction, float w)
+{
+    float length = glm::length(direction);
+    glm::vec3 normalized = length > 0.0f ? direction / length : direction;
+    return PackSnorm(normalized.x, 10) | (PackSnorm(normalized.y, 10) << 10) | (PackSnorm(normalized.z, 10) << 20) | (PackSnorm(w, 2) << 30);
+}
+
+glm::vec4 VertexQuantization::DequantizeDirection(std::uint32_t quantizedDirection)
+{
+    return glm::vec4(UnpackSnorm(quantizedDirection, 10), UnpackSnorm(quantizedDirection >> 10, 10),
+        UnpackSnorm(quantizedDirection >> 20, 10), UnpackSnorm(quantizedDirection >> 30, 2));
+}
+
+glm::u16vec2 VertexQuantization::QuantizeTexCoord(const glm::vec2& texCoord)
+{
+    return glm::u16vec2(glm::packHalf1x16(texCoord.x), glm::packHalf1x16(texCoord.y));
+}
+
+glm::vec2 VertexQuantization::DequantizeTexCoord(const glm::u16vec2& quantizedTexCoord)
+{
+    return glm::vec2(glm::unpackHalf1x16(quantizedTexCoord.x), glm::unpackHalf1x16(quantizedTexCoord.y));
+}
+
+float VertexQuantization::GetBitangentSign(const glm::vec3& normal, const glm::vec3& tangent, const glm::vec3& bitangent)
+{
+    return glm::dot(glm::cross(normal, tangent), bitangent) < 0.0f ? -1.0f : 1.0f;
+}
@@ -4,30 +4,28 @@
 #include <ituGL/renderer/Renderer.h>
 #include <ituGL/shader/Shader.h>
 #include <ituGL/geometry/VertexAttribute.h>
+#include <ituGL/asset/VirtualFileSystem.h>
 #include <vector>
 #include <iostream>
 #include <cassert>
 #include <array>
-#include <fstream>
-#include <sstream>
 
 void LoadAndCompileShader(Shader& shader, const char* path)
 {
     // Open the file for reading
-    std::ifstream file(path);
-    if (!file.is_open())
+    VirtualFile file;
+    if (!VirtualFileSystem::GetDefault().Open(path, file))
     {
         std::cout << "Can't find file: " << path << std::endl;
         std::cout << "Is your working directory properly set?" << std::endl;
         return;
     }
 
-    // Dump the contents into a string
-    std::stringstream stringStream;
-    stringStream << file.rdbuf() << '\0';
+    // Copy the contents into a string, to terminate it
+    std::string source(file.GetText());
 
     // Set the source code from the string
-    shader.SetSource(stringStream.str().c_str());
+    shader.SetSource(source.c_str());
 
     // Try to compile
     if (!shader.Compile())
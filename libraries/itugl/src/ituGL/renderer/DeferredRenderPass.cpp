@@ -24,8 +24,7 @@ void DeferredRenderPass::Render()
     const Camera& camera = renderer.GetCurrentCamera();
 
     assert(m_material);
-    m_material->Use();
-    std::shared_ptr<const ShaderProgram> shaderProgram = m_material->GetShaderProgram();
+    std::shared_ptr<const ShaderProgram> shaderProgram;
 
     // Our fullscreen triangle is directly in clip coordinates.
     // Use the inverse view proj matrix to cancel view projection from the camera
@@ -34,9 +33,23 @@ void DeferredRenderPass::Render()
     bool first = true;
     unsigned int lightIndex = 0;
     const auto& lights = renderer.GetLights();
-    while (renderer.UpdateLights(shaderProgram, lights, lightIndex))
+    while (true)
     {
-        const Light* light = lightIndex <= lights.size() ? lights[lightIndex - 1] : nullptr;
+        const Light* light = lightIndex < lights.size() ? lights[lightIndex] : nullptr;
+
+        // Each light uses the shader variant without the features it doesn't need
+        ShaderProgramVariants::KeywordMask keywords = Renderer::GetLightKeywords(*m_material, light, first);
+        std::shared_ptr<const ShaderProgram> lightShaderProgram = m_material->GetShaderProgramVariant(keywords);
+        if (lightShaderProgram != shaderProgram)
+        {
+            m_material->UseVariant(keywords);
+            shaderProgram = lightShaderProgram;
+        }
+
+        if (!renderer.UpdateLights(shaderProgram, lights, lightIndex))
+        {
+            break;
+        }
         assert(first || light);
 
         const Mesh* mesh = &renderer.GetFullscreenMesh();
@@ -29,7 +29,7 @@ void ForwardRenderPass::Render()
         // Prepare drawcall states
         renderer.PrepareDrawcall(drawcallInfo);
 
-        std::shared_ptr<const ShaderProgram> shaderProgram = drawcallInfo.material.GetShaderProgram();
+        std::shared_ptr<const ShaderProgram> shaderProgram = drawcallInfo.material.GetShaderProgramVariant();
 
         //for all lights
         bool first = true;
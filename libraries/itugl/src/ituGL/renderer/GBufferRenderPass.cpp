@@ -7,10 +7,10 @@
 #include <ituGL/texture/Texture2DObject.h>
 #include <ituGL/texture/FramebufferObject.h>
 
-GBufferRenderPass::GBufferRenderPass(int width, int height, int drawcallCollectionIndex)
+GBufferRenderPass::GBufferRenderPass(int width, int height, int drawcallCollectionIndex, bool velocityEnabled)
     : m_drawcallCollectionIndex(drawcallCollectionIndex)
 {
-    InitTextures(width, height);
+    InitTextures(width, height, velocityEnabled);
     InitFramebuffer();
 }
 
@@ -32,19 +32,35 @@ void GBufferRenderPass::InitFramebuffer()
     targetFramebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color2, *m_othersTexture);
 
     // Set the draw buffers used by the framebuffer (all attachments except depth)
-    targetFramebuffer->SetDrawBuffers(std::array<FramebufferObject::Attachment, 3>(
-        {
-            FramebufferObject::Attachment::Color0,
-            FramebufferObject::Attachment::Color1,
-            FramebufferObject::Attachment::Color2
-        }));
+    if (m_velocityTexture)
+    {
+        // Set the velocity texture as color attachment 3
+        targetFramebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color3, *m_velocityTexture);
+
+        targetFramebuffer->SetDrawBuffers(std::array<FramebufferObject::Attachment, 4>(
+            {
+                FramebufferObject::Attachment::Color0,
+                FramebufferObject::Attachment::Color1,
+                FramebufferObject::Attachment::Color2,
+                FramebufferObject::Attachment::Color3
+            }));
+    }
+    else
+    {
+        targetFramebuffer->SetDrawBuffers(std::array<FramebufferObject::Attachment, 3>(
+            {
+                FramebufferObject::Attachment::Color0,
+                FramebufferObject::Attachment::Color1,
+                FramebufferObject::Attachment::Color2
+            }));
+    }
 
     m_targetFramebuffer = targetFramebuffer;
 
     FramebufferObject::Unbind();
 }
 
-void GBufferRenderPass::InitTextures(int width, int height)
+void GBufferRenderPass::InitTextures(int width, int height, bool velocityEnabled)
 {
     // Depth: Set the min and magfilter as nearest
     m_depthTexture = std::make_shared<Texture2DObject>();
@@ -74,6 +90,16 @@ void GBufferRenderPass::InitTextures(int width, int height)
     m_othersTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST);
     m_othersTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
 
+    // Velocity: Optional, signed motion in normalized device coordinates, so it needs a float format
+    if (velocityEnabled)
+    {
+        m_velocityTexture = std::make_shared<Texture2DObject>();
+        m_velocityTexture->Bind();
+        m_velocityTexture->SetImage(0, width, height, TextureObject::FormatRG, TextureObject::InternalFormatRG16F);
+        m_velocityTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST);
+        m_velocityTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
+    }
+
     Texture2DObject::Unbind();
 }
 
@@ -1,5 +1,6 @@
 #include <ituGL/renderer/Renderer.h>
 
+#include <ituGL/camera/Camera.h>
 #include <ituGL/shader/Material.h>
 #include <ituGL/geometry/VertexFormat.h>
 #include <ituGL/geometry/VertexArrayObject.h>
@@ -8,6 +9,7 @@
 #include <ituGL/geometry/Model.h>
 #include <ituGL/lighting/Light.h>
 #include <ituGL/texture/FramebufferObject.h>
+#include <ituGL/texture/TextureObject.h>
 #include <ituGL/renderer/RenderPass.h>
 #include <span>
 #include <algorithm>
@@ -18,6 +20,9 @@ Renderer::Renderer(DeviceGL& device)
     , m_currentCamera(nullptr)
     , m_defaultFramebuffer(FramebufferObject::GetDefault())
     , m_currentFramebuffer(m_defaultFramebuffer)
+    , m_viewProjMatrix(1.0f)
+    , m_previousViewProjMatrix(1.0f)
+    , m_hasPreviousFrame(false)
     , m_drawcallCollections(1)
 {
     InitializeFullscreenMesh();
@@ -76,6 +81,13 @@ void Renderer::Render()
 {
     assert(m_currentCamera);
 
+    // Passes can change the current camera, so keep the matrix of the main camera
+    m_viewProjMatrix = m_currentCamera->GetViewProjectionMatrix();
+    if (!m_hasPreviousFrame)
+    {
+        m_previousViewProjMatrix = m_viewProjMatrix;
+    }
+
     for (auto& pass : m_passes)
     {
         SetCurrentFramebuffer(pass->GetTargetFramebuffer());
@@ -102,7 +114,26 @@ void Renderer::Reset()
         collection.clear();
     }
 
+    // This frame becomes the previous frame
+    m_previousObjectWorldMatrices.clear();
+    for (size_t i = 0; i < m_worldMatrices.size(); ++i)
+    {
+        if (m_worldMatrixObjectKeys[i] != NoObjectKey)
+        {
+            m_previousObjectWorldMatrices[m_worldMatrixObjectKeys[i]] = m_worldMatrices[i];
+        }
+    }
+
+    m_worldMatrices.clear();
+    m_previousWorldMatrices.clear();
+    m_worldMatrixObjectKeys.clear();
+    m_previousViewProjMatrix = m_viewProjMatrix;
+    m_hasPreviousFrame = true;
+
     m_currentCamera = nullptr;
+
+    // Textures can be bound outside the renderer until the next frame, like the ImGui ones
+    TextureObject::InvalidateUnitBindings();
 }
 
 int Renderer::AddRenderPass(std::unique_ptr<RenderPass> renderPass)
@@ -134,12 +165,29 @@ void Renderer::RegisterShaderProgram(std::shared_ptr<const ShaderProgram> shader
     {
         m_updateLightsFunctions[shaderProgramPtr] = updateLightsFunction;
     }
+
+    // Programs that need the previous frame transform declare this uniform
+    ShaderProgram::Location previousTransformLocation = shaderProgramPtr->GetUniformLocation("PrevWorldViewProjMatrix");
+    if (previousTransformLocation >= 0)
+    {
+        m_previousTransformLocations[shaderProgramPtr] = previousTransformLocation;
+    }
+    else
+    {
+        // The program may be registered again after it is rebuilt without the uniform
+        m_previousTransformLocations.erase(shaderProgramPtr);
+    }
 }
 
 void Renderer::UpdateTransforms(std::shared_ptr<const ShaderProgram> shaderProgramPtr, unsigned int worldMatrixIndex, bool cameraChanged) const
 {
-    const glm::mat4& worldMatrix = m_worldMatrices[worldMatrixIndex];
-    UpdateTransforms(shaderProgramPtr, worldMatrix);
+    const auto& itFind = m_updateTransformsFunctions.find(shaderProgramPtr);
+    if (itFind != m_updateTransformsFunctions.end())
+    {
+        itFind->second(*shaderProgramPtr, m_worldMatrices[worldMatrixIndex], *m_currentCamera, cameraChanged);
+    }
+
+    UpdatePreviousTransform(shaderProgramPtr, m_previousWorldMatrices[worldMatrixIndex]);
 }
 
 void Renderer::UpdateTransforms(std::shared_ptr<const ShaderProgram> shaderProgramPtr, const glm::mat4& worldMatrix, bool cameraChanged) const
@@ -149,6 +197,23 @@ void Renderer::UpdateTransforms(std::shared_ptr<const ShaderProgram> shaderProgr
     {
         itFind->second(*shaderProgramPtr, worldMatrix, *m_currentCamera, cameraChanged);
     }
+
+    // No history for matrices that are not registered, consider them static
+    UpdatePreviousTransform(shaderProgramPtr, worldMatrix);
+}
+
+void Renderer::UpdatePreviousTransform(std::shared_ptr<const ShaderProgram> shaderProgramPtr, const glm::mat4& previousWorldMatrix) const
+{
+    const auto& itFind = m_previousTransformLocations.find(shaderProgramPtr);
+    if (itFind != m_previousTransformLocations.end())
+    {
+        shaderProgramPtr->SetUniform(itFind->second, m_previousViewProjMatrix * previousWorldMatrix);
+    }
+}
+
+const glm::mat4& Renderer::GetPreviousWorldMatrix(unsigned int worldMatrixIndex) const
+{
+    return m_previousWorldMatrices[worldMatrixIndex];
 }
 
 Renderer::UpdateLightsFunction Renderer::GetDefaultUpdateLightsFunction(const ShaderProgram& shaderProgram)
@@ -226,15 +291,35 @@ std::span<const Renderer::DrawcallInfo> Renderer::GetDrawcalls(unsigned int coll
     return m_drawcallCollections[collectionIndex];
 }
 
-void Renderer::AddModel(const Model& model, const glm::mat4& worldMatrix)
+unsigned int Renderer::AddDrawcallCollection()
 {
-    unsigned int worldMatrixIndex = static_cast<unsigned int>(m_worldMatrices.size());
-    m_worldMatrices.push_back(worldMatrix);
+    unsigned int collectionIndex = GetDrawcallCollectionCount();
+    m_drawcallCollections.emplace_back();
+    return collectionIndex;
+}
+
+void Renderer::AddDrawcall(unsigned int collectionIndex, const DrawcallInfo& drawcallInfo)
+{
+    assert(collectionIndex < m_drawcallCollections.size());
+    assert(drawcallInfo.worldMatrixIndex < m_worldMatrices.size());
+    m_drawcallCollections[collectionIndex].push_back(drawcallInfo);
+}
+
+void Renderer::AddModel(const Model& model, const glm::mat4& worldMatrix, ObjectKey objectKey)
+{
+    unsigned int worldMatrixIndex = AddWorldMatrix(worldMatrix, objectKey);
 
     const Mesh& mesh = model.GetMesh();
     for (unsigned int submeshIndex = 0; submeshIndex < mesh.GetSubmeshCount(); ++submeshIndex)
     {
-        DrawcallInfo drawcallInfo(model.GetMaterial(submeshIndex), worldMatrixIndex,
+        // Quantized positions need their own matrix, to move them back to the model space
+        unsigned int submeshMatrixIndex = worldMatrixIndex;
+        if (mesh.HasSubmeshPositionTransform(submeshIndex))
+        {
+            submeshMatrixIndex = AddLocalMatrix(worldMatrixIndex, mesh.GetSubmeshPositionTransform(submeshIndex));
+        }
+
+        DrawcallInfo drawcallInfo(model.GetMaterial(submeshIndex), submeshMatrixIndex,
             mesh.GetSubmeshVertexArray(submeshIndex), mesh.GetSubmeshDrawcall(submeshIndex));
 
         for (DrawcallCollection& collection : m_drawcallCollections)
@@ -244,9 +329,110 @@ void Renderer::AddModel(const Model& model, const glm::mat4& worldMatrix)
     }
 }
 
+void Renderer::AddModel(DrawcallList& drawcallList, const Model& model, const glm::mat4& worldMatrix, ObjectKey objectKey) const
+{
+    // Reading the previous frame is safe from several threads, it only changes in Reset
+    const glm::mat4& previousWorldMatrix = FindPreviousWorldMatrix(objectKey, worldMatrix);
+
+    unsigned int worldMatrixIndex = static_cast<unsigned int>(drawcallList.worldMatrices.size());
+    drawcallList.worldMatrices.push_back(worldMatrix);
+    drawcallList.previousWorldMatrices.push_back(previousWorldMatrix);
+    drawcallList.objectKeys.push_back(objectKey);
+
+    const Mesh& mesh = model.GetMesh();
+    for (unsigned int submeshIndex = 0; submeshIndex < mesh.GetSubmeshCount(); ++submeshIndex)
+    {
+        unsigned int submeshMatrixIndex = worldMatrixIndex;
+        if (mesh.HasSubmeshPositionTransform(submeshIndex))
+        {
+            // Submeshes with the same position transform share the matrix
+            const glm::mat4& positionTransform = mesh.GetSubmeshPositionTransform(submeshIndex);
+            glm::mat4 submeshMatrix = worldMatrix * positionTransform;
+            submeshMatrixIndex = static_cast<unsigned int>(drawcallList.worldMatrices.size());
+            for (unsigned int index = worldMatrixIndex + 1; index < drawcallList.worldMatrices.size(); ++index)
+            {
+                if (drawcallList.worldMatrices[index] == submeshMatrix)
+                {
+                    submeshMatrixIndex = index;
+                    break;
+                }
+            }
+
+            if (submeshMatrixIndex == drawcallList.worldMatrices.size())
+            {
+                drawcallList.worldMatrices.push_back(submeshMatrix);
+                drawcallList.previousWorldMatrices.push_back(previousWorldMatrix * positionTransform);
+                drawcallList.objectKeys.push_back(NoObjectKey);
+            }
+        }
+
+        drawcallList.drawcalls.emplace_back(model.GetMaterial(submeshIndex), submeshMatrixIndex,
+            mesh.GetSubmeshVertexArray(submeshIndex), mesh.GetSubmeshDrawcall(submeshIndex));
+    }
+}
+
+void Renderer::AddDrawcalls(const DrawcallList& drawcallList)
+{
+    assert(drawcallList.worldMatrices.size() == drawcallList.previousWorldMatrices.size());
+    assert(drawcallList.worldMatrices.size() == drawcallList.objectKeys.size());
+
+    // The matrices are final, append them and offset the local world matrix indices to the end of the renderer list
+    unsigned int worldMatrixOffset = static_cast<unsigned int>(m_worldMatrices.size());
+    m_worldMatrices.insert(m_worldMatrices.end(), drawcallList.worldMatrices.begin(), drawcallList.worldMatrices.end());
+    m_previousWorldMatrices.insert(m_previousWorldMatrices.end(), drawcallList.previousWorldMatrices.begin(), drawcallList.previousWorldMatrices.end());
+    m_worldMatrixObjectKeys.insert(m_worldMatrixObjectKeys.end(), drawcallList.objectKeys.begin(), drawcallList.objectKeys.end());
+
+    for (DrawcallCollection& collection : m_drawcallCollections)
+    {
+        collection.reserve(collection.size() + drawcallList.drawcalls.size());
+        for (const DrawcallInfo& drawcallInfo : drawcallList.drawcalls)
+        {
+            collection.emplace_back(drawcallInfo.material, drawcallInfo.worldMatrixIndex + worldMatrixOffset,
+                drawcallInfo.vao, drawcallInfo.drawcall);
+        }
+    }
+}
+
+unsigned int Renderer::AddWorldMatrix(const glm::mat4& worldMatrix, ObjectKey objectKey)
+{
+    unsigned int worldMatrixIndex = static_cast<unsigned int>(m_worldMatrices.size());
+    m_worldMatrices.push_back(worldMatrix);
+    m_previousWorldMatrices.push_back(FindPreviousWorldMatrix(objectKey, worldMatrix));
+    m_worldMatrixObjectKeys.push_back(objectKey);
+
+    return worldMatrixIndex;
+}
+
+unsigned int Renderer::AddLocalMatrix(unsigned int parentIndex, const glm::mat4& localMatrix)
+{
+    // Copies, push_back can reallocate the vectors
+    glm::mat4 worldMatrix = m_worldMatrices[parentIndex] * localMatrix;
+    glm::mat4 previousWorldMatrix = m_previousWorldMatrices[parentIndex] * localMatrix;
+
+    unsigned int worldMatrixIndex = static_cast<unsigned int>(m_worldMatrices.size());
+    m_worldMatrices.push_back(worldMatrix);
+    m_previousWorldMatrices.push_back(previousWorldMatrix);
+    m_worldMatrixObjectKeys.push_back(NoObjectKey);
+    return worldMatrixIndex;
+}
+
+const glm::mat4& Renderer::FindPreviousWorldMatrix(ObjectKey objectKey, const glm::mat4& worldMatrix) const
+{
+    // Use the matrix of the previous frame if the object was there, otherwise it didn't move
+    if (objectKey != NoObjectKey)
+    {
+        const auto& itFind = m_previousObjectWorldMatrices.find(objectKey);
+        if (itFind != m_previousObjectWorldMatrices.end())
+        {
+            return itFind->second;
+        }
+    }
+    return worldMatrix;
+}
+
 void Renderer::PrepareDrawcall(const DrawcallInfo& drawcallInfo)
 {
-    std::shared_ptr<const ShaderProgram> shaderProgram = drawcallInfo.material.GetShaderProgram();
+    std::shared_ptr<const ShaderProgram> shaderProgram = drawcallInfo.material.GetShaderProgramVariant();
 
     // TODO: Room for optimization here, caching current material, current worldMatrixIndex and current VAO
 
@@ -270,6 +456,24 @@ void Renderer::SetLightingRenderStates(bool firstPass)
     glBlendFunc(GL_ONE, GL_ONE);
 }
 
+ShaderProgramVariants::KeywordMask Renderer::GetLightKeywords(const Material& material, const Light* light, bool firstPass)
+{
+    ShaderProgramVariants::KeywordMask keywords = 0;
+    std::shared_ptr<const ShaderProgramVariants> shaderVariants = material.GetShaderVariants();
+    if (shaderVariants)
+    {
+        if (firstPass)
+        {
+            keywords |= shaderVariants->GetKeywordMask("LIGHT_INDIRECT");
+        }
+        if (light && light->GetShadowMap())
+        {
+            keywords |= shaderVariants->GetKeywordMask("LIGHT_SHADOW");
+        }
+    }
+    return keywords;
+}
+
 void Renderer::InitializeFullscreenMesh()
 {
     VertexFormat vertexFormat;
@@ -19,6 +19,7 @@ ShadowMapRenderPass::ShadowMapRenderPass(std::shared_ptr<Light> light, std::shar
     , m_drawcallCollectionIndex(drawcallCollectionIndex)
     , m_volumeCenter(0.0f)
     , m_volumeSize(1.0f)
+    , m_mainViewProjMatrix(1.0f)
 {
     InitFramebuffer();
 }
@@ -38,6 +39,11 @@ void ShadowMapRenderPass::SetSceneAABBBounds(const glm::vec3& min, const glm::ve
     m_sceneAABBCenter = min + m_sceneAABBExtents;
 }
 
+void ShadowMapRenderPass::AddCasterMaterial(std::shared_ptr<const Material> material)
+{
+    m_casterMaterials[material.get()] = material;
+}
+
 void ShadowMapRenderPass::InitFramebuffer()
 {
     std::shared_ptr<FramebufferObject> targetFramebuffer = std::make_shared<FramebufferObject>();
@@ -63,10 +69,6 @@ void ShadowMapRenderPass::Render()
 
     device.Clear(false, Color(), true, 1.0f);
 
-    // Use shadow map shader
-    m_material->Use();
-    std::shared_ptr<const ShaderProgram> shaderProgram = m_material->GetShaderProgram();
-
     // Backup current viewport
     glm::ivec4 currentViewport;
     device.GetViewport(currentViewport.x, currentViewport.y, currentViewport.z, currentViewport.w);
@@ -81,17 +83,33 @@ void ShadowMapRenderPass::Render()
     Camera lightCamera;
 
     if (!shouldFreeze)
-        m_mainCameraCopy = currentCamera;
+        m_mainViewProjMatrix = currentCamera.GetViewProjectionMatrix();
 
     glEnable(GL_DEPTH_CLAMP); // pancaking
-    InitLightCamera(lightCamera, m_mainCameraCopy);
+    InitLightCamera(lightCamera, m_mainViewProjMatrix);
 
     renderer.SetCurrentCamera(lightCamera);
 
     // for all drawcalls
+    const Material* currentMaterial = nullptr;
+    std::shared_ptr<const ShaderProgram> shaderProgram;
     bool first = true;
     for (const Renderer::DrawcallInfo& drawcallInfo : drawcallCollection)
     {
+        // Use shadow map shader, or the caster material of the drawcall
+        const Material* material = m_material.get();
+        if (m_casterMaterials.contains(&drawcallInfo.material))
+        {
+            material = &drawcallInfo.material;
+        }
+        if (material != currentMaterial)
+        {
+            material->Use();
+            shaderProgram = material->GetShaderProgram();
+            currentMaterial = material;
+            first = true;
+        }
+
         // Bind the vao
         drawcallInfo.vao.Bind();
 
@@ -119,7 +137,7 @@ void ShadowMapRenderPass::Render()
     glDisable(GL_DEPTH_CLAMP);
 }
 
-void ShadowMapRenderPass::InitLightCamera(Camera& lightCamera, const Camera& curCamera)
+void ShadowMapRenderPass::InitLightCamera(Camera& lightCamera, const glm::mat4& viewProjMatrix)
 {
     Renderer& renderer = GetRenderer();
     DebugRenderPass& debugRenderer = renderer.GetDebugRenderPass();
@@ -127,7 +145,7 @@ void ShadowMapRenderPass::InitLightCamera(Camera& lightCamera, const Camera& cur
     debugRenderer.DrawAABB(m_sceneAABBCenter, m_sceneAABBExtents, Color(1.0f, 1.0f, 1.0f)); // Draw scene AABB
 
     // Find the view volume center
-    std::vector<glm::vec3> viewCorners = curCamera.GetFrustumCornersWorldSpace3D();
+    std::vector<glm::vec3> viewCorners = Camera::GetFrustumCornersWorldSpace3D(viewProjMatrix);
     debugRenderer.DrawArbitraryBox(viewCorners, Color(1.0f, 0.0f, 0.0f)); // Draw view frustum
     glm::vec3 center(0.0f);
     for (const auto& v : viewCorners)
@@ -1,5 +1,9 @@
 #include <ituGL/scene/Bounds.h>
 
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <cassert>
+
 SphereBounds::SphereBounds(const Bounds& bounds) : Bounds(bounds.GetCenter()), m_radius(0.0f)
 {
     switch (bounds.GetType())
@@ -8,10 +12,10 @@ SphereBounds::SphereBounds(const Bounds& bounds) : Bounds(bounds.GetCenter()), m
         m_radius = static_cast<const SphereBounds&>(bounds).GetRadius();
         break;
     case Type::AABB:
-        m_radius = static_cast<const AabbBounds&>(bounds).GetSize().length();
+        m_radius = glm::length(static_cast<const AabbBounds&>(bounds).GetSize());
         break;
     case Type::Box:
-        m_radius = static_cast<const BoxBounds&>(bounds).GetSize().length();
+        m_radius = glm::length(static_cast<const BoxBounds&>(bounds).GetSize());
         break;
     default:
         assert(false);
@@ -100,6 +104,7 @@ bool Bounds::Intersects(const BoxBounds& boundsA, const AabbBounds& boundsB)
     return Bounds::Intersects(boundsA, BoxBounds(boundsB.GetCenter(), glm::mat3(1.0f), boundsB.GetSize()));
 }
 
+// Returns true if the projections of both boxes on the axis overlap (the axis does not separate them)
 bool TestSeparationAxis(const glm::vec3& axis, const glm::vec3& distance, const glm::mat3& mA, const glm::mat3& mB)
 {
     float projDistance = std::abs(glm::dot(distance, axis));
@@ -109,7 +114,7 @@ bool TestSeparationAxis(const glm::vec3& axis, const glm::vec3& distance, const
         projSize += std::abs(glm::dot(mA[i], axis));
         projSize += std::abs(glm::dot(mB[i], axis));
     }
-    return projSize <= projDistance;
+    return projDistance <= projSize;
 }
 
 template<>
@@ -117,7 +122,7 @@ bool Bounds::Intersects(const BoxBounds& boundsA, const BoxBounds& boundsB)
 {
     glm::vec3 distance = boundsB.GetCenter() - boundsA.GetCenter();
     glm::mat3 mA = boundsA.GetScaledMatrix();
-    glm::mat3 mB = boundsA.GetScaledMatrix();
+    glm::mat3 mB = boundsB.GetScaledMatrix();
     return TestSeparationAxis(boundsA.GetXVector(), distance, mA, mB)
         && TestSeparationAxis(boundsA.GetYVector(), distance, mA, mB)
         && TestSeparationAxis(boundsA.GetZVector(), distance, mA, mB)
@@ -136,19 +141,19 @@ bool Bounds::Intersects(const BoxBounds& boundsA, const BoxBounds& boundsB)
 }
 
 template<>
-bool Bounds::Intersects(const FrustumBounds& boundsA, const SphereBounds& boundsB)
+bool Bounds::Intersects(const FrustumBounds&, const SphereBounds&)
 {
     return true;
 }
 
 template<>
-bool Bounds::Intersects(const FrustumBounds& boundsA, const AabbBounds& boundsB)
+bool Bounds::Intersects(const FrustumBounds&, const AabbBounds&)
 {
     return true;
 }
 
 template<>
-bool Bounds::Intersects(const FrustumBounds& boundsA, const BoxBounds& boundsB)
+bool Bounds::Intersects(const FrustumBounds&, const BoxBounds&)
 {
     return true;
 }
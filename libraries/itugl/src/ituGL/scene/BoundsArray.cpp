@@ -0,0 +1,408 @@
+#include <ituGL/scene/BoundsArray.h>
+
+#include <ituGL/core/CpuFeatures.h>
+#include <glm/geometric.hpp>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+
+#if defined(ITUGL_SIMD_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // Rounds the size up to a whole number of batches, so kernels can always load full vectors
+    size_t GetPaddedSize(size_t size)
+    {
+        return (size + BoundsArrayBatchSize - 1) / BoundsArrayBatchSize * BoundsArrayBatchSize;
+    }
+}
+
+// The same kernels are built for each instruction set, and picked at runtime with CpuFeatures
+#if defined(ITUGL_SIMD_SSE2)
+namespace
+{
+    namespace Sse2
+    {
+        using FloatVector = __m128;
+        constexpr size_t VectorLanes = 4;
+        inline FloatVector VectorLoad(const float* data) { return _mm_loadu_ps(data); }
+        inline void VectorStore(float* data, FloatVector a) { _mm_storeu_ps(data, a); }
+        inline FloatVector VectorSplat(float value) { return _mm_set1_ps(value); }
+        inline FloatVector VectorAdd(FloatVector a, FloatVector b) { return _mm_add_ps(a, b); }
+        inline FloatVector VectorSub(FloatVector a, FloatVector b) { return _mm_sub_ps(a, b); }
+        inline FloatVector VectorMul(FloatVector a, FloatVector b) { return _mm_mul_ps(a, b); }
+        inline FloatVector VectorAbs(FloatVector a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+        inline FloatVector VectorAnd(FloatVector a, FloatVector b) { return _mm_and_ps(a, b); }
+        inline FloatVector VectorLessEqual(FloatVector a, FloatVector b) { return _mm_cmple_ps(a, b); }
+        inline FloatVector VectorAllTrue() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+        inline int VectorMoveMask(FloatVector a) { return _mm_movemask_ps(a); }
+
+#include "BoundsArrayKernels.inl"
+    }
+}
+#endif
+
+#if defined(ITUGL_SIMD_AVX2)
+ITUGL_AVX2_BEGIN
+namespace
+{
+    namespace Avx2
+    {
+        using FloatVector = __m256;
+        constexpr size_t VectorLanes = 8;
+        inline FloatVector VectorLoad(const float* data) { return _mm256_loadu_ps(data); }
+        inline void VectorStore(float* data, FloatVector a) { _mm256_storeu_ps(data, a); }
+        inline FloatVector VectorSplat(float value) { return _mm256_set1_ps(value); }
+        inline FloatVector VectorAdd(FloatVector a, FloatVector b) { return _mm256_add_ps(a, b); }
+        inline FloatVector VectorSub(FloatVector a, FloatVector b) { return _mm256_sub_ps(a, b); }
+        inline FloatVector VectorMul(FloatVector a, FloatVector b) { return _mm256_mul_ps(a, b); }
+        inline FloatVector VectorAbs(FloatVector a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        inline FloatVector VectorAnd(FloatVector a, FloatVector b) { return _mm256_and_ps(a, b); }
+        inline FloatVector VectorLessEqual(FloatVector a, FloatVector b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+        inline FloatVector VectorAllTrue() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+        inline int VectorMoveMask(FloatVector a) { return _mm256_movemask_ps(a); }
+
+#include "BoundsArrayKernels.inl"
+    }
+}
+ITUGL_AVX2_END
+#endif
+
+AabbArray::AabbArray() : m_size(0)
+{
+}
+
+void AabbArray::Reserve(size_t capacity)
+{
+    size_t paddedCapacity = GetPaddedSize(capacity);
+    m_centerX.reserve(paddedCapacity);
+    m_centerY.reserve(paddedCapacity);
+    m_centerZ.reserve(paddedCapacity);
+    m_sizeX.reserve(paddedCapacity);
+    m_sizeY.reserve(paddedCapacity);
+    m_sizeZ.reserve(paddedCapacity);
+}
+
+void AabbArray::Resize(size_t size)
+{
+    ResizeStorage(size);
+    m_size = size;
+}
+
+void AabbArray::Clear()
+{
+    Resize(0);
+}
+
+void AabbArray::ResizeStorage(size_t size)
+{
+    // Padding elements are zero-sized boxes at the origin. Their results are never written
+    size_t paddedSize = GetPaddedSize(size);
+    m_centerX.resize(paddedSize, 0.0f);
+    m_centerY.resize(paddedSize, 0.0f);
+    m_centerZ.resize(paddedSize, 0.0f);
+    m_sizeX.resize(paddedSize, 0.0f);
+    m_sizeY.resize(paddedSize, 0.0f);
+    m_sizeZ.resize(paddedSize, 0.0f);
+}
+
+size_t AabbArray::Add(const glm::vec3& center, const glm::vec3& size)
+{
+    size_t index = m_size;
+    Resize(m_size + 1);
+    Set(index, center, size);
+    return index;
+}
+
+size_t AabbArray::Add(const AabbBounds& bounds)
+{
+    return Add(bounds.GetCenter(), bounds.GetSize());
+}
+
+AabbBounds AabbArray::Get(size_t index) const
+{
+    assert(index < m_size);
+    return AabbBounds(glm::vec3(m_centerX[index], m_centerY[index], m_centerZ[index]),
+        glm::vec3(m_sizeX[index], m_sizeY[index], m_sizeZ[index]));
+}
+
+void AabbArray::Set(size_t index, const glm::vec3& center, const glm::vec3& size)
+{
+    assert(index < m_size);
+    m_centerX[index] = center.x;
+    m_centerY[index] = center.y;
+    m_centerZ[index] = center.z;
+    m_sizeX[index] = size.x;
+    m_sizeY[index] = size.y;
+    m_sizeZ[index] = size.z;
+}
+
+void AabbArray::Set(size_t index, const AabbBounds& bounds)
+{
+    Set(index, bounds.GetCenter(), bounds.GetSize());
+}
+
+void AabbArray::TestPlanes(std::span<const BoundsPlane> planes, std::span<unsigned char> results) const
+{
+    assert(results.size() >= m_size);
+#if defined(ITUGL_SIMD_AVX2)
+    if (CpuFeatures::IsAvx2Enabled())
+    {
+        Avx2::TestPlanes(*this, planes, results);
+        return;
+    }
+#endif
+#if defined(ITUGL_SIMD_SSE2)
+    Sse2::TestPlanes(*this, planes, results);
+#else
+    TestPlanesReference(planes, results);
+#endif
+}
+
+void AabbArray::TestPlanesReference(std::span<const BoundsPlane> planes, std::span<unsigned char> results) const
+{
+    assert(results.size() >= m_size);
+
+    for (size_t i = 0; i < m_size; ++i)
+    {
+        bool inside = true;
+        for (const BoundsPlane& plane : planes)
+        {
+            float distance = plane.x * m_centerX[i] + plane.y * m_centerY[i] + plane.z * m_centerZ[i] + plane.w;
+            float radius = std::abs(plane.x) * m_sizeX[i] + std::abs(plane.y) * m_sizeY[i] + std::abs(plane.z) * m_sizeZ[i];
+            inside &= 0.0f <= distance + radius;
+        }
+        results[i] = inside ? 1 : 0;
+    }
+}
+
+void AabbArray::TestOverlap(const AabbBounds& bounds, std::span<unsigned char> results) const
+{
+    assert(results.size() >= m_size);
+#if defined(ITUGL_SIMD_AVX2)
+    if (CpuFeatures::IsAvx2Enabled())
+    {
+        Avx2::TestOverlap(*this, bounds, results);
+        return;
+    }
+#endif
+#if defined(ITUGL_SIMD_SSE2)
+    Sse2::TestOverlap(*this, bounds, results);
+#else
+    TestOverlapReference(bounds, results);
+#endif
+}
+
+void AabbArray::TestOverlapReference(const AabbBounds& bounds, std::span<unsigned char> results) const
+{
+    assert(results.size() >= m_size);
+
+    const glm::vec3& center = bounds.GetCenter();
+    const glm::vec3& size = bounds.GetSize();
+    for (size_t i = 0; i < m_size; ++i)
+    {
+        bool overlap = std::abs(m_centerX[i] - center.x) <= m_sizeX[i] + size.x
+            && std::abs(m_centerY[i] - center.y) <= m_sizeY[i] + size.y
+            && std::abs(m_centerZ[i] - center.z) <= m_sizeZ[i] + size.z;
+        results[i] = overlap ? 1 : 0;
+    }
+}
+
+void AabbArray::Transform(const glm::mat4& matrix, AabbArray& output) const
+{
+    assert(&output != this);
+    output.Resize(m_size);
+
+    float* const outputs[6] = { output.m_centerX.data(), output.m_centerY.data(), output.m_centerZ.data(),
+        output.m_sizeX.data(), output.m_sizeY.data(), output.m_sizeZ.data() };
+#if defined(ITUGL_SIMD_AVX2)
+    if (CpuFeatures::IsAvx2Enabled())
+    {
+        Avx2::Transform(*this, matrix, outputs);
+        return;
+    }
+#endif
+#if defined(ITUGL_SIMD_SSE2)
+    Sse2::Transform(*this, matrix, outputs);
+#else
+    TransformReference(matrix, output);
+#endif
+}
+
+void AabbArray::TransformReference(const glm::mat4& matrix, AabbArray& output) const
+{
+    assert(&output != this);
+    output.Resize(m_size);
+
+    for (size_t i = 0; i < m_size; ++i)
+    {
+        float centerX = m_centerX[i], centerY = m_centerY[i], centerZ = m_centerZ[i];
+        float sizeX = m_sizeX[i], sizeY = m_sizeY[i], sizeZ = m_sizeZ[i];
+        for (int row = 0; row < 3; ++row)
+        {
+            float center = matrix[0][row] * centerX + matrix[1][row] * centerY + matrix[2][row] * centerZ + matrix[3][row];
+            float size = std::abs(matrix[0][row]) * sizeX + std::abs(matrix[1][row]) * sizeY + std::abs(matrix[2][row]) * sizeZ;
+            (row == 0 ? output.m_centerX : row == 1 ? output.m_centerY : output.m_centerZ)[i] = center;
+            (row == 0 ? output.m_sizeX : row == 1 ? output.m_sizeY : output.m_sizeZ)[i] = size;
+        }
+    }
+}
+
+
+SphereArray::SphereArray() : m_size(0)
+{
+}
+
+void SphereArray::Reserve(size_t capacity)
+{
+    size_t paddedCapacity = GetPaddedSize(capacity);
+    m_centerX.reserve(paddedCapacity);
+    m_centerY.reserve(paddedCapacity);
+    m_centerZ.reserve(paddedCapacity);
+    m_radius.reserve(paddedCapacity);
+}
+
+void SphereArray::Resize(size_t size)
+{
+    ResizeStorage(size);
+    m_size = size;
+}
+
+void SphereArray::Clear()
+{
+    Resize(0);
+}
+
+void SphereArray::ResizeStorage(size_t size)
+{
+    size_t paddedSize = GetPaddedSize(size);
+    m_centerX.resize(paddedSize, 0.0f);
+    m_centerY.resize(paddedSize, 0.0f);
+    m_centerZ.resize(paddedSize, 0.0f);
+    m_radius.resize(paddedSize, 0.0f);
+}
+
+size_t SphereArray::Add(const glm::vec3& center, float radius)
+{
+    size_t index = m_size;
+    Resize(m_size + 1);
+    Set(index, center, radius);
+    return index;
+}
+
+size_t SphereArray::Add(const SphereBounds& bounds)
+{
+    return Add(bounds.GetCenter(), bounds.GetRadius());
+}
+
+SphereBounds SphereArray::Get(size_t index) const
+{
+    assert(index < m_size);
+    return SphereBounds(glm::vec3(m_centerX[index], m_centerY[index], m_centerZ[index]), m_radius[index]);
+}
+
+void SphereArray::Set(size_t index, const glm::vec3& center, float radius)
+{
+    assert(index < m_size);
+    m_centerX[index] = center.x;
+    m_centerY[index] = center.y;
+    m_centerZ[index] = center.z;
+    m_radius[index] = radius;
+}
+
+void SphereArray::Set(size_t index, const SphereBounds& bounds)
+{
+    Set(index, bounds.GetCenter(), bounds.GetRadius());
+}
+
+void SphereArray::TestPlanes(std::span<const BoundsPlane> planes, std::span<unsigned char> results) const
+{
+    assert(results.size() >= m_size);
+#if defined(ITUGL_SIMD_AVX2)
+    if (CpuFeatures::IsAvx2Enabled())
+    {
+        Avx2::TestPlanes(*this, planes, results);
+        return;
+    }
+#endif
+#if defined(ITUGL_SIMD_SSE2)
+    Sse2::TestPlanes(*this, planes, results);
+#else
+    TestPlanesReference(planes, results);
+#endif
+}
+
+void SphereArray::TestPlanesReference(std::span<const BoundsPlane> planes, std::span<unsigned char> results) const
+{
+    assert(results.size() >= m_size);
+
+    for (size_t i = 0; i < m_size; ++i)
+    {
+        bool inside = true;
+        for (const BoundsPlane& plane : planes)
+        {
+            float distance = plane.x * m_centerX[i] + plane.y * m_centerY[i] + plane.z * m_centerZ[i] + plane.w;
+            inside &= 0.0f <= distance + m_radius[i];
+        }
+        results[i] = inside ? 1 : 0;
+    }
+}
+
+void SphereArray::TestOverlap(const SphereBounds& bounds, std::span<unsigned char> results) const
+{
+    assert(results.size() >= m_size);
+#if defined(ITUGL_SIMD_AVX2)
+    if (CpuFeatures::IsAvx2Enabled())
+    {
+        Avx2::TestOverlap(*this, bounds, results);
+        return;
+    }
+#endif
+#if defined(ITUGL_SIMD_SSE2)
+    Sse2::TestOverlap(*this, bounds, results);
+#else
+    TestOverlapReference(bounds, results);
+#endif
+}
+
+void SphereArray::TestOverlapReference(const SphereBounds& bounds, std::span<unsigned char> results) const
+{
+    assert(results.size() >= m_size);
+
+    const glm::vec3& center = bounds.GetCenter();
+    for (size_t i = 0; i < m_size; ++i)
+    {
+        float deltaX = m_centerX[i] - center.x;
+        float deltaY = m_centerY[i] - center.y;
+        float deltaZ = m_centerZ[i] - center.z;
+        float distance2 = deltaX * deltaX + deltaY * deltaY + deltaZ * deltaZ;
+        float radius = m_radius[i] + bounds.GetRadius();
+        results[i] = distance2 <= radius * radius ? 1 : 0;
+    }
+}
+
+
+void ExtractFrustumPlanes(const glm::mat4& viewProjectionMatrix, std::array<BoundsPlane, 6>& planes)
+{
+    // Rows of the matrix (glm is column major)
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        row[i] = glm::vec4(viewProjectionMatrix[0][i], viewProjectionMatrix[1][i], viewProjectionMatrix[2][i], viewProjectionMatrix[3][i]);
+    }
+
+    // Gribb-Hartmann extraction, for OpenGL clip space (-w <= z <= w)
+    planes[0] = row[3] + row[0]; // Left
+    planes[1] = row[3] - row[0]; // Right
+    planes[2] = row[3] + row[1]; // Bottom
+    planes[3] = row[3] - row[1]; // Top
+    planes[4] = row[3] + row[2]; // Near
+    planes[5] = row[3] - row[2]; // Far
+
+    for (BoundsPlane& plane : planes)
+    {
+        plane /= glm::length(glm::vec3(plane));
+    }
+}
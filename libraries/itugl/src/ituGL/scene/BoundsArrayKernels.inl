@@ -0,0 +1,158 @@
+// Vectorized kernels of BoundsArray.cpp, included once for each instruction set
+// Included inside a namespace that defines FloatVector, VectorLanes and the Vector functions for that set
+
+static_assert(BoundsArrayBatchSize % VectorLanes == 0, "Batch size must be a multiple of the vector width");
+
+// Expands the lane mask into one byte per element, skipping the padding elements past the end
+inline void StoreMask(int mask, size_t first, size_t size, std::span<unsigned char> results)
+{
+    size_t count = std::min(VectorLanes, size - first);
+    for (size_t lane = 0; lane < count; ++lane)
+    {
+        results[first + lane] = (mask >> lane) & 1;
+    }
+}
+
+void TestPlanes(const AabbArray& boxes, std::span<const BoundsPlane> planes, std::span<unsigned char> results)
+{
+    const float* centersX = boxes.GetCenterX().data();
+    const float* centersY = boxes.GetCenterY().data();
+    const float* centersZ = boxes.GetCenterZ().data();
+    const float* sizesX = boxes.GetSizeX().data();
+    const float* sizesY = boxes.GetSizeY().data();
+    const float* sizesZ = boxes.GetSizeZ().data();
+
+    for (size_t i = 0; i < boxes.GetSize(); i += VectorLanes)
+    {
+        FloatVector centerX = VectorLoad(centersX + i);
+        FloatVector centerY = VectorLoad(centersY + i);
+        FloatVector centerZ = VectorLoad(centersZ + i);
+        FloatVector sizeX = VectorLoad(sizesX + i);
+        FloatVector sizeY = VectorLoad(sizesY + i);
+        FloatVector sizeZ = VectorLoad(sizesZ + i);
+
+        FloatVector inside = VectorAllTrue();
+        for (const BoundsPlane& plane : planes)
+        {
+            // Signed distance of the center, and the projected radius of the box on the plane normal
+            FloatVector distance = VectorAdd(VectorAdd(VectorAdd(VectorMul(VectorSplat(plane.x), centerX), VectorMul(VectorSplat(plane.y), centerY)), VectorMul(VectorSplat(plane.z), centerZ)), VectorSplat(plane.w));
+            FloatVector radius = VectorAdd(VectorAdd(VectorMul(VectorSplat(std::abs(plane.x)), sizeX), VectorMul(VectorSplat(std::abs(plane.y)), sizeY)), VectorMul(VectorSplat(std::abs(plane.z)), sizeZ));
+            inside = VectorAnd(inside, VectorLessEqual(VectorSplat(0.0f), VectorAdd(distance, radius)));
+        }
+        StoreMask(VectorMoveMask(inside), i, boxes.GetSize(), results);
+    }
+}
+
+void TestOverlap(const AabbArray& boxes, const AabbBounds& bounds, std::span<unsigned char> results)
+{
+    const glm::vec3& center = bounds.GetCenter();
+    const glm::vec3& size = bounds.GetSize();
+    FloatVector otherCenterX = VectorSplat(center.x), otherCenterY = VectorSplat(center.y), otherCenterZ = VectorSplat(center.z);
+    FloatVector otherSizeX = VectorSplat(size.x), otherSizeY = VectorSplat(size.y), otherSizeZ = VectorSplat(size.z);
+
+    const float* centersX = boxes.GetCenterX().data();
+    const float* centersY = boxes.GetCenterY().data();
+    const float* centersZ = boxes.GetCenterZ().data();
+    const float* sizesX = boxes.GetSizeX().data();
+    const float* sizesY = boxes.GetSizeY().data();
+    const float* sizesZ = boxes.GetSizeZ().data();
+
+    for (size_t i = 0; i < boxes.GetSize(); i += VectorLanes)
+    {
+        // Boxes overlap if the distance between centers is not larger than the sum of half sizes, on every axis
+        FloatVector overlapX = VectorLessEqual(VectorAbs(VectorSub(VectorLoad(centersX + i), otherCenterX)), VectorAdd(VectorLoad(sizesX + i), otherSizeX));
+        FloatVector overlapY = VectorLessEqual(VectorAbs(VectorSub(VectorLoad(centersY + i), otherCenterY)), VectorAdd(VectorLoad(sizesY + i), otherSizeY));
+        FloatVector overlapZ = VectorLessEqual(VectorAbs(VectorSub(VectorLoad(centersZ + i), otherCenterZ)), VectorAdd(VectorLoad(sizesZ + i), otherSizeZ));
+        StoreMask(VectorMoveMask(VectorAnd(VectorAnd(overlapX, overlapY), overlapZ)), i, boxes.GetSize(), results);
+    }
+}
+
+// Output components in the order center x, y, z and size x, y, z, with room for the padding elements
+void Transform(const AabbArray& boxes, const glm::mat4& matrix, float* const output[6])
+{
+    // Matrix is column major: matrix[column][row]
+    FloatVector m[4][3], absM[3][3];
+    for (int column = 0; column < 4; ++column)
+    {
+        for (int row = 0; row < 3; ++row)
+        {
+            m[column][row] = VectorSplat(matrix[column][row]);
+            if (column < 3)
+            {
+                absM[column][row] = VectorSplat(std::abs(matrix[column][row]));
+            }
+        }
+    }
+
+    const float* centersX = boxes.GetCenterX().data();
+    const float* centersY = boxes.GetCenterY().data();
+    const float* centersZ = boxes.GetCenterZ().data();
+    const float* sizesX = boxes.GetSizeX().data();
+    const float* sizesY = boxes.GetSizeY().data();
+    const float* sizesZ = boxes.GetSizeZ().data();
+
+    for (size_t i = 0; i < boxes.GetSize(); i += VectorLanes)
+    {
+        FloatVector centerX = VectorLoad(centersX + i);
+        FloatVector centerY = VectorLoad(centersY + i);
+        FloatVector centerZ = VectorLoad(centersZ + i);
+        FloatVector sizeX = VectorLoad(sizesX + i);
+        FloatVector sizeY = VectorLoad(sizesY + i);
+        FloatVector sizeZ = VectorLoad(sizesZ + i);
+
+        // Center is transformed as a point. Size is the projection of the transformed axes (Arvo's method)
+        VectorStore(output[0] + i, VectorAdd(VectorAdd(VectorAdd(VectorMul(m[0][0], centerX), VectorMul(m[1][0], centerY)), VectorMul(m[2][0], centerZ)), m[3][0]));
+        VectorStore(output[1] + i, VectorAdd(VectorAdd(VectorAdd(VectorMul(m[0][1], centerX), VectorMul(m[1][1], centerY)), VectorMul(m[2][1], centerZ)), m[3][1]));
+        VectorStore(output[2] + i, VectorAdd(VectorAdd(VectorAdd(VectorMul(m[0][2], centerX), VectorMul(m[1][2], centerY)), VectorMul(m[2][2], centerZ)), m[3][2]));
+        VectorStore(output[3] + i, VectorAdd(VectorAdd(VectorMul(absM[0][0], sizeX), VectorMul(absM[1][0], sizeY)), VectorMul(absM[2][0], sizeZ)));
+        VectorStore(output[4] + i, VectorAdd(VectorAdd(VectorMul(absM[0][1], sizeX), VectorMul(absM[1][1], sizeY)), VectorMul(absM[2][1], sizeZ)));
+        VectorStore(output[5] + i, VectorAdd(VectorAdd(VectorMul(absM[0][2], sizeX), VectorMul(absM[1][2], sizeY)), VectorMul(absM[2][2], sizeZ)));
+    }
+}
+
+void TestPlanes(const SphereArray& spheres, std::span<const BoundsPlane> planes, std::span<unsigned char> results)
+{
+    const float* centersX = spheres.GetCenterX().data();
+    const float* centersY = spheres.GetCenterY().data();
+    const float* centersZ = spheres.GetCenterZ().data();
+    const float* radii = spheres.GetRadius().data();
+
+    for (size_t i = 0; i < spheres.GetSize(); i += VectorLanes)
+    {
+        FloatVector centerX = VectorLoad(centersX + i);
+        FloatVector centerY = VectorLoad(centersY + i);
+        FloatVector centerZ = VectorLoad(centersZ + i);
+        FloatVector radius = VectorLoad(radii + i);
+
+        FloatVector inside = VectorAllTrue();
+        for (const BoundsPlane& plane : planes)
+        {
+            FloatVector distance = VectorAdd(VectorAdd(VectorAdd(VectorMul(VectorSplat(plane.x), centerX), VectorMul(VectorSplat(plane.y), centerY)), VectorMul(VectorSplat(plane.z), centerZ)), VectorSplat(plane.w));
+            inside = VectorAnd(inside, VectorLessEqual(VectorSplat(0.0f), VectorAdd(distance, radius)));
+        }
+        StoreMask(VectorMoveMask(inside), i, spheres.GetSize(), results);
+    }
+}
+
+void TestOverlap(const SphereArray& spheres, const SphereBounds& bounds, std::span<unsigned char> results)
+{
+    const glm::vec3& center = bounds.GetCenter();
+    FloatVector otherCenterX = VectorSplat(center.x), otherCenterY = VectorSplat(center.y), otherCenterZ = VectorSplat(center.z);
+    FloatVector otherRadius = VectorSplat(bounds.GetRadius());
+
+    const float* centersX = spheres.GetCenterX().data();
+    const float* centersY = spheres.GetCenterY().data();
+    const float* centersZ = spheres.GetCenterZ().data();
+    const float* radii = spheres.GetRadius().data();
+
+    for (size_t i = 0; i < spheres.GetSize(); i += VectorLanes)
+    {
+        // Compare squared distances to avoid the square root
+        FloatVector deltaX = VectorSub(VectorLoad(centersX + i), otherCenterX);
+        FloatVector deltaY = VectorSub(VectorLoad(centersY + i), otherCenterY);
+        FloatVector deltaZ = VectorSub(VectorLoad(centersZ + i), otherCenterZ);
+        FloatVector distance2 = VectorAdd(VectorAdd(VectorMul(deltaX, deltaX), VectorMul(deltaY, deltaY)), VectorMul(deltaZ, deltaZ));
+        FloatVector radius = VectorAdd(VectorLoad(radii + i), otherRadius);
+        StoreMask(VectorMoveMask(VectorLessEqual(distance2, VectorMul(radius, radius))), i, spheres.GetSize(), results);
+    }
+}
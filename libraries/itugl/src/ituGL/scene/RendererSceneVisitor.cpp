@@ -5,6 +5,7 @@
 #include <ituGL/scene/SceneLight.h>
 #include <ituGL/scene/SceneModel.h>
 #include <ituGL/scene/Transform.h>
+#include <cassert>
 
 RendererSceneVisitor::RendererSceneVisitor(Renderer& renderer) : m_renderer(renderer)
 {
@@ -12,17 +13,64 @@ RendererSceneVisitor::RendererSceneVisitor(Renderer& renderer) : m_renderer(rend
 
 void RendererSceneVisitor::VisitCamera(SceneCamera& sceneCamera)
 {
+    if (m_chunkData)
+    {
+        assert(!m_chunkData->camera); // Currently, only one camera per scene supported
+        m_chunkData->camera = sceneCamera.GetCamera().get();
+        return;
+    }
+
     assert(!m_renderer.HasCamera()); // Currently, only one camera per scene supported
     m_renderer.SetCurrentCamera(*sceneCamera.GetCamera());
 }
 
 void RendererSceneVisitor::VisitLight(SceneLight& sceneLight)
 {
+    if (m_chunkData)
+    {
+        m_chunkData->lights.push_back(sceneLight.GetLight().get());
+        return;
+    }
+
     m_renderer.AddLight(*sceneLight.GetLight());
 }
 
 void RendererSceneVisitor::VisitModel(SceneModel& sceneModel)
 {
     assert(sceneModel.GetTransform());
-    m_renderer.AddModel(*sceneModel.GetModel(), sceneModel.GetTransform()->GetTransformMatrix());
+
+    // The node id is the key to find its transform in the previous frame. Unlike the address, it is never reused
+    if (m_chunkData)
+    {
+        m_renderer.AddModel(m_chunkData->drawcallList, *sceneModel.GetModel(), sceneModel.GetTransform()->GetTransformMatrix(), sceneModel.GetId());
+        return;
+    }
+
+    m_renderer.AddModel(*sceneModel.GetModel(), sceneModel.GetTransform()->GetTransformMatrix(), sceneModel.GetId());
+}
+
+RendererSceneVisitor RendererSceneVisitor::CreateChunkVisitor() const
+{
+    RendererSceneVisitor chunkVisitor(m_renderer);
+    chunkVisitor.m_chunkData = std::make_unique<ChunkData>();
+    return chunkVisitor;
+}
+
+void RendererSceneVisitor::MergeChunkVisitor(RendererSceneVisitor& chunkVisitor)
+{
+    assert(chunkVisitor.m_chunkData);
+    const ChunkData& chunkData = *chunkVisitor.m_chunkData;
+
+    if (chunkData.camera)
+    {
+        assert(!m_renderer.HasCamera()); // Currently, only one camera per scene supported
+        m_renderer.SetCurrentCamera(*chunkData.camera);
+    }
+
+    for (const Light* light : chunkData.lights)
+    {
+        m_renderer.AddLight(*light);
+    }
+
+    m_renderer.AddDrawcalls(chunkData.drawcallList);
 }
@@ -3,6 +3,8 @@
 #include <ituGL/scene/SceneNode.h>
 #include <ituGL/scene/SceneModel.h>
 #include <ituGL/scene/SceneVisitor.h>
+#include <ituGL/scene/Transform.h>
+#include <ituGL/core/JobSystem.h>
 #include <cassert>
 #include <glm/gtx/string_cast.hpp>
 #include <iostream>
@@ -13,9 +15,9 @@ Scene::Scene() : m_AABBMinBounds({ 0.0f }), m_AABBMaxBounds({ 0.0f }), m_AABBCen
 
 Scene::~Scene()
 {
-    for (auto& pair : m_nodes)
+    for (auto& node : m_nodeList)
     {
-        pair.second->SetOwnerScene(nullptr);
+        node->SetOwnerScene(nullptr);
     }
 }
 
@@ -24,7 +26,7 @@ std::shared_ptr<SceneNode> Scene::GetSceneNode(const std::string& name) const
     auto it = m_nodes.find(name);
     if (it != m_nodes.end())
     {
-        return it->second;
+        return m_nodeList[it->second];
     }
     return nullptr;
 }
@@ -32,7 +34,17 @@ std::shared_ptr<SceneNode> Scene::GetSceneNode(const std::string& name) const
 bool Scene::AddSceneNode(std::shared_ptr<SceneNode> node)
 {
     assert(node);
-    m_nodes[node->GetName()] = node;
+    auto it = m_nodes.find(node->GetName());
+    if (it != m_nodes.end())
+    {
+        // Replace the node with the same name, keeping its position in the list
+        m_nodeList[it->second] = node;
+    }
+    else
+    {
+        m_nodes[node->GetName()] = m_nodeList.size();
+        m_nodeList.push_back(node);
+    }
     node->SetOwnerScene(this);
 
     glm::vec3 nodeMin = node->GetAabbBounds().GetMin();
@@ -48,7 +60,7 @@ bool Scene::AddSceneNode(std::shared_ptr<SceneNode> node)
 
 bool Scene::RemoveSceneNode(std::shared_ptr<SceneNode> node)
 {
-    assert(m_nodes.find(node->GetName()) == m_nodes.end() || m_nodes.find(node->GetName())->second == node);
+    assert(m_nodes.find(node->GetName()) == m_nodes.end() || m_nodeList[m_nodes.find(node->GetName())->second] == node);
     return RemoveSceneNode(node->GetName());
 }
 
@@ -57,10 +69,20 @@ bool Scene::RemoveSceneNode(const std::string& name)
     auto it = m_nodes.find(name);
     if (it != m_nodes.end())
     {
-        assert(it->second);
-        assert(it->second->GetOwnerScene() == this);
-        it->second->SetOwnerScene(nullptr);
+        size_t index = it->second;
+        std::shared_ptr<SceneNode>& node = m_nodeList[index];
+        assert(node);
+        assert(node->GetOwnerScene() == this);
+        node->SetOwnerScene(nullptr);
         m_nodes.erase(it);
+
+        // Move the last node to the empty slot
+        if (index + 1 < m_nodeList.size())
+        {
+            node = std::move(m_nodeList.back());
+            m_nodes[node->GetName()] = index;
+        }
+        m_nodeList.pop_back();
         return true;
     }
     return false;
@@ -68,20 +90,72 @@ bool Scene::RemoveSceneNode(const std::string& name)
 
 void Scene::AcceptVisitor(SceneVisitor& visitor)
 {
-    for (auto& pair : m_nodes)
+    for (auto& node : m_nodeList)
     {
-        pair.second->AcceptVisitor(visitor);
+        node->AcceptVisitor(visitor);
     }
 }
 
 void Scene::AcceptVisitor(SceneVisitor& visitor) const
 {
-    for (auto& pair : m_nodes)
+    for (auto& node : m_nodeList)
     {
-        pair.second->AcceptVisitor(visitor);
+        node->AcceptVisitor(visitor);
     }
 }
 
+size_t Scene::GetChunkCount(size_t chunkSize) const
+{
+    assert(chunkSize > 0);
+    return (m_nodeList.size() + chunkSize - 1) / chunkSize;
+}
+
+void Scene::UpdateTransforms()
+{
+    // Updating a transform also updates its parents, so shared parents are never written from the worker threads
+    for (auto& node : m_nodeList)
+    {
+        std::shared_ptr<Transform> transform = node->GetTransform();
+        if (transform && transform->IsDirty())
+        {
+            transform->GetTransformMatrix();
+        }
+    }
+}
+
+void Scene::ForEachNodeParallel(JobSystem& jobSystem, size_t chunkSize, const ChunkFunction& function)
+{
+    jobSystem.ParallelFor(m_nodeList.size(), chunkSize, [this, &function](size_t begin, size_t end, size_t chunkIndex)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                function(*m_nodeList[i], chunkIndex);
+            }
+        });
+}
+
+void Scene::AcceptVisitorOnNode(SceneNode& node, SceneVisitor& visitor)
+{
+    node.AcceptVisitor(visitor);
+}
+
+bool Scene::Save(const char* path, const SceneSnapshot::GetModelIdFunction& getModelId) const
+{
+    return SceneSnapshot::Save(path, *this, getModelId);
+}
+
+bool Scene::Load(const char* path, const SceneSnapshot::GetModelFunction& getModel)
+{
+    SceneSnapshot snapshot;
+    if (!snapshot.Open(path))
+    {
+        std::cout << "ERROR::SCENE::SNAPSHOT_NOT_VALID " << path << std::endl;
+        return false;
+    }
+    snapshot.AddToScene(*this, getModel);
+    return true;
+}
+
 void Scene::GetAABBBounds(glm::vec3& min, glm::vec3& max)
 {
     min = m_AABBMinBounds;
@@ -2,6 +2,7 @@
 
 #include <ituGL/scene/Scene.h>
 #include <ituGL/scene/Transform.h>
+#include <atomic>
 
 SceneNode::SceneNode(const std::string& name) : SceneNode(name, std::make_shared<Transform>(), glm::vec3(0.0f), glm::vec3(1.0f))
 {
@@ -13,12 +14,19 @@ SceneNode::SceneNode(const std::string& name, glm::vec3 aabbBoundsMin, glm::vec3
 }
 
 SceneNode::SceneNode(const std::string& name, std::shared_ptr<Transform> transform, glm::vec3 aabbBoundsMin, glm::vec3 aabbBoundsMax) 
-    : m_scene(nullptr), m_name(name), m_transform(transform)
+    : m_scene(nullptr), m_id(GetNextId()), m_name(name), m_transform(transform)
 {
     m_AABB_extents = (aabbBoundsMax - aabbBoundsMin) * 0.5f;
     m_AABB_center = aabbBoundsMin + m_AABB_extents;
 }
 
+// Nodes can be created by the loading threads
+std::uint64_t SceneNode::GetNextId()
+{
+    static std::atomic<std::uint64_t> s_nextId = 1;
+    return s_nextId++;
+}
+
 SceneNode::~SceneNode()
 {
 }
@@ -89,6 +97,11 @@ glm::vec3 SceneNode::GetAabbExtents() const
     return m_AABB_extents;
 }
 
+glm::vec3 SceneNode::GetAabbCenter() const
+{
+    return m_AABB_center;
+}
+
 void SceneNode::AcceptVisitor(SceneVisitor& visitor)
 {
 }
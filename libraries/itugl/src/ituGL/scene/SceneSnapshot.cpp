@@ -0,0 +1,566 @@
+#include <ituGL/scene/SceneSnapshot.h>
+
+#include <ituGL/core/Hash.h>
+#include <ituGL/scene/Scene.h>
+#include <ituGL/scene/SceneVisitor.h>
+#include <ituGL/scene/SceneModel.h>
+#include <ituGL/scene/SceneLight.h>
+#include <ituGL/scene/SceneCamera.h>
+#include <ituGL/scene/Transform.h>
+#include <ituGL/camera/Camera.h>
+#include <ituGL/lighting/DirectionalLight.h>
+#include <ituGL/lighting/PointLight.h>
+#include <ituGL/lighting/SpotLight.h>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// File layout: header, followed by the arrays at the offsets in the header. Offsets are aligned to ArrayAlignment
+// All values are stored in the native (little endian) format
+struct SceneSnapshot::Header
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t nodeCount;
+    std::uint32_t lightCount;
+    std::uint32_t cameraCount;
+    std::uint32_t stringsSize;
+
+    // Per node arrays
+    std::uint64_t typesOffset;
+    std::uint64_t dataIndicesOffset;    // Index in the lights or cameras array
+    std::uint64_t namesOffset;          // Offset and length in the strings block
+    std::uint64_t modelIdsOffset;
+    std::uint64_t translationsOffset;
+    std::uint64_t rotationsOffset;
+    std::uint64_t scalesOffset;
+    std::uint64_t boundsMinOffset;
+    std::uint64_t boundsMaxOffset;
+    std::uint64_t parentsOffset;        // Index of the parent node, or NoParent
+
+    // Other arrays
+    std::uint64_t lightsOffset;
+    std::uint64_t camerasOffset;
+    std::uint64_t stringsOffset;
+};
+
+namespace
+{
+    constexpr char SnapshotMagic[4] = { 'I', 'S', 'C', 'N' };
+    constexpr std::uint64_t ArrayAlignment = 16;
+
+    struct NameEntry
+    {
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+
+    static_assert(sizeof(glm::vec3) == 12, "Snapshot arrays require tightly packed vectors");
+
+    // Parent links must not form cycles, or evaluating the transforms would never end
+    bool HasParentCycle(std::span<const std::uint32_t> parentIndices)
+    {
+        enum class State : std::uint8_t { NotVisited, InChain, Checked };
+        std::vector<State> states(parentIndices.size(), State::NotVisited);
+        for (std::uint32_t nodeIndex = 0; nodeIndex < parentIndices.size(); ++nodeIndex)
+        {
+            // Follow the parents until a node that was already visited
+            std::uint32_t index = nodeIndex;
+            while (index != SceneSnapshot::NoParent && states[index] == State::NotVisited)
+            {
+                states[index] = State::InChain;
+                index = parentIndices[index];
+            }
+            if (index != SceneSnapshot::NoParent && states[index] == State::InChain)
+            {
+                return true;
+            }
+
+            for (index = nodeIndex; index != SceneSnapshot::NoParent && states[index] == State::InChain; index = parentIndices[index])
+            {
+                states[index] = State::Checked;
+            }
+        }
+        return false;
+    }
+
+    // Collects the properties of every node of the scene in separate arrays
+    class SnapshotCollector : public SceneVisitor
+    {
+    public:
+        SnapshotCollector(const SceneSnapshot::GetModelIdFunction& getModelId, const SceneSnapshot::NodeFilterFunction& filter)
+            : m_getModelId(getModelId), m_filter(filter) {}
+
+        // Converts the parent transforms to node indices, once all the nodes are collected
+        void ResolveParents()
+        {
+            parentIndices.clear();
+            parentIndices.reserve(m_parentTransforms.size());
+            for (const Transform* parentTransform : m_parentTransforms)
+            {
+                auto it = parentTransform ? m_transformIndices.find(parentTransform) : m_transformIndices.end();
+                parentIndices.push_back(it != m_transformIndices.end() ? it->second : SceneSnapshot::NoParent);
+            }
+        }
+
+        void VisitCamera(const SceneCamera& sceneCamera) override
+        {
+            if (m_filter && !m_filter(sceneCamera))
+            {
+                return;
+            }
+            const Camera& camera = *sceneCamera.GetCamera();
+            AddNode(sceneCamera, SceneSnapshot::NodeType::Camera, static_cast<std::uint32_t>(cameras.size()), 0);
+            cameras.push_back(SceneSnapshot::CameraData{ camera.GetViewMatrix(), camera.GetProjectionMatrix() });
+        }
+
+        void VisitLight(const SceneLight& sceneLight) override
+        {
+            if (m_filter && !m_filter(sceneLight))
+            {
+                return;
+            }
+            const Light& light = *sceneLight.GetLight();
+            SceneSnapshot::LightData lightData{};
+            lightData.type = static_cast<std::uint32_t>(light.GetType());
+            lightData.color = light.GetColor();
+            lightData.intensity = light.GetIntensity();
+            lightData.position = light.GetPosition();
+            lightData.direction = light.GetDirection();
+            lightData.attenuation = glm::vec4(0.0f);
+            if (light.GetType() == Light::Type::Point)
+            {
+                lightData.attenuation = glm::vec4(static_cast<const PointLight&>(light).GetDistanceAttenuation(), 0.0f, 0.0f);
+            }
+            else if (light.GetType() == Light::Type::Spot)
+            {
+                lightData.attenuation = light.GetAttenuation();
+            }
+            lightData.shadowBias = light.GetShadowBias();
+            lightData.shadowMapResolution = glm::ivec2(light.GetShadowMapResolution());
+
+            AddNode(sceneLight, SceneSnapshot::NodeType::Light, static_cast<std::uint32_t>(lights.size()), 0);
+            lights.push_back(lightData);
+        }
+
+        void VisitModel(const SceneModel& sceneModel) override
+        {
+            if (m_filter && !m_filter(sceneModel))
+            {
+                return;
+            }
+            AssetId modelId = sceneModel.GetModel() ? m_getModelId(*sceneModel.GetModel()) : 0;
+            if (modelId != 0)
+            {
+                AddNode(sceneModel, SceneSnapshot::NodeType::Model, 0, modelId);
+            }
+        }
+
+    private:
+        void AddNode(const SceneNode& node, SceneSnapshot::NodeType type, std::uint32_t dataIndex, AssetId modelId)
+        {
+            const std::string& name = node.GetName();
+            names.push_back(NameEntry{ static_cast<std::uint32_t>(strings.size()), static_cast<std::uint32_t>(name.size()) });
+            strings.insert(strings.end(), name.begin(), name.end());
+
+            std::uint32_t nodeIndex = static_cast<std::uint32_t>(types.size());
+            types.push_back(type);
+            dataIndices.push_back(dataIndex);
+            modelIds.push_back(modelId);
+
+            std::shared_ptr<const Transform> transform = node.GetTransform();
+            translations.push_back(transform ? transform->GetTranslation() : glm::vec3(0.0f));
+            rotations.push_back(transform ? transform->GetRotation() : glm::vec3(0.0f));
+            scales.push_back(transform ? transform->GetScale() : glm::vec3(1.0f));
+
+            // If several nodes share the transform, the first one is the parent of its children
+            if (transform)
+            {
+                m_transformIndices.emplace(transform.get(), nodeIndex);
+            }
+            m_parentTransforms.push_back(transform ? transform->GetParent().get() : nullptr);
+
+            boundsMin.push_back(node.GetAabbCenter() - node.GetAabbExtents());
+            boundsMax.push_back(node.GetAabbCenter() + node.GetAabbExtents());
+        }
+
+    public:
+        std::vector<SceneSnapshot::NodeType> types;
+        std::vector<std::uint32_t> dataIndices;
+        std::vector<NameEntry> names;
+        std::vector<AssetId> modelIds;
+        std::vector<glm::vec3> translations;
+        std::vector<glm::vec3> rotations;
+        std::vector<glm::vec3> scales;
+        std::vector<glm::vec3> boundsMin;
+        std::vector<glm::vec3> boundsMax;
+        std::vector<std::uint32_t> parentIndices;
+        std::vector<SceneSnapshot::LightData> lights;
+        std::vector<SceneSnapshot::CameraData> cameras;
+        std::vector<char> strings;
+
+    private:
+        const SceneSnapshot::GetModelIdFunction& m_getModelId;
+        const SceneSnapshot::NodeFilterFunction& m_filter;
+
+        std::unordered_map<const Transform*, std::uint32_t> m_transformIndices;
+        std::vector<const Transform*> m_parentTransforms;
+    };
+
+    std::uint64_t AlignOffset(std::uint64_t offset)
+    {
+        return (offset + ArrayAlignment - 1) / ArrayAlignment * ArrayAlignment;
+    }
+
+    // Reserves space for the array at the end of the file and returns its offset
+    template<typename T>
+    std::uint64_t AddArray(std::uint64_t& fileSize, const std::vector<T>& array)
+    {
+        std::uint64_t offset = AlignOffset(fileSize);
+        fileSize = offset + array.size() * sizeof(T);
+        return offset;
+    }
+
+    template<typename T>
+    void WriteArray(std::ofstream& stream, std::uint64_t offset, const std::vector<T>& array)
+    {
+        // Pad with zeros up to the array offset
+        std::uint64_t position = static_cast<std::uint64_t>(stream.tellp());
+        assert(position <= offset);
+        const char padding[ArrayAlignment] = {};
+        stream.write(padding, offset - position);
+        stream.write(reinterpret_cast<const char*>(array.data()), array.size() * sizeof(T));
+    }
+}
+
+SceneSnapshot::SceneSnapshot() : m_header(nullptr)
+{
+}
+
+bool SceneSnapshot::Open(const char* path)
+{
+    Close();
+
+    if (!m_file.Open(path) || m_file.GetSize() < sizeof(Header))
+    {
+        m_file.Close();
+        return false;
+    }
+
+    m_header = reinterpret_cast<const Header*>(m_file.GetData().data());
+    if (!ValidateHeader())
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void SceneSnapshot::Close()
+{
+    m_header = nullptr;
+    m_file.Close();
+}
+
+bool SceneSnapshot::ValidateHeader() const
+{
+    if (std::memcmp(m_header->magic, SnapshotMagic, sizeof(SnapshotMagic)) != 0 || m_header->version != Version)
+    {
+        return false;
+    }
+
+    // Every array must be aligned and inside the file
+    auto isValidArray = [this](std::uint64_t offset, std::uint64_t count, std::uint64_t elementSize)
+    {
+        return offset % ArrayAlignment == 0 && offset <= m_file.GetSize() && count * elementSize <= m_file.GetSize() - offset;
+    };
+    std::uint64_t nodeCount = m_header->nodeCount;
+    bool validArrays = isValidArray(m_header->typesOffset, nodeCount, sizeof(NodeType))
+        && isValidArray(m_header->dataIndicesOffset, nodeCount, sizeof(std::uint32_t))
+        && isValidArray(m_header->namesOffset, nodeCount, sizeof(NameEntry))
+        && isValidArray(m_header->modelIdsOffset, nodeCount, sizeof(AssetId))
+        && isValidArray(m_header->translationsOffset, nodeCount, sizeof(glm::vec3))
+        && isValidArray(m_header->rotationsOffset, nodeCount, sizeof(glm::vec3))
+        && isValidArray(m_header->scalesOffset, nodeCount, sizeof(glm::vec3))
+        && isValidArray(m_header->boundsMinOffset, nodeCount, sizeof(glm::vec3))
+        && isValidArray(m_header->boundsMaxOffset, nodeCount, sizeof(glm::vec3))
+        && isValidArray(m_header->parentsOffset, nodeCount, sizeof(std::uint32_t))
+        && isValidArray(m_header->lightsOffset, m_header->lightCount, sizeof(LightData))
+        && isValidArray(m_header->camerasOffset, m_header->cameraCount, sizeof(CameraData))
+        && isValidArray(m_header->stringsOffset, m_header->stringsSize, 1);
+    if (!validArrays)
+    {
+        return false;
+    }
+
+    // Every node must have a known type, and its indices must be in range
+    std::span<const NodeType> types = GetNodeTypes();
+    std::span<const std::uint32_t> dataIndices = GetArray<std::uint32_t>(m_header->dataIndicesOffset, nodeCount);
+    std::span<const std::uint32_t> parentIndices = GetParentIndices();
+    for (std::uint32_t nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+    {
+        switch (types[nodeIndex])
+        {
+        case NodeType::Model:
+            break;
+        case NodeType::Light:
+            if (dataIndices[nodeIndex] >= m_header->lightCount)
+            {
+                return false;
+            }
+            break;
+        case NodeType::Camera:
+            if (dataIndices[nodeIndex] >= m_header->cameraCount)
+            {
+                return false;
+            }
+            break;
+        default:
+            return false;
+        }
+
+        if (parentIndices[nodeIndex] != NoParent && parentIndices[nodeIndex] >= nodeCount)
+        {
+            return false;
+        }
+    }
+    return !HasParentCycle(parentIndices);
+}
+
+template<typename T>
+std::span<const T> SceneSnapshot::GetArray(std::uint64_t offset, std::uint64_t count) const
+{
+    assert(IsOpen());
+    return std::span<const T>(reinterpret_cast<const T*>(m_file.GetData().data() + offset), static_cast<size_t>(count));
+}
+
+unsigned int SceneSnapshot::GetNodeCount() const
+{
+    return m_header ? m_header->nodeCount : 0;
+}
+
+std::span<const SceneSnapshot::NodeType> SceneSnapshot::GetNodeTypes() const
+{
+    return GetArray<NodeType>(m_header->typesOffset, m_header->nodeCount);
+}
+
+std::span<const AssetId> SceneSnapshot::GetModelIds() const
+{
+    return GetArray<AssetId>(m_header->modelIdsOffset, m_header->nodeCount);
+}
+
+std::span<const glm::vec3> SceneSnapshot::GetTranslations() const
+{
+    return GetArray<glm::vec3>(m_header->translationsOffset, m_header->nodeCount);
+}
+
+std::span<const glm::vec3> SceneSnapshot::GetRotations() const
+{
+    return GetArray<glm::vec3>(m_header->rotationsOffset, m_header->nodeCount);
+}
+
+std::span<const glm::vec3> SceneSnapshot::GetScales() const
+{
+    return GetArray<glm::vec3>(m_header->scalesOffset, m_header->nodeCount);
+}
+
+std::span<const glm::vec3> SceneSnapshot::GetBoundsMin() const
+{
+    return GetArray<glm::vec3>(m_header->boundsMinOffset, m_header->nodeCount);
+}
+
+std::span<const glm::vec3> SceneSnapshot::GetBoundsMax() const
+{
+    return GetArray<glm::vec3>(m_header->boundsMaxOffset, m_header->nodeCount);
+}
+
+std::span<const std::uint32_t> SceneSnapshot::GetParentIndices() const
+{
+    return GetArray<std::uint32_t>(m_header->parentsOffset, m_header->nodeCount);
+}
+
+std::string_view SceneSnapshot::GetNodeName(unsigned int nodeIndex) const
+{
+    const NameEntry& name = GetArray<NameEntry>(m_header->namesOffset, m_header->nodeCount)[nodeIndex];
+    std::span<const char> strings = GetArray<char>(m_header->stringsOffset, m_header->stringsSize);
+    if (static_cast<std::uint64_t>(name.offset) + name.length > strings.size())
+    {
+        return std::string_view();
+    }
+    return std::string_view(strings.data() + name.offset, name.length);
+}
+
+const SceneSnapshot::LightData& SceneSnapshot::GetLightData(unsigned int nodeIndex) const
+{
+    assert(GetNodeTypes()[nodeIndex] == NodeType::Light);
+    std::uint32_t dataIndex = GetArray<std::uint32_t>(m_header->dataIndicesOffset, m_header->nodeCount)[nodeIndex];
+    assert(dataIndex < m_header->lightCount);
+    return GetArray<LightData>(m_header->lightsOffset, m_header->lightCount)[dataIndex];
+}
+
+const SceneSnapshot::CameraData& SceneSnapshot::GetCameraData(unsigned int nodeIndex) const
+{
+    assert(GetNodeTypes()[nodeIndex] == NodeType::Camera);
+    std::uint32_t dataIndex = GetArray<std::uint32_t>(m_header->dataIndicesOffset, m_header->nodeCount)[nodeIndex];
+    assert(dataIndex < m_header->cameraCount);
+    return GetArray<CameraData>(m_header->camerasOffset, m_header->cameraCount)[dataIndex];
+}
+
+std::shared_ptr<SceneNode> SceneSnapshot::CreateSceneNode(unsigned int nodeIndex, const GetModelFunction& getModel) const
+{
+    assert(nodeIndex < GetNodeCount());
+
+    std::string name(GetNodeName(nodeIndex));
+    std::shared_ptr<SceneNode> node;
+
+    switch (GetNodeTypes()[nodeIndex])
+    {
+    case NodeType::Model:
+        if (std::shared_ptr<Model> model = getModel(GetModelIds()[nodeIndex]))
+        {
+            node = std::make_shared<SceneModel>(name, model, GetBoundsMin()[nodeIndex], GetBoundsMax()[nodeIndex]);
+        }
+        break;
+    case NodeType::Light:
+        {
+            const LightData& lightData = GetLightData(nodeIndex);
+            std::shared_ptr<Light> light;
+            switch (static_cast<Light::Type>(lightData.type))
+            {
+            case Light::Type::Directional:
+                light = std::make_shared<DirectionalLight>();
+                break;
+            case Light::Type::Point:
+                {
+                    std::shared_ptr<PointLight> pointLight = std::make_shared<PointLight>();
+                    pointLight->SetDistanceAttenuation(glm::vec2(lightData.attenuation));
+                    light = pointLight;
+                }
+                break;
+            case Light::Type::Spot:
+                {
+                    std::shared_ptr<SpotLight> spotLight = std::make_shared<SpotLight>();
+                    spotLight->SetDistanceAttenuation(glm::vec2(lightData.attenuation.x, lightData.attenuation.y));
+                    spotLight->SetAngleAttenuation(glm::vec2(lightData.attenuation.z, lightData.attenuation.w));
+                    light = spotLight;
+                }
+                break;
+            default:
+                return nullptr;
+            }
+            light->SetColor(lightData.color);
+            light->SetIntensity(lightData.intensity);
+            light->SetPosition(lightData.position);
+            light->SetDirection(lightData.direction);
+            light->SetShadowBias(lightData.shadowBias);
+            light->SetShadowMapResolution(glm::vec2(lightData.shadowMapResolution));
+            node = std::make_shared<SceneLight>(name, light);
+        }
+        break;
+    case NodeType::Camera:
+        {
+            const CameraData& cameraData = GetCameraData(nodeIndex);
+            std::shared_ptr<Camera> camera = std::make_shared<Camera>();
+            camera->SetViewMatrix(cameraData.viewMatrix);
+            camera->SetProjectionMatrix(cameraData.projectionMatrix);
+            node = std::make_shared<SceneCamera>(name, camera);
+        }
+        break;
+    }
+
+    if (node)
+    {
+        std::shared_ptr<Transform> transform = node->GetTransform();
+        transform->SetTranslation(GetTranslations()[nodeIndex]);
+        transform->SetRotation(GetRotations()[nodeIndex]);
+        transform->SetScale(GetScales()[nodeIndex]);
+    }
+    return node;
+}
+
+void SceneSnapshot::AddToScene(Scene& scene, const GetModelFunction& getModel) const
+{
+    unsigned int nodeCount = GetNodeCount();
+    std::vector<std::shared_ptr<SceneNode>> nodes(nodeCount);
+    for (unsigned int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+    {
+        nodes[nodeIndex] = CreateSceneNode(nodeIndex, getModel);
+        if (nodes[nodeIndex])
+        {
+            scene.AddSceneNode(nodes[nodeIndex]);
+        }
+    }
+
+    // Link the parents once all the nodes exist, a parent can be stored after its children
+    std::span<const std::uint32_t> parentIndices = GetParentIndices();
+    for (unsigned int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+    {
+        std::uint32_t parentIndex = parentIndices[nodeIndex];
+        if (nodes[nodeIndex] && parentIndex != NoParent && nodes[parentIndex])
+        {
+            nodes[nodeIndex]->GetTransform()->SetParent(nodes[parentIndex]->GetTransform());
+        }
+    }
+}
+
+bool SceneSnapshot::Save(const char* path, const Scene& scene, const GetModelIdFunction& getModelId, const NodeFilterFunction& filter)
+{
+    SnapshotCollector collector(getModelId, filter);
+    scene.AcceptVisitor(collector);
+    collector.ResolveParents();
+
+    Header header{};
+    std::memcpy(header.magic, SnapshotMagic, sizeof(SnapshotMagic));
+    header.version = Version;
+    header.nodeCount = static_cast<std::uint32_t>(collector.types.size());
+    header.lightCount = static_cast<std::uint32_t>(collector.lights.size());
+    header.cameraCount = static_cast<std::uint32_t>(collector.cameras.size());
+    header.stringsSize = static_cast<std::uint32_t>(collector.strings.size());
+
+    // Compute the offsets of the arrays, in the same order they are written
+    std::uint64_t fileSize = sizeof(Header);
+    header.typesOffset = AddArray(fileSize, collector.types);
+    header.dataIndicesOffset = AddArray(fileSize, collector.dataIndices);
+    header.namesOffset = AddArray(fileSize, collector.names);
+    header.modelIdsOffset = AddArray(fileSize, collector.modelIds);
+    header.translationsOffset = AddArray(fileSize, collector.translations);
+    header.rotationsOffset = AddArray(fileSize, collector.rotations);
+    header.scalesOffset = AddArray(fileSize, collector.scales);
+    header.boundsMinOffset = AddArray(fileSize, collector.boundsMin);
+    header.boundsMaxOffset = AddArray(fileSize, collector.boundsMax);
+    header.parentsOffset = AddArray(fileSize, collector.parentIndices);
+    header.lightsOffset = AddArray(fileSize, collector.lights);
+    header.camerasOffset = AddArray(fileSize, collector.cameras);
+    header.stringsOffset = AddArray(fileSize, collector.strings);
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        return false;
+    }
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    WriteArray(stream, header.typesOffset, collector.types);
+    WriteArray(stream, header.dataIndicesOffset, collector.dataIndices);
+    WriteArray(stream, header.namesOffset, collector.names);
+    WriteArray(stream, header.modelIdsOffset, collector.modelIds);
+    WriteArray(stream, header.translationsOffset, collector.translations);
+    WriteArray(stream, header.rotationsOffset, collector.rotations);
+    WriteArray(stream, header.scalesOffset, collector.scales);
+    WriteArray(stream, header.boundsMinOffset, collector.boundsMin);
+    WriteArray(stream, header.boundsMaxOffset, collector.boundsMax);
+    WriteArray(stream, header.parentsOffset, collector.parentIndices);
+    WriteArray(stream, header.lightsOffset, collector.lights);
+    WriteArray(stream, header.camerasOffset, collector.cameras);
+    WriteArray(stream, header.stringsOffset, collector.strings);
+
+    return static_cast<bool>(stream);
+}
+
+AssetId SceneSnapshot::GetAssetId(std::string_view path)
+{
+    return Hash::FNV1a(path);
+}
@@ -0,0 +1,350 @@
+#include <ituGL/scene/WorldPartition.h>
+
+#include <ituGL/core/JobSystem.h>
+#include <ituGL/scene/Scene.h>
+#include <ituGL/scene/SceneModel.h>
+#include <ituGL/scene/SceneLight.h>
+#include <ituGL/scene/SceneCamera.h>
+#include <ituGL/scene/Transform.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <set>
+#include <unordered_set>
+
+namespace
+{
+    double GetTime()
+    {
+        using namespace std::chrono;
+        return duration<double>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Snapshot node indices sorted by depth in the hierarchy, so parents are created before their children
+    std::vector<unsigned int> GetNodeOrder(const SceneSnapshot& snapshot)
+    {
+        // Open rejects cycles, so every walk ends at a root
+        std::span<const std::uint32_t> parentIndices = snapshot.GetParentIndices();
+        std::vector<unsigned int> depths(parentIndices.size(), 0);
+        for (size_t i = 0; i < parentIndices.size(); ++i)
+        {
+            for (std::uint32_t parentIndex = parentIndices[i]; parentIndex != SceneSnapshot::NoParent; parentIndex = parentIndices[parentIndex])
+            {
+                ++depths[i];
+            }
+        }
+
+        std::vector<unsigned int> order(parentIndices.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) { return depths[a] < depths[b]; });
+        return order;
+    }
+}
+
+WorldPartition::WorldPartition(Scene& scene, JobSystem& jobSystem, float cellSize, const GetCellPathFunction& getCellPath, const SceneSnapshot::GetModelFunction& getModel)
+    : m_scene(scene)
+    , m_jobSystem(jobSystem)
+    , m_cellSize(cellSize)
+    , m_loadRadius(cellSize)
+    , m_unloadRadius(cellSize * 1.5f)
+    , m_timeBudget(0.002)
+    , m_getCellPath(getCellPath)
+    , m_getModel(getModel)
+{
+    assert(cellSize > 0.0f);
+    assert(getCellPath && getModel);
+}
+
+WorldPartition::~WorldPartition()
+{
+    UnloadAll();
+}
+
+void WorldPartition::SetRadius(float loadRadius, float unloadRadius)
+{
+    assert(loadRadius <= unloadRadius);
+    m_loadRadius = loadRadius;
+    m_unloadRadius = unloadRadius;
+}
+
+void WorldPartition::Update(const glm::vec3& position)
+{
+    double endTime = GetTime() + m_timeBudget;
+
+    RequestCells(position);
+    ReleaseCells(position, endTime);
+    IntegrateCells(position, endTime);
+}
+
+void WorldPartition::UnloadAll()
+{
+    for (auto& pair : m_cells)
+    {
+        RemoveCellNodes(pair.second);
+    }
+    m_cells.clear();
+}
+
+unsigned int WorldPartition::GetCellCount() const
+{
+    return static_cast<unsigned int>(m_cells.size());
+}
+
+unsigned int WorldPartition::GetActiveCellCount() const
+{
+    unsigned int count = 0;
+    for (const auto& pair : m_cells)
+    {
+        const CellData& data = *pair.second.data;
+        if (data.ready && pair.second.nextNodeIndex == data.snapshot.GetNodeCount())
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+glm::ivec2 WorldPartition::GetCell(const glm::vec3& position) const
+{
+    return glm::ivec2(std::floor(position.x / m_cellSize), std::floor(position.z / m_cellSize));
+}
+
+std::uint64_t WorldPartition::GetCellKey(glm::ivec2 cell)
+{
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell.x)) << 32) | static_cast<std::uint32_t>(cell.y);
+}
+
+float WorldPartition::GetDistanceToCell(const glm::vec3& position, glm::ivec2 cell) const
+{
+    // Distance on the XZ plane to the closest point of the cell
+    glm::vec2 cellMin = glm::vec2(cell) * m_cellSize;
+    glm::vec2 point(position.x, position.z);
+    glm::vec2 closestPoint = glm::clamp(point, cellMin, cellMin + m_cellSize);
+    return glm::distance(point, closestPoint);
+}
+
+void WorldPartition::RequestCells(const glm::vec3& position)
+{
+    glm::ivec2 centerCell = GetCell(position);
+    int cellRadius = static_cast<int>(std::ceil(m_loadRadius / m_cellSize));
+
+    for (int y = -cellRadius; y <= cellRadius; ++y)
+    {
+        for (int x = -cellRadius; x <= cellRadius; ++x)
+        {
+            glm::ivec2 coordinates = centerCell + glm::ivec2(x, y);
+            std::uint64_t key = GetCellKey(coordinates);
+            if (m_cells.find(key) != m_cells.end() || GetDistanceToCell(position, coordinates) > m_loadRadius)
+            {
+                continue;
+            }
+
+            Cell& cell = m_cells[key];
+            cell.coordinates = coordinates;
+            cell.namePrefix = GetNodeNamePrefix(coordinates);
+            cell.data = std::make_shared<CellData>();
+
+            // Map the snapshot in the background. Missing files are valid, and produce empty cells
+            std::shared_ptr<CellData> data = cell.data;
+            std::string path = m_getCellPath(coordinates);
+            m_jobSystem.Schedule([data, path]()
+                {
+                    // Read the pages here, so the main thread doesn't wait for the disk when creating the nodes
+                    if (data->snapshot.Open(path.c_str()))
+                    {
+                        data->snapshot.Prefetch();
+                        data->nodeOrder = GetNodeOrder(data->snapshot);
+                    }
+                    data->ready.store(true, std::memory_order_release);
+                });
+        }
+    }
+}
+
+void WorldPartition::ReleaseCells(const glm::vec3& position, double endTime)
+{
+    bool releasedCells = false;
+    for (auto it = m_cells.begin(); it != m_cells.end();)
+    {
+        Cell& cell = it->second;
+        if (GetDistanceToCell(position, cell.coordinates) <= m_unloadRadius)
+        {
+            ++it;
+            continue;
+        }
+
+        // Remove nodes a few at a time, the cell is erased when it is empty
+        // Children are removed before their parents. If the cell comes back in range before it is empty, the removed nodes are integrated again
+        while (!cell.addedNodes.empty() && GetTime() < endTime)
+        {
+            unsigned int orderIndex = cell.addedNodes.back();
+            std::shared_ptr<SceneNode>& node = cell.nodes[cell.data->nodeOrder[orderIndex]];
+            m_scene.RemoveSceneNode(node);
+            node.reset();
+            cell.nextNodeIndex = orderIndex;
+            cell.addedNodes.pop_back();
+        }
+
+        if (cell.addedNodes.empty())
+        {
+            it = m_cells.erase(it);
+            releasedCells = true;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // Forget the models that are not used anymore
+    if (releasedCells)
+    {
+        std::erase_if(m_models, [](const auto& pair) { return pair.second.expired(); });
+    }
+}
+
+void WorldPartition::IntegrateCells(const glm::vec3& position, double endTime)
+{
+    for (auto& pair : m_cells)
+    {
+        // Skip cells still loading, and cells being removed
+        Cell& cell = pair.second;
+        if (!cell.data->ready.load(std::memory_order_acquire) || GetDistanceToCell(position, cell.coordinates) > m_unloadRadius)
+        {
+            continue;
+        }
+
+        const SceneSnapshot& snapshot = cell.data->snapshot;
+        const std::vector<unsigned int>& nodeOrder = cell.data->nodeOrder;
+        unsigned int nodeCount = snapshot.GetNodeCount();
+        cell.nodes.resize(nodeCount);
+        while (cell.nextNodeIndex < nodeCount)
+        {
+            if (GetTime() >= endTime)
+            {
+                return;
+            }
+
+            unsigned int orderIndex = cell.nextNodeIndex++;
+            unsigned int nodeIndex = nodeOrder[orderIndex];
+            std::shared_ptr<SceneNode> node = snapshot.CreateSceneNode(nodeIndex, [this](AssetId modelId) { return GetModel(modelId); });
+            if (node)
+            {
+                // The parent was added before. If it was skipped, the node keeps no parent, like in SceneSnapshot::AddToScene
+                std::uint32_t parentIndex = snapshot.GetParentIndices()[nodeIndex];
+                if (parentIndex != SceneSnapshot::NoParent && cell.nodes[parentIndex])
+                {
+                    node->GetTransform()->SetParent(cell.nodes[parentIndex]->GetTransform());
+                }
+
+                // Scene replaces nodes with the same name, and other cells may use it
+                node->Rename(cell.namePrefix + node->GetName());
+                m_scene.AddSceneNode(node);
+                cell.nodes[nodeIndex] = node;
+                cell.addedNodes.push_back(orderIndex);
+            }
+        }
+    }
+}
+
+void WorldPartition::RemoveCellNodes(Cell& cell)
+{
+    for (std::shared_ptr<SceneNode>& node : cell.nodes)
+    {
+        if (node)
+        {
+            m_scene.RemoveSceneNode(node);
+        }
+    }
+    cell.nodes.clear();
+    cell.addedNodes.clear();
+    cell.nextNodeIndex = 0;
+}
+
+std::shared_ptr<Model> WorldPartition::GetModel(AssetId modelId)
+{
+    // Reuse the model if another cell still uses it
+    std::weak_ptr<Model>& cachedModel = m_models[modelId];
+    std::shared_ptr<Model> model = cachedModel.lock();
+    if (!model)
+    {
+        model = m_getModel(modelId);
+        cachedModel = model;
+    }
+    return model;
+}
+
+std::string WorldPartition::GetNodeNamePrefix(glm::ivec2 cell)
+{
+    return "cell(" + std::to_string(cell.x) + "," + std::to_string(cell.y) + ")/";
+}
+
+bool WorldPartition::SaveCells(const Scene& scene, float cellSize, const GetCellPathFunction& getCellPath, const SceneSnapshot::GetModelIdFunction& getModelId)
+{
+    // Find the nodes that are stored. Models without id are skipped by the snapshot
+    struct CellCollector : public SceneVisitor
+    {
+        std::function<void(const SceneNode&)> addNode;
+        std::function<bool(const Model&)> isStored;
+        void VisitCamera(const SceneCamera& node) override { addNode(node); }
+        void VisitLight(const SceneLight& node) override { addNode(node); }
+        void VisitModel(const SceneModel& node) override
+        {
+            if (node.GetModel() && isStored(*node.GetModel()))
+            {
+                addNode(node);
+            }
+        }
+    };
+    std::vector<const SceneNode*> nodes;
+    std::unordered_set<const Transform*> nodeTransforms;
+    CellCollector collector;
+    collector.isStored = [&](const Model& model) { return getModelId(model) != 0; };
+    collector.addNode = [&](const SceneNode& node)
+    {
+        nodes.push_back(&node);
+        nodeTransforms.insert(node.GetTransform().get());
+    };
+    scene.AcceptVisitor(collector);
+
+    // Each hierarchy goes to the cell of its root, so the local transforms stay valid and the parents can be linked when streaming
+    // Parents that are not stored would be lost, and the nodes would move
+    std::unordered_map<const SceneNode*, glm::ivec2> nodeCells;
+    std::set<std::pair<int, int>> cells;
+    for (const SceneNode* node : nodes)
+    {
+        std::shared_ptr<const Transform> root = node->GetTransform();
+        while (root && root->GetParent())
+        {
+            root = root->GetParent();
+            if (nodeTransforms.find(root.get()) == nodeTransforms.end())
+            {
+                std::cout << "ERROR::WORLD_PARTITION::PARENT_NOT_SAVED: " << node->GetName() << std::endl;
+                return false;
+            }
+        }
+
+        glm::vec3 position = root ? root->GetTranslation() : glm::vec3(0.0f);
+        glm::ivec2 cell(std::floor(position.x / cellSize), std::floor(position.z / cellSize));
+        nodeCells[node] = cell;
+        cells.emplace(cell.x, cell.y);
+    }
+
+    bool success = true;
+    for (const auto& cell : cells)
+    {
+        glm::ivec2 coordinates(cell.first, cell.second);
+        success &= SceneSnapshot::Save(getCellPath(coordinates).c_str(), scene, getModelId,
+            [&](const SceneNode& node)
+            {
+                auto it = nodeCells.find(&node);
+                return it != nodeCells.end() && it->second == coordinates;
+            });
+    }
+    return success;
+}
@@ -2,12 +2,13 @@
 #include <ituGL/core/DeviceGL.h>
 #include <cassert>
 
-Material::Material() : Material(nullptr)
+Material::Material() : Material(std::shared_ptr<ShaderProgram>())
 {
 }
 
 Material::Material(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet& filteredUniforms)
     : ShaderUniformCollection(shaderProgram, filteredUniforms)
+    , m_keywords(0)
     , m_depthTestFunction(TestFunction::Less)
     , m_depthWrite(true)
     , m_stencilTestFunctions{ TestFunction::Never, TestFunction::Never }
@@ -22,6 +23,71 @@ Material::Material(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet&
 {
 }
 
+Material::Material(std::shared_ptr<ShaderProgramVariants> shaderVariants, const NameSet& filteredUniforms)
+    : Material(shaderVariants->GetVariant(shaderVariants->GetAllKeywordsMask()), filteredUniforms)
+{
+    m_shaderVariants = shaderVariants;
+}
+
+std::shared_ptr<ShaderProgramVariants> Material::GetShaderVariants() const
+{
+    return m_shaderVariants;
+}
+
+Material::KeywordMask Material::GetKeywords() const
+{
+    return m_keywords;
+}
+
+void Material::SetKeywords(KeywordMask keywords)
+{
+    m_keywords = keywords;
+}
+
+void Material::SetKeywordEnabled(const char* keyword, bool enabled)
+{
+    assert(m_shaderVariants);
+    KeywordMask keywordMask = m_shaderVariants->GetKeywordMask(keyword);
+    m_keywords = enabled ? (m_keywords | keywordMask) : (m_keywords & ~keywordMask);
+}
+
+std::shared_ptr<const ShaderProgram> Material::GetShaderProgramVariant(KeywordMask extraKeywords) const
+{
+    return FindShaderProgramVariant(extraKeywords);
+}
+
+void Material::RefreshUniforms()
+{
+    ShaderUniformCollection::RefreshUniforms();
+    // Locations in the variants may have changed
+    m_variantLocationMaps.clear();
+}
+
+std::shared_ptr<ShaderProgram> Material::FindShaderProgramVariant(KeywordMask extraKeywords) const
+{
+    if (m_shaderVariants)
+    {
+        KeywordMask keywords = m_keywords | extraKeywords;
+        std::shared_ptr<ShaderProgram> shaderProgram = m_shaderVariants->GetVariant(keywords);
+        // If the variant doesn't build, use the one with all the keywords
+        if (shaderProgram)
+        {
+            return shaderProgram;
+        }
+    }
+    return m_shaderProgram;
+}
+
+const Material::LocationMap& Material::GetVariantLocationMap(const ShaderProgram& shaderProgram) const
+{
+    auto itLocationMap = m_variantLocationMaps.find(&shaderProgram);
+    if (itLocationMap == m_variantLocationMaps.end())
+    {
+        itLocationMap = m_variantLocationMaps.emplace(&shaderProgram, GetLocationMap(shaderProgram)).first;
+    }
+    return itLocationMap->second;
+}
+
 void Material::SetShaderSetupFunction(ShaderSetupFunction shaderSetupFunction)
 {
     m_shaderSetupFunction = shaderSetupFunction;
@@ -182,19 +248,34 @@ void Material::SetCullMode(CullMode cullmode)
 }
 
 void Material::Use(OverrideFlags overrideFlags) const
+{
+    UseVariant(0, overrideFlags);
+}
+
+void Material::UseVariant(KeywordMask extraKeywords, OverrideFlags overrideFlags) const
 {
     assert(m_shaderProgram);
 
+    std::shared_ptr<ShaderProgram> shaderProgram = FindShaderProgramVariant(extraKeywords);
+
     // Set the shader program as the one currently in use
-    m_shaderProgram->Use();
+    shaderProgram->Use();
 
     // Set the value of all the uniforms stored as properties
-    SetUniforms();
+    if (shaderProgram == m_shaderProgram)
+    {
+        SetUniforms();
+    }
+    else
+    {
+        // The locations of the properties are different in each variant
+        SetUniforms(*shaderProgram, GetVariantLocationMap(*shaderProgram));
+    }
 
     if (m_shaderSetupFunction)
     {
         // if needed, do extra set up for the shader
-        m_shaderSetupFunction(*m_shaderProgram);
+        m_shaderSetupFunction(*shaderProgram);
     }
 
     // If not skipped, set the depth settings
@@ -8,7 +8,7 @@
 ShaderProgram::Handle ShaderProgram::s_usedHandle = ShaderProgram::NullHandle;
 #endif
 
-ShaderProgram::ShaderProgram() : Object(NullHandle)
+ShaderProgram::ShaderProgram() : Object(NullHandle), m_appliedUniformsId(0), m_appliedUniformsSerial(0)
 {
     Handle& handle = GetHandle();
     handle = glCreateProgram();
@@ -25,12 +25,15 @@ ShaderProgram::~ShaderProgram()
 }
 
 ShaderProgram::ShaderProgram(ShaderProgram&& shaderProgram) noexcept : Object(std::move(shaderProgram))
+    , m_appliedUniformsId(shaderProgram.m_appliedUniformsId), m_appliedUniformsSerial(shaderProgram.m_appliedUniformsSerial)
 {
 }
 
 ShaderProgram& ShaderProgram::operator = (ShaderProgram&& shaderProgram) noexcept
 {
     Object::operator=(std::move(shaderProgram));
+    m_appliedUniformsId = shaderProgram.m_appliedUniformsId;
+    m_appliedUniformsSerial = shaderProgram.m_appliedUniformsSerial;
     return *this;
 }
 
@@ -97,6 +100,8 @@ bool ShaderProgram::Link()
 {
     assert(IsValid());
     glLinkProgram(GetHandle());
+    // Linking resets the values of the uniforms
+    SetAppliedUniforms(0, 0);
     return IsLinked();
 }
 
@@ -110,6 +115,39 @@ bool ShaderProgram::IsLinked() const
     return success;
 }
 
+void ShaderProgram::SetBinaryRetrievable(bool retrievable)
+{
+    assert(IsValid());
+    glProgramParameteri(GetHandle(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, retrievable ? GL_TRUE : GL_FALSE);
+}
+
+bool ShaderProgram::GetBinary(std::vector<std::byte>& binary, GLenum& binaryFormat) const
+{
+    assert(IsValid());
+
+    GLint binaryLength = 0;
+    glGetProgramiv(GetHandle(), GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    if (binaryLength <= 0)
+    {
+        binary.clear();
+        return false;
+    }
+
+    binary.resize(binaryLength);
+    GLsizei length = 0;
+    glGetProgramBinary(GetHandle(), binaryLength, &length, &binaryFormat, binary.data());
+    binary.resize(length);
+    return length > 0;
+}
+
+bool ShaderProgram::SetBinary(std::span<const std::byte> binary, GLenum binaryFormat)
+{
+    assert(IsValid());
+    glProgramBinary(GetHandle(), binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+    SetAppliedUniforms(0, 0);
+    return IsLinked();
+}
+
 // Get a string with linking error messages
 // The max length of the string returned is determined by the capacity of the span
 void ShaderProgram::GetLinkingErrors(std::span<char> errors) const
@@ -160,6 +198,41 @@ void ShaderProgram::GetUniformInfo(unsigned int index, int& size, GLenum& glType
     glGetActiveUniform(GetHandle(), index, uniformName.size(), nullptr, &size, &glType, uniformName.data());
 }
 
+// Get the layout of a uniform inside its uniform block
+void ShaderProgram::GetUniformBlockMemberInfo(unsigned int index, int& blockIndex, int& offset, int& arrayStride, int& matrixStride) const
+{
+    GLuint uniformIndex = index;
+    glGetActiveUniformsiv(GetHandle(), 1, &uniformIndex, GL_UNIFORM_BLOCK_INDEX, &blockIndex);
+    glGetActiveUniformsiv(GetHandle(), 1, &uniformIndex, GL_UNIFORM_OFFSET, &offset);
+    glGetActiveUniformsiv(GetHandle(), 1, &uniformIndex, GL_UNIFORM_ARRAY_STRIDE, &arrayStride);
+    glGetActiveUniformsiv(GetHandle(), 1, &uniformIndex, GL_UNIFORM_MATRIX_STRIDE, &matrixStride);
+}
+
+// Find a uniform block by name
+ShaderProgram::Location ShaderProgram::GetUniformBlockIndex(const char* name) const
+{
+    assert(IsValid());
+    assert(IsLinked());
+    GLuint blockIndex = glGetUniformBlockIndex(GetHandle(), name);
+    return blockIndex != GL_INVALID_INDEX ? static_cast<Location>(blockIndex) : -1;
+}
+
+// Get the size of the data of a uniform block, with its layout
+int ShaderProgram::GetUniformBlockSize(Location blockIndex) const
+{
+    assert(blockIndex >= 0);
+    GLint size = 0;
+    glGetActiveUniformBlockiv(GetHandle(), blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+    return size;
+}
+
+// Set the binding point of a uniform block
+void ShaderProgram::SetUniformBlockBinding(Location blockIndex, GLuint binding) const
+{
+    assert(blockIndex >= 0);
+    glUniformBlockBinding(GetHandle(), blockIndex, binding);
+}
+
 // All the different combinations of Get/SetUniform
 template<>
 void ShaderProgram::GetUniform<GLint>(Location location, std::span<GLint> value) const
@@ -0,0 +1,163 @@
+#include <ituGL/shader/ShaderProgramVariants.h>
+
+#include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/asset/VirtualFileSystem.h>
+#include <cassert>
+#include <iostream>
+#include <sstream>
+
+ShaderProgramVariants::ShaderProgramVariants(std::span<const char* const> keywords, const BuildFunction& buildFunction)
+    : m_keywords(keywords.begin(), keywords.end())
+    , m_buildFunction(buildFunction)
+{
+    assert(m_keywords.size() <= sizeof(KeywordMask) * 8);
+    assert(m_buildFunction);
+}
+
+unsigned int ShaderProgramVariants::GetKeywordCount() const
+{
+    return static_cast<unsigned int>(m_keywords.size());
+}
+
+const std::string& ShaderProgramVariants::GetKeyword(unsigned int index) const
+{
+    return m_keywords[index];
+}
+
+ShaderProgramVariants::KeywordMask ShaderProgramVariants::GetKeywordMask(std::string_view keyword) const
+{
+    for (unsigned int i = 0; i < m_keywords.size(); ++i)
+    {
+        if (m_keywords[i] == keyword)
+        {
+            return 1u << i;
+        }
+    }
+    return 0;
+}
+
+ShaderProgramVariants::KeywordMask ShaderProgramVariants::GetAllKeywordsMask() const
+{
+    return m_keywords.size() < sizeof(KeywordMask) * 8 ? (1u << m_keywords.size()) - 1 : ~0u;
+}
+
+void ShaderProgramVariants::SetVariantBuiltFunction(const VariantBuiltFunction& variantBuiltFunction)
+{
+    m_variantBuiltFunction = variantBuiltFunction;
+}
+
+std::shared_ptr<ShaderProgram> ShaderProgramVariants::GetVariant(KeywordMask keywords)
+{
+    auto itVariant = m_variants.find(keywords);
+    if (itVariant != m_variants.end())
+    {
+        return itVariant->second;
+    }
+
+    std::shared_ptr<ShaderProgram> shaderProgram = std::make_shared<ShaderProgram>();
+    if (!m_buildFunction(*shaderProgram, GetDefines(keywords)))
+    {
+        std::cout << "ERROR::SHADER_VARIANTS::BUILD_FAILED: " << keywords << std::endl;
+        shaderProgram = nullptr;
+    }
+    m_variants.emplace(keywords, shaderProgram);
+
+    if (shaderProgram && m_variantBuiltFunction)
+    {
+        m_variantBuiltFunction(keywords, shaderProgram);
+    }
+    return shaderProgram;
+}
+
+bool ShaderProgramVariants::HasVariant(KeywordMask keywords) const
+{
+    return m_variants.contains(keywords);
+}
+
+unsigned int ShaderProgramVariants::GetVariantCount() const
+{
+    return static_cast<unsigned int>(m_variants.size());
+}
+
+bool ShaderProgramVariants::LoadManifest(const char* path)
+{
+    VirtualFile manifestFile;
+    if (!VirtualFileSystem::GetDefault().Open(path, manifestFile))
+    {
+        std::cout << "ERROR::SHADER_VARIANTS::MANIFEST_NOT_FOUND: " << path << std::endl;
+        return false;
+    }
+
+    bool success = true;
+    std::istringstream file{ std::string(manifestFile.GetText()) };
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream lineStream(line);
+        std::string keyword;
+        if (!(lineStream >> keyword) || keyword[0] == '#')
+        {
+            continue;
+        }
+
+        KeywordMask keywords = 0;
+        do
+        {
+            KeywordMask keywordMask = GetKeywordMask(keyword);
+            if (keywordMask == 0)
+            {
+                std::cout << "ERROR::SHADER_VARIANTS::UNKNOWN_KEYWORD: " << keyword << " in " << path << std::endl;
+                success = false;
+            }
+            keywords |= keywordMask;
+        } while (lineStream >> keyword);
+
+        success &= GetVariant(keywords) != nullptr;
+    }
+    return success;
+}
+
+bool ShaderProgramVariants::Rebuild()
+{
+    bool success = true;
+    for (auto itVariant = m_variants.begin(); itVariant != m_variants.end(); )
+    {
+        // Forget the failed variants, the new sources may fix them
+        if (!itVariant->second)
+        {
+            itVariant = m_variants.erase(itVariant);
+            continue;
+        }
+
+        ShaderProgram shaderProgram;
+        if (m_buildFunction(shaderProgram, GetDefines(itVariant->first)))
+        {
+            // Same object, so everyone holding the variant gets the new program
+            *itVariant->second = std::move(shaderProgram);
+            if (m_variantBuiltFunction)
+            {
+                m_variantBuiltFunction(itVariant->first, itVariant->second);
+            }
+        }
+        else
+        {
+            std::cout << "ERROR::SHADER_VARIANTS::REBUILD_FAILED: " << itVariant->first << std::endl;
+            success = false;
+        }
+        ++itVariant;
+    }
+    return success;
+}
+
+std::vector<std::string> ShaderProgramVariants::GetDefines(KeywordMask keywords) const
+{
+    std::vector<std::string> defines;
+    for (unsigned int i = 0; i < m_keywords.size(); ++i)
+    {
+        if (keywords & (1u << i))
+        {
+            defines.push_back(m_keywords[i]);
+        }
+    }
+    return defines;
+}
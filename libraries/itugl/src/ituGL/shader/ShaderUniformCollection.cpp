@@ -1,16 +1,46 @@
 #include <ituGL/shader/ShaderUniformCollection.h>
 #include <cassert>
 #include <array>
+#include <atomic>
 
-ShaderUniformCollection::ShaderUniformCollection() : m_shaderProgram(nullptr)
+ShaderUniformCollection::Statistics ShaderUniformCollection::s_statistics;
+
+// Materials can be created by the loading threads
+ShaderUniformCollection::ValuesId::ValuesId()
 {
+    static std::atomic<unsigned long long> s_nextValue = 1;
+    value = s_nextValue++;
 }
 
-ShaderUniformCollection::ShaderUniformCollection(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet& filteredUniforms) : m_shaderProgram(shaderProgram)
+ShaderUniformCollection::ShaderUniformCollection() : m_shaderProgram(nullptr), m_materialBlockIndex(-1), m_changeSerial(0), m_materialBlockDirty(false)
+{
+}
+
+ShaderUniformCollection::ShaderUniformCollection(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet& filteredUniforms)
+    : m_shaderProgram(shaderProgram), m_filteredUniforms(filteredUniforms), m_materialBlockIndex(-1), m_changeSerial(0), m_materialBlockDirty(false)
 {
     ExtractUniforms(filteredUniforms);
 }
 
+ShaderUniformCollection::ShaderUniformCollection(const ShaderUniformCollection& other)
+    : m_shaderProgram(other.m_shaderProgram), m_filteredUniforms(other.m_filteredUniforms)
+    , m_dataUniforms(other.m_dataUniforms), m_textureUniforms(other.m_textureUniforms)
+    , m_locationDataIndex(other.m_locationDataIndex), m_locationTextureIndex(other.m_locationTextureIndex)
+    , m_intDataValues(other.m_intDataValues), m_uintDataValues(other.m_uintDataValues)
+    , m_floatDataValues(other.m_floatDataValues), m_doubleDataValues(other.m_doubleDataValues)
+    , m_materialBlockIndex(other.m_materialBlockIndex), m_blockLocations(other.m_blockLocations)
+    , m_valuesId(other.m_valuesId), m_changeSerial(other.m_changeSerial)
+    , m_materialBlockData(other.m_materialBlockData), m_materialBlockDirty(true), m_uniformBufferPool(other.m_uniformBufferPool)
+{
+    // The allocation is left empty, the block is packed and uploaded to a new range when it is used
+}
+
+ShaderUniformCollection& ShaderUniformCollection::operator = (const ShaderUniformCollection& other)
+{
+    // Moving an empty allocation in releases the current range
+    return *this = ShaderUniformCollection(other);
+}
+
 std::shared_ptr<ShaderProgram> ShaderUniformCollection::GetShaderProgram()
 {
     return m_shaderProgram;
@@ -23,9 +53,68 @@ std::shared_ptr<const ShaderProgram> ShaderUniformCollection::GetShaderProgram()
 
 void ShaderUniformCollection::ChangeShader(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet& filteredUniforms)
 {
+    // Move the current properties away, to copy their values after extracting the new ones
+    ShaderUniformCollection previous(std::move(*this));
     Reset();
+    m_uniformBufferPool = previous.m_uniformBufferPool;
     m_shaderProgram = shaderProgram;
+    m_filteredUniforms = filteredUniforms;
     ExtractUniforms(filteredUniforms);
+    CopyUniformValues(previous);
+}
+
+void ShaderUniformCollection::RefreshUniforms()
+{
+    // Copied, ChangeShader replaces the member
+    NameSet filteredUniforms = m_filteredUniforms;
+    ChangeShader(m_shaderProgram, filteredUniforms);
+}
+
+void ShaderUniformCollection::CopyUniformValues(const ShaderUniformCollection& source)
+{
+    std::unordered_map<std::string_view, const DataUniform*> sourceDataUniforms;
+    for (const DataUniform& sourceUniform : source.m_dataUniforms)
+    {
+        sourceDataUniforms[sourceUniform.name] = &sourceUniform;
+    }
+    for (const DataUniform& uniform : m_dataUniforms)
+    {
+        auto itSource = sourceDataUniforms.find(uniform.name);
+        if (itSource == sourceDataUniforms.end() || itSource->second->type != uniform.type || itSource->second->dimension != uniform.dimension)
+        {
+            continue;
+        }
+
+        switch (uniform.type)
+        {
+        case Data::Type::Int:
+            CopyDataValues<int>(uniform, source, *itSource->second);
+            break;
+        case Data::Type::UInt:
+            CopyDataValues<unsigned int>(uniform, source, *itSource->second);
+            break;
+        case Data::Type::Float:
+            CopyDataValues<float>(uniform, source, *itSource->second);
+            break;
+        case Data::Type::Double:
+            CopyDataValues<double>(uniform, source, *itSource->second);
+            break;
+        default:
+            assert(false);
+        }
+    }
+
+    for (TextureUniform& uniform : m_textureUniforms)
+    {
+        for (const TextureUniform& sourceUniform : source.m_textureUniforms)
+        {
+            if (sourceUniform.name == uniform.name && sourceUniform.target == uniform.target)
+            {
+                uniform.texture = sourceUniform.texture;
+                break;
+            }
+        }
+    }
 }
 
 ShaderProgram::Location ShaderUniformCollection::GetAttributeLocation(const char* name) const
@@ -35,6 +124,11 @@ ShaderProgram::Location ShaderUniformCollection::GetAttributeLocation(const char
 
 ShaderProgram::Location ShaderUniformCollection::GetUniformLocation(const char* name) const
 {
+    auto itBlockLocation = m_blockLocations.find(name);
+    if (itBlockLocation != m_blockLocations.end())
+    {
+        return itBlockLocation->second;
+    }
     return m_shaderProgram->GetUniformLocation(name);
 }
 
@@ -70,6 +164,14 @@ void ShaderUniformCollection::ExtractUniforms(const NameSet& filteredUniforms)
 
     ShaderProgram& shaderProgram = *m_shaderProgram;
 
+    m_materialBlockIndex = shaderProgram.GetUniformBlockIndex(MaterialBlockName);
+    if (m_materialBlockIndex >= 0)
+    {
+        shaderProgram.SetUniformBlockBinding(m_materialBlockIndex, MaterialBlockBinding);
+        m_materialBlockData.assign(shaderProgram.GetUniformBlockSize(m_materialBlockIndex), std::byte(0));
+        m_materialBlockDirty = true;
+    }
+
     unsigned int uniformCount = shaderProgram.GetUniformCount();
 
     // Loop over all the uniforms
@@ -85,8 +187,31 @@ void ShaderUniformCollection::ExtractUniforms(const NameSet& filteredUniforms)
         if (filteredUniforms.contains(uniformName))
             continue;
 
-        // Get the uniform location
-        ShaderProgram::Location location = GetUniformLocation(uniformName);
+        int blockIndex, blockOffset, arrayStride, matrixStride;
+        shaderProgram.GetUniformBlockMemberInfo(i, blockIndex, blockOffset, arrayStride, matrixStride);
+
+        // Only the members of the material block are properties, other blocks are set by someone else
+        if (blockIndex >= 0 && blockIndex != m_materialBlockIndex)
+            continue;
+
+        // Get the uniform location. Block members get the next location after the previous members
+        ShaderProgram::Location location;
+        if (blockIndex >= 0)
+        {
+            location = BlockLocationBase + static_cast<ShaderProgram::Location>(m_blockLocations.size());
+            std::string name = uniformName;
+            m_blockLocations[name] = location;
+            // Arrays are also found without the index, like the uniforms outside the block
+            if (name.ends_with("[0]"))
+            {
+                m_blockLocations[name.substr(0, name.size() - 3)] = location;
+            }
+        }
+        else
+        {
+            location = GetUniformLocation(uniformName);
+            blockOffset = arrayStride = matrixStride = -1;
+        }
         assert(location >= 0);
 
         Data::Type type;
@@ -96,18 +221,27 @@ void ShaderUniformCollection::ExtractUniforms(const NameSet& filteredUniforms)
         {
             // If it is a data property, store as data
             DataUniform uniform;
+            uniform.name = uniformName;
             uniform.location = location;
             uniform.type = type;
             uniform.dimension = dimension;
             uniform.count = size;
+            uniform.blockOffset = blockOffset;
+            // Zero for single values, the element loop in PackBlockValues doesn't use them
+            uniform.arrayStride = std::max(arrayStride, 0);
+            uniform.matrixStride = std::max(matrixStride, 0);
+            uniform.serial = m_changeSerial;
             AddUniform(uniform);
         }
         else if (IsTextureUniform(glType, target))
         {
+            assert(blockIndex < 0);
             // If it is a texture property, store as property
             TextureUniform uniform;
+            uniform.name = uniformName;
             uniform.location = location;
             uniform.target = target;
+            uniform.serial = m_changeSerial;
             AddUniform(uniform);
         }
         else
@@ -289,91 +423,288 @@ void ShaderUniformCollection::AddUniform(const TextureUniform& uniform)
 
 void ShaderUniformCollection::SetUniforms() const
 {
+    SetUniforms(*m_shaderProgram, nullptr);
+}
+
+void ShaderUniformCollection::SetUniforms(const ShaderProgram& shaderProgram, const LocationMap& locations) const
+{
+    SetUniforms(shaderProgram, &locations);
+}
+
+void ShaderUniformCollection::SetUniforms(const ShaderProgram& shaderProgram, const LocationMap* locations) const
+{
+    // If another collection was set to the program after this one, the program has its values instead
+    unsigned long long appliedId, appliedSerial;
+    shaderProgram.GetAppliedUniforms(appliedId, appliedSerial);
+    bool setAll = appliedId != m_valuesId.value;
+
     for (const DataUniform& uniform : m_dataUniforms)
     {
-        UseUniform(uniform);
+        // Block members are in the uniform buffer
+        if (uniform.blockOffset >= 0)
+        {
+            continue;
+        }
+
+        ShaderProgram::Location targetLocation = uniform.location;
+        if (locations)
+        {
+            auto itLocation = locations->find(uniform.location);
+            if (itLocation == locations->end())
+            {
+                continue;
+            }
+            targetLocation = itLocation->second;
+        }
+
+        if (setAll || uniform.serial > appliedSerial)
+        {
+            UseUniform(uniform, shaderProgram, targetLocation);
+            ++s_statistics.uniformCount;
+        }
+        else
+        {
+            ++s_statistics.skippedUniformCount;
+        }
     }
     for (const TextureUniform& uniform : m_textureUniforms)
     {
-        UseUniform(uniform);
+        ShaderProgram::Location targetLocation = uniform.location;
+        if (locations)
+        {
+            auto itLocation = locations->find(uniform.location);
+            if (itLocation == locations->end())
+            {
+                continue;
+            }
+            targetLocation = itLocation->second;
+        }
+
+        UseUniform(uniform, shaderProgram, targetLocation, setAll || uniform.serial > appliedSerial);
+    }
+
+    shaderProgram.SetAppliedUniforms(m_valuesId.value, m_changeSerial);
+
+    // Variants declare the same block, with the same layout
+    UseMaterialBlock();
+}
+
+const ShaderUniformCollection::Statistics& ShaderUniformCollection::GetStatistics()
+{
+    return s_statistics;
+}
+
+void ShaderUniformCollection::ResetStatistics()
+{
+    s_statistics = Statistics();
+}
+
+std::shared_ptr<UniformBufferPool> ShaderUniformCollection::GetUniformBufferPool() const
+{
+    return m_uniformBufferPool;
+}
+
+void ShaderUniformCollection::SetUniformBufferPool(std::shared_ptr<UniformBufferPool> uniformBufferPool)
+{
+    if (uniformBufferPool != m_uniformBufferPool)
+    {
+        // Allocated again from the new pool on the next use
+        m_materialBlockAllocation.Release();
+        m_uniformBufferPool = uniformBufferPool;
+    }
+}
+
+void ShaderUniformCollection::UseMaterialBlock() const
+{
+    if (m_materialBlockIndex < 0)
+    {
+        return;
+    }
+
+    if (!m_materialBlockAllocation.IsValid())
+    {
+        if (!m_uniformBufferPool)
+        {
+            m_uniformBufferPool = UniformBufferPool::GetDefault();
+        }
+        m_materialBlockAllocation = UniformBufferPool::Allocation(m_uniformBufferPool, m_materialBlockData.size());
+        m_materialBlockDirty = true;
+    }
+
+    if (m_materialBlockDirty)
+    {
+        for (const DataUniform& uniform : m_dataUniforms)
+        {
+            if (uniform.blockOffset < 0)
+            {
+                continue;
+            }
+
+            switch (uniform.type)
+            {
+            case Data::Type::Int:
+                PackBlockValues<int>(uniform);
+                break;
+            case Data::Type::UInt:
+                PackBlockValues<unsigned int>(uniform);
+                break;
+            case Data::Type::Float:
+                PackBlockValues<float>(uniform);
+                break;
+            case Data::Type::Double:
+                PackBlockValues<double>(uniform);
+                break;
+            default:
+                assert(false);
+            }
+        }
+        m_materialBlockAllocation.UpdateData(m_materialBlockData);
+        m_materialBlockDirty = false;
+        ++s_statistics.blockUploadCount;
     }
+
+    m_materialBlockAllocation.BindRange(MaterialBlockBinding);
 }
 
-void ShaderUniformCollection::UseUniform(const DataUniform& uniform) const
+bool ShaderUniformCollection::IsBlockLocation(ShaderProgram::Location location)
+{
+    return location >= BlockLocationBase;
+}
+
+ShaderUniformCollection::LocationMap ShaderUniformCollection::GetLocationMap(const ShaderProgram& shaderProgram) const
+{
+    assert(m_shaderProgram);
+
+    LocationMap locations;
+
+    // Block members are not set one by one, the other program only needs to read the same binding point
+    if (m_materialBlockIndex >= 0)
+    {
+        ShaderProgram::Location blockIndex = shaderProgram.GetUniformBlockIndex(MaterialBlockName);
+        if (blockIndex >= 0)
+        {
+            shaderProgram.SetUniformBlockBinding(blockIndex, MaterialBlockBinding);
+        }
+    }
+
+    unsigned int uniformCount = m_shaderProgram->GetUniformCount();
+    for (unsigned int i = 0; i < uniformCount; ++i)
+    {
+        int size;
+        GLenum glType;
+        char uniformName[256];
+        m_shaderProgram->GetUniformInfo(i, size, glType, std::span(uniformName, sizeof(uniformName)));
+
+        ShaderProgram::Location location = GetUniformLocation(uniformName);
+        if ((!m_locationDataIndex.contains(location) && !m_locationTextureIndex.contains(location)) || IsBlockLocation(location))
+        {
+            // Filtered uniform or block member, not set by location
+            continue;
+        }
+
+        // Uniforms removed from the other program are skipped
+        ShaderProgram::Location otherLocation = shaderProgram.GetUniformLocation(uniformName);
+        if (otherLocation >= 0)
+        {
+            locations[location] = otherLocation;
+        }
+    }
+    return locations;
+}
+
+void ShaderUniformCollection::UseUniform(const DataUniform& uniform, const ShaderProgram& shaderProgram, ShaderProgram::Location targetLocation) const
 {
     switch (uniform.type)
     {
     case Data::Type::Int:
-        UseUniform<int>(uniform);
+        UseUniform<int>(uniform, shaderProgram, targetLocation);
         break;
     case Data::Type::UInt:
-        UseUniform<unsigned int>(uniform);
+        UseUniform<unsigned int>(uniform, shaderProgram, targetLocation);
         break;
     case Data::Type::Float:
-        UseUniform<float>(uniform);
+        UseUniform<float>(uniform, shaderProgram, targetLocation);
         break;
     case Data::Type::Double:
-        UseUniform<double>(uniform);
+        UseUniform<double>(uniform, shaderProgram, targetLocation);
         break;
     default:
         assert(false);
     }
 }
 
-void ShaderUniformCollection::UseUniform(const TextureUniform& uniform) const
+void ShaderUniformCollection::UseUniform(const TextureUniform& uniform, const ShaderProgram& shaderProgram, ShaderProgram::Location targetLocation, bool setUnit) const
 {
     //TODO: default texture
     if (uniform.texture)
     {
-        size_t textureIndex = &uniform - m_textureUniforms.data();
-        m_shaderProgram->SetTexture(uniform.location, static_cast<int>(textureIndex), *uniform.texture);
+        // The unit is the index of the texture property, so the program keeps the unit while the collection is the same
+        GLint textureUnit = static_cast<GLint>(&uniform - m_textureUniforms.data());
+        if (uniform.texture->BindToUnit(textureUnit))
+        {
+            ++s_statistics.textureBindCount;
+        }
+        else
+        {
+            ++s_statistics.skippedTextureBindCount;
+        }
+
+        if (setUnit)
+        {
+            shaderProgram.SetUniform(targetLocation, textureUnit);
+            ++s_statistics.uniformCount;
+        }
+        else
+        {
+            ++s_statistics.skippedUniformCount;
+        }
     }
 }
 
 template<>
-void ShaderUniformCollection::UseUniform<float>(const DataUniform& uniform) const
+void ShaderUniformCollection::UseUniform<float>(const DataUniform& uniform, const ShaderProgram& shaderProgram, ShaderProgram::Location targetLocation) const
 {
     ShaderProgram::Location location = uniform.location;
     switch (uniform.dimension)
     {
     case UniformDimension::Scalar:
-        m_shaderProgram->SetUniforms<float>(location, GetDataValues<float>(location));
+        shaderProgram.SetUniforms<float>(targetLocation, GetDataValues<float>(location));
         break;
     case UniformDimension::Vector2:
-        m_shaderProgram->SetUniforms<float, 2>(location, GetDataValues<glm::vec<2, float>>(location));
+        shaderProgram.SetUniforms<float, 2>(targetLocation, GetDataValues<glm::vec<2, float>>(location));
         break;
     case UniformDimension::Vector3:
-        m_shaderProgram->SetUniforms<float, 3>(location, GetDataValues<glm::vec<3, float>>(location));
+        shaderProgram.SetUniforms<float, 3>(targetLocation, GetDataValues<glm::vec<3, float>>(location));
         break;
     case UniformDimension::Vector4:
-        m_shaderProgram->SetUniforms<float, 4>(location, GetDataValues<glm::vec<4, float>>(location));
+        shaderProgram.SetUniforms<float, 4>(targetLocation, GetDataValues<glm::vec<4, float>>(location));
         break;
     case UniformDimension::Matrix2x2:
-        m_shaderProgram->SetUniforms<float, 2, 2>(location, GetDataValues<glm::mat<2, 2, float>>(location));
+        shaderProgram.SetUniforms<float, 2, 2>(targetLocation, GetDataValues<glm::mat<2, 2, float>>(location));
         break;
     case UniformDimension::Matrix2x3:
-        m_shaderProgram->SetUniforms<float, 2, 3>(location, GetDataValues<glm::mat<2, 3, float>>(location));
+        shaderProgram.SetUniforms<float, 2, 3>(targetLocation, GetDataValues<glm::mat<2, 3, float>>(location));
         break;
     case UniformDimension::Matrix2x4:
-        m_shaderProgram->SetUniforms<float, 2, 4>(location, GetDataValues<glm::mat<2, 4, float>>(location));
+        shaderProgram.SetUniforms<float, 2, 4>(targetLocation, GetDataValues<glm::mat<2, 4, float>>(location));
         break;
     case UniformDimension::Matrix3x2:
-        m_shaderProgram->SetUniforms<float, 3, 2>(location, GetDataValues<glm::mat<3, 2, float>>(location));
+        shaderProgram.SetUniforms<float, 3, 2>(targetLocation, GetDataValues<glm::mat<3, 2, float>>(location));
         break;
     case UniformDimension::Matrix3x3:
-        m_shaderProgram->SetUniforms<float, 3, 3>(location, GetDataValues<glm::mat<3, 3, float>>(location));
+        shaderProgram.SetUniforms<float, 3, 3>(targetLocation, GetDataValues<glm::mat<3, 3, float>>(location));
         break;
     case UniformDimension::Matrix3x4:
-        m_shaderProgram->SetUniforms<float, 3, 4>(location, GetDataValues<glm::mat<3, 4, float>>(location));
+        shaderProgram.SetUniforms<float, 3, 4>(targetLocation, GetDataValues<glm::mat<3, 4, float>>(location));
         break;
     case UniformDimension::Matrix4x2:
-        m_shaderProgram->SetUniforms<float, 4, 2>(location, GetDataValues<glm::mat<4, 2, float>>(location));
+        shaderProgram.SetUniforms<float, 4, 2>(targetLocation, GetDataValues<glm::mat<4, 2, float>>(location));
         break;
     case UniformDimension::Matrix4x3:
-        m_shaderProgram->SetUniforms<float, 4, 3>(location, GetDataValues<glm::mat<4, 3, float>>(location));
+        shaderProgram.SetUniforms<float, 4, 3>(targetLocation, GetDataValues<glm::mat<4, 3, float>>(location));
         break;
     case UniformDimension::Matrix4x4:
-        m_shaderProgram->SetUniforms<float, 4, 4>(location, GetDataValues<glm::mat<4, 4, float>>(location));
+        shaderProgram.SetUniforms<float, 4, 4>(targetLocation, GetDataValues<glm::mat<4, 4, float>>(location));
         break;
     default:
         assert(false);
@@ -392,7 +723,11 @@ void ShaderUniformCollection::SetUniformValue(ShaderProgram::Location location,
 {
     TextureUniform& uniform = GetTextureUniform(location);
     assert(!value || uniform.target == value->GetTarget());
-    uniform.texture = value;
+    if (uniform.texture != value)
+    {
+        uniform.texture = value;
+        uniform.serial = ++m_changeSerial;
+    }
 }
 
 int ShaderUniformCollection::GetDataUniformSize(const DataUniform& uniform) const
@@ -448,6 +783,13 @@ void ShaderUniformCollection::Reset()
     m_uintDataValues.clear();
     m_floatDataValues.clear();
     m_doubleDataValues.clear();
+    // The values in the programs are from before
+    m_valuesId = ValuesId();
+    m_materialBlockIndex = -1;
+    m_blockLocations.clear();
+    m_materialBlockData.clear();
+    m_materialBlockDirty = false;
+    m_materialBlockAllocation.Release();
 }
 
 #ifndef NDEBUG
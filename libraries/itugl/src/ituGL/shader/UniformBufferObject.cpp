@@ -0,0 +1,36 @@
+#include <ituGL/shader/UniformBufferObject.h>
+
+#include <cassert>
+
+UniformBufferObject::UniformBufferObject()
+{
+    // Nothing to do here, it is done by the base class
+}
+
+// Binding to an indexed binding point also binds to the generic target
+void UniformBufferObject::BindBase(GLuint index) const
+{
+    glBindBufferBase(GL_UNIFORM_BUFFER, index, GetHandle());
+#ifndef NDEBUG
+    s_boundHandle = GetHandle();
+#endif
+}
+
+void UniformBufferObject::BindRange(GLuint index, size_t offset, size_t size) const
+{
+    assert(offset % GetOffsetAlignment() == 0);
+    glBindBufferRange(GL_UNIFORM_BUFFER, index, GetHandle(), offset, size);
+#ifndef NDEBUG
+    s_boundHandle = GetHandle();
+#endif
+}
+
+size_t UniformBufferObject::GetOffsetAlignment()
+{
+    static GLint alignment = 0;
+    if (alignment == 0)
+    {
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    }
+    return static_cast<size_t>(alignment);
+}
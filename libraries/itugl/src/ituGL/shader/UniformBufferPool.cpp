@@ -0,0 +1,185 @@
+#include <ituGL/shader/UniformBufferPool.h>
+
+#include <algorithm>
+#include <cassert>
+
+UniformBufferPool::UniformBufferPool(size_t pageSize) : m_pageSize(pageSize), m_allocationCount(0), m_allocatedSize(0)
+{
+}
+
+UniformBufferPool::Range UniformBufferPool::Allocate(size_t size)
+{
+    assert(size > 0);
+
+    // Round the size up, so the ranges after this one are aligned too
+    size_t alignment = UniformBufferObject::GetOffsetAlignment();
+    size_t alignedSize = (size + alignment - 1) / alignment * alignment;
+
+    Range range;
+
+    auto itFree = std::find_if(m_freeRanges.begin(), m_freeRanges.end(), [=](const Range& freeRange) { return freeRange.size >= alignedSize; });
+    if (itFree != m_freeRanges.end())
+    {
+        range = { itFree->pageIndex, itFree->offset, alignedSize };
+
+        // Keep the rest of the free range
+        if (itFree->size > alignedSize)
+        {
+            itFree->offset += alignedSize;
+            itFree->size -= alignedSize;
+        }
+        else
+        {
+            m_freeRanges.erase(itFree);
+        }
+    }
+    else
+    {
+        if (m_pages.empty() || m_pages.back().usedSize + alignedSize > m_pages.back().size)
+        {
+            // Blocks bigger than a page get a page of their own
+            Page& page = m_pages.emplace_back();
+            page.size = std::max(m_pageSize, alignedSize);
+            page.usedSize = 0;
+            page.buffer.Bind();
+            page.buffer.AllocateData(page.size, BufferObject::DynamicDraw);
+        }
+
+        Page& page = m_pages.back();
+        range = { static_cast<unsigned int>(m_pages.size() - 1), page.usedSize, alignedSize };
+        page.usedSize += alignedSize;
+    }
+
+    ++m_allocationCount;
+    m_allocatedSize += range.size;
+    return range;
+}
+
+void UniformBufferPool::Free(const Range& range)
+{
+    assert(range.pageIndex < m_pages.size());
+    assert(m_allocationCount > 0);
+
+    // Merge with the free ranges right before and after it in the same page
+    auto itNext = std::lower_bound(m_freeRanges.begin(), m_freeRanges.end(), range, [](const Range& a, const Range& b)
+        {
+            return a.pageIndex < b.pageIndex || (a.pageIndex == b.pageIndex && a.offset < b.offset);
+        });
+    bool mergeNext = itNext != m_freeRanges.end() && itNext->pageIndex == range.pageIndex && range.offset + range.size == itNext->offset;
+    bool mergePrevious = itNext != m_freeRanges.begin() && (itNext - 1)->pageIndex == range.pageIndex
+        && (itNext - 1)->offset + (itNext - 1)->size == range.offset;
+    if (mergePrevious)
+    {
+        Range& previous = *(itNext - 1);
+        previous.size += range.size;
+        if (mergeNext)
+        {
+            previous.size += itNext->size;
+            m_freeRanges.erase(itNext);
+        }
+    }
+    else if (mergeNext)
+    {
+        itNext->offset = range.offset;
+        itNext->size += range.size;
+    }
+    else
+    {
+        m_freeRanges.insert(itNext, range);
+    }
+
+    --m_allocationCount;
+    m_allocatedSize -= range.size;
+}
+
+void UniformBufferPool::UpdateData(const Range& range, std::span<const std::byte> data)
+{
+    assert(data.size() <= range.size);
+
+    UniformBufferObject& buffer = m_pages[range.pageIndex].buffer;
+    buffer.Bind();
+    buffer.UpdateData(data, range.offset);
+}
+
+void UniformBufferPool::BindRange(GLuint binding, const Range& range) const
+{
+    m_pages[range.pageIndex].buffer.BindRange(binding, range.offset, range.size);
+}
+
+size_t UniformBufferPool::GetMemorySize() const
+{
+    size_t memorySize = 0;
+    for (const Page& page : m_pages)
+    {
+        memorySize += page.size;
+    }
+    return memorySize;
+}
+
+std::shared_ptr<UniformBufferPool> UniformBufferPool::GetDefault()
+{
+    // Not owned here, the buffers must be deleted before the OpenGL context
+    static std::weak_ptr<UniformBufferPool> s_defaultPool;
+
+    std::shared_ptr<UniformBufferPool> pool = s_defaultPool.lock();
+    if (!pool)
+    {
+        pool = std::make_shared<UniformBufferPool>();
+        s_defaultPool = pool;
+    }
+    return pool;
+}
+
+
+UniformBufferPool::Allocation::Allocation() : m_range{ 0, 0, 0 }
+{
+}
+
+UniformBufferPool::Allocation::Allocation(std::shared_ptr<UniformBufferPool> pool, size_t size)
+    : m_pool(pool), m_range(pool->Allocate(size))
+{
+}
+
+UniformBufferPool::Allocation::~Allocation()
+{
+    Release();
+}
+
+UniformBufferPool::Allocation::Allocation(Allocation&& allocation) noexcept
+    : m_pool(std::move(allocation.m_pool)), m_range(allocation.m_range)
+{
+    allocation.m_pool = nullptr;
+}
+
+UniformBufferPool::Allocation& UniformBufferPool::Allocation::operator = (Allocation&& allocation) noexcept
+{
+    if (this != &allocation)
+    {
+        Release();
+        m_pool = std::move(allocation.m_pool);
+        m_range = allocation.m_range;
+        allocation.m_pool = nullptr;
+    }
+    return *this;
+}
+
+void UniformBufferPool::Allocation::UpdateData(std::span<const std::byte> data) const
+{
+    assert(IsValid());
+    m_pool->UpdateData(m_range, data);
+}
+
+void UniformBufferPool::Allocation::BindRange(GLuint binding) const
+{
+    assert(IsValid());
+    m_pool->BindRange(binding, m_range);
+}
+
+void UniformBufferPool::Allocation::Release()
+{
+    if (m_pool)
+    {
+        m_pool->Free(m_range);
+        m_pool = nullptr;
+    }
+}
@@ -0,0 +1,416 @@
+#include <ituGL/texture/BlockCompression.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    constexpr int BlockTexels = 16;
+
+    // Endpoints of the principal axis of the texels, using the first componentCount components
+    // The range is inset a bit, as the extremes are usually outliers and the palette covers them anyway
+    void FindEndpoints(const std::uint8_t texels[64], int componentCount, float endpoint0[4], float endpoint1[4])
+    {
+        float mean[4] = {};
+        for (int i = 0; i < BlockTexels; ++i)
+        {
+            for (int c = 0; c < componentCount; ++c)
+            {
+                mean[c] += texels[i * 4 + c];
+            }
+        }
+        for (int c = 0; c < componentCount; ++c)
+        {
+            mean[c] /= BlockTexels;
+        }
+
+        float covariance[4][4] = {};
+        for (int i = 0; i < BlockTexels; ++i)
+        {
+            for (int c0 = 0; c0 < componentCount; ++c0)
+            {
+                for (int c1 = 0; c1 < componentCount; ++c1)
+                {
+                    covariance[c0][c1] += (texels[i * 4 + c0] - mean[c0]) * (texels[i * 4 + c1] - mean[c1]);
+                }
+            }
+        }
+
+        // Power iteration, starting from the diagonal of the bounding box
+        float axis[4] = {};
+        for (int c = 0; c < componentCount; ++c)
+        {
+            std::uint8_t minValue = 255, maxValue = 0;
+            for (int i = 0; i < BlockTexels; ++i)
+            {
+                minValue = std::min(minValue, texels[i * 4 + c]);
+                maxValue = std::max(maxValue, texels[i * 4 + c]);
+            }
+            axis[c] = static_cast<float>(maxValue - minValue) + 1.0f;
+        }
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            float next[4] = {};
+            float length = 0.0f;
+            for (int c0 = 0; c0 < componentCount; ++c0)
+            {
+                for (int c1 = 0; c1 < componentCount; ++c1)
+                {
+                    next[c0] += covariance[c0][c1] * axis[c1];
+                }
+                length = std::max(length, std::abs(next[c0]));
+            }
+            if (length < 1e-6f)
+            {
+                break;
+            }
+            for (int c = 0; c < componentCount; ++c)
+            {
+                axis[c] = next[c] / length;
+            }
+        }
+        float axisLength2 = 0.0f;
+        for (int c = 0; c < componentCount; ++c)
+        {
+            axisLength2 += axis[c] * axis[c];
+        }
+
+        float minProjection = 0.0f, maxProjection = 0.0f;
+        if (axisLength2 > 0.0f)
+        {
+            for (int i = 0; i < BlockTexels; ++i)
+            {
+                float projection = 0.0f;
+                for (int c = 0; c < componentCount; ++c)
+                {
+                    projection += (texels[i * 4 + c] - mean[c]) * axis[c];
+                }
+                projection /= axisLength2;
+                minProjection = std::min(minProjection, projection);
+                maxProjection = std::max(maxProjection, projection);
+            }
+            float inset = (maxProjection - minProjection) / 32.0f;
+            minProjection += inset;
+            maxProjection -= inset;
+        }
+
+        for (int c = 0; c < 4; ++c)
+        {
+            endpoint0[c] = c < componentCount ? std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f) : 255.0f;
+            endpoint1[c] = c < componentCount ? std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f) : 255.0f;
+        }
+    }
+
+    int GetDistance2(const std::uint8_t* texel, const int color[4], int componentCount)
+    {
+        int distance = 0;
+        for (int c = 0; c < componentCount; ++c)
+        {
+            int delta = texel[c] - color[c];
+            distance += delta * delta;
+        }
+        return distance;
+    }
+
+    std::uint16_t PackRGB565(const float color[4])
+    {
+        int r = static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f);
+        int g = static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f);
+        int b = static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f);
+        return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void UnpackRGB565(std::uint16_t packed, int color[4])
+    {
+        int r = (packed >> 11) & 31;
+        int g = (packed >> 5) & 63;
+        int b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+        color[3] = 255;
+    }
+
+    // Writes count bits of the value at the bit offset, least significant bits first
+    void WriteBits(std::uint8_t* block, int& bitOffset, std::uint32_t value, int count)
+    {
+        for (int i = 0; i < count; ++i, ++bitOffset)
+        {
+            if (value & (1u << i))
+            {
+                block[bitOffset >> 3] |= static_cast<std::uint8_t>(1u << (bitOffset & 7));
+            }
+        }
+    }
+
+    // Quantizes a BC7 mode 6 endpoint to 7 bits per component and a shared p-bit, keeping the p-bit with less error
+    void QuantizeBC7Endpoint(const float endpoint[4], int quantized[4], int& pBit, int expanded[4])
+    {
+        int bestError = -1;
+        for (int p = 0; p < 2; ++p)
+        {
+            int error = 0;
+            int candidate[4];
+            for (int c = 0; c < 4; ++c)
+            {
+                candidate[c] = std::clamp(static_cast<int>((endpoint[c] - p) * 0.5f + 0.5f), 0, 127);
+                int delta = ((candidate[c] << 1) | p) - static_cast<int>(endpoint[c] + 0.5f);
+                error += delta * delta;
+            }
+            if (bestError < 0 || error < bestError)
+            {
+                bestError = error;
+                pBit = p;
+                for (int c = 0; c < 4; ++c)
+                {
+                    quantized[c] = candidate[c];
+                    expanded[c] = (candidate[c] << 1) | p;
+                }
+            }
+        }
+    }
+}
+
+std::vector<std::byte> BlockCompression::Encode(std::span<const std::byte> rgba, int width, int height, TextureObject::InternalFormat internalFormat)
+{
+    assert(rgba.size() == static_cast<size_t>(width) * height * 4);
+
+    int blockSize = TextureObject::GetBlockSize(internalFormat);
+    assert(blockSize > 0);
+
+    std::vector<std::byte> data(TextureObject::GetCompressedImageSize(internalFormat, width, height));
+    const std::uint8_t* source = reinterpret_cast<const std::uint8_t*>(rgba.data());
+    std::uint8_t* destination = reinterpret_cast<std::uint8_t*>(data.data());
+
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    for (int blockY = 0; blockY < blocksY; ++blockY)
+    {
+        for (int blockX = 0; blockX < blocksX; ++blockX)
+        {
+            std::uint8_t texels[64];
+            for (int y = 0; y < 4; ++y)
+            {
+                int sourceY = std::min(blockY * 4 + y, height - 1);
+                for (int x = 0; x < 4; ++x)
+                {
+                    int sourceX = std::min(blockX * 4 + x, width - 1);
+                    std::memcpy(texels + (y * 4 + x) * 4, source + (static_cast<size_t>(sourceY) * width + sourceX) * 4, 4);
+                }
+            }
+
+            std::uint8_t* block = destination + (static_cast<size_t>(blockY) * blocksX + blockX) * blockSize;
+            switch (internalFormat)
+            {
+            case TextureObject::InternalFormatBC1:
+            case TextureObject::InternalFormatBC1SRGB:
+                EncodeBC1(texels, block);
+                break;
+            case TextureObject::InternalFormatBC3:
+            case TextureObject::InternalFormatBC3SRGB:
+                EncodeBC3(texels, block);
+                break;
+            case TextureObject::InternalFormatBC4:
+                EncodeBC4(texels, 0, block);
+                break;
+            case TextureObject::InternalFormatBC5:
+                EncodeBC5(texels, block);
+                break;
+            case TextureObject::InternalFormatBC7:
+            case TextureObject::InternalFormatBC7SRGB:
+                EncodeBC7(texels, block);
+                break;
+            default:
+                assert(false);
+                break;
+            }
+        }
+    }
+    return data;
+}
+
+void BlockCompression::EncodeBC1(const std::uint8_t texels[64], std::uint8_t block[8])
+{
+    float endpoint0[4], endpoint1[4];
+    FindEndpoints(texels, 3, endpoint0, endpoint1);
+
+    std::uint16_t color0 = PackRGB565(endpoint0);
+    std::uint16_t color1 = PackRGB565(endpoint1);
+
+    // color0 > color1 selects the 4 color mode
+    if (color0 < color1)
+    {
+        std::swap(color0, color1);
+    }
+
+    std::uint32_t indices = 0;
+    if (color0 != color1)
+    {
+        int palette[4][4];
+        UnpackRGB565(color0, palette[0]);
+        UnpackRGB565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (int i = 0; i < BlockTexels; ++i)
+        {
+            int bestIndex = 0;
+            int bestDistance = GetDistance2(texels + i * 4, palette[0], 3);
+            for (int index = 1; index < 4; ++index)
+            {
+                int distance = GetDistance2(texels + i * 4, palette[index], 3);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = index;
+                }
+            }
+            indices |= static_cast<std::uint32_t>(bestIndex) << (i * 2);
+        }
+    }
+
+    block[0] = static_cast<std::uint8_t>(color0 & 0xFF);
+    block[1] = static_cast<std::uint8_t>(color0 >> 8);
+    block[2] = static_cast<std::uint8_t>(color1 & 0xFF);
+    block[3] = static_cast<std::uint8_t>(color1 >> 8);
+    for (int i = 0; i < 4; ++i)
+    {
+        block[4 + i] = static_cast<std::uint8_t>(indices >> (i * 8));
+    }
+}
+
+void BlockCompression::EncodeBC3(const std::uint8_t texels[64], std::uint8_t block[16])
+{
+    EncodeBC4(texels, 3, block);
+    EncodeBC1(texels, block + 8);
+}
+
+void BlockCompression::EncodeBC4(const std::uint8_t texels[64], int component, std::uint8_t block[8])
+{
+    std::uint8_t minValue = 255, maxValue = 0;
+    for (int i = 0; i < BlockTexels; ++i)
+    {
+        minValue = std::min(minValue, texels[i * 4 + component]);
+        maxValue = std::max(maxValue, texels[i * 4 + component]);
+    }
+
+    // value0 > value1 selects the 8 value mode. If they are equal, index 0 is exact
+    block[0] = maxValue;
+    block[1] = minValue;
+
+    std::uint64_t indices = 0;
+    if (maxValue != minValue)
+    {
+        int palette[8];
+        palette[0] = maxValue;
+        palette[1] = minValue;
+        for (int index = 2; index < 8; ++index)
+        {
+            palette[index] = ((8 - index) * maxValue + (index - 1) * minValue) / 7;
+        }
+
+        for (int i = 0; i < BlockTexels; ++i)
+        {
+            int value = texels[i * 4 + component];
+            int bestIndex = 0;
+            int bestDistance = std::abs(value - palette[0]);
+            for (int index = 1; index < 8; ++index)
+            {
+                int distance = std::abs(value - palette[index]);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    bestIndex = index;
+                }
+            }
+            indices |= static_cast<std::uint64_t>(bestIndex) << (i * 3);
+        }
+    }
+
+    for (int i = 0; i < 6; ++i)
+    {
+        block[2 + i] = static_cast<std::uint8_t>(indices >> (i * 8));
+    }
+}
+
+void BlockCompression::EncodeBC5(const std::uint8_t texels[64], std::uint8_t block[16])
+{
+    EncodeBC4(texels, 0, block);
+    EncodeBC4(texels, 1, block + 8);
+}
+
+void BlockCompression::EncodeBC7(const std::uint8_t texels[64], std::uint8_t block[16])
+{
+    // Interpolation weights of the 4-bit indices, in 1/64 units
+    constexpr int Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    float endpoint0[4], endpoint1[4];
+    FindEndpoints(texels, 4, endpoint0, endpoint1);
+
+    int quantized[2][4], expanded[2][4], pBits[2];
+    QuantizeBC7Endpoint(endpoint0, quantized[0], pBits[0], expanded[0]);
+    QuantizeBC7Endpoint(endpoint1, quantized[1], pBits[1], expanded[1]);
+
+    int palette[16][4];
+    for (int index = 0; index < 16; ++index)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            palette[index][c] = ((64 - Weights[index]) * expanded[0][c] + Weights[index] * expanded[1][c] + 32) >> 6;
+        }
+    }
+
+    int indices[BlockTexels];
+    for (int i = 0; i < BlockTexels; ++i)
+    {
+        int bestIndex = 0;
+        int bestDistance = GetDistance2(texels + i * 4, palette[0], 4);
+        for (int index = 1; index < 16; ++index)
+        {
+            int distance = GetDistance2(texels + i * 4, palette[index], 4);
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                bestIndex = index;
+            }
+        }
+        indices[i] = bestIndex;
+    }
+
+    // The most significant bit of the first index is implicit 0. Swap the endpoints if it is set
+    if (indices[0] & 8)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            std::swap(quantized[0][c], quantized[1][c]);
+        }
+        std::swap(pBits[0], pBits[1]);
+        for (int i = 0; i < BlockTexels; ++i)
+        {
+            indices[i] = 15 - indices[i];
+        }
+    }
+
+    std::memset(block, 0, 16);
+    int bitOffset = 0;
+    // Mode 6 is 6 zero bits followed by a one
+    WriteBits(block, bitOffset, 1u << 6, 7);
+    for (int c = 0; c < 4; ++c)
+    {
+        WriteBits(block, bitOffset, quantized[0][c], 7);
+        WriteBits(block, bitOffset, quantized[1][c], 7);
+    }
+    WriteBits(block, bitOffset, pBits[0], 1);
+    WriteBits(block, bitOffset, pBits[1], 1);
+    WriteBits(block, bitOffset, indices[0], 3);
+    for (int i = 1; i < BlockTexels; ++i)
+    {
+        WriteBits(block, bitOffset, indices[i], 4);
+    }
+    assert(bitOffset == 128);
+}
@@ -0,0 +1,430 @@
+#include <ituGL/texture/MipChain.h>
+
+#include <ituGL/texture/Texture2DObject.h>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// SSE2 is enough here: one vector holds the 4 components of a texel
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ITUGL_MIPCHAIN_SSE
+#endif
+
+namespace
+{
+    // Rows are filtered as 4 float components per texel, in linear space
+    constexpr int RowComponents = 4;
+
+    // Entries of the linear to sRGB table. Enough precision for 8 bits in the dark values, where the curve is steepest
+    constexpr int LinearToSRGBTableSize = 16384;
+
+    struct ConversionTables
+    {
+        ConversionTables()
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                float value = i / 255.0f;
+                unormToFloat[i] = value;
+                srgbToLinear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+            }
+            for (int i = 0; i < LinearToSRGBTableSize; ++i)
+            {
+                float value = static_cast<float>(i) / (LinearToSRGBTableSize - 1);
+                float srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+                linearToSRGB[i] = static_cast<std::uint8_t>(std::clamp(srgb, 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+        }
+
+        std::array<float, 256> unormToFloat;
+        std::array<float, 256> srgbToLinear;
+        std::array<std::uint8_t, LinearToSRGBTableSize> linearToSRGB;
+    };
+
+    const ConversionTables& GetConversionTables()
+    {
+        static const ConversionTables tables;
+        return tables;
+    }
+
+    // Format of the texels of the chain
+    struct TexelFormat
+    {
+        int components;
+        Data::Type dataType;
+        // Number of components stored in sRGB, the alpha is always linear
+        int srgbComponents;
+    };
+
+    // Reads a row of a level, converted to linear RGBA floats
+    void ReadRow(const MipChain::Level& level, int y, const TexelFormat& format, float* row)
+    {
+        int width = level.width;
+        int count = width * format.components;
+        if (format.dataType == Data::Type::Float)
+        {
+            const float* texels = reinterpret_cast<const float*>(level.data.data()) + static_cast<size_t>(y) * count;
+            for (int x = 0; x < width; ++x)
+            {
+                for (int c = 0; c < RowComponents; ++c)
+                {
+                    row[x * RowComponents + c] = c < format.components ? texels[x * format.components + c] : 0.0f;
+                }
+            }
+        }
+        else
+        {
+            const ConversionTables& tables = GetConversionTables();
+            const std::uint8_t* texels = reinterpret_cast<const std::uint8_t*>(level.data.data()) + static_cast<size_t>(y) * count;
+            for (int x = 0; x < width; ++x)
+            {
+                for (int c = 0; c < RowComponents; ++c)
+                {
+                    float value = 0.0f;
+                    if (c < format.components)
+                    {
+                        std::uint8_t texel = texels[x * format.components + c];
+                        value = c < format.srgbComponents ? tables.srgbToLinear[texel] : tables.unormToFloat[texel];
+                    }
+                    row[x * RowComponents + c] = value;
+                }
+            }
+        }
+    }
+
+    // Scalar conversion of a linear value to its stored 8-bit value
+    inline std::uint8_t QuantizeReference(float value, bool srgb)
+    {
+        const ConversionTables& tables = GetConversionTables();
+        value = std::min(std::max(value, 0.0f), 1.0f);
+        if (srgb)
+        {
+            return tables.linearToSRGB[static_cast<int>(value * (LinearToSRGBTableSize - 1) + 0.5f)];
+        }
+        return static_cast<std::uint8_t>(static_cast<int>(value * 255.0f + 0.5f));
+    }
+
+    // Writes a row of linear RGBA floats to a level, converted to the level format
+    void WriteRow(MipChain::Level& level, int y, const TexelFormat& format, const float* row, bool reference)
+    {
+        int width = level.width;
+        int count = width * format.components;
+        if (format.dataType == Data::Type::Float)
+        {
+            float* texels = reinterpret_cast<float*>(level.data.data()) + static_cast<size_t>(y) * count;
+            for (int x = 0; x < width; ++x)
+            {
+                for (int c = 0; c < format.components; ++c)
+                {
+                    texels[x * format.components + c] = row[x * RowComponents + c];
+                }
+            }
+            return;
+        }
+
+        std::uint8_t* texels = reinterpret_cast<std::uint8_t*>(level.data.data()) + static_cast<size_t>(y) * count;
+#if defined(ITUGL_MIPCHAIN_SSE)
+        if (!reference)
+        {
+            // Scale to the table index or the 8-bit value per component, then truncate after adding 0.5, like the scalar code
+            const ConversionTables& tables = GetConversionTables();
+            const float srgbScale = static_cast<float>(LinearToSRGBTableSize - 1);
+            __m128 scale = _mm_setr_ps(
+                format.srgbComponents > 0 ? srgbScale : 255.0f,
+                format.srgbComponents > 1 ? srgbScale : 255.0f,
+                format.srgbComponents > 2 ? srgbScale : 255.0f,
+                255.0f);
+            __m128 zero = _mm_setzero_ps();
+            __m128 one = _mm_set1_ps(1.0f);
+            __m128 half = _mm_set1_ps(0.5f);
+            alignas(16) std::int32_t indices[RowComponents];
+            for (int x = 0; x < width; ++x)
+            {
+                __m128 value = _mm_loadu_ps(row + x * RowComponents);
+                value = _mm_min_ps(_mm_max_ps(value, zero), one);
+                __m128i index = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, scale), half));
+                _mm_store_si128(reinterpret_cast<__m128i*>(indices), index);
+                for (int c = 0; c < format.components; ++c)
+                {
+                    texels[x * format.components + c] = c < format.srgbComponents
+                        ? tables.linearToSRGB[indices[c]] : static_cast<std::uint8_t>(indices[c]);
+                }
+            }
+            return;
+        }
+#endif
+        (void)reference;
+        for (int x = 0; x < width; ++x)
+        {
+            for (int c = 0; c < format.components; ++c)
+            {
+                texels[x * format.components + c] = QuantizeReference(row[x * RowComponents + c], c < format.srgbComponents);
+            }
+        }
+    }
+
+    // Averages 2x2 texels of two source rows. The last texel is repeated if the width is odd
+    void BoxFilterRow(const float* row0, const float* row1, int sourceWidth, float* destination, int destinationWidth, bool reference)
+    {
+#if defined(ITUGL_MIPCHAIN_SSE)
+        if (!reference)
+        {
+            __m128 quarter = _mm_set1_ps(0.25f);
+            for (int x = 0; x < destinationWidth; ++x)
+            {
+                int x0 = std::min(2 * x, sourceWidth - 1) * RowComponents;
+                int x1 = std::min(2 * x + 1, sourceWidth - 1) * RowComponents;
+                __m128 top = _mm_add_ps(_mm_loadu_ps(row0 + x0), _mm_loadu_ps(row0 + x1));
+                __m128 bottom = _mm_add_ps(_mm_loadu_ps(row1 + x0), _mm_loadu_ps(row1 + x1));
+                _mm_storeu_ps(destination + x * RowComponents, _mm_mul_ps(_mm_add_ps(top, bottom), quarter));
+            }
+            return;
+        }
+#endif
+        (void)reference;
+        for (int x = 0; x < destinationWidth; ++x)
+        {
+            int x0 = std::min(2 * x, sourceWidth - 1) * RowComponents;
+            int x1 = std::min(2 * x + 1, sourceWidth - 1) * RowComponents;
+            for (int c = 0; c < RowComponents; ++c)
+            {
+                // Same operation order as the vector code, so both give the same bits
+                float top = row0[x0 + c] + row0[x1 + c];
+                float bottom = row1[x0 + c] + row1[x1 + c];
+                destination[x * RowComponents + c] = (top + bottom) * 0.25f;
+            }
+        }
+    }
+
+    // Kaiser windowed sinc, with a radius of 3 destination texels
+    constexpr float KaiserWidth = 3.0f;
+    constexpr float KaiserAlpha = 4.0f;
+
+    // Modified Bessel function of the first kind, order 0
+    float BesselI0(float x)
+    {
+        float sum = 1.0f;
+        float term = 1.0f;
+        float halfX = x * 0.5f;
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (halfX / k) * (halfX / k);
+            sum += term;
+            if (term < sum * 1e-8f)
+            {
+                break;
+            }
+        }
+        return sum;
+    }
+
+    float KaiserSinc(float x)
+    {
+        float t = x / KaiserWidth;
+        if (std::abs(t) >= 1.0f)
+        {
+            return 0.0f;
+        }
+        const float pi = 3.14159265358979f;
+        float sinc = x == 0.0f ? 1.0f : std::sin(pi * x) / (pi * x);
+        return sinc * BesselI0(KaiserAlpha * std::sqrt(1.0f - t * t)) / BesselI0(KaiserAlpha);
+    }
+
+    // Source texels and normalized weights of each destination texel along one axis. Texels past the edges are clamped
+    struct FilterTaps
+    {
+        FilterTaps(int sourceSize, int destinationSize)
+        {
+            float scale = static_cast<float>(sourceSize) / destinationSize;
+            int radius = static_cast<int>(std::ceil(KaiserWidth * scale));
+            tapCount = 2 * radius + 1;
+            indices.resize(static_cast<size_t>(destinationSize) * tapCount);
+            weights.resize(indices.size());
+            for (int i = 0; i < destinationSize; ++i)
+            {
+                float center = (i + 0.5f) * scale;
+                int first = static_cast<int>(std::floor(center)) - radius;
+                float weightSum = 0.0f;
+                for (int t = 0; t < tapCount; ++t)
+                {
+                    int j = first + t;
+                    float weight = KaiserSinc((j + 0.5f - center) / scale);
+                    indices[i * tapCount + t] = std::clamp(j, 0, sourceSize - 1);
+                    weights[i * tapCount + t] = weight;
+                    weightSum += weight;
+                }
+                for (int t = 0; t < tapCount; ++t)
+                {
+                    weights[i * tapCount + t] /= weightSum;
+                }
+            }
+        }
+
+        int tapCount;
+        std::vector<int> indices;
+        std::vector<float> weights;
+    };
+
+    void KaiserFilter(const float* source, int sourceStride, const FilterTaps& taps, int destinationSize, float* destination, int destinationStride)
+    {
+        for (int i = 0; i < destinationSize; ++i)
+        {
+            float sum[RowComponents] = {};
+            for (int t = 0; t < taps.tapCount; ++t)
+            {
+                const float* texel = source + static_cast<size_t>(taps.indices[i * taps.tapCount + t]) * sourceStride;
+                float weight = taps.weights[i * taps.tapCount + t];
+                for (int c = 0; c < RowComponents; ++c)
+                {
+                    sum[c] += texel[c] * weight;
+                }
+            }
+            std::memcpy(destination + static_cast<size_t>(i) * destinationStride, sum, sizeof(sum));
+        }
+    }
+
+    void GenerateBoxLevel(const MipChain::Level& source, MipChain::Level& destination, const TexelFormat& format, bool reference)
+    {
+        std::vector<float> row0(static_cast<size_t>(source.width) * RowComponents);
+        std::vector<float> row1(row0.size());
+        std::vector<float> destinationRow(static_cast<size_t>(destination.width) * RowComponents);
+        for (int y = 0; y < destination.height; ++y)
+        {
+            ReadRow(source, std::min(2 * y, source.height - 1), format, row0.data());
+            ReadRow(source, std::min(2 * y + 1, source.height - 1), format, row1.data());
+            BoxFilterRow(row0.data(), row1.data(), source.width, destinationRow.data(), destination.width, reference);
+            WriteRow(destination, y, format, destinationRow.data(), reference);
+        }
+    }
+
+    void GenerateKaiserLevel(const MipChain::Level& source, MipChain::Level& destination, const TexelFormat& format, bool reference)
+    {
+        FilterTaps horizontalTaps(source.width, destination.width);
+        FilterTaps verticalTaps(source.height, destination.height);
+
+        // Horizontal pass, keeping all the source rows at the destination width
+        std::vector<float> sourceRow(static_cast<size_t>(source.width) * RowComponents);
+        std::vector<float> horizontal(static_cast<size_t>(destination.width) * source.height * RowComponents);
+        for (int y = 0; y < source.height; ++y)
+        {
+            ReadRow(source, y, format, sourceRow.data());
+            KaiserFilter(sourceRow.data(), RowComponents, horizontalTaps, destination.width,
+                horizontal.data() + static_cast<size_t>(y) * destination.width * RowComponents, RowComponents);
+        }
+
+        // Vertical pass, one column at a time
+        std::vector<float> column(static_cast<size_t>(destination.height) * RowComponents);
+        std::vector<float> destinationRows(static_cast<size_t>(destination.width) * destination.height * RowComponents);
+        for (int x = 0; x < destination.width; ++x)
+        {
+            KaiserFilter(horizontal.data() + x * RowComponents, destination.width * RowComponents, verticalTaps, destination.height,
+                destinationRows.data() + x * RowComponents, destination.width * RowComponents);
+        }
+
+        for (int y = 0; y < destination.height; ++y)
+        {
+            WriteRow(destination, y, format, destinationRows.data() + static_cast<size_t>(y) * destination.width * RowComponents, reference);
+        }
+    }
+}
+
+MipChain::MipChain() : m_components(0), m_dataType(Data::Type::None)
+{
+}
+
+void MipChain::Generate(std::span<const std::byte> data, int width, int height, int components, Data::Type dataType, bool srgb, Filter filter)
+{
+    Generate(data, width, height, components, dataType, srgb, filter, false);
+}
+
+void MipChain::GenerateReference(std::span<const std::byte> data, int width, int height, int components, Data::Type dataType, bool srgb, Filter filter)
+{
+    Generate(data, width, height, components, dataType, srgb, filter, true);
+}
+
+void MipChain::Generate(std::span<const std::byte> data, int width, int height, int components, Data::Type dataType, bool srgb, Filter filter, bool reference)
+{
+    assert(width > 0 && height > 0);
+    assert(components >= 1 && components <= 4);
+    assert(dataType == Data::Type::UByte || dataType == Data::Type::Float);
+    assert(data.size() == static_cast<size_t>(width) * height * components * Data::GetTypeSize(dataType));
+
+    Clear();
+    m_components = components;
+    m_dataType = dataType;
+
+    // HDR data is already linear
+    TexelFormat format;
+    format.components = components;
+    format.dataType = dataType;
+    format.srgbComponents = srgb && dataType == Data::Type::UByte ? std::min(components, 3) : 0;
+
+    m_levels.push_back(Level{ width, height, std::vector<std::byte>(data.begin(), data.end()) });
+    while (width > 1 || height > 1)
+    {
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+
+        Level level{ width, height, std::vector<std::byte>(static_cast<size_t>(width) * height * components * Data::GetTypeSize(dataType)) };
+        const Level& source = m_levels.back();
+        switch (filter)
+        {
+        case Filter::Box:
+            GenerateBoxLevel(source, level, format, reference);
+            break;
+        case Filter::Kaiser:
+            GenerateKaiserLevel(source, level, format, reference);
+            break;
+        }
+        m_levels.push_back(std::move(level));
+    }
+}
+
+void MipChain::Clear()
+{
+    m_levels.clear();
+    m_components = 0;
+    m_dataType = Data::Type::None;
+}
+
+void MipChain::Upload(Texture2DObject& texture, TextureObject::Format format, TextureObject::InternalFormat internalFormat) const
+{
+    assert(!m_levels.empty());
+    assert(TextureObject::GetComponentCount(format) == m_components);
+
+    // Levels are tightly packed, and small levels have rows that are not multiple of 4 bytes
+    GLint unpackAlignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpackAlignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (unsigned int i = 0; i < GetLevelCount(); ++i)
+    {
+        const Level& level = m_levels[i];
+        texture.SetImage<std::byte>(i, level.width, level.height, format, internalFormat, level.data, m_dataType);
+    }
+    texture.SetParameter(TextureObject::ParameterInt::BaseLevel, 0);
+    texture.SetParameter(TextureObject::ParameterInt::MaxLevel, static_cast<int>(GetLevelCount()) - 1);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+}
+
+bool MipChain::IsSRGB(TextureObject::InternalFormat internalFormat)
+{
+    switch (internalFormat)
+    {
+    case TextureObject::InternalFormatSRGB8:
+    case TextureObject::InternalFormatSRGBA8:
+    case TextureObject::InternalFormatSRGBCompressed:
+    case TextureObject::InternalFormatSRGBACompressed:
+    case TextureObject::InternalFormatBC1SRGB:
+    case TextureObject::InternalFormatBC3SRGB:
+    case TextureObject::InternalFormatBC7SRGB:
+        return true;
+    default:
+        return false;
+    }
+}
@@ -20,3 +20,11 @@ void Texture2DObject::SetImage(GLint level, GLsizei width, GLsizei height, Forma
 {
     SetImage<float>(level, width, height, format, internalFormat, std::span<float>());
 }
+
+void Texture2DObject::SetCompressedImage(GLint level, GLsizei width, GLsizei height, InternalFormat internalFormat, std::span<const std::byte> data)
+{
+    assert(IsBound());
+    assert(IsBlockCompressed(internalFormat));
+    assert(data.size_bytes() == GetCompressedImageSize(internalFormat, width, height));
+    glCompressedTexImage2D(GetTarget(), level, internalFormat, width, height, 0, static_cast<GLsizei>(data.size_bytes()), data.data());
+}
@@ -2,6 +2,9 @@
 
 #include <cassert>
 
+GLint TextureObject::s_activeTextureUnit = 0;
+TextureObject::UnitBinding TextureObject::s_unitBindings[TextureObject::TrackedUnitCount] = {};
+
 TextureObject::TextureObject() : Object(NullHandle)
 {
     Handle& handle = GetHandle();
@@ -12,6 +15,18 @@ TextureObject::~TextureObject()
 {
     Handle& handle = GetHandle();
     glDeleteTextures(1, &handle);
+
+    // Deleting unbinds the texture, and a new texture can get the same handle
+    if (handle != NullHandle)
+    {
+        for (UnitBinding& unitBinding : s_unitBindings)
+        {
+            if (unitBinding.handle == handle)
+            {
+                unitBinding.handle = NullHandle;
+            }
+        }
+    }
 }
 
 #ifndef NDEBUG
@@ -26,18 +41,52 @@ GLint TextureObject::GetActiveTexture()
 void TextureObject::SetActiveTexture(GLint textureUnit)
 {
     glActiveTexture(GL_TEXTURE0 + textureUnit);
+    s_activeTextureUnit = textureUnit;
+}
+
+bool TextureObject::BindToUnit(GLint textureUnit) const
+{
+    if (textureUnit < TrackedUnitCount)
+    {
+        const UnitBinding& unitBinding = s_unitBindings[textureUnit];
+        if (unitBinding.target == GetTarget() && unitBinding.handle == GetHandle() && unitBinding.handle != NullHandle)
+        {
+            return false;
+        }
+    }
+    SetActiveTexture(textureUnit);
+    Bind();
+    return true;
+}
+
+void TextureObject::InvalidateUnitBindings()
+{
+    for (UnitBinding& unitBinding : s_unitBindings)
+    {
+        unitBinding.handle = NullHandle;
+    }
 }
 
 void TextureObject::Bind(Target target) const
 {
     Handle handle = GetHandle();
     glBindTexture(target, handle);
+    SetUnitBinding(target, handle);
 }
 
 void TextureObject::Unbind(Target target)
 {
     Handle handle = NullHandle;
     glBindTexture(target, handle);
+    SetUnitBinding(target, handle);
+}
+
+void TextureObject::SetUnitBinding(GLenum target, Handle handle)
+{
+    if (s_activeTextureUnit < TrackedUnitCount)
+    {
+        s_unitBindings[s_activeTextureUnit] = { target, handle };
+    }
 }
 
 void TextureObject::GenerateMipmap()
@@ -119,6 +168,7 @@ bool TextureObject::IsValidFormat(Format format, InternalFormat internalFormat)
     case InternalFormatR16F:
     case InternalFormatR32F:
     case InternalFormatRCompressed:
+    case InternalFormatBC4:
         return format == FormatR;
     case InternalFormatRG:
     case InternalFormatRG8:
@@ -128,6 +178,7 @@ bool TextureObject::IsValidFormat(Format format, InternalFormat internalFormat)
     case InternalFormatRG16F:
     case InternalFormatRG32F:
     case InternalFormatRGCompressed:
+    case InternalFormatBC5:
         return format == FormatRG;
     case InternalFormatRGB:
     case InternalFormatRGB8:
@@ -140,6 +191,8 @@ bool TextureObject::IsValidFormat(Format format, InternalFormat internalFormat)
     case InternalFormatRGBCompressed:
     case InternalFormatSRGBCompressed:
     case InternalFormatR11G11B10:
+    case InternalFormatBC1:
+    case InternalFormatBC1SRGB:
         return format == FormatRGB || format == FormatBGR;
     case InternalFormatRGBA:
     case InternalFormatRGBA8:
@@ -152,6 +205,10 @@ bool TextureObject::IsValidFormat(Format format, InternalFormat internalFormat)
     case InternalFormatRGBACompressed:
     case InternalFormatSRGBACompressed:
     case InternalFormatRGB10A2:
+    case InternalFormatBC3:
+    case InternalFormatBC3SRGB:
+    case InternalFormatBC7:
+    case InternalFormatBC7SRGB:
         return format == FormatRGBA || format == FormatBGRA;
     case InternalFormatDepth:
     case InternalFormatDepth16:
@@ -204,6 +261,7 @@ int TextureObject::GetDataComponentCount(InternalFormat internalFormat)
     case InternalFormatR16F:
     case InternalFormatR32F:
     case InternalFormatRCompressed:
+    case InternalFormatBC4:
     case InternalFormatR11G11B10:
     case InternalFormatRGB10A2:
     case InternalFormatDepth:
@@ -222,6 +280,7 @@ int TextureObject::GetDataComponentCount(InternalFormat internalFormat)
     case InternalFormatRG16F:
     case InternalFormatRG32F:
     case InternalFormatRGCompressed:
+    case InternalFormatBC5:
         return 2;
     case InternalFormatRGB:
     case InternalFormatRGB8:
@@ -233,6 +292,8 @@ int TextureObject::GetDataComponentCount(InternalFormat internalFormat)
     case InternalFormatSRGB8:
     case InternalFormatRGBCompressed:
     case InternalFormatSRGBCompressed:
+    case InternalFormatBC1:
+    case InternalFormatBC1SRGB:
         return 3;
     case InternalFormatRGBA:
     case InternalFormatRGBA8:
@@ -244,9 +305,44 @@ int TextureObject::GetDataComponentCount(InternalFormat internalFormat)
     case InternalFormatSRGBA8:
     case InternalFormatRGBACompressed:
     case InternalFormatSRGBACompressed:
+    case InternalFormatBC3:
+    case InternalFormatBC3SRGB:
+    case InternalFormatBC7:
+    case InternalFormatBC7SRGB:
         return 4;
     default:
         //Unknown format
         return 0;
     }
 }
+
+bool TextureObject::IsBlockCompressed(InternalFormat internalFormat)
+{
+    return GetBlockSize(internalFormat) > 0;
+}
+
+int TextureObject::GetBlockSize(InternalFormat internalFormat)
+{
+    switch (internalFormat)
+    {
+    case InternalFormatBC1:
+    case InternalFormatBC1SRGB:
+    case InternalFormatBC4:
+        return 8;
+    case InternalFormatBC3:
+    case InternalFormatBC3SRGB:
+    case InternalFormatBC5:
+    case InternalFormatBC7:
+    case InternalFormatBC7SRGB:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+size_t TextureObject::GetCompressedImageSize(InternalFormat internalFormat, int width, int height)
+{
+    size_t blocksX = (width + 3) / 4;
+    size_t blocksY = (height + 3) / 4;
+    return blocksX * blocksY * GetBlockSize(internalFormat);
+}
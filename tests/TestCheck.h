@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal checks for the test executables, that work in release builds too
+// Failed checks are printed with their location, and main returns the number of failures
+class TestCheck
+{
+public:
+    static inline bool Check(bool condition, const char* expression, const char* file, int line)
+    {
+        if (!condition)
+        {
+            std::printf("%s(%d): check failed: %s\n", file, line, expression);
+            ++GetFailureCount();
+        }
+        return condition;
+    }
+
+    static inline int& GetFailureCount()
+    {
+        static int failureCount = 0;
+        return failureCount;
+    }
+
+    // Exit code of the test. Failures are capped so the code never wraps to 0
+    static inline int GetResult()
+    {
+        int failureCount = GetFailureCount();
+        std::printf(failureCount == 0 ? "All checks passed\n" : "%d checks failed\n", failureCount);
+        return failureCount < 100 ? failureCount : 100;
+    }
+
+    // Exit code for tests that can't run on this machine, like AVX2 tests on older CPUs
+    static constexpr int SkipResult = 77;
+};
+
+#define TEST_CHECK(condition) TestCheck::Check((condition), #condition, __FILE__, __LINE__)
@@ -0,0 +1,212 @@
+#include <ituGL/asset/AssetPack.h>
+#include <ituGL/asset/VirtualFileSystem.h>
+#include <ituGL/core/LZ4.h>
+
+#include <TestCheck.h>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Compresses data of different kinds with LZ4 and checks that it decompresses to the same bytes, and that bad blocks are rejected
+// Then builds a pack from a directory, and reads its files directly and through a VirtualFileSystem
+
+namespace
+{
+    std::vector<std::byte> MakeText(size_t size)
+    {
+        const char* words[] = { "terrain ", "shadow ", "mesh ", "light ", "texture ", "\n" };
+        std::mt19937 random(1);
+        std::vector<std::byte> data;
+        while (data.size() < size)
+        {
+            for (const char* c = words[random() % 6]; *c && data.size() < size; ++c)
+            {
+                data.push_back(std::byte(*c));
+            }
+        }
+        return data;
+    }
+
+    std::vector<std::byte> MakeRandom(size_t size, unsigned int seed)
+    {
+        std::mt19937 random(seed);
+        std::vector<std::byte> data(size);
+        for (std::byte& value : data)
+        {
+            value = std::byte(random() & 0xFF);
+        }
+        return data;
+    }
+
+    // Random bytes with long runs, for lengths that don't fit in the token
+    std::vector<std::byte> MakeRuns(size_t size)
+    {
+        std::mt19937 random(2);
+        std::vector<std::byte> data;
+        while (data.size() < size)
+        {
+            std::vector<std::byte> literals = MakeRandom(random() % 400, random());
+            data.insert(data.end(), literals.begin(), literals.end());
+            data.insert(data.end(), random() % 1000, std::byte(random() & 0xFF));
+        }
+        data.resize(size);
+        return data;
+    }
+
+    std::vector<std::byte> Compress(const std::vector<std::byte>& data)
+    {
+        std::vector<std::byte> compressedData(LZ4::GetMaxCompressedSize(data.size()));
+        size_t compressedSize = LZ4::Compress(data, compressedData);
+        TEST_CHECK(compressedSize <= compressedData.size());
+        compressedData.resize(compressedSize);
+        return compressedData;
+    }
+
+    void CheckRoundTrip(const std::vector<std::byte>& data, bool compressible)
+    {
+        std::vector<std::byte> compressedData = Compress(data);
+        if (compressible)
+        {
+            TEST_CHECK(compressedData.size() < data.size() / 2);
+        }
+
+        std::vector<std::byte> decompressedData(data.size());
+        TEST_CHECK(LZ4::Decompress(compressedData, decompressedData));
+        TEST_CHECK(decompressedData == data);
+
+        // The size must match exactly
+        if (!data.empty())
+        {
+            std::vector<std::byte> smaller(data.size() - 1);
+            TEST_CHECK(!LZ4::Decompress(compressedData, smaller));
+            std::vector<std::byte> larger(data.size() + 1);
+            TEST_CHECK(!LZ4::Decompress(compressedData, larger));
+            TEST_CHECK(!LZ4::Decompress(std::span(compressedData).first(compressedData.size() - 1), decompressedData));
+        }
+    }
+
+    void TestLZ4()
+    {
+        CheckRoundTrip({}, false);
+        CheckRoundTrip({ std::byte(7) }, false);
+        CheckRoundTrip(MakeText(11), false);
+        CheckRoundTrip(MakeText(13), false);
+        CheckRoundTrip(MakeText(100000), true);
+        CheckRoundTrip(MakeRandom(100000, 3), false);
+        CheckRoundTrip(MakeRuns(300000), true);
+        CheckRoundTrip(std::vector<std::byte>(70000, std::byte(0)), true);
+
+        // A match before the start of the output, and a match with offset 0
+        std::byte matchBeforeStart[] = { std::byte(0x10), std::byte('a'), std::byte(2), std::byte(0), std::byte(0x00) };
+        std::byte matchOffsetZero[] = { std::byte(0x10), std::byte('a'), std::byte(0), std::byte(0), std::byte(0x00) };
+        std::vector<std::byte> output(5);
+        TEST_CHECK(!LZ4::Decompress(matchBeforeStart, output));
+        TEST_CHECK(!LZ4::Decompress(matchOffsetZero, output));
+
+        // Corrupted blocks must fail or decompress to something, but never write out of the buffer
+        std::vector<std::byte> data = MakeText(5000);
+        std::vector<std::byte> compressedData = Compress(data);
+        std::mt19937 random(4);
+        for (int i = 0; i < 1000; ++i)
+        {
+            std::vector<std::byte> corruptedData = compressedData;
+            corruptedData[random() % corruptedData.size()] = std::byte(random() & 0xFF);
+            std::vector<std::byte> decompressedData(data.size());
+            LZ4::Decompress(corruptedData, decompressedData);
+        }
+    }
+
+    void WriteFile(const std::filesystem::path& path, const std::vector<std::byte>& data)
+    {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    void TestPack(const std::filesystem::path& directory, const std::string& packPath)
+    {
+        std::vector<std::byte> text = MakeText(20000);
+        std::vector<std::byte> noise = MakeRandom(20000, 5);
+        WriteFile(directory / "text.txt", text);
+        WriteFile(directory / "sub" / "noise.bin", noise);
+        WriteFile(directory / "empty.txt", {});
+        WriteFile(directory / "skipped.pak", text);
+
+        AssetPack::BuildSettings settings;
+        settings.excludedExtensions.push_back(".pak");
+        TEST_CHECK(AssetPack::Build(directory.string().c_str(), packPath.c_str(), settings) == 3);
+
+        AssetPack pack;
+        if (!TEST_CHECK(pack.Open(packPath.c_str())))
+        {
+            return;
+        }
+        TEST_CHECK(pack.GetEntryCount() == 3);
+        TEST_CHECK(pack.Find("skipped.pak") == nullptr);
+        TEST_CHECK(pack.Find("missing.txt") == nullptr);
+
+        // Text is compressed. Noise doesn't get smaller, so it is stored as it is and read in place
+        std::vector<std::byte> data;
+        const AssetPack::Entry* textEntry = pack.Find("text.txt");
+        if (TEST_CHECK(textEntry != nullptr))
+        {
+            TEST_CHECK(textEntry->compression == AssetPack::Compression::LZ4);
+            TEST_CHECK(textEntry->storedSize < text.size());
+            TEST_CHECK(pack.GetPath(*textEntry) == "text.txt");
+            TEST_CHECK(pack.Read(*textEntry, data) && data == text);
+        }
+        const AssetPack::Entry* noiseEntry = pack.Find("sub/noise.bin");
+        if (TEST_CHECK(noiseEntry != nullptr))
+        {
+            TEST_CHECK(noiseEntry->compression == AssetPack::Compression::None);
+            std::span<const std::byte> storedData = pack.GetStoredData(*noiseEntry);
+            TEST_CHECK(std::vector<std::byte>(storedData.begin(), storedData.end()) == noise);
+        }
+        const AssetPack::Entry* emptyEntry = pack.Find("empty.txt");
+        if (TEST_CHECK(emptyEntry != nullptr))
+        {
+            TEST_CHECK(pack.Read(*emptyEntry, data) && data.empty());
+        }
+        pack.Close();
+
+        // Files are found under the mount point, and only there when loose files are disabled
+        VirtualFileSystem fileSystem;
+        fileSystem.SetLooseFilesEnabled(false);
+        TEST_CHECK(fileSystem.Mount(packPath.c_str(), "assets"));
+        TEST_CHECK(fileSystem.Exists("assets/text.txt"));
+        TEST_CHECK(fileSystem.IsPacked("assets/sub/noise.bin"));
+        TEST_CHECK(!fileSystem.Exists("text.txt"));
+        TEST_CHECK(!fileSystem.Exists("assets/skipped.pak"));
+        VirtualFile file;
+        if (TEST_CHECK(fileSystem.Open("assets/text.txt", file)))
+        {
+            TEST_CHECK(std::vector<std::byte>(file.GetData().begin(), file.GetData().end()) == text);
+        }
+        if (TEST_CHECK(fileSystem.Open("assets/sub/noise.bin", file)))
+        {
+            TEST_CHECK(std::vector<std::byte>(file.GetData().begin(), file.GetData().end()) == noise);
+        }
+        fileSystem.UnmountAll();
+
+        // A truncated pack doesn't open
+        std::filesystem::resize_file(packPath, std::filesystem::file_size(packPath) / 2);
+        TEST_CHECK(!pack.Open(packPath.c_str()));
+    }
+}
+
+int main()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "assetPackTest";
+    std::string packPath = (std::filesystem::temp_directory_path() / "assetPackTest.pak").string();
+    std::filesystem::remove_all(directory);
+
+    TestLZ4();
+    TestPack(directory, packPath);
+
+    std::filesystem::remove_all(directory);
+    std::filesystem::remove(packPath);
+    return TestCheck::GetResult();
+}
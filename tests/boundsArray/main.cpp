@@ -0,0 +1,184 @@
+#include <ituGL/scene/BoundsArray.h>
+#include <ituGL/core/CpuFeatures.h>
+
+#include <TestCheck.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Compares the vectorized bounds kernels with their scalar reference implementations on random data
+// Both do the same operations in the same order, so the results must be identical, not just close
+
+namespace
+{
+    // Value written after the results, to check that the padding lanes are never stored
+    constexpr unsigned char GuardValue = 0xCD;
+
+    glm::vec3 RandomVector(std::mt19937& random, float min, float max)
+    {
+        std::uniform_real_distribution<float> distribution(min, max);
+        return glm::vec3(distribution(random), distribution(random), distribution(random));
+    }
+
+    // Planes of a random camera frustum, plus random planes that don't form a closed volume
+    std::vector<BoundsPlane> RandomPlanes(std::mt19937& random)
+    {
+        glm::vec3 position = RandomVector(random, -50.0f, 50.0f);
+        glm::vec3 target = position + RandomVector(random, -1.0f, 1.0f);
+        glm::mat4 viewProjection = glm::perspective(1.0f, 1.5f, 0.1f, 100.0f) * glm::lookAt(position, target, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        std::array<BoundsPlane, 6> frustumPlanes;
+        ExtractFrustumPlanes(viewProjection, frustumPlanes);
+        std::vector<BoundsPlane> planes(frustumPlanes.begin(), frustumPlanes.end());
+
+        std::uniform_real_distribution<float> distance(-20.0f, 20.0f);
+        planes.push_back(BoundsPlane(glm::normalize(RandomVector(random, -1.0f, 1.0f)), distance(random)));
+        return planes;
+    }
+
+    AabbArray RandomBoxes(std::mt19937& random, size_t count)
+    {
+        AabbArray boxes;
+        boxes.Reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            boxes.Add(RandomVector(random, -100.0f, 100.0f), RandomVector(random, 0.0f, 10.0f));
+        }
+        return boxes;
+    }
+
+    SphereArray RandomSpheres(std::mt19937& random, size_t count)
+    {
+        std::uniform_real_distribution<float> radius(0.0f, 10.0f);
+        SphereArray spheres;
+        spheres.Reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            spheres.Add(RandomVector(random, -100.0f, 100.0f), radius(random));
+        }
+        return spheres;
+    }
+
+    // Runs a kernel and its reference, and checks that they agree and leave the guard bytes untouched
+    template<typename Kernel, typename ReferenceKernel>
+    void CheckResults(size_t count, Kernel&& kernel, ReferenceKernel&& referenceKernel)
+    {
+        std::vector<unsigned char> results(count + BoundsArrayBatchSize, GuardValue);
+        std::vector<unsigned char> referenceResults(count + BoundsArrayBatchSize, GuardValue);
+        kernel(std::span(results));
+        referenceKernel(std::span(referenceResults));
+
+        TEST_CHECK(results == referenceResults);
+        for (size_t i = count; i < results.size(); ++i)
+        {
+            TEST_CHECK(results[i] == GuardValue);
+        }
+    }
+
+    bool AreEqual(std::span<const float> a, std::span<const float> b, size_t count)
+    {
+        return std::memcmp(a.data(), b.data(), count * sizeof(float)) == 0;
+    }
+
+    void TestAabbArray(std::mt19937& random, size_t count)
+    {
+        AabbArray boxes = RandomBoxes(random, count);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            std::vector<BoundsPlane> planes = RandomPlanes(random);
+            CheckResults(count,
+                [&](std::span<unsigned char> results) { boxes.TestPlanes(planes, results); },
+                [&](std::span<unsigned char> results) { boxes.TestPlanesReference(planes, results); });
+
+            AabbBounds other(RandomVector(random, -100.0f, 100.0f), RandomVector(random, 0.0f, 50.0f));
+            CheckResults(count,
+                [&](std::span<unsigned char> results) { boxes.TestOverlap(other, results); },
+                [&](std::span<unsigned char> results) { boxes.TestOverlapReference(other, results); });
+
+            glm::mat4 matrix = glm::translate(glm::mat4(1.0f), RandomVector(random, -10.0f, 10.0f));
+            matrix = glm::rotate(matrix, static_cast<float>(i), glm::normalize(RandomVector(random, 0.1f, 1.0f)));
+            matrix = glm::scale(matrix, RandomVector(random, 0.5f, 2.0f));
+            AabbArray transformed, referenceTransformed;
+            boxes.Transform(matrix, transformed);
+            boxes.TransformReference(matrix, referenceTransformed);
+            TEST_CHECK(transformed.GetSize() == count && referenceTransformed.GetSize() == count);
+            TEST_CHECK(AreEqual(transformed.GetCenterX(), referenceTransformed.GetCenterX(), count));
+            TEST_CHECK(AreEqual(transformed.GetCenterY(), referenceTransformed.GetCenterY(), count));
+            TEST_CHECK(AreEqual(transformed.GetCenterZ(), referenceTransformed.GetCenterZ(), count));
+            TEST_CHECK(AreEqual(transformed.GetSizeX(), referenceTransformed.GetSizeX(), count));
+            TEST_CHECK(AreEqual(transformed.GetSizeY(), referenceTransformed.GetSizeY(), count));
+            TEST_CHECK(AreEqual(transformed.GetSizeZ(), referenceTransformed.GetSizeZ(), count));
+        }
+    }
+
+    void TestSphereArray(std::mt19937& random, size_t count)
+    {
+        SphereArray spheres = RandomSpheres(random, count);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            std::vector<BoundsPlane> planes = RandomPlanes(random);
+            CheckResults(count,
+                [&](std::span<unsigned char> results) { spheres.TestPlanes(planes, results); },
+                [&](std::span<unsigned char> results) { spheres.TestPlanesReference(planes, results); });
+
+            std::uniform_real_distribution<float> radius(0.0f, 50.0f);
+            SphereBounds other(RandomVector(random, -100.0f, 100.0f), radius(random));
+            CheckResults(count,
+                [&](std::span<unsigned char> results) { spheres.TestOverlap(other, results); },
+                [&](std::span<unsigned char> results) { spheres.TestOverlapReference(other, results); });
+        }
+    }
+
+    // Known results, so both implementations can't be wrong in the same way
+    void TestKnownResults()
+    {
+        AabbArray boxes;
+        boxes.Add(glm::vec3(0.0f), glm::vec3(1.0f));
+        boxes.Add(glm::vec3(5.0f, 0.0f, 0.0f), glm::vec3(1.0f));
+        boxes.Add(glm::vec3(-1.5f, 0.0f, 0.0f), glm::vec3(1.0f));
+
+        // Only x <= 0.5 is in front
+        BoundsPlane plane(-1.0f, 0.0f, 0.0f, 0.5f);
+        std::vector<unsigned char> results(boxes.GetSize());
+        boxes.TestPlanes(std::span(&plane, 1), results);
+        TEST_CHECK(results[0] == 1 && results[1] == 0 && results[2] == 1);
+
+        boxes.TestOverlap(AabbBounds(glm::vec3(3.0f, 0.0f, 0.0f), glm::vec3(1.0f)), results);
+        TEST_CHECK(results[0] == 0 && results[1] == 1 && results[2] == 0);
+
+        AabbArray transformed;
+        boxes.Transform(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 2.0f, 0.0f)), glm::vec3(2.0f)), transformed);
+        TEST_CHECK(transformed.Get(1).GetCenter() == glm::vec3(10.0f, 2.0f, 0.0f));
+        TEST_CHECK(transformed.Get(1).GetSize() == glm::vec3(2.0f));
+    }
+}
+
+int main()
+{
+    // Both versions of the kernels, if the CPU can run the AVX2 one
+    for (bool avx2 : { false, true })
+    {
+        if (avx2 && !CpuFeatures::IsAvx2Supported())
+        {
+            std::printf("AVX2 is not supported, skipped the AVX2 kernels\n");
+            continue;
+        }
+        CpuFeatures::SetAvx2Enabled(avx2);
+
+        std::mt19937 random(12345);
+
+        TestKnownResults();
+
+        // Sizes around the batch size, to test the partial batches
+        for (size_t count : { 0, 1, 7, 8, 9, 15, 16, 17, 1000, 4099 })
+        {
+            TestAabbArray(random, count);
+            TestSphereArray(random, count);
+        }
+    }
+
+    return TestCheck::GetResult();
+}
@@ -0,0 +1,169 @@
+#include <ituGL/geometry/FoliageScatter.h>
+#include <ituGL/geometry/TerrainHeightfield.h>
+#include <ituGL/core/JobSystem.h>
+#include <glm/vector_relational.hpp>
+
+#include <TestCheck.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// Scatters instances over a heightfield, with chunks that don't divide the terrain evenly
+// Checks the min distance across chunk borders, the chunk ranges and bounds, the masks, and that any number of workers gives the same result
+
+namespace
+{
+    const unsigned int Width = 101;
+    const unsigned int Height = 61;
+    const float ChunkSize = 7.0f;
+
+    // Hills from -5 to 5 over a 100 x 60 area
+    TerrainHeightfield CreateHeightfield()
+    {
+        std::vector<float> heights(Width * Height);
+        for (unsigned int j = 0; j < Height; ++j)
+        {
+            for (unsigned int i = 0; i < Width; ++i)
+            {
+                heights[j * Width + i] = 5.0f * std::sin(i * 0.1f) * std::cos(j * 0.13f);
+            }
+        }
+
+        TerrainHeightfield heightfield;
+        heightfield.Initialize(heights, Width, Height, glm::vec2(1.0f), glm::vec2(-20.0f, 10.0f));
+        return heightfield;
+    }
+
+    std::vector<FoliageScatter::Instance> Scatter(const TerrainHeightfield& heightfield, const FoliageScatter::Settings& settings,
+        unsigned int workerCount, std::vector<FoliageScatter::Chunk>& chunks)
+    {
+        JobSystem jobSystem(workerCount);
+        std::vector<FoliageScatter::Instance> instances;
+        FoliageScatter::Scatter(heightfield, settings, ChunkSize, jobSystem, instances, chunks);
+        return instances;
+    }
+
+    bool IsSame(const std::vector<FoliageScatter::Instance>& a, const std::vector<FoliageScatter::Instance>& b)
+    {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(FoliageScatter::Instance)) == 0;
+    }
+
+    // Brute force, no two points closer than the min distance
+    bool CheckMinDistance(const std::vector<FoliageScatter::Instance>& instances, float minDistance)
+    {
+        // Small tolerance for the rounding of the distances
+        float minDistance2 = minDistance * minDistance * 0.9999f;
+        for (size_t i = 0; i < instances.size(); ++i)
+        {
+            for (size_t j = i + 1; j < instances.size(); ++j)
+            {
+                glm::vec2 delta(instances[i].position.x - instances[j].position.x, instances[i].position.z - instances[j].position.z);
+                if (delta.x * delta.x + delta.y * delta.y < minDistance2)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void TestDistribution(const TerrainHeightfield& heightfield)
+    {
+        FoliageScatter::Settings settings;
+        settings.minDistance = 1.25f;
+        settings.maxSlope = 10.0f;
+        settings.scaleRange = glm::vec2(0.5f, 2.0f);
+        settings.seed = 7;
+
+        std::vector<FoliageScatter::Chunk> chunks;
+        std::vector<FoliageScatter::Instance> instances = Scatter(heightfield, settings, 0, chunks);
+        TEST_CHECK(CheckMinDistance(instances, settings.minDistance));
+
+        // A Poisson-disk distribution fills the area. Each point keeps at most a disk of radius minDistance / 2 to itself
+        float area = (Width - 1) * (Height - 1) * 1.0f;
+        float pointArea = settings.minDistance * settings.minDistance;
+        TEST_CHECK(instances.size() > 0.5f * area / pointArea);
+        TEST_CHECK(instances.size() < 1.3f * area / pointArea);
+
+        // 15 x 9 chunks, in rows, covering the instances in order
+        TEST_CHECK(chunks.size() == 15 * 9);
+        unsigned int nextInstance = 0;
+        for (size_t index = 0; index < chunks.size(); ++index)
+        {
+            const FoliageScatter::Chunk& chunk = chunks[index];
+            TEST_CHECK(chunk.firstInstance == nextInstance);
+            nextInstance += chunk.instanceCount;
+
+            glm::vec2 chunkMin = glm::vec2(-20.0f, 10.0f) + glm::vec2(index % 15, index / 15) * ChunkSize;
+            for (unsigned int i = chunk.firstInstance; i < chunk.firstInstance + chunk.instanceCount; ++i)
+            {
+                const glm::vec3& position = instances[i].position;
+                TEST_CHECK(glm::all(glm::greaterThanEqual(position, chunk.boundsMin)) && glm::all(glm::lessThanEqual(position, chunk.boundsMax)));
+                TEST_CHECK(position.x >= chunkMin.x && position.x <= chunkMin.x + ChunkSize);
+                TEST_CHECK(position.z >= chunkMin.y && position.z <= chunkMin.y + ChunkSize);
+                TEST_CHECK(position.y == heightfield.SampleHeight(position.x, position.z));
+
+                float scale = FoliageScatter::GetScale(instances[i]);
+                float yaw = FoliageScatter::GetYaw(instances[i]);
+                TEST_CHECK(scale >= 0.499f && scale <= 2.001f);
+                TEST_CHECK(yaw >= 0.0f && yaw <= 6.3f);
+            }
+        }
+        TEST_CHECK(nextInstance == instances.size());
+
+        // Same result with any number of workers, the chunks of a phase run in any order
+        for (unsigned int workerCount : { 1u, 2u, 5u })
+        {
+            std::vector<FoliageScatter::Chunk> workerChunks;
+            TEST_CHECK(IsSame(Scatter(heightfield, settings, workerCount, workerChunks), instances));
+            TEST_CHECK(workerChunks.size() == chunks.size());
+        }
+
+        // Another seed gives another distribution, with the same guarantees
+        settings.seed = 8;
+        std::vector<FoliageScatter::Instance> otherInstances = Scatter(heightfield, settings, 2, chunks);
+        TEST_CHECK(!IsSame(otherInstances, instances));
+        TEST_CHECK(CheckMinDistance(otherInstances, settings.minDistance));
+    }
+
+    void TestMasks(const TerrainHeightfield& heightfield)
+    {
+        FoliageScatter::Settings settings;
+        settings.minDistance = 1.0f;
+        settings.maxSlope = 10.0f;
+        settings.minHeight = -2.0f;
+        settings.maxHeight = 3.0f;
+
+        std::vector<FoliageScatter::Chunk> chunks;
+        std::vector<FoliageScatter::Instance> all = Scatter(heightfield, settings, 3, chunks);
+        TEST_CHECK(!all.empty());
+        for (const FoliageScatter::Instance& instance : all)
+        {
+            TEST_CHECK(instance.position.y >= -2.0f && instance.position.y <= 3.0f);
+        }
+
+        // Half the density keeps about half the points
+        settings.density = 0.5f;
+        std::vector<FoliageScatter::Instance> half = Scatter(heightfield, settings, 3, chunks);
+        TEST_CHECK(half.size() > all.size() * 0.4f && half.size() < all.size() * 0.6f);
+
+        // Flat ground only, the slope of the hills is up to about 0.46 radians
+        settings.density = 1.0f;
+        settings.maxSlope = 0.2f;
+        std::vector<FoliageScatter::Instance> flat = Scatter(heightfield, settings, 3, chunks);
+        TEST_CHECK(flat.size() < all.size());
+        for (const FoliageScatter::Instance& instance : flat)
+        {
+            TEST_CHECK(heightfield.SampleNormal(instance.position.x, instance.position.z).y >= std::cos(0.2f) - 1e-5f);
+        }
+    }
+}
+
+int main()
+{
+    TerrainHeightfield heightfield = CreateHeightfield();
+
+    TestDistribution(heightfield);
+    TestMasks(heightfield);
+    return TestCheck::GetResult();
+}
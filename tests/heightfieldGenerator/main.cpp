@@ -0,0 +1,153 @@
+#include <ituGL/geometry/HeightfieldGenerator.h>
+#include <ituGL/core/JobSystem.h>
+#include <ituGL/core/CpuFeatures.h>
+
+#include <TestCheck.h>
+#include <glm/vec3.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#define STB_PERLIN_IMPLEMENTATION
+#include <stb_perlin.h>
+
+// Checks that the heightfields and tangent frames don't depend on the number of worker threads,
+// and that they match the scalar reference and stb_perlin_fbm_noise3
+
+namespace
+{
+    struct Vertex
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec3 tangent;
+        glm::vec3 bitangent;
+    };
+
+    // Same sample coordinates as HeightfieldGenerator
+    float GetNoiseCoordinate(unsigned int i, unsigned int count, float min, float max)
+    {
+        float t = static_cast<float>(i) / static_cast<float>(count > 1 ? count - 1 : 1);
+        return min + (max - min) * t;
+    }
+
+    float GetMaxDifference(std::span<const float> values, std::span<const float> expected)
+    {
+        float maxDifference = 0.0f;
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            maxDifference = std::max(maxDifference, std::abs(values[i] - expected[i]));
+        }
+        return maxDifference;
+    }
+
+    std::vector<float> ComputeTangentFrames(std::span<const float> heights, unsigned int width, unsigned int height, JobSystem* jobSystem)
+    {
+        const glm::vec2 spacing(0.5f, 0.75f);
+        std::vector<Vertex> vertices(static_cast<size_t>(width) * height);
+        if (jobSystem)
+        {
+            HeightfieldGenerator::ComputeTangentFrames(heights, width, height, spacing, vertices,
+                offsetof(Vertex, normal), offsetof(Vertex, tangent), offsetof(Vertex, bitangent), *jobSystem);
+        }
+        else
+        {
+            std::span<std::byte> vertexData(reinterpret_cast<std::byte*>(vertices.data()), vertices.size() * sizeof(Vertex));
+            HeightfieldGenerator::ComputeTangentFramesReference(heights, width, height, spacing, vertexData, sizeof(Vertex),
+                offsetof(Vertex, normal), offsetof(Vertex, tangent), offsetof(Vertex, bitangent));
+        }
+
+        // Only the frames, the positions are not written
+        std::vector<float> frames;
+        for (const Vertex& vertex : vertices)
+        {
+            for (const glm::vec3& vector : { vertex.normal, vertex.tangent, vertex.bitangent })
+            {
+                frames.insert(frames.end(), { vector.x, vector.y, vector.z });
+            }
+        }
+        return frames;
+    }
+
+    void CheckHeightfield(unsigned int width, unsigned int height, const HeightfieldGenerator::NoiseSettings& settings, std::span<JobSystem*> jobSystems)
+    {
+        // Every worker count gives the same bits
+        std::vector<float> heights = HeightfieldGenerator::Generate(width, height, settings, *jobSystems[0]);
+        std::vector<float> frames = ComputeTangentFrames(heights, width, height, jobSystems[0]);
+        for (JobSystem* jobSystem : jobSystems.subspan(1))
+        {
+            std::vector<float> otherHeights = HeightfieldGenerator::Generate(width, height, settings, *jobSystem);
+            TEST_CHECK(std::memcmp(otherHeights.data(), heights.data(), heights.size() * sizeof(float)) == 0);
+
+            std::vector<float> otherFrames = ComputeTangentFrames(heights, width, height, jobSystem);
+            TEST_CHECK(std::memcmp(otherFrames.data(), frames.data(), frames.size() * sizeof(float)) == 0);
+        }
+
+        // Close to the scalar reference, and to stb. The noise values are up to about the sum of the amplitudes
+        const float tolerance = 1e-5f * settings.height * settings.octaves;
+        std::vector<float> referenceHeights(heights.size());
+        HeightfieldGenerator::GenerateReference(referenceHeights, width, height, settings);
+        TEST_CHECK(GetMaxDifference(heights, referenceHeights) <= tolerance);
+
+        std::vector<float> stbHeights(heights.size());
+        for (unsigned int j = 0; j < height; ++j)
+        {
+            float y = GetNoiseCoordinate(j, height, settings.noiseMin.y, settings.noiseMax.y);
+            for (unsigned int i = 0; i < width; ++i)
+            {
+                float x = GetNoiseCoordinate(i, width, settings.noiseMin.x, settings.noiseMax.x);
+                stbHeights[static_cast<size_t>(j) * width + i] = settings.height
+                    * stb_perlin_fbm_noise3(x, y, settings.noiseZ, settings.lacunarity, settings.gain, settings.octaves);
+            }
+        }
+        TEST_CHECK(GetMaxDifference(heights, stbHeights) <= tolerance);
+
+        // Unit vectors, so the same tolerance for every component
+        std::vector<float> referenceFrames = ComputeTangentFrames(heights, width, height, nullptr);
+        TEST_CHECK(GetMaxDifference(frames, referenceFrames) <= 1e-5f);
+    }
+}
+
+int main()
+{
+    // No workers runs all the jobs in the waiting thread. The row split depends on the width, not on the worker count
+    JobSystem noWorkers(0), oneWorker(1), fourWorkers(4);
+    JobSystem* jobSystems[] = { &noWorkers, &oneWorker, &fourWorkers };
+
+    // Both versions of the rows, if the CPU can run the AVX2 one
+    for (bool avx2 : { false, true })
+    {
+        if (avx2 && !CpuFeatures::IsAvx2Supported())
+        {
+            std::printf("AVX2 is not supported, skipped the AVX2 rows\n");
+            continue;
+        }
+        CpuFeatures::SetAvx2Enabled(avx2);
+
+        HeightfieldGenerator::NoiseSettings settings;
+        settings.noiseMin = glm::vec2(-3.7f, 2.1f);
+        settings.noiseMax = glm::vec2(5.2f, 9.9f);
+        settings.height = 20.0f;
+
+        // Sizes that are not multiples of the vector width, and rows split in several jobs
+        const unsigned int sizes[][2] = { { 1, 1 }, { 2, 3 }, { 7, 5 }, { 33, 17 }, { 129, 200 }, { 1025, 64 } };
+        for (const auto& size : sizes)
+        {
+            // With z at an integer the second noise plane is skipped, so test both
+            for (float noiseZ : { 0.0f, 0.37f })
+            {
+                settings.noiseZ = noiseZ;
+                CheckHeightfield(size[0], size[1], settings, jobSystems);
+            }
+        }
+
+        settings.octaves = 1;
+        settings.lacunarity = 3.0f;
+        settings.gain = 0.3f;
+        CheckHeightfield(100, 100, settings, jobSystems);
+    }
+
+    return TestCheck::GetResult();
+}
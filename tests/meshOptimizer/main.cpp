@@ -0,0 +1,200 @@
+#include <ituGL/geometry/MeshOptimizer.h>
+
+#include <TestCheck.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <tuple>
+#include <vector>
+
+// Measures the vertex cache ACMR/ATVR and the overfetch of a grid with shuffled triangles, before and after each optimization step
+// Checks that the steps improve them, and that the mesh still has the same triangles
+
+namespace
+{
+    struct Vertex
+    {
+        glm::vec3 position;
+        glm::vec2 texCoord;
+    };
+
+    struct Mesh
+    {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+    };
+
+    // Grid of size x size quads, with the triangles and the vertices in random order, and one vertex that no triangle uses
+    Mesh MakeShuffledGrid(unsigned int size)
+    {
+        Mesh mesh;
+        for (unsigned int y = 0; y <= size; ++y)
+        {
+            for (unsigned int x = 0; x <= size; ++x)
+            {
+                mesh.vertices.push_back(Vertex{ glm::vec3(x, 0.0f, y), glm::vec2(x, y) / static_cast<float>(size) });
+            }
+        }
+        mesh.vertices.push_back(Vertex{ glm::vec3(-1.0f), glm::vec2(0.0f) });
+
+        std::vector<std::array<unsigned int, 3>> triangles;
+        for (unsigned int y = 0; y < size; ++y)
+        {
+            for (unsigned int x = 0; x < size; ++x)
+            {
+                unsigned int i = y * (size + 1) + x;
+                triangles.push_back({ i, i + size + 1, i + 1 });
+                triangles.push_back({ i + 1, i + size + 1, i + size + 2 });
+            }
+        }
+        std::mt19937 random(1);
+        std::shuffle(triangles.begin(), triangles.end(), random);
+
+        std::vector<unsigned int> remap(mesh.vertices.size());
+        std::iota(remap.begin(), remap.end(), 0u);
+        std::shuffle(remap.begin(), remap.end(), random);
+        std::vector<Vertex> vertices(mesh.vertices.size());
+        for (size_t i = 0; i < remap.size(); ++i)
+        {
+            vertices[remap[i]] = mesh.vertices[i];
+        }
+        mesh.vertices = std::move(vertices);
+
+        for (const auto& triangle : triangles)
+        {
+            for (unsigned int index : triangle)
+            {
+                mesh.indices.push_back(remap[index]);
+            }
+        }
+        return mesh;
+    }
+
+    // Triangles as positions, rotated so the smallest comes first to keep the winding, and sorted
+    std::vector<std::array<float, 9>> GetTriangles(const Mesh& mesh)
+    {
+        std::vector<std::array<float, 9>> triangles;
+        for (size_t i = 0; i < mesh.indices.size(); i += 3)
+        {
+            std::array<glm::vec3, 3> positions;
+            for (int j = 0; j < 3; ++j)
+            {
+                positions[j] = mesh.vertices[mesh.indices[i + j]].position;
+            }
+            auto less = [](const glm::vec3& a, const glm::vec3& b) { return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z); };
+            std::rotate(positions.begin(), std::min_element(positions.begin(), positions.end(), less), positions.end());
+
+            std::array<float, 9> triangle;
+            for (int j = 0; j < 3; ++j)
+            {
+                triangle[j * 3 + 0] = positions[j].x;
+                triangle[j * 3 + 1] = positions[j].y;
+                triangle[j * 3 + 2] = positions[j].z;
+            }
+            triangles.push_back(triangle);
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    MeshOptimizer::VertexCacheStatistics AnalyzeVertexCache(const Mesh& mesh)
+    {
+        return MeshOptimizer::AnalyzeVertexCache(mesh.indices, static_cast<unsigned int>(mesh.vertices.size()));
+    }
+
+    MeshOptimizer::VertexFetchStatistics AnalyzeVertexFetch(const Mesh& mesh)
+    {
+        return MeshOptimizer::AnalyzeVertexFetch(mesh.indices, static_cast<unsigned int>(mesh.vertices.size()), sizeof(Vertex));
+    }
+
+    void TestStatistics()
+    {
+        // Every vertex of the first triangle misses, the second triangle reuses two
+        std::vector<unsigned int> indices = { 0, 1, 2, 2, 1, 3 };
+        MeshOptimizer::VertexCacheStatistics statistics = MeshOptimizer::AnalyzeVertexCache(std::span(indices).first(3), 3);
+        TEST_CHECK(statistics.transformedCount == 3);
+        TEST_CHECK(statistics.acmr == 3.0f);
+        TEST_CHECK(statistics.atvr == 1.0f);
+        statistics = MeshOptimizer::AnalyzeVertexCache(indices, 4);
+        TEST_CHECK(statistics.transformedCount == 4);
+        TEST_CHECK(statistics.acmr == 2.0f);
+        TEST_CHECK(statistics.atvr == 1.0f);
+
+        // With a cache of 3, the first vertex is evicted before it is used again
+        indices = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+        statistics = MeshOptimizer::AnalyzeVertexCache(indices, 6, 3);
+        TEST_CHECK(statistics.transformedCount == 9);
+        TEST_CHECK(statistics.atvr == 1.5f);
+    }
+
+    void TestOptimize()
+    {
+        Mesh mesh = MakeShuffledGrid(64);
+        unsigned int vertexCount = static_cast<unsigned int>(mesh.vertices.size());
+        std::vector<std::array<float, 9>> triangles = GetTriangles(mesh);
+
+        // Random order misses the cache on almost every vertex
+        MeshOptimizer::VertexCacheStatistics shuffled = AnalyzeVertexCache(mesh);
+        TEST_CHECK(shuffled.acmr > 2.0f);
+
+        // A grid can't go below 0.5, and Forsyth's algorithm gets close to 0.7 with 16 entries
+        MeshOptimizer::OptimizeVertexCache(mesh.indices, vertexCount);
+        MeshOptimizer::VertexCacheStatistics optimized = AnalyzeVertexCache(mesh);
+        std::printf("ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", shuffled.acmr, optimized.acmr, shuffled.atvr, optimized.atvr);
+        TEST_CHECK(optimized.acmr >= 0.5f && optimized.acmr < 0.8f);
+        TEST_CHECK(optimized.atvr < 1.6f);
+        TEST_CHECK(GetTriangles(mesh) == triangles);
+
+        // Overdraw order may cost a few more cache misses, within the threshold
+        MeshOptimizer::OptimizeOverdraw(mesh.indices, std::as_bytes(std::span(mesh.vertices)), sizeof(Vertex), offsetof(Vertex, position), 1.05f);
+        MeshOptimizer::VertexCacheStatistics overdraw = AnalyzeVertexCache(mesh);
+        TEST_CHECK(overdraw.acmr <= optimized.acmr * 1.05f + 0.01f);
+        TEST_CHECK(GetTriangles(mesh) == triangles);
+
+        // Vertices in order of first use, and the unused vertex removed
+        MeshOptimizer::VertexFetchStatistics fetchBefore = AnalyzeVertexFetch(mesh);
+        unsigned int usedCount = MeshOptimizer::OptimizeVertexFetch(mesh.indices, mesh.vertices);
+        MeshOptimizer::VertexFetchStatistics fetchAfter = AnalyzeVertexFetch(mesh);
+        std::printf("Overfetch %.3f -> %.3f\n", fetchBefore.overfetch, fetchAfter.overfetch);
+        TEST_CHECK(usedCount == vertexCount - 1);
+        TEST_CHECK(mesh.vertices.size() == usedCount);
+        TEST_CHECK(fetchBefore.overfetch > 3.0f);
+        TEST_CHECK(fetchAfter.overfetch < 2.0f);
+        TEST_CHECK(AnalyzeVertexCache(mesh).transformedCount == overdraw.transformedCount);
+        TEST_CHECK(GetTriangles(mesh) == triangles);
+
+        unsigned int nextIndex = 0;
+        bool firstUseOrder = true;
+        for (unsigned int index : mesh.indices)
+        {
+            firstUseOrder &= index <= nextIndex;
+            nextIndex = std::max(nextIndex, index + 1);
+        }
+        TEST_CHECK(firstUseOrder);
+    }
+
+    void TestOptimizeAll()
+    {
+        Mesh mesh = MakeShuffledGrid(32);
+        std::vector<std::array<float, 9>> triangles = GetTriangles(mesh);
+        float shuffledAcmr = AnalyzeVertexCache(mesh).acmr;
+
+        unsigned int usedCount = MeshOptimizer::Optimize(mesh.indices, mesh.vertices, offsetof(Vertex, position));
+        TEST_CHECK(usedCount == mesh.vertices.size());
+        TEST_CHECK(AnalyzeVertexCache(mesh).acmr < shuffledAcmr * 0.5f);
+        TEST_CHECK(GetTriangles(mesh) == triangles);
+    }
+}
+
+int main()
+{
+    TestStatistics();
+    TestOptimize();
+    TestOptimizeAll();
+    return TestCheck::GetResult();
+}
@@ -0,0 +1,137 @@
+#include <ituGL/texture/MipChain.h>
+
+#include <TestCheck.h>
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Compares the optimized mip generation against the scalar reference, that must give the same bytes
+// Random images of odd and power of two sizes, every component count, data type, color space and filter
+
+namespace
+{
+    const char* GetFilterName(MipChain::Filter filter)
+    {
+        return filter == MipChain::Filter::Box ? "box" : "kaiser";
+    }
+
+    std::vector<std::byte> CreateImage(std::mt19937& random, int width, int height, int components, Data::Type dataType)
+    {
+        size_t texelCount = static_cast<size_t>(width) * height * components;
+        std::vector<std::byte> data;
+        if (dataType == Data::Type::Float)
+        {
+            // Include values out of [0, 1], float data is not clamped
+            std::uniform_real_distribution<float> value(-0.5f, 4.0f);
+            std::vector<float> texels(texelCount);
+            for (float& texel : texels)
+            {
+                texel = value(random);
+            }
+            data.resize(texelCount * sizeof(float));
+            std::memcpy(data.data(), texels.data(), data.size());
+        }
+        else
+        {
+            std::uniform_int_distribution<int> value(0, 255);
+            data.resize(texelCount);
+            for (std::byte& texel : data)
+            {
+                texel = static_cast<std::byte>(value(random));
+            }
+        }
+        return data;
+    }
+
+    void CheckEquivalent(std::span<const std::byte> data, int width, int height, int components, Data::Type dataType, bool srgb, MipChain::Filter filter)
+    {
+        MipChain mipChain, reference;
+        mipChain.Generate(data, width, height, components, dataType, srgb, filter);
+        reference.GenerateReference(data, width, height, components, dataType, srgb, filter);
+
+        // Enough levels to reach 1x1
+        unsigned int expectedLevelCount = 1;
+        for (int size = std::max(width, height); size > 1; size /= 2)
+        {
+            ++expectedLevelCount;
+        }
+
+        bool equal = TEST_CHECK(mipChain.GetLevelCount() == expectedLevelCount)
+            && TEST_CHECK(reference.GetLevelCount() == expectedLevelCount);
+        for (unsigned int level = 0; equal && level < mipChain.GetLevelCount(); ++level)
+        {
+            const MipChain::Level& optimized = mipChain.GetLevel(level);
+            const MipChain::Level& expected = reference.GetLevel(level);
+            equal = TEST_CHECK(optimized.width == expected.width && optimized.height == expected.height)
+                && TEST_CHECK(optimized.data.size() == expected.data.size())
+                && TEST_CHECK(std::memcmp(optimized.data.data(), expected.data.data(), expected.data.size()) == 0);
+        }
+        if (!equal)
+        {
+            std::printf("  %dx%d, %d components, %s, %s, %s filter\n", width, height, components,
+                dataType == Data::Type::Float ? "float" : "ubyte", srgb ? "srgb" : "linear", GetFilterName(filter));
+        }
+    }
+
+    // A constant image stays constant in every level, with both filters
+    void TestConstantImage()
+    {
+        const int width = 37, height = 12;
+        std::vector<std::byte> data(width * height * 4);
+        for (size_t i = 0; i < data.size(); i += 4)
+        {
+            data[i + 0] = std::byte(10);
+            data[i + 1] = std::byte(128);
+            data[i + 2] = std::byte(250);
+            data[i + 3] = std::byte(77);
+        }
+
+        for (MipChain::Filter filter : { MipChain::Filter::Box, MipChain::Filter::Kaiser })
+        {
+            for (bool srgb : { false, true })
+            {
+                MipChain mipChain;
+                mipChain.Generate(data, width, height, 4, Data::Type::UByte, srgb, filter);
+                for (unsigned int level = 0; level < mipChain.GetLevelCount(); ++level)
+                {
+                    const MipChain::Level& mipLevel = mipChain.GetLevel(level);
+                    bool constant = mipLevel.data.size() == static_cast<size_t>(mipLevel.width) * mipLevel.height * 4;
+                    for (size_t i = 0; constant && i < mipLevel.data.size(); ++i)
+                    {
+                        constant = mipLevel.data[i] == data[i % 4];
+                    }
+                    TEST_CHECK(constant);
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    std::mt19937 random(12345);
+
+    const int sizes[][2] = { { 1, 1 }, { 2, 2 }, { 3, 5 }, { 7, 1 }, { 1, 9 }, { 16, 16 }, { 33, 17 }, { 64, 31 }, { 257, 3 }, { 128, 128 } };
+    for (const auto& size : sizes)
+    {
+        for (int components = 1; components <= 4; ++components)
+        {
+            for (Data::Type dataType : { Data::Type::UByte, Data::Type::Float })
+            {
+                std::vector<std::byte> data = CreateImage(random, size[0], size[1], components, dataType);
+                for (bool srgb : { false, true })
+                {
+                    for (MipChain::Filter filter : { MipChain::Filter::Box, MipChain::Filter::Kaiser })
+                    {
+                        CheckEquivalent(data, size[0], size[1], components, dataType, srgb, filter);
+                    }
+                }
+            }
+        }
+    }
+
+    TestConstantImage();
+
+    return TestCheck::GetResult();
+}
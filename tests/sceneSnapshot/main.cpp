@@ -0,0 +1,349 @@
+#include <ituGL/scene/Scene.h>
+#include <ituGL/scene/SceneSnapshot.h>
+#include <ituGL/scene/SceneModel.h>
+#include <ituGL/scene/SceneLight.h>
+#include <ituGL/scene/SceneCamera.h>
+#include <ituGL/scene/Transform.h>
+#include <ituGL/geometry/Model.h>
+#include <ituGL/camera/Camera.h>
+#include <ituGL/lighting/DirectionalLight.h>
+#include <ituGL/lighting/PointLight.h>
+#include <ituGL/lighting/SpotLight.h>
+
+#include <TestCheck.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Saves a scene with every node type and a transform hierarchy, loads it back and compares the nodes
+// Then corrupts the file in several ways, and checks that the snapshot fails to open
+
+namespace
+{
+    // Same layout as SceneSnapshot::Header, to corrupt the files
+    struct SnapshotHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t nodeCount;
+        std::uint32_t lightCount;
+        std::uint32_t cameraCount;
+        std::uint32_t stringsSize;
+        std::uint64_t typesOffset;
+        std::uint64_t dataIndicesOffset;
+        std::uint64_t namesOffset;
+        std::uint64_t modelIdsOffset;
+        std::uint64_t translationsOffset;
+        std::uint64_t rotationsOffset;
+        std::uint64_t scalesOffset;
+        std::uint64_t boundsMinOffset;
+        std::uint64_t boundsMaxOffset;
+        std::uint64_t parentsOffset;
+        std::uint64_t lightsOffset;
+        std::uint64_t camerasOffset;
+        std::uint64_t stringsOffset;
+    };
+
+    struct TestModels
+    {
+        std::shared_ptr<Model> rock = std::make_shared<Model>();
+        std::shared_ptr<Model> tree = std::make_shared<Model>();
+        // Not referenced by id, nodes using it are not saved
+        std::shared_ptr<Model> unknown = std::make_shared<Model>();
+
+        AssetId GetModelId(const Model& model) const
+        {
+            return &model == rock.get() ? 1 : &model == tree.get() ? 2 : 0;
+        }
+
+        std::shared_ptr<Model> GetModel(AssetId modelId) const
+        {
+            return modelId == 1 ? rock : modelId == 2 ? tree : nullptr;
+        }
+    };
+
+    std::shared_ptr<SceneModel> AddModel(Scene& scene, const std::string& name, std::shared_ptr<Model> model, glm::vec3 translation)
+    {
+        std::shared_ptr<SceneModel> node = std::make_shared<SceneModel>(name, model, glm::vec3(-1.0f, 0.0f, -2.0f), glm::vec3(1.0f, 3.0f, 2.0f));
+        node->GetTransform()->SetTranslation(translation);
+        node->GetTransform()->SetRotation(glm::vec3(0.1f, 0.2f, 0.3f));
+        node->GetTransform()->SetScale(glm::vec3(2.0f));
+        scene.AddSceneNode(node);
+        return node;
+    }
+
+    // Children are added before their parents, so the loader must link them after creating all the nodes
+    void BuildScene(Scene& scene, const TestModels& models)
+    {
+        std::shared_ptr<SceneModel> leaf = AddModel(scene, "leaf", models.tree, glm::vec3(0.0f, 1.0f, 0.0f));
+        std::shared_ptr<SceneModel> branch = AddModel(scene, "branch", models.tree, glm::vec3(0.0f, 2.0f, 0.0f));
+        std::shared_ptr<SceneModel> trunk = AddModel(scene, "trunk", models.tree, glm::vec3(10.0f, 0.0f, -5.0f));
+        leaf->GetTransform()->SetParent(branch->GetTransform());
+        branch->GetTransform()->SetParent(trunk->GetTransform());
+
+        AddModel(scene, "rock", models.rock, glm::vec3(-3.0f, 0.0f, 4.0f));
+        AddModel(scene, "unknown", models.unknown, glm::vec3(0.0f));
+
+        // Parent transform not owned by any node
+        std::shared_ptr<SceneModel> orphan = AddModel(scene, "orphan", models.rock, glm::vec3(1.0f));
+        std::shared_ptr<Transform> looseParent = std::make_shared<Transform>();
+        looseParent->SetTranslation(glm::vec3(100.0f));
+        orphan->GetTransform()->SetParent(looseParent);
+
+        std::shared_ptr<DirectionalLight> directionalLight = std::make_shared<DirectionalLight>();
+        directionalLight->SetColor(glm::vec3(1.0f, 0.9f, 0.8f));
+        directionalLight->SetIntensity(2.0f);
+        directionalLight->SetDirection(glm::normalize(glm::vec3(1.0f, -1.0f, 0.5f)));
+        directionalLight->SetShadowBias(0.01f);
+        directionalLight->SetShadowMapResolution(glm::vec2(1024.0f));
+        scene.AddSceneNode(std::make_shared<SceneLight>("sun", directionalLight));
+
+        std::shared_ptr<PointLight> pointLight = std::make_shared<PointLight>();
+        pointLight->SetColor(glm::vec3(0.2f, 0.4f, 1.0f));
+        pointLight->SetPosition(glm::vec3(4.0f, 5.0f, 6.0f));
+        pointLight->SetDistanceAttenuation(glm::vec2(3.0f, 8.0f));
+        scene.AddSceneNode(std::make_shared<SceneLight>("lamp", pointLight));
+
+        std::shared_ptr<SpotLight> spotLight = std::make_shared<SpotLight>();
+        spotLight->SetPosition(glm::vec3(-4.0f, 5.0f, 6.0f));
+        spotLight->SetDirection(glm::vec3(0.0f, -1.0f, 0.0f));
+        spotLight->SetDistanceAttenuation(glm::vec2(1.0f, 9.0f));
+        spotLight->SetAngleAttenuation(glm::vec2(0.3f, 0.6f));
+        scene.AddSceneNode(std::make_shared<SceneLight>("spot", spotLight));
+
+        std::shared_ptr<Camera> camera = std::make_shared<Camera>();
+        camera->SetViewMatrix(glm::vec3(0.0f, 5.0f, 10.0f), glm::vec3(0.0f));
+        camera->SetPerspectiveProjectionMatrix(1.0f, 1.5f, 0.1f, 100.0f);
+        scene.AddSceneNode(std::make_shared<SceneCamera>("camera", camera));
+    }
+
+    void CheckTransform(const SceneNode& loaded, const SceneNode& original)
+    {
+        TEST_CHECK(loaded.GetTransform()->GetTranslation() == original.GetTransform()->GetTranslation());
+        TEST_CHECK(loaded.GetTransform()->GetRotation() == original.GetTransform()->GetRotation());
+        TEST_CHECK(loaded.GetTransform()->GetScale() == original.GetTransform()->GetScale());
+    }
+
+    void CheckLight(const Scene& loadedScene, const Scene& originalScene, const std::string& name)
+    {
+        auto loaded = std::dynamic_pointer_cast<SceneLight>(loadedScene.GetSceneNode(name));
+        auto original = std::dynamic_pointer_cast<SceneLight>(originalScene.GetSceneNode(name));
+        if (!TEST_CHECK(loaded != nullptr))
+        {
+            return;
+        }
+        const Light& loadedLight = *loaded->GetLight();
+        const Light& originalLight = *original->GetLight();
+        TEST_CHECK(loadedLight.GetType() == originalLight.GetType());
+        TEST_CHECK(loadedLight.GetColor() == originalLight.GetColor());
+        TEST_CHECK(loadedLight.GetIntensity() == originalLight.GetIntensity());
+        TEST_CHECK(loadedLight.GetPosition() == originalLight.GetPosition());
+        TEST_CHECK(loadedLight.GetDirection() == originalLight.GetDirection());
+        TEST_CHECK(loadedLight.GetAttenuation() == originalLight.GetAttenuation());
+        TEST_CHECK(loadedLight.GetShadowBias() == originalLight.GetShadowBias());
+        TEST_CHECK(loadedLight.GetShadowMapResolution() == originalLight.GetShadowMapResolution());
+        CheckTransform(*loaded, *original);
+    }
+
+    void TestRoundTrip(const std::string& path)
+    {
+        TestModels models;
+        Scene scene;
+        BuildScene(scene, models);
+        TEST_CHECK(scene.Save(path.c_str(), [&](const Model& model) { return models.GetModelId(model); }));
+
+        Scene loadedScene;
+        TEST_CHECK(loadedScene.Load(path.c_str(), [&](AssetId modelId) { return models.GetModel(modelId); }));
+        TEST_CHECK(loadedScene.GetSceneNodeCount() == scene.GetSceneNodeCount() - 1);
+        TEST_CHECK(loadedScene.GetSceneNode("unknown") == nullptr);
+
+        for (const char* name : { "leaf", "branch", "trunk", "rock", "orphan" })
+        {
+            auto loaded = std::dynamic_pointer_cast<SceneModel>(loadedScene.GetSceneNode(name));
+            auto original = std::dynamic_pointer_cast<SceneModel>(scene.GetSceneNode(name));
+            if (!TEST_CHECK(loaded != nullptr))
+            {
+                continue;
+            }
+            TEST_CHECK(loaded->GetModel() == original->GetModel());
+            TEST_CHECK(loaded->GetAabbCenter() == original->GetAabbCenter());
+            TEST_CHECK(loaded->GetAabbExtents() == original->GetAabbExtents());
+            CheckTransform(*loaded, *original);
+        }
+
+        // The hierarchy is restored, and gives the same world matrices
+        std::shared_ptr<SceneNode> leaf = loadedScene.GetSceneNode("leaf");
+        std::shared_ptr<SceneNode> branch = loadedScene.GetSceneNode("branch");
+        std::shared_ptr<SceneNode> trunk = loadedScene.GetSceneNode("trunk");
+        if (leaf && branch && trunk)
+        {
+            TEST_CHECK(leaf->GetTransform()->GetParent() == branch->GetTransform());
+            TEST_CHECK(branch->GetTransform()->GetParent() == trunk->GetTransform());
+            TEST_CHECK(trunk->GetTransform()->GetParent() == nullptr);
+            TEST_CHECK(leaf->GetTransform()->GetTransformMatrix() == scene.GetSceneNode("leaf")->GetTransform()->GetTransformMatrix());
+        }
+
+        // Parents that don't belong to a stored node are dropped
+        if (std::shared_ptr<SceneNode> orphan = loadedScene.GetSceneNode("orphan"))
+        {
+            TEST_CHECK(orphan->GetTransform()->GetParent() == nullptr);
+        }
+
+        CheckLight(loadedScene, scene, "sun");
+        CheckLight(loadedScene, scene, "lamp");
+        CheckLight(loadedScene, scene, "spot");
+
+        auto camera = std::dynamic_pointer_cast<SceneCamera>(loadedScene.GetSceneNode("camera"));
+        auto originalCamera = std::dynamic_pointer_cast<SceneCamera>(scene.GetSceneNode("camera"));
+        if (TEST_CHECK(camera != nullptr))
+        {
+            TEST_CHECK(camera->GetCamera()->GetViewMatrix() == originalCamera->GetCamera()->GetViewMatrix());
+            TEST_CHECK(camera->GetCamera()->GetProjectionMatrix() == originalCamera->GetCamera()->GetProjectionMatrix());
+            CheckTransform(*camera, *originalCamera);
+        }
+    }
+
+    // Nodes whose parent is filtered out are stored without parent
+    void TestFilteredParent(const std::string& path)
+    {
+        TestModels models;
+        Scene scene;
+        BuildScene(scene, models);
+        auto filter = [](const SceneNode& node) { return node.GetName() != "branch"; };
+        TEST_CHECK(SceneSnapshot::Save(path.c_str(), scene, [&](const Model& model) { return models.GetModelId(model); }, filter));
+
+        SceneSnapshot snapshot;
+        if (!TEST_CHECK(snapshot.Open(path.c_str())))
+        {
+            return;
+        }
+        for (unsigned int nodeIndex = 0; nodeIndex < snapshot.GetNodeCount(); ++nodeIndex)
+        {
+            TEST_CHECK(snapshot.GetNodeName(nodeIndex) != "branch");
+            if (snapshot.GetNodeName(nodeIndex) == "leaf")
+            {
+                TEST_CHECK(snapshot.GetParentIndices()[nodeIndex] == SceneSnapshot::NoParent);
+            }
+        }
+    }
+
+    std::vector<char> ReadFile(const std::string& path)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+
+    bool OpenModified(const std::string& path, std::vector<char> data)
+    {
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(data.data(), data.size());
+        SceneSnapshot snapshot;
+        return snapshot.Open(path.c_str());
+    }
+
+    template<typename T>
+    void WriteValue(std::vector<char>& data, std::uint64_t offset, T value)
+    {
+        std::memcpy(data.data() + offset, &value, sizeof(T));
+    }
+
+    unsigned int FindNode(const SceneSnapshot& snapshot, std::string_view name)
+    {
+        for (unsigned int nodeIndex = 0; nodeIndex < snapshot.GetNodeCount(); ++nodeIndex)
+        {
+            if (snapshot.GetNodeName(nodeIndex) == name)
+            {
+                return nodeIndex;
+            }
+        }
+        return SceneSnapshot::NoParent;
+    }
+
+    void TestCorruptFiles(const std::string& path, const std::string& corruptPath)
+    {
+        TestModels models;
+        Scene scene;
+        BuildScene(scene, models);
+        TEST_CHECK(scene.Save(path.c_str(), [&](const Model& model) { return models.GetModelId(model); }));
+
+        unsigned int leafIndex, branchIndex, lampIndex, cameraIndex;
+        {
+            SceneSnapshot snapshot;
+            if (!TEST_CHECK(snapshot.Open(path.c_str())))
+            {
+                return;
+            }
+            leafIndex = FindNode(snapshot, "leaf");
+            branchIndex = FindNode(snapshot, "branch");
+            lampIndex = FindNode(snapshot, "lamp");
+            cameraIndex = FindNode(snapshot, "camera");
+            if (!TEST_CHECK(leafIndex != SceneSnapshot::NoParent && branchIndex != SceneSnapshot::NoParent
+                && lampIndex != SceneSnapshot::NoParent && cameraIndex != SceneSnapshot::NoParent))
+            {
+                return;
+            }
+        }
+
+        const std::vector<char> data = ReadFile(path);
+        SnapshotHeader header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        TEST_CHECK(OpenModified(corruptPath, data));
+
+        std::vector<char> truncated(data.begin(), data.end() - 1);
+        TEST_CHECK(!OpenModified(corruptPath, truncated));
+
+        std::vector<char> modified = data;
+        WriteValue(modified, offsetof(SnapshotHeader, version), SceneSnapshot::Version + 1);
+        TEST_CHECK(!OpenModified(corruptPath, modified));
+
+        modified = data;
+        WriteValue(modified, header.dataIndicesOffset + lampIndex * sizeof(std::uint32_t), header.lightCount);
+        TEST_CHECK(!OpenModified(corruptPath, modified));
+
+        modified = data;
+        WriteValue(modified, header.dataIndicesOffset + cameraIndex * sizeof(std::uint32_t), header.cameraCount);
+        TEST_CHECK(!OpenModified(corruptPath, modified));
+
+        modified = data;
+        WriteValue(modified, header.typesOffset + leafIndex, std::uint8_t(3));
+        TEST_CHECK(!OpenModified(corruptPath, modified));
+
+        // A model node turned into a light must still have a valid light index
+        modified = data;
+        WriteValue(modified, header.typesOffset + leafIndex, SceneSnapshot::NodeType::Light);
+        WriteValue(modified, header.dataIndicesOffset + leafIndex * sizeof(std::uint32_t), header.lightCount + 10);
+        TEST_CHECK(!OpenModified(corruptPath, modified));
+
+        modified = data;
+        WriteValue(modified, header.parentsOffset + leafIndex * sizeof(std::uint32_t), header.nodeCount);
+        TEST_CHECK(!OpenModified(corruptPath, modified));
+
+        // Leaf is the parent of branch, which is the parent of leaf
+        modified = data;
+        WriteValue(modified, header.parentsOffset + branchIndex * sizeof(std::uint32_t), leafIndex);
+        TEST_CHECK(!OpenModified(corruptPath, modified));
+
+        modified = data;
+        WriteValue(modified, header.parentsOffset + leafIndex * sizeof(std::uint32_t), leafIndex);
+        TEST_CHECK(!OpenModified(corruptPath, modified));
+    }
+}
+
+int main()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string path = (directory / "sceneSnapshotTest.scn").string();
+    std::string corruptPath = (directory / "sceneSnapshotTestCorrupt.scn").string();
+
+    TestRoundTrip(path);
+    TestFilteredParent(path);
+    TestCorruptFiles(path, corruptPath);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(corruptPath);
+    return TestCheck::GetResult();
+}
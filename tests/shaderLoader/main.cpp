@@ -0,0 +1,151 @@
+#include <ituGL/asset/ShaderLoader.h>
+#include <ituGL/asset/ShaderSourceCache.h>
+
+#include <TestCheck.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Expands shader files with #include, #pragma once, #version and defines, and compares the sources with the expected text
+// Then remaps the compilation logs of several drivers to the file paths
+
+namespace
+{
+    void WriteFile(const std::filesystem::path& path, const char* text)
+    {
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        stream << text;
+    }
+
+    void TestIncludes(const std::filesystem::path& directory)
+    {
+        // Comment lines before #version are dropped. The second include is skipped by #pragma once,
+        // and the one inside the block comment is not expanded
+        WriteFile(directory / "main.glsl",
+            "// Main file\n"
+            "#version 330 core\n"
+            "#include \"common.glsl\"\n"
+            "#include \"common.glsl\"\n"
+            "/*\n"
+            "#include \"missing.glsl\"\n"
+            "*/\n"
+            "void main() {}\n");
+        WriteFile(directory / "common.glsl",
+            "#pragma once\n"
+            "#version 330 core\n"
+            "float Common() { return 1.0; }\n");
+        WriteFile(directory / "noversion.glsl",
+            "#include \"common.glsl\"\n"
+            "void main() {}\n");
+        WriteFile(directory / "code.glsl", "float Code() { return 2.0; }\n");
+        WriteFile(directory / "recursive.glsl", "#include \"recursive2.glsl\"\n");
+        WriteFile(directory / "recursive2.glsl", "#include \"recursive.glsl\"\n");
+        WriteFile(directory / "missing.glsl.in", "#include \"missing.glsl\"\n");
+
+        std::string mainPath = (directory / "main.glsl").string();
+        std::string noVersionPath = (directory / "noversion.glsl").string();
+        std::string codePath = (directory / "code.glsl").string();
+        std::string recursivePath = (directory / "recursive.glsl").string();
+        std::string missingPath = (directory / "missing.glsl.in").string();
+        std::string defines[] = { "FOO 1", "BAR" };
+
+        std::vector<std::string> sources;
+        std::vector<std::string> files;
+        const char* paths[] = { mainPath.c_str(), noVersionPath.c_str() };
+        if (TEST_CHECK(ShaderLoader::LoadSources(paths, sources, &files, defines)))
+        {
+            TEST_CHECK(sources.size() == 2);
+            TEST_CHECK(sources[0] ==
+                "#version 330 core\n"
+                "#define FOO 1\n"
+                "#define BAR\n"
+                "#line 3 1\n"
+                "float Common() { return 1.0; }\n"
+                "#line 5 0\n"
+                "/*\n"
+                "#include \"missing.glsl\"\n"
+                "*/\n"
+                "void main() {}\n");
+
+            // Files are shared by the sources, common.glsl is already included there. The defines are written only once
+            TEST_CHECK(sources[1] ==
+                "#line 2 2\n"
+                "void main() {}\n");
+
+            TEST_CHECK(files.size() == 3);
+            TEST_CHECK(files[0] == ShaderSourceCache::NormalizePath(mainPath));
+            TEST_CHECK(files[1] == ShaderSourceCache::NormalizePath((directory / "common.glsl").string()));
+            TEST_CHECK(files[2] == ShaderSourceCache::NormalizePath(noVersionPath));
+        }
+
+        // The #version of an included file is used if it comes before any code
+        const char* noVersionPaths[] = { noVersionPath.c_str() };
+        if (TEST_CHECK(ShaderLoader::LoadSources(noVersionPaths, sources, nullptr, defines)))
+        {
+            TEST_CHECK(sources[0] ==
+                "#version 330 core\n"
+                "#define FOO 1\n"
+                "#define BAR\n"
+                "#line 3 1\n"
+                "float Common() { return 1.0; }\n"
+                "#line 2 0\n"
+                "void main() {}\n");
+        }
+
+        // Without any #version, the defines go first
+        const char* codePaths[] = { codePath.c_str() };
+        if (TEST_CHECK(ShaderLoader::LoadSources(codePaths, sources, nullptr, defines)))
+        {
+            TEST_CHECK(sources[0] ==
+                "#define FOO 1\n"
+                "#define BAR\n"
+                "#line 1 0\n"
+                "float Code() { return 2.0; }\n");
+        }
+
+        const char* recursivePaths[] = { recursivePath.c_str() };
+        TEST_CHECK(!ShaderLoader::LoadSources(recursivePaths, sources));
+        const char* missingPaths[] = { missingPath.c_str() };
+        TEST_CHECK(!ShaderLoader::LoadSources(missingPaths, sources));
+    }
+
+    void TestRemapErrors()
+    {
+        std::string files[] = { "main.glsl", "common.glsl" };
+
+        // NVIDIA, Mesa and AMD formats
+        TEST_CHECK(ShaderLoader::RemapErrors("0(12) : error C0000: syntax error\n", files) == "main.glsl(12) : error C0000: syntax error\n");
+        TEST_CHECK(ShaderLoader::RemapErrors("1:7(3): error: undeclared\n", files) == "common.glsl:7(3): error: undeclared\n");
+        TEST_CHECK(ShaderLoader::RemapErrors("ERROR: 1:4: 'x' : undeclared identifier\n", files) == "ERROR: common.glsl:4: 'x' : undeclared identifier\n");
+        TEST_CHECK(ShaderLoader::RemapErrors("WARNING: 0:2: unused\n", files) == "WARNING: main.glsl:2: unused\n");
+
+        // Every line is remapped, the last one may have no line break
+        TEST_CHECK(ShaderLoader::RemapErrors("0(1) : a\n1(2) : b", files) == "main.glsl(1) : a\ncommon.glsl(2) : b");
+
+        // Lines without a known source number are kept
+        for (const char* line : {
+            "2(5) : unknown source\n",
+            "99999999999999999999999999(1) : too large\n",
+            "3 errors generated\n",
+            "0 : no line number\n",
+            "error: no source number\n",
+            "\n" })
+        {
+            TEST_CHECK(ShaderLoader::RemapErrors(line, files) == line);
+        }
+        TEST_CHECK(ShaderLoader::RemapErrors("", files).empty());
+    }
+}
+
+int main()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "shaderLoaderTest";
+    std::filesystem::create_directories(directory);
+
+    TestIncludes(directory);
+    TestRemapErrors();
+
+    std::filesystem::remove_all(directory);
+    return TestCheck::GetResult();
+}
@@ -0,0 +1,140 @@
+#include <ituGL/geometry/TerrainHeightfield.h>
+
+#include <TestCheck.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Compares the vectorized height queries and the quadtree raycasts with their reference implementations, on a random terrain
+// Also checks the heights at the samples, between them and outside the grid
+
+namespace
+{
+    // Uneven size, so the last quadtree nodes cover fewer cells, and a grid that is not at the origin
+    const unsigned int Width = 77;
+    const unsigned int Height = 45;
+    const glm::vec2 Spacing(0.5f, 0.75f);
+    const glm::vec2 Origin(-10.0f, 3.0f);
+
+    TerrainHeightfield CreateHeightfield(std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> noise(-0.25f, 0.25f);
+        std::vector<float> heights(Width * Height);
+        for (unsigned int j = 0; j < Height; ++j)
+        {
+            for (unsigned int i = 0; i < Width; ++i)
+            {
+                heights[j * Width + i] = 4.0f * std::sin(i * 0.15f) * std::cos(j * 0.2f) + noise(random);
+            }
+        }
+
+        TerrainHeightfield heightfield;
+        heightfield.Initialize(heights, Width, Height, Spacing, Origin);
+        return heightfield;
+    }
+
+    bool IsClose(float a, float b, float tolerance = 1e-4f)
+    {
+        return std::abs(a - b) <= tolerance * std::max(1.0f, std::abs(a));
+    }
+
+    void TestSampleHeights(const TerrainHeightfield& heightfield, std::mt19937& random)
+    {
+        std::span<const float> heights = heightfield.GetHeights();
+
+        // Exact at the samples, and the average of the 4 corners at the center of a cell
+        TEST_CHECK(heightfield.SampleHeight(Origin.x + 3 * Spacing.x, Origin.y + 5 * Spacing.y) == heights[5 * Width + 3]);
+        float center = 0.25f * (heights[5 * Width + 3] + heights[5 * Width + 4] + heights[6 * Width + 3] + heights[6 * Width + 4]);
+        TEST_CHECK(IsClose(heightfield.SampleHeight(Origin.x + 3.5f * Spacing.x, Origin.y + 5.5f * Spacing.y), center));
+
+        // Outside the grid, the height of the closest border
+        TEST_CHECK(heightfield.SampleHeight(Origin.x - 100.0f, Origin.y - 100.0f) == heights[0]);
+        TEST_CHECK(heightfield.SampleHeight(Origin.x + 1000.0f, Origin.y + 1000.0f) == heights.back());
+
+        // Positions inside and outside the grid. An odd count leaves a tail for the scalar path
+        glm::vec3 boundsMin = heightfield.GetBoundsMin();
+        glm::vec3 boundsMax = heightfield.GetBoundsMax();
+        std::uniform_real_distribution<float> positionX(boundsMin.x - 5.0f, boundsMax.x + 5.0f);
+        std::uniform_real_distribution<float> positionZ(boundsMin.z - 5.0f, boundsMax.z + 5.0f);
+        const size_t count = 1001;
+        std::vector<float> x(count), z(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            x[i] = positionX(random);
+            z[i] = positionZ(random);
+        }
+        // Exactly on the last row and column
+        x[0] = boundsMax.x;
+        z[1] = boundsMax.z;
+
+        std::vector<float> results(count), referenceResults(count);
+        heightfield.SampleHeights(x, z, results);
+        heightfield.SampleHeightsReference(x, z, referenceResults);
+        for (size_t i = 0; i < count; ++i)
+        {
+            TEST_CHECK(IsClose(results[i], referenceResults[i]));
+            TEST_CHECK(referenceResults[i] == heightfield.SampleHeight(x[i], z[i]));
+            TEST_CHECK(results[i] >= boundsMin.y && results[i] <= boundsMax.y);
+        }
+    }
+
+    void TestRaycast(const TerrainHeightfield& heightfield, std::mt19937& random)
+    {
+        glm::vec3 boundsMin = heightfield.GetBoundsMin();
+        glm::vec3 boundsMax = heightfield.GetBoundsMax();
+        std::uniform_real_distribution<float> positionX(boundsMin.x - 10.0f, boundsMax.x + 10.0f);
+        std::uniform_real_distribution<float> positionY(boundsMin.y, boundsMax.y + 10.0f);
+        std::uniform_real_distribution<float> positionZ(boundsMin.z - 10.0f, boundsMax.z + 10.0f);
+        std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+
+        // A ray straight down hits at the sampled height
+        TerrainHeightfield::RayHit hit;
+        glm::vec3 origin(Origin.x + 10.3f, boundsMax.y + 1.0f, Origin.y + 7.1f);
+        if (TEST_CHECK(heightfield.Raycast(origin, glm::vec3(0.0f, -1.0f, 0.0f), 100.0f, hit)))
+        {
+            TEST_CHECK(IsClose(hit.position.y, heightfield.SampleHeight(origin.x, origin.z)));
+            TEST_CHECK(IsClose(hit.distance, origin.y - hit.position.y));
+        }
+
+        // Too short to reach the surface
+        TEST_CHECK(!heightfield.Raycast(origin, glm::vec3(0.0f, -1.0f, 0.0f), 0.5f, hit));
+
+        int hitCount = 0;
+        for (int i = 0; i < 2000; ++i)
+        {
+            // Mostly downwards, some of them almost horizontal or with a zero component
+            glm::vec3 rayOrigin(positionX(random), positionY(random), positionZ(random));
+            glm::vec3 rayDirection(direction(random), -std::abs(direction(random)) * (i % 4 == 0 ? 0.05f : 1.0f), direction(random));
+            if (i % 10 == 0)
+            {
+                rayDirection.x = 0.0f;
+            }
+            float maxDistance = i % 3 == 0 ? 20.0f : 1000.0f;
+
+            TerrainHeightfield::RayHit rayHit, referenceHit;
+            bool found = heightfield.Raycast(rayOrigin, rayDirection, maxDistance, rayHit);
+            bool referenceFound = heightfield.RaycastReference(rayOrigin, rayDirection, maxDistance, referenceHit);
+            if (!TEST_CHECK(found == referenceFound) || !found)
+            {
+                continue;
+            }
+            ++hitCount;
+            TEST_CHECK(IsClose(rayHit.distance, referenceHit.distance));
+            TEST_CHECK(IsClose(rayHit.position.x, referenceHit.position.x) && IsClose(rayHit.position.y, referenceHit.position.y)
+                && IsClose(rayHit.position.z, referenceHit.position.z));
+            TEST_CHECK(rayHit.distance <= maxDistance);
+        }
+        // Make sure the comparison is not only between misses
+        TEST_CHECK(hitCount > 500);
+    }
+}
+
+int main()
+{
+    std::mt19937 random(12345);
+    TerrainHeightfield heightfield = CreateHeightfield(random);
+
+    TestSampleHeights(heightfield, random);
+    TestRaycast(heightfield, random);
+    return TestCheck::GetResult();
+}
@@ -0,0 +1,140 @@
+#include <ituGL/geometry/VertexLayout.h>
+#include <glm/gtc/type_precision.hpp>
+
+#include <TestCheck.h>
+#include <cstdint>
+
+// Builds the vertex layouts used by the exercises and checks their offsets, stride and attributes at compile time
+// Then compares them with the layouts that VertexFormat builds at runtime for the same attributes
+
+namespace
+{
+    // Same as the terrain vertex
+    struct Vertex
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec3 tangent;
+        glm::vec3 bitangent;
+        glm::vec2 texCoord;
+    };
+
+    using Layout = VertexLayout<Vertex,
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, position, Position),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, normal, Normal),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, tangent, Tangent),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, bitangent, Bitangent),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, texCoord, TexCoord0)>;
+
+    static_assert(Layout::AttributeCount == 5);
+    static_assert(Layout::Stride == 56);
+    static_assert(Layout::Layouts[1].GetOffset() == 12);
+    static_assert(Layout::Layouts[4].GetOffset() == 48);
+    static_assert(Layout::Layouts[4].GetStride() == 56);
+    static_assert(Layout::Layouts[4].GetAttribute().GetType() == Data::Type::Float);
+    static_assert(Layout::Layouts[4].GetAttribute().GetComponents() == 2);
+    static_assert(Layout::Layouts[4].GetAttribute().GetSemantic() == VertexAttribute::Semantic::TexCoord0);
+
+    // Same as the compact terrain vertex, with packed and normalized members
+    struct CompactVertex
+    {
+        glm::i16vec4 position;
+        std::uint32_t normal;
+        std::uint32_t tangent;
+        glm::u16vec2 texCoord;
+    };
+
+    using CompactLayout = VertexLayout<CompactVertex,
+        ITUGL_VERTEX_ATTRIBUTE_FORMAT(CompactVertex, position, Position, Short, 4, true),
+        ITUGL_VERTEX_ATTRIBUTE_FORMAT(CompactVertex, normal, Normal, Int2101010Rev, 4, true),
+        ITUGL_VERTEX_ATTRIBUTE_FORMAT(CompactVertex, tangent, Tangent, Int2101010Rev, 4, true),
+        ITUGL_VERTEX_ATTRIBUTE_FORMAT(CompactVertex, texCoord, TexCoord0, Half, 2, false)>;
+
+    static_assert(CompactLayout::Stride == 20);
+    static_assert(CompactLayout::Layouts[1].GetOffset() == 8);
+    static_assert(CompactLayout::Layouts[3].GetOffset() == 16);
+    // Packed types have all the components in one value
+    static_assert(CompactLayout::Layouts[1].GetAttribute().GetSize() == 4);
+    static_assert(CompactLayout::Layouts[1].GetAttribute().GetComponents() == 4);
+    static_assert(CompactLayout::Layouts[0].GetAttribute().IsNormalized());
+    static_assert(!CompactLayout::Layouts[3].GetAttribute().IsNormalized());
+
+    // Same as the particle in exercise02, with scalars and a Color
+    struct Particle
+    {
+        glm::vec2 position;
+        float size;
+        float birth;
+        float duration;
+        Color color;
+        glm::vec2 velocity;
+    };
+
+    using ParticleLayout = VertexLayout<Particle,
+        ITUGL_VERTEX_ATTRIBUTE(Particle, position, Position),
+        ITUGL_VERTEX_ATTRIBUTE(Particle, size, Unknown),
+        ITUGL_VERTEX_ATTRIBUTE(Particle, birth, Unknown),
+        ITUGL_VERTEX_ATTRIBUTE(Particle, duration, Unknown),
+        ITUGL_VERTEX_ATTRIBUTE(Particle, color, Color0),
+        ITUGL_VERTEX_ATTRIBUTE(Particle, velocity, Unknown)>;
+
+    static_assert(ParticleLayout::Stride == 44);
+    static_assert(ParticleLayout::Layouts[1].GetAttribute().GetComponents() == 1);
+    static_assert(ParticleLayout::Layouts[4].GetOffset() == 20);
+    static_assert(ParticleLayout::Layouts[4].GetAttribute().GetComponents() == 4);
+    static_assert(ParticleLayout::Layouts[5].GetOffset() == 36);
+
+    // Attributes out of order, or missing a member, are rejected
+    static_assert(!IsVertexLayoutPacked<Vertex,
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, normal, Normal),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, position, Position),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, tangent, Tangent),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, bitangent, Bitangent),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, texCoord, TexCoord0)>());
+    static_assert(!IsVertexLayoutPacked<Vertex,
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, position, Position),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, normal, Normal),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, bitangent, Bitangent),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, texCoord, TexCoord0)>());
+    static_assert(!IsVertexLayoutPacked<Vertex,
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, position, Position),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, normal, Normal),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, tangent, Tangent),
+        ITUGL_VERTEX_ATTRIBUTE(Vertex, bitangent, Bitangent)>());
+
+    bool IsSameAttribute(const VertexAttribute& a, const VertexAttribute& b)
+    {
+        return a.GetType() == b.GetType() && a.GetComponents() == b.GetComponents()
+            && a.IsNormalized() == b.IsNormalized() && a.GetSemantic() == b.GetSemantic();
+    }
+
+    // The compile time layouts must match the interleaved layouts of the same VertexFormat
+    template<typename TLayout>
+    void TestVertexFormat()
+    {
+        VertexFormat vertexFormat = TLayout::GetVertexFormat();
+        TEST_CHECK(vertexFormat.GetAttributeCount() == static_cast<int>(TLayout::AttributeCount));
+        TEST_CHECK(vertexFormat.GetSize() == sizeof(typename TLayout::Vertex));
+
+        const VertexAttribute::Layout* layout = TLayout::LayoutBegin();
+        for (VertexFormat::LayoutIterator it = vertexFormat.LayoutBegin(1, true); it != vertexFormat.LayoutEnd(); it++, ++layout)
+        {
+            if (!TEST_CHECK(layout != TLayout::LayoutEnd()))
+            {
+                return;
+            }
+            TEST_CHECK(IsSameAttribute(it->GetAttribute(), layout->GetAttribute()));
+            TEST_CHECK(it->GetOffset() == layout->GetOffset());
+            TEST_CHECK(it->GetStride() == layout->GetStride());
+        }
+        TEST_CHECK(layout == TLayout::LayoutEnd());
+    }
+}
+
+int main()
+{
+    TestVertexFormat<Layout>();
+    TestVertexFormat<CompactLayout>();
+    TestVertexFormat<ParticleLayout>();
+    return TestCheck::GetResult();
+}
@@ -0,0 +1,132 @@
+#include <ituGL/geometry/VertexQuantization.h>
+
+#include <TestCheck.h>
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <cmath>
+#include <random>
+
+// Quantizes random positions, directions and texture coordinates, dequantizes them back and checks the errors against the precision of each format
+// Also checks that the quality report keeps the largest errors
+
+namespace
+{
+    void TestPositions()
+    {
+        std::mt19937 random(1);
+        glm::vec3 boundsMin(-3.0f, -1.0f, -2.0f);
+        glm::vec3 boundsMax(5.0f, 4.0f, 6.0f);
+        VertexQuantization::PositionTransform transform = VertexQuantization::GetPositionTransform(boundsMin, boundsMax);
+
+        // Uniform scale, the half size of the largest axis
+        TEST_CHECK(transform.offset == glm::vec3(1.0f, 1.5f, 2.0f));
+        TEST_CHECK(transform.scale == 4.0f);
+
+        // Half a step on each axis, plus rounding
+        float maxError = transform.scale / 32767.0f;
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        VertexQuantization::QualityReport report;
+        for (int i = 0; i < 10000; ++i)
+        {
+            glm::vec3 position = glm::mix(boundsMin, boundsMax, glm::vec3(unit(random), unit(random), unit(random)));
+            glm::i16vec4 quantized = VertexQuantization::QuantizePosition(position, transform);
+            report.AddPosition(position, VertexQuantization::DequantizePosition(quantized, transform));
+            TEST_CHECK(quantized.w == 32767);
+        }
+        TEST_CHECK(report.GetMaxPositionError() > 0.0f && report.GetMaxPositionError() <= maxError);
+
+        // The corners map to the ends of the range
+        TEST_CHECK(glm::length(VertexQuantization::DequantizePosition(VertexQuantization::QuantizePosition(boundsMin, transform), transform) - boundsMin) <= maxError);
+        TEST_CHECK(glm::length(VertexQuantization::DequantizePosition(VertexQuantization::QuantizePosition(boundsMax, transform), transform) - boundsMax) <= maxError);
+
+        // Flat bounds still give a valid transform
+        VertexQuantization::PositionTransform pointTransform = VertexQuantization::GetPositionTransform(glm::vec3(2.0f), glm::vec3(2.0f));
+        TEST_CHECK(pointTransform.scale > 0.0f);
+        TEST_CHECK(VertexQuantization::DequantizePosition(VertexQuantization::QuantizePosition(glm::vec3(2.0f), pointTransform), pointTransform) == glm::vec3(2.0f));
+    }
+
+    void TestDirections()
+    {
+        std::mt19937 random(2);
+        std::normal_distribution<float> normal;
+        VertexQuantization::QualityReport report;
+        for (int i = 0; i < 10000; ++i)
+        {
+            glm::vec3 direction(normal(random), normal(random), normal(random));
+            glm::vec4 quantized = VertexQuantization::DequantizeDirection(VertexQuantization::QuantizeDirection(direction));
+            report.AddNormal(direction, glm::vec3(quantized));
+            TEST_CHECK(quantized.w == 0.0f);
+        }
+
+        // 10 bit components are within 1/1022 of the value, about 0.1 degrees for the whole direction
+        TEST_CHECK(report.GetMaxNormalError() > 0.0f && report.GetMaxNormalError() < 0.15f);
+
+        // Axes and the sign in w are exact
+        for (float w : { -1.0f, 0.0f, 1.0f })
+        {
+            TEST_CHECK(VertexQuantization::DequantizeDirection(VertexQuantization::QuantizeDirection(glm::vec3(1.0f, 0.0f, 0.0f), w)) == glm::vec4(1.0f, 0.0f, 0.0f, w));
+            TEST_CHECK(VertexQuantization::DequantizeDirection(VertexQuantization::QuantizeDirection(glm::vec3(0.0f, -2.0f, 0.0f), w)) == glm::vec4(0.0f, -1.0f, 0.0f, w));
+        }
+
+        // Handedness of the tangent frame
+        glm::vec3 normalAxis(0.0f, 0.0f, 1.0f), tangent(1.0f, 0.0f, 0.0f), bitangent(0.0f, 1.0f, 0.0f);
+        TEST_CHECK(VertexQuantization::GetBitangentSign(normalAxis, tangent, bitangent) == 1.0f);
+        TEST_CHECK(VertexQuantization::GetBitangentSign(normalAxis, tangent, -bitangent) == -1.0f);
+    }
+
+    void TestTexCoords()
+    {
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::uniform_real_distribution<float> tiled(-8.0f, 8.0f);
+        VertexQuantization::QualityReport report, tiledReport;
+        for (int i = 0; i < 10000; ++i)
+        {
+            glm::vec2 texCoord(unit(random), unit(random));
+            report.AddTexCoord(texCoord, VertexQuantization::DequantizeTexCoord(VertexQuantization::QuantizeTexCoord(texCoord)));
+            glm::vec2 tiledTexCoord(tiled(random), tiled(random));
+            tiledReport.AddTexCoord(tiledTexCoord, VertexQuantization::DequantizeTexCoord(VertexQuantization::QuantizeTexCoord(tiledTexCoord)));
+        }
+
+        // Half floats have 11 significant bits, the error is relative to the value
+        TEST_CHECK(report.GetMaxTexCoordError() <= std::ldexp(1.0f, -12));
+        TEST_CHECK(tiledReport.GetMaxTexCoordError() <= std::ldexp(8.0f, -11));
+
+        // Texel centers of power of two textures are exact
+        TEST_CHECK(VertexQuantization::DequantizeTexCoord(VertexQuantization::QuantizeTexCoord(glm::vec2(0.5f / 256.0f, 0.75f))) == glm::vec2(0.5f / 256.0f, 0.75f));
+    }
+
+    void TestReport()
+    {
+        VertexQuantization::QualityReport report;
+        TEST_CHECK(report.GetMaxPositionError() == 0.0f);
+        TEST_CHECK(report.GetMaxNormalError() == 0.0f);
+        TEST_CHECK(report.GetSizeRatio() == 1.0f);
+
+        report.AddPosition(glm::vec3(0.0f), glm::vec3(0.0f, 0.5f, 0.0f));
+        report.AddTangent(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 0.0f));
+        report.AddVertexData(100, 40);
+
+        VertexQuantization::QualityReport other;
+        other.AddPosition(glm::vec3(0.0f), glm::vec3(0.0f, 0.25f, 0.0f));
+        other.AddNormal(glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        other.AddVertexData(50, 20);
+
+        report.Merge(other);
+        TEST_CHECK(report.GetMaxPositionError() == 0.5f);
+        TEST_CHECK(std::abs(report.GetMaxTangentError() - 45.0f) < 0.01f);
+        TEST_CHECK(std::abs(report.GetMaxNormalError() - 90.0f) < 0.01f);
+        TEST_CHECK(report.GetSourceSize() == 150);
+        TEST_CHECK(report.GetQuantizedSize() == 60);
+        TEST_CHECK(std::abs(report.GetSizeRatio() - 0.4f) < 0.0001f);
+    }
+}
+
+int main()
+{
+    TestPositions();
+    TestDirections();
+    TestTexCoords();
+    TestReport();
+    return TestCheck::GetResult();
+}
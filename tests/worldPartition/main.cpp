@@ -0,0 +1,183 @@
+#include <ituGL/scene/WorldPartition.h>
+#include <ituGL/scene/Scene.h>
+#include <ituGL/scene/SceneModel.h>
+#include <ituGL/scene/Transform.h>
+#include <ituGL/geometry/Model.h>
+#include <ituGL/core/JobSystem.h>
+
+#include <TestCheck.h>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+// Saves a scene with a transform hierarchy in cells, streams the cells in around a position, then moves away to evict them
+// Checks the node names, the parents and the world matrices of the streamed nodes, and that every node is removed again
+
+namespace
+{
+    const float CellSize = 10.0f;
+
+    struct TestModels
+    {
+        std::shared_ptr<Model> rock = std::make_shared<Model>();
+        std::shared_ptr<Model> tree = std::make_shared<Model>();
+        // Not referenced by id, nodes using it are not saved
+        std::shared_ptr<Model> unknown = std::make_shared<Model>();
+
+        AssetId GetModelId(const Model& model) const
+        {
+            return &model == rock.get() ? 1 : &model == tree.get() ? 2 : 0;
+        }
+
+        std::shared_ptr<Model> GetModel(AssetId modelId) const
+        {
+            return modelId == 1 ? rock : modelId == 2 ? tree : nullptr;
+        }
+    };
+
+    std::shared_ptr<SceneModel> AddModel(Scene& scene, const std::string& name, std::shared_ptr<Model> model, glm::vec3 translation)
+    {
+        std::shared_ptr<SceneModel> node = std::make_shared<SceneModel>(name, model, glm::vec3(-1.0f), glm::vec3(1.0f));
+        node->GetTransform()->SetTranslation(translation);
+        node->GetTransform()->SetRotation(glm::vec3(0.0f, 0.5f, 0.0f));
+        scene.AddSceneNode(node);
+        return node;
+    }
+
+    std::string GetCellPath(const std::string& prefix, glm::ivec2 cell)
+    {
+        std::string name = prefix + "_" + std::to_string(cell.x) + "_" + std::to_string(cell.y) + ".scn";
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    // Updates until every requested cell has all its nodes in the scene
+    bool UpdateUntilActive(WorldPartition& partition, const glm::vec3& position)
+    {
+        for (int i = 0; i < 5000; ++i)
+        {
+            partition.Update(position);
+            if (partition.GetCellCount() > 0 && partition.GetActiveCellCount() == partition.GetCellCount())
+            {
+                // One more update to release the cells that are out of range
+                partition.Update(position);
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    void CheckStreamedNodes(const Scene& scene, const Scene& original)
+    {
+        TEST_CHECK(scene.GetSceneNodeCount() == 5);
+
+        // The hierarchy is stored in the cell of its root, even if the children are in other cells
+        std::string prefix = WorldPartition::GetNodeNamePrefix(glm::ivec2(0, 0));
+        std::shared_ptr<SceneNode> house = scene.GetSceneNode(prefix + "house");
+        std::shared_ptr<SceneNode> door = scene.GetSceneNode(prefix + "door");
+        std::shared_ptr<SceneNode> knob = scene.GetSceneNode(prefix + "knob");
+        if (TEST_CHECK(house && door && knob))
+        {
+            TEST_CHECK(house->GetTransform()->GetParent() == nullptr);
+            TEST_CHECK(door->GetTransform()->GetParent() == house->GetTransform());
+            TEST_CHECK(knob->GetTransform()->GetParent() == door->GetTransform());
+            TEST_CHECK(knob->GetTransform()->GetTransformMatrix() == original.GetSceneNode("knob")->GetTransform()->GetTransformMatrix());
+        }
+
+        // Nodes with the same name in different cells are both kept
+        std::shared_ptr<SceneNode> rock = scene.GetSceneNode(WorldPartition::GetNodeNamePrefix(glm::ivec2(1, 0)) + "rock");
+        std::shared_ptr<SceneNode> otherRock = scene.GetSceneNode(WorldPartition::GetNodeNamePrefix(glm::ivec2(0, 1)) + "rock");
+        if (TEST_CHECK(rock && otherRock))
+        {
+            TEST_CHECK(rock->GetTransform()->GetTranslation() == glm::vec3(15.0f, 0.0f, 5.0f));
+            TEST_CHECK(otherRock->GetTransform()->GetTranslation() == glm::vec3(5.0f, 0.0f, 15.0f));
+        }
+    }
+
+    void TestRoundTrip(const std::string& pathPrefix)
+    {
+        TestModels models;
+        auto getCellPath = [&](glm::ivec2 cell) { return GetCellPath(pathPrefix, cell); };
+        auto getModelId = [&](const Model& model) { return models.GetModelId(model); };
+
+        // Children are added first, and the door is outside the cell of the house
+        Scene original;
+        std::shared_ptr<SceneModel> knob = AddModel(original, "knob", models.rock, glm::vec3(0.0f, 1.0f, 0.5f));
+        std::shared_ptr<SceneModel> door = AddModel(original, "door", models.tree, glm::vec3(20.0f, 0.0f, 0.0f));
+        std::shared_ptr<SceneModel> house = AddModel(original, "house", models.tree, glm::vec3(5.0f, 0.0f, 5.0f));
+        knob->GetTransform()->SetParent(door->GetTransform());
+        door->GetTransform()->SetParent(house->GetTransform());
+        AddModel(original, "rock", models.rock, glm::vec3(15.0f, 0.0f, 5.0f));
+        AddModel(original, "unknown", models.unknown, glm::vec3(5.0f, 0.0f, 5.0f));
+        TEST_CHECK(WorldPartition::SaveCells(original, CellSize, getCellPath, getModelId));
+        TEST_CHECK(!std::filesystem::exists(getCellPath(glm::ivec2(2, 0))));
+
+        // Another rock with the same name, in another cell
+        Scene other;
+        AddModel(other, "rock", models.rock, glm::vec3(5.0f, 0.0f, 15.0f));
+        TEST_CHECK(WorldPartition::SaveCells(other, CellSize, getCellPath, getModelId));
+
+        Scene scene;
+        JobSystem jobSystem(1);
+        WorldPartition partition(scene, jobSystem, CellSize, getCellPath, [&](AssetId modelId) { return models.GetModel(modelId); });
+        partition.SetRadius(6.0f, 8.0f);
+        partition.SetTimeBudget(1.0);
+
+        glm::vec3 position(10.0f, 0.0f, 10.0f);
+        TEST_CHECK(UpdateUntilActive(partition, position));
+        CheckStreamedNodes(scene, original);
+
+        // Far away cells have no files, so all the nodes are removed
+        TEST_CHECK(UpdateUntilActive(partition, glm::vec3(1000.0f, 0.0f, 1000.0f)));
+        TEST_CHECK(scene.GetSceneNodeCount() == 0);
+
+        // Coming back streams the same nodes again
+        TEST_CHECK(UpdateUntilActive(partition, position));
+        CheckStreamedNodes(scene, original);
+
+        partition.UnloadAll();
+        TEST_CHECK(scene.GetSceneNodeCount() == 0);
+    }
+
+    // Nodes whose parent is not stored would move, so nothing is written
+    void TestParentNotSaved(const std::string& pathPrefix)
+    {
+        TestModels models;
+        auto getCellPath = [&](glm::ivec2 cell) { return GetCellPath(pathPrefix, cell); };
+
+        Scene scene;
+        std::shared_ptr<SceneModel> parent = AddModel(scene, "parent", models.unknown, glm::vec3(5.0f, 0.0f, 5.0f));
+        std::shared_ptr<SceneModel> child = AddModel(scene, "child", models.rock, glm::vec3(1.0f, 0.0f, 0.0f));
+        child->GetTransform()->SetParent(parent->GetTransform());
+
+        TEST_CHECK(!WorldPartition::SaveCells(scene, CellSize, getCellPath, [&](const Model& model) { return models.GetModelId(model); }));
+        TEST_CHECK(!std::filesystem::exists(getCellPath(glm::ivec2(0, 0))));
+    }
+
+    void RemoveCellFiles(const std::string& pathPrefix)
+    {
+        for (int y = -1; y <= 2; ++y)
+        {
+            for (int x = -1; x <= 2; ++x)
+            {
+                std::filesystem::remove(GetCellPath(pathPrefix, glm::ivec2(x, y)));
+            }
+        }
+    }
+}
+
+int main()
+{
+    std::string pathPrefix = "worldPartitionTest";
+    std::string rejectedPathPrefix = "worldPartitionTestRejected";
+    RemoveCellFiles(pathPrefix);
+    RemoveCellFiles(rejectedPathPrefix);
+
+    TestRoundTrip(pathPrefix);
+    TestParentNotSaved(rejectedPathPrefix);
+
+    RemoveCellFiles(pathPrefix);
+    RemoveCellFiles(rejectedPathPrefix);
+    return TestCheck::GetResult();
+}
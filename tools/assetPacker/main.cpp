@@ -0,0 +1,96 @@
+#include <ituGL/asset/AssetPack.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Builds a pack with all the files in a directory, to be mounted with VirtualFileSystem
+// Cook the textures and models first, so the pack has the cooked files too
+
+void PrintUsage()
+{
+    std::cout << "Usage: assetPacker [options] directory pack\n"
+        << "       assetPacker -list pack\n"
+        << "  -nocompress           Store all the files without compression\n"
+        << "  -minsavings fraction  Compress a file only if it gets at least this much smaller (default 0.1)\n"
+        << "  -exclude .ext         Skip the files with this extension. Can be repeated\n"
+        << "  -list                 Print the files in a pack\n";
+}
+
+int ListPack(const char* path)
+{
+    AssetPack pack;
+    if (!pack.Open(path))
+    {
+        std::cout << "ERROR::ASSET_PACKER::PACK_NOT_OPENED: " << path << std::endl;
+        return 1;
+    }
+
+    for (unsigned int i = 0; i < pack.GetEntryCount(); ++i)
+    {
+        const AssetPack::Entry& entry = pack.GetEntry(i);
+        std::cout << pack.GetPath(entry) << "  " << entry.size << " bytes";
+        if (entry.compression == AssetPack::Compression::LZ4)
+        {
+            std::cout << ", " << entry.storedSize << " compressed";
+        }
+        std::cout << "\n";
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    AssetPack::BuildSettings settings;
+    std::vector<const char*> paths;
+    bool list = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-nocompress") == 0)
+        {
+            settings.compression = AssetPack::Compression::None;
+        }
+        else if (std::strcmp(argv[i], "-minsavings") == 0 && i + 1 < argc)
+        {
+            settings.minSavings = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "-exclude") == 0 && i + 1 < argc)
+        {
+            settings.excludedExtensions.push_back(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "-list") == 0)
+        {
+            list = true;
+        }
+        else if (argv[i][0] == '-')
+        {
+            PrintUsage();
+            return 1;
+        }
+        else
+        {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    if (list && paths.size() == 1)
+    {
+        return ListPack(paths[0]);
+    }
+
+    if (list || paths.size() != 2)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    int fileCount = AssetPack::Build(paths[0], paths[1], settings);
+    if (fileCount < 0)
+    {
+        std::cout << "ERROR::ASSET_PACKER::WRITE_FAILED: " << paths[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << fileCount << " files in " << paths[1] << std::endl;
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include <ituGL/asset/DDSFile.h>
+#include <ituGL/asset/Texture2DLoader.h>
+#include <ituGL/core/JobSystem.h>
+#include <ituGL/texture/BlockCompression.h>
+#include <ituGL/texture/MipChain.h>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Encodes source images to block compressed DDS files with all their mipmaps
+// The cooked files are written next to the sources, where Texture2DLoader looks for them
+
+struct CookSettings
+{
+    TextureObject::InternalFormat internalFormat = TextureObject::InternalFormatBC7;
+    bool srgb = false;
+    bool flipVertical = false;
+    MipChain::Filter filter = MipChain::Filter::Box;
+};
+
+void PrintUsage()
+{
+    std::cout << "Usage: textureCooker [options] image...\n"
+        << "  -format bc1|bc3|bc4|bc5|bc7   Compressed format (default bc7)\n"
+        << "  -srgb                         Color is sRGB: mipmaps are filtered in linear space and the format is sRGB\n"
+        << "  -flip                         Flip the image vertically, like Texture2DLoader::SetFlipVertical\n"
+        << "  -filter box|kaiser            Mipmap filter (default box)\n";
+}
+
+bool ParseFormat(const char* name, TextureObject::InternalFormat& internalFormat)
+{
+    if (std::strcmp(name, "bc1") == 0) internalFormat = TextureObject::InternalFormatBC1;
+    else if (std::strcmp(name, "bc3") == 0) internalFormat = TextureObject::InternalFormatBC3;
+    else if (std::strcmp(name, "bc4") == 0) internalFormat = TextureObject::InternalFormatBC4;
+    else if (std::strcmp(name, "bc5") == 0) internalFormat = TextureObject::InternalFormatBC5;
+    else if (std::strcmp(name, "bc7") == 0) internalFormat = TextureObject::InternalFormatBC7;
+    else return false;
+    return true;
+}
+
+TextureObject::InternalFormat GetSRGBFormat(TextureObject::InternalFormat internalFormat)
+{
+    switch (internalFormat)
+    {
+    case TextureObject::InternalFormatBC1:
+        return TextureObject::InternalFormatBC1SRGB;
+    case TextureObject::InternalFormatBC3:
+        return TextureObject::InternalFormatBC3SRGB;
+    case TextureObject::InternalFormatBC7:
+        return TextureObject::InternalFormatBC7SRGB;
+    default:
+        // BC4 and BC5 store data, not color
+        return internalFormat;
+    }
+}
+
+bool CookTexture(const char* path, const CookSettings& settings)
+{
+    // Always decoded as RGBA8, the encoders pick the components they need
+    int width, height;
+    Data::Type dataType;
+    TextureObject::InternalFormat decodeFormat = settings.srgb ? TextureObject::InternalFormatSRGBA8 : TextureObject::InternalFormatRGBA8;
+    std::span<const std::byte> data = TextureLoaderUtils::LoadTexture2DData(path, width, height, dataType, TextureObject::FormatRGBA, decodeFormat, settings.flipVertical);
+    if (data.empty())
+    {
+        std::cout << "ERROR::TEXTURE_COOKER::LOAD_FAILED: " << path << std::endl;
+        return false;
+    }
+
+    MipChain mipChain;
+    mipChain.Generate(data, width, height, 4, dataType, settings.srgb, settings.filter);
+    TextureLoaderUtils::FreeTexture2DData(data);
+
+    DDSFile cookedFile;
+    cookedFile.SetInternalFormat(settings.srgb ? GetSRGBFormat(settings.internalFormat) : settings.internalFormat);
+    cookedFile.SetFlipVertical(settings.flipVertical);
+    for (unsigned int i = 0; i < mipChain.GetLevelCount(); ++i)
+    {
+        const MipChain::Level& level = mipChain.GetLevel(i);
+        cookedFile.AddLevel(level.width, level.height, BlockCompression::Encode(level.data, level.width, level.height, cookedFile.GetInternalFormat()));
+    }
+
+    std::string cookedPath = Texture2DLoader::GetCookedPath(path);
+    if (!cookedFile.Write(cookedPath.c_str()))
+    {
+        std::cout << "ERROR::TEXTURE_COOKER::WRITE_FAILED: " << cookedPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    CookSettings settings;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-format") == 0 && i + 1 < argc)
+        {
+            if (!ParseFormat(argv[++i], settings.internalFormat))
+            {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "-filter") == 0 && i + 1 < argc)
+        {
+            ++i;
+            settings.filter = std::strcmp(argv[i], "kaiser") == 0 ? MipChain::Filter::Kaiser : MipChain::Filter::Box;
+        }
+        else if (std::strcmp(argv[i], "-srgb") == 0)
+        {
+            settings.srgb = true;
+        }
+        else if (std::strcmp(argv[i], "-flip") == 0)
+        {
+            settings.flipVertical = true;
+        }
+        else if (argv[i][0] == '-')
+        {
+            PrintUsage();
+            return 1;
+        }
+        else
+        {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    if (paths.empty())
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    // One image per job, encoding is the slow part
+    std::atomic<int> failedCount = 0;
+    JobSystem::GetDefault().ParallelFor(paths.size(), 1, [&](size_t begin, size_t end, size_t)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (!CookTexture(paths[i], settings))
+                {
+                    ++failedCount;
+                }
+            }
+        });
+
+    std::cout << "Cooked " << paths.size() - failedCount << " of " << paths.size() << " textures" << std::endl;
+    return failedCount > 0 ? 1 : 0;
+}